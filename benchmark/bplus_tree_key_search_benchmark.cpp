@@ -0,0 +1,180 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// B+树节点内查找的性能测试。
+// 每次查找对应树上的一层，输出的 cycles_per_level 是在一个节点内查找一次需要的CPU周期数。
+// generic 使用 common::lower_bound + KeyComparator，fast 使用节点当前的查找实现(INTS/FLOATS 使用SIMD)。
+//
+#include <vector>
+#include <chrono>
+#include <random>
+#include <benchmark/benchmark.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "storage/index/bplus_tree.h"
+#include "storage/index/bplus_tree_key_search.h"
+#include "common/lang/lower_bound.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+namespace {
+
+const int PROBE_NUM = 4096;
+
+inline uint64_t read_cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * @brief 构造一个填满的叶子节点或内部节点，以及一组随机的查找键值
+ */
+class NodeSearchContext
+{
+public:
+  NodeSearchContext(AttrType attr_type, bool internal) : internal_(internal)
+  {
+    const int attr_length = 4;
+    const int key_length  = attr_length + sizeof(RID);
+    const int capacity =
+        internal ? ((int)BP_PAGE_DATA_SIZE - InternalIndexNode::HEADER_SIZE) / (key_length + (int)sizeof(PageNum))
+                 : ((int)BP_PAGE_DATA_SIZE - LeafIndexNode::HEADER_SIZE) / (key_length + (int)sizeof(RID));
+
+    header_.root_page         = BP_INVALID_PAGE_NUM;
+    header_.internal_max_size = capacity;
+    header_.leaf_max_size     = capacity;
+    header_.attr_length       = attr_length;
+    header_.key_length        = key_length;
+    header_.attr_type         = attr_type;
+    comparator_.init(attr_type, attr_length);
+
+    item_size_ = key_length + (internal ? sizeof(PageNum) : sizeof(RID));
+    frame_.clear_page();
+    RID  rid{1, 1};
+    char key[key_length];
+    if (internal) {
+      InternalIndexNodeHandler node(header_, &frame_);
+      node.init_empty();
+      fill_key(key, 0, rid);
+      node.create_new_root(0, key, 1);
+      for (int i = 2; i < capacity; i++) {
+        fill_key(key, i * 2, rid);
+        node.insert(key, i, comparator_);
+      }
+      // 内部节点的第0个键值是无效的。没有前缀压缩，返回的就是节点中的键值
+      keys_     = const_cast<char *>(node.key_at(1, key));
+      key_num_  = node.size() - 1;
+    } else {
+      LeafIndexNodeHandler node(header_, &frame_);
+      node.init_empty();
+      for (int i = 0; i < capacity; i++) {
+        fill_key(key, i * 2, rid);
+        node.insert(i, key, reinterpret_cast<const char *>(&rid));
+      }
+      keys_    = const_cast<char *>(node.key_at(0, key));
+      key_num_ = node.size();
+    }
+
+    mt19937 random_engine(0);
+    uniform_int_distribution<int> distribution(-1, capacity * 2);
+    probes_.resize(PROBE_NUM * key_length);
+    for (int i = 0; i < PROBE_NUM; i++) {
+      fill_key(probes_.data() + i * key_length, distribution(random_engine), rid);
+    }
+  }
+
+  void fill_key(char *key, int value, const RID &rid) const
+  {
+    if (header_.attr_type == FLOATS) {
+      float float_value = static_cast<float>(value);
+      memcpy(key, &float_value, sizeof(float_value));
+    } else {
+      memcpy(key, &value, sizeof(value));
+    }
+    memcpy(key + header_.attr_length, &rid, sizeof(rid));
+  }
+
+  const char *probe(int i) const { return probes_.data() + (i % PROBE_NUM) * header_.key_length; }
+
+  bool            internal_;
+  int             item_size_ = 0;
+  char           *keys_      = nullptr;  ///< 参与查找的第一个键值
+  int             key_num_   = 0;        ///< 参与查找的键值个数
+  IndexFileHeader header_;
+  KeyComparator   comparator_;
+  Frame           frame_;
+  vector<char>    probes_;
+};
+
+void report(State &state, uint64_t cycles, int node_size)
+{
+  state.counters["node_size"]        = node_size;
+  state.counters["cycles_per_level"] = Counter(static_cast<double>(cycles), Counter::kAvgIterations);
+  state.SetLabel(fast_key_search_isa());
+}
+
+}  // namespace
+
+/**
+ * @brief 旧的查找方法，每次比较都通过 KeyComparator 分派
+ * @details state.range(0) 是属性类型，state.range(1) 表示是否是内部节点
+ */
+static void BM_GenericNodeSearch(State &state)
+{
+  NodeSearchContext context(static_cast<AttrType>(state.range(0)), state.range(1) != 0);
+  const int         item_size = context.item_size_;
+
+  uint64_t cycles = 0;
+  int      i      = 0;
+  for (auto _ : state) {
+    bool                 found = false;
+    const uint64_t       begin = read_cycles();
+    BinaryIterator<char> iter_begin(item_size, context.keys_);
+    BinaryIterator<char> iter_end(item_size, context.keys_ + context.key_num_ * item_size);
+    BinaryIterator<char> iter = lower_bound(iter_begin, iter_end, context.probe(i++), context.comparator_, &found);
+    DoNotOptimize(iter);
+    cycles += read_cycles() - begin;
+  }
+  report(state, cycles, context.key_num_);
+}
+
+static void BM_FastNodeSearch(State &state)
+{
+  NodeSearchContext context(static_cast<AttrType>(state.range(0)), state.range(1) != 0);
+  LeafIndexNodeHandler     leaf_node(context.header_, &context.frame_);
+  InternalIndexNodeHandler internal_node(context.header_, &context.frame_);
+
+  uint64_t cycles = 0;
+  int      i      = 0;
+  for (auto _ : state) {
+    bool           found = false;
+    const uint64_t begin = read_cycles();
+    int index = context.internal_ ? internal_node.lookup(context.comparator_, context.probe(i++), &found)
+                                  : leaf_node.lookup(context.comparator_, context.probe(i++), &found);
+    DoNotOptimize(index);
+    cycles += read_cycles() - begin;
+  }
+  report(state, cycles, context.key_num_);
+}
+
+BENCHMARK(BM_GenericNodeSearch)->ArgsProduct({{INTS, FLOATS}, {0, 1}});
+BENCHMARK(BM_FastNodeSearch)->ArgsProduct({{INTS, FLOATS}, {0, 1}});
+
+BENCHMARK_MAIN();
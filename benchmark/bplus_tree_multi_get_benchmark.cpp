@@ -0,0 +1,147 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// B+树批量查找的性能测试。
+// single_get 对每个键值调用一次 get_entry，multi_get 一次调用 multi_get_entry 查找一批键值。
+// state.range(0) 是一批查找的键值个数，state.range(1) 是键值的取值范围相对于树中数据的比例(百分比)，
+// 比例越小，一批中的键值越密集，批量查找时可以复用的叶子节点越多。
+//
+#include <algorithm>
+#include <list>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "storage/index/bplus_tree.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "common/log/log.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+namespace {
+
+const char *INDEX_FILE_NAME = "bench_multi_get.btree";
+const int   KEY_NUM         = 200000;
+const int   ROWS_PER_PAGE   = 64;
+
+BufferPoolManager bpm;
+
+/**
+ * @brief 所有测试共用一棵树，键值是[0, KEY_NUM)，RID按照键值顺序放在堆页面中
+ */
+class MultiGetContext
+{
+public:
+  static MultiGetContext &instance()
+  {
+    static MultiGetContext context;
+    return context;
+  }
+
+  BplusTreeHandler &handler() { return handler_; }
+
+  vector<int> make_probes(int batch_size, int range_percent, mt19937 &random_engine) const
+  {
+    const int range = max(batch_size, KEY_NUM / 100 * range_percent);
+    uniform_int_distribution<int> start_distribution(0, KEY_NUM - range);
+    uniform_int_distribution<int> offset_distribution(0, range - 1);
+    const int start = start_distribution(random_engine);
+
+    vector<int> probes(batch_size);
+    for (int &probe : probes) {
+      probe = start + offset_distribution(random_engine);
+    }
+    return probes;
+  }
+
+private:
+  MultiGetContext()
+  {
+    LoggerFactory::init_default("bplus_tree_multi_get_benchmark.log", LOG_LEVEL_WARN);
+    BufferPoolManager::set_instance(&bpm);
+    ::remove(INDEX_FILE_NAME);
+
+    RC rc = handler_.create(INDEX_FILE_NAME, INTS, sizeof(int), false /*is_unique*/);
+    if (rc != RC::SUCCESS) {
+      throw runtime_error("failed to create index");
+    }
+
+    for (int i = 0; i < KEY_NUM; i++) {
+      RID rid(i / ROWS_PER_PAGE + 1, i % ROWS_PER_PAGE);
+      handler_.insert_entry(reinterpret_cast<const char *>(&i), &rid);
+    }
+  }
+
+  ~MultiGetContext()
+  {
+    handler_.close();
+    ::remove(INDEX_FILE_NAME);
+  }
+
+private:
+  BplusTreeHandler handler_;
+};
+
+}  // namespace
+
+static void BM_SingleGet(State &state)
+{
+  MultiGetContext &context = MultiGetContext::instance();
+  mt19937 random_engine(0);
+
+  int64_t found = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    vector<int> probes = context.make_probes(state.range(0), state.range(1), random_engine);
+    state.ResumeTiming();
+
+    for (int probe : probes) {
+      list<RID> rids;
+      context.handler().get_entry(reinterpret_cast<const char *>(&probe), sizeof(probe), rids);
+      found += rids.size();
+    }
+  }
+  DoNotOptimize(found);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_MultiGet(State &state)
+{
+  MultiGetContext &context = MultiGetContext::instance();
+  mt19937 random_engine(0);
+
+  int64_t found = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    vector<int> probes = context.make_probes(state.range(0), state.range(1), random_engine);
+    vector<string> keys;
+    keys.reserve(probes.size());
+    for (int probe : probes) {
+      keys.emplace_back(reinterpret_cast<const char *>(&probe), sizeof(probe));
+    }
+    state.ResumeTiming();
+
+    vector<RID> rids;
+    context.handler().multi_get_entry(keys, rids);
+    found += rids.size();
+  }
+  DoNotOptimize(found);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_SingleGet)->ArgsProduct({{16, 256, 4096}, {1, 100}});
+BENCHMARK(BM_MultiGet)->ArgsProduct({{16, 256, 4096}, {1, 100}});
+
+BENCHMARK_MAIN();
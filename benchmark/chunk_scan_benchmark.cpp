@@ -0,0 +1,212 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// 扫描-过滤-投影查询的性能测试，比较逐行执行与按批(Chunk)执行。
+// 查询相当于 select id, name from t where v >= range(0) and score < 1000000，
+// 表中 v 均匀分布在 [0, 100) 之间，state.range(0) 控制过滤掉的比例。
+// 逐行执行的方式与按批执行之前的投影算子一样：对每一行按照投影的字段调用 find_cell。
+//
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "common/global_context.h"
+#include "common/log/log.h"
+#include "sql/expr/chunk.h"
+#include "sql/operator/predicate_physical_operator.h"
+#include "sql/operator/project_physical_operator.h"
+#include "sql/operator/table_scan_physical_operator.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/db/db.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+class ChunkScanBenchmark : public Fixture
+{
+public:
+  ChunkScanBenchmark()
+  {
+    static once_flag init_flag;
+    call_once(init_flag, []() {
+      LoggerFactory::init_default("chunk_scan_benchmark.log", LOG_LEVEL_WARN);
+      BufferPoolManager::set_instance(&bpm_);
+      if (OB_FAIL(TrxKit::init_global("vacuous"))) {
+        throw runtime_error("failed to init trx kit");
+      }
+      GCTX.trx_kit_ = TrxKit::instance();
+    });
+  }
+
+  void SetUp(const State &state) override
+  {
+    if (db_ != nullptr) {
+      return;
+    }
+
+    filesystem::remove_all(DB_DIR);
+    filesystem::create_directory(DB_DIR);
+    db_ = make_unique<Db>();
+    RC rc = db_->init("bench", DB_DIR);
+    if (OB_FAIL(rc)) {
+      throw runtime_error(string("failed to init db: ") + strrc(rc));
+    }
+
+    AttrInfoSqlNode attrs[4];
+    attrs[0].type   = INTS;
+    attrs[0].name   = "id";
+    attrs[0].length = sizeof(int);
+    attrs[1].type   = CHARS;
+    attrs[1].name   = "name";
+    attrs[1].length = 16;
+    attrs[2].type   = FLOATS;
+    attrs[2].name   = "score";
+    attrs[2].length = sizeof(float);
+    attrs[3].type   = INTS;
+    attrs[3].name   = "v";
+    attrs[3].length = sizeof(int);
+    rc = db_->create_table("t", 4, attrs);
+    if (OB_FAIL(rc)) {
+      throw runtime_error(string("failed to create table: ") + strrc(rc));
+    }
+
+    table_ = db_->find_table("t");
+    for (int i = 0; i < ROW_NUM; i++) {
+      Value values[4];
+      values[0].set_int(i);
+      values[1].set_string(("name" + to_string(i)).c_str());
+      values[2].set_float(i * 0.5f);
+      values[3].set_int((i * 37) % 100);
+
+      Record record;
+      rc = table_->make_record(4, values, record);
+      if (OB_SUCC(rc)) {
+        rc = table_->insert_record(record);
+      }
+      if (OB_FAIL(rc)) {
+        throw runtime_error(string("failed to insert record: ") + strrc(rc));
+      }
+    }
+  }
+
+  unique_ptr<PhysicalOperator> create_scan(int64_t min_v)
+  {
+    auto scan = make_unique<TableScanPhysicalOperator>(table_, true);
+    vector<unique_ptr<Expression>> predicates;
+    predicates.emplace_back(make_unique<ComparisonExpr>(
+        GREAT_EQUAL, field_expr("v"), make_unique<ValueExpr>(Value(static_cast<int>(min_v)))));
+    scan->set_predicates(std::move(predicates));
+
+    auto predicate = make_unique<PredicatePhysicalOperator>(
+        make_unique<ComparisonExpr>(LESS_THAN, field_expr("score"), make_unique<ValueExpr>(Value(1000000.0f))));
+    predicate->add_child(std::move(scan));
+    return predicate;
+  }
+
+  vector<TupleCellSpec> projections() const
+  {
+    return {TupleCellSpec(table_->name(), "id"), TupleCellSpec(table_->name(), "name")};
+  }
+
+  void add_projections(ProjectPhysicalOperator &project) const
+  {
+    project.add_projection(table_, table_->table_meta().field("id"));
+    project.add_projection(table_, table_->table_meta().field("name"));
+  }
+
+  Trx *create_trx() { return GCTX.trx_kit_->create_trx(db_->clog_manager()); }
+
+private:
+  unique_ptr<Expression> field_expr(const char *name)
+  {
+    return make_unique<FieldExpr>(table_, table_->table_meta().field(name));
+  }
+
+public:
+  static constexpr int ROW_NUM = 200000;
+
+private:
+  static constexpr const char *DB_DIR = "chunk_scan_benchmark_dir";
+
+  static BufferPoolManager bpm_;
+  static unique_ptr<Db>    db_;
+  static Table            *table_;
+};
+
+BufferPoolManager ChunkScanBenchmark::bpm_;
+unique_ptr<Db>    ChunkScanBenchmark::db_;
+Table            *ChunkScanBenchmark::table_ = nullptr;
+
+BENCHMARK_DEFINE_F(ChunkScanBenchmark, Row)(State &state)
+{
+  Trx *trx = create_trx();
+  const vector<TupleCellSpec> specs = projections();
+  int64_t rows = 0;
+  for (auto _ : state) {
+    unique_ptr<PhysicalOperator> oper = create_scan(state.range(0));
+    oper->open(trx);
+    Value value;
+    while (RC::SUCCESS == oper->next()) {
+      Tuple *tuple = oper->current_tuple();
+      for (const TupleCellSpec &spec : specs) {
+        tuple->find_cell(spec, value);
+        DoNotOptimize(value);
+      }
+      rows++;
+    }
+    oper->close();
+  }
+  GCTX.trx_kit_->destroy_trx(trx);
+
+  state.counters["rows"] = Counter(static_cast<double>(rows), Counter::kIsRate);
+  state.SetItemsProcessed(state.iterations() * ROW_NUM);
+}
+
+BENCHMARK_DEFINE_F(ChunkScanBenchmark, Chunk)(State &state)
+{
+  Trx *trx = create_trx();
+  int64_t rows = 0;
+  for (auto _ : state) {
+    ProjectPhysicalOperator project;
+    add_projections(project);
+    project.add_child(create_scan(state.range(0)));
+    project.open(trx);
+
+    Chunk chunk;
+    Value value;
+    while (RC::SUCCESS == project.next_chunk(chunk)) {
+      for (int i = 0; i < chunk.size(); i++) {
+        const int row = chunk.row_at(i);
+        for (int col = 0; col < chunk.column_num(); col++) {
+          chunk.column(col).get_value(row, value);
+          DoNotOptimize(value);
+        }
+      }
+      rows += chunk.size();
+    }
+    project.close();
+  }
+  GCTX.trx_kit_->destroy_trx(trx);
+
+  state.counters["rows"] = Counter(static_cast<double>(rows), Counter::kIsRate);
+  state.SetItemsProcessed(state.iterations() * ROW_NUM);
+}
+
+BENCHMARK_REGISTER_F(ChunkScanBenchmark, Row)->ArgName("min_v")->Arg(0)->Arg(50)->Arg(90)->Unit(kMillisecond);
+BENCHMARK_REGISTER_F(ChunkScanBenchmark, Chunk)->ArgName("min_v")->Arg(0)->Arg(50)->Arg(90)->Unit(kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,156 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// 日志写入(CLogManager)的性能测试。
+// 每次迭代是一个事务：begin、若干条 INSERT 日志、commit。
+// state.range(0) 是每条日志的数据长度，state.range(1) 是每个事务的日志条数(也就是提交的频率)，
+// state.range(2) 是提交的持久化级别(CLogDurability)，并发度是线程数。
+// 除了每秒提交的事务数和写入的字节数，还统计 commit_trx 的延迟(微秒)：p50、p99。
+//
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "common/log/log.h"
+#include "storage/clog/clog.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+class CLogBenchmark : public Fixture
+{
+public:
+  CLogBenchmark()
+  {
+    static once_flag init_log_flag;
+    call_once(init_log_flag, []() { LoggerFactory::init_default("clog_benchmark.log", LOG_LEVEL_WARN); });
+  }
+
+  void SetUp(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    filesystem::remove_all(LOG_DIR);
+    filesystem::create_directory(LOG_DIR);
+
+    log_manager_.reset(new CLogManager);
+    CLogConfig config;
+    config.durability = static_cast<CLogDurability>(state.range(2));
+    RC rc = log_manager_->init(LOG_DIR, config);
+    if (OB_FAIL(rc)) {
+      throw runtime_error(string("failed to init clog manager: ") + strrc(rc));
+    }
+
+    next_trx_id_.store(1);
+    latencies_.assign(state.threads(), vector<int64_t>());
+  }
+
+  void TearDown(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    log_manager_.reset();
+    filesystem::remove_all(LOG_DIR);
+  }
+
+  void run_trx(State &state, const vector<char> &data)
+  {
+    const int32_t trx_id = next_trx_id_.fetch_add(2);
+    const int records_per_trx = static_cast<int>(state.range(1));
+
+    RC rc = log_manager_->begin_trx(trx_id);
+    for (int i = 0; OB_SUCC(rc) && i < records_per_trx; i++) {
+      rc = log_manager_->append_log(
+          CLogType::INSERT, trx_id, 1 /*table_id*/, RID(1, i), data.size(), 0 /*offset*/, data.data());
+    }
+    if (OB_FAIL(rc)) {
+      state.SkipWithError(strrc(rc));
+      return;
+    }
+
+    auto begin = chrono::steady_clock::now();
+    rc = log_manager_->commit_trx(trx_id, trx_id + 1);
+    auto end = chrono::steady_clock::now();
+    if (OB_FAIL(rc)) {
+      state.SkipWithError(strrc(rc));
+      return;
+    }
+
+    latencies_[state.thread_index()].push_back(chrono::duration_cast<chrono::microseconds>(end - begin).count());
+  }
+
+  /**
+   * @brief 汇总所有线程的提交延迟。循环结束时所有线程都已经结束了迭代，只由0号线程统计
+   */
+  void report_latency(State &state)
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    vector<int64_t> all;
+    for (const vector<int64_t> &latencies : latencies_) {
+      all.insert(all.end(), latencies.begin(), latencies.end());
+    }
+    if (all.empty()) {
+      return;
+    }
+
+    sort(all.begin(), all.end());
+    state.counters["p50_us"] = static_cast<double>(all[all.size() * 50 / 100]);
+    state.counters["p99_us"] = static_cast<double>(all[all.size() * 99 / 100]);
+  }
+
+protected:
+  static constexpr const char *LOG_DIR = "clog_benchmark_dir";
+
+  unique_ptr<CLogManager>  log_manager_;
+  atomic<int32_t>          next_trx_id_{1};
+  vector<vector<int64_t>>  latencies_;  ///< 每个线程的提交延迟
+};
+
+BENCHMARK_DEFINE_F(CLogBenchmark, Commit)(State &state)
+{
+  vector<char> data(state.range(0), 'a');
+  const int64_t records_per_trx = state.range(1);
+
+  for (auto _ : state) {
+    run_trx(state, data);
+  }
+  report_latency(state);
+
+  state.counters["commits"] = Counter(static_cast<double>(state.iterations()), Counter::kIsRate);
+  state.SetBytesProcessed(state.iterations() * records_per_trx *
+                          (static_cast<int64_t>(data.size()) + CLogRecordData::HEADER_SIZE + sizeof(CLogRecordHeader)));
+}
+
+BENCHMARK_REGISTER_F(CLogBenchmark, Commit)
+    ->ArgNames({"record_size", "records_per_trx", "durability"})
+    ->ArgsProduct({{64, 1024},
+                   {1, 16},
+                   {static_cast<int64_t>(CLogDurability::SYNC), static_cast<int64_t>(CLogDurability::BUFFERED)}})
+    ->Threads(1)
+    ->Threads(4)
+    ->Threads(16)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,172 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// 崩溃恢复的性能测试。
+// 先准备一个数据库目录：表中的数据已经落盘，之后写入的日志(INSERT + COMMIT)没有反映到页面上，
+// 相当于写完日志以后进程崩溃。每轮测试复制一份这个目录，然后打开数据库，计时的就是重做日志的过程。
+// state.range(0) 是重做线程数(RECOVERY_THREADS)，-1表示串行重做。
+// 多个重做线程需要使用 -DCONCURRENCY=ON 编译，否则只会使用一个重做线程。
+//
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "common/global_context.h"
+#include "common/conf/ini.h"
+#include "common/log/log.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/clog/clog.h"
+#include "storage/db/db.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+namespace {
+
+const char *BASE_DIR   = "clog_recovery_bench_base";
+const char *WORK_DIR   = "clog_recovery_bench_work";
+const char *TABLE_NAME = "t";
+const int   FIELD_NUM  = 4;
+const int   TRX_NUM    = 1000;
+const int   ROWS_PER_TRX = 100;
+
+BufferPoolManager bpm;
+
+/**
+ * @brief 准备需要恢复的数据库目录，所有测试共用
+ */
+class RecoveryContext
+{
+public:
+  static RecoveryContext &instance()
+  {
+    static RecoveryContext context;
+    return context;
+  }
+
+  int64_t record_num() const { return static_cast<int64_t>(TRX_NUM) * (ROWS_PER_TRX + 2); }
+
+private:
+  RecoveryContext()
+  {
+    LoggerFactory::init_default("clog_recovery_benchmark.log", LOG_LEVEL_WARN);
+    BufferPoolManager::set_instance(&bpm);
+    if (TrxKit::init_global("mvcc") != RC::SUCCESS) {
+      throw runtime_error("failed to init trx kit");
+    }
+    GCTX.trx_kit_ = TrxKit::instance();
+
+    // 不自动做检查点，否则恢复起点会越过这些日志
+    get_properties()->put("CHECKPOINT_INTERVAL", "0", "CLOG");
+
+    filesystem::remove_all(BASE_DIR);
+    filesystem::create_directory(BASE_DIR);
+
+    Db db;
+    check(db.init("bench", BASE_DIR), "failed to init db");
+
+    vector<AttrInfoSqlNode> attrs(FIELD_NUM);
+    for (int i = 0; i < FIELD_NUM; i++) {
+      attrs[i].type   = INTS;
+      attrs[i].name   = "f" + to_string(i);
+      attrs[i].length = sizeof(int);
+    }
+    check(db.create_table(TABLE_NAME, FIELD_NUM, attrs.data()), "failed to create table");
+    Table *table = db.find_table(TABLE_NAME);
+
+    // 先插入数据并落盘，日志中的插入会覆盖这些记录
+    vector<Value> values(FIELD_NUM);
+    vector<RID> rids;
+    for (int i = 0; i < TRX_NUM * ROWS_PER_TRX; i++) {
+      for (int f = 0; f < FIELD_NUM; f++) {
+        values[f].set_int(i);
+      }
+      Record record;
+      check(table->make_record(FIELD_NUM, values.data(), record), "failed to make record");
+      check(table->insert_record(record), "failed to insert record");
+      rids.push_back(record.rid());
+    }
+    check(db.sync(), "failed to sync db");
+
+    // 插入日志的数据与 MvccTrx 插入的记录一样，begin xid 是负的事务号
+    const TableMeta &table_meta = table->table_meta();
+    const FieldMeta *trx_fields = table_meta.trx_fields().first;
+    vector<char> data(table_meta.record_size());
+    CLogManager *clog_manager = db.clog_manager();
+    int32_t trx_id = 1;
+    for (int t = 0; t < TRX_NUM; t++, trx_id += 2) {
+      check(clog_manager->begin_trx(trx_id), "failed to begin trx");
+      for (int r = 0; r < ROWS_PER_TRX; r++) {
+        const RID &rid = rids[t * ROWS_PER_TRX + r];
+        memset(data.data(), r, data.size());
+        const int32_t begin_xid = -trx_id;
+        const int32_t end_xid   = numeric_limits<int32_t>::max();
+        memcpy(data.data() + trx_fields[0].offset(), &begin_xid, sizeof(begin_xid));
+        memcpy(data.data() + trx_fields[1].offset(), &end_xid, sizeof(end_xid));
+        check(clog_manager->append_log(
+                  CLogType::INSERT, trx_id, table->table_id(), rid, data.size(), 0 /*offset*/, data.data()),
+            "failed to append log");
+      }
+      check(clog_manager->commit_trx(trx_id, trx_id + 1), "failed to commit trx");
+    }
+    // 这些日志只写入了日志文件，没有修改页面，Db 关闭时页面仍然是 sync 时的状态
+  }
+
+  ~RecoveryContext()
+  {
+    filesystem::remove_all(BASE_DIR);
+    filesystem::remove_all(WORK_DIR);
+  }
+
+  static void check(RC rc, const char *message)
+  {
+    if (rc != RC::SUCCESS) {
+      throw runtime_error(string(message) + ": " + strrc(rc));
+    }
+  }
+};
+
+}  // namespace
+
+static void BM_Recover(State &state)
+{
+  RecoveryContext &context = RecoveryContext::instance();
+  get_properties()->put("RECOVERY_THREADS", to_string(state.range(0)), "CLOG");
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    filesystem::remove_all(WORK_DIR);
+    filesystem::copy(BASE_DIR, WORK_DIR, filesystem::copy_options::recursive);
+    Db *db = new Db;
+    state.ResumeTiming();
+
+    RC rc = db->init("bench", WORK_DIR);
+
+    state.PauseTiming();
+    if (rc != RC::SUCCESS) {
+      state.SkipWithError(strrc(rc));
+    }
+    delete db;
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * context.record_num());
+}
+
+BENCHMARK(BM_Recover)->Arg(-1)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
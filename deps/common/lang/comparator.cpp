@@ -23,7 +23,8 @@ int compare_int(void *arg1, void *arg2)
 {
   int v1 = *(int *)arg1;
   int v2 = *(int *)arg2;
-  return v1 - v2;
+  // 不能直接相减，INT_MIN - INT_MAX 这样的差会溢出
+  return (v1 > v2) - (v1 < v2);
 }
 
 int compare_float(void *arg1, void *arg2)
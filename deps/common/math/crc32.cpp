@@ -0,0 +1,50 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "common/math/crc32.h"
+
+namespace common {
+
+namespace {
+
+/**
+ * @brief CRC32C 的查找表，多项式是 0x82F63B78(反转形式)
+ */
+struct Crc32cTable
+{
+  uint32_t values[256];
+
+  Crc32cTable()
+  {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78 : (crc >> 1);
+      }
+      values[i] = crc;
+    }
+  }
+};
+
+const Crc32cTable crc32c_table;
+
+}  // namespace
+
+uint32_t crc32c(uint32_t crc, const void *data, size_t len)
+{
+  const uint8_t *p = static_cast<const uint8_t *>(data);
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc = crc32c_table.values[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+}  // namespace common
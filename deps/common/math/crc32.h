@@ -0,0 +1,25 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace common {
+
+/**
+ * @brief 计算 CRC32C(Castagnoli) 校验和
+ * @details 查表实现，每次处理一个字节。可以分多次计算：把上一次的结果作为 crc 传入
+ * @param crc 之前计算的结果，第一次计算时传0
+ */
+uint32_t crc32c(uint32_t crc, const void *data, size_t len);
+
+}  // namespace common
@@ -59,6 +59,9 @@ See the Mulan PSL v2 for more details. */
   DEFINE_RC(LOCKED_UNLOCK)                  \
   DEFINE_RC(LOCKED_NEED_WAIT)               \
   DEFINE_RC(LOCKED_CONCURRENCY_CONFLICT)    \
+  DEFINE_RC(LOCKED_WAIT_TIMEOUT)            \
+  DEFINE_RC(LOCKED_DEADLOCK)                \
+  DEFINE_RC(TRX_READ_ONLY)                  \
   DEFINE_RC(FILE_EXIST)                     \
   DEFINE_RC(FILE_NOT_EXIST)                 \
   DEFINE_RC(FILE_NAME)                      \
@@ -71,6 +74,7 @@ See the Mulan PSL v2 for more details. */
   DEFINE_RC(FILE_SEEK)                      \
   DEFINE_RC(FILE_READ)                      \
   DEFINE_RC(FILE_WRITE)                     \
+  DEFINE_RC(FILE_VERSION_MISMATCH)          \
   DEFINE_RC(VARIABLE_NOT_EXISTS)            \
   DEFINE_RC(VARIABLE_NOT_VALID)             \
   DEFINE_RC(LOGBUF_FULL)
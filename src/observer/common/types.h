@@ -24,4 +24,5 @@ using PageNum = int32_t;
 using SlotNum = int32_t;
 
 /// LSN for log sequence number
-using LSN = int32_t;
+/// LSN是日志在日志流中的字节偏移量，会一直增长，所以使用64位整数
+using LSN = int64_t;
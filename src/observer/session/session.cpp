@@ -24,7 +24,8 @@ Session &Session::default_session()
   return session;
 }
 
-Session::Session(const Session &other) : db_(other.db_)
+Session::Session(const Session &other)
+    : db_(other.db_), durability_(other.durability_), lock_wait_timeout_ms_(other.lock_wait_timeout_ms_)
 {}
 
 Session::~Session()
@@ -76,6 +77,8 @@ Trx *Session::current_trx()
   if (trx_ == nullptr) {
     trx_ = GCTX.trx_kit_->create_trx(db_->clog_manager());
   }
+  trx_->set_durability(durability_);
+  trx_->set_lock_wait_timeout_ms(lock_wait_timeout_ms_);
   return trx_;
 }
 
@@ -16,6 +16,8 @@ See the Mulan PSL v2 for more details. */
 
 #include <string>
 
+#include "storage/clog/clog.h"
+
 class Trx;
 class Db;
 class SessionEvent;
@@ -79,6 +81,20 @@ public:
   void set_sql_debug(bool sql_debug) { sql_debug_ = sql_debug; }
   bool sql_debug_on() const { return sql_debug_; }
 
+  /**
+   * @brief 当前会话提交事务时日志的持久化级别
+   * @details DEFAULT 表示使用服务器的设置
+   */
+  void           set_durability(CLogDurability durability) { durability_ = durability; }
+  CLogDurability durability() const { return durability_; }
+
+  /**
+   * @brief 当前会话等待行锁的超时时间(毫秒)
+   * @details 小于0表示使用服务器的设置
+   */
+  void set_lock_wait_timeout_ms(int timeout_ms) { lock_wait_timeout_ms_ = timeout_ms; }
+  int  lock_wait_timeout_ms() const { return lock_wait_timeout_ms_; }
+
   /**
    * @brief 将指定会话设置到线程变量中
    * 
@@ -97,4 +113,6 @@ private:
   SessionEvent *current_request_ = nullptr; ///< 当前正在处理的请求
   bool trx_multi_operation_mode_ = false;   ///< 当前事务的模式，是否多语句模式. 单语句模式自动提交
   bool sql_debug_ = false;                  ///< 是否输出SQL调试信息
+  CLogDurability durability_ = CLogDurability::DEFAULT; ///< 提交事务时日志的持久化级别
+  int lock_wait_timeout_ms_ = -1;                       ///< 等待行锁的超时时间
 };
@@ -31,5 +31,7 @@ RC CreateIndexExecutor::execute(SQLStageEvent *sql_event)
   
   Trx *trx = session->current_trx();
   Table *table = create_index_stmt->table();
-  return table->create_index(trx, create_index_stmt->field_meta(), create_index_stmt->index_name().c_str(), create_index_stmt->is_unique());
+  return table->create_index(trx, create_index_stmt->field_meta(), create_index_stmt->index_name().c_str(),
+                             create_index_stmt->is_unique(), create_index_stmt->index_type(),
+                             create_index_stmt->prefix_compression());
 }
\ No newline at end of file
@@ -25,6 +25,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/stmt/stmt.h"
 #include "sql/stmt/select_stmt.h"
 #include "storage/default/default_handler.h"
+#include "storage/trx/trx.h"
 #include "sql/executor/command_executor.h"
 #include "sql/operator/calc_physical_operator.h"
 
@@ -64,6 +65,7 @@ RC ExecuteStage::handle_request_with_physical_operator(SQLStageEvent *sql_event)
 
   // TODO 这里也可以优化一下，是否可以让physical operator自己设置tuple schema
   TupleSchema schema;
+  bool read_only = true;  // 不修改数据的语句
   switch (stmt->type()) {
     case StmtType::SELECT: {
       SelectStmt *select_stmt = static_cast<SelectStmt *>(stmt);
@@ -90,9 +92,20 @@ RC ExecuteStage::handle_request_with_physical_operator(SQLStageEvent *sql_event)
     } break;
     default: {
       // 只有select返回结果
+      read_only = false;
     } break;
   }
 
+  // 自动提交的查询使用只读事务，不分配事务号也不写日志
+  Session *session = sql_event->session_event()->session();
+  if (read_only && !session->is_trx_multi_operation_mode()) {
+    rc = session->current_trx()->set_read_only(true);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to set read only mode of trx. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
   SqlResult *sql_result = sql_event->session_event()->sql_result();
   sql_result->set_tuple_schema(schema);
   sql_result->set_operator(std::move(physical_operator));
@@ -21,10 +21,18 @@ See the Mulan PSL v2 for more details. */
 #include "sql/executor/sql_result.h"
 #include "session/session.h"
 #include "sql/stmt/set_variable_stmt.h"
+#include "storage/db/db.h"
+#include "storage/clog/clog.h"
+#include "event/sql_debug.h"
 
 /**
  * @brief SetVariable语句执行器
  * @ingroup Executor
+ * @details 支持的变量：
+ * - sql_debug: 是否输出SQL调试信息
+ * - durability: 当前会话提交事务时日志的持久化级别，sync/async/buffered，default表示使用服务器的设置
+ * - global_durability: 服务器默认的持久化级别，对没有设置 durability 的会话生效
+ * - lock_wait_timeout_ms: 当前会话等待行锁的超时时间(毫秒)，0表示不等待，负数表示使用服务器的设置
  */
 class SetVariableExecutor
 {
@@ -49,14 +57,61 @@ public:
 
       session->set_sql_debug(bool_value);
       LOG_TRACE("set sql_debug to %d", bool_value);
+    } else if (strcasecmp(var_name, "durability") == 0) {
+      CLogDurability durability = CLogDurability::DEFAULT;
+      rc = var_value_to_durability(var_value, durability);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+
+      session->set_durability(durability);
+      LOG_TRACE("set session durability to %s", clog_durability_name(durability));
+    } else if (strcasecmp(var_name, "global_durability") == 0) {
+      CLogDurability durability = CLogDurability::DEFAULT;
+      rc = var_value_to_durability(var_value, durability);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+
+      Db *db = session->get_current_db();
+      if (db == nullptr || db->clog_manager() == nullptr) {
+        return RC::INTERNAL;
+      }
+      db->clog_manager()->set_default_durability(durability);
+    } else if (strcasecmp(var_name, "lock_wait_timeout_ms") == 0) {
+      if (var_value.attr_type() != AttrType::INTS) {
+        return RC::VARIABLE_NOT_VALID;
+      }
+
+      session->set_lock_wait_timeout_ms(var_value.get_int());
+      LOG_TRACE("set session lock wait timeout to %d ms", var_value.get_int());
     } else {
       rc = RC::VARIABLE_NOT_EXISTS;
     }
 
-    return RC::SUCCESS;
+    if (rc == RC::SUCCESS && strcasestr(var_name, "durability") != nullptr) {
+      Db *db = session->get_current_db();
+      if (db != nullptr && db->clog_manager() != nullptr) {
+        sql_debug("session durability: %s, %s",
+            clog_durability_name(session->durability()), db->clog_manager()->durability_status().c_str());
+      }
+    }
+    return rc;
   }
 
 private:
+  RC var_value_to_durability(const Value &var_value, CLogDurability &durability) const
+  {
+    if (var_value.attr_type() != AttrType::CHARS) {
+      return RC::VARIABLE_NOT_VALID;
+    }
+
+    if (!clog_durability_from_string(var_value.get_string().c_str(), durability)) {
+      return RC::VARIABLE_NOT_VALID;
+    }
+    return RC::SUCCESS;
+  }
+
   RC var_value_to_boolean(const Value &var_value, bool &bool_value) const
   {
     RC rc = RC::SUCCESS;
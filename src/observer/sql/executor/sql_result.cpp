@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "common/rc.h"
+#include "common/global_context.h"
 #include "sql/executor/sql_result.h"
 #include "session/session.h"
 #include "storage/trx/trx.h"
@@ -32,6 +33,9 @@ RC SqlResult::open()
     return RC::INVALID_ARGUMENT;
   }
 
+  // 上一条语句已经结束，没有持有页面，可以改写之前提交的事务修改的记录
+  GCTX.trx_kit_->resolve_commits_if_needed();
+
   Trx *trx = session_->current_trx();
   trx->start_if_need();
   return operator_->open(trx);
@@ -20,6 +20,7 @@ See the Mulan PSL v2 for more details. */
 #include "event/session_event.h"
 #include "sql/executor/sql_result.h"
 #include "session/session.h"
+#include "sql/stmt/trx_begin_stmt.h"
 #include "storage/trx/trx.h"
 
 /**
@@ -38,7 +39,16 @@ public:
 
     Session *session = session_event->session();
     Trx *trx = session->current_trx();
-
+    TrxBeginStmt *stmt = static_cast<TrxBeginStmt *>(sql_event->stmt());
+
+    // 已经在事务中时 BEGIN 不会开始新的事务
+    if (!session->is_trx_multi_operation_mode()) {
+      RC rc = trx->set_read_only(stmt->read_only());
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to set read only mode of trx. rc=%s", strrc(rc));
+        return rc;
+      }
+    }
     session->set_trx_multi_operation_mode(true);
 
     return trx->start_if_need();
@@ -21,6 +21,8 @@ See the Mulan PSL v2 for more details. */
 #include "session/session.h"
 #include "storage/trx/trx.h"
 #include "sql/stmt/stmt.h"
+#include "storage/db/db.h"
+#include "event/sql_debug.h"
 
 /**
  * @brief 事务结束的执行器，可以是提交或回滚
@@ -42,7 +44,13 @@ public:
     Trx *trx = session->current_trx();
 
     if (stmt->type() == StmtType::COMMIT) {
-      return trx->commit();
+      RC rc = trx->commit();
+      Db *db = session->get_current_db();
+      if (session->sql_debug_on() && db != nullptr && db->clog_manager() != nullptr) {
+        sql_debug("commit durability: %s, %s",
+            clog_durability_name(session->durability()), db->clog_manager()->durability_status().c_str());
+      }
+      return rc;
     }
     else {
       return trx->rollback();
@@ -0,0 +1,248 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+#include <algorithm>
+
+#include "sql/expr/chunk.h"
+
+using namespace std;
+
+Column::Column(AttrType attr_type, int attr_len, int capacity)
+{
+  init(attr_type, attr_len, capacity);
+}
+
+void Column::init(AttrType attr_type, int attr_len, int capacity)
+{
+  attr_type_ = attr_type;
+  attr_len_  = attr_len;
+  count_     = 0;
+  capacity_  = capacity;
+  constant_  = false;
+  own_data_.reset(new char[static_cast<size_t>(attr_len) * capacity]());
+  data_ = own_data_.get();
+}
+
+void Column::reference(const Column &other)
+{
+  attr_type_ = other.attr_type_;
+  attr_len_  = other.attr_len_;
+  count_     = other.count_;
+  capacity_  = other.capacity_;
+  constant_  = other.constant_;
+  own_data_.reset();
+  data_ = other.data_;
+}
+
+void Column::set_constant(const Value &value)
+{
+  const int attr_len = value.attr_type() == CHARS ? max(value.length(), 1) : static_cast<int>(sizeof(int32_t));
+  init(value.attr_type(), attr_len, 1);
+  set_value(0, value);
+  count_    = 1;
+  constant_ = true;
+}
+
+void Column::append(const char *data)
+{
+  memcpy(data_ + static_cast<size_t>(count_) * attr_len_, data, attr_len_);
+  count_++;
+}
+
+void Column::append(const Column &other, int index, int num)
+{
+  if (other.attr_len_ == attr_len_ && !other.constant_) {
+    memcpy(data_ + static_cast<size_t>(count_) * attr_len_, other.data_at(index), static_cast<size_t>(num) * attr_len_);
+    count_ += num;
+    return;
+  }
+
+  if (other.attr_len_ > attr_len_) {
+    widen(other.attr_len_);
+  }
+  for (int i = 0; i < num; i++) {
+    char *dest = data_ + static_cast<size_t>(count_) * attr_len_;
+    memcpy(dest, other.data_at(index + i), other.attr_len_);
+    memset(dest + other.attr_len_, 0, attr_len_ - other.attr_len_);
+    count_++;
+  }
+}
+
+void Column::append_repeat(const Column &other, int index, int num)
+{
+  if (other.attr_len_ > attr_len_) {
+    widen(other.attr_len_);
+  }
+
+  const char *src = other.data_at(index);
+  if (attr_len_ == sizeof(int32_t) && other.attr_len_ == sizeof(int32_t)) {
+    int32_t value = 0;
+    memcpy(&value, src, sizeof(value));
+    int32_t *dest = values<int32_t>() + count_;
+    fill(dest, dest + num, value);
+    count_ += num;
+    return;
+  }
+
+  for (int i = 0; i < num; i++) {
+    char *dest = data_ + static_cast<size_t>(count_) * attr_len_;
+    memcpy(dest, src, other.attr_len_);
+    memset(dest + other.attr_len_, 0, attr_len_ - other.attr_len_);
+    count_++;
+  }
+}
+
+RC Column::set_value(int index, const Value &value)
+{
+  if (index < 0 || index >= capacity_) {
+    LOG_WARN("invalid row index. index=%d, capacity=%d", index, capacity_);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  char *dest = data_ + static_cast<size_t>(index) * attr_len_;
+  switch (attr_type_) {
+    case INTS: {
+      const int32_t int_value = value.get_int();
+      memcpy(dest, &int_value, sizeof(int_value));
+    } break;
+    case FLOATS: {
+      const float float_value = value.get_float();
+      memcpy(dest, &float_value, sizeof(float_value));
+    } break;
+    case BOOLEANS: {
+      const int32_t bool_value = value.get_boolean() ? 1 : 0;
+      memcpy(dest, &bool_value, sizeof(bool_value));
+    } break;
+    case CHARS: {
+      const string str = value.get_string();
+      if (static_cast<int>(str.size()) > attr_len_) {
+        if (own_data_ == nullptr) {
+          LOG_WARN("cannot widen a referenced column. len=%d, attr_len=%d", static_cast<int>(str.size()), attr_len_);
+          return RC::INTERNAL;
+        }
+        widen(static_cast<int>(str.size()));
+        dest = data_ + static_cast<size_t>(index) * attr_len_;
+      }
+      memcpy(dest, str.data(), str.size());
+      memset(dest + str.size(), 0, attr_len_ - str.size());
+    } break;
+    default: {
+      LOG_WARN("unsupported attr type: %d", attr_type_);
+      return RC::INTERNAL;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+void Column::get_value(int index, Value &value) const
+{
+  value.set_type(attr_type_);
+  value.set_data(data_at(index), attr_len_);
+}
+
+void Column::widen(int attr_len)
+{
+  unique_ptr<char[]> new_data(new char[static_cast<size_t>(attr_len) * capacity_]());
+  const int rows = constant_ ? 1 : capacity_;
+  for (int i = 0; i < rows; i++) {
+    memcpy(new_data.get() + static_cast<size_t>(i) * attr_len, data_ + static_cast<size_t>(i) * attr_len_, attr_len_);
+  }
+  own_data_ = std::move(new_data);
+  data_     = own_data_.get();
+  attr_len_ = attr_len;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int Chunk::add_column(unique_ptr<Column> column, const TupleCellSpec &spec)
+{
+  columns_.emplace_back(std::move(column));
+  specs_.push_back(spec);
+  return static_cast<int>(columns_.size()) - 1;
+}
+
+int Chunk::find_column(const char *table_name, const char *field_name) const
+{
+  for (size_t i = 0; i < specs_.size(); i++) {
+    if (0 == strcmp(specs_[i].table_name(), table_name) && 0 == strcmp(specs_[i].field_name(), field_name)) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+void Chunk::filter(const Column &bools)
+{
+  const int32_t *values = bools.values<int32_t>();
+  const int      stride = bools.stride();
+  const int      size   = this->size();
+
+  int selected = 0;
+  if (!has_selection_) {
+    selection_.resize(rows_);
+    for (int i = 0; i < size; i++) {
+      selection_[selected] = i;
+      selected += (values[i * stride] != 0);
+    }
+  } else {
+    for (int i = 0; i < size; i++) {
+      const int row = selection_[i];
+      selection_[selected] = row;
+      selected += (values[row * stride] != 0);
+    }
+  }
+  selection_.resize(selected);
+  has_selection_ = true;
+}
+
+void Chunk::set_selection(const Chunk &other)
+{
+  has_selection_ = other.has_selection_;
+  selection_     = other.selection_;
+}
+
+void Chunk::reset()
+{
+  for (unique_ptr<Column> &column : columns_) {
+    column->reset();
+  }
+  rows_          = 0;
+  has_selection_ = false;
+  selection_.clear();
+}
+
+void Chunk::clear()
+{
+  columns_.clear();
+  specs_.clear();
+  rows_          = 0;
+  has_selection_ = false;
+  selection_.clear();
+}
+
+void Chunk::copy_from(const Chunk &other)
+{
+  clear();
+  const int size = other.size();
+  for (int i = 0; i < other.column_num(); i++) {
+    const Column &src = other.column(i);
+    auto column = make_unique<Column>(src.attr_type(), src.attr_len(), max(size, 1));
+    if (!other.has_selection_) {
+      column->append(src, 0, size);
+    } else {
+      for (int row : other.selection_) {
+        column->append(src, row, 1);
+      }
+    }
+    add_column(std::move(column), other.spec(i));
+  }
+  rows_ = size;
+}
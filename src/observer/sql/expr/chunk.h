@@ -0,0 +1,251 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "common/rc.h"
+#include "sql/expr/tuple.h"
+#include "sql/expr/tuple_cell.h"
+#include "sql/parser/value.h"
+
+/**
+ * @brief 一批数据中的一列
+ * @ingroup Tuple
+ * @details 每一行占用 attr_len 个字节，按行号连续存放。INTS、FLOATS、BOOLEANS 都是4个字节，CHARS 是定长的，
+ * 不足的部分补0。
+ * 列可以引用另一列的数据而不复制(比如投影)，被引用的数据只在产生它的算子下一次调用 next_chunk 之前有效。
+ * 常量列只保存一个值，所有的行都使用这个值。
+ */
+class Column
+{
+public:
+  Column() = default;
+  Column(AttrType attr_type, int attr_len, int capacity);
+
+  /**
+   * @brief 分配空间，清空原来的数据
+   */
+  void init(AttrType attr_type, int attr_len, int capacity);
+
+  /**
+   * @brief 引用另一列的数据
+   */
+  void reference(const Column &other);
+
+  /**
+   * @brief 设置为常量列
+   */
+  void set_constant(const Value &value);
+
+  AttrType attr_type() const { return attr_type_; }
+  int      attr_len() const { return attr_len_; }
+  int      count() const { return count_; }
+  int      capacity() const { return capacity_; }
+  bool     is_constant() const { return constant_; }
+
+  /**
+   * @brief 访问第 index 行的步长。常量列是0，这样计算时不需要区分常量
+   */
+  int stride() const { return constant_ ? 0 : 1; }
+
+  void set_count(int count) { count_ = count; }
+  void reset() { count_ = 0; }
+
+  char       *data() { return data_; }
+  const char *data() const { return data_; }
+  const char *data_at(int index) const { return data_ + static_cast<size_t>(index) * stride() * attr_len_; }
+
+  template <typename T>
+  T *values()
+  {
+    return reinterpret_cast<T *>(data_);
+  }
+  template <typename T>
+  const T *values() const
+  {
+    return reinterpret_cast<const T *>(data_);
+  }
+
+  /**
+   * @brief 在最后追加一行，data 是 attr_len 个字节
+   */
+  void append(const char *data);
+
+  /**
+   * @brief 追加另一列中从 index 开始的 num 行
+   * @details 两列的长度可以不同，比如逐行转换过来的字符串列
+   */
+  void append(const Column &other, int index, int num);
+
+  /**
+   * @brief 把另一列的第 index 行重复追加 num 次
+   */
+  void append_repeat(const Column &other, int index, int num);
+
+  /**
+   * @brief 写入第 index 行
+   * @details 字符串比列的长度长时会加宽这一列，只有数据属于这一列时才可以加宽
+   */
+  RC set_value(int index, const Value &value);
+
+  void get_value(int index, Value &value) const;
+
+private:
+  /**
+   * @brief 修改每一行的长度，原来的数据补0
+   */
+  void widen(int attr_len);
+
+private:
+  AttrType                attr_type_ = UNDEFINED;
+  int                     attr_len_  = 0;
+  int                     count_     = 0;
+  int                     capacity_  = 0;
+  bool                    constant_  = false;
+  char                   *data_      = nullptr;  ///< 指向 own_data_ 或者被引用的列
+  std::unique_ptr<char[]> own_data_;
+};
+
+/**
+ * @brief 列存的一批数据
+ * @ingroup Tuple
+ * @details 向量化执行时算子之间每次传递一批行(最多 MAX_ROWS 行)，每一列的数据连续存放，用类型确定的循环处理，
+ * 避免逐行执行时每个值都要经过虚函数和 Value 转换。
+ * 过滤不移动数据，而是修改选择向量(selection)，记录哪些行还有效。没有选择向量时所有的行都有效。
+ * 列的布局由产生数据的算子决定：调用方第一次传入空的 Chunk，之后重复传入同一个对象。
+ */
+class Chunk
+{
+public:
+  static constexpr int MAX_ROWS = 1024;
+
+public:
+  Chunk() = default;
+  Chunk(const Chunk &) = delete;
+  Chunk &operator=(const Chunk &) = delete;
+
+  int column_num() const { return static_cast<int>(columns_.size()); }
+
+  Column       &column(int index) { return *columns_[index]; }
+  const Column &column(int index) const { return *columns_[index]; }
+
+  const TupleCellSpec &spec(int index) const { return specs_[index]; }
+
+  /**
+   * @brief 增加一列，返回列的位置
+   */
+  int add_column(std::unique_ptr<Column> column, const TupleCellSpec &spec);
+
+  /**
+   * @brief 按照表名和字段名查找列
+   * @return 列的位置，找不到时返回-1
+   */
+  int find_column(const char *table_name, const char *field_name) const;
+
+  /**
+   * @brief 数据的行数，包括被过滤掉的行
+   */
+  int  rows() const { return rows_; }
+  void set_rows(int rows) { rows_ = rows; }
+
+  /**
+   * @brief 有效的行数
+   */
+  int size() const { return has_selection_ ? static_cast<int>(selection_.size()) : rows_; }
+
+  /**
+   * @brief 第 i 个有效行的行号
+   */
+  int row_at(int i) const { return has_selection_ ? selection_[i] : i; }
+
+  /**
+   * @brief 按照 BOOLEANS 类型的列过滤，只保留值为 true 的行
+   */
+  void filter(const Column &bools);
+
+  /**
+   * @brief 使用另一个 Chunk 的选择向量
+   */
+  void set_selection(const Chunk &other);
+
+  /**
+   * @brief 清空数据和选择向量，保留列的定义
+   */
+  void reset();
+
+  /**
+   * @brief 删除所有的列
+   */
+  void clear();
+
+  /**
+   * @brief 把 other 中有效的行复制过来，复制以后没有选择向量
+   * @details 引用其它列的数据在产生它的算子下次调用 next_chunk 以后就失效，需要保留的数据要复制出来
+   */
+  void copy_from(const Chunk &other);
+
+private:
+  std::vector<std::unique_ptr<Column>> columns_;
+  std::vector<TupleCellSpec>           specs_;
+  int                                  rows_          = 0;
+  bool                                 has_selection_ = false;
+  std::vector<int>                     selection_;
+};
+
+/**
+ * @brief 一批数据中的一行，用于把向量化的结果交给逐行处理的代码
+ * @ingroup Tuple
+ */
+class ChunkTuple : public Tuple
+{
+public:
+  ChunkTuple() = default;
+  virtual ~ChunkTuple() = default;
+
+  void set_chunk(const Chunk *chunk) { chunk_ = chunk; }
+  void set_row(int row) { row_ = row; }
+
+  int cell_num() const override { return chunk_->column_num(); }
+
+  RC cell_at(int index, Value &cell) const override
+  {
+    if (index < 0 || index >= chunk_->column_num()) {
+      LOG_WARN("invalid argument. index=%d", index);
+      return RC::INVALID_ARGUMENT;
+    }
+    chunk_->column(index).get_value(row_, cell);
+    return RC::SUCCESS;
+  }
+
+  RC find_cell(const TupleCellSpec &spec, Value &cell) const override
+  {
+    const int index = chunk_->find_column(spec.table_name(), spec.field_name());
+    if (index < 0) {
+      return RC::NOTFOUND;
+    }
+    return cell_at(index, cell);
+  }
+
+  RC spec_at(int index, TupleCellSpec &spec) const override
+  {
+    if (index < 0 || index >= chunk_->column_num()) {
+      return RC::NOTFOUND;
+    }
+    spec = chunk_->spec(index);
+    return RC::SUCCESS;
+  }
+
+private:
+  const Chunk *chunk_ = nullptr;
+  int          row_   = 0;
+};
@@ -12,22 +12,100 @@ See the Mulan PSL v2 for more details. */
 // Created by Wangyunlai on 2022/07/05.
 //
 
+#include <algorithm>
+#include <type_traits>
+
+#include "sql/expr/chunk.h"
 #include "sql/expr/expression.h"
 #include "sql/expr/tuple.h"
 
 using namespace std;
 
+namespace {
+
+/**
+ * @brief 初始化保存计算结果的列，每个有效的行都会写入
+ */
+void init_result_column(const Chunk &chunk, AttrType type, Column &column)
+{
+  // 字符串的长度事先不知道，写入时再加宽
+  const int attr_len = (type == CHARS) ? 1 : static_cast<int>(sizeof(int32_t));
+  column.init(type, attr_len, max(chunk.rows(), 1));
+  column.set_count(chunk.rows());
+}
+
+bool is_number(AttrType type) { return type == INTS || type == FLOATS; }
+
+/**
+ * @brief 与 Value::compare 的结果一致，浮点数的差在 EPSILON 以内认为相等
+ */
+template <typename L, typename R>
+inline int compare_number(L left, R right)
+{
+  if constexpr (is_same_v<L, int32_t> && is_same_v<R, int32_t>) {
+    return (left > right) - (left < right);
+  } else {
+    const float cmp = static_cast<float>(left) - static_cast<float>(right);
+    return (cmp > EPSILON) - (cmp < -EPSILON);
+  }
+}
+
+}  // namespace
+
+RC Expression::get_column(Chunk &chunk, Column &column) const
+{
+  init_result_column(chunk, value_type(), column);
+
+  ChunkTuple tuple;
+  tuple.set_chunk(&chunk);
+  Value value;
+  const int size = chunk.size();
+  for (int i = 0; i < size; i++) {
+    const int row = chunk.row_at(i);
+    tuple.set_row(row);
+    RC rc = get_value(tuple, value);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    rc = column.set_value(row, value);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 RC FieldExpr::get_value(const Tuple &tuple, Value &value) const
 {
   return tuple.find_cell(TupleCellSpec(table_name(), field_name()), value);
 }
 
+RC FieldExpr::get_column(Chunk &chunk, Column &column) const
+{
+  const int index = chunk.find_column(table_name(), field_name());
+  if (index < 0) {
+    LOG_WARN("no such column in chunk. table=%s, field=%s", table_name(), field_name());
+    return RC::NOTFOUND;
+  }
+
+  column.reference(chunk.column(index));
+  return RC::SUCCESS;
+}
+
 RC ValueExpr::get_value(const Tuple &tuple, Value &value) const
 {
   value = value_;
   return RC::SUCCESS;
 }
 
+RC ValueExpr::get_column(Chunk &chunk, Column &column) const
+{
+  column.set_constant(value_);
+  return RC::SUCCESS;
+}
+
 /////////////////////////////////////////////////////////////////////////////////
 CastExpr::CastExpr(unique_ptr<Expression> child, AttrType cast_type)
     : child_(std::move(child)), cast_type_(cast_type)
@@ -164,6 +242,86 @@ RC ComparisonExpr::get_value(const Tuple &tuple, Value &value) const
   return rc;
 }
 
+template <typename L, typename R>
+void ComparisonExpr::compare_column(const Chunk &chunk, const Column &left, const Column &right, Column &result) const
+{
+  const L  *left_values   = left.values<L>();
+  const R  *right_values  = right.values<R>();
+  const int left_stride   = left.stride();
+  const int right_stride  = right.stride();
+  int32_t  *result_values = result.values<int32_t>();
+  const int size          = chunk.size();
+
+  auto compare = [&](auto op) {
+    for (int i = 0; i < size; i++) {
+      const int row      = chunk.row_at(i);
+      result_values[row] = op(compare_number(left_values[row * left_stride], right_values[row * right_stride]));
+    }
+  };
+
+  switch (comp_) {
+    case EQUAL_TO: compare([](int cmp) { return cmp == 0; }); break;
+    case LESS_EQUAL: compare([](int cmp) { return cmp <= 0; }); break;
+    case NOT_EQUAL: compare([](int cmp) { return cmp != 0; }); break;
+    case LESS_THAN: compare([](int cmp) { return cmp < 0; }); break;
+    case GREAT_EQUAL: compare([](int cmp) { return cmp >= 0; }); break;
+    case GREAT_THAN: compare([](int cmp) { return cmp > 0; }); break;
+    default: break;
+  }
+}
+
+RC ComparisonExpr::get_column(Chunk &chunk, Column &column) const
+{
+  Column left_column;
+  Column right_column;
+  RC rc = left_->get_column(chunk, left_column);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to get column of left expression. rc=%s", strrc(rc));
+    return rc;
+  }
+  rc = right_->get_column(chunk, right_column);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to get column of right expression. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  if (comp_ > GREAT_THAN) {
+    LOG_WARN("unsupported comparison. %d", comp_);
+    return RC::INTERNAL;
+  }
+
+  init_result_column(chunk, BOOLEANS, column);
+
+  const AttrType left_type  = left_column.attr_type();
+  const AttrType right_type = right_column.attr_type();
+  if (left_type == INTS && right_type == INTS) {
+    compare_column<int32_t, int32_t>(chunk, left_column, right_column, column);
+  } else if (left_type == INTS && right_type == FLOATS) {
+    compare_column<int32_t, float>(chunk, left_column, right_column, column);
+  } else if (left_type == FLOATS && right_type == INTS) {
+    compare_column<float, int32_t>(chunk, left_column, right_column, column);
+  } else if (left_type == FLOATS && right_type == FLOATS) {
+    compare_column<float, float>(chunk, left_column, right_column, column);
+  } else {
+    Value left_value;
+    Value right_value;
+    int32_t *result_values = column.values<int32_t>();
+    const int size = chunk.size();
+    for (int i = 0; i < size; i++) {
+      const int row = chunk.row_at(i);
+      left_column.get_value(row, left_value);
+      right_column.get_value(row, right_value);
+      bool bool_value = false;
+      rc = compare_value(left_value, right_value, bool_value);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      result_values[row] = bool_value ? 1 : 0;
+    }
+  }
+  return RC::SUCCESS;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ConjunctionExpr::ConjunctionExpr(Type type, vector<unique_ptr<Expression>> &children)
     : conjunction_type_(type), children_(std::move(children))
@@ -196,6 +354,44 @@ RC ConjunctionExpr::get_value(const Tuple &tuple, Value &value) const
   return rc;
 }
 
+RC ConjunctionExpr::get_column(Chunk &chunk, Column &column) const
+{
+  init_result_column(chunk, BOOLEANS, column);
+
+  int32_t  *result_values = column.values<int32_t>();
+  const int size          = chunk.size();
+  const bool is_and       = (conjunction_type_ == Type::AND);
+  for (int i = 0; i < size; i++) {
+    result_values[chunk.row_at(i)] = (is_and || children_.empty()) ? 1 : 0;
+  }
+
+  Column child_column;
+  Value  value;
+  for (const unique_ptr<Expression> &expr : children_) {
+    RC rc = expr->get_column(chunk, child_column);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to get column by child expression. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    const bool     is_bool      = (child_column.attr_type() == BOOLEANS);
+    const int32_t *child_values = child_column.values<int32_t>();
+    const int      child_stride = child_column.stride();
+    for (int i = 0; i < size; i++) {
+      const int row = chunk.row_at(i);
+      bool bool_value = false;
+      if (is_bool) {
+        bool_value = child_values[row * child_stride] != 0;
+      } else {
+        child_column.get_value(row, value);
+        bool_value = value.get_boolean();
+      }
+      result_values[row] = is_and ? (result_values[row] & bool_value) : (result_values[row] | bool_value);
+    }
+  }
+  return RC::SUCCESS;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 ArithmeticExpr::ArithmeticExpr(ArithmeticExpr::Type type, Expression *left, Expression *right)
@@ -327,4 +523,99 @@ RC ArithmeticExpr::try_get_value(Value &value) const
   }
 
   return calc_value(left_value, right_value, value);
-}
\ No newline at end of file
+}
+
+template <typename T, typename L, typename R>
+void ArithmeticExpr::calc_column(const Chunk &chunk, const Column &left, const Column &right, Column &result) const
+{
+  const L  *left_values   = left.values<L>();
+  const R  *right_values  = right.values<R>();
+  const int left_stride   = left.stride();
+  const int right_stride  = right.stride();
+  T        *result_values = result.values<T>();
+  const int size          = chunk.size();
+
+  auto calc = [&](auto op) {
+    for (int i = 0; i < size; i++) {
+      const int row      = chunk.row_at(i);
+      result_values[row] = op(static_cast<T>(left_values[row * left_stride]),
+                              static_cast<T>(right_values[row * right_stride]));
+    }
+  };
+
+  switch (arithmetic_type_) {
+    case Type::ADD: calc([](T l, T r) { return l + r; }); break;
+    case Type::SUB: calc([](T l, T r) { return l - r; }); break;
+    case Type::MUL: calc([](T l, T r) { return l * r; }); break;
+    case Type::DIV: {
+      // 与 calc_value 一样，除数为0时设置为最大值
+      if constexpr (is_same_v<T, int32_t>) {
+        calc([](T l, T r) { return r == 0 ? numeric_limits<T>::max() : l / r; });
+      } else {
+        calc([](T l, T r) { return (r > -EPSILON && r < EPSILON) ? numeric_limits<T>::max() : l / r; });
+      }
+    } break;
+    case Type::NEGATIVE: calc([](T l, T) { return -l; }); break;
+  }
+}
+
+RC ArithmeticExpr::get_column(Chunk &chunk, Column &column) const
+{
+  Column left_column;
+  Column right_column;
+  RC rc = left_->get_column(chunk, left_column);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to get column of left expression. rc=%s", strrc(rc));
+    return rc;
+  }
+  if (right_) {
+    rc = right_->get_column(chunk, right_column);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to get column of right expression. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  const AttrType target_type = value_type();
+  init_result_column(chunk, target_type, column);
+
+  // 一元运算没有右边的列，用左边的列占位
+  const Column  &right      = right_ ? right_column : left_column;
+  const AttrType left_type  = left_column.attr_type();
+  const AttrType right_type = right.attr_type();
+  if (is_number(left_type) && is_number(right_type) && is_number(target_type)) {
+    if (target_type == INTS && left_type == INTS && right_type == INTS) {
+      calc_column<int32_t, int32_t, int32_t>(chunk, left_column, right, column);
+    } else if (target_type == FLOATS && left_type == INTS && right_type == INTS) {
+      calc_column<float, int32_t, int32_t>(chunk, left_column, right, column);
+    } else if (target_type == FLOATS && left_type == INTS) {
+      calc_column<float, int32_t, float>(chunk, left_column, right, column);
+    } else if (target_type == FLOATS && right_type == INTS) {
+      calc_column<float, float, int32_t>(chunk, left_column, right, column);
+    } else if (target_type == FLOATS) {
+      calc_column<float, float, float>(chunk, left_column, right, column);
+    } else {
+      return Expression::get_column(chunk, column);
+    }
+    return RC::SUCCESS;
+  }
+
+  Value left_value;
+  Value right_value;
+  Value value;
+  const int size = chunk.size();
+  for (int i = 0; i < size; i++) {
+    const int row = chunk.row_at(i);
+    left_column.get_value(row, left_value);
+    right.get_value(row, right_value);
+    rc = calc_value(left_value, right_value, value);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    rc = column.set_value(row, value);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
@@ -23,6 +23,8 @@ See the Mulan PSL v2 for more details. */
 #include "common/log/log.h"
 
 class Tuple;
+class Chunk;
+class Column;
 
 /**
  * @defgroup Expression
@@ -76,6 +78,13 @@ public:
     return RC::UNIMPLENMENT;
   }
 
+  /**
+   * @brief 在一批数据上计算表达式的值
+   * @details 只计算 chunk 中有效的行，结果写到 column 中与行号对应的位置。
+   * 默认实现逐行调用 get_value，能够按列计算的表达式需要重载这个函数。
+   */
+  virtual RC get_column(Chunk &chunk, Column &column) const;
+
   /**
    * @brief 表达式的类型
    * 可以根据表达式类型来转换为具体的子类
@@ -125,6 +134,7 @@ public:
   const char *field_name() const { return field_.field_name(); }
 
   RC get_value(const Tuple &tuple, Value &value) const override;
+  RC get_column(Chunk &chunk, Column &column) const override;
 
 private:
   Field field_;
@@ -145,6 +155,7 @@ public:
 
   RC get_value(const Tuple &tuple, Value &value) const override;
   RC try_get_value(Value &value) const override { value = value_; return RC::SUCCESS; }
+  RC get_column(Chunk &chunk, Column &column) const override;
 
   ExprType type() const override { return ExprType::VALUE; }
 
@@ -201,6 +212,7 @@ public:
   ExprType type() const override { return ExprType::COMPARISON; }
 
   RC get_value(const Tuple &tuple, Value &value) const override;
+  RC get_column(Chunk &chunk, Column &column) const override;
 
   AttrType value_type() const override { return BOOLEANS; }
 
@@ -221,6 +233,13 @@ public:
    */
   RC compare_value(const Value &left, const Value &right, bool &value) const;
 
+private:
+  /**
+   * @brief 按列比较两个数值类型的列
+   */
+  template <typename L, typename R>
+  void compare_column(const Chunk &chunk, const Column &left, const Column &right, Column &result) const;
+
 private:
   CompOp comp_;
   std::unique_ptr<Expression> left_;
@@ -250,6 +269,7 @@ public:
   AttrType value_type() const override { return BOOLEANS; }
 
   RC get_value(const Tuple &tuple, Value &value) const override;
+  RC get_column(Chunk &chunk, Column &column) const override;
 
   Type conjunction_type() const { return conjunction_type_; }
 
@@ -286,6 +306,7 @@ public:
 
   RC get_value(const Tuple &tuple, Value &value) const override;
   RC try_get_value(Value &value) const override;
+  RC get_column(Chunk &chunk, Column &column) const override;
 
   Type arithmetic_type() const { return arithmetic_type_; }
 
@@ -294,7 +315,13 @@ public:
 
 private:
   RC calc_value(const Value &left_value, const Value &right_value, Value &value) const;
-  
+
+  /**
+   * @brief 按列计算两个数值类型的列，T 是结果的类型
+   */
+  template <typename T, typename L, typename R>
+  void calc_column(const Chunk &chunk, const Column &left, const Column &right, Column &result) const;
+
 private:
   Type arithmetic_type_;
   std::unique_ptr<Expression> left_;
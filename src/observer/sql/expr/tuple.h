@@ -108,6 +108,12 @@ public:
    */
   virtual RC find_cell(const TupleCellSpec &spec, Value &cell) const = 0;
 
+  /**
+   * @brief 获取指定位置的Cell的描述
+   * @details 把逐行的数据转换成列存的 Chunk 时，用它确定每一列的名字
+   */
+  virtual RC spec_at(int index, TupleCellSpec &spec) const = 0;
+
   virtual std::string to_string() const
   {
     std::string str;
@@ -196,17 +202,16 @@ public:
     return RC::NOTFOUND;
   }
 
-#if 0
-  RC cell_spec_at(int index, const TupleCellSpec *&spec) const override
+  RC spec_at(int index, TupleCellSpec &spec) const override
   {
     if (index < 0 || index >= static_cast<int>(speces_.size())) {
       LOG_WARN("invalid argument. index=%d", index);
       return RC::INVALID_ARGUMENT;
     }
-    spec = speces_[index];
+    const Field &field = speces_[index]->field();
+    spec = TupleCellSpec(field.table_name(), field.field_name());
     return RC::SUCCESS;
   }
-#endif
 
   Record &record()
   {
@@ -275,16 +280,15 @@ public:
     return tuple_->find_cell(spec, cell);
   }
 
-#if 0
-  RC cell_spec_at(int index, const TupleCellSpec *&spec) const override
+  RC spec_at(int index, TupleCellSpec &spec) const override
   {
     if (index < 0 || index >= static_cast<int>(speces_.size())) {
       return RC::NOTFOUND;
     }
-    spec = speces_[index];
+    spec = *speces_[index];
     return RC::SUCCESS;
   }
-#endif
+
 private:
   std::vector<TupleCellSpec *> speces_;
   Tuple *tuple_ = nullptr;
@@ -327,6 +331,15 @@ public:
     return RC::NOTFOUND;
   }
 
+  RC spec_at(int index, TupleCellSpec &spec) const override
+  {
+    if (index < 0 || index >= static_cast<int>(expressions_.size())) {
+      return RC::NOTFOUND;
+    }
+    spec = TupleCellSpec(expressions_[index]->name().c_str());
+    return RC::SUCCESS;
+  }
+
 
 private:
   const std::vector<std::unique_ptr<Expression>> &expressions_;
@@ -367,6 +380,16 @@ public:
     return RC::INTERNAL;
   }
 
+  virtual RC spec_at(int index, TupleCellSpec &spec) const override
+  {
+    if (index < 0 || index >= cell_num()) {
+      return RC::NOTFOUND;
+    }
+
+    spec = TupleCellSpec(cells_[index].to_string().c_str());
+    return RC::SUCCESS;
+  }
+
 private:
   std::vector<Value> cells_;
 };
@@ -399,7 +422,7 @@ public:
   RC cell_at(int index, Value &value) const override
   {
     const int left_cell_num = left_->cell_num();
-    if (index > 0 && index < left_cell_num) {
+    if (index >= 0 && index < left_cell_num) {
       return left_->cell_at(index, value);
     }
 
@@ -420,6 +443,20 @@ public:
     return right_->find_cell(spec, value);
   }
 
+  RC spec_at(int index, TupleCellSpec &spec) const override
+  {
+    const int left_cell_num = left_->cell_num();
+    if (index >= 0 && index < left_cell_num) {
+      return left_->spec_at(index, spec);
+    }
+
+    if (index >= left_cell_num && index < left_cell_num + right_->cell_num()) {
+      return right_->spec_at(index - left_cell_num, spec);
+    }
+
+    return RC::NOTFOUND;
+  }
+
 private:
   Tuple *left_ = nullptr;
   Tuple *right_ = nullptr;
@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "sql/operator/physical_operator.h"
 #include "sql/expr/tuple.h"
+#include "sql/expr/chunk.h"
 
 class CalcPhysicalOperator : public PhysicalOperator
 {
@@ -72,6 +73,32 @@ public:
     return &tuple_;
   }
 
+  /**
+   * @brief 计算出只有一行的一批数据，每个表达式是一列
+   */
+  RC next_chunk(Chunk &chunk) override
+  {
+    if (emitted_) {
+      return RC::RECORD_EOF;
+    }
+    emitted_ = true;
+
+    // 表达式不引用任何字段，在一个没有列的单行批次上计算
+    Chunk input;
+    input.set_rows(1);
+    chunk.clear();
+    chunk.set_rows(1);
+    for (const std::unique_ptr<Expression> &expr : expressions_) {
+      auto column = std::make_unique<Column>();
+      RC rc = expr->get_column(input, *column);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+      chunk.add_column(std::move(column), TupleCellSpec(expr->name().c_str()));
+    }
+    return RC::SUCCESS;
+  }
+
   const std::vector<std::unique_ptr<Expression>> &expressions() const
   {
     return expressions_;
@@ -0,0 +1,719 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include <string_view>
+
+#include "common/conf/ini.h"
+#include "common/lang/string.h"
+#include "common/log/log.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/hash_join_physical_operator.h"
+
+using namespace std;
+using namespace common;
+
+static const char *SQL_SECTION = "SQL";
+
+HashJoinConfig HashJoinConfig::from_properties()
+{
+  HashJoinConfig config;
+  Ini *properties = get_properties();
+  if (nullptr == properties) {
+    return config;
+  }
+
+  int64_t value = 0;
+  string str = properties->get("HASH_JOIN_MEMORY_LIMIT", "", SQL_SECTION);
+  if (!str.empty() && str_to_val(str, value) && value > 0) {
+    config.memory_limit = value;
+  }
+  return config;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/**
+ * @brief 64位整数的混合函数(murmur3 的 fmix64)，让输入的每一位都影响低位的桶号和高位的分区号
+ */
+inline uint64_t mix(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+/**
+ * @brief 分区号使用哈希值的高位，桶号使用低位，这样同一个分区中的行仍然均匀分布在各个桶中
+ */
+inline int partition_of(uint64_t hash, int partition_num) { return static_cast<int>((hash >> 56) % partition_num); }
+
+string_view chars_of(const Column &column, int row)
+{
+  const char *data = column.data_at(row);
+  return string_view(data, strnlen(data, column.attr_len()));
+}
+
+/**
+ * @brief 记录一批数据的列，不复制数据
+ */
+void copy_schema(const Chunk &chunk, Chunk &schema)
+{
+  for (int i = 0; i < chunk.column_num(); i++) {
+    const Column &column = chunk.column(i);
+    schema.add_column(make_unique<Column>(column.attr_type(), column.attr_len(), 1), chunk.spec(i));
+  }
+}
+
+string key_name(const Expression &expr)
+{
+  if (expr.type() == ExprType::FIELD) {
+    const auto &field_expr = static_cast<const FieldExpr &>(expr);
+    return string(field_expr.table_name()) + "." + field_expr.field_name();
+  }
+  return expr.name();
+}
+
+}  // namespace
+
+RC JoinHashTable::add(const Chunk &chunk, const vector<unique_ptr<Expression>> &keys)
+{
+  if (chunk.size() == 0) {
+    return RC::SUCCESS;
+  }
+
+  auto copied = make_unique<Chunk>();
+  copied->copy_from(chunk);
+
+  vector<Column> key_columns(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    RC rc = keys[i]->get_column(*copied, key_columns[i]);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get key column. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  const int rows = copied->rows();
+  const size_t base = chunks_.size() * Chunk::MAX_ROWS;
+  hashes_.resize(base + Chunk::MAX_ROWS);
+  for (int i = 0; i < rows; i++) {
+    hashes_[base + i] = hash_keys(key_columns, i);
+  }
+
+  for (int i = 0; i < copied->column_num(); i++) {
+    memory_size_ += static_cast<int64_t>(copied->column(i).attr_len()) * rows;
+  }
+  memory_size_ += static_cast<int64_t>(sizeof(uint64_t) + sizeof(uint32_t)) * Chunk::MAX_ROWS;
+
+  chunks_.emplace_back(std::move(copied));
+  keys_.emplace_back(std::move(key_columns));
+  row_num_ += rows;
+  return RC::SUCCESS;
+}
+
+void JoinHashTable::build()
+{
+  size_t bucket_num = 16;
+  while (bucket_num < static_cast<size_t>(row_num_)) {
+    bucket_num <<= 1;
+  }
+  mask_ = bucket_num - 1;
+  buckets_.assign(bucket_num, NIL);
+  next_.assign(hashes_.size(), NIL);
+  memory_size_ += static_cast<int64_t>(sizeof(uint32_t) * bucket_num);
+
+  // 倒序插入链表头部，这样同一个键的行按照输入的顺序返回
+  for (size_t i = chunks_.size(); i-- > 0;) {
+    const uint32_t base = static_cast<uint32_t>(i * Chunk::MAX_ROWS);
+    for (int row = chunks_[i]->rows() - 1; row >= 0; row--) {
+      const uint32_t row_id = base + row;
+      uint32_t &bucket = buckets_[hashes_[row_id] & mask_];
+      next_[row_id] = bucket;
+      bucket = row_id;
+    }
+  }
+}
+
+void JoinHashTable::clear()
+{
+  chunks_.clear();
+  keys_.clear();
+  hashes_.clear();
+  buckets_.clear();
+  next_.clear();
+  mask_        = 0;
+  row_num_     = 0;
+  memory_size_ = 0;
+}
+
+uint32_t JoinHashTable::first(uint64_t hash) const
+{
+  if (buckets_.empty()) {
+    return NIL;
+  }
+  return buckets_[hash & mask_];
+}
+
+uint64_t JoinHashTable::hash_keys(const vector<Column> &keys, int row)
+{
+  uint64_t hash = 0;
+  for (const Column &key : keys) {
+    uint64_t key_hash = 0;
+    switch (key.attr_type()) {
+      case INTS:
+      case BOOLEANS: {
+        int32_t value = 0;
+        memcpy(&value, key.data_at(row), sizeof(value));
+        key_hash = static_cast<uint32_t>(value);
+      } break;
+      case CHARS: {
+        key_hash = std::hash<string_view>()(chars_of(key, row));
+      } break;
+      default: {
+        key_hash = std::hash<string_view>()(string_view(key.data_at(row), key.attr_len()));
+      } break;
+    }
+    hash = mix(hash * 31 + key_hash);
+  }
+  return hash;
+}
+
+bool JoinHashTable::keys_equal(const vector<Column> &left, int left_row, const vector<Column> &right, int right_row)
+{
+  for (size_t i = 0; i < left.size(); i++) {
+    const Column &left_key  = left[i];
+    const Column &right_key = right[i];
+    if (left_key.attr_type() == CHARS && right_key.attr_type() == CHARS) {
+      if (chars_of(left_key, left_row) != chars_of(right_key, right_row)) {
+        return false;
+      }
+    } else if (left_key.attr_len() == right_key.attr_len() && left_key.attr_type() == right_key.attr_type()) {
+      if (0 != memcmp(left_key.data_at(left_row), right_key.data_at(right_row), left_key.attr_len())) {
+        return false;
+      }
+    } else {
+      Value left_value;
+      Value right_value;
+      left_key.get_value(left_row, left_value);
+      right_key.get_value(right_row, right_value);
+      if (0 != left_value.compare(right_value)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+HashJoinPhysicalOperator::HashJoinPhysicalOperator(vector<unique_ptr<Expression>> &&left_keys,
+    vector<unique_ptr<Expression>> &&right_keys, bool build_left, int64_t memory_limit)
+    : left_keys_(std::move(left_keys)),
+      right_keys_(std::move(right_keys)),
+      build_left_(build_left),
+      memory_limit_(memory_limit)
+{}
+
+HashJoinPhysicalOperator::~HashJoinPhysicalOperator()
+{
+  close_spill_files(build_files_);
+  close_spill_files(probe_files_);
+}
+
+string HashJoinPhysicalOperator::param() const
+{
+  string str;
+  for (size_t i = 0; i < left_keys_.size(); i++) {
+    if (i > 0) {
+      str += " AND ";
+    }
+    str += key_name(*left_keys_[i]) + "=" + key_name(*right_keys_[i]);
+  }
+  str += build_left_ ? ", BUILD LEFT" : ", BUILD RIGHT";
+  return str;
+}
+
+RC HashJoinPhysicalOperator::open(Trx *trx)
+{
+  if (children_.size() != 2) {
+    LOG_WARN("hash join operator should have 2 children");
+    return RC::INTERNAL;
+  }
+
+  RC rc = children_[0]->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open left child. rc=%s", strrc(rc));
+    return rc;
+  }
+  rc = children_[1]->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open right child. rc=%s", strrc(rc));
+    children_[0]->close();
+    return rc;
+  }
+
+  trx_ = trx;
+  hash_table_.clear();
+  built_        = false;
+  spilled_      = false;
+  partition_    = -1;
+  spilled_rows_ = 0;
+  build_schema_.clear();
+  probe_schema_.clear();
+  probe_chunk_.clear();
+  probe_key_columns_.clear();
+  probe_index_ = 0;
+  match_       = JoinHashTable::NIL;
+  chunk_.clear();
+  row_ = 0;
+  tuple_.set_chunk(&chunk_);
+  return RC::SUCCESS;
+}
+
+RC HashJoinPhysicalOperator::next()
+{
+  if (partition_ >= PARTITION_NUM) {
+    return RC::RECORD_EOF;
+  }
+  if (row_ + 1 < chunk_.size()) {
+    row_++;
+    return RC::SUCCESS;
+  }
+
+  RC rc = next_chunk(chunk_);
+  if (rc != RC::SUCCESS) {
+    chunk_.reset();
+  }
+  row_ = 0;
+  return rc;
+}
+
+RC HashJoinPhysicalOperator::close()
+{
+  if (spilled_) {
+    LOG_INFO("hash join spilled to %d partitions. spilled rows=%ld, memory limit=%ld",
+             PARTITION_NUM, spilled_rows_, memory_limit_);
+  }
+  close_spill_files(build_files_);
+  close_spill_files(probe_files_);
+  hash_table_.clear();
+  probe_chunk_.clear();
+  probe_key_columns_.clear();
+
+  RC rc = RC::SUCCESS;
+  for (unique_ptr<PhysicalOperator> &child : children_) {
+    RC child_rc = child->close();
+    if (OB_FAIL(child_rc)) {
+      LOG_WARN("failed to close child. rc=%s", strrc(child_rc));
+      rc = child_rc;
+    }
+  }
+  return rc;
+}
+
+Tuple *HashJoinPhysicalOperator::current_tuple()
+{
+  tuple_.set_row(chunk_.row_at(row_));
+  return &tuple_;
+}
+
+RC HashJoinPhysicalOperator::build()
+{
+  RC rc = RC::SUCCESS;
+  Chunk chunk;
+  while (RC::SUCCESS == (rc = build_child()->next_chunk(chunk))) {
+    if (build_schema_.column_num() == 0) {
+      copy_schema(chunk, build_schema_);
+    }
+
+    if (spilled_) {
+      rc = spill(build_files_, chunk, build_keys());
+    } else {
+      rc = hash_table_.add(chunk, build_keys());
+      if (OB_SUCC(rc) && hash_table_.memory_size() > memory_limit_) {
+        LOG_INFO("hash join exceeds memory limit, start to spill. rows=%ld, memory=%ld, limit=%ld",
+                 hash_table_.row_num(), hash_table_.memory_size(), memory_limit_);
+        spilled_ = true;
+        for (const unique_ptr<Chunk> &built_chunk : hash_table_.chunks()) {
+          rc = spill(build_files_, *built_chunk, build_keys());
+          if (OB_FAIL(rc)) {
+            break;
+          }
+        }
+        hash_table_.clear();
+      }
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to build hash table. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to read build side. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  built_ = true;
+  if (!spilled_) {
+    hash_table_.build();
+    return RC::SUCCESS;
+  }
+
+  rc = flush_spill_files(build_files_);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  // Chunk 的列由产生数据的算子决定，探测端使用另外一个 Chunk
+  Chunk probe_chunk;
+  while (RC::SUCCESS == (rc = probe_child()->next_chunk(probe_chunk))) {
+    if (probe_schema_.column_num() == 0) {
+      copy_schema(probe_chunk, probe_schema_);
+    }
+    rc = spill(probe_files_, probe_chunk, probe_keys());
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to read probe side. rc=%s", strrc(rc));
+    return rc;
+  }
+  return flush_spill_files(probe_files_);
+}
+
+RC HashJoinPhysicalOperator::spill(SpillFiles &spill_files, const Chunk &chunk, const vector<unique_ptr<Expression>> &keys)
+{
+  // 键表达式需要可以修改的 Chunk，复制一份同时去掉选择向量
+  Chunk copied;
+  copied.copy_from(chunk);
+
+  vector<Column> key_columns(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    RC rc = keys[i]->get_column(copied, key_columns[i]);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get key column. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  for (int row = 0; row < copied.rows(); row++) {
+    const int partition = partition_of(JoinHashTable::hash_keys(key_columns, row), PARTITION_NUM);
+    unique_ptr<Chunk> &buffer = spill_files.buffers[partition];
+    if (buffer == nullptr) {
+      buffer = make_unique<Chunk>();
+      for (int i = 0; i < copied.column_num(); i++) {
+        const Column &column = copied.column(i);
+        buffer->add_column(make_unique<Column>(column.attr_type(), column.attr_len(), Chunk::MAX_ROWS), copied.spec(i));
+      }
+    }
+
+    for (int i = 0; i < copied.column_num(); i++) {
+      buffer->column(i).append(copied.column(i), row, 1);
+    }
+    buffer->set_rows(buffer->rows() + 1);
+    spilled_rows_++;
+
+    if (buffer->rows() >= Chunk::MAX_ROWS) {
+      RC rc = flush_spill_files(spill_files);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC HashJoinPhysicalOperator::flush_spill_files(SpillFiles &spill_files)
+{
+  for (int partition = 0; partition < PARTITION_NUM; partition++) {
+    Chunk *buffer = spill_files.buffers[partition].get();
+    if (buffer == nullptr || buffer->rows() == 0) {
+      continue;
+    }
+
+    FILE *&file = spill_files.files[partition];
+    if (file == nullptr) {
+      file = tmpfile();
+      if (file == nullptr) {
+        LOG_WARN("failed to create temporary file for hash join. error=%s", strerror(errno));
+        return RC::IOERR_OPEN;
+      }
+    }
+
+    // 每一批数据：行数，列数，每一列的类型和长度，然后是每一列的数据
+    const int32_t header[2] = {buffer->rows(), buffer->column_num()};
+    bool ok = fwrite(header, sizeof(header), 1, file) == 1;
+    for (int i = 0; ok && i < buffer->column_num(); i++) {
+      const Column &column = buffer->column(i);
+      const int32_t column_header[2] = {static_cast<int32_t>(column.attr_type()), column.attr_len()};
+      ok = fwrite(column_header, sizeof(column_header), 1, file) == 1;
+    }
+    for (int i = 0; ok && i < buffer->column_num(); i++) {
+      const Column &column = buffer->column(i);
+      ok = fwrite(column.data(), static_cast<size_t>(column.attr_len()) * buffer->rows(), 1, file) == 1;
+    }
+    if (!ok) {
+      LOG_WARN("failed to write hash join partition. partition=%d, error=%s", partition, strerror(errno));
+      return RC::IOERR_WRITE;
+    }
+    buffer->reset();
+  }
+  return RC::SUCCESS;
+}
+
+RC HashJoinPhysicalOperator::read_spilled_chunk(FILE *file, const Chunk &schema, Chunk &chunk)
+{
+  int32_t header[2] = {0, 0};
+  if (fread(header, sizeof(header), 1, file) != 1) {
+    if (feof(file)) {
+      return RC::RECORD_EOF;
+    }
+    LOG_WARN("failed to read hash join partition. error=%s", strerror(errno));
+    return RC::IOERR_READ;
+  }
+
+  const int rows = header[0];
+  const int column_num = header[1];
+  if (column_num != schema.column_num() || rows <= 0 || rows > Chunk::MAX_ROWS) {
+    LOG_WARN("invalid hash join partition block. rows=%d, columns=%d", rows, column_num);
+    return RC::INTERNAL;
+  }
+
+  chunk.clear();
+  for (int i = 0; i < column_num; i++) {
+    int32_t column_header[2] = {0, 0};
+    if (fread(column_header, sizeof(column_header), 1, file) != 1) {
+      LOG_WARN("failed to read hash join partition. error=%s", strerror(errno));
+      return RC::IOERR_READ;
+    }
+    chunk.add_column(make_unique<Column>(static_cast<AttrType>(column_header[0]), column_header[1], rows), schema.spec(i));
+  }
+  for (int i = 0; i < column_num; i++) {
+    Column &column = chunk.column(i);
+    if (fread(column.data(), static_cast<size_t>(column.attr_len()) * rows, 1, file) != 1) {
+      LOG_WARN("failed to read hash join partition. error=%s", strerror(errno));
+      return RC::IOERR_READ;
+    }
+    column.set_count(rows);
+  }
+  chunk.set_rows(rows);
+  return RC::SUCCESS;
+}
+
+void HashJoinPhysicalOperator::close_spill_files(SpillFiles &spill_files)
+{
+  for (int i = 0; i < PARTITION_NUM; i++) {
+    if (spill_files.files[i] != nullptr) {
+      fclose(spill_files.files[i]);
+      spill_files.files[i] = nullptr;
+    }
+    spill_files.buffers[i].reset();
+  }
+}
+
+RC HashJoinPhysicalOperator::next_partition()
+{
+  probe_chunk_.clear();
+  probe_key_columns_.clear();
+  probe_index_ = 0;
+  match_       = JoinHashTable::NIL;
+
+  while (++partition_ < PARTITION_NUM) {
+    hash_table_.clear();
+    FILE *build_file = build_files_.files[partition_];
+    FILE *probe_file = probe_files_.files[partition_];
+    if (build_file == nullptr || probe_file == nullptr) {
+      continue;
+    }
+
+    rewind(build_file);
+    rewind(probe_file);
+
+    RC rc = RC::SUCCESS;
+    Chunk chunk;
+    while (RC::SUCCESS == (rc = read_spilled_chunk(build_file, build_schema_, chunk))) {
+      rc = hash_table_.add(chunk, build_keys());
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+    if (rc != RC::RECORD_EOF) {
+      return rc;
+    }
+
+    if (hash_table_.memory_size() > memory_limit_) {
+      LOG_WARN("hash join partition still exceeds memory limit. partition=%d, rows=%ld, memory=%ld, limit=%ld",
+               partition_, hash_table_.row_num(), hash_table_.memory_size(), memory_limit_);
+    }
+    hash_table_.build();
+    return RC::SUCCESS;
+  }
+
+  hash_table_.clear();
+  return RC::RECORD_EOF;
+}
+
+RC HashJoinPhysicalOperator::next_probe_chunk()
+{
+  if (partition_ >= PARTITION_NUM) {
+    return RC::RECORD_EOF;
+  }
+  RC rc = RC::SUCCESS;
+  if (spilled_) {
+    rc = read_spilled_chunk(probe_files_.files[partition_], probe_schema_, probe_chunk_);
+  } else {
+    rc = probe_child()->next_chunk(probe_chunk_);
+    if (OB_SUCC(rc) && probe_schema_.column_num() == 0) {
+      copy_schema(probe_chunk_, probe_schema_);
+    }
+  }
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  const vector<unique_ptr<Expression>> &keys = probe_keys();
+  probe_key_columns_.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    rc = keys[i]->get_column(probe_chunk_, probe_key_columns_[i]);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get key column. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  probe_hashes_.resize(probe_chunk_.rows());
+  const int size = probe_chunk_.size();
+  for (int i = 0; i < size; i++) {
+    const int row = probe_chunk_.row_at(i);
+    probe_hashes_[row] = JoinHashTable::hash_keys(probe_key_columns_, row);
+  }
+
+  probe_index_ = 0;
+  start_probe_row();
+  return RC::SUCCESS;
+}
+
+void HashJoinPhysicalOperator::start_probe_row()
+{
+  match_ = JoinHashTable::NIL;
+  if (probe_index_ < probe_chunk_.size()) {
+    match_ = hash_table_.first(probe_hashes_[probe_chunk_.row_at(probe_index_)]);
+  }
+}
+
+void HashJoinPhysicalOperator::init_output(Chunk &chunk)
+{
+  const Chunk &left  = build_left_ ? build_schema_ : probe_schema_;
+  const Chunk &right = build_left_ ? probe_schema_ : build_schema_;
+  for (const Chunk *schema : {&left, &right}) {
+    for (int i = 0; i < schema->column_num(); i++) {
+      const Column &column = schema->column(i);
+      chunk.add_column(make_unique<Column>(column.attr_type(), column.attr_len(), Chunk::MAX_ROWS), schema->spec(i));
+    }
+  }
+}
+
+RC HashJoinPhysicalOperator::next_chunk(Chunk &chunk)
+{
+  if (partition_ >= PARTITION_NUM) {
+    // 所有的分区都已经处理完，不能再用 partition_ 访问溢出文件
+    return RC::RECORD_EOF;
+  }
+  RC rc = RC::SUCCESS;
+  if (!built_) {
+    rc = build();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    if (spilled_) {
+      rc = next_partition();
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+    }
+  }
+  if (!spilled_ && hash_table_.empty()) {
+    // 构建端没有数据，不需要读取探测端
+    return RC::RECORD_EOF;
+  }
+
+  probe_rows_.clear();
+  build_ids_.clear();
+  while (static_cast<int>(probe_rows_.size()) < Chunk::MAX_ROWS) {
+    if (probe_index_ >= probe_chunk_.size()) {
+      // 输出引用了当前探测的数据，先输出再读取下一批
+      if (!probe_rows_.empty()) {
+        break;
+      }
+
+      rc = next_probe_chunk();
+      if (rc == RC::RECORD_EOF && spilled_) {
+        rc = next_partition();
+      }
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      continue;
+    }
+
+    const int      probe_row  = probe_chunk_.row_at(probe_index_);
+    const uint64_t probe_hash = probe_hashes_[probe_row];
+    while (match_ != JoinHashTable::NIL && static_cast<int>(probe_rows_.size()) < Chunk::MAX_ROWS) {
+      if (hash_table_.hash_of(match_) == probe_hash &&
+          JoinHashTable::keys_equal(
+              hash_table_.keys_of(match_), JoinHashTable::row_of(match_), probe_key_columns_, probe_row)) {
+        probe_rows_.push_back(probe_row);
+        build_ids_.push_back(match_);
+      }
+      match_ = hash_table_.next(match_);
+    }
+
+    if (match_ == JoinHashTable::NIL) {
+      probe_index_++;
+      start_probe_row();
+    }
+  }
+
+  if (chunk.column_num() == 0) {
+    init_output(chunk);
+  }
+  chunk.reset();
+
+  const int num = static_cast<int>(probe_rows_.size());
+  const int left_column_num = build_left_ ? build_schema_.column_num() : probe_schema_.column_num();
+  const int build_offset = build_left_ ? 0 : left_column_num;
+  const int probe_offset = build_left_ ? left_column_num : 0;
+  for (int i = 0; i < probe_chunk_.column_num(); i++) {
+    Column &column = chunk.column(probe_offset + i);
+    const Column &src = probe_chunk_.column(i);
+    for (int k = 0; k < num; k++) {
+      column.append(src, probe_rows_[k], 1);
+    }
+  }
+  for (int i = 0; i < build_schema_.column_num(); i++) {
+    Column &column = chunk.column(build_offset + i);
+    for (int k = 0; k < num; k++) {
+      const uint32_t build_id = build_ids_[k];
+      column.append(hash_table_.chunk_of(build_id).column(i), JoinHashTable::row_of(build_id), 1);
+    }
+  }
+  chunk.set_rows(num);
+  return RC::SUCCESS;
+}
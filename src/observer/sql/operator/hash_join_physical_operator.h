@@ -0,0 +1,216 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <memory>
+#include <vector>
+
+#include "sql/expr/chunk.h"
+#include "sql/operator/physical_operator.h"
+
+/**
+ * @brief 哈希连接的配置
+ * @ingroup PhysicalOperator
+ * @details 在配置文件的 [SQL] 中设置
+ */
+struct HashJoinConfig
+{
+  int64_t memory_limit = 64 * 1024 * 1024;  ///< HASH_JOIN_MEMORY_LIMIT 哈希表最多使用的内存(字节)，超过以后分区写到临时文件
+
+  /**
+   * @brief 从配置文件中读取配置，没有配置的项使用默认值
+   */
+  static HashJoinConfig from_properties();
+};
+
+/**
+ * @brief 连接使用的内存哈希表
+ * @ingroup PhysicalOperator
+ * @details 构建端的数据按批复制保存，第 i 批的第 j 行编号为 i * Chunk::MAX_ROWS + j。
+ * 哈希表是一个桶数组加上每一行的链表指针，都是 uint32_t 的数组：桶中保存第一行的编号，链表指针保存同一个桶中
+ * 下一行的编号。查找时先比较保存的哈希值，相同时才比较键。
+ * 键只支持可以精确比较的类型(INTS、CHARS)，字符串按照 strnlen 以后的内容比较，与 Value::compare 一致。
+ */
+class JoinHashTable
+{
+public:
+  static constexpr uint32_t NIL = UINT32_MAX;
+
+public:
+  JoinHashTable() = default;
+
+  /**
+   * @brief 复制一批数据，keys 是计算键的表达式
+   */
+  RC add(const Chunk &chunk, const std::vector<std::unique_ptr<Expression>> &keys);
+
+  /**
+   * @brief 所有数据加入以后建立哈希表
+   */
+  void build();
+
+  void clear();
+
+  /**
+   * @brief 查找哈希值为 hash 的第一行，没有时返回 NIL
+   */
+  uint32_t first(uint64_t hash) const;
+
+  /**
+   * @brief 同一个桶中的下一行
+   */
+  uint32_t next(uint32_t row_id) const { return next_[row_id]; }
+
+  uint64_t hash_of(uint32_t row_id) const { return hashes_[row_id]; }
+
+  const Chunk               &chunk_of(uint32_t row_id) const { return *chunks_[row_id / Chunk::MAX_ROWS]; }
+  const std::vector<Column> &keys_of(uint32_t row_id) const { return keys_[row_id / Chunk::MAX_ROWS]; }
+  static int                 row_of(uint32_t row_id) { return static_cast<int>(row_id % Chunk::MAX_ROWS); }
+
+  const std::vector<std::unique_ptr<Chunk>> &chunks() const { return chunks_; }
+
+  bool    empty() const { return chunks_.empty(); }
+  int64_t row_num() const { return row_num_; }
+  int64_t memory_size() const { return memory_size_; }
+
+  /**
+   * @brief 计算一行的键的哈希值
+   */
+  static uint64_t hash_keys(const std::vector<Column> &keys, int row);
+
+  /**
+   * @brief 比较两行的键是否相同
+   */
+  static bool keys_equal(const std::vector<Column> &left, int left_row, const std::vector<Column> &right, int right_row);
+
+private:
+  std::vector<std::unique_ptr<Chunk>> chunks_;
+  std::vector<std::vector<Column>>    keys_;     ///< 每一批数据的键
+  std::vector<uint64_t>               hashes_;   ///< 每一行的哈希值，按行编号访问
+  std::vector<uint32_t>               buckets_;  ///< 每个桶的第一行
+  std::vector<uint32_t>               next_;     ///< 同一个桶中的下一行
+  uint64_t                            mask_        = 0;
+  int64_t                             row_num_     = 0;
+  int64_t                             memory_size_ = 0;
+};
+
+/**
+ * @brief 等值连接的哈希连接算子
+ * @ingroup PhysicalOperator
+ * @details 在较小的一端(构建端)上建立哈希表，另一端(探测端)按批查找。第一个孩子是左表，第二个孩子是右表，
+ * 输出的列总是左表的列加上右表的列，与构建端是哪一端无关。
+ * 构建端的数据超过内存限制时，把两端的数据都按照哈希值分区写到临时文件中，再逐个分区连接(Grace hash join)。
+ * 单个分区仍然超过内存限制时不再继续分区。
+ */
+class HashJoinPhysicalOperator : public PhysicalOperator
+{
+public:
+  /**
+   * @param left_keys 左表的连接键，与 right_keys 一一对应，每一对是一个等值条件
+   * @param build_left 是否在左表上建立哈希表
+   * @param memory_limit 哈希表最多使用的内存
+   */
+  HashJoinPhysicalOperator(std::vector<std::unique_ptr<Expression>> &&left_keys,
+                           std::vector<std::unique_ptr<Expression>> &&right_keys, bool build_left, int64_t memory_limit);
+  virtual ~HashJoinPhysicalOperator();
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::HASH_JOIN; }
+
+  std::string param() const override;
+
+  RC open(Trx *trx) override;
+  RC next() override;
+  RC close() override;
+  Tuple *current_tuple() override;
+
+  RC next_chunk(Chunk &chunk) override;
+
+  /**
+   * @brief 写到临时文件中的分区个数，没有超过内存限制时是0
+   */
+  int spilled_partitions() const { return spilled_ ? PARTITION_NUM : 0; }
+
+private:
+  static constexpr int PARTITION_NUM = 16;
+
+  /**
+   * @brief 一端写到临时文件中的数据，每个分区一个文件
+   */
+  struct SpillFiles
+  {
+    FILE *files[PARTITION_NUM] = {};
+    std::unique_ptr<Chunk> buffers[PARTITION_NUM];  ///< 写文件之前先攒够一批
+  };
+
+  PhysicalOperator *build_child() { return children_[build_left_ ? 0 : 1].get(); }
+  PhysicalOperator *probe_child() { return children_[build_left_ ? 1 : 0].get(); }
+  const std::vector<std::unique_ptr<Expression>> &build_keys() const { return build_left_ ? left_keys_ : right_keys_; }
+  const std::vector<std::unique_ptr<Expression>> &probe_keys() const { return build_left_ ? right_keys_ : left_keys_; }
+
+  /**
+   * @brief 读取构建端，建立哈希表。超过内存限制时把两端的数据都分区写到临时文件
+   */
+  RC build();
+
+  /**
+   * @brief 获取下一批探测的数据，计算键和哈希值
+   */
+  RC next_probe_chunk();
+
+  /**
+   * @brief 加载下一个分区的构建端数据，准备读取这个分区的探测端数据
+   */
+  RC next_partition();
+
+  RC   spill(SpillFiles &spill_files, const Chunk &chunk, const std::vector<std::unique_ptr<Expression>> &keys);
+  RC   flush_spill_files(SpillFiles &spill_files);
+  void close_spill_files(SpillFiles &spill_files);
+
+  /**
+   * @brief 从临时文件中读取一批数据，schema 提供列的名字
+   */
+  RC read_spilled_chunk(FILE *file, const Chunk &schema, Chunk &chunk);
+
+  void start_probe_row();
+  void init_output(Chunk &chunk);
+
+private:
+  std::vector<std::unique_ptr<Expression>> left_keys_;
+  std::vector<std::unique_ptr<Expression>> right_keys_;
+  bool    build_left_   = false;
+  int64_t memory_limit_ = 0;
+
+  Trx          *trx_ = nullptr;
+  JoinHashTable hash_table_;
+  bool          built_     = false;
+  bool          spilled_   = false;
+  int           partition_ = -1;  ///< 正在连接的分区
+  SpillFiles    build_files_;
+  SpillFiles    probe_files_;
+  Chunk         build_schema_;  ///< 构建端的列，没有数据
+  Chunk         probe_schema_;  ///< 探测端的列，没有数据
+  int64_t       spilled_rows_ = 0;
+
+  Chunk                 probe_chunk_;
+  std::vector<Column>   probe_key_columns_;
+  std::vector<uint64_t> probe_hashes_;  ///< 探测数据每一行的哈希值，按行号访问
+  int                   probe_index_ = 0;                    ///< 正在探测第几个有效行
+  uint32_t              match_       = JoinHashTable::NIL;  ///< 正在检查的构建端的行
+
+  std::vector<int>      probe_rows_;  ///< 这一批输出中每一行对应的探测端的行号
+  std::vector<uint32_t> build_ids_;   ///< 这一批输出中每一行对应的构建端的行编号
+
+  Chunk      chunk_;  ///< 逐行接口使用的当前批次
+  int        row_ = 0;
+  ChunkTuple tuple_;
+};
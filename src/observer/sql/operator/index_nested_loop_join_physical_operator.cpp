@@ -0,0 +1,207 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+
+#include "common/log/log.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/index_nested_loop_join_physical_operator.h"
+#include "sql/operator/index_scan_physical_operator.h"
+#include "storage/index/index.h"
+#include "storage/table/table.h"
+
+using namespace std;
+
+IndexNestedLoopJoinPhysicalOperator::IndexNestedLoopJoinPhysicalOperator(unique_ptr<Expression> outer_key)
+    : outer_key_(std::move(outer_key))
+{}
+
+string IndexNestedLoopJoinPhysicalOperator::param() const
+{
+  string str = outer_key_->name();
+  if (outer_key_->type() == ExprType::FIELD) {
+    const auto &field_expr = static_cast<const FieldExpr &>(*outer_key_);
+    str = string(field_expr.table_name()) + "." + field_expr.field_name();
+  }
+
+  if (children_.size() == 2 && children_[1]->type() == PhysicalOperatorType::INDEX_SCAN) {
+    const auto *inner = static_cast<const IndexScanPhysicalOperator *>(children_[1].get());
+    str += string("=") + inner->table()->name() + "." + inner->index()->field_meta().name();
+  }
+  return str;
+}
+
+RC IndexNestedLoopJoinPhysicalOperator::open(Trx *trx)
+{
+  if (children_.size() != 2 || children_[1]->type() != PhysicalOperatorType::INDEX_SCAN) {
+    LOG_WARN("index nested loop join operator should have 2 children and the second one should be an index scan");
+    return RC::INTERNAL;
+  }
+
+  outer_ = children_[0].get();
+  inner_ = static_cast<IndexScanPhysicalOperator *>(children_[1].get());
+
+  RC rc = outer_->open(trx);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to open outer oper. rc=%s", strrc(rc));
+    return rc;
+  }
+  rc = inner_->open(trx);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to open inner oper. rc=%s", strrc(rc));
+    outer_->close();
+    return rc;
+  }
+
+  outer_chunk_.clear();
+  outer_index_ = -1;
+  outer_eof_ = false;
+  inner_chunk_.clear();
+  inner_row_ = 0;
+  inner_eof_ = true;
+  chunk_.clear();
+  row_ = 0;
+  tuple_.set_chunk(&chunk_);
+  return RC::SUCCESS;
+}
+
+RC IndexNestedLoopJoinPhysicalOperator::next()
+{
+  if (row_ + 1 < chunk_.size()) {
+    row_++;
+    return RC::SUCCESS;
+  }
+
+  RC rc = next_chunk(chunk_);
+  if (rc != RC::SUCCESS) {
+    chunk_.reset();
+  }
+  row_ = 0;
+  return rc;
+}
+
+RC IndexNestedLoopJoinPhysicalOperator::close()
+{
+  RC rc = RC::SUCCESS;
+  for (unique_ptr<PhysicalOperator> &child : children_) {
+    RC child_rc = child->close();
+    if (child_rc != RC::SUCCESS) {
+      LOG_WARN("failed to close child oper. rc=%s", strrc(child_rc));
+      rc = child_rc;
+    }
+  }
+  return rc;
+}
+
+Tuple *IndexNestedLoopJoinPhysicalOperator::current_tuple()
+{
+  tuple_.set_row(chunk_.row_at(row_));
+  return &tuple_;
+}
+
+RC IndexNestedLoopJoinPhysicalOperator::next_outer_row()
+{
+  RC rc = RC::SUCCESS;
+  outer_index_++;
+  while (outer_index_ >= outer_chunk_.size()) {
+    if (outer_eof_) {
+      return RC::RECORD_EOF;
+    }
+
+    rc = outer_->next_chunk(outer_chunk_);
+    if (rc == RC::RECORD_EOF) {
+      outer_eof_ = true;
+      return rc;
+    }
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to fetch outer chunk. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    rc = outer_key_->get_column(outer_chunk_, outer_key_column_);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to get outer key column. rc=%s", strrc(rc));
+      return rc;
+    }
+    outer_index_ = 0;
+  }
+
+  Value value;
+  outer_key_column_.get_value(outer_chunk_.row_at(outer_index_), value);
+  rc = inner_->rescan(value);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to rescan inner oper. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  inner_chunk_.reset();
+  inner_row_ = 0;
+  inner_eof_ = false;
+  return RC::SUCCESS;
+}
+
+void IndexNestedLoopJoinPhysicalOperator::init_output(Chunk &chunk)
+{
+  for (const Chunk *source : {&outer_chunk_, &inner_chunk_}) {
+    for (int i = 0; i < source->column_num(); i++) {
+      const Column &column = source->column(i);
+      chunk.add_column(make_unique<Column>(column.attr_type(), column.attr_len(), Chunk::MAX_ROWS), source->spec(i));
+    }
+  }
+}
+
+RC IndexNestedLoopJoinPhysicalOperator::next_chunk(Chunk &chunk)
+{
+  RC rc = RC::SUCCESS;
+  chunk.reset();
+  while (chunk.rows() < Chunk::MAX_ROWS) {
+    if (inner_row_ >= inner_chunk_.size()) {
+      if (!inner_eof_) {
+        rc = inner_->next_chunk(inner_chunk_);
+        if (rc == RC::SUCCESS) {
+          inner_row_ = 0;
+          continue;
+        }
+        if (rc != RC::RECORD_EOF) {
+          LOG_WARN("failed to fetch inner chunk. rc=%s", strrc(rc));
+          return rc;
+        }
+        inner_eof_ = true;
+      }
+
+      rc = next_outer_row();
+      if (rc == RC::RECORD_EOF) {
+        break;
+      }
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      continue;
+    }
+
+    if (chunk.column_num() == 0) {
+      init_output(chunk);
+    }
+
+    const int outer_column_num = outer_chunk_.column_num();
+    const int outer_row = outer_chunk_.row_at(outer_index_);
+    const int num = min(inner_chunk_.size() - inner_row_, Chunk::MAX_ROWS - chunk.rows());
+    for (int i = 0; i < outer_column_num; i++) {
+      chunk.column(i).append_repeat(outer_chunk_.column(i), outer_row, num);
+    }
+    for (int i = 0; i < inner_chunk_.column_num(); i++) {
+      chunk.column(outer_column_num + i).append(inner_chunk_.column(i), inner_row_, num);
+    }
+    chunk.set_rows(chunk.rows() + num);
+    inner_row_ += num;
+  }
+
+  return chunk.rows() > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+}
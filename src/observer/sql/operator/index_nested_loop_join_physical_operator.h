@@ -0,0 +1,74 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <memory>
+
+#include "sql/expr/chunk.h"
+#include "sql/operator/physical_operator.h"
+
+class IndexScanPhysicalOperator;
+
+/**
+ * @brief 索引嵌套循环连接算子
+ * @ingroup PhysicalOperator
+ * @details 第一个孩子是外表，第二个孩子是内表上参数化的 IndexScanPhysicalOperator。
+ * 外表的每一行计算连接键，用这个值重新扫描内表的索引，而不是像 NestedLoopJoinPhysicalOperator 那样遍历内表所有的数据。
+ * 内表的索引扫描器只创建一次，B+树索引按照从小到大的顺序查找时可以从上一次的叶子节点继续定位。
+ * 输出的列是外表的列加上内表的列。
+ */
+class IndexNestedLoopJoinPhysicalOperator : public PhysicalOperator
+{
+public:
+  /**
+   * @param outer_key 外表的连接键，与内表索引的字段相等
+   */
+  IndexNestedLoopJoinPhysicalOperator(std::unique_ptr<Expression> outer_key);
+  virtual ~IndexNestedLoopJoinPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::INDEX_NESTED_LOOP_JOIN; }
+
+  std::string param() const override;
+
+  RC open(Trx *trx) override;
+  RC next() override;
+  RC close() override;
+  Tuple *current_tuple() override;
+
+  RC next_chunk(Chunk &chunk) override;
+
+private:
+  /**
+   * @brief 用外表的下一行重新扫描内表
+   */
+  RC next_outer_row();
+
+  void init_output(Chunk &chunk);
+
+private:
+  std::unique_ptr<Expression> outer_key_;
+
+  PhysicalOperator          *outer_ = nullptr;
+  IndexScanPhysicalOperator *inner_ = nullptr;
+
+  Chunk  outer_chunk_;
+  Column outer_key_column_;
+  int    outer_index_ = -1;  ///< 正在连接外表批次中的第几个有效行
+  bool   outer_eof_   = false;
+
+  Chunk inner_chunk_;
+  int   inner_row_ = 0;     ///< 下一次从内表这一批中的第几行开始连接
+  bool  inner_eof_ = true;  ///< 外表当前这一行在内表中的数据是否已经读完
+
+  Chunk      chunk_;  ///< 逐行接口使用的当前批次
+  int        row_ = 0;
+  ChunkTuple tuple_;
+};
@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "sql/operator/index_scan_physical_operator.h"
+#include "sql/expr/chunk.h"
 #include "storage/index/index.h"
 #include "storage/trx/trx.h"
 
@@ -34,30 +35,43 @@ IndexScanPhysicalOperator::IndexScanPhysicalOperator(
   }
 }
 
+IndexScanPhysicalOperator::IndexScanPhysicalOperator(Table *table, Index *index, bool readonly)
+    : table_(table),
+      index_(index),
+      readonly_(readonly),
+      left_inclusive_(true),
+      right_inclusive_(true),
+      parameterized_(true)
+{}
+
 RC IndexScanPhysicalOperator::open(Trx *trx)
 {
   if (nullptr == table_ || nullptr == index_) {
     return RC::INTERNAL;
   }
 
-  IndexScanner *index_scanner = index_->create_scanner(left_value_.data(),
-      left_value_.length(),
-      left_inclusive_,
-      right_value_.data(),
-      right_value_.length(),
-      right_inclusive_);
-  if (nullptr == index_scanner) {
-    LOG_WARN("failed to create index scanner");
-    return RC::INTERNAL;
-  }
-
   record_handler_ = table_->record_handler();
   if (nullptr == record_handler_) {
     LOG_WARN("invalid record handler");
-    index_scanner->destroy();
     return RC::INTERNAL;
   }
-  index_scanner_ = index_scanner;
+
+  if (!parameterized_) {
+    // 没有指定的边界不限制范围
+    const bool has_left = left_value_.attr_type() != UNDEFINED;
+    const bool has_right = right_value_.attr_type() != UNDEFINED;
+    IndexScanner *index_scanner = index_->create_scanner(has_left ? left_value_.data() : nullptr,
+        left_value_.length(),
+        left_inclusive_,
+        has_right ? right_value_.data() : nullptr,
+        right_value_.length(),
+        right_inclusive_);
+    if (nullptr == index_scanner) {
+      LOG_WARN("failed to create index scanner");
+      return RC::INTERNAL;
+    }
+    index_scanner_ = index_scanner;
+  }
 
   tuple_.set_schema(table_, table_->table_meta().field_metas());
 
@@ -65,15 +79,52 @@ RC IndexScanPhysicalOperator::open(Trx *trx)
   return RC::SUCCESS;
 }
 
+RC IndexScanPhysicalOperator::rescan(const Value &value)
+{
+  left_value_ = value;
+  right_value_ = value;
+  if (index_scanner_ != nullptr) {
+    RC rc = index_scanner_->rescan(left_value_.data(),
+        left_value_.length(),
+        left_inclusive_,
+        right_value_.data(),
+        right_value_.length(),
+        right_inclusive_);
+    if (rc != RC::UNIMPLENMENT) {
+      return rc;
+    }
+
+    index_scanner_->destroy();
+    index_scanner_ = nullptr;
+  }
+
+  index_scanner_ = index_->create_scanner(left_value_.data(),
+      left_value_.length(),
+      left_inclusive_,
+      right_value_.data(),
+      right_value_.length(),
+      right_inclusive_);
+  if (nullptr == index_scanner_) {
+    LOG_WARN("failed to create index scanner");
+    return RC::INTERNAL;
+  }
+  return RC::SUCCESS;
+}
+
 RC IndexScanPhysicalOperator::next()
 {
+  // 参数化的扫描还没有指定要查找的值
+  if (nullptr == index_scanner_) {
+    return RC::RECORD_EOF;
+  }
+
   RID rid;
   RC rc = RC::SUCCESS;
 
-  record_page_handler_.cleanup();
-
   bool filter_result = false;
   while (RC::SUCCESS == (rc = index_scanner_->next_entry(&rid))) {
+    // 被过滤掉的记录也要先释放所在的页面，才能读取下一条
+    record_page_handler_.cleanup();
     rc = record_handler_->get_record(record_page_handler_, &rid, readonly_, &current_record_);
     if (rc != RC::SUCCESS) {
       return rc;
@@ -90,6 +141,36 @@ RC IndexScanPhysicalOperator::next()
     }
 
     rc = trx_->visit_record(table_, current_record_, readonly_);
+    if (rc == RC::LOCKED_NEED_WAIT) {
+      // 行锁被其它事务持有，释放数据页面和索引页面的锁等待，拿到锁以后重新读取记录检查。
+      // 持有锁的事务回滚或者修改索引时需要这些页面的锁
+      record_page_handler_.cleanup();
+      rc = index_scanner_->suspend();
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      rc = trx_->lock_record(table_, rid);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+
+      rc = record_handler_->get_record(record_page_handler_, &rid, readonly_, &current_record_);
+      if (rc == RC::RECORD_NOT_EXIST) {
+        continue;
+      } else if (rc != RC::SUCCESS) {
+        return rc;
+      }
+
+      rc = filter(tuple_, filter_result);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      if (!filter_result) {
+        continue;
+      }
+      rc = trx_->visit_record(table_, current_record_, readonly_);
+    }
+
     if (rc == RC::RECORD_INVISIBLE) {
       continue;
     } else {
@@ -102,8 +183,13 @@ RC IndexScanPhysicalOperator::next()
 
 RC IndexScanPhysicalOperator::close()
 {
-  index_scanner_->destroy();
-  index_scanner_ = nullptr;
+  record_page_handler_.cleanup();
+
+  // EXPLAIN 不会打开算子，这时还没有创建扫描器
+  if (index_scanner_ != nullptr) {
+    index_scanner_->destroy();
+    index_scanner_ = nullptr;
+  }
   return RC::SUCCESS;
 }
 
@@ -113,6 +199,31 @@ Tuple *IndexScanPhysicalOperator::current_tuple()
   return &tuple_;
 }
 
+RC IndexScanPhysicalOperator::next_chunk(Chunk &chunk)
+{
+  const std::vector<FieldMeta> &field_metas = *table_->table_meta().field_metas();
+  if (chunk.column_num() == 0) {
+    for (const FieldMeta &field_meta : field_metas) {
+      chunk.add_column(std::make_unique<Column>(field_meta.type(), field_meta.len(), Chunk::MAX_ROWS),
+                       TupleCellSpec(table_->name(), field_meta.name()));
+    }
+  }
+
+  chunk.reset();
+  RC rc = RC::SUCCESS;
+  while (chunk.rows() < Chunk::MAX_ROWS && RC::SUCCESS == (rc = next())) {
+    const char *data = current_record_.data();
+    for (size_t i = 0; i < field_metas.size(); i++) {
+      chunk.column(i).append(data + field_metas[i].offset());
+    }
+    chunk.set_rows(chunk.rows() + 1);
+  }
+  if (rc != RC::SUCCESS && rc != RC::RECORD_EOF) {
+    return rc;
+  }
+  return chunk.rows() > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+}
+
 void IndexScanPhysicalOperator::set_predicates(std::vector<std::unique_ptr<Expression>> &&exprs)
 {
   predicates_ = std::move(exprs);
@@ -25,10 +25,19 @@ See the Mulan PSL v2 for more details. */
 class IndexScanPhysicalOperator : public PhysicalOperator
 {
 public:
+  /**
+   * @details left_value 或 right_value 为空时这一端不限制范围，两端都为空时按照索引的顺序扫描所有的数据
+   */
   IndexScanPhysicalOperator(Table *table, Index *index, bool readonly, 
       const Value *left_value, bool left_inclusive,
       const Value *right_value, bool right_inclusive);
 
+  /**
+   * @brief 参数化的等值扫描，打开以后每次用 rescan 指定要查找的值
+   * @details 用于索引嵌套循环连接，外表的每一行都用连接键重新扫描一次，扫描器只创建一次
+   */
+  IndexScanPhysicalOperator(Table *table, Index *index, bool readonly);
+
   virtual ~IndexScanPhysicalOperator() = default;
 
   PhysicalOperatorType type() const override
@@ -44,6 +53,20 @@ public:
 
   Tuple *current_tuple() override;
 
+  /**
+   * @brief 把记录中的字段直接复制到列中，列与 TableScanPhysicalOperator 相同
+   */
+  RC next_chunk(Chunk &chunk) override;
+
+  /**
+   * @brief 重新扫描等于 value 的数据
+   * @details 复用已经打开的索引扫描器，索引不支持时才重新创建
+   */
+  RC rescan(const Value &value);
+
+  Table *table() const { return table_; }
+  Index *index() const { return index_; }
+
   void set_predicates(std::vector<std::unique_ptr<Expression>> &&exprs);
 
 private:
@@ -66,6 +89,7 @@ private:
   Value right_value_;
   bool left_inclusive_ = false;
   bool right_inclusive_ = false;
+  bool parameterized_ = false;  ///< 打开时不扫描，等待 rescan
 
   std::vector<std::unique_ptr<Expression>> predicates_;
 };
@@ -12,6 +12,8 @@ See the Mulan PSL v2 for more details. */
 // Created by WangYunlai on 2022/12/30.
 //
 
+#include <algorithm>
+
 #include "sql/operator/join_physical_operator.h"
 
 NestedLoopJoinPhysicalOperator::NestedLoopJoinPhysicalOperator()
@@ -30,6 +32,13 @@ RC NestedLoopJoinPhysicalOperator::open(Trx *trx)
   right_closed_ = true;
   round_done_ = true;
 
+  left_chunk_.clear();
+  right_chunks_.clear();
+  right_fetched_ = false;
+  left_row_ = 0;
+  right_index_ = 0;
+  right_row_ = 0;
+
   rc = left_->open(trx);
   trx_ = trx;
   return rc;
@@ -134,3 +143,102 @@ RC NestedLoopJoinPhysicalOperator::right_next()
   joined_tuple_.set_right(right_tuple_);
   return rc;
 }
+
+RC NestedLoopJoinPhysicalOperator::fetch_right_chunks()
+{
+  right_chunks_.clear();
+  RC rc = right_->open(trx_);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to open right oper. rc=%s", strrc(rc));
+    return rc;
+  }
+  right_closed_ = false;
+
+  Chunk chunk;
+  while (RC::SUCCESS == (rc = right_->next_chunk(chunk))) {
+    auto copied = std::make_unique<Chunk>();
+    copied->copy_from(chunk);
+    right_chunks_.emplace_back(std::move(copied));
+  }
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to fetch right chunks. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rc = right_->close();
+  right_closed_ = true;
+  right_fetched_ = true;
+  return rc;
+}
+
+RC NestedLoopJoinPhysicalOperator::next_chunk(Chunk &chunk)
+{
+  RC rc = RC::SUCCESS;
+  if (!right_fetched_) {
+    rc = fetch_right_chunks();
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+  if (right_chunks_.empty()) {
+    return RC::RECORD_EOF;
+  }
+
+  const int right_chunk_num = static_cast<int>(right_chunks_.size());
+  chunk.reset();
+  while (chunk.rows() < Chunk::MAX_ROWS) {
+    if (left_row_ >= left_chunk_.size()) {
+      rc = left_->next_chunk(left_chunk_);
+      if (rc == RC::RECORD_EOF) {
+        break;
+      }
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      left_row_ = 0;
+      right_index_ = 0;
+      right_row_ = 0;
+
+      if (chunk.column_num() == 0) {
+        const Chunk &right_chunk = *right_chunks_.front();
+        for (int i = 0; i < left_chunk_.column_num(); i++) {
+          const Column &column = left_chunk_.column(i);
+          chunk.add_column(std::make_unique<Column>(column.attr_type(), column.attr_len(), Chunk::MAX_ROWS),
+                           left_chunk_.spec(i));
+        }
+        for (int i = 0; i < right_chunk.column_num(); i++) {
+          const Column &column = right_chunk.column(i);
+          chunk.add_column(std::make_unique<Column>(column.attr_type(), column.attr_len(), Chunk::MAX_ROWS),
+                           right_chunk.spec(i));
+        }
+      }
+    }
+
+    const int left_column_num = left_chunk_.column_num();
+    const int left_row = left_chunk_.row_at(left_row_);
+    while (right_index_ < right_chunk_num && chunk.rows() < Chunk::MAX_ROWS) {
+      const Chunk &right_chunk = *right_chunks_[right_index_];
+      const int num = std::min(right_chunk.rows() - right_row_, Chunk::MAX_ROWS - chunk.rows());
+      for (int i = 0; i < left_column_num; i++) {
+        chunk.column(i).append_repeat(left_chunk_.column(i), left_row, num);
+      }
+      for (int i = 0; i < right_chunk.column_num(); i++) {
+        chunk.column(left_column_num + i).append(right_chunk.column(i), right_row_, num);
+      }
+      chunk.set_rows(chunk.rows() + num);
+
+      right_row_ += num;
+      if (right_row_ >= right_chunk.rows()) {
+        right_index_++;
+        right_row_ = 0;
+      }
+    }
+
+    if (right_index_ >= right_chunk_num) {
+      left_row_++;
+      right_index_ = 0;
+    }
+  }
+
+  return chunk.rows() > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+}
@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "sql/parser/parse.h"
 #include "sql/operator/physical_operator.h"
+#include "sql/expr/chunk.h"
 
 /**
  * @brief 最简单的两表（称为左表、右表）join算子
@@ -38,9 +39,16 @@ public:
   RC close() override;
   Tuple *current_tuple() override;
 
+  /**
+   * @brief 按批连接
+   * @details 右表只读取一次，复制保存下来。左表每一批中的每一行与右表所有的行连接，输出的列是左表的列加上右表的列
+   */
+  RC next_chunk(Chunk &chunk) override;
+
 private:
   RC left_next();   //! 左表遍历下一条数据
   RC right_next();  //! 右表遍历下一条数据，如果上一轮结束了就重新开始新的一轮
+  RC fetch_right_chunks();  //! 读取右表所有的数据
 
 private:
   Trx *trx_ = nullptr;
@@ -53,4 +61,11 @@ private:
   JoinedTuple joined_tuple_;  //! 当前关联的左右两个tuple
   bool round_done_ = true;    //! 右表遍历的一轮是否结束
   bool right_closed_ = true;  //! 右表算子是否已经关闭
+
+  Chunk left_chunk_;                                //! 左表当前的一批数据
+  std::vector<std::unique_ptr<Chunk>> right_chunks_;  //! 右表所有的数据
+  bool right_fetched_ = false;                      //! 是否已经读取了右表
+  int left_row_ = 0;     //! 正在连接左表批次中的第几个有效行
+  int right_index_ = 0;  //! 正在连接右表的第几批
+  int right_row_ = 0;    //! 下一次从右表这一批中的第几行开始连接
 };
@@ -0,0 +1,287 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+#include <algorithm>
+#include <string_view>
+
+#include "common/log/log.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/merge_join_physical_operator.h"
+
+using namespace std;
+
+namespace {
+
+string_view chars_of(const Column &column, int row)
+{
+  const char *data = column.data_at(row);
+  return string_view(data, strnlen(data, column.attr_len()));
+}
+
+/**
+ * @brief 比较两个键，结果与B+树索引中的顺序一致
+ */
+int compare_keys(const Column &left, int left_row, const Column &right, int right_row)
+{
+  if (left.attr_type() == INTS && right.attr_type() == INTS) {
+    const int left_value  = left.values<int>()[left_row * left.stride()];
+    const int right_value = right.values<int>()[right_row * right.stride()];
+    return left_value < right_value ? -1 : (left_value > right_value ? 1 : 0);
+  }
+  if (left.attr_type() == CHARS && right.attr_type() == CHARS) {
+    return chars_of(left, left_row).compare(chars_of(right, right_row));
+  }
+
+  Value left_value;
+  Value right_value;
+  left.get_value(left_row, left_value);
+  right.get_value(right_row, right_value);
+  return left_value.compare(right_value);
+}
+
+string key_name(const Expression &expr)
+{
+  if (expr.type() == ExprType::FIELD) {
+    const auto &field_expr = static_cast<const FieldExpr &>(expr);
+    return string(field_expr.table_name()) + "." + field_expr.field_name();
+  }
+  return expr.name();
+}
+
+}  // namespace
+
+RC MergeJoinPhysicalOperator::Input::fetch()
+{
+  while (!eof && index >= chunk.size()) {
+    RC rc = oper->next_chunk(chunk);
+    if (rc == RC::RECORD_EOF) {
+      eof = true;
+      break;
+    }
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to fetch chunk. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    rc = key->get_column(chunk, key_column);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to get key column. rc=%s", strrc(rc));
+      return rc;
+    }
+    index = 0;
+  }
+  return RC::SUCCESS;
+}
+
+MergeJoinPhysicalOperator::MergeJoinPhysicalOperator(unique_ptr<Expression> left_key, unique_ptr<Expression> right_key)
+{
+  left_.key  = std::move(left_key);
+  right_.key = std::move(right_key);
+}
+
+string MergeJoinPhysicalOperator::param() const { return key_name(*left_.key) + "=" + key_name(*right_.key); }
+
+RC MergeJoinPhysicalOperator::open(Trx *trx)
+{
+  if (children_.size() != 2) {
+    LOG_WARN("merge join operator should have 2 children");
+    return RC::INTERNAL;
+  }
+
+  RC rc = children_[0]->open(trx);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to open left child. rc=%s", strrc(rc));
+    return rc;
+  }
+  rc = children_[1]->open(trx);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to open right child. rc=%s", strrc(rc));
+    children_[0]->close();
+    return rc;
+  }
+
+  for (Input *input : {&left_, &right_}) {
+    input->chunk.clear();
+    input->index = 0;
+    input->eof   = false;
+  }
+  left_.oper  = children_[0].get();
+  right_.oper = children_[1].get();
+
+  run_chunks_.clear();
+  run_rows_     = 0;
+  run_pos_      = 0;
+  max_run_rows_ = 0;
+
+  chunk_.clear();
+  row_ = 0;
+  tuple_.set_chunk(&chunk_);
+  return RC::SUCCESS;
+}
+
+RC MergeJoinPhysicalOperator::next()
+{
+  if (row_ + 1 < chunk_.size()) {
+    row_++;
+    return RC::SUCCESS;
+  }
+
+  RC rc = next_chunk(chunk_);
+  if (rc != RC::SUCCESS) {
+    chunk_.reset();
+  }
+  row_ = 0;
+  return rc;
+}
+
+RC MergeJoinPhysicalOperator::close()
+{
+  RC rc = RC::SUCCESS;
+  for (unique_ptr<PhysicalOperator> &child : children_) {
+    RC child_rc = child->close();
+    if (child_rc != RC::SUCCESS) {
+      LOG_WARN("failed to close child oper. rc=%s", strrc(child_rc));
+      rc = child_rc;
+    }
+  }
+  run_chunks_.clear();
+  return rc;
+}
+
+Tuple *MergeJoinPhysicalOperator::current_tuple()
+{
+  tuple_.set_row(chunk_.row_at(row_));
+  return &tuple_;
+}
+
+RC MergeJoinPhysicalOperator::load_run()
+{
+  const Column &key_column = right_.key_column;
+  if (run_key_.attr_type() != key_column.attr_type() || run_key_.attr_len() != key_column.attr_len()) {
+    run_key_.init(key_column.attr_type(), key_column.attr_len(), 1);
+  }
+  run_key_.reset();
+  run_key_.append(key_column.data_at(right_.row()));
+
+  run_rows_ = 0;
+  run_pos_  = 0;
+  do {
+    const int run_row = static_cast<int>(run_rows_ % Chunk::MAX_ROWS);
+    const size_t run_chunk_index = static_cast<size_t>(run_rows_ / Chunk::MAX_ROWS);
+    if (run_chunk_index == run_chunks_.size()) {
+      auto run_chunk = make_unique<Chunk>();
+      for (int i = 0; i < right_.chunk.column_num(); i++) {
+        const Column &column = right_.chunk.column(i);
+        run_chunk->add_column(
+            make_unique<Column>(column.attr_type(), column.attr_len(), Chunk::MAX_ROWS), right_.chunk.spec(i));
+      }
+      run_chunks_.emplace_back(std::move(run_chunk));
+    }
+
+    Chunk &run_chunk = *run_chunks_[run_chunk_index];
+    if (run_row == 0) {
+      run_chunk.reset();
+    }
+    for (int i = 0; i < run_chunk.column_num(); i++) {
+      run_chunk.column(i).append(right_.chunk.column(i), right_.row(), 1);
+    }
+    run_chunk.set_rows(run_row + 1);
+    run_rows_++;
+
+    right_.index++;
+    RC rc = right_.fetch();
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  } while (!right_.eof && 0 == compare_keys(right_.key_column, right_.row(), run_key_, 0));
+
+  max_run_rows_ = max(max_run_rows_, run_rows_);
+  return RC::SUCCESS;
+}
+
+void MergeJoinPhysicalOperator::init_output(Chunk &chunk)
+{
+  for (const Chunk *source : {&left_.chunk, run_chunks_.front().get()}) {
+    for (int i = 0; i < source->column_num(); i++) {
+      const Column &column = source->column(i);
+      chunk.add_column(make_unique<Column>(column.attr_type(), column.attr_len(), Chunk::MAX_ROWS), source->spec(i));
+    }
+  }
+}
+
+RC MergeJoinPhysicalOperator::next_chunk(Chunk &chunk)
+{
+  RC rc = RC::SUCCESS;
+  chunk.reset();
+  while (chunk.rows() < Chunk::MAX_ROWS) {
+    rc = left_.fetch();
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    if (left_.eof) {
+      break;
+    }
+
+    // 左表当前行与缓冲区中的键相同时，与缓冲区中所有的行连接
+    if (run_rows_ > 0) {
+      if (0 == compare_keys(left_.key_column, left_.row(), run_key_, 0)) {
+        if (chunk.column_num() == 0) {
+          init_output(chunk);
+        }
+
+        const Chunk &run_chunk = *run_chunks_[run_pos_ / Chunk::MAX_ROWS];
+        const int run_row = static_cast<int>(run_pos_ % Chunk::MAX_ROWS);
+        const int num = min(run_chunk.rows() - run_row, Chunk::MAX_ROWS - chunk.rows());
+        const int left_column_num = left_.chunk.column_num();
+        for (int i = 0; i < left_column_num; i++) {
+          chunk.column(i).append_repeat(left_.chunk.column(i), left_.row(), num);
+        }
+        for (int i = 0; i < run_chunk.column_num(); i++) {
+          chunk.column(left_column_num + i).append(run_chunk.column(i), run_row, num);
+        }
+        chunk.set_rows(chunk.rows() + num);
+
+        run_pos_ += num;
+        if (run_pos_ >= run_rows_) {
+          run_pos_ = 0;
+          left_.index++;
+        }
+        continue;
+      }
+
+      // 左表已经越过了这个键，右表中也不会再有这个键
+      run_rows_ = 0;
+    }
+
+    rc = right_.fetch();
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    if (right_.eof) {
+      break;
+    }
+
+    const int result = compare_keys(left_.key_column, left_.row(), right_.key_column, right_.row());
+    if (result < 0) {
+      left_.index++;
+    } else if (result > 0) {
+      right_.index++;
+    } else {
+      rc = load_run();
+      if (rc != RC::SUCCESS) {
+        LOG_WARN("failed to load duplicate keys of right child. rc=%s", strrc(rc));
+        return rc;
+      }
+    }
+  }
+
+  return chunk.rows() > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+}
@@ -0,0 +1,95 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "sql/expr/chunk.h"
+#include "sql/operator/physical_operator.h"
+
+/**
+ * @brief 排序归并连接算子
+ * @ingroup PhysicalOperator
+ * @details 两个孩子输出的数据都已经按照各自的连接键从小到大排好序(比如B+树索引扫描)，两端同时向后推进，
+ * 每一端最多读取一遍。右表中键相同的一段数据(重复键)复制到缓冲区中，左表中所有等于这个键的行都与缓冲区连接，
+ * 因此键唯一时只缓存一行，使用的内存与数据量无关。
+ * 键只支持可以精确比较的类型(INTS、CHARS)，比较的方式与B+树索引一致。
+ * 输出的列是左表的列加上右表的列。
+ */
+class MergeJoinPhysicalOperator : public PhysicalOperator
+{
+public:
+  /**
+   * @param left_key 左表的连接键，左表的数据按照它排序
+   * @param right_key 右表的连接键，右表的数据按照它排序
+   */
+  MergeJoinPhysicalOperator(std::unique_ptr<Expression> left_key, std::unique_ptr<Expression> right_key);
+  virtual ~MergeJoinPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::MERGE_JOIN; }
+
+  std::string param() const override;
+
+  RC open(Trx *trx) override;
+  RC next() override;
+  RC close() override;
+  Tuple *current_tuple() override;
+
+  RC next_chunk(Chunk &chunk) override;
+
+  /**
+   * @brief 右表重复键缓冲区最多保存过的行数
+   */
+  int64_t max_run_rows() const { return max_run_rows_; }
+
+private:
+  /**
+   * @brief 一端正在读取的数据
+   */
+  struct Input
+  {
+    PhysicalOperator           *oper = nullptr;
+    std::unique_ptr<Expression> key;
+    Chunk                       chunk;
+    Column                      key_column;
+    int                         index = 0;  ///< 当前是这一批中的第几个有效行
+    bool                        eof   = false;
+
+    int row() const { return chunk.row_at(index); }
+
+    /**
+     * @brief 保证当前行有效，这一批读完时读取下一批
+     */
+    RC fetch();
+  };
+
+  /**
+   * @brief 把右表中与当前行键相同的所有行复制到缓冲区
+   */
+  RC load_run();
+
+  void init_output(Chunk &chunk);
+
+private:
+  Input left_;
+  Input right_;
+
+  std::vector<std::unique_ptr<Chunk>> run_chunks_;    ///< 右表中键相同的一段数据，每一批最多 MAX_ROWS 行
+  Column                              run_key_;       ///< 缓冲区中数据的键，只有一行
+  int64_t                             run_rows_ = 0;  ///< 缓冲区中的行数，0表示没有数据
+  int64_t                             run_pos_  = 0;  ///< 左表当前行下一次从缓冲区中的第几行开始连接
+  int64_t                             max_run_rows_ = 0;
+
+  Chunk      chunk_;  ///< 逐行接口使用的当前批次
+  int        row_ = 0;
+  ChunkTuple tuple_;
+};
@@ -12,7 +12,10 @@ See the Mulan PSL v2 for more details. */
 // Created by WangYunlai on 2022/11/18.
 //
 
+#include <algorithm>
+
 #include "sql/operator/physical_operator.h"
+#include "sql/expr/chunk.h"
 
 std::string physical_operator_type_name(PhysicalOperatorType type)
 {
@@ -23,6 +26,12 @@ std::string physical_operator_type_name(PhysicalOperatorType type)
       return "INDEX_SCAN";
     case PhysicalOperatorType::NESTED_LOOP_JOIN:
       return "NESTED_LOOP_JOIN";
+    case PhysicalOperatorType::HASH_JOIN:
+      return "HASH_JOIN";
+    case PhysicalOperatorType::INDEX_NESTED_LOOP_JOIN:
+      return "INDEX_NESTED_LOOP_JOIN";
+    case PhysicalOperatorType::MERGE_JOIN:
+      return "MERGE_JOIN";
     case PhysicalOperatorType::EXPLAIN:
       return "EXPLAIN";
     case PhysicalOperatorType::PREDICATE:
@@ -54,3 +63,64 @@ std::string PhysicalOperator::param() const
 {
   return "";
 }
+
+RC PhysicalOperator::next_chunk(Chunk &chunk)
+{
+  chunk.reset();
+
+  RC rc = RC::SUCCESS;
+  Value value;
+  while (chunk.rows() < Chunk::MAX_ROWS) {
+    rc = next();
+    if (rc != RC::SUCCESS) {
+      break;
+    }
+
+    Tuple *tuple = current_tuple();
+    if (nullptr == tuple) {
+      LOG_WARN("failed to get current tuple");
+      return RC::INTERNAL;
+    }
+
+    // 逐行的算子没有描述输出的类型，按照第一行数据创建列
+    if (chunk.column_num() == 0) {
+      for (int i = 0; i < tuple->cell_num(); i++) {
+        TupleCellSpec spec("");
+        rc = tuple->spec_at(i, spec);
+        if (rc == RC::SUCCESS) {
+          rc = tuple->cell_at(i, value);
+        }
+        if (rc != RC::SUCCESS) {
+          LOG_WARN("failed to get cell of tuple. index=%d, rc=%s", i, strrc(rc));
+          return rc;
+        }
+
+        const AttrType attr_type = value.attr_type();
+        const int attr_len = (attr_type == CHARS) ? std::max(value.length(), 1) : static_cast<int>(sizeof(int32_t));
+        chunk.add_column(std::make_unique<Column>(attr_type, attr_len, Chunk::MAX_ROWS), spec);
+      }
+    }
+
+    const int row = chunk.rows();
+    for (int i = 0; i < chunk.column_num(); i++) {
+      rc = tuple->cell_at(i, value);
+      if (rc == RC::SUCCESS) {
+        rc = chunk.column(i).set_value(row, value);
+      }
+      if (rc != RC::SUCCESS) {
+        LOG_WARN("failed to copy cell of tuple. index=%d, rc=%s", i, strrc(rc));
+        return rc;
+      }
+    }
+    chunk.set_rows(row + 1);
+  }
+
+  if (rc != RC::SUCCESS && rc != RC::RECORD_EOF) {
+    return rc;
+  }
+
+  for (int i = 0; i < chunk.column_num(); i++) {
+    chunk.column(i).set_count(chunk.rows());
+  }
+  return chunk.rows() > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+}
@@ -24,6 +24,7 @@ See the Mulan PSL v2 for more details. */
 class Record;
 class TupleCellSpec;
 class Trx;
+class Chunk;
 
 /**
  * @brief 物理算子
@@ -40,6 +41,9 @@ enum class PhysicalOperatorType
   TABLE_SCAN,
   INDEX_SCAN,
   NESTED_LOOP_JOIN,
+  HASH_JOIN,
+  INDEX_NESTED_LOOP_JOIN,
+  MERGE_JOIN,
   EXPLAIN,
   PREDICATE,
   PROJECT,
@@ -75,6 +79,13 @@ public:
 
   virtual Tuple *current_tuple() = 0;
 
+  /**
+   * @brief 获取下一批数据
+   * @details 向量化执行使用的接口，数据按列存放在 chunk 中。返回成功时至少有一行有效的数据，没有数据时返回 RECORD_EOF。
+   * 默认实现逐行调用 next 和 current_tuple，把结果复制到 chunk 中，没有向量化的算子通过它接入向量化的执行。
+   */
+  virtual RC next_chunk(Chunk &chunk);
+
   void add_child(std::unique_ptr<PhysicalOperator> oper)
   {
     children_.emplace_back(std::move(oper));
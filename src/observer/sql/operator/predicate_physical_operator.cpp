@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/log/log.h"
 #include "sql/operator/predicate_physical_operator.h"
+#include "sql/expr/chunk.h"
 #include "storage/record/record.h"
 #include "sql/stmt/filter_stmt.h"
 #include "storage/field/field.h"
@@ -69,3 +70,24 @@ Tuple *PredicatePhysicalOperator::current_tuple()
 {
   return children_[0]->current_tuple();
 }
+
+RC PredicatePhysicalOperator::next_chunk(Chunk &chunk)
+{
+  RC rc = RC::SUCCESS;
+  PhysicalOperator *oper = children_.front().get();
+
+  Column result;
+  while (RC::SUCCESS == (rc = oper->next_chunk(chunk))) {
+    rc = expression_->get_column(chunk, result);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to evaluate predicate on chunk. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    chunk.filter(result);
+    if (chunk.size() > 0) {
+      return rc;
+    }
+  }
+  return rc;
+}
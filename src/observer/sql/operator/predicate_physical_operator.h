@@ -42,6 +42,8 @@ public:
 
   Tuple *current_tuple() override;
 
+  RC next_chunk(Chunk &chunk) override;
+
 private:
   std::unique_ptr<Expression> expression_;
 };
@@ -30,6 +30,11 @@ RC ProjectPhysicalOperator::open(Trx *trx)
     return rc;
   }
 
+  child_chunk_.clear();
+  chunk_.clear();
+  column_indexes_.clear();
+  row_ = 0;
+  tuple_.set_chunk(&chunk_);
   return RC::SUCCESS;
 }
 
@@ -38,7 +43,54 @@ RC ProjectPhysicalOperator::next()
   if (children_.empty()) {
     return RC::RECORD_EOF;
   }
-  return children_[0]->next();
+
+  if (row_ + 1 < chunk_.size()) {
+    row_++;
+    return RC::SUCCESS;
+  }
+
+  RC rc = next_chunk(chunk_);
+  if (rc != RC::SUCCESS) {
+    chunk_.reset();
+  }
+  row_ = 0;
+  return rc;
+}
+
+RC ProjectPhysicalOperator::next_chunk(Chunk &chunk)
+{
+  if (children_.empty()) {
+    return RC::RECORD_EOF;
+  }
+
+  RC rc = children_[0]->next_chunk(child_chunk_);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  if (column_indexes_.empty()) {
+    for (const TupleCellSpec &spec : specs_) {
+      const int index = child_chunk_.find_column(spec.table_name(), spec.field_name());
+      if (index < 0) {
+        LOG_WARN("no such column in child chunk. table=%s, field=%s", spec.table_name(), spec.field_name());
+        return RC::NOTFOUND;
+      }
+      column_indexes_.push_back(index);
+    }
+  }
+
+  if (chunk.column_num() == 0) {
+    for (const TupleCellSpec &spec : specs_) {
+      chunk.add_column(std::make_unique<Column>(), spec);
+    }
+  }
+
+  for (size_t i = 0; i < column_indexes_.size(); i++) {
+    chunk.column(i).reference(child_chunk_.column(column_indexes_[i]));
+  }
+  chunk.set_rows(child_chunk_.rows());
+  chunk.set_selection(child_chunk_);
+  return RC::SUCCESS;
 }
 
 RC ProjectPhysicalOperator::close()
@@ -50,7 +102,7 @@ RC ProjectPhysicalOperator::close()
 }
 Tuple *ProjectPhysicalOperator::current_tuple()
 {
-  tuple_.set_tuple(children_[0]->current_tuple());
+  tuple_.set_row(chunk_.row_at(row_));
   return &tuple_;
 }
 
@@ -58,6 +110,5 @@ void ProjectPhysicalOperator::add_projection(const Table *table, const FieldMeta
 {
   // 对单表来说，展示的(alias) 字段总是字段名称，
   // 对多表查询来说，展示的alias 需要带表名字
-  TupleCellSpec *spec = new TupleCellSpec(table->name(), field_meta->name(), field_meta->name());
-  tuple_.add_cell_spec(spec);
+  specs_.emplace_back(table->name(), field_meta->name(), field_meta->name());
 }
@@ -15,10 +15,13 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include "sql/operator/physical_operator.h"
+#include "sql/expr/chunk.h"
 
 /**
  * @brief 选择/投影物理算子
  * @ingroup PhysicalOperator
+ * @details 投影是查询结果的出口，从子算子按批获取数据，投影以后的列直接引用子算子的列，不复制数据。
+ * 逐行的接口 next/current_tuple 依次返回批次中的每一行。
  */
 class ProjectPhysicalOperator : public PhysicalOperator
 {
@@ -45,11 +48,18 @@ public:
 
   int cell_num() const
   {
-    return tuple_.cell_num();
+    return static_cast<int>(specs_.size());
   }
 
   Tuple *current_tuple() override;
 
+  RC next_chunk(Chunk &chunk) override;
+
 private:
-  ProjectTuple tuple_;
+  std::vector<TupleCellSpec> specs_;
+  std::vector<int>           column_indexes_;  ///< 每个投影的字段在子算子输出中的位置
+  Chunk                      child_chunk_;
+  Chunk                      chunk_;           ///< 逐行接口使用的当前批次
+  int                        row_ = 0;         ///< 当前行在 chunk_ 中是第几个有效行
+  ChunkTuple                 tuple_;
 };
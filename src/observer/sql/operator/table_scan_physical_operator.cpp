@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "sql/operator/table_scan_physical_operator.h"
+#include "sql/expr/chunk.h"
 #include "storage/table/table.h"
 #include "event/sql_debug.h"
 
@@ -70,6 +71,43 @@ Tuple *TableScanPhysicalOperator::current_tuple()
   return &tuple_;
 }
 
+RC TableScanPhysicalOperator::next_chunk(Chunk &chunk)
+{
+  const vector<FieldMeta> &field_metas = *table_->table_meta().field_metas();
+  if (chunk.column_num() == 0) {
+    for (const FieldMeta &field_meta : field_metas) {
+      chunk.add_column(make_unique<Column>(field_meta.type(), field_meta.len(), Chunk::MAX_ROWS),
+                       TupleCellSpec(table_->name(), field_meta.name()));
+    }
+  }
+
+  RC rc = RC::SUCCESS;
+  while (record_scanner_.has_next()) {
+    chunk.reset();
+    while (chunk.rows() < Chunk::MAX_ROWS && record_scanner_.has_next()) {
+      rc = record_scanner_.next(current_record_);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+
+      const char *data = current_record_.data();
+      for (size_t i = 0; i < field_metas.size(); i++) {
+        chunk.column(i).append(data + field_metas[i].offset());
+      }
+      chunk.set_rows(chunk.rows() + 1);
+    }
+
+    rc = filter(chunk);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    if (chunk.size() > 0) {
+      return RC::SUCCESS;
+    }
+  }
+  return RC::RECORD_EOF;
+}
+
 string TableScanPhysicalOperator::param() const
 {
   return table_->name();
@@ -100,3 +138,20 @@ RC TableScanPhysicalOperator::filter(RowTuple &tuple, bool &result)
   result = true;
   return rc;
 }
+
+RC TableScanPhysicalOperator::filter(Chunk &chunk)
+{
+  Column result;
+  for (unique_ptr<Expression> &expr : predicates_) {
+    RC rc = expr->get_column(chunk, result);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+
+    chunk.filter(result);
+    if (chunk.size() == 0) {
+      break;
+    }
+  }
+  return RC::SUCCESS;
+}
@@ -46,10 +46,16 @@ public:
 
   Tuple *current_tuple() override;
 
+  /**
+   * @brief 把记录中的字段直接复制到列中，再按列计算下推的过滤条件
+   */
+  RC next_chunk(Chunk &chunk) override;
+
   void set_predicates(std::vector<std::unique_ptr<Expression>> &&exprs);
 
 private:
   RC filter(RowTuple &tuple, bool &result);
+  RC filter(Chunk &chunk);
 
 private:
   Table *                                  table_ = nullptr;
@@ -69,5 +69,14 @@ RC UpdatePhysicalOperator::close()
   if (!children_.empty()) {
     children_[0]->close();
   }
+
+  // 扫描已经释放了所有页面的锁，现在可以修改索引了
+  if (trx_ != nullptr) {
+    RC rc = trx_->apply_index_updates();
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to update index entries: %s", strrc(rc));
+      return rc;
+    }
+  }
   return RC::SUCCESS;
 }
@@ -12,6 +12,8 @@ See the Mulan PSL v2 for more details. */
 // Created by Wangyunlai on 2023/08/16.
 //
 
+#include <algorithm>
+
 #include "sql/optimizer/logical_plan_generator.h"
 
 #include "sql/operator/logical_operator.h"
@@ -84,13 +86,81 @@ RC LogicalPlanGenerator::create_plan(CalcStmt *calc_stmt, std::unique_ptr<Logica
   return RC::SUCCESS;
 }
 
+/**
+ * @brief 把过滤条件中可以作为连接条件的比较移到连接算子中
+ * @details 连接条件是两个字段相等，一个字段属于左边已经连接的表，另一个字段属于右表。两个字段的类型要相同，
+ * 并且可以精确比较(INTS、CHARS)，浮点数比较时有误差，不能用哈希查找。移过去的条件左边总是引用左边的表。
+ */
+static void extract_join_conditions(ConjunctionExpr *conjunction, const vector<Table *> &left_tables,
+    const Table *right_table, JoinLogicalOperator &join_oper)
+{
+  if (conjunction == nullptr || conjunction->conjunction_type() != ConjunctionExpr::Type::AND) {
+    return;
+  }
+
+  auto in_left = [&left_tables](const Table *table) {
+    return find(left_tables.begin(), left_tables.end(), table) != left_tables.end();
+  };
+
+  vector<unique_ptr<Expression>> &children = conjunction->children();
+  for (auto iter = children.begin(); iter != children.end();) {
+    if ((*iter)->type() != ExprType::COMPARISON) {
+      ++iter;
+      continue;
+    }
+
+    auto comparison_expr = static_cast<ComparisonExpr *>(iter->get());
+    unique_ptr<Expression> &left_expr = comparison_expr->left();
+    unique_ptr<Expression> &right_expr = comparison_expr->right();
+    if (comparison_expr->comp() != EQUAL_TO || left_expr->type() != ExprType::FIELD ||
+        right_expr->type() != ExprType::FIELD) {
+      ++iter;
+      continue;
+    }
+
+    const Field &left_field = static_cast<FieldExpr *>(left_expr.get())->field();
+    const Field &right_field = static_cast<FieldExpr *>(right_expr.get())->field();
+    const AttrType attr_type = left_field.attr_type();
+    if (attr_type != right_field.attr_type() || (attr_type != INTS && attr_type != CHARS)) {
+      ++iter;
+      continue;
+    }
+
+    const bool left_first = in_left(left_field.table()) && right_field.table() == right_table;
+    const bool right_first = in_left(right_field.table()) && left_field.table() == right_table;
+    if (!left_first && !right_first) {
+      ++iter;
+      continue;
+    }
+    if (right_first) {
+      left_expr.swap(right_expr);
+    }
+
+    join_oper.expressions().emplace_back(std::move(*iter));
+    iter = children.erase(iter);
+  }
+}
+
 RC LogicalPlanGenerator::create_plan(
     SelectStmt *select_stmt, unique_ptr<LogicalOperator> &logical_operator)
 {
+  unique_ptr<LogicalOperator> predicate_oper;
+  RC rc = create_plan(select_stmt->filter_stmt(), predicate_oper);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to create predicate logical plan. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  ConjunctionExpr *conjunction = nullptr;
+  if (predicate_oper) {
+    conjunction = static_cast<ConjunctionExpr *>(predicate_oper->expressions().front().get());
+  }
+
   unique_ptr<LogicalOperator> table_oper(nullptr);
 
   const std::vector<Table *> &tables = select_stmt->tables();
   const std::vector<Field> &all_fields = select_stmt->query_fields();
+  std::vector<Table *> joined_tables;
   for (Table *table : tables) {
     std::vector<Field> fields;
     for (const Field &field : all_fields) {
@@ -106,15 +176,15 @@ RC LogicalPlanGenerator::create_plan(
       JoinLogicalOperator *join_oper = new JoinLogicalOperator;
       join_oper->add_child(std::move(table_oper));
       join_oper->add_child(std::move(table_get_oper));
+      extract_join_conditions(conjunction, joined_tables, table, *join_oper);
       table_oper = unique_ptr<LogicalOperator>(join_oper);
     }
+    joined_tables.push_back(table);
   }
 
-  unique_ptr<LogicalOperator> predicate_oper;
-  RC rc = create_plan(select_stmt->filter_stmt(), predicate_oper);
-  if (rc != RC::SUCCESS) {
-    LOG_WARN("failed to create predicate logical plan. rc=%s", strrc(rc));
-    return rc;
+  // 所有的条件都变成了连接条件
+  if (conjunction != nullptr && conjunction->children().empty()) {
+    predicate_oper.reset();
   }
 
   unique_ptr<LogicalOperator> project_oper(new ProjectLogicalOperator(all_fields));
@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 // Created by Wangyunlai on 2022/12/14.
 //
 
+#include <algorithm>
 #include <utility>
 
 #include "sql/optimizer/physical_plan_generator.h"
@@ -32,10 +33,14 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/explain_physical_operator.h"
 #include "sql/operator/join_logical_operator.h"
 #include "sql/operator/join_physical_operator.h"
+#include "sql/operator/hash_join_physical_operator.h"
+#include "sql/operator/index_nested_loop_join_physical_operator.h"
+#include "sql/operator/merge_join_physical_operator.h"
 #include "sql/operator/calc_logical_operator.h"
 #include "sql/operator/calc_physical_operator.h"
 #include "sql/expr/expression.h"
 #include "common/log/log.h"
+#include "storage/table/table.h"
 
 using namespace std;
 
@@ -93,6 +98,7 @@ RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, u
   // 看看是否有可以用于索引查找的表达式
   Table *table = table_get_oper.table();
 
+  // 等值查询优先使用哈希索引，没有哈希索引时使用第一个可用的B+树索引
   Index *index = nullptr;
   ValueExpr *value_expr = nullptr;
   for (auto &expr : predicates) {
@@ -111,14 +117,15 @@ RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, u
       }
 
       FieldExpr *field_expr = nullptr;
+      ValueExpr *field_value_expr = nullptr;
       if (left_expr->type() == ExprType::FIELD) {
         ASSERT(right_expr->type() == ExprType::VALUE, "right expr should be a value expr while left is field expr");
         field_expr = static_cast<FieldExpr *>(left_expr.get());
-        value_expr = static_cast<ValueExpr *>(right_expr.get());
+        field_value_expr = static_cast<ValueExpr *>(right_expr.get());
       } else if (right_expr->type() == ExprType::FIELD) {
         ASSERT(left_expr->type() == ExprType::VALUE, "left expr should be a value expr while right is a field expr");
         field_expr = static_cast<FieldExpr *>(right_expr.get());
-        value_expr = static_cast<ValueExpr *>(left_expr.get());
+        field_value_expr = static_cast<ValueExpr *>(left_expr.get());
       }
 
       if (field_expr == nullptr) {
@@ -126,10 +133,17 @@ RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, u
       }
 
       const Field &field = field_expr->field();
-      index = table->find_index_by_field(field.field_name());
-      if (nullptr != index) {
+      Index *hash_index = table->find_index_by_field(field.field_name(), HASH_INDEX);
+      if (nullptr != hash_index) {
+        index = hash_index;
+        value_expr = field_value_expr;
         break;
       }
+
+      if (nullptr == index) {
+        index = table->find_index_by_field(field.field_name());
+        value_expr = field_value_expr;
+      }
     }
   }
 
@@ -288,6 +302,31 @@ RC PhysicalPlanGenerator::create_plan(ExplainLogicalOperator &explain_oper, uniq
   return rc;
 }
 
+/**
+ * @brief 估计逻辑算子输出的行数，用来选择哈希连接的构建端
+ * @details 只根据表中的记录个数估计，不考虑过滤条件。等值连接按照较大的一端估计，笛卡尔积是两端的乘积
+ */
+static int64_t estimate_rows(LogicalOperator &oper)
+{
+  vector<unique_ptr<LogicalOperator>> &children = oper.children();
+  switch (oper.type()) {
+    case LogicalOperatorType::TABLE_GET: {
+      return static_cast<TableGetLogicalOperator &>(oper).table()->estimated_record_num();
+    }
+    case LogicalOperatorType::JOIN: {
+      const int64_t left_rows = estimate_rows(*children[0]);
+      const int64_t right_rows = estimate_rows(*children[1]);
+      if (!oper.expressions().empty()) {
+        return std::max(left_rows, right_rows);
+      }
+      return left_rows * right_rows;
+    }
+    default: {
+      return children.empty() ? 0 : estimate_rows(*children[0]);
+    }
+  }
+}
+
 RC PhysicalPlanGenerator::create_plan(JoinLogicalOperator &join_oper, unique_ptr<PhysicalOperator> &oper)
 {
   RC rc = RC::SUCCESS;
@@ -298,7 +337,37 @@ RC PhysicalPlanGenerator::create_plan(JoinLogicalOperator &join_oper, unique_ptr
     return RC::INTERNAL;
   }
 
-  unique_ptr<PhysicalOperator> join_physical_oper(new NestedLoopJoinPhysicalOperator);
+  vector<unique_ptr<Expression>> &join_exprs = join_oper.expressions();
+  if (!join_exprs.empty()) {
+    rc = create_index_join_plan(join_oper, oper);
+    if (rc != RC::SUCCESS || oper != nullptr) {
+      return rc;
+    }
+
+    rc = create_merge_join_plan(join_oper, oper);
+    if (rc != RC::SUCCESS || oper != nullptr) {
+      return rc;
+    }
+  }
+
+  // 有等值连接条件时使用哈希连接，在估计行数较少的一端建立哈希表
+  unique_ptr<PhysicalOperator> join_physical_oper;
+  if (join_exprs.empty()) {
+    join_physical_oper.reset(new NestedLoopJoinPhysicalOperator);
+  } else {
+    vector<unique_ptr<Expression>> left_keys;
+    vector<unique_ptr<Expression>> right_keys;
+    for (unique_ptr<Expression> &expr : join_exprs) {
+      auto comparison_expr = static_cast<ComparisonExpr *>(expr.get());
+      left_keys.emplace_back(std::move(comparison_expr->left()));
+      right_keys.emplace_back(std::move(comparison_expr->right()));
+    }
+
+    const bool build_left = estimate_rows(*child_opers[0]) < estimate_rows(*child_opers[1]);
+    join_physical_oper.reset(new HashJoinPhysicalOperator(
+        std::move(left_keys), std::move(right_keys), build_left, HashJoinConfig::from_properties().memory_limit));
+  }
+
   for (auto &child_oper : child_opers) {
     unique_ptr<PhysicalOperator> child_physical_oper;
     rc = create(*child_oper, child_physical_oper);
@@ -314,6 +383,143 @@ RC PhysicalPlanGenerator::create_plan(JoinLogicalOperator &join_oper, unique_ptr
   return rc;
 }
 
+/**
+ * @brief 没有用作连接键的其它连接条件，在连接以后过滤
+ */
+static void filter_by_join_exprs(vector<unique_ptr<Expression>> &join_exprs, unique_ptr<PhysicalOperator> &oper)
+{
+  if (join_exprs.empty()) {
+    return;
+  }
+
+  unique_ptr<Expression> conjunction_expr(new ConjunctionExpr(ConjunctionExpr::Type::AND, join_exprs));
+  unique_ptr<PhysicalOperator> predicate_oper(new PredicatePhysicalOperator(std::move(conjunction_expr)));
+  predicate_oper->add_child(std::move(oper));
+  oper = std::move(predicate_oper);
+}
+
+/**
+ * @brief 外表的每一行在内表索引中查找一次的代价，按照全表扫描一行的代价计算
+ * @details 查找需要从根节点走到叶子节点再读取记录，外表的行数乘以这个值不超过内表的行数时，
+ * 才认为索引嵌套循环连接比哈希连接读取内表所有的数据更好
+ */
+static constexpr int64_t INDEX_LOOKUP_COST = 4;
+
+RC PhysicalPlanGenerator::create_index_join_plan(JoinLogicalOperator &join_oper, unique_ptr<PhysicalOperator> &oper)
+{
+  vector<unique_ptr<LogicalOperator>> &child_opers = join_oper.children();
+  if (child_opers[1]->type() != LogicalOperatorType::TABLE_GET) {
+    return RC::SUCCESS;
+  }
+
+  auto &inner_oper = static_cast<TableGetLogicalOperator &>(*child_opers[1]);
+  Table *inner_table = inner_oper.table();
+  const int64_t outer_rows = estimate_rows(*child_opers[0]);
+  const int64_t inner_rows = estimate_rows(inner_oper);
+  if (outer_rows * INDEX_LOOKUP_COST > inner_rows) {
+    return RC::SUCCESS;
+  }
+
+  // 优先使用B+树索引，外表的键有序时可以复用叶子节点
+  vector<unique_ptr<Expression>> &join_exprs = join_oper.expressions();
+  Index *index = nullptr;
+  size_t key_index = 0;
+  for (size_t i = 0; i < join_exprs.size(); i++) {
+    auto comparison_expr = static_cast<ComparisonExpr *>(join_exprs[i].get());
+    auto inner_field_expr = static_cast<FieldExpr *>(comparison_expr->right().get());
+    const char *field_name = inner_field_expr->field_name();
+    Index *bplus_tree_index = inner_table->find_index_by_field(field_name, BPLUS_TREE_INDEX);
+    if (bplus_tree_index != nullptr) {
+      index = bplus_tree_index;
+      key_index = i;
+      break;
+    }
+    if (index == nullptr) {
+      index = inner_table->find_index_by_field(field_name);
+      key_index = i;
+    }
+  }
+  if (index == nullptr) {
+    return RC::SUCCESS;
+  }
+
+  unique_ptr<PhysicalOperator> outer_physical_oper;
+  RC rc = create(*child_opers[0], outer_physical_oper);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to create physical child oper. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  auto inner_scan_oper = make_unique<IndexScanPhysicalOperator>(inner_table, index, inner_oper.readonly());
+  inner_scan_oper->set_predicates(std::move(inner_oper.predicates()));
+
+  auto key_expr = static_cast<ComparisonExpr *>(join_exprs[key_index].get());
+  unique_ptr<PhysicalOperator> join_physical_oper(new IndexNestedLoopJoinPhysicalOperator(std::move(key_expr->left())));
+  join_physical_oper->add_child(std::move(outer_physical_oper));
+  join_physical_oper->add_child(std::move(inner_scan_oper));
+  join_exprs.erase(join_exprs.begin() + key_index);
+  filter_by_join_exprs(join_exprs, join_physical_oper);
+
+  oper = std::move(join_physical_oper);
+  return RC::SUCCESS;
+}
+
+/**
+ * @brief 逻辑算子能否按照 key 从小到大输出数据
+ * @details 目前只有表上有 key 字段的B+树索引时可以，返回使用的索引，否则返回空
+ */
+static Index *ordered_index(LogicalOperator &oper, const FieldExpr &key)
+{
+  if (oper.type() != LogicalOperatorType::TABLE_GET) {
+    return nullptr;
+  }
+
+  Table *table = static_cast<TableGetLogicalOperator &>(oper).table();
+  if (0 != strcmp(table->name(), key.table_name())) {
+    return nullptr;
+  }
+  return table->find_index_by_field(key.field_name(), BPLUS_TREE_INDEX);
+}
+
+RC PhysicalPlanGenerator::create_merge_join_plan(JoinLogicalOperator &join_oper, unique_ptr<PhysicalOperator> &oper)
+{
+  vector<unique_ptr<LogicalOperator>> &child_opers = join_oper.children();
+  vector<unique_ptr<Expression>> &join_exprs = join_oper.expressions();
+
+  // 找一个两端都可以按照连接键有序输出的连接条件
+  Index *left_index = nullptr;
+  Index *right_index = nullptr;
+  size_t key_index = 0;
+  for (; key_index < join_exprs.size(); key_index++) {
+    auto comparison_expr = static_cast<ComparisonExpr *>(join_exprs[key_index].get());
+    left_index = ordered_index(*child_opers[0], static_cast<FieldExpr &>(*comparison_expr->left()));
+    right_index = ordered_index(*child_opers[1], static_cast<FieldExpr &>(*comparison_expr->right()));
+    if (left_index != nullptr && right_index != nullptr) {
+      break;
+    }
+  }
+  if (key_index == join_exprs.size()) {
+    return RC::SUCCESS;
+  }
+
+  unique_ptr<PhysicalOperator> join_physical_oper;
+  auto key_expr = static_cast<ComparisonExpr *>(join_exprs[key_index].get());
+  join_physical_oper.reset(new MergeJoinPhysicalOperator(std::move(key_expr->left()), std::move(key_expr->right())));
+  Index *indexes[2] = {left_index, right_index};
+  for (int i = 0; i < 2; i++) {
+    auto &table_get_oper = static_cast<TableGetLogicalOperator &>(*child_opers[i]);
+    auto scan_oper = make_unique<IndexScanPhysicalOperator>(table_get_oper.table(), indexes[i], table_get_oper.readonly(),
+        nullptr /*left_value*/, false /*left_inclusive*/, nullptr /*right_value*/, false /*right_inclusive*/);
+    scan_oper->set_predicates(std::move(table_get_oper.predicates()));
+    join_physical_oper->add_child(std::move(scan_oper));
+  }
+  join_exprs.erase(join_exprs.begin() + key_index);
+  filter_by_join_exprs(join_exprs, join_physical_oper);
+
+  oper = std::move(join_physical_oper);
+  return RC::SUCCESS;
+}
+
 RC PhysicalPlanGenerator::create_plan(CalcLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper)
 {
   RC rc = RC::SUCCESS;
@@ -54,4 +54,16 @@ private:
   RC create_plan(ExplainLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
   RC create_plan(JoinLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
   RC create_plan(CalcLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
+
+  /**
+   * @brief 外表比内表小很多并且内表的连接字段上有索引时，生成索引嵌套循环连接
+   * @details 不满足条件时 oper 保持为空
+   */
+  RC create_index_join_plan(JoinLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
+
+  /**
+   * @brief 两端都可以按照同一个等值连接条件的字段有序输出时，生成排序归并连接
+   * @details 两端是有对应字段B+树索引的表时，按照索引的顺序扫描。不满足条件时 oper 保持为空
+   */
+  RC create_merge_join_plan(JoinLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
 };
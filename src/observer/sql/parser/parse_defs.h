@@ -183,6 +183,16 @@ struct DropTableSqlNode
   std::string relation_name;  ///< 要删除的表名
 };
 
+/**
+ * @brief 索引的类型
+ * @ingroup SQLParser
+ */
+enum IndexType
+{
+  BPLUS_TREE_INDEX,  ///< 默认的B+树索引
+  HASH_INDEX,        ///< 哈希索引(USING HASH)，只支持等值查询
+};
+
 /**
  * @brief 描述一个create index语句
  * @ingroup SQLParser
@@ -195,6 +205,8 @@ struct CreateIndexSqlNode
   std::string relation_name;   ///< Relation name
   std::string attribute_name;  ///< Attribute name
   bool is_unique;              ///< Judge whether use 'UNIQUE'
+  IndexType index_type;        ///< 索引的类型
+  bool prefix_compression;     ///< 是否使用前缀压缩的索引节点(COMPRESS)
 };
 
 /**
@@ -228,6 +240,16 @@ struct LoadDataSqlNode
   std::string file_name;
 };
 
+/**
+ * @brief 开始事务
+ * @ingroup SQLParser
+ * @details BEGIN [READ ONLY] 或者 START TRANSACTION [READ ONLY]
+ */
+struct BeginSqlNode
+{
+  bool read_only = false;  ///< 只读事务
+};
+
 /**
  * @brief 设置变量的值
  * @ingroup SQLParser
@@ -284,7 +306,7 @@ enum SqlCommandFlag
   SCF_SYNC,
   SCF_SHOW_TABLES,
   SCF_DESC_TABLE,
-  SCF_BEGIN,        ///< 事务开始语句，可以在这里扩展只读事务
+  SCF_BEGIN,        ///< 事务开始语句
   SCF_COMMIT,
   SCF_CLOG_SYNC,
   SCF_ROLLBACK,
@@ -316,6 +338,7 @@ public:
   LoadDataSqlNode           load_data;
   ExplainSqlNode            explain;
   SetVariableSqlNode        set_variable;
+  BeginSqlNode              begin;
 
 public:
   ParsedSqlNode();
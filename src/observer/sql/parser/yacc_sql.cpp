@@ -99,6 +99,34 @@ int yyerror(YYLTYPE *llocp, const char *sql_string, ParsedSqlResult *sql_result,
   return 0;
 }
 
+/**
+ * @brief 判断标识符是否是给定的关键字(不区分大小写)，并释放标识符
+ * @details START TRANSACTION、READ ONLY、USING HASH、COMPRESS 不作为保留字，词法分析时是普通的标识符，
+ * 这样它们仍然可以用作表名、字段名
+ */
+bool match_keyword(char *id, const char *keyword)
+{
+  bool matched = 0 == strcasecmp(id, keyword);
+  free(id);
+  return matched;
+}
+
+/**
+ * @brief 判断两个标识符是否依次是给定的两个关键字，并释放标识符
+ */
+bool match_keywords(char *first, char *second, const char *first_keyword, const char *second_keyword)
+{
+  bool first_matched  = match_keyword(first, first_keyword);
+  bool second_matched = match_keyword(second, second_keyword);
+  return first_matched && second_matched;
+}
+
+/**
+ * @brief 创建索引语句末尾的选项 [USING HASH] [COMPRESS]
+ */
+const int INDEX_OPTION_HASH     = 1;
+const int INDEX_OPTION_COMPRESS = 2;
+
 ArithmeticExpr *create_arithmetic_expression(ArithmeticExpr::Type type,
                                              Expression *left,
                                              Expression *right,
@@ -111,7 +139,7 @@ ArithmeticExpr *create_arithmetic_expression(ArithmeticExpr::Type type,
 }
 
 
-#line 115 "yacc_sql.cpp"
+#line 143 "yacc_sql.cpp"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -204,41 +232,43 @@ enum yysymbol_kind_t
   YYSYMBOL_help_stmt = 62,                 /* help_stmt  */
   YYSYMBOL_sync_stmt = 63,                 /* sync_stmt  */
   YYSYMBOL_begin_stmt = 64,                /* begin_stmt  */
-  YYSYMBOL_commit_stmt = 65,               /* commit_stmt  */
-  YYSYMBOL_rollback_stmt = 66,             /* rollback_stmt  */
-  YYSYMBOL_drop_table_stmt = 67,           /* drop_table_stmt  */
-  YYSYMBOL_show_tables_stmt = 68,          /* show_tables_stmt  */
-  YYSYMBOL_desc_table_stmt = 69,           /* desc_table_stmt  */
-  YYSYMBOL_create_index_stmt = 70,         /* create_index_stmt  */
-  YYSYMBOL_drop_index_stmt = 71,           /* drop_index_stmt  */
-  YYSYMBOL_create_table_stmt = 72,         /* create_table_stmt  */
-  YYSYMBOL_attr_def_list = 73,             /* attr_def_list  */
-  YYSYMBOL_attr_def = 74,                  /* attr_def  */
-  YYSYMBOL_number = 75,                    /* number  */
-  YYSYMBOL_type = 76,                      /* type  */
-  YYSYMBOL_insert_stmt = 77,               /* insert_stmt  */
-  YYSYMBOL_value_list_list = 78,           /* value_list_list  */
-  YYSYMBOL_value_tuple = 79,               /* value_tuple  */
-  YYSYMBOL_value_list = 80,                /* value_list  */
-  YYSYMBOL_value = 81,                     /* value  */
-  YYSYMBOL_delete_stmt = 82,               /* delete_stmt  */
-  YYSYMBOL_update_stmt = 83,               /* update_stmt  */
-  YYSYMBOL_select_stmt = 84,               /* select_stmt  */
-  YYSYMBOL_calc_stmt = 85,                 /* calc_stmt  */
-  YYSYMBOL_expression_list = 86,           /* expression_list  */
-  YYSYMBOL_expression = 87,                /* expression  */
-  YYSYMBOL_select_attr = 88,               /* select_attr  */
-  YYSYMBOL_rel_attr = 89,                  /* rel_attr  */
-  YYSYMBOL_attr_list = 90,                 /* attr_list  */
-  YYSYMBOL_rel_list = 91,                  /* rel_list  */
-  YYSYMBOL_where = 92,                     /* where  */
-  YYSYMBOL_condition_list = 93,            /* condition_list  */
-  YYSYMBOL_condition = 94,                 /* condition  */
-  YYSYMBOL_comp_op = 95,                   /* comp_op  */
-  YYSYMBOL_load_data_stmt = 96,            /* load_data_stmt  */
-  YYSYMBOL_explain_stmt = 97,              /* explain_stmt  */
-  YYSYMBOL_set_variable_stmt = 98,         /* set_variable_stmt  */
-  YYSYMBOL_opt_semicolon = 99              /* opt_semicolon  */
+  YYSYMBOL_opt_read_only = 65,             /* opt_read_only  */
+  YYSYMBOL_commit_stmt = 66,               /* commit_stmt  */
+  YYSYMBOL_rollback_stmt = 67,             /* rollback_stmt  */
+  YYSYMBOL_drop_table_stmt = 68,           /* drop_table_stmt  */
+  YYSYMBOL_show_tables_stmt = 69,          /* show_tables_stmt  */
+  YYSYMBOL_desc_table_stmt = 70,           /* desc_table_stmt  */
+  YYSYMBOL_create_index_stmt = 71,         /* create_index_stmt  */
+  YYSYMBOL_opt_index_options = 72,         /* opt_index_options  */
+  YYSYMBOL_drop_index_stmt = 73,           /* drop_index_stmt  */
+  YYSYMBOL_create_table_stmt = 74,         /* create_table_stmt  */
+  YYSYMBOL_attr_def_list = 75,             /* attr_def_list  */
+  YYSYMBOL_attr_def = 76,                  /* attr_def  */
+  YYSYMBOL_number = 77,                    /* number  */
+  YYSYMBOL_type = 78,                      /* type  */
+  YYSYMBOL_insert_stmt = 79,               /* insert_stmt  */
+  YYSYMBOL_value_list_list = 80,           /* value_list_list  */
+  YYSYMBOL_value_tuple = 81,               /* value_tuple  */
+  YYSYMBOL_value_list = 82,                /* value_list  */
+  YYSYMBOL_value = 83,                     /* value  */
+  YYSYMBOL_delete_stmt = 84,               /* delete_stmt  */
+  YYSYMBOL_update_stmt = 85,               /* update_stmt  */
+  YYSYMBOL_select_stmt = 86,               /* select_stmt  */
+  YYSYMBOL_calc_stmt = 87,                 /* calc_stmt  */
+  YYSYMBOL_expression_list = 88,           /* expression_list  */
+  YYSYMBOL_expression = 89,                /* expression  */
+  YYSYMBOL_select_attr = 90,               /* select_attr  */
+  YYSYMBOL_rel_attr = 91,                  /* rel_attr  */
+  YYSYMBOL_attr_list = 92,                 /* attr_list  */
+  YYSYMBOL_rel_list = 93,                  /* rel_list  */
+  YYSYMBOL_where = 94,                     /* where  */
+  YYSYMBOL_condition_list = 95,            /* condition_list  */
+  YYSYMBOL_condition = 96,                 /* condition  */
+  YYSYMBOL_comp_op = 97,                   /* comp_op  */
+  YYSYMBOL_load_data_stmt = 98,            /* load_data_stmt  */
+  YYSYMBOL_explain_stmt = 99,              /* explain_stmt  */
+  YYSYMBOL_set_variable_stmt = 100,        /* set_variable_stmt  */
+  YYSYMBOL_opt_semicolon = 101             /* opt_semicolon  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -567,18 +597,18 @@ union yyalloc
 #endif /* !YYCOPY_NEEDED */
 
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  66
+#define YYFINAL  70
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   157
+#define YYLAST   175
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  58
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  42
+#define YYNNTS  44
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  95
+#define YYNRULES  102
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  181
+#define YYNSTATES  192
 
 /* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   308
@@ -632,16 +662,17 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,   179,   179,   187,   188,   189,   190,   191,   192,   193,
-     194,   195,   196,   197,   198,   199,   200,   201,   202,   203,
-     204,   205,   206,   210,   216,   221,   227,   233,   239,   245,
-     252,   258,   266,   278,   293,   304,   324,   327,   340,   348,
-     359,   363,   367,   371,   378,   394,   401,   410,   413,   426,
-     429,   441,   445,   449,   457,   470,   486,   515,   525,   530,
-     542,   545,   548,   551,   554,   558,   561,   569,   576,   588,
-     593,   604,   607,   621,   624,   633,   650,   653,   660,   663,
-     668,   676,   688,   700,   712,   727,   731,   734,   737,   740,
-     743,   749,   762,   770,   780,   781
+       0,   209,   209,   217,   218,   219,   220,   221,   222,   223,
+     224,   225,   226,   227,   228,   229,   230,   231,   232,   233,
+     234,   235,   236,   240,   246,   251,   257,   265,   277,   280,
+     288,   294,   300,   307,   313,   321,   342,   367,   370,   375,
+     379,   388,   399,   419,   422,   435,   443,   454,   458,   462,
+     466,   473,   489,   496,   505,   508,   521,   524,   536,   540,
+     544,   552,   565,   581,   610,   620,   625,   637,   640,   643,
+     646,   649,   653,   656,   664,   671,   683,   688,   699,   702,
+     716,   719,   728,   745,   748,   755,   758,   763,   771,   783,
+     795,   807,   822,   826,   829,   832,   835,   838,   844,   857,
+     865,   875,   876
 };
 #endif
 
@@ -665,15 +696,16 @@ static const char *const yytname[] =
   "WHERE", "AND", "SET", "ON", "LOAD", "DATA", "INFILE", "EXPLAIN", "EQ",
   "LT", "GT", "LE", "GE", "NE", "NUMBER", "FLOAT", "ID", "SSS", "'+'",
   "'-'", "'*'", "'/'", "UMINUS", "$accept", "commands", "command_wrapper",
-  "exit_stmt", "help_stmt", "sync_stmt", "begin_stmt", "commit_stmt",
-  "rollback_stmt", "drop_table_stmt", "show_tables_stmt",
-  "desc_table_stmt", "create_index_stmt", "drop_index_stmt",
-  "create_table_stmt", "attr_def_list", "attr_def", "number", "type",
-  "insert_stmt", "value_list_list", "value_tuple", "value_list", "value",
-  "delete_stmt", "update_stmt", "select_stmt", "calc_stmt",
-  "expression_list", "expression", "select_attr", "rel_attr", "attr_list",
-  "rel_list", "where", "condition_list", "condition", "comp_op",
-  "load_data_stmt", "explain_stmt", "set_variable_stmt", "opt_semicolon", YY_NULLPTR
+  "exit_stmt", "help_stmt", "sync_stmt", "begin_stmt", "opt_read_only",
+  "commit_stmt", "rollback_stmt", "drop_table_stmt", "show_tables_stmt",
+  "desc_table_stmt", "create_index_stmt", "opt_index_options",
+  "drop_index_stmt", "create_table_stmt", "attr_def_list", "attr_def",
+  "number", "type", "insert_stmt", "value_list_list", "value_tuple",
+  "value_list", "value", "delete_stmt", "update_stmt", "select_stmt",
+  "calc_stmt", "expression_list", "expression", "select_attr", "rel_attr",
+  "attr_list", "rel_list", "where", "condition_list", "condition",
+  "comp_op", "load_data_stmt", "explain_stmt", "set_variable_stmt",
+  "opt_semicolon", YY_NULLPTR
 };
 
 static const char *
@@ -683,7 +715,7 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#define YYPACT_NINF (-145)
+#define YYPACT_NINF (-149)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
@@ -697,25 +729,26 @@ yysymbol_name (yysymbol_kind_t yysymbol)
    STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-      10,     5,    40,    16,   -46,   -39,     9,  -145,    13,   -15,
-     -14,  -145,  -145,  -145,  -145,  -145,    -1,    11,    10,    57,
-      60,  -145,  -145,  -145,  -145,  -145,  -145,  -145,  -145,  -145,
-    -145,  -145,  -145,  -145,  -145,  -145,  -145,  -145,  -145,  -145,
-    -145,    18,    21,    56,    26,    27,    16,  -145,  -145,  -145,
-      16,  -145,  -145,    20,    36,  -145,    53,    67,  -145,  -145,
-      49,    50,    65,    61,    62,  -145,  -145,  -145,  -145,    86,
-      68,    58,  -145,    69,     0,  -145,    16,    16,    16,    16,
-      16,    59,    63,    64,  -145,    75,    76,    66,   -42,    70,
-      72,    73,    74,    77,  -145,  -145,   -13,   -13,  -145,  -145,
-    -145,    -3,    67,    94,    44,  -145,    78,  -145,    84,    71,
-      97,   100,    79,  -145,   110,    80,    76,  -145,   -42,  -145,
-     104,    37,    37,  -145,    90,   -42,   121,  -145,  -145,  -145,
-     113,    72,   109,    82,   115,    85,    -3,  -145,   114,    94,
-    -145,  -145,  -145,  -145,  -145,  -145,    44,    44,    44,    76,
-      87,    88,    97,  -145,   119,    89,   103,  -145,   -42,   124,
-    -145,  -145,  -145,  -145,  -145,  -145,  -145,  -145,  -145,   125,
-    -145,  -145,   126,    44,   114,  -145,  -145,  -145,    -3,  -145,
-    -145
+      -2,    44,    28,    14,   -25,   -44,    39,  -149,    15,    17,
+      16,    23,  -149,  -149,  -149,  -149,    25,    35,    -2,    30,
+      65,    79,  -149,  -149,  -149,  -149,  -149,  -149,  -149,  -149,
+    -149,  -149,  -149,  -149,  -149,  -149,  -149,  -149,  -149,  -149,
+    -149,  -149,    33,    34,    78,    43,    48,    14,  -149,  -149,
+    -149,    14,  -149,  -149,    24,    69,  -149,    67,    81,  -149,
+    -149,    52,    53,    68,    55,  -149,    64,    70,  -149,    23,
+    -149,  -149,  -149,    89,    71,    59,  -149,    74,   -12,  -149,
+      14,    14,    14,    14,    14,    62,    63,    66,  -149,    82,
+      83,    72,  -149,    21,    73,  -149,    75,    76,    84,    77,
+    -149,  -149,   -31,   -31,  -149,  -149,  -149,     8,    81,    97,
+      46,  -149,    86,  -149,    87,    31,    99,   102,    80,  -149,
+     114,    85,    83,  -149,    21,  -149,   109,    45,    45,  -149,
+      96,    21,   127,  -149,  -149,  -149,   115,    75,   117,    88,
+     116,    90,     8,  -149,   119,    97,  -149,  -149,  -149,  -149,
+    -149,  -149,    46,    46,    46,    83,    91,    94,    99,  -149,
+     118,    93,   107,  -149,    21,   126,  -149,  -149,  -149,  -149,
+    -149,  -149,  -149,  -149,  -149,   130,  -149,   100,   132,    46,
+     119,  -149,  -149,   103,  -149,   100,     8,  -149,   104,  -149,
+    -149,  -149
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -724,44 +757,45 @@ static const yytype_int16 yypact[] =
 static const yytype_int8 yydefact[] =
 {
        0,     0,     0,     0,     0,     0,     0,    25,     0,     0,
-       0,    26,    27,    28,    24,    23,     0,     0,     0,     0,
-      94,    22,    21,    14,    15,    16,    17,     9,    10,    11,
-      12,    13,     8,     5,     7,     6,     4,     3,    18,    19,
-      20,     0,     0,     0,     0,     0,     0,    51,    52,    53,
-       0,    66,    57,    58,    69,    67,     0,    71,    31,    30,
-       0,     0,     0,     0,     0,    92,     1,    95,     2,     0,
-       0,     0,    29,     0,     0,    65,     0,     0,     0,     0,
-       0,     0,     0,     0,    68,     0,    76,     0,     0,     0,
-       0,     0,     0,     0,    64,    59,    60,    61,    62,    63,
-      70,    73,    71,    47,    78,    54,     0,    93,     0,     0,
-      36,     0,     0,    34,     0,     0,    76,    72,     0,    44,
-      45,     0,     0,    77,    79,     0,     0,    41,    42,    43,
-      39,     0,     0,     0,     0,     0,    73,    56,    49,    47,
-      85,    86,    87,    88,    89,    90,     0,     0,    78,    76,
-       0,     0,    36,    35,     0,     0,     0,    74,     0,     0,
-      46,    82,    84,    81,    83,    80,    55,    91,    40,     0,
-      37,    32,     0,    78,    49,    48,    38,    33,    73,    50,
-      75
+       0,    28,    30,    31,    24,    23,     0,     0,     0,     0,
+       0,   101,    22,    21,    14,    15,    16,    17,     9,    10,
+      11,    12,    13,     8,     5,     7,     6,     4,     3,    18,
+      19,    20,     0,     0,     0,     0,     0,     0,    58,    59,
+      60,     0,    73,    64,    65,    76,    74,     0,    78,    34,
+      33,     0,     0,     0,     0,    26,     0,     0,    99,    28,
+       1,   102,     2,     0,     0,     0,    32,     0,     0,    72,
+       0,     0,     0,     0,     0,     0,     0,     0,    75,     0,
+      83,     0,    29,     0,     0,    27,     0,     0,     0,     0,
+      71,    66,    67,    68,    69,    70,    77,    80,    78,    54,
+      85,    61,     0,   100,     0,     0,    43,     0,     0,    41,
+       0,     0,    83,    79,     0,    51,    52,     0,     0,    84,
+      86,     0,     0,    48,    49,    50,    46,     0,     0,     0,
+       0,     0,    80,    63,    56,    54,    92,    93,    94,    95,
+      96,    97,     0,     0,    85,    83,     0,     0,    43,    42,
+       0,     0,     0,    81,     0,     0,    53,    89,    91,    88,
+      90,    87,    62,    98,    47,     0,    44,    37,     0,    85,
+      56,    55,    45,    38,    35,    37,    80,    57,    39,    36,
+      82,    40
 };
 
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-    -145,  -145,   129,  -145,  -145,  -145,  -145,  -145,  -145,  -145,
-    -145,  -145,  -145,  -145,  -145,    -2,    17,  -145,  -145,  -145,
-      14,  -145,   -25,   -87,  -145,  -145,  -145,  -145,    81,    12,
-    -145,    -4,    52,  -134,  -113,  -144,  -145,    29,  -145,  -145,
-    -145,  -145
+    -149,  -149,   129,  -149,  -149,  -149,  -149,    92,  -149,  -149,
+    -149,  -149,  -149,  -149,   -32,  -149,  -149,    -1,    19,  -149,
+    -149,  -149,    13,  -149,   -21,   -92,  -149,  -149,  -149,  -149,
+      95,   -28,  -149,    -4,    54,  -138,  -117,  -148,  -149,    32,
+    -149,  -149,  -149,  -149
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_uint8 yydefgoto[] =
 {
-       0,    19,    20,    21,    22,    23,    24,    25,    26,    27,
-      28,    29,    30,    31,    32,   132,   110,   169,   130,    33,
-     119,   120,   159,    51,    34,    35,    36,    37,    52,    53,
-      56,   122,    84,   116,   105,   123,   124,   146,    38,    39,
-      40,    68
+       0,    20,    21,    22,    23,    24,    25,    65,    26,    27,
+      28,    29,    30,    31,   184,    32,    33,   138,   116,   175,
+     136,    34,   125,   126,   165,    52,    35,    36,    37,    38,
+      53,    54,    57,   128,    88,   122,   111,   129,   130,   152,
+      39,    40,    41,    72
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
@@ -769,42 +803,46 @@ static const yytype_uint8 yydefgoto[] =
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_uint8 yytable[] =
 {
-      57,   107,   157,   137,   165,    54,   114,    47,    48,    55,
-      49,    41,    58,    42,     1,     2,    59,   121,   115,    61,
-      94,     3,     4,     5,     6,     7,     8,     9,    10,   178,
-      43,   138,    11,    12,    13,    46,   166,    62,   149,    14,
-      15,    76,    79,    80,   180,    60,    44,    16,    45,    17,
-      63,    64,    18,    77,    78,    79,    80,    66,    74,   161,
-     163,   121,    75,    67,    71,    47,    48,    81,    49,    69,
-      50,   174,    70,    77,    78,    79,    80,    72,    73,   102,
-     140,   141,   142,   143,   144,   145,   121,    82,    83,    96,
-      97,    98,    99,    47,    48,    54,    49,   127,   128,   129,
-      85,    86,    87,    89,    88,    90,    91,    93,   103,    92,
-     100,   104,   112,   118,   101,    54,   126,   106,   131,   133,
-     135,   125,   108,   109,   111,   139,   148,   150,   113,   153,
-     134,   136,   151,   154,   155,   158,   156,   168,   167,   171,
-     172,   173,   162,   164,   175,   176,   177,    65,   152,   179,
-     170,   147,     0,   160,   117,     0,     0,    95
+      58,   113,     1,     2,   163,   143,   171,    59,   100,     3,
+       4,     5,     6,     7,     8,     9,    10,   120,   127,    78,
+      11,    12,    13,    79,    83,    84,    55,    14,    15,   121,
+      56,   186,   144,    47,    45,    16,    46,    17,   172,   155,
+      18,    81,    82,    83,    84,    80,    60,    61,   190,    19,
+      42,    62,    43,   102,   103,   104,   105,   133,   134,   135,
+     167,   169,   127,    48,    49,    70,    50,    63,    51,    44,
+      48,    49,   180,    50,    64,    67,    66,    81,    82,    83,
+      84,    69,    71,   108,    73,    74,    75,   127,   146,   147,
+     148,   149,   150,   151,    76,    48,    49,    55,    50,    77,
+      85,    86,    87,    89,    90,    91,    92,    93,    96,    97,
+      98,    94,    99,   106,   107,   109,   124,    55,   110,   132,
+     137,   139,   118,   112,   141,   114,   115,   117,   119,   131,
+     145,   140,   154,   156,   157,   161,   142,   159,   177,   160,
+     164,   162,   173,   174,   178,   179,   181,    68,   168,   170,
+     182,   183,   185,   189,   188,   191,   158,   176,   166,   187,
+     153,    95,   123,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,   101
 };
 
 static const yytype_int16 yycheck[] =
 {
-       4,    88,   136,   116,   148,    51,     9,    49,    50,    55,
-      52,     6,    51,     8,     4,     5,     7,   104,    21,    34,
-      20,    11,    12,    13,    14,    15,    16,    17,    18,   173,
-      25,   118,    22,    23,    24,    19,   149,    51,   125,    29,
-      30,    21,    55,    56,   178,    32,     6,    37,     8,    39,
-      51,    40,    42,    53,    54,    55,    56,     0,    46,   146,
-     147,   148,    50,     3,     8,    49,    50,    31,    52,    51,
-      54,   158,    51,    53,    54,    55,    56,    51,    51,    83,
-      43,    44,    45,    46,    47,    48,   173,    34,    21,    77,
-      78,    79,    80,    49,    50,    51,    52,    26,    27,    28,
-      51,    51,    37,    41,    43,    19,    38,    38,    33,    51,
-      51,    35,    38,    19,    51,    51,    32,    51,    21,    19,
-      10,    43,    52,    51,    51,    21,    36,     6,    51,    20,
-      51,    51,    19,    51,    19,    21,    51,    49,    51,    20,
-      51,    38,   146,   147,    20,    20,    20,    18,   131,   174,
-     152,   122,    -1,   139,   102,    -1,    -1,    76
+       4,    93,     4,     5,   142,   122,   154,    51,    20,    11,
+      12,    13,    14,    15,    16,    17,    18,     9,   110,    47,
+      22,    23,    24,    51,    55,    56,    51,    29,    30,    21,
+      55,   179,   124,    19,     6,    37,     8,    39,   155,   131,
+      42,    53,    54,    55,    56,    21,     7,    32,   186,    51,
+       6,    34,     8,    81,    82,    83,    84,    26,    27,    28,
+     152,   153,   154,    49,    50,     0,    52,    51,    54,    25,
+      49,    50,   164,    52,    51,    40,    51,    53,    54,    55,
+      56,    51,     3,    87,    51,    51,     8,   179,    43,    44,
+      45,    46,    47,    48,    51,    49,    50,    51,    52,    51,
+      31,    34,    21,    51,    51,    37,    51,    43,    19,    38,
+      51,    41,    38,    51,    51,    33,    19,    51,    35,    32,
+      21,    19,    38,    51,    10,    52,    51,    51,    51,    43,
+      21,    51,    36,     6,    19,    19,    51,    20,    20,    51,
+      21,    51,    51,    49,    51,    38,    20,    18,   152,   153,
+      20,    51,    20,   185,    51,    51,   137,   158,   145,   180,
+     128,    69,   108,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    80
 };
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
@@ -812,24 +850,25 @@ static const yytype_int16 yycheck[] =
 static const yytype_int8 yystos[] =
 {
        0,     4,     5,    11,    12,    13,    14,    15,    16,    17,
-      18,    22,    23,    24,    29,    30,    37,    39,    42,    59,
-      60,    61,    62,    63,    64,    65,    66,    67,    68,    69,
-      70,    71,    72,    77,    82,    83,    84,    85,    96,    97,
-      98,     6,     8,    25,     6,     8,    19,    49,    50,    52,
-      54,    81,    86,    87,    51,    55,    88,    89,    51,     7,
-      32,    34,    51,    51,    40,    60,     0,     3,    99,    51,
-      51,     8,    51,    51,    87,    87,    21,    53,    54,    55,
-      56,    31,    34,    21,    90,    51,    51,    37,    43,    41,
-      19,    38,    51,    38,    20,    86,    87,    87,    87,    87,
-      51,    51,    89,    33,    35,    92,    51,    81,    52,    51,
-      74,    51,    38,    51,     9,    21,    91,    90,    19,    78,
-      79,    81,    89,    93,    94,    43,    32,    26,    27,    28,
-      76,    21,    73,    19,    51,    10,    51,    92,    81,    21,
-      43,    44,    45,    46,    47,    48,    95,    95,    36,    81,
-       6,    19,    74,    20,    51,    19,    51,    91,    21,    80,
-      78,    81,    89,    81,    89,    93,    92,    51,    49,    75,
-      73,    20,    51,    38,    81,    20,    20,    20,    93,    80,
-      91
+      18,    22,    23,    24,    29,    30,    37,    39,    42,    51,
+      59,    60,    61,    62,    63,    64,    66,    67,    68,    69,
+      70,    71,    73,    74,    79,    84,    85,    86,    87,    98,
+      99,   100,     6,     8,    25,     6,     8,    19,    49,    50,
+      52,    54,    83,    88,    89,    51,    55,    90,    91,    51,
+       7,    32,    34,    51,    51,    65,    51,    40,    60,    51,
+       0,     3,   101,    51,    51,     8,    51,    51,    89,    89,
+      21,    53,    54,    55,    56,    31,    34,    21,    92,    51,
+      51,    37,    51,    43,    41,    65,    19,    38,    51,    38,
+      20,    88,    89,    89,    89,    89,    51,    51,    91,    33,
+      35,    94,    51,    83,    52,    51,    76,    51,    38,    51,
+       9,    21,    93,    92,    19,    80,    81,    83,    91,    95,
+      96,    43,    32,    26,    27,    28,    78,    21,    75,    19,
+      51,    10,    51,    94,    83,    21,    43,    44,    45,    46,
+      47,    48,    97,    97,    36,    83,     6,    19,    76,    20,
+      51,    19,    51,    93,    21,    82,    80,    83,    91,    83,
+      91,    95,    94,    51,    49,    77,    75,    20,    51,    38,
+      83,    20,    20,    51,    72,    20,    95,    82,    51,    72,
+      93,    51
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
@@ -837,14 +876,15 @@ static const yytype_int8 yyr1[] =
 {
        0,    58,    59,    60,    60,    60,    60,    60,    60,    60,
       60,    60,    60,    60,    60,    60,    60,    60,    60,    60,
-      60,    60,    60,    61,    62,    63,    64,    65,    66,    67,
-      68,    69,    70,    70,    71,    72,    73,    73,    74,    74,
-      75,    76,    76,    76,    77,    78,    78,    79,    79,    80,
-      80,    81,    81,    81,    82,    83,    84,    85,    86,    86,
-      87,    87,    87,    87,    87,    87,    87,    88,    88,    89,
-      89,    90,    90,    91,    91,    91,    92,    92,    93,    93,
-      93,    94,    94,    94,    94,    95,    95,    95,    95,    95,
-      95,    96,    97,    98,    99,    99
+      60,    60,    60,    61,    62,    63,    64,    64,    65,    65,
+      66,    67,    68,    69,    70,    71,    71,    72,    72,    72,
+      72,    73,    74,    75,    75,    76,    76,    77,    78,    78,
+      78,    79,    80,    80,    81,    81,    82,    82,    83,    83,
+      83,    84,    85,    86,    87,    88,    88,    89,    89,    89,
+      89,    89,    89,    89,    90,    90,    91,    91,    92,    92,
+      93,    93,    93,    94,    94,    95,    95,    95,    96,    96,
+      96,    96,    97,    97,    97,    97,    97,    97,    98,    99,
+     100,   101,   101
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
@@ -852,14 +892,15 @@ static const yytype_int8 yyr2[] =
 {
        0,     2,     2,     1,     1,     1,     1,     1,     1,     1,
        1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
-       1,     1,     1,     1,     1,     1,     1,     1,     1,     3,
-       2,     2,     8,     9,     5,     7,     0,     3,     5,     2,
-       1,     1,     1,     1,     5,     1,     3,     0,     4,     0,
-       3,     1,     1,     1,     4,     7,     6,     2,     1,     3,
-       3,     3,     3,     3,     3,     2,     1,     1,     2,     1,
-       3,     0,     3,     0,     3,     6,     0,     2,     0,     1,
-       3,     3,     3,     3,     3,     1,     1,     1,     1,     1,
-       1,     7,     2,     4,     0,     1
+       1,     1,     1,     1,     1,     1,     2,     3,     0,     2,
+       1,     1,     3,     2,     2,     9,    10,     0,     1,     2,
+       3,     5,     7,     0,     3,     5,     2,     1,     1,     1,
+       1,     5,     1,     3,     0,     4,     0,     3,     1,     1,
+       1,     4,     7,     6,     2,     1,     3,     3,     3,     3,
+       3,     3,     2,     1,     1,     2,     1,     3,     0,     3,
+       0,     3,     6,     0,     2,     0,     1,     3,     3,     3,
+       3,     3,     1,     1,     1,     1,     1,     1,     7,     2,
+       4,     0,     1
 };
 
 
@@ -1721,125 +1762,213 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* commands: command_wrapper opt_semicolon  */
-#line 180 "yacc_sql.y"
+#line 210 "yacc_sql.y"
   {
     std::unique_ptr<ParsedSqlNode> sql_node = std::unique_ptr<ParsedSqlNode>((yyvsp[-1].sql_node));
     sql_result->add_sql_node(std::move(sql_node));
   }
-#line 1730 "yacc_sql.cpp"
+#line 1771 "yacc_sql.cpp"
     break;
 
   case 23: /* exit_stmt: EXIT  */
-#line 210 "yacc_sql.y"
+#line 240 "yacc_sql.y"
          {
       (void)yynerrs;  // 这么写为了消除yynerrs未使用的告警。如果你有更好的方法欢迎提PR
       (yyval.sql_node) = new ParsedSqlNode(SCF_EXIT);
     }
-#line 1739 "yacc_sql.cpp"
+#line 1780 "yacc_sql.cpp"
     break;
 
   case 24: /* help_stmt: HELP  */
-#line 216 "yacc_sql.y"
+#line 246 "yacc_sql.y"
          {
       (yyval.sql_node) = new ParsedSqlNode(SCF_HELP);
     }
-#line 1747 "yacc_sql.cpp"
+#line 1788 "yacc_sql.cpp"
     break;
 
   case 25: /* sync_stmt: SYNC  */
-#line 221 "yacc_sql.y"
+#line 251 "yacc_sql.y"
          {
       (yyval.sql_node) = new ParsedSqlNode(SCF_SYNC);
     }
-#line 1755 "yacc_sql.cpp"
+#line 1796 "yacc_sql.cpp"
     break;
 
-  case 26: /* begin_stmt: TRX_BEGIN  */
-#line 227 "yacc_sql.y"
-               {
+  case 26: /* begin_stmt: TRX_BEGIN opt_read_only  */
+#line 257 "yacc_sql.y"
+                            {
+      if ((yyvsp[0].number) < 0) {
+        yyerror(&(yyloc), sql_string, sql_result, scanner, "syntax error");
+        YYERROR;
+      }
+      (yyval.sql_node) = new ParsedSqlNode(SCF_BEGIN);
+      (yyval.sql_node)->begin.read_only = (yyvsp[0].number) > 0;
+    }
+#line 1809 "yacc_sql.cpp"
+    break;
+
+  case 27: /* begin_stmt: ID ID opt_read_only  */
+#line 265 "yacc_sql.y"
+                          {
+      if (!match_keywords((yyvsp[-2].string), (yyvsp[-1].string), "start", "transaction") || (yyvsp[0].number) < 0) {
+        yyerror(&(yyloc), sql_string, sql_result, scanner, "syntax error");
+        YYERROR;
+      }
       (yyval.sql_node) = new ParsedSqlNode(SCF_BEGIN);
+      (yyval.sql_node)->begin.read_only = (yyvsp[0].number) > 0;
     }
-#line 1763 "yacc_sql.cpp"
+#line 1822 "yacc_sql.cpp"
     break;
 
-  case 27: /* commit_stmt: TRX_COMMIT  */
-#line 233 "yacc_sql.y"
+  case 28: /* opt_read_only: %empty  */
+#line 277 "yacc_sql.y"
+    {
+      (yyval.number) = 0;
+    }
+#line 1830 "yacc_sql.cpp"
+    break;
+
+  case 29: /* opt_read_only: ID ID  */
+#line 281 "yacc_sql.y"
+    {
+      // 不是 READ ONLY 时返回-1，由语句报告语法错误
+      (yyval.number) = match_keywords((yyvsp[-1].string), (yyvsp[0].string), "read", "only") ? 1 : -1;
+    }
+#line 1839 "yacc_sql.cpp"
+    break;
+
+  case 30: /* commit_stmt: TRX_COMMIT  */
+#line 288 "yacc_sql.y"
                {
       (yyval.sql_node) = new ParsedSqlNode(SCF_COMMIT);
     }
-#line 1771 "yacc_sql.cpp"
+#line 1847 "yacc_sql.cpp"
     break;
 
-  case 28: /* rollback_stmt: TRX_ROLLBACK  */
-#line 239 "yacc_sql.y"
+  case 31: /* rollback_stmt: TRX_ROLLBACK  */
+#line 294 "yacc_sql.y"
                   {
       (yyval.sql_node) = new ParsedSqlNode(SCF_ROLLBACK);
     }
-#line 1779 "yacc_sql.cpp"
+#line 1855 "yacc_sql.cpp"
     break;
 
-  case 29: /* drop_table_stmt: DROP TABLE ID  */
-#line 245 "yacc_sql.y"
+  case 32: /* drop_table_stmt: DROP TABLE ID  */
+#line 300 "yacc_sql.y"
                   {
       (yyval.sql_node) = new ParsedSqlNode(SCF_DROP_TABLE);
       (yyval.sql_node)->drop_table.relation_name = (yyvsp[0].string);
       free((yyvsp[0].string));
     }
-#line 1789 "yacc_sql.cpp"
+#line 1865 "yacc_sql.cpp"
     break;
 
-  case 30: /* show_tables_stmt: SHOW TABLES  */
-#line 252 "yacc_sql.y"
+  case 33: /* show_tables_stmt: SHOW TABLES  */
+#line 307 "yacc_sql.y"
                 {
       (yyval.sql_node) = new ParsedSqlNode(SCF_SHOW_TABLES);
     }
-#line 1797 "yacc_sql.cpp"
+#line 1873 "yacc_sql.cpp"
     break;
 
-  case 31: /* desc_table_stmt: DESC ID  */
-#line 258 "yacc_sql.y"
+  case 34: /* desc_table_stmt: DESC ID  */
+#line 313 "yacc_sql.y"
              {
       (yyval.sql_node) = new ParsedSqlNode(SCF_DESC_TABLE);
       (yyval.sql_node)->desc_table.relation_name = (yyvsp[0].string);
       free((yyvsp[0].string));
     }
-#line 1807 "yacc_sql.cpp"
+#line 1883 "yacc_sql.cpp"
     break;
 
-  case 32: /* create_index_stmt: CREATE INDEX ID ON ID LBRACE ID RBRACE  */
-#line 267 "yacc_sql.y"
+  case 35: /* create_index_stmt: CREATE INDEX ID ON ID LBRACE ID RBRACE opt_index_options  */
+#line 322 "yacc_sql.y"
     {
+      if ((yyvsp[0].number) < 0) {
+        free((yyvsp[-6].string));
+        free((yyvsp[-4].string));
+        free((yyvsp[-2].string));
+        yyerror(&(yyloc), sql_string, sql_result, scanner, "syntax error");
+        YYERROR;
+      }
       (yyval.sql_node) = new ParsedSqlNode(SCF_CREATE_INDEX);
       CreateIndexSqlNode &create_index = (yyval.sql_node)->create_index;
-      create_index.index_name = (yyvsp[-5].string);
-      create_index.relation_name = (yyvsp[-3].string);
-      create_index.attribute_name = (yyvsp[-1].string);
+      create_index.index_name = (yyvsp[-6].string);
+      create_index.relation_name = (yyvsp[-4].string);
+      create_index.attribute_name = (yyvsp[-2].string);
       create_index.is_unique = false;
-      free((yyvsp[-5].string));
-      free((yyvsp[-3].string));
-      free((yyvsp[-1].string));
+      create_index.index_type = ((yyvsp[0].number) & INDEX_OPTION_HASH) ? HASH_INDEX : BPLUS_TREE_INDEX;
+      create_index.prefix_compression = ((yyvsp[0].number) & INDEX_OPTION_COMPRESS) != 0;
+      free((yyvsp[-6].string));
+      free((yyvsp[-4].string));
+      free((yyvsp[-2].string));
     }
-#line 1823 "yacc_sql.cpp"
+#line 1908 "yacc_sql.cpp"
     break;
 
-  case 33: /* create_index_stmt: CREATE UNIQUE INDEX ID ON ID LBRACE ID RBRACE  */
-#line 279 "yacc_sql.y"
+  case 36: /* create_index_stmt: CREATE UNIQUE INDEX ID ON ID LBRACE ID RBRACE opt_index_options  */
+#line 343 "yacc_sql.y"
     {
+      if ((yyvsp[0].number) < 0) {
+        free((yyvsp[-6].string));
+        free((yyvsp[-4].string));
+        free((yyvsp[-2].string));
+        yyerror(&(yyloc), sql_string, sql_result, scanner, "syntax error");
+        YYERROR;
+      }
       (yyval.sql_node) = new ParsedSqlNode(SCF_CREATE_INDEX);
       CreateIndexSqlNode &create_index = (yyval.sql_node)->create_index;
-      create_index.index_name = (yyvsp[-5].string);
-      create_index.relation_name = (yyvsp[-3].string);
-      create_index.attribute_name = (yyvsp[-1].string);
+      create_index.index_name = (yyvsp[-6].string);
+      create_index.relation_name = (yyvsp[-4].string);
+      create_index.attribute_name = (yyvsp[-2].string);
       create_index.is_unique = true;
-      free((yyvsp[-5].string));
-      free((yyvsp[-3].string));
-      free((yyvsp[-1].string));
+      create_index.index_type = ((yyvsp[0].number) & INDEX_OPTION_HASH) ? HASH_INDEX : BPLUS_TREE_INDEX;
+      create_index.prefix_compression = ((yyvsp[0].number) & INDEX_OPTION_COMPRESS) != 0;
+      free((yyvsp[-6].string));
+      free((yyvsp[-4].string));
+      free((yyvsp[-2].string));
     }
-#line 1839 "yacc_sql.cpp"
+#line 1933 "yacc_sql.cpp"
     break;
 
-  case 34: /* drop_index_stmt: DROP INDEX ID ON ID  */
-#line 294 "yacc_sql.y"
+  case 37: /* opt_index_options: %empty  */
+#line 367 "yacc_sql.y"
+    {
+      (yyval.number) = 0;
+    }
+#line 1941 "yacc_sql.cpp"
+    break;
+
+  case 38: /* opt_index_options: ID  */
+#line 371 "yacc_sql.y"
+    {
+      // 选项不对时返回-1，由语句报告语法错误
+      (yyval.number) = match_keyword((yyvsp[0].string), "compress") ? INDEX_OPTION_COMPRESS : -1;
+    }
+#line 1950 "yacc_sql.cpp"
+    break;
+
+  case 39: /* opt_index_options: ID ID  */
+#line 376 "yacc_sql.y"
+    {
+      (yyval.number) = match_keywords((yyvsp[-1].string), (yyvsp[0].string), "using", "hash") ? INDEX_OPTION_HASH : -1;
+    }
+#line 1958 "yacc_sql.cpp"
+    break;
+
+  case 40: /* opt_index_options: ID ID ID  */
+#line 380 "yacc_sql.y"
+    {
+      bool hash     = match_keywords((yyvsp[-2].string), (yyvsp[-1].string), "using", "hash");
+      bool compress = match_keyword((yyvsp[0].string), "compress");
+      (yyval.number) = (hash && compress) ? (INDEX_OPTION_HASH | INDEX_OPTION_COMPRESS) : -1;
+    }
+#line 1968 "yacc_sql.cpp"
+    break;
+
+  case 41: /* drop_index_stmt: DROP INDEX ID ON ID  */
+#line 389 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_DROP_INDEX);
       (yyval.sql_node)->drop_index.index_name = (yyvsp[-2].string);
@@ -1847,11 +1976,11 @@ yyreduce:
       free((yyvsp[-2].string));
       free((yyvsp[0].string));
     }
-#line 1851 "yacc_sql.cpp"
+#line 1980 "yacc_sql.cpp"
     break;
 
-  case 35: /* create_table_stmt: CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE  */
-#line 305 "yacc_sql.y"
+  case 42: /* create_table_stmt: CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE  */
+#line 400 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_CREATE_TABLE);
       CreateTableSqlNode &create_table = (yyval.sql_node)->create_table;
@@ -1867,19 +1996,19 @@ yyreduce:
       std::reverse(create_table.attr_infos.begin(), create_table.attr_infos.end());
       delete (yyvsp[-2].attr_info);
     }
-#line 1871 "yacc_sql.cpp"
+#line 2000 "yacc_sql.cpp"
     break;
 
-  case 36: /* attr_def_list: %empty  */
-#line 324 "yacc_sql.y"
+  case 43: /* attr_def_list: %empty  */
+#line 419 "yacc_sql.y"
     {
       (yyval.attr_infos) = nullptr;
     }
-#line 1879 "yacc_sql.cpp"
+#line 2008 "yacc_sql.cpp"
     break;
 
-  case 37: /* attr_def_list: COMMA attr_def attr_def_list  */
-#line 328 "yacc_sql.y"
+  case 44: /* attr_def_list: COMMA attr_def attr_def_list  */
+#line 423 "yacc_sql.y"
     {
       if ((yyvsp[0].attr_infos) != nullptr) {
         (yyval.attr_infos) = (yyvsp[0].attr_infos);
@@ -1889,11 +2018,11 @@ yyreduce:
       (yyval.attr_infos)->emplace_back(*(yyvsp[-1].attr_info));
       delete (yyvsp[-1].attr_info);
     }
-#line 1893 "yacc_sql.cpp"
+#line 2022 "yacc_sql.cpp"
     break;
 
-  case 38: /* attr_def: ID type LBRACE number RBRACE  */
-#line 341 "yacc_sql.y"
+  case 45: /* attr_def: ID type LBRACE number RBRACE  */
+#line 436 "yacc_sql.y"
     {
       (yyval.attr_info) = new AttrInfoSqlNode;
       (yyval.attr_info)->type = (AttrType)(yyvsp[-3].number);
@@ -1901,11 +2030,11 @@ yyreduce:
       (yyval.attr_info)->length = (yyvsp[-1].number);
       free((yyvsp[-4].string));
     }
-#line 1905 "yacc_sql.cpp"
+#line 2034 "yacc_sql.cpp"
     break;
 
-  case 39: /* attr_def: ID type  */
-#line 349 "yacc_sql.y"
+  case 46: /* attr_def: ID type  */
+#line 444 "yacc_sql.y"
     {
       (yyval.attr_info) = new AttrInfoSqlNode;
       (yyval.attr_info)->type = (AttrType)(yyvsp[0].number);
@@ -1913,41 +2042,41 @@ yyreduce:
       (yyval.attr_info)->length = 4;
       free((yyvsp[-1].string));
     }
-#line 1917 "yacc_sql.cpp"
+#line 2046 "yacc_sql.cpp"
     break;
 
-  case 40: /* number: NUMBER  */
-#line 359 "yacc_sql.y"
+  case 47: /* number: NUMBER  */
+#line 454 "yacc_sql.y"
            {(yyval.number) = (yyvsp[0].number);}
-#line 1923 "yacc_sql.cpp"
+#line 2052 "yacc_sql.cpp"
     break;
 
-  case 41: /* type: INT_T  */
-#line 364 "yacc_sql.y"
+  case 48: /* type: INT_T  */
+#line 459 "yacc_sql.y"
     { 
       (yyval.number)=INTS;
     }
-#line 1931 "yacc_sql.cpp"
+#line 2060 "yacc_sql.cpp"
     break;
 
-  case 42: /* type: STRING_T  */
-#line 368 "yacc_sql.y"
+  case 49: /* type: STRING_T  */
+#line 463 "yacc_sql.y"
     { 
       (yyval.number)=CHARS; 
     }
-#line 1939 "yacc_sql.cpp"
+#line 2068 "yacc_sql.cpp"
     break;
 
-  case 43: /* type: FLOAT_T  */
-#line 372 "yacc_sql.y"
+  case 50: /* type: FLOAT_T  */
+#line 467 "yacc_sql.y"
     { 
       (yyval.number)=FLOATS; 
     }
-#line 1947 "yacc_sql.cpp"
+#line 2076 "yacc_sql.cpp"
     break;
 
-  case 44: /* insert_stmt: INSERT INTO ID VALUES value_list_list  */
-#line 379 "yacc_sql.y"
+  case 51: /* insert_stmt: INSERT INTO ID VALUES value_list_list  */
+#line 474 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_INSERT);
       (yyval.sql_node)->insertion.relation_name = (yyvsp[-2].string);
@@ -1959,11 +2088,11 @@ yyreduce:
       } 
       free((yyvsp[-2].string));
     }
-#line 1963 "yacc_sql.cpp"
+#line 2092 "yacc_sql.cpp"
     break;
 
-  case 45: /* value_list_list: value_tuple  */
-#line 394 "yacc_sql.y"
+  case 52: /* value_list_list: value_tuple  */
+#line 489 "yacc_sql.y"
                 {
       (yyval.value_list_list) = new std::vector<std::vector<Value>>;
       if ((yyvsp[0].value_list) != nullptr) {
@@ -1971,29 +2100,29 @@ yyreduce:
         delete (yyvsp[0].value_list);
       }
     }
-#line 1975 "yacc_sql.cpp"
+#line 2104 "yacc_sql.cpp"
     break;
 
-  case 46: /* value_list_list: value_tuple COMMA value_list_list  */
-#line 401 "yacc_sql.y"
+  case 53: /* value_list_list: value_tuple COMMA value_list_list  */
+#line 496 "yacc_sql.y"
                                         {
       (yyval.value_list_list) = (yyvsp[0].value_list_list);
       (yyval.value_list_list)->emplace_back(*(yyvsp[-2].value_list));
       delete (yyvsp[-2].value_list);
     }
-#line 1985 "yacc_sql.cpp"
+#line 2114 "yacc_sql.cpp"
     break;
 
-  case 47: /* value_tuple: %empty  */
-#line 410 "yacc_sql.y"
+  case 54: /* value_tuple: %empty  */
+#line 505 "yacc_sql.y"
     {
       (yyval.value_list) = nullptr;
     }
-#line 1993 "yacc_sql.cpp"
+#line 2122 "yacc_sql.cpp"
     break;
 
-  case 48: /* value_tuple: LBRACE value value_list RBRACE  */
-#line 413 "yacc_sql.y"
+  case 55: /* value_tuple: LBRACE value value_list RBRACE  */
+#line 508 "yacc_sql.y"
                                      {
       (yyval.value_list) = new std::vector<Value>;
       if ((yyvsp[-1].value_list) != nullptr) {
@@ -2003,19 +2132,19 @@ yyreduce:
       std::reverse((yyval.value_list)->begin(), (yyval.value_list)->end());
       delete (yyvsp[-2].value);
     }
-#line 2007 "yacc_sql.cpp"
+#line 2136 "yacc_sql.cpp"
     break;
 
-  case 49: /* value_list: %empty  */
-#line 426 "yacc_sql.y"
+  case 56: /* value_list: %empty  */
+#line 521 "yacc_sql.y"
     {
       (yyval.value_list) = nullptr;
     }
-#line 2015 "yacc_sql.cpp"
+#line 2144 "yacc_sql.cpp"
     break;
 
-  case 50: /* value_list: COMMA value value_list  */
-#line 429 "yacc_sql.y"
+  case 57: /* value_list: COMMA value value_list  */
+#line 524 "yacc_sql.y"
                               { 
       if ((yyvsp[0].value_list) != nullptr) {
         (yyval.value_list) = (yyvsp[0].value_list);
@@ -2025,39 +2154,39 @@ yyreduce:
       (yyval.value_list)->emplace_back(*(yyvsp[-1].value));
       delete (yyvsp[-1].value);
     }
-#line 2029 "yacc_sql.cpp"
+#line 2158 "yacc_sql.cpp"
     break;
 
-  case 51: /* value: NUMBER  */
-#line 441 "yacc_sql.y"
+  case 58: /* value: NUMBER  */
+#line 536 "yacc_sql.y"
            {
       (yyval.value) = new Value((int)(yyvsp[0].number));
       (yyloc) = (yylsp[0]);
     }
-#line 2038 "yacc_sql.cpp"
+#line 2167 "yacc_sql.cpp"
     break;
 
-  case 52: /* value: FLOAT  */
-#line 445 "yacc_sql.y"
+  case 59: /* value: FLOAT  */
+#line 540 "yacc_sql.y"
            {
       (yyval.value) = new Value((float)(yyvsp[0].floats));
       (yyloc) = (yylsp[0]);
     }
-#line 2047 "yacc_sql.cpp"
+#line 2176 "yacc_sql.cpp"
     break;
 
-  case 53: /* value: SSS  */
-#line 449 "yacc_sql.y"
+  case 60: /* value: SSS  */
+#line 544 "yacc_sql.y"
          {
       char *tmp = common::substr((yyvsp[0].string),1,strlen((yyvsp[0].string))-2);
       (yyval.value) = new Value(tmp);
       free(tmp);
     }
-#line 2057 "yacc_sql.cpp"
+#line 2186 "yacc_sql.cpp"
     break;
 
-  case 54: /* delete_stmt: DELETE FROM ID where  */
-#line 458 "yacc_sql.y"
+  case 61: /* delete_stmt: DELETE FROM ID where  */
+#line 553 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_DELETE);
       (yyval.sql_node)->deletion.relation_name = (yyvsp[-1].string);
@@ -2067,11 +2196,11 @@ yyreduce:
       }
       free((yyvsp[-1].string));
     }
-#line 2071 "yacc_sql.cpp"
+#line 2200 "yacc_sql.cpp"
     break;
 
-  case 55: /* update_stmt: UPDATE ID SET ID EQ value where  */
-#line 471 "yacc_sql.y"
+  case 62: /* update_stmt: UPDATE ID SET ID EQ value where  */
+#line 566 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_UPDATE);
       (yyval.sql_node)->update.relation_name = (yyvsp[-5].string);
@@ -2084,11 +2213,11 @@ yyreduce:
       free((yyvsp[-5].string));
       free((yyvsp[-3].string));
     }
-#line 2088 "yacc_sql.cpp"
+#line 2217 "yacc_sql.cpp"
     break;
 
-  case 56: /* select_stmt: SELECT select_attr FROM ID rel_list where  */
-#line 487 "yacc_sql.y"
+  case 63: /* select_stmt: SELECT select_attr FROM ID rel_list where  */
+#line 582 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_SELECT);
       if ((yyvsp[-4].rel_attr_list) != nullptr) {
@@ -2114,31 +2243,31 @@ yyreduce:
 
       free((yyvsp[-2].string));
     }
-#line 2118 "yacc_sql.cpp"
+#line 2247 "yacc_sql.cpp"
     break;
 
-  case 57: /* calc_stmt: CALC expression_list  */
-#line 516 "yacc_sql.y"
+  case 64: /* calc_stmt: CALC expression_list  */
+#line 611 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_CALC);
       std::reverse((yyvsp[0].expression_list)->begin(), (yyvsp[0].expression_list)->end());
       (yyval.sql_node)->calc.expressions.swap(*(yyvsp[0].expression_list));
       delete (yyvsp[0].expression_list);
     }
-#line 2129 "yacc_sql.cpp"
+#line 2258 "yacc_sql.cpp"
     break;
 
-  case 58: /* expression_list: expression  */
-#line 526 "yacc_sql.y"
+  case 65: /* expression_list: expression  */
+#line 621 "yacc_sql.y"
     {
       (yyval.expression_list) = new std::vector<Expression*>;
       (yyval.expression_list)->emplace_back((yyvsp[0].expression));
     }
-#line 2138 "yacc_sql.cpp"
+#line 2267 "yacc_sql.cpp"
     break;
 
-  case 59: /* expression_list: expression COMMA expression_list  */
-#line 531 "yacc_sql.y"
+  case 66: /* expression_list: expression COMMA expression_list  */
+#line 626 "yacc_sql.y"
     {
       if ((yyvsp[0].expression_list) != nullptr) {
         (yyval.expression_list) = (yyvsp[0].expression_list);
@@ -2147,70 +2276,70 @@ yyreduce:
       }
       (yyval.expression_list)->emplace_back((yyvsp[-2].expression));
     }
-#line 2151 "yacc_sql.cpp"
+#line 2280 "yacc_sql.cpp"
     break;
 
-  case 60: /* expression: expression '+' expression  */
-#line 542 "yacc_sql.y"
+  case 67: /* expression: expression '+' expression  */
+#line 637 "yacc_sql.y"
                               {
       (yyval.expression) = create_arithmetic_expression(ArithmeticExpr::Type::ADD, (yyvsp[-2].expression), (yyvsp[0].expression), sql_string, &(yyloc));
     }
-#line 2159 "yacc_sql.cpp"
+#line 2288 "yacc_sql.cpp"
     break;
 
-  case 61: /* expression: expression '-' expression  */
-#line 545 "yacc_sql.y"
+  case 68: /* expression: expression '-' expression  */
+#line 640 "yacc_sql.y"
                                 {
       (yyval.expression) = create_arithmetic_expression(ArithmeticExpr::Type::SUB, (yyvsp[-2].expression), (yyvsp[0].expression), sql_string, &(yyloc));
     }
-#line 2167 "yacc_sql.cpp"
+#line 2296 "yacc_sql.cpp"
     break;
 
-  case 62: /* expression: expression '*' expression  */
-#line 548 "yacc_sql.y"
+  case 69: /* expression: expression '*' expression  */
+#line 643 "yacc_sql.y"
                                 {
       (yyval.expression) = create_arithmetic_expression(ArithmeticExpr::Type::MUL, (yyvsp[-2].expression), (yyvsp[0].expression), sql_string, &(yyloc));
     }
-#line 2175 "yacc_sql.cpp"
+#line 2304 "yacc_sql.cpp"
     break;
 
-  case 63: /* expression: expression '/' expression  */
-#line 551 "yacc_sql.y"
+  case 70: /* expression: expression '/' expression  */
+#line 646 "yacc_sql.y"
                                 {
       (yyval.expression) = create_arithmetic_expression(ArithmeticExpr::Type::DIV, (yyvsp[-2].expression), (yyvsp[0].expression), sql_string, &(yyloc));
     }
-#line 2183 "yacc_sql.cpp"
+#line 2312 "yacc_sql.cpp"
     break;
 
-  case 64: /* expression: LBRACE expression RBRACE  */
-#line 554 "yacc_sql.y"
+  case 71: /* expression: LBRACE expression RBRACE  */
+#line 649 "yacc_sql.y"
                                {
       (yyval.expression) = (yyvsp[-1].expression);
       (yyval.expression)->set_name(token_name(sql_string, &(yyloc)));
     }
-#line 2192 "yacc_sql.cpp"
+#line 2321 "yacc_sql.cpp"
     break;
 
-  case 65: /* expression: '-' expression  */
-#line 558 "yacc_sql.y"
+  case 72: /* expression: '-' expression  */
+#line 653 "yacc_sql.y"
                                   {
       (yyval.expression) = create_arithmetic_expression(ArithmeticExpr::Type::NEGATIVE, (yyvsp[0].expression), nullptr, sql_string, &(yyloc));
     }
-#line 2200 "yacc_sql.cpp"
+#line 2329 "yacc_sql.cpp"
     break;
 
-  case 66: /* expression: value  */
-#line 561 "yacc_sql.y"
+  case 73: /* expression: value  */
+#line 656 "yacc_sql.y"
             {
       (yyval.expression) = new ValueExpr(*(yyvsp[0].value));
       (yyval.expression)->set_name(token_name(sql_string, &(yyloc)));
       delete (yyvsp[0].value);
     }
-#line 2210 "yacc_sql.cpp"
+#line 2339 "yacc_sql.cpp"
     break;
 
-  case 67: /* select_attr: '*'  */
-#line 569 "yacc_sql.y"
+  case 74: /* select_attr: '*'  */
+#line 664 "yacc_sql.y"
         {
       (yyval.rel_attr_list) = new std::vector<RelAttrSqlNode>;
       RelAttrSqlNode attr;
@@ -2218,11 +2347,11 @@ yyreduce:
       attr.attribute_name = "*";
       (yyval.rel_attr_list)->emplace_back(attr);
     }
-#line 2222 "yacc_sql.cpp"
+#line 2351 "yacc_sql.cpp"
     break;
 
-  case 68: /* select_attr: rel_attr attr_list  */
-#line 576 "yacc_sql.y"
+  case 75: /* select_attr: rel_attr attr_list  */
+#line 671 "yacc_sql.y"
                          {
       if ((yyvsp[0].rel_attr_list) != nullptr) {
         (yyval.rel_attr_list) = (yyvsp[0].rel_attr_list);
@@ -2232,21 +2361,21 @@ yyreduce:
       (yyval.rel_attr_list)->emplace_back(*(yyvsp[-1].rel_attr));
       delete (yyvsp[-1].rel_attr);
     }
-#line 2236 "yacc_sql.cpp"
+#line 2365 "yacc_sql.cpp"
     break;
 
-  case 69: /* rel_attr: ID  */
-#line 588 "yacc_sql.y"
+  case 76: /* rel_attr: ID  */
+#line 683 "yacc_sql.y"
        {
       (yyval.rel_attr) = new RelAttrSqlNode;
       (yyval.rel_attr)->attribute_name = (yyvsp[0].string);
       free((yyvsp[0].string));
     }
-#line 2246 "yacc_sql.cpp"
+#line 2375 "yacc_sql.cpp"
     break;
 
-  case 70: /* rel_attr: ID DOT ID  */
-#line 593 "yacc_sql.y"
+  case 77: /* rel_attr: ID DOT ID  */
+#line 688 "yacc_sql.y"
                 {
       (yyval.rel_attr) = new RelAttrSqlNode;
       (yyval.rel_attr)->relation_name  = (yyvsp[-2].string);
@@ -2254,19 +2383,19 @@ yyreduce:
       free((yyvsp[-2].string));
       free((yyvsp[0].string));
     }
-#line 2258 "yacc_sql.cpp"
+#line 2387 "yacc_sql.cpp"
     break;
 
-  case 71: /* attr_list: %empty  */
-#line 604 "yacc_sql.y"
+  case 78: /* attr_list: %empty  */
+#line 699 "yacc_sql.y"
     {
       (yyval.rel_attr_list) = nullptr;
     }
-#line 2266 "yacc_sql.cpp"
+#line 2395 "yacc_sql.cpp"
     break;
 
-  case 72: /* attr_list: COMMA rel_attr attr_list  */
-#line 607 "yacc_sql.y"
+  case 79: /* attr_list: COMMA rel_attr attr_list  */
+#line 702 "yacc_sql.y"
                                {
       if ((yyvsp[0].rel_attr_list) != nullptr) {
         (yyval.rel_attr_list) = (yyvsp[0].rel_attr_list);
@@ -2277,19 +2406,19 @@ yyreduce:
       (yyval.rel_attr_list)->emplace_back(*(yyvsp[-1].rel_attr));
       delete (yyvsp[-1].rel_attr);
     }
-#line 2281 "yacc_sql.cpp"
+#line 2410 "yacc_sql.cpp"
     break;
 
-  case 73: /* rel_list: %empty  */
-#line 621 "yacc_sql.y"
+  case 80: /* rel_list: %empty  */
+#line 716 "yacc_sql.y"
     {
       (yyval.relation_list) = nullptr;
     }
-#line 2289 "yacc_sql.cpp"
+#line 2418 "yacc_sql.cpp"
     break;
 
-  case 74: /* rel_list: COMMA ID rel_list  */
-#line 624 "yacc_sql.y"
+  case 81: /* rel_list: COMMA ID rel_list  */
+#line 719 "yacc_sql.y"
                         {
       if ((yyvsp[0].relation_list) != nullptr) {
         (yyval.relation_list) = (yyvsp[0].relation_list);
@@ -2299,11 +2428,11 @@ yyreduce:
       (yyval.relation_list)->relation_names.push_back((yyvsp[-1].string));
       free((yyvsp[-1].string));
     }
-#line 2303 "yacc_sql.cpp"
+#line 2432 "yacc_sql.cpp"
     break;
 
-  case 75: /* rel_list: INNER JOIN ID ON condition_list rel_list  */
-#line 633 "yacc_sql.y"
+  case 82: /* rel_list: INNER JOIN ID ON condition_list rel_list  */
+#line 728 "yacc_sql.y"
                                                {
       if ((yyvsp[0].relation_list) != nullptr) {
         (yyval.relation_list) = (yyvsp[0].relation_list);
@@ -2317,55 +2446,55 @@ yyreduce:
       free((yyvsp[-3].string));
       delete (yyvsp[-1].condition_list);
     }
-#line 2321 "yacc_sql.cpp"
+#line 2450 "yacc_sql.cpp"
     break;
 
-  case 76: /* where: %empty  */
-#line 650 "yacc_sql.y"
+  case 83: /* where: %empty  */
+#line 745 "yacc_sql.y"
     {
       (yyval.condition_list) = nullptr;
     }
-#line 2329 "yacc_sql.cpp"
+#line 2458 "yacc_sql.cpp"
     break;
 
-  case 77: /* where: WHERE condition_list  */
-#line 653 "yacc_sql.y"
+  case 84: /* where: WHERE condition_list  */
+#line 748 "yacc_sql.y"
                            {
       (yyval.condition_list) = (yyvsp[0].condition_list);  
     }
-#line 2337 "yacc_sql.cpp"
+#line 2466 "yacc_sql.cpp"
     break;
 
-  case 78: /* condition_list: %empty  */
-#line 660 "yacc_sql.y"
+  case 85: /* condition_list: %empty  */
+#line 755 "yacc_sql.y"
     {
       (yyval.condition_list) = nullptr;
     }
-#line 2345 "yacc_sql.cpp"
+#line 2474 "yacc_sql.cpp"
     break;
 
-  case 79: /* condition_list: condition  */
-#line 663 "yacc_sql.y"
+  case 86: /* condition_list: condition  */
+#line 758 "yacc_sql.y"
                 {
       (yyval.condition_list) = new std::vector<ConditionSqlNode>;
       (yyval.condition_list)->emplace_back(*(yyvsp[0].condition));
       delete (yyvsp[0].condition);
     }
-#line 2355 "yacc_sql.cpp"
+#line 2484 "yacc_sql.cpp"
     break;
 
-  case 80: /* condition_list: condition AND condition_list  */
-#line 668 "yacc_sql.y"
+  case 87: /* condition_list: condition AND condition_list  */
+#line 763 "yacc_sql.y"
                                    {
       (yyval.condition_list) = (yyvsp[0].condition_list);
       (yyval.condition_list)->emplace_back(*(yyvsp[-2].condition));
       delete (yyvsp[-2].condition);
     }
-#line 2365 "yacc_sql.cpp"
+#line 2494 "yacc_sql.cpp"
     break;
 
-  case 81: /* condition: rel_attr comp_op value  */
-#line 677 "yacc_sql.y"
+  case 88: /* condition: rel_attr comp_op value  */
+#line 772 "yacc_sql.y"
     {
       (yyval.condition) = new ConditionSqlNode;
       (yyval.condition)->left_is_attr = 1;
@@ -2377,11 +2506,11 @@ yyreduce:
       delete (yyvsp[-2].rel_attr);
       delete (yyvsp[0].value);
     }
-#line 2381 "yacc_sql.cpp"
+#line 2510 "yacc_sql.cpp"
     break;
 
-  case 82: /* condition: value comp_op value  */
-#line 689 "yacc_sql.y"
+  case 89: /* condition: value comp_op value  */
+#line 784 "yacc_sql.y"
     {
       (yyval.condition) = new ConditionSqlNode;
       (yyval.condition)->left_is_attr = 0;
@@ -2393,11 +2522,11 @@ yyreduce:
       delete (yyvsp[-2].value);
       delete (yyvsp[0].value);
     }
-#line 2397 "yacc_sql.cpp"
+#line 2526 "yacc_sql.cpp"
     break;
 
-  case 83: /* condition: rel_attr comp_op rel_attr  */
-#line 701 "yacc_sql.y"
+  case 90: /* condition: rel_attr comp_op rel_attr  */
+#line 796 "yacc_sql.y"
     {
       (yyval.condition) = new ConditionSqlNode;
       (yyval.condition)->left_is_attr = 1;
@@ -2409,11 +2538,11 @@ yyreduce:
       delete (yyvsp[-2].rel_attr);
       delete (yyvsp[0].rel_attr);
     }
-#line 2413 "yacc_sql.cpp"
+#line 2542 "yacc_sql.cpp"
     break;
 
-  case 84: /* condition: value comp_op rel_attr  */
-#line 713 "yacc_sql.y"
+  case 91: /* condition: value comp_op rel_attr  */
+#line 808 "yacc_sql.y"
     {
       (yyval.condition) = new ConditionSqlNode;
       (yyval.condition)->left_is_attr = 0;
@@ -2425,59 +2554,59 @@ yyreduce:
       delete (yyvsp[-2].value);
       delete (yyvsp[0].rel_attr);
     }
-#line 2429 "yacc_sql.cpp"
+#line 2558 "yacc_sql.cpp"
     break;
 
-  case 85: /* comp_op: EQ  */
-#line 728 "yacc_sql.y"
+  case 92: /* comp_op: EQ  */
+#line 823 "yacc_sql.y"
     { 
       (yyval.comp) = EQUAL_TO; 
     }
-#line 2437 "yacc_sql.cpp"
+#line 2566 "yacc_sql.cpp"
     break;
 
-  case 86: /* comp_op: LT  */
-#line 731 "yacc_sql.y"
+  case 93: /* comp_op: LT  */
+#line 826 "yacc_sql.y"
          { 
       (yyval.comp) = LESS_THAN; 
     }
-#line 2445 "yacc_sql.cpp"
+#line 2574 "yacc_sql.cpp"
     break;
 
-  case 87: /* comp_op: GT  */
-#line 734 "yacc_sql.y"
+  case 94: /* comp_op: GT  */
+#line 829 "yacc_sql.y"
          { 
       (yyval.comp) = GREAT_THAN; 
     }
-#line 2453 "yacc_sql.cpp"
+#line 2582 "yacc_sql.cpp"
     break;
 
-  case 88: /* comp_op: LE  */
-#line 737 "yacc_sql.y"
+  case 95: /* comp_op: LE  */
+#line 832 "yacc_sql.y"
          { 
       (yyval.comp) = LESS_EQUAL; 
     }
-#line 2461 "yacc_sql.cpp"
+#line 2590 "yacc_sql.cpp"
     break;
 
-  case 89: /* comp_op: GE  */
-#line 740 "yacc_sql.y"
+  case 96: /* comp_op: GE  */
+#line 835 "yacc_sql.y"
          { 
       (yyval.comp) = GREAT_EQUAL; 
     }
-#line 2469 "yacc_sql.cpp"
+#line 2598 "yacc_sql.cpp"
     break;
 
-  case 90: /* comp_op: NE  */
-#line 743 "yacc_sql.y"
+  case 97: /* comp_op: NE  */
+#line 838 "yacc_sql.y"
          { 
       (yyval.comp) = NOT_EQUAL; 
     }
-#line 2477 "yacc_sql.cpp"
+#line 2606 "yacc_sql.cpp"
     break;
 
-  case 91: /* load_data_stmt: LOAD DATA INFILE SSS INTO TABLE ID  */
-#line 750 "yacc_sql.y"
+  case 98: /* load_data_stmt: LOAD DATA INFILE SSS INTO TABLE ID  */
+#line 845 "yacc_sql.y"
     {
       char *tmp_file_name = common::substr((yyvsp[-3].string), 1, strlen((yyvsp[-3].string)) - 2);
       
@@ -2487,20 +2616,20 @@ yyreduce:
       free((yyvsp[0].string));
       free(tmp_file_name);
     }
-#line 2491 "yacc_sql.cpp"
+#line 2620 "yacc_sql.cpp"
     break;
 
-  case 92: /* explain_stmt: EXPLAIN command_wrapper  */
-#line 763 "yacc_sql.y"
+  case 99: /* explain_stmt: EXPLAIN command_wrapper  */
+#line 858 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_EXPLAIN);
       (yyval.sql_node)->explain.sql_node = std::unique_ptr<ParsedSqlNode>((yyvsp[0].sql_node));
     }
-#line 2500 "yacc_sql.cpp"
+#line 2629 "yacc_sql.cpp"
     break;
 
-  case 93: /* set_variable_stmt: SET ID EQ value  */
-#line 771 "yacc_sql.y"
+  case 100: /* set_variable_stmt: SET ID EQ value  */
+#line 866 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_SET_VARIABLE);
       (yyval.sql_node)->set_variable.name  = (yyvsp[-2].string);
@@ -2508,11 +2637,11 @@ yyreduce:
       free((yyvsp[-2].string));
       delete (yyvsp[0].value);
     }
-#line 2512 "yacc_sql.cpp"
+#line 2641 "yacc_sql.cpp"
     break;
 
 
-#line 2516 "yacc_sql.cpp"
+#line 2645 "yacc_sql.cpp"
 
       default: break;
     }
@@ -2741,7 +2870,7 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 783 "yacc_sql.y"
+#line 878 "yacc_sql.y"
 
 //_____________________________________________________________________
 extern void scan_string(const char *str, yyscan_t scanner);
@@ -30,6 +30,34 @@ int yyerror(YYLTYPE *llocp, const char *sql_string, ParsedSqlResult *sql_result,
   return 0;
 }
 
+/**
+ * @brief 判断标识符是否是给定的关键字(不区分大小写)，并释放标识符
+ * @details START TRANSACTION、READ ONLY、USING HASH、COMPRESS 不作为保留字，词法分析时是普通的标识符，
+ * 这样它们仍然可以用作表名、字段名
+ */
+bool match_keyword(char *id, const char *keyword)
+{
+  bool matched = 0 == strcasecmp(id, keyword);
+  free(id);
+  return matched;
+}
+
+/**
+ * @brief 判断两个标识符是否依次是给定的两个关键字，并释放标识符
+ */
+bool match_keywords(char *first, char *second, const char *first_keyword, const char *second_keyword)
+{
+  bool first_matched  = match_keyword(first, first_keyword);
+  bool second_matched = match_keyword(second, second_keyword);
+  return first_matched && second_matched;
+}
+
+/**
+ * @brief 创建索引语句末尾的选项 [USING HASH] [COMPRESS]
+ */
+const int INDEX_OPTION_HASH     = 1;
+const int INDEX_OPTION_COMPRESS = 2;
+
 ArithmeticExpr *create_arithmetic_expression(ArithmeticExpr::Type type,
                                              Expression *left,
                                              Expression *right,
@@ -157,9 +185,11 @@ ArithmeticExpr *create_arithmetic_expression(ArithmeticExpr::Type type,
 %type <sql_node>            show_tables_stmt
 %type <sql_node>            desc_table_stmt
 %type <sql_node>            create_index_stmt
+%type <number>              opt_index_options
 %type <sql_node>            drop_index_stmt
 %type <sql_node>            sync_stmt
 %type <sql_node>            begin_stmt
+%type <number>              opt_read_only
 %type <sql_node>            commit_stmt
 %type <sql_node>            rollback_stmt
 %type <sql_node>            load_data_stmt
@@ -224,8 +254,33 @@ sync_stmt:
     ;
 
 begin_stmt:
-    TRX_BEGIN  {
+    TRX_BEGIN opt_read_only {
+      if ($2 < 0) {
+        yyerror(&@$, sql_string, sql_result, scanner, "syntax error");
+        YYERROR;
+      }
       $$ = new ParsedSqlNode(SCF_BEGIN);
+      $$->begin.read_only = $2 > 0;
+    }
+    | ID ID opt_read_only {
+      if (!match_keywords($1, $2, "start", "transaction") || $3 < 0) {
+        yyerror(&@$, sql_string, sql_result, scanner, "syntax error");
+        YYERROR;
+      }
+      $$ = new ParsedSqlNode(SCF_BEGIN);
+      $$->begin.read_only = $3 > 0;
+    }
+    ;
+
+opt_read_only:
+    /* empty */
+    {
+      $$ = 0;
+    }
+    | ID ID
+    {
+      // 不是 READ ONLY 时返回-1，由语句报告语法错误
+      $$ = match_keywords($1, $2, "read", "only") ? 1 : -1;
     }
     ;
 
@@ -263,32 +318,72 @@ desc_table_stmt:
     ;
 
 create_index_stmt:    /*create index 语句的语法解析树*/
-    CREATE INDEX ID ON ID LBRACE ID RBRACE
+    CREATE INDEX ID ON ID LBRACE ID RBRACE opt_index_options
     {
+      if ($9 < 0) {
+        free($3);
+        free($5);
+        free($7);
+        yyerror(&@$, sql_string, sql_result, scanner, "syntax error");
+        YYERROR;
+      }
       $$ = new ParsedSqlNode(SCF_CREATE_INDEX);
       CreateIndexSqlNode &create_index = $$->create_index;
       create_index.index_name = $3;
       create_index.relation_name = $5;
       create_index.attribute_name = $7;
       create_index.is_unique = false;
+      create_index.index_type = ($9 & INDEX_OPTION_HASH) ? HASH_INDEX : BPLUS_TREE_INDEX;
+      create_index.prefix_compression = ($9 & INDEX_OPTION_COMPRESS) != 0;
       free($3);
       free($5);
       free($7);
     } 
-    | CREATE UNIQUE INDEX ID ON ID LBRACE ID RBRACE
+    | CREATE UNIQUE INDEX ID ON ID LBRACE ID RBRACE opt_index_options
     {
+      if ($10 < 0) {
+        free($4);
+        free($6);
+        free($8);
+        yyerror(&@$, sql_string, sql_result, scanner, "syntax error");
+        YYERROR;
+      }
       $$ = new ParsedSqlNode(SCF_CREATE_INDEX);
       CreateIndexSqlNode &create_index = $$->create_index;
       create_index.index_name = $4;
       create_index.relation_name = $6;
       create_index.attribute_name = $8;
       create_index.is_unique = true;
+      create_index.index_type = ($10 & INDEX_OPTION_HASH) ? HASH_INDEX : BPLUS_TREE_INDEX;
+      create_index.prefix_compression = ($10 & INDEX_OPTION_COMPRESS) != 0;
       free($4);
       free($6);
       free($8);
     }
     ;
 
+opt_index_options:
+    /* empty */
+    {
+      $$ = 0;
+    }
+    | ID
+    {
+      // 选项不对时返回-1，由语句报告语法错误
+      $$ = match_keyword($1, "compress") ? INDEX_OPTION_COMPRESS : -1;
+    }
+    | ID ID
+    {
+      $$ = match_keywords($1, $2, "using", "hash") ? INDEX_OPTION_HASH : -1;
+    }
+    | ID ID ID
+    {
+      bool hash     = match_keywords($1, $2, "using", "hash");
+      bool compress = match_keyword($3, "compress");
+      $$ = (hash && compress) ? (INDEX_OPTION_HASH | INDEX_OPTION_COMPRESS) : -1;
+    }
+    ;
+
 drop_index_stmt:      /*drop index 语句的语法解析树*/
     DROP INDEX ID ON ID
     {
@@ -46,12 +46,32 @@ RC CreateIndexStmt::create(Db *db, const CreateIndexSqlNode &create_index, Stmt
     return RC::SCHEMA_FIELD_NOT_EXIST;   
   }
 
+  if (create_index.prefix_compression && field_meta->type() != CHARS) {
+    LOG_WARN("prefix compression can only be used on chars field. db=%s, table=%s, field name=%s",
+             db->name(), table_name, create_index.attribute_name.c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  if (create_index.index_type == HASH_INDEX && create_index.prefix_compression) {
+    LOG_WARN("prefix compression can not be used on hash index. db=%s, table=%s, index name=%s",
+             db->name(), table_name, create_index.index_name.c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  if (create_index.index_type == HASH_INDEX && field_meta->type() == FLOATS) {
+    LOG_WARN("hash index can not be created on float field. db=%s, table=%s, field name=%s",
+             db->name(), table_name, create_index.attribute_name.c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
   Index *index = table->find_index(create_index.index_name.c_str());
   if (nullptr != index) {
     LOG_WARN("index with name(%s) already exists. table name=%s", create_index.index_name.c_str(), table_name);
     return RC::SCHEMA_INDEX_NAME_REPEAT;
   }
 
-  stmt = new CreateIndexStmt(table, field_meta, create_index.index_name, create_index.is_unique);
+  stmt = new CreateIndexStmt(
+      table, field_meta, create_index.index_name, create_index.is_unique,
+      create_index.index_type, create_index.prefix_compression);
   return RC::SUCCESS;
 }
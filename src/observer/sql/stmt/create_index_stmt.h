@@ -29,11 +29,14 @@ class FieldMeta;
 class CreateIndexStmt : public Stmt
 {
 public:
-  CreateIndexStmt(Table *table, const FieldMeta *field_meta, const std::string &index_name, const bool &is_unique)
+  CreateIndexStmt(Table *table, const FieldMeta *field_meta, const std::string &index_name, const bool &is_unique,
+                  IndexType index_type, bool prefix_compression)
         : table_(table),
           field_meta_(field_meta),
           index_name_(index_name),
-          is_unique_(is_unique)
+          is_unique_(is_unique),
+          index_type_(index_type),
+          prefix_compression_(prefix_compression)
   {}
 
   virtual ~CreateIndexStmt() = default;
@@ -44,6 +47,8 @@ public:
   const FieldMeta *field_meta() const { return field_meta_; }
   const std::string &index_name() const { return index_name_; }
   const bool &is_unique() const { return is_unique_; }
+  IndexType index_type() const { return index_type_; }
+  bool prefix_compression() const { return prefix_compression_; }
 
 public:
   static RC create(Db *db, const CreateIndexSqlNode &create_index, Stmt *&stmt);
@@ -53,4 +58,6 @@ private:
   const FieldMeta *field_meta_ = nullptr;
   std::string index_name_;
   bool is_unique_ = false;
+  IndexType index_type_ = BPLUS_TREE_INDEX;
+  bool prefix_compression_ = false;  ///< 索引节点是否使用前缀压缩
 };
@@ -79,7 +79,7 @@ RC Stmt::create_stmt(Db *db, ParsedSqlNode &sql_node, Stmt *&stmt)
     }
 
     case SCF_BEGIN: {
-      return TrxBeginStmt::create(stmt);
+      return TrxBeginStmt::create(sql_node.begin, stmt);
     }
 
     case SCF_COMMIT:
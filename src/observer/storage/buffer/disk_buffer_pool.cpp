@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 #include <errno.h>
 #include <string.h>
+#include <cinttypes>
 
 #include "storage/buffer/disk_buffer_pool.h"
 #include "common/lang/mutex.h"
@@ -101,6 +102,19 @@ int BPFrameManager::purge_frames(int count, std::function<RC(Frame *frame)> purg
   return freed_count;
 }
 
+void BPFrameManager::oldest_dirty_lsn(LSN &lsn, bool &found)
+{
+  found = false;
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  frames_.foreach([&lsn, &found](const FrameId &, Frame *const frame) -> bool {
+    if (frame->dirty() && (!found || frame->rec_lsn() < lsn)) {
+      lsn   = frame->rec_lsn();
+      found = true;
+    }
+    return true;
+  });
+}
+
 Frame *BPFrameManager::get(int file_desc, PageNum page_num)
 {
   FrameId frame_id(file_desc, page_num);
@@ -461,7 +475,10 @@ RC DiskBufferPool::purge_all_pages()
   for (std::list<Frame *>::iterator it = used.begin(); it != used.end(); ++it) {
     Frame *frame = *it;
 
-    purge_frame(frame->page_num(), frame);
+    RC rc = purge_frame(frame->page_num(), frame);
+    if (rc != RC::SUCCESS) {
+      frame->unpin();  // 没有释放的页帧去掉 find_list 加上的 pin
+    }
   }
   return RC::SUCCESS;
 }
@@ -497,6 +514,15 @@ RC DiskBufferPool::flush_page_internal(Frame &frame)
   // so it is easier to flush data to file.
 
   Page &page = frame.page();
+
+  // 页面上修改对应的日志需要先于页面持久化
+  RC rc = bp_manager_.flush_log(page.lsn);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to flush log before flushing page %d of %d. page lsn=%" PRId64 ", rc=%s",
+              page.page_num, file_desc_, page.lsn, strrc(rc));
+    return rc;
+  }
+
   int64_t offset = ((int64_t)page.page_num) * sizeof(Page);
   if (lseek(file_desc_, offset, SEEK_SET) == offset - 1) {
     LOG_ERROR("Failed to flush page %lld of %d due to failed to seek %s.", offset, file_desc_, strerror(errno));
@@ -515,13 +541,27 @@ RC DiskBufferPool::flush_page_internal(Frame &frame)
 
 RC DiskBufferPool::flush_all_pages()
 {
+  // find_list 会 pin 住每个页帧，无论是否刷盘成功都要 unpin，否则关闭文件后页帧仍然留在缓冲池中，
+  // 之后打开的文件复用了同一个文件描述符时会读到这些过期的页面
   std::list<Frame *> used = frame_manager_.find_list(file_desc_);
+  RC rc = RC::SUCCESS;
   for (Frame *frame : used) {
-    RC rc = flush_page(*frame);
-    if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to flush all pages");
-      return rc;
+    if (rc == RC::SUCCESS) {
+      rc = flush_page(*frame);
+      if (rc != RC::SUCCESS) {
+        LOG_WARN("failed to flush all pages. rc=%s", strrc(rc));
+      }
     }
+    frame->unpin();
+  }
+  return rc;
+}
+
+RC DiskBufferPool::sync_file()
+{
+  if (fsync(file_desc_) != 0) {
+    LOG_WARN("failed to sync file. file=%s, error=%s", file_name_.c_str(), strerror(errno));
+    return RC::IOERR_SYNC;
   }
   return RC::SUCCESS;
 }
@@ -611,6 +651,11 @@ int DiskBufferPool::file_desc() const
 {
   return file_desc_;
 }
+
+int DiskBufferPool::allocated_pages() const
+{
+  return file_header_->allocated_pages;
+}
 ////////////////////////////////////////////////////////////////////////////////
 BufferPoolManager::BufferPoolManager(int memory_size /* = 0 */)
 {
@@ -752,6 +797,36 @@ RC BufferPoolManager::flush_page(Frame &frame)
   return bp->flush_page(frame);
 }
 
+void BufferPoolManager::oldest_dirty_lsn(LSN &lsn, bool &found)
+{
+  frame_manager_.oldest_dirty_lsn(lsn, found);
+}
+
+RC BufferPoolManager::sync_files()
+{
+  std::scoped_lock lock_guard(lock_);
+  for (auto &item : buffer_pools_) {
+    RC rc = item.second->sync_file();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+void BufferPoolManager::set_log_flusher(std::function<RC(LSN)> log_flusher)
+{
+  log_flusher_ = std::move(log_flusher);
+}
+
+RC BufferPoolManager::flush_log(LSN lsn)
+{
+  if (!log_flusher_ || lsn <= 0) {
+    return RC::SUCCESS;
+  }
+  return log_flusher_(lsn);
+}
+
 static BufferPoolManager *default_bpm = nullptr;
 void BufferPoolManager::set_instance(BufferPoolManager *bpm)
 {
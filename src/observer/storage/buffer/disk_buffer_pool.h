@@ -126,6 +126,12 @@ public:
    */
   int purge_frames(int count, std::function<RC(Frame *frame)> purger);
 
+  /**
+   * @brief 所有脏页中最小的 recovery LSN
+   * @param found 没有脏页时返回false
+   */
+  void oldest_dirty_lsn(LSN &lsn, bool &found);
+
   size_t frame_num() const
   {
     return frames_.count();
@@ -248,6 +254,11 @@ public:
 
   int file_desc() const;
 
+  /**
+   * @brief 已经分配的页面个数，包括文件头页面
+   */
+  int allocated_pages() const;
+
   /**
    * 如果页面是脏的，就将数据刷新到磁盘
    */
@@ -258,6 +269,11 @@ public:
    */
   RC flush_all_pages();
 
+  /**
+   * @brief 将文件同步到磁盘(fsync)
+   */
+  RC sync_file();
+
   /**
    * 回放日志时处理page0中已被认定为不存在的page
    */
@@ -313,6 +329,30 @@ public:
 
   RC flush_page(Frame &frame);
 
+  /**
+   * @brief 所有脏页中最小的 recovery LSN，做检查点时使用
+   * @param found 没有脏页时返回false
+   */
+  void oldest_dirty_lsn(LSN &lsn, bool &found);
+
+  /**
+   * @brief 将所有打开的文件同步到磁盘
+   * @details 做检查点时使用，保证已经写出的页面在记录检查点之前持久化
+   */
+  RC sync_files();
+
+  /**
+   * @brief 设置持久化日志的函数
+   * @details 页面写到磁盘之前，要先保证页面LSN之前的日志都已经持久化(WAL)。
+   * 没有设置时(比如没有日志的测试场景)直接写页面。
+   */
+  void set_log_flusher(std::function<RC(LSN)> log_flusher);
+
+  /**
+   * @brief 保证 lsn 之前的日志都已经持久化
+   */
+  RC flush_log(LSN lsn);
+
 public:
   static void set_instance(BufferPoolManager *bpm); // TODO 优化全局变量的表示方法
   static BufferPoolManager &instance();
@@ -320,7 +360,9 @@ public:
 private:
   BPFrameManager frame_manager_{"BufPool"};
 
-  common::Mutex  lock_;
+  std::mutex     lock_;  ///< 日志的刷盘线程做检查点时也会访问，没有开启 CONCURRENCY 时也需要加锁
   std::unordered_map<std::string, DiskBufferPool *> buffer_pools_;
   std::unordered_map<int, DiskBufferPool *> fd_buffer_pools_;
+
+  std::function<RC(LSN)> log_flusher_;
 };
@@ -16,6 +16,22 @@ See the Mulan PSL v2 for more details. */
 #include "session/thread_data.h"
 #include "session/session.h"
 
+static std::atomic<const std::atomic<LSN> *> frame_lsn_source{nullptr};
+
+void Frame::set_lsn_source(const std::atomic<LSN> *lsn_source)
+{
+  frame_lsn_source.store(lsn_source);
+}
+
+void Frame::mark_dirty()
+{
+  if (!dirty_) {
+    const std::atomic<LSN> *lsn_source = frame_lsn_source.load();
+    rec_lsn_ = (lsn_source == nullptr) ? 0 : lsn_source->load();
+  }
+  dirty_ = true;
+}
+
 using namespace std;
 
 FrameId::FrameId(int file_desc, PageNum page_num) : file_desc_(file_desc), page_num_(page_num)
@@ -96,11 +96,24 @@ public:
   /**
    * @brief 标记指定页面为“脏”页。如果修改了页面的内容，则应调用此函数，
    * 以便该页面被淘汰出缓冲区时系统将新的页面数据写入磁盘文件
+   * @details 页面从干净变脏时，记录当前日志的LSN(recovery LSN)。描述这次修改的日志，LSN都不会比它小，
+   * 检查点使用所有脏页中最小的 recovery LSN 作为恢复起点的上限。
    */
-  void mark_dirty() { dirty_ = true; }
+  void mark_dirty();
   void clear_dirty() { dirty_ = false; }
   bool dirty() const { return dirty_; }
 
+  /**
+   * @brief 页面变脏时的日志LSN，只在 dirty 时有意义
+   */
+  LSN  rec_lsn() const { return rec_lsn_; }
+
+  /**
+   * @brief 设置页面变脏时读取的日志LSN
+   * @details 由日志模块设置为日志缓存当前分配到的LSN，没有设置时 recovery LSN 都是0
+   */
+  static void set_lsn_source(const std::atomic<LSN> *lsn_source);
+
   char *data() { return page_.data; }
 
   bool can_purge() { return pin_count_.load() == 0; }
@@ -137,6 +150,7 @@ private:
   friend class  BufferPool;
 
   bool              dirty_     = false;
+  LSN               rec_lsn_   = 0;
   std::atomic<int>  pin_count_{0};
   unsigned long     acc_time_  = 0;
   int               file_desc_ = -1;
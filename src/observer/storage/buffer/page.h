@@ -32,7 +32,9 @@ static constexpr const int BP_PAGE_DATA_SIZE = (BP_PAGE_SIZE - sizeof(PageNum) -
  */
 struct Page
 {
+  LSN     lsn;       ///< 放在最前面，避免因为对齐填充使页面超过 BP_PAGE_SIZE
   PageNum page_num;
-  LSN     lsn;
   char data[BP_PAGE_DATA_SIZE];
 };
+
+static_assert(sizeof(Page) == BP_PAGE_SIZE, "invalid page size");
@@ -12,23 +12,45 @@ See the Mulan PSL v2 for more details. */
 // Created by huhaosheng.hhs on 2022
 //
 
+#include <inttypes.h>
+#include <algorithm>
+#include <chrono>
 #include <sstream>
+#include <thread>
 #include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 
 #include "common/log/log.h"
 #include "storage/clog/clog.h"
+#include "storage/clog/clog_recovery.h"
 #include "common/global_context.h"
 #include "storage/trx/trx.h"
 #include "common/io/io.h"
+#include "common/conf/ini.h"
+#include "common/lang/string.h"
+#include "common/math/crc32.h"
+#include "storage/buffer/disk_buffer_pool.h"
 
 using namespace std;
 using namespace common;
 
 /**
- * @brief 当前的日志使用固定的文件名，而且就这一个文件
+ * @brief 日志段文件名的前缀，日志段的文件名是 clog.<段编号>
  */
 const char *CLOG_FILE_NAME = "clog";
 
+/**
+ * @brief 检查点文件名
+ */
+const char *CLOG_CHECKPOINT_FILE_NAME = "clog_checkpoint";
+
+static const char *CLOG_SECTION = "CLOG";
+
 const char *clog_type_name(CLogType type)
 {
   #define DEFINE_CLOG_TYPE(name)  case CLogType::name: return #name;
@@ -48,6 +70,38 @@ CLogType clog_type_from_integer(int32_t value)
   return static_cast<CLogType>(value);
 }
 
+const char *clog_durability_name(CLogDurability durability)
+{
+  switch (durability) {
+    case CLogDurability::DEFAULT: return "default";
+    case CLogDurability::SYNC: return "sync";
+    case CLogDurability::ASYNC: return "async";
+    case CLogDurability::BUFFERED: return "buffered";
+    default: return "unknown durability";
+  }
+}
+
+bool clog_durability_from_string(const char *str, CLogDurability &durability)
+{
+  const CLogDurability values[] = {
+      CLogDurability::DEFAULT, CLogDurability::SYNC, CLogDurability::ASYNC, CLogDurability::BUFFERED};
+  for (CLogDurability value : values) {
+    if (strcasecmp(str, clog_durability_name(value)) == 0) {
+      durability = value;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief 当前时间(微秒)，用来计算持久化延迟
+ */
+static int64_t current_time_us()
+{
+  return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 string CLogRecordHeader::to_string() const
@@ -89,66 +143,6 @@ string CLogRecordData::to_string() const
 
 ////////////////////////////////////////////////////////////////////////////////
 
-int _align8(int size)
-{
-  return size / 8 * 8 + ((size % 8 == 0) ? 0 : 8);
-}
-
-CLogRecord *CLogRecord::build_mtr_record(CLogType type, int32_t trx_id)
-{
-  CLogRecord *log_record = new CLogRecord();
-  CLogRecordHeader &header = log_record->header_;
-  header.trx_id_ = trx_id;
-  header.type_   = clog_type_to_integer(type);
-  return log_record;
-}
-
-CLogRecord *CLogRecord::build_commit_record(int32_t trx_id, int32_t commit_xid)
-{
-  CLogRecord *log_record = new CLogRecord();
-  CLogRecordHeader &header = log_record->header_;
-  header.type_ = clog_type_to_integer(CLogType::MTR_COMMIT);
-  header.trx_id_ = trx_id;
-  header.logrec_len_ = sizeof(CLogRecordCommitData);
-  
-  CLogRecordCommitData &commit_record = log_record->commit_record();
-  commit_record.commit_xid_ = commit_xid;
-  return log_record;
-}
-
-CLogRecord *CLogRecord::build_data_record(CLogType type, 
-                                          int32_t trx_id, 
-                                          int32_t table_id, 
-                                          const RID &rid, 
-                                          int32_t data_len, 
-                                          int32_t data_offset, 
-                                          const char *data)
-{
-  CLogRecord *log_record = new CLogRecord();
-  CLogRecordHeader &header = log_record->header_;
-  header.trx_id_ = trx_id;
-  header.type_   = clog_type_to_integer(type);
-  header.logrec_len_ = CLogRecordData::HEADER_SIZE + data_len;
-
-  CLogRecordData &data_record = log_record->data_record();
-  data_record.table_id_    = table_id;
-  data_record.rid_         = rid;
-  data_record.data_len_    = data_len;
-  data_record.data_offset_ = data_offset;
-
-  if (data_len > 0) {
-    data_record.data_ = new char[data_len];
-    if (nullptr == data_record.data_) {
-      delete log_record;
-      LOG_WARN("failed to allocate memory while creating clog record. memory size=%d", data_len);
-      return nullptr;
-    }
-
-    memcpy(data_record.data_, data, data_len);
-  }
-  return log_record;
-}
-
 CLogRecord *CLogRecord::build(const CLogRecordHeader &header, char *data)
 {
   CLogRecord *log_record = new CLogRecord();
@@ -195,322 +189,1590 @@ string CLogRecord::to_string() const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-static const int CLOG_BUFFER_SIZE = 4 * 1024 * 1024;
-
-CLogBuffer::CLogBuffer()
+CLogBuffer::~CLogBuffer()
 {
+  delete[] buffer_;
+  buffer_ = nullptr;
 }
 
-CLogBuffer::~CLogBuffer()
-{}
-
-RC CLogBuffer::append_log_record(CLogRecord *log_record)
+RC CLogBuffer::init(LSN start_lsn, int capacity)
 {
-  if (nullptr == log_record) {
+  if (capacity <= 0) {
     return RC::INVALID_ARGUMENT;
   }
 
-  /// total_size_ 的计算没有考虑日志头
-  if (total_size_ + log_record->logrec_len() >= CLOG_BUFFER_SIZE) {
-    return RC::LOGBUF_FULL;
+  buffer_ = new (std::nothrow) char[capacity];
+  if (nullptr == buffer_) {
+    LOG_WARN("failed to allocate log buffer. capacity=%d", capacity);
+    return RC::NOMEM;
   }
 
-  lock_guard<Mutex> lock_guard(lock_);
-  log_records_.emplace_back(log_record);
-  total_size_ += log_record->logrec_len();
-  LOG_DEBUG("append log. log_record={%s}", log_record->to_string().c_str());
+  capacity_ = capacity;
+  set_current_lsn(start_lsn);
   return RC::SUCCESS;
 }
 
-RC CLogBuffer::flush_buffer(CLogFile &log_file)
+void CLogBuffer::set_current_lsn(LSN lsn)
 {
-  RC rc = RC::SUCCESS;
-  int count = 0;
-  while (!log_records_.empty()) {
-    lock_.lock();
-    if (log_records_.empty()) {
-      lock_.unlock();
-      return RC::SUCCESS;
-    }
+  reserved_lsn_  = lsn;
+  published_lsn_ = lsn;
+  written_lsn_   = lsn;
+}
+
+RC CLogBuffer::append_log_record(CLogFile &log_file, CLogRecordHeader &header, initializer_list<CLogSlice> body,
+                                 LSN &end_lsn)
+{
+  const int32_t record_size = static_cast<int32_t>(sizeof(header)) + header.logrec_len_;
+  if (record_size > capacity_) {
+    LOG_WARN("log record is too large. size=%d, capacity=%d", record_size, capacity_);
+    return RC::LOGBUF_FULL;
+  }
+
+  const LSN lsn = reserved_lsn_.fetch_add(record_size);
+  end_lsn       = lsn + record_size;
 
-    // log buffer 需要支持并发，所以要考虑加锁
-    // 从队列中取出日志记录然后写入到文件中
-    unique_ptr<CLogRecord> log_record = std::move(log_records_.front());
-    log_records_.pop_front();
+  RC rc = wait_for_space(log_file, end_lsn);
+  if (OB_FAIL(rc)) {
+    // 空间已经预留，无法撤销。写文件失败后日志模块已经不可用了
+    LOG_ERROR("failed to wait for log buffer space. lsn=%" PRId64 ", rc=%s", lsn, strrc(rc));
+    return rc;
+  }
 
-    rc = write_log_record(log_file, log_record.get());
-    // 当前无法处理日志写不完整的情况，所以直接粗暴退出
-    ASSERT(rc == RC::SUCCESS, "failed to write log record. log_record=%s, rc=%s",
-           log_record->to_string().c_str(), strrc(rc));
+  header.lsn_ = lsn;
+  copy_in(lsn, reinterpret_cast<const char *>(&header), sizeof(header));
+  LSN offset = lsn + sizeof(header);
+  for (const CLogSlice &slice : body) {
+    copy_in(offset, slice.data, slice.len);
+    offset += slice.len;
+  }
+  ASSERT(offset == end_lsn, "log record body length mismatch. header={%s}", header.to_string().c_str());
 
-    lock_.unlock();
-    total_size_ -= log_record->logrec_len();
-    count++;
+  // 按照LSN的顺序发布，前面的日志复制完成以后才能推进到这里
+  LSN expected = lsn;
+  while (!published_lsn_.compare_exchange_weak(expected, end_lsn)) {
+    expected = lsn;
+    this_thread::yield();
   }
 
-  LOG_WARN("flush log buffer done. write log record number=%d", count);
-  return log_file.sync();
+  LOG_DEBUG("append log. header={%s}", header.to_string().c_str());
+  return RC::SUCCESS;
 }
 
-RC CLogBuffer::write_log_record(CLogFile &log_file, CLogRecord *log_record)
+RC CLogBuffer::wait_for_space(CLogFile &log_file, LSN end_lsn)
 {
-  // TODO 看起来每种类型的日志自己实现 serialize 接口更好一点
-  const CLogRecordHeader &header = log_record->header();
-  RC rc = log_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
-  if (rc != RC::SUCCESS) {
-    LOG_WARN("failed to write log record header. size=%d, rc=%s", sizeof(header), strrc(rc));
-    return rc;
+  while (end_lsn - written_lsn_.load() > capacity_) {
+    // 缓存满了，自己把已经发布的数据写入文件。如果前面的日志还没有复制完成，就等一会儿
+    LSN written_lsn = 0;
+    RC rc = flush_buffer(log_file, written_lsn);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    if (end_lsn - written_lsn > capacity_) {
+      this_thread::yield();
+    }
+  }
+  return RC::SUCCESS;
+}
+
+void CLogBuffer::copy_in(LSN lsn, const char *data, int len)
+{
+  if (len <= 0) {
+    return;
   }
 
-  switch (log_record->log_type()) {
-    case CLogType::MTR_BEGIN:
-    case CLogType::MTR_ROLLBACK: {
-      // do nothing
-    } break;
+  const int pos   = static_cast<int>(lsn % capacity_);
+  const int first = std::min(len, capacity_ - pos);
+  memcpy(buffer_ + pos, data, first);
+  if (first < len) {
+    memcpy(buffer_, data + first, len - first);
+  }
+}
 
-    case CLogType::MTR_COMMIT: {
-      rc = log_file.write(reinterpret_cast<const char *>(&log_record->commit_record()), 
-                          log_record->header().logrec_len_);
-    } break;
+RC CLogBuffer::flush_buffer(CLogFile &log_file, LSN &written_lsn)
+{
+  lock_guard<mutex> guard(write_lock_);
 
-    default: {
-      rc = log_file.write(reinterpret_cast<const char *>(&log_record->data_record()), CLogRecordData::HEADER_SIZE);
-      if (OB_FAIL(rc)) {
-        LOG_WARN("failed to write data record header. size=%d, rc=%s", CLogRecordData::HEADER_SIZE, strrc(rc));
-        return rc;
-      }
+  const LSN start_lsn = written_lsn_.load();
+  const LSN end_lsn   = published_lsn_.load();
+  if (start_lsn >= end_lsn) {
+    written_lsn = start_lsn;
+    return RC::SUCCESS;
+  }
 
-      rc = log_file.write(log_record->data_record().data_, log_record->data_record().data_len_);
-      if (OB_FAIL(rc)) {
-        LOG_WARN("failed to write log data. size=%d, rc=%s", log_record->data_record().data_len_, strrc(rc));
-        return rc;
-      }
-    } break;
+  const int len   = static_cast<int>(end_lsn - start_lsn);
+  const int pos   = static_cast<int>(start_lsn % capacity_);
+  const int first = std::min(len, capacity_ - pos);
+
+  CLogSlice slices[2];
+  int slice_num = 0;
+  slices[slice_num++] = CLogSlice{buffer_ + pos, first};
+  if (first < len) {
+    slices[slice_num++] = CLogSlice{buffer_, len - first};
   }
 
+  RC rc = log_file.write_at(start_lsn, slices, slice_num);
+  // 当前无法处理日志写不完整的情况，所以直接粗暴退出
+  ASSERT(rc == RC::SUCCESS, "failed to write log buffer. lsn=%" PRId64 ", len=%d, rc=%s",
+         start_lsn, len, strrc(rc));
+
+  written_lsn_.store(end_lsn);
+  written_lsn = end_lsn;
+  LOG_DEBUG("flush log buffer done. lsn=%" PRId64 ", len=%d", start_lsn, len);
   return rc;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-RC CLogFile::init(const char *path)
+const char *clog_sync_method_name(CLogSyncMethod method)
 {
-  RC rc = RC::SUCCESS;
-
-  std::string clog_file_path = std::string(path) + common::FILE_PATH_SPLIT_STR + CLOG_FILE_NAME;
-  int fd = ::open(clog_file_path.c_str(), O_RDWR | O_APPEND | O_CREAT, S_IRUSR | S_IWUSR);
-  if (fd < 0) {
-    rc = RC::IOERR_OPEN;
-    LOG_WARN("failed to open clog file. filename=%s, error=%s", clog_file_path.c_str(), strerror(errno));
-    return rc;
+  switch (method) {
+    case CLogSyncMethod::FSYNC: return "fsync";
+    case CLogSyncMethod::FDATASYNC: return "fdatasync";
+    case CLogSyncMethod::DSYNC: return "dsync";
+    case CLogSyncMethod::DIRECT: return "direct";
+    default: return "unknown sync method";
   }
-
-  filename_ = clog_file_path;
-  fd_       = fd;
-  LOG_INFO("open clog file success. file=%s, fd=%d", filename_.c_str(), fd_);
-  return rc;
 }
 
-CLogFile::~CLogFile()
+bool clog_sync_method_from_string(const char *str, CLogSyncMethod &method)
 {
-  if (fd_ >= 0) {
-    LOG_INFO("close clog file. file=%s, fd=%d", filename_.c_str(), fd_);
-    ::close(fd_);
-    fd_ = -1;
+  const CLogSyncMethod values[] = {
+      CLogSyncMethod::FSYNC, CLogSyncMethod::FDATASYNC, CLogSyncMethod::DSYNC, CLogSyncMethod::DIRECT};
+  for (CLogSyncMethod value : values) {
+    if (strcasecmp(str, clog_sync_method_name(value)) == 0) {
+      method = value;
+      return true;
+    }
   }
+  return false;
 }
 
-RC CLogFile::write(const char *data, int len)
+/**
+ * @brief 计算日志块的校验和，覆盖头部中校验和之后的字段和块中的有效数据
+ */
+static uint32_t clog_block_checksum(const char *block)
 {
-  int ret = writen(fd_, data, len);
-  if (0 != ret) {
-    LOG_WARN("failed to write data to file. filename=%s, data len=%d, error=%s", filename_.c_str(), len, strerror(ret));
-    return RC::IOERR_WRITE;
-  }
-  return RC::SUCCESS;
+  const CLogBlockHeader *header = reinterpret_cast<const CLogBlockHeader *>(block);
+  const size_t offset = sizeof(header->checksum);
+  const int data_len = std::max(0, std::min(header->data_len, CLogFile::BLOCK_DATA_SIZE));
+  return crc32c(0, block + offset, sizeof(CLogBlockHeader) - offset + data_len);
 }
 
-RC CLogFile::read(char *data, int len)
+static char *alloc_blocks(int block_num)
 {
-  int ret = readn(fd_, data, len);
-  if (ret != 0) {
-    if (ret == -1) {
-      eof_ = true;
-      LOG_TRACE("file read touch eof. filename=%s", filename_.c_str());
-    } else {
-      LOG_WARN("failed to read data from file. file=%s, data len=%d, error=%s", filename_.c_str(), len, strerror(ret));
-    }
-    return RC::IOERR_READ;
+  char *buffer = static_cast<char *>(aligned_alloc(CLogFile::BLOCK_SIZE, static_cast<size_t>(block_num) * CLogFile::BLOCK_SIZE));
+  if (buffer != nullptr) {
+    memset(buffer, 0, static_cast<size_t>(block_num) * CLogFile::BLOCK_SIZE);
   }
-  return RC::SUCCESS;
+  return buffer;
 }
 
-RC CLogFile::sync()
+RC CLogFile::init(const char *path, int64_t segment_size, CLogSyncMethod sync_method)
 {
-  int ret = fsync(fd_);
-  if (ret != 0) {
-    LOG_WARN("failed to sync file. file=%s, error=%s", filename_.c_str(), strerror(errno));
-    return RC::IOERR_SYNC;
+  if (segment_size < BLOCK_SIZE || segment_size % BLOCK_SIZE != 0) {
+    LOG_WARN("invalid clog segment size, should be a multiple of %d. size=%" PRId64, BLOCK_SIZE, segment_size);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  path_         = path;
+  segment_size_ = segment_size;
+  sync_method_  = sync_method;
+
+  read_block_  = alloc_blocks(1);
+  tail_block_  = alloc_blocks(1);
+  if (read_block_ == nullptr || tail_block_ == nullptr) {
+    LOG_WARN("failed to allocate clog block buffer");
+    return RC::NOMEM;
+  }
+
+  DIR *dir = opendir(path);
+  if (nullptr == dir) {
+    LOG_WARN("failed to open clog directory. path=%s, error=%s", path, strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  const size_t prefix_len = strlen(CLOG_FILE_NAME) + 1;  // "clog."
+  int64_t first_segment = -1;
+  int64_t last_segment  = -1;
+  for (struct dirent *entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+    if (0 != strncmp(entry->d_name, CLOG_FILE_NAME, prefix_len - 1) || entry->d_name[prefix_len - 1] != '.') {
+      continue;
+    }
+
+    // 没有准备完成的临时文件 clog.<N>.tmp 也会被跳过
+    char *end = nullptr;
+    const int64_t segment = strtoll(entry->d_name + prefix_len, &end, 10);
+    if (end == entry->d_name + prefix_len || *end != '\0' || segment < 0) {
+      continue;
+    }
+
+    first_segment = (first_segment < 0) ? segment : std::min(first_segment, segment);
+    last_segment  = std::max(last_segment, segment);
   }
+  closedir(dir);
+
+  first_segment_ = std::max(first_segment, int64_t(0));
+  last_segment_  = last_segment;
+  LOG_INFO("open clog files. path=%s, segment size=%" PRId64 ", sync method=%s, first segment=%" PRId64
+           ", last segment=%" PRId64,
+           path, segment_size_, clog_sync_method_name(sync_method_), first_segment_, last_segment_);
   return RC::SUCCESS;
 }
 
-RC CLogFile::offset(int64_t &off) const
+CLogFile::~CLogFile()
 {
-  off_t pos = lseek(fd_, 0, SEEK_CUR);
-  if (pos == -1) {
-    LOG_WARN("failed to seek. error=%s", strerror(errno));
-    return RC::IOERR_SEEK;
+  if (prepare_thread_.joinable()) {
+    prepare_thread_.join();
   }
 
-  off = static_cast<int64_t>(pos);
-  return RC::SUCCESS;
+  for (auto &item : segment_fds_) {
+    LOG_INFO("close clog file. file=%s, fd=%d", segment_file_name(item.first).c_str(), item.second);
+    ::close(item.second);
+  }
+  segment_fds_.clear();
+
+  free(read_block_);
+  free(write_buffer_);
+  free(tail_block_);
+  read_block_   = nullptr;
+  write_buffer_ = nullptr;
+  tail_block_   = nullptr;
 }
 
-////////////////////////////////////////////////////////////////////////////////
-RC CLogRecordIterator::init(CLogFile &log_file)
+string CLogFile::segment_file_name(int64_t segment) const
 {
-  log_file_ = &log_file;
-  return RC::SUCCESS;
+  char name[64];
+  snprintf(name, sizeof(name), "%s.%010" PRId64, CLOG_FILE_NAME, segment);
+  return path_ + common::FILE_PATH_SPLIT_STR + name;
 }
 
-bool CLogRecordIterator::valid() const
+RC CLogFile::open_segment(const string &file_name, bool create, int &fd)
 {
-  return nullptr != log_record_;
+  // 日志按照LSN写入到文件的指定位置，所以不能使用 O_APPEND
+  int flags = create ? (O_RDWR | O_CREAT) : O_RDWR;
+  if (sync_method_ == CLogSyncMethod::DSYNC || sync_method_ == CLogSyncMethod::DIRECT) {
+    flags |= O_DSYNC;
+  }
+#ifdef O_DIRECT
+  if (sync_method_ == CLogSyncMethod::DIRECT) {
+    fd = ::open(file_name.c_str(), flags | O_DIRECT, S_IRUSR | S_IWUSR);
+    if (fd >= 0 || errno != EINVAL) {
+      return RC::SUCCESS;
+    }
+
+    LOG_WARN("file system does not support O_DIRECT, use O_DSYNC instead. file=%s", file_name.c_str());
+    sync_method_ = CLogSyncMethod::DSYNC;
+  }
+#endif
+
+  fd = ::open(file_name.c_str(), flags, S_IRUSR | S_IWUSR);
+  return RC::SUCCESS;
 }
 
-RC CLogRecordIterator::next()
+RC CLogFile::prepare_segment(int64_t segment)
 {
-  delete log_record_;
-  log_record_ = nullptr;
-
-  CLogRecordHeader header;
-  RC rc = log_file_->read(reinterpret_cast<char *>(&header), sizeof(header));
-  if (rc != RC::SUCCESS) {
-    if (log_file_->eof()) {
-      return RC::RECORD_EOF;
-    }
+  const string file_name     = segment_file_name(segment);
+  const string tmp_file_name = file_name + ".tmp";
+  if (::access(file_name.c_str(), F_OK) == 0) {
+    return RC::SUCCESS;
+  }
 
-    LOG_WARN("failed to read log header. rc=%s", strrc(rc));
-    return rc;
+  int fd = ::open(tmp_file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    LOG_WARN("failed to create clog file. file=%s, error=%s", tmp_file_name.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
   }
 
-  char *data = nullptr;
-  int32_t record_size = header.logrec_len_;
-  if (record_size > 0) {
-    data = new char[record_size];
-    rc = log_file_->read(data, record_size);
-    if (OB_FAIL(rc)) {
-      if (log_file_->eof()) {
-        // TODO 遇到了没有写完整数据的log，应该truncate一部分数据, 但是现在不管
-      }
-      LOG_WARN("failed to read log data. data size=%d, rc=%s", record_size, strrc(rc));
-      delete[] data;
-      data = nullptr;
-      return rc;
+#ifdef __linux__
+  // 先分配连续的空间，失败了也没关系，填充0时同样会分配空间
+  if (::fallocate(fd, 0, 0, segment_size_) != 0) {
+    LOG_DEBUG("failed to fallocate clog file. file=%s, error=%s", tmp_file_name.c_str(), strerror(errno));
+  }
+#endif
+
+  // 只分配空间的话，第一次写入时文件系统仍然需要修改元数据，所以要真正写入0
+  const int64_t zero_len = std::min<int64_t>(segment_size_, 1024 * 1024);
+  vector<char> zeros(zero_len, 0);
+  int ret = 0;
+  for (int64_t offset = 0; offset < segment_size_ && ret == 0; offset += zero_len) {
+    if (::lseek(fd, offset, SEEK_SET) < 0) {
+      ret = errno;
+      break;
     }
+    ret = writen(fd, zeros.data(), std::min(zero_len, segment_size_ - offset));
+  }
+  if (ret == 0 && fsync(fd) != 0) {
+    ret = errno;
+  }
+  ::close(fd);
+  if (ret != 0) {
+    LOG_WARN("failed to fill clog file. file=%s, error=%s", tmp_file_name.c_str(), strerror(ret));
+    ::unlink(tmp_file_name.c_str());
+    return RC::IOERR_WRITE;
   }
 
-  delete log_record_;
-  log_record_ = CLogRecord::build(header, data);
-  delete[] data;
-  return rc;
+  if (::rename(tmp_file_name.c_str(), file_name.c_str()) != 0) {
+    LOG_WARN("failed to rename clog file. file=%s, error=%s", file_name.c_str(), strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+
+  // 新文件的目录项也需要持久化
+  int dir_fd = ::open(path_.c_str(), O_RDONLY);
+  if (dir_fd >= 0) {
+    fsync(dir_fd);
+    ::close(dir_fd);
+  }
+  LOG_INFO("prepare clog file done. file=%s, size=%" PRId64, file_name.c_str(), segment_size_);
+  return RC::SUCCESS;
 }
 
-const CLogRecord &CLogRecordIterator::log_record()
+void CLogFile::prepare_segment_async(int64_t segment)
 {
-  return *log_record_;
-}
+  if (prepare_thread_.joinable()) {
+    prepare_thread_.join();
+  }
 
-////////////////////////////////////////////////////////////////////////////////
+  preparing_segment_ = segment;
+  prepare_rc_        = RC::SUCCESS;
+  prepare_thread_    = thread([this, segment]() { prepare_rc_ = prepare_segment(segment); });
+}
 
-RC CLogManager::init(const char *path)
+RC CLogFile::wait_prepared_segment(int64_t segment)
 {
-  log_buffer_ = new CLogBuffer();
-  log_file_   = new CLogFile();
-  return log_file_->init(path);
+  if (prepare_thread_.joinable()) {
+    prepare_thread_.join();
+  }
+  if (preparing_segment_ == segment && OB_SUCC(prepare_rc_)) {
+    return RC::SUCCESS;
+  }
+  return prepare_segment(segment);
 }
 
-CLogManager::~CLogManager()
+RC CLogFile::segment_fd(int64_t segment, bool create, int &fd)
 {
-  if (log_buffer_) {
-    delete log_buffer_;
-    log_buffer_ = nullptr;
+  {
+    lock_guard<mutex> guard(lock_);
+    auto iter = segment_fds_.find(segment);
+    if (iter != segment_fds_.end()) {
+      fd = iter->second;
+      return RC::SUCCESS;
+    }
+
+    fd = -1;
+    if (!create && (segment < first_segment_ || segment > last_segment_)) {
+      return RC::SUCCESS;
+    }
   }
 
-  if (log_file_ != nullptr) {
-    delete log_file_;
-    log_file_ = nullptr;
+  // 只有写日志的线程会创建日志段
+  if (create) {
+    RC rc = wait_prepared_segment(segment);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
   }
-}
 
-RC CLogManager::append_log(CLogType type, 
-                int32_t trx_id, 
-                int32_t table_id, 
-                const RID &rid, 
-                int32_t data_len, 
-                int32_t data_offset, 
-                const char *data)
-{
-  CLogRecord *log_record = CLogRecord::build_data_record(type, trx_id, table_id, rid, data_len, data_offset, data);
-  if (nullptr == log_record) {
-    LOG_WARN("failed to create log record");
-    return RC::NOMEM;
+  const string file_name = segment_file_name(segment);
+  RC rc = open_segment(file_name, false /*create*/, fd);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  if (fd < 0) {
+    if (!create && errno == ENOENT) {
+      return RC::SUCCESS;
+    }
+    LOG_WARN("failed to open clog file. filename=%s, error=%s", file_name.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
   }
-  return append_log(log_record);
-}
 
-RC CLogManager::begin_trx(int32_t trx_id)
-{
-  return append_log(CLogRecord::build_mtr_record(CLogType::MTR_BEGIN, trx_id));
+  {
+    lock_guard<mutex> guard(lock_);
+    segment_fds_[segment] = fd;
+    if (last_segment_ < first_segment_) {
+      // 还没有任何日志段，或者日志段都已经被回收了
+      first_segment_ = segment;
+    }
+    if (segment > last_segment_) {
+      last_segment_ = segment;
+    }
+  }
+  LOG_INFO("open clog file success. file=%s, fd=%d", file_name.c_str(), fd);
+
+  if (create) {
+    // 开始写一个新的日志段时，在后台准备好下一个段，切换日志段时不需要等待
+    prepare_segment_async(segment + 1);
+  }
+  return RC::SUCCESS;
 }
 
-RC CLogManager::commit_trx(int32_t trx_id, int32_t commit_xid)
+RC CLogFile::read_blocks(int64_t segment, int64_t block, char *buffer, int block_num, int &read_num)
 {
-  RC rc = append_log(CLogRecord::build_commit_record(trx_id, commit_xid));
-  if (rc != RC::SUCCESS) {
-    LOG_WARN("failed to append trx commit log. trx id=%d, rc=%s", trx_id, strrc(rc));
+  read_num = 0;
+  int fd = -1;
+  RC rc = segment_fd(segment, false /*create*/, fd);
+  if (OB_FAIL(rc) || fd < 0) {
     return rc;
   }
 
-  rc = sync(); // 事务提交时需要把当前事务关联的日志，都写入到磁盘中，这样做是保证不丢数据
-  return rc;
-}
+  off_t  offset = static_cast<off_t>(block) * BLOCK_SIZE;
+  size_t remain = static_cast<size_t>(block_num) * BLOCK_SIZE;
+  size_t total  = 0;
+  while (remain > 0) {
+    ssize_t ret = ::pread(fd, buffer + total, remain, offset);
+    if (ret < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      LOG_WARN("failed to read clog block. file=%s, block=%" PRId64 ", error=%s",
+               segment_file_name(segment).c_str(), block, strerror(errno));
+      return RC::IOERR_READ;
+    }
+    if (ret == 0) {
+      break;
+    }
+    total  += ret;
+    offset += ret;
+    remain -= ret;
+  }
 
-RC CLogManager::rollback_trx(int32_t trx_id)
-{
-  return append_log(CLogRecord::build_mtr_record(CLogType::MTR_ROLLBACK, trx_id));
+  // 文件不完整时，不完整的块当作不存在
+  read_num = static_cast<int>(total / BLOCK_SIZE);
+  return RC::SUCCESS;
 }
 
-RC CLogManager::append_log(CLogRecord *log_record)
+bool CLogFile::check_block(int64_t segment, int64_t block, const char *buffer) const
 {
-  if (nullptr == log_record) {
-    return RC::INVALID_ARGUMENT;
-  }
-  return log_buffer_->append_log_record(log_record);
+  const CLogBlockHeader *header = reinterpret_cast<const CLogBlockHeader *>(buffer);
+  return header->lsn == block_lsn(segment, block) && header->data_len > 0 && header->data_len <= BLOCK_DATA_SIZE &&
+         header->checksum == clog_block_checksum(buffer);
 }
 
-RC CLogManager::sync()
+RC CLogFile::read_block(int64_t segment, int64_t block, char *buffer, bool &valid)
 {
-  return log_buffer_->flush_buffer(*log_file_);
+  int read_num = 0;
+  RC rc = read_blocks(segment, block, buffer, 1, read_num);
+  valid = OB_SUCC(rc) && read_num == 1 && check_block(segment, block, buffer);
+  return rc;
 }
 
-RC CLogManager::recover(Db *db)
+RC CLogFile::write_blocks(int64_t segment, int64_t block, const char *buffer, int block_num)
 {
-  CLogRecordIterator log_record_iterator;
-  RC rc = log_record_iterator.init(*log_file_);
+  int fd = -1;
+  RC rc = segment_fd(segment, true /*create*/, fd);
   if (OB_FAIL(rc)) {
-    LOG_WARN("failed to init log record iterator. rc=%s", strrc(rc));
     return rc;
   }
 
-  TrxKit *trx_manager = GCTX.trx_kit_;
-  ASSERT(trx_manager != nullptr, "cannot do recover that trx_manager is null");
-
+  off_t   offset = static_cast<off_t>(block) * BLOCK_SIZE;
+  size_t  remain = static_cast<size_t>(block_num) * BLOCK_SIZE;
+  while (remain > 0) {
+    ssize_t ret = ::pwrite(fd, buffer, remain, offset);
+    if (ret < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      LOG_WARN("failed to write data to file. filename=%s, offset=%" PRId64 ", error=%s",
+               segment_file_name(segment).c_str(), static_cast<int64_t>(offset), strerror(errno));
+      return RC::IOERR_WRITE;
+    }
+    buffer += ret;
+    offset += ret;
+    remain -= ret;
+  }
+
+  lock_guard<mutex> guard(lock_);
+  unsynced_segments_.insert(segment);
+  return RC::SUCCESS;
+}
+
+RC CLogFile::write_at(LSN lsn, const CLogSlice *slices, int slice_num)
+{
+  int64_t total_len = 0;
+  for (int i = 0; i < slice_num; i++) {
+    total_len += slices[i].len;
+  }
+
+  const int64_t data_size = segment_data_size();
+  const int64_t blocks_per_segment = segment_size_ / BLOCK_SIZE;
+  int slice_index  = 0;
+  int slice_offset = 0;
+  while (total_len > 0) {
+    // 每次写一个日志段内的数据，从 lsn 所在的块开始
+    const int64_t segment     = lsn / data_size;
+    const int64_t first_block = (lsn % data_size) / BLOCK_DATA_SIZE;
+    int           block_offset = static_cast<int>(lsn % BLOCK_DATA_SIZE);
+    const int64_t segment_len  = std::min(total_len, data_size - lsn % data_size);
+    const int     block_num    = static_cast<int>(
+        std::min(blocks_per_segment - first_block, (block_offset + segment_len + BLOCK_DATA_SIZE - 1) / BLOCK_DATA_SIZE));
+
+    if (write_buffer_blocks_ < block_num) {
+      free(write_buffer_);
+      write_buffer_        = alloc_blocks(block_num);
+      write_buffer_blocks_ = write_buffer_ == nullptr ? 0 : block_num;
+      if (write_buffer_ == nullptr) {
+        LOG_WARN("failed to allocate clog write buffer. blocks=%d", block_num);
+        return RC::NOMEM;
+      }
+    }
+
+    // 从块的中间开始写时，块的前一部分数据是上一次写入的
+    if (block_offset > 0) {
+      const CLogBlockHeader *tail_header = reinterpret_cast<const CLogBlockHeader *>(tail_block_);
+      if (tail_header->lsn == block_lsn(segment, first_block) && tail_header->data_len == block_offset) {
+        memcpy(write_buffer_, tail_block_, BLOCK_SIZE);
+      } else {
+        bool valid = false;
+        RC rc = read_block(segment, first_block, write_buffer_, valid);
+        if (OB_FAIL(rc)) {
+          return rc;
+        }
+        if (!valid || reinterpret_cast<CLogBlockHeader *>(write_buffer_)->data_len < block_offset) {
+          LOG_WARN("cannot find the previous data of the block. lsn=%" PRId64, lsn);
+          return RC::IOERR_READ;
+        }
+      }
+    }
+
+    int64_t remain = segment_len;
+    for (int i = 0; i < block_num; i++) {
+      char *block = write_buffer_ + static_cast<size_t>(i) * BLOCK_SIZE;
+      char *block_data = block + sizeof(CLogBlockHeader);
+      const int copy_len = static_cast<int>(std::min<int64_t>(remain, BLOCK_DATA_SIZE - block_offset));
+      int copied = 0;
+      while (copied < copy_len) {
+        const CLogSlice &slice = slices[slice_index];
+        const int len = std::min(slice.len - slice_offset, copy_len - copied);
+        memcpy(block_data + block_offset + copied, slice.data + slice_offset, len);
+        copied += len;
+        slice_offset += len;
+        if (slice_offset >= slice.len) {
+          slice_index++;
+          slice_offset = 0;
+        }
+      }
+
+      const int data_len = block_offset + copy_len;
+      memset(block_data + data_len, 0, BLOCK_DATA_SIZE - data_len);
+      CLogBlockHeader *header = reinterpret_cast<CLogBlockHeader *>(block);
+      header->data_len = data_len;
+      header->lsn      = block_lsn(segment, first_block + i);
+      header->checksum = clog_block_checksum(block);
+
+      remain -= copy_len;
+      block_offset = 0;
+    }
+
+    RC rc = write_blocks(segment, first_block, write_buffer_, block_num);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    memcpy(tail_block_, write_buffer_ + static_cast<size_t>(block_num - 1) * BLOCK_SIZE, BLOCK_SIZE);
+
+    lsn += segment_len;
+    total_len -= segment_len;
+  }
+  return RC::SUCCESS;
+}
+
+RC CLogFile::read(char *data, int len)
+{
+  const int64_t data_size = segment_data_size();
+  while (len > 0) {
+    const int64_t segment = read_lsn_ / data_size;
+    const int64_t block   = (read_lsn_ % data_size) / BLOCK_DATA_SIZE;
+    const int     offset  = static_cast<int>(read_lsn_ % BLOCK_DATA_SIZE);
+    const LSN     lsn     = block_lsn(segment, block);
+
+    if (read_block_lsn_ != lsn) {
+      bool valid = false;
+      RC rc = read_block(segment, block, read_block_, valid);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+      if (!valid) {
+        const CLogBlockHeader *header = reinterpret_cast<const CLogBlockHeader *>(read_block_);
+        if (header->lsn == lsn && header->data_len != 0) {
+          // 块的位置正确但是校验失败，一般是最后一次写入没有完成
+          torn_ = true;
+          LOG_WARN("found a torn clog block, treat as end of log. file=%s, block=%" PRId64 ", lsn=%" PRId64,
+                   segment_file_name(segment).c_str(), block, lsn);
+        }
+        eof_ = true;
+        LOG_TRACE("file read touch eof. segment=%" PRId64 ", block=%" PRId64, segment, block);
+        return RC::IOERR_READ;
+      }
+      read_block_lsn_ = lsn;
+    }
+
+    const CLogBlockHeader *header = reinterpret_cast<const CLogBlockHeader *>(read_block_);
+    if (offset >= header->data_len) {
+      eof_ = true;
+      LOG_TRACE("file read touch eof. lsn=%" PRId64, read_lsn_);
+      return RC::IOERR_READ;
+    }
+
+    const int read_len = std::min(len, header->data_len - offset);
+    memcpy(data, read_block_ + sizeof(CLogBlockHeader) + offset, read_len);
+    data += read_len;
+    len -= read_len;
+    read_lsn_ += read_len;
+  }
+  return RC::SUCCESS;
+}
+
+RC CLogFile::seek(LSN lsn)
+{
+  if (lsn < 0) {
+    return RC::INVALID_ARGUMENT;
+  }
+  read_lsn_       = lsn;
+  read_block_lsn_ = -1;
+  eof_            = false;
+  torn_           = false;
+  return RC::SUCCESS;
+}
+
+RC CLogFile::sync()
+{
+  vector<pair<int64_t, int>> fds;
+  {
+    lock_guard<mutex> guard(lock_);
+    for (int64_t segment : unsynced_segments_) {
+      auto iter = segment_fds_.find(segment);
+      if (iter != segment_fds_.end()) {
+        fds.emplace_back(segment, iter->second);
+      }
+    }
+    unsynced_segments_.clear();
+  }
+
+  if (sync_method_ == CLogSyncMethod::DSYNC || sync_method_ == CLogSyncMethod::DIRECT) {
+    return RC::SUCCESS;
+  }
+
+  for (auto &item : fds) {
+    int ret = (sync_method_ == CLogSyncMethod::FSYNC) ? fsync(item.second) : fdatasync(item.second);
+    if (ret != 0) {
+      LOG_WARN("failed to sync file. file=%s, error=%s", segment_file_name(item.first).c_str(), strerror(errno));
+      return RC::IOERR_SYNC;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC CLogFile::offset(int64_t &off) const
+{
+  off = read_lsn_;
+  return RC::SUCCESS;
+}
+
+RC CLogFile::end_lsn(LSN &lsn)
+{
+  int64_t first_segment = 0;
+  int64_t last_segment  = 0;
+  {
+    lock_guard<mutex> guard(lock_);
+    first_segment = first_segment_;
+    last_segment  = last_segment_;
+  }
+
+  lsn = first_segment * segment_data_size();
+  const int64_t blocks_per_segment = segment_size_ / BLOCK_SIZE;
+  char *buffer = alloc_blocks(1);
+  if (buffer == nullptr) {
+    return RC::NOMEM;
+  }
+
+  // 预先准备好的日志段是空的，从后向前找到第一个有数据的段，再在这个段中找到最后一个有效的块
+  RC rc = RC::SUCCESS;
+  for (int64_t segment = last_segment; segment >= first_segment && OB_SUCC(rc); segment--) {
+    bool valid = false;
+    rc = read_block(segment, 0, buffer, valid);
+    if (OB_FAIL(rc) || !valid) {
+      continue;
+    }
+
+    for (int64_t block = 0; block < blocks_per_segment; block++) {
+      if (block > 0) {
+        rc = read_block(segment, block, buffer, valid);
+        if (OB_FAIL(rc)) {
+          break;
+        }
+      }
+      if (!valid) {
+        lsn = block_lsn(segment, block);
+        break;
+      }
+
+      const CLogBlockHeader *header = reinterpret_cast<const CLogBlockHeader *>(buffer);
+      lsn = block_lsn(segment, block) + header->data_len;
+      if (header->data_len < BLOCK_DATA_SIZE) {
+        break;
+      }
+    }
+    break;
+  }
+  free(buffer);
+  return rc;
+}
+
+RC CLogFile::truncate(LSN lsn)
+{
+  if (prepare_thread_.joinable()) {
+    prepare_thread_.join();
+  }
+
+  const int64_t data_size = segment_data_size();
+  const int64_t segment   = lsn / data_size;
+  const int64_t block     = (lsn % data_size) / BLOCK_DATA_SIZE;
+  const int     offset    = static_cast<int>(lsn % BLOCK_DATA_SIZE);
+
+  {
+    lock_guard<mutex> guard(lock_);
+    for (int64_t i = last_segment_; i > segment; i--) {
+      auto iter = segment_fds_.find(i);
+      if (iter != segment_fds_.end()) {
+        ::close(iter->second);
+        segment_fds_.erase(iter);
+      }
+      unsynced_segments_.erase(i);
+      const string file_name = segment_file_name(i);
+      if (::unlink(file_name.c_str()) != 0 && errno != ENOENT) {
+        LOG_WARN("failed to remove clog file. file=%s, error=%s", file_name.c_str(), strerror(errno));
+        return RC::IOERR_WRITE;
+      }
+    }
+    if (last_segment_ > segment) {
+      last_segment_ = segment;
+    }
+  }
+
+  // 读取 lsn 所在的块以及这个段后面所有的块
+  const int block_num = static_cast<int>(segment_size_ / BLOCK_SIZE - block);
+  char *buffer = alloc_blocks(block_num);
+  if (buffer == nullptr) {
+    return RC::NOMEM;
+  }
+
+  int read_num = 0;
+  RC rc = read_blocks(segment, block, buffer, block_num, read_num);
+  if (OB_FAIL(rc) || read_num == 0) {
+    free(buffer);
+    return rc;
+  }
+
+  bool need_write = false;
+  int  zero_from  = 0;
+  if (offset > 0) {
+    CLogBlockHeader *header = reinterpret_cast<CLogBlockHeader *>(buffer);
+    if (!check_block(segment, block, buffer) || header->data_len < offset) {
+      LOG_WARN("cannot truncate log in an invalid block. lsn=%" PRId64, lsn);
+      free(buffer);
+      return RC::IOERR_READ;
+    }
+    if (header->data_len != offset) {
+      memset(buffer + sizeof(CLogBlockHeader) + offset, 0, BLOCK_DATA_SIZE - offset);
+      header->data_len = offset;
+      header->checksum = clog_block_checksum(buffer);
+      need_write = true;
+    }
+    zero_from = 1;
+  }
+
+  // 后面的块可能有崩溃前没有写完的数据，看起来可能仍然有效，全部清零，以后的写入不会把它们当作日志
+  for (int i = zero_from; i < read_num; i++) {
+    char *block_data = buffer + static_cast<size_t>(i) * BLOCK_SIZE;
+    if (std::any_of(block_data, block_data + BLOCK_SIZE, [](char c) { return c != 0; })) {
+      memset(block_data, 0, BLOCK_SIZE);
+      need_write = true;
+    }
+  }
+
+  if (need_write) {
+    LOG_INFO("truncate clog. lsn=%" PRId64 ", file=%s", lsn, segment_file_name(segment).c_str());
+    rc = write_blocks(segment, block, buffer, read_num);
+    if (OB_SUCC(rc)) {
+      rc = sync();
+    }
+  }
+  if (OB_SUCC(rc)) {
+    memcpy(tail_block_, buffer, BLOCK_SIZE);
+  }
+  free(buffer);
+  read_block_lsn_ = -1;
+  return rc;
+}
+
+RC CLogFile::remove_segments_before(LSN lsn)
+{
+  const int64_t segment = lsn / segment_data_size();
+
+  lock_guard<mutex> guard(lock_);
+  int64_t i = first_segment_;
+  for (; i < segment && i <= last_segment_; i++) {
+    auto iter = segment_fds_.find(i);
+    if (iter != segment_fds_.end()) {
+      ::close(iter->second);
+      segment_fds_.erase(iter);
+    }
+    unsynced_segments_.erase(i);
+
+    const string file_name = segment_file_name(i);
+    if (::unlink(file_name.c_str()) != 0 && errno != ENOENT) {
+      LOG_WARN("failed to remove clog file. file=%s, error=%s", file_name.c_str(), strerror(errno));
+      break;
+    }
+    LOG_INFO("remove clog file. file=%s", file_name.c_str());
+  }
+  first_segment_ = i;
+  return RC::SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+RC CLogRecordIterator::init(CLogFile &log_file, LSN start_lsn)
+{
+  log_file_ = &log_file;
+  next_lsn_ = start_lsn;
+  return log_file.seek(start_lsn);
+}
+
+bool CLogRecordIterator::valid() const
+{
+  return nullptr != log_record_;
+}
+
+RC CLogRecordIterator::next()
+{
+  delete log_record_;
+  log_record_ = nullptr;
+
+  CLogRecordHeader header;
+  RC rc = log_file_->read(reinterpret_cast<char *>(&header), sizeof(header));
+  if (rc != RC::SUCCESS) {
+    if (log_file_->eof()) {
+      return RC::RECORD_EOF;
+    }
+
+    LOG_WARN("failed to read log header. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  if (header.lsn_ != next_lsn_ || header.logrec_len_ < 0) {
+    // 没有写完整的日志，或者是文件尾部残留的旧数据
+    LOG_WARN("got an invalid log header, treat as end of log. expect lsn=%" PRId64 ", header={%s}",
+             next_lsn_, header.to_string().c_str());
+    return RC::RECORD_EOF;
+  }
+
+  char *data = nullptr;
+  int32_t record_size = header.logrec_len_;
+  if (record_size > 0) {
+    data = new char[record_size];
+    rc = log_file_->read(data, record_size);
+    if (OB_FAIL(rc)) {
+      delete[] data;
+      data = nullptr;
+      if (log_file_->eof()) {
+        // 没有写完整数据的日志，由恢复流程截断
+        LOG_WARN("got an incomplete log record, treat as end of log. header={%s}", header.to_string().c_str());
+        return RC::RECORD_EOF;
+      }
+      LOG_WARN("failed to read log data. data size=%d, rc=%s", record_size, strrc(rc));
+      return rc;
+    }
+  }
+
+  delete log_record_;
+  log_record_ = CLogRecord::build(header, data);
+  delete[] data;
+  next_lsn_ += sizeof(header) + record_size;
+  return rc;
+}
+
+const CLogRecord &CLogRecordIterator::log_record()
+{
+  return *log_record_;
+}
+
+CLogRecord *CLogRecordIterator::release_log_record()
+{
+  CLogRecord *log_record = log_record_;
+  log_record_ = nullptr;
+  return log_record;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void atomic_update_max(atomic<int64_t> &target, int64_t value)
+{
+  int64_t current = target.load();
+  while (current < value && !target.compare_exchange_weak(current, value)) {
+  }
+}
+
+double CLogGroupCommitStats::avg_group_size() const
+{
+  const int64_t syncs = sync_count.load();
+  return syncs == 0 ? 0.0 : static_cast<double>(commit_count.load()) / syncs;
+}
+
+double CLogGroupCommitStats::avg_wait_us() const
+{
+  const int64_t waits = wait_count.load();
+  return waits == 0 ? 0.0 : static_cast<double>(total_wait_us.load()) / waits;
+}
+
+string CLogGroupCommitStats::to_string() const
+{
+  stringstream ss;
+  ss << "sync_count:" << sync_count.load()
+     << ", commit_count:" << commit_count.load()
+     << ", avg_group_size:" << avg_group_size()
+     << ", max_group_size:" << max_group_size.load()
+     << ", avg_wait_us:" << avg_wait_us()
+     << ", max_wait_us:" << max_wait_us.load();
+  return ss.str();
+}
+
+double CLogDurabilityStats::avg_lag_us() const
+{
+  const int64_t count = lag_count.load();
+  return count == 0 ? 0.0 : static_cast<double>(total_lag_us.load()) / count;
+}
+
+string CLogDurabilityStats::to_string() const
+{
+  stringstream ss;
+  ss << "sync_commits:" << sync_commits.load()
+     << ", async_commits:" << async_commits.load()
+     << ", buffered_commits:" << buffered_commits.load()
+     << ", background_syncs:" << background_syncs.load()
+     << ", avg_lag_us:" << avg_lag_us()
+     << ", max_lag_us:" << max_lag_us.load()
+     << ", last_lag_us:" << last_lag_us.load();
+  return ss.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+CLogConfig CLogConfig::from_properties()
+{
+  CLogConfig config;
+  Ini *properties = get_properties();
+  if (nullptr == properties) {
+    return config;
+  }
+
+  int64_t value = 0;
+  string str = properties->get("SEGMENT_SIZE", "", CLOG_SECTION);
+  if (!str.empty() && str_to_val(str, value) && value > 0) {
+    // 日志段由日志块组成，向上取整到块大小的整数倍
+    config.segment_size = (value + CLogFile::BLOCK_SIZE - 1) / CLogFile::BLOCK_SIZE * CLogFile::BLOCK_SIZE;
+  }
+
+  str = properties->get("CHECKPOINT_INTERVAL", "", CLOG_SECTION);
+  if (!str.empty() && str_to_val(str, value) && value >= 0) {
+    config.checkpoint_interval = value;
+  }
+
+  int threads = 0;
+  str = properties->get("RECOVERY_THREADS", "", CLOG_SECTION);
+  if (!str.empty() && str_to_val(str, threads)) {
+    config.recovery_threads = threads;
+  }
+
+  str = properties->get("DURABILITY", "", CLOG_SECTION);
+  if (!str.empty()) {
+    CLogDurability durability = CLogDurability::SYNC;
+    if (clog_durability_from_string(str.c_str(), durability) && durability != CLogDurability::DEFAULT) {
+      config.durability = durability;
+    } else {
+      LOG_WARN("invalid clog durability, use %s. value=%s", clog_durability_name(config.durability), str.c_str());
+    }
+  }
+
+  str = properties->get("SYNC_METHOD", "", CLOG_SECTION);
+  if (!str.empty() && !clog_sync_method_from_string(str.c_str(), config.sync_method)) {
+    LOG_WARN("invalid clog sync method, use %s. value=%s", clog_sync_method_name(config.sync_method), str.c_str());
+  }
+
+  int interval = 0;
+  str = properties->get("FLUSH_INTERVAL_MS", "", CLOG_SECTION);
+  if (!str.empty() && str_to_val(str, interval) && interval > 0) {
+    config.flush_interval_ms = interval;
+  }
+  return config;
+}
+
+RC CLogCheckpoint::load(const char *path, bool &found)
+{
+  found = false;
+  const string file_name = string(path) + common::FILE_PATH_SPLIT_STR + CLOG_CHECKPOINT_FILE_NAME;
+  int fd = ::open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      return RC::SUCCESS;
+    }
+    LOG_WARN("failed to open checkpoint file. file=%s, error=%s", file_name.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  int ret = readn(fd, this, sizeof(*this));
+  ::close(fd);
+  if (ret != 0 || magic != MAGIC || segment_size <= 0) {
+    LOG_ERROR("invalid checkpoint file. file=%s", file_name.c_str());
+    return RC::IOERR_READ;
+  }
+  if (version != VERSION) {
+    LOG_ERROR("unsupported clog format. file=%s, version=%d, expected version=%d", file_name.c_str(), version, VERSION);
+    return RC::IOERR_READ;
+  }
+
+  found = true;
+  LOG_INFO("load checkpoint. redo lsn=%" PRId64 ", checkpoint lsn=%" PRId64 ", segment size=%" PRId64 ", max trx id=%d",
+           redo_lsn, checkpoint_lsn, segment_size, max_trx_id);
+  return RC::SUCCESS;
+}
+
+RC CLogCheckpoint::save(const char *path) const
+{
+  const string file_name = string(path) + common::FILE_PATH_SPLIT_STR + CLOG_CHECKPOINT_FILE_NAME;
+  const string tmp_file_name = file_name + ".tmp";
+  int fd = ::open(tmp_file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    LOG_WARN("failed to create checkpoint file. file=%s, error=%s", tmp_file_name.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  int ret = writen(fd, this, sizeof(*this));
+  if (ret == 0 && fsync(fd) != 0) {
+    ret = errno;
+  }
+  ::close(fd);
+  if (ret != 0) {
+    LOG_WARN("failed to write checkpoint file. file=%s, error=%s", tmp_file_name.c_str(), strerror(ret));
+    return RC::IOERR_WRITE;
+  }
+
+  if (::rename(tmp_file_name.c_str(), file_name.c_str()) != 0) {
+    LOG_WARN("failed to rename checkpoint file. file=%s, error=%s", file_name.c_str(), strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+  return RC::SUCCESS;
+}
+
+RC CLogManager::init(const char *path, const CLogConfig &config, BufferPoolManager *buffer_pool_manager)
+{
+  path_                = path;
+  config_              = config;
+  buffer_pool_manager_ = buffer_pool_manager;
+  default_durability_  = config_.durability == CLogDurability::DEFAULT ? CLogDurability::SYNC : config_.durability;
+
+  // 日志段的大小以检查点文件中记录的为准，否则修改配置后就找不到原来的日志了
+  CLogCheckpoint checkpoint;
+  bool found = false;
+  RC rc = checkpoint.load(path_.c_str(), found);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  if (found && checkpoint.segment_size != config_.segment_size) {
+    LOG_WARN("clog segment size in config is ignored. config=%" PRId64 ", existing=%" PRId64,
+             config_.segment_size, checkpoint.segment_size);
+    config_.segment_size = checkpoint.segment_size;
+  }
+
+  log_buffer_ = new CLogBuffer();
+  log_file_   = new CLogFile();
+  rc = log_file_->init(path, config_.segment_size, config_.sync_method);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  if (!found) {
+    checkpoint.segment_size = config_.segment_size;
+    checkpoint.redo_lsn     = log_file_->begin_lsn();
+    rc = checkpoint.save(path_.c_str());
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  last_checkpoint_lsn_ = checkpoint.checkpoint_lsn;
+
+  // 恢复时会根据有效的日志重新设置LSN
+  LSN end_lsn = 0;
+  rc = log_file_->end_lsn(end_lsn);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  flushed_lsn_ = end_lsn;
+  rc = log_buffer_->init(end_lsn);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  if (buffer_pool_manager_ != nullptr) {
+    Frame::set_lsn_source(&log_buffer_->reserved_lsn());
+    buffer_pool_manager_->set_log_flusher([this](LSN lsn) {
+      // 页面LSN不会超过已经放入缓存的日志，除非页面来自一份更长的日志(比如日志被删除了)，不能一直等下去
+      return sync_log(std::min(lsn, log_buffer_->published_lsn()));
+    });
+  }
+
+  flush_thread_ = thread(&CLogManager::flush_thread_func, this);
+  return RC::SUCCESS;
+}
+
+CLogManager::~CLogManager()
+{
+  stop_flush_thread();
+  // 正常关闭时不丢失 ASYNC 提交的事务
+  if (log_buffer_ != nullptr && async_lsn_.load() > flushed_lsn()) {
+    sync_log(async_lsn_.load());
+  }
+
+  if (buffer_pool_manager_ != nullptr) {
+    Frame::set_lsn_source(nullptr);
+    buffer_pool_manager_->set_log_flusher(nullptr);
+  }
+
+  if (group_commit_stats_.sync_count > 0) {
+    LOG_INFO("clog group commit stats: %s", group_commit_stats_.to_string().c_str());
+  }
+  if (durability_stats_.async_commits > 0 || durability_stats_.buffered_commits > 0) {
+    LOG_INFO("clog durability stats: %s", durability_stats_.to_string().c_str());
+  }
+
+  if (log_buffer_) {
+    delete log_buffer_;
+    log_buffer_ = nullptr;
+  }
+
+  if (log_file_ != nullptr) {
+    delete log_file_;
+    log_file_ = nullptr;
+  }
+}
+
+RC CLogManager::append_log(CLogType type, 
+                int32_t trx_id, 
+                int32_t table_id, 
+                const RID &rid, 
+                int32_t data_len, 
+                int32_t data_offset, 
+                const char *data,
+                LSN *end_lsn)
+{
+  CLogRecordHeader header;
+  header.trx_id_     = trx_id;
+  header.type_       = clog_type_to_integer(type);
+  header.logrec_len_ = CLogRecordData::HEADER_SIZE + data_len;
+
+  CLogRecordData data_record;
+  data_record.table_id_    = table_id;
+  data_record.rid_         = rid;
+  data_record.data_len_    = data_len;
+  data_record.data_offset_ = data_offset;
+
+  LSN record_end_lsn = 0;
+  RC rc = append_log(header,
+      {CLogSlice{reinterpret_cast<const char *>(&data_record), CLogRecordData::HEADER_SIZE}, CLogSlice{data, data_len}},
+      record_end_lsn);
+  if (OB_SUCC(rc) && end_lsn != nullptr) {
+    *end_lsn = record_end_lsn;
+  }
+  return rc;
+}
+
+RC CLogManager::begin_trx(int32_t trx_id)
+{
+  CLogRecordHeader header;
+  header.trx_id_ = trx_id;
+  header.type_   = clog_type_to_integer(CLogType::MTR_BEGIN);
+
+  // 先记录活跃事务再写日志。记录的LSN不大于 MTR_BEGIN 日志的LSN，检查点也不会漏掉这个事务
+  {
+    lock_guard<mutex> guard(active_trx_lock_);
+    active_trx_lsns_[trx_id] = log_buffer_->reserved_lsn().load();
+  }
+
+  LSN end_lsn = 0;
+  return append_log(header, {}, end_lsn);
+}
+
+RC CLogManager::commit_trx(int32_t trx_id, int32_t commit_xid, LSN *commit_end_lsn, CLogDurability durability)
+{
+  CLogRecordHeader header;
+  header.trx_id_     = trx_id;
+  header.type_       = clog_type_to_integer(CLogType::MTR_COMMIT);
+  header.logrec_len_ = sizeof(CLogRecordCommitData);
+
+  CLogRecordCommitData commit_record;
+  commit_record.commit_xid_ = commit_xid;
+
+  // 在日志放到缓存之前计数，这样覆盖这条日志的那次刷盘一定能统计到它
+  pending_commits_++;
+  LSN end_lsn = 0;
+  RC rc = append_log(header, {CLogSlice{reinterpret_cast<const char *>(&commit_record), sizeof(commit_record)}}, end_lsn);
+  if (rc != RC::SUCCESS) {
+    pending_commits_--;
+    LOG_WARN("failed to append trx commit log. trx id=%d, rc=%s", trx_id, strrc(rc));
+    return rc;
+  }
+
+  {
+    lock_guard<mutex> guard(active_trx_lock_);
+    active_trx_lsns_.erase(trx_id);
+  }
+
+  if (commit_end_lsn != nullptr) {
+    *commit_end_lsn = end_lsn;
+  }
+
+  if (durability == CLogDurability::DEFAULT) {
+    durability = default_durability_.load();
+  }
+
+  // 记录最早一个没有持久化的提交返回的时间，刷盘时据此计算持久化延迟
+  auto note_unsynced_commit = [this]() {
+    int64_t expected = 0;
+    oldest_unsynced_us_.compare_exchange_strong(expected, current_time_us());
+  };
+
+  if (durability == CLogDurability::ASYNC) {
+    // 日志已经在缓存中，由后台线程刷盘
+    atomic_update_max(async_lsn_, end_lsn);
+    note_unsynced_commit();
+    durability_stats_.async_commits++;
+    return RC::SUCCESS;
+  }
+
+  if (durability == CLogDurability::BUFFERED) {
+    rc = write_log(end_lsn);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to write trx commit log. trx id=%d, rc=%s", trx_id, strrc(rc));
+      return rc;
+    }
+    note_unsynced_commit();
+    durability_stats_.buffered_commits++;
+    return RC::SUCCESS;
+  }
+
+  // 事务提交时需要把当前事务关联的日志，都写入到磁盘中，这样做是保证不丢数据
+  // 事务的日志LSN都小于提交日志的LSN，所以等待提交日志持久化就可以了
+  durability_stats_.sync_commits++;
+  auto begin = chrono::steady_clock::now();
+  rc = sync_to(end_lsn);
+  const int64_t wait_us = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - begin).count();
+  group_commit_stats_.wait_count++;
+  group_commit_stats_.total_wait_us += wait_us;
+  atomic_update_max(group_commit_stats_.max_wait_us, wait_us);
+  return rc;
+}
+
+RC CLogManager::rollback_trx(int32_t trx_id, LSN *rollback_end_lsn)
+{
+  CLogRecordHeader header;
+  header.trx_id_ = trx_id;
+  header.type_   = clog_type_to_integer(CLogType::MTR_ROLLBACK);
+
+  LSN end_lsn = 0;
+  RC rc = append_log(header, {}, end_lsn);
+  if (OB_SUCC(rc)) {
+    lock_guard<mutex> guard(active_trx_lock_);
+    active_trx_lsns_.erase(trx_id);
+  }
+  if (OB_SUCC(rc) && rollback_end_lsn != nullptr) {
+    *rollback_end_lsn = end_lsn;
+  }
+  return rc;
+}
+
+void CLogManager::retain_trx(int32_t trx_id)
+{
+  lock_guard<mutex> guard(active_trx_lock_);
+  auto iter = active_trx_lsns_.find(trx_id);
+  if (iter != active_trx_lsns_.end()) {
+    retained_trxes_[trx_id] = RetainedTrx{iter->second, 0};
+  }
+}
+
+void CLogManager::release_trx(int32_t trx_id)
+{
+  lock_guard<mutex> guard(active_trx_lock_);
+  auto iter = retained_trxes_.find(trx_id);
+  if (iter != retained_trxes_.end()) {
+    // 改写时页面变脏，记录的LSN不大于现在的日志结尾
+    iter->second.released_lsn = log_buffer_->reserved_lsn().load();
+  }
+}
+
+RC CLogManager::append_log(CLogRecordHeader &header, initializer_list<CLogSlice> body, LSN &end_lsn)
+{
+  return log_buffer_->append_log_record(*log_file_, header, body, end_lsn);
+}
+
+RC CLogManager::sync()
+{
+  return sync_to(log_buffer_->published_lsn());
+}
+
+RC CLogManager::sync_to(LSN lsn)
+{
+  RC rc = sync_log(lsn);
+  if (OB_SUCC(rc)) {
+    checkpoint_if_needed();
+  }
+  return rc;
+}
+
+RC CLogManager::sync_log(LSN lsn)
+{
+  unique_lock<mutex> lock(sync_lock_);
+  while (flushed_lsn_ < lsn) {
+    if (syncing_) {
+      // 已经有leader在刷盘，等它完成后再检查自己的日志是否已经持久化
+      sync_cond_.wait(lock);
+      continue;
+    }
+
+    syncing_ = true;
+    lock.unlock();
+
+    // 先取出最早一个没有持久化的提交的时间。这个提交返回前日志已经复制到缓存中，这次刷盘一定会覆盖它
+    const int64_t oldest_unsynced_us = oldest_unsynced_us_.exchange(0);
+
+    // 把已经复制到缓存中的日志都写入文件，然后执行一次sync
+    LSN written_lsn = 0;
+    RC rc = log_buffer_->flush_buffer(*log_file_, written_lsn);
+    const int64_t commit_count = pending_commits_.exchange(0);
+    if (OB_SUCC(rc)) {
+      rc = log_file_->sync();
+    }
+
+    if (oldest_unsynced_us != 0) {
+      if (OB_SUCC(rc)) {
+        const int64_t lag_us = current_time_us() - oldest_unsynced_us;
+        durability_stats_.lag_count++;
+        durability_stats_.total_lag_us += lag_us;
+        durability_stats_.last_lag_us = lag_us;
+        atomic_update_max(durability_stats_.max_lag_us, lag_us);
+      } else {
+        int64_t expected = 0;
+        oldest_unsynced_us_.compare_exchange_strong(expected, oldest_unsynced_us);
+      }
+    }
+
+    lock.lock();
+    syncing_ = false;
+    if (OB_SUCC(rc) && written_lsn > flushed_lsn_) {
+      flushed_lsn_ = written_lsn;
+    }
+    sync_cond_.notify_all();
+
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to flush log buffer. lsn=%" PRId64 ", rc=%s", lsn, strrc(rc));
+      return rc;
+    }
+
+    group_commit_stats_.sync_count++;
+    group_commit_stats_.commit_count += commit_count;
+    atomic_update_max(group_commit_stats_.max_group_size, commit_count);
+  }
+  return RC::SUCCESS;
+}
+
+RC CLogManager::write_log(LSN lsn)
+{
+  // 调用者的日志已经复制到缓存中，一次写入就可以覆盖它
+  LSN written_lsn = 0;
+  RC rc = log_buffer_->flush_buffer(*log_file_, written_lsn);
+  if (OB_SUCC(rc) && written_lsn < lsn) {
+    LOG_WARN("log is not written. lsn=%" PRId64 ", written lsn=%" PRId64, lsn, written_lsn);
+    rc = RC::INTERNAL;
+  }
+  return rc;
+}
+
+void CLogManager::set_default_durability(CLogDurability durability)
+{
+  if (durability == CLogDurability::DEFAULT) {
+    durability = config_.durability;
+  }
+  LOG_INFO("change clog durability from %s to %s",
+           clog_durability_name(default_durability_.load()), clog_durability_name(durability));
+  default_durability_ = durability;
+}
+
+string CLogManager::durability_status()
+{
+  const LSN published_lsn = log_buffer_->published_lsn();
+  const LSN written_lsn   = log_buffer_->written_lsn();
+  const LSN synced_lsn    = flushed_lsn();
+  const int64_t oldest_unsynced_us = oldest_unsynced_us_.load();
+
+  stringstream ss;
+  ss << "durability:" << clog_durability_name(default_durability_.load())
+     << ", flush_interval_ms:" << config_.flush_interval_ms
+     << ", published_lsn:" << published_lsn
+     << ", written_lsn:" << written_lsn
+     << ", flushed_lsn:" << synced_lsn
+     << ", unwritten_bytes:" << std::max<LSN>(0, published_lsn - written_lsn)
+     << ", unsynced_bytes:" << std::max<LSN>(0, published_lsn - synced_lsn)
+     << ", oldest_unsynced_commit_us:" << (oldest_unsynced_us == 0 ? 0 : current_time_us() - oldest_unsynced_us)
+     << ", " << durability_stats_.to_string();
+  return ss.str();
+}
+
+void CLogManager::flush_thread_func()
+{
+  unique_lock<mutex> lock(flush_lock_);
+  while (!flush_stopped_) {
+    flush_cond_.wait_for(lock, chrono::milliseconds(config_.flush_interval_ms));
+    if (flush_stopped_) {
+      break;
+    }
+
+    const LSN lsn = async_lsn_.load();
+    if (lsn > flushed_lsn()) {
+      lock.unlock();
+      RC rc = sync_log(lsn);
+      lock.lock();
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to sync async commit log. lsn=%" PRId64 ", rc=%s", lsn, strrc(rc));
+      } else {
+        durability_stats_.background_syncs++;
+      }
+    }
+
+    // 提交时只发出请求，检查点要刷 buffer pool 的文件，在这里做，不阻塞提交
+    if (checkpoint_requested_.exchange(false)) {
+      lock.unlock();
+      RC rc = checkpoint();
+      lock.lock();
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to do checkpoint. rc=%s", strrc(rc));
+      }
+    }
+  }
+}
+
+void CLogManager::stop_flush_thread()
+{
+  if (!flush_thread_.joinable()) {
+    return;
+  }
+
+  {
+    lock_guard<mutex> guard(flush_lock_);
+    flush_stopped_ = true;
+    flush_cond_.notify_all();
+  }
+  flush_thread_.join();
+}
+
+void CLogManager::checkpoint_if_needed()
+{
+  if (config_.checkpoint_interval <= 0) {
+    return;
+  }
+
+  if (flushed_lsn() - last_checkpoint_lsn_.load() < config_.checkpoint_interval) {
+    return;
+  }
+
+  // 已经请求过了，刷盘线程还没有做完
+  if (checkpoint_requested_.exchange(true)) {
+    return;
+  }
+
+  lock_guard<mutex> guard(flush_lock_);
+  flush_cond_.notify_all();
+}
+
+RC CLogManager::checkpoint()
+{
+  lock_guard<mutex> guard(checkpoint_lock_);
+
+  // 先确定日志的结尾。之后才变脏的页面和开始的事务，记录的LSN都不会比它小
+  const LSN checkpoint_lsn = log_buffer_->published_lsn();
+  LSN redo_lsn = checkpoint_lsn;
+
+  RC rc = RC::SUCCESS;
+  LSN dirty_lsn = 0;
+  bool found = false;
+  if (buffer_pool_manager_ != nullptr) {
+    buffer_pool_manager_->oldest_dirty_lsn(dirty_lsn, found);
+    if (found) {
+      redo_lsn = std::min(redo_lsn, dirty_lsn);
+    }
+
+    // 已经写出去的页面不再是脏页，需要保证它们已经持久化
+    rc = buffer_pool_manager_->sync_files();
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to sync buffer pool files. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  {
+    lock_guard<mutex> trx_guard(active_trx_lock_);
+    for (const auto &item : active_trx_lsns_) {
+      redo_lsn = std::min(redo_lsn, item.second);
+    }
+
+    // 提交以后改写记录的页面，如果比最老的脏页更早变脏，说明已经落盘，不再需要这个事务的日志
+    for (auto iter = retained_trxes_.begin(); iter != retained_trxes_.end();) {
+      const RetainedTrx &trx = iter->second;
+      if (trx.released_lsn != 0 && (!found || dirty_lsn > trx.released_lsn)) {
+        iter = retained_trxes_.erase(iter);
+      } else {
+        redo_lsn = std::min(redo_lsn, trx.begin_lsn);
+        ++iter;
+      }
+    }
+  }
+
+  // 检查点文件中记录的位置，之前的日志都必须已经持久化
+  rc = sync_log(checkpoint_lsn);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to sync log before checkpoint. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  CLogCheckpoint checkpoint;
+  checkpoint.segment_size   = log_file_->segment_size();
+  checkpoint.redo_lsn       = redo_lsn;
+  checkpoint.checkpoint_lsn = checkpoint_lsn;
+  checkpoint.max_trx_id     = GCTX.trx_kit_ != nullptr ? GCTX.trx_kit_->current_trx_id() : 0;
+  rc = checkpoint.save(path_.c_str());
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  last_checkpoint_lsn_ = checkpoint_lsn;
+
+  rc = log_file_->remove_segments_before(redo_lsn);
+  LOG_INFO("checkpoint done. redo lsn=%" PRId64 ", checkpoint lsn=%" PRId64 ", rc=%s",
+           redo_lsn, checkpoint_lsn, strrc(rc));
+  return rc;
+}
+
+LSN CLogManager::flushed_lsn()
+{
+  lock_guard<mutex> lock(sync_lock_);
+  return flushed_lsn_;
+}
+
+RC CLogManager::redo_serially(Db *db, CLogRecordIterator &iterator)
+{
+  TrxKit *trx_manager = GCTX.trx_kit_;
+  RC rc = RC::SUCCESS;
+
   /// 遍历所有的日志，然后做redo
   // 在做redo时，需要记录处理的事务。在所有的日志都重做完成时，如果有事务没有结束，那这些事务就需要回滚
-  for (rc = log_record_iterator.next(); OB_SUCC(rc) && log_record_iterator.valid(); rc = log_record_iterator.next()) {
-    const CLogRecord &log_record = log_record_iterator.log_record();
+  for (rc = iterator.next(); OB_SUCC(rc) && iterator.valid(); rc = iterator.next()) {
+    const CLogRecord &log_record = iterator.log_record();
     LOG_TRACE("begin to redo log={%s}", log_record.to_string().c_str());
     switch (log_record.log_type()) {
       case CLogType::MTR_BEGIN: {
@@ -535,6 +1797,8 @@ RC CLogManager::recover(Db *db)
           return rc;
         }
 
+        // 已经结束的事务不再需要，不能一直留在活跃事务表中
+        trx_manager->destroy_trx(trx);
       } break;
 
       default: {
@@ -559,11 +1823,77 @@ RC CLogManager::recover(Db *db)
     rc = RC::SUCCESS;
   } else {
     LOG_ERROR("failed to redo log iterator. rc=%s", strrc(rc));
+  }
+  return rc;
+}
+
+RC CLogManager::recover(Db *db)
+{
+  CLogCheckpoint checkpoint;
+  bool found = false;
+  RC rc = checkpoint.load(path_.c_str(), found);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  // 从检查点记录的恢复起点开始重做，更早的日志段可能已经被删除了
+  const LSN redo_lsn = std::max(found ? checkpoint.redo_lsn : 0, log_file_->begin_lsn());
+  LOG_INFO("begin to recover from lsn %" PRId64, redo_lsn);
+
+  CLogRecordIterator log_record_iterator;
+  rc = log_record_iterator.init(*log_file_, redo_lsn);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init log record iterator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  TrxKit *trx_manager = GCTX.trx_kit_;
+  ASSERT(trx_manager != nullptr, "cannot do recover that trx_manager is null");
+
+  // 检查点之前的事务不会重做，但是它们的事务号已经写到了记录上
+  if (found) {
+    trx_manager->advance_trx_id(checkpoint.max_trx_id);
+  }
+
+  auto begin = chrono::steady_clock::now();
+  if (config_.recovery_threads < 0) {
+    rc = redo_serially(db, log_record_iterator);
+  } else {
+    CLogParallelRecovery parallel_recovery(db, *trx_manager, config_.recovery_threads);
+    rc = parallel_recovery.recover(log_record_iterator);
+  }
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("failed to redo log. rc=%s", strrc(rc));
     return rc;
   }
+  LOG_INFO("redo log done. lsn=[%" PRId64 ", %" PRId64 "), cost %" PRId64 "ms",
+           redo_lsn, log_record_iterator.next_lsn(),
+           (int64_t)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - begin).count());
 
   LOG_TRACE("recover redo log done");
 
+  // 删除文件尾部没有写完整的日志，新的日志接着最后一条完整的日志写。
+  // 最后一次写入可能只有一部分块落盘了，有效日志之后也可能有看起来完整的块，所以总是需要截断
+  const LSN end_lsn = log_record_iterator.next_lsn();
+  LSN file_end_lsn = 0;
+  rc = log_file_->end_lsn(file_end_lsn);
+  if (OB_SUCC(rc)) {
+    if (file_end_lsn > end_lsn || log_file_->torn()) {
+      LOG_WARN("truncate incomplete log. file end lsn=%" PRId64 ", valid end lsn=%" PRId64 ", torn=%d",
+               file_end_lsn, end_lsn, log_file_->torn());
+    }
+    rc = log_file_->truncate(end_lsn);
+  }
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  log_buffer_->set_current_lsn(end_lsn);
+  {
+    lock_guard<mutex> lock(sync_lock_);
+    flushed_lsn_ = end_lsn;
+  }
+
   vector<Trx *> uncommitted_trxes;
   trx_manager->all_trxes(uncommitted_trxes);
   LOG_INFO("find %d uncommitted trx", uncommitted_trxes.size());
@@ -19,10 +19,15 @@ See the Mulan PSL v2 for more details. */
 #include <list>
 #include <atomic>
 #include <unordered_map>
-#include <deque>
-#include <memory>
+#include <initializer_list>
+#include <map>
+#include <set>
 #include <string>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 
+#include "common/types.h"
 #include "storage/record/record.h"
 #include "storage/persist/persist.h"
 #include "common/lang/mutex.h"
@@ -31,6 +36,7 @@ class CLogManager;
 class CLogBuffer;
 class CLogFile;
 class Db;
+class BufferPoolManager;
 
 /**
  * @defgroup CLog
@@ -55,7 +61,8 @@ class Db;
   DEFINE_CLOG_TYPE(MTR_COMMIT)        \
   DEFINE_CLOG_TYPE(MTR_ROLLBACK)      \
   DEFINE_CLOG_TYPE(INSERT)            \
-  DEFINE_CLOG_TYPE(DELETE)
+  DEFINE_CLOG_TYPE(DELETE)            \
+  DEFINE_CLOG_TYPE(UPDATE)
 
 enum class CLogType 
 { 
@@ -81,13 +88,39 @@ int32_t clog_type_to_integer(CLogType type);
  */
 CLogType clog_type_from_integer(int32_t value);
 
+/**
+ * @brief 事务提交时日志的持久化级别
+ * @ingroup CLog
+ * @details 可以在配置文件中设置服务器的默认值，也可以使用 SET 修改会话或服务器的设置。
+ */
+enum class CLogDurability
+{
+  DEFAULT,   ///< 使用服务器的设置，只用于会话
+  SYNC,      ///< 提交日志持久化(fsync)以后提交才返回
+  ASYNC,     ///< 提交日志放入日志缓存后就返回，后台线程每隔一段时间执行一次fsync。进程崩溃会丢失最近的提交
+  BUFFERED,  ///< 提交日志写入操作系统(write)后就返回，不主动执行fsync。进程崩溃不丢数据，操作系统崩溃会丢失
+};
+
+/**
+ * @brief 持久化级别转换成字符串
+ * @ingroup CLog
+ */
+const char *clog_durability_name(CLogDurability durability);
+
+/**
+ * @brief 字符串转换成持久化级别，不区分大小写
+ * @ingroup CLog
+ * @return 不认识的字符串返回false
+ */
+bool clog_durability_from_string(const char *str, CLogDurability &durability);
+
 /**
  * @brief CLog的记录头。每个日志都带有这个信息
  * @ingroup CLog
  */
 struct CLogRecordHeader 
 {
-  int32_t lsn_ = -1;     ///< log sequence number。当前没有使用
+  LSN     lsn_ = -1;     ///< log sequence number。日志在日志流(文件)中的字节偏移量，加入到 CLogBuffer 时分配
   int32_t trx_id_ = -1;  ///< 日志所属事务的编号
   int32_t type_ = clog_type_to_integer(CLogType::ERROR); ///< 日志类型
   int32_t logrec_len_ = 0;  ///< record的长度，不包含header长度
@@ -121,6 +154,8 @@ struct CLogRecordCommitData
  * @brief 有具体数据修改的事务日志数据
  * @ingroup CLog
  * @details 这里记录的都是操作的记录，比如插入、删除一条数据。
+ * 修改(UPDATE)日志只记录记录中发生变化的一段连续字节：data_offset_ 是这段数据在记录中的偏移量，
+ * data_ 中先是修改后的数据，后面跟着修改前的数据(用于回滚)，两段长度相同，data_len_ 是两段的总长度。
  */
 struct CLogRecordData
 {
@@ -157,47 +192,13 @@ class CLogRecord
 public:
   /**
    * @brief 默认构造函数。
-   * @details 通常不需要直接调用这个函数来创建一条日志，而是调用 `build_xxx`创建对象。
+   * @details 通常不需要直接调用这个函数来创建一条日志，而是调用 `build`创建对象。
+   * 写日志时不会创建日志对象，而是直接序列化到 CLogBuffer 中，日志对象只在读取日志时使用。
    */
   CLogRecord() = default;
 
   ~CLogRecord();
 
-  /**
-   * @brief 创建一个事务相关的日志对象
-   * @details 除了MTR_COMMIT的日志(请参考 build_commit_record)。
-   * @param type 日志类型
-   * @param trx_id 事务编号
-   */
-  static CLogRecord *build_mtr_record(CLogType type, int32_t trx_id);
-
-  /**
-   * @brief 创建一个表示提交事务的日志对象
-   * 
-   * @param trx_id 事务编号
-   * @param commit_xid 事务提交时使用的编号
-   */
-  static CLogRecord *build_commit_record(int32_t trx_id, int32_t commit_xid);
-
-  /**
-   * @brief 创建一个表示数据操作的日志对象
-   * 
-   * @param type 类型
-   * @param trx_id 事务编号
-   * @param table_id 操作的表
-   * @param rid 操作的哪条记录
-   * @param data_len 数据的长度
-   * @param data_offset 偏移量，参考 CLogRecordData::data_offset_
-   * @param data 具体的数据
-   */
-  static CLogRecord *build_data_record(CLogType type,
-                                       int32_t trx_id,
-                                       int32_t table_id,
-                                       const RID &rid,
-                                       int32_t data_len,
-                                       int32_t data_offset,
-                                       const char *data);
-  
   /**
    * @brief 根据二进制数据创建日志对象
    * @details 通常是从日志文件中读取数据，然后调用此函数创建日志对象
@@ -210,6 +211,11 @@ public:
   int32_t  trx_id() const { return header_.trx_id_; }
   int32_t  logrec_len() const { return header_.logrec_len_; }
 
+  /**
+   * @brief 日志在日志流中的结束位置。修改页面时，页面LSN记录的就是这个位置
+   */
+  LSN end_lsn() const { return header_.lsn_ + static_cast<LSN>(sizeof(header_)) + header_.logrec_len_; }
+
   CLogRecordHeader &header() { return header_; }
   CLogRecordCommitData &commit_record() { return commit_record_; }
   CLogRecordData   &data_record() { return data_record_; }
@@ -228,54 +234,163 @@ protected:
 };
 
 /**
- * @brief 缓存运行时产生的日志对象
+ * @brief 日志体中的一段数据
+ * @ingroup CLog
+ */
+struct CLogSlice
+{
+  const char *data = nullptr;
+  int32_t     len  = 0;
+};
+
+/**
+ * @brief 缓存运行时产生的日志
  * @ingroup CLog
- * @details 当前的实现非常简单，没有采用其它数据库中常用的将日志序列化到二进制buffer，
- * 管理二进制buffer的方法。这里仅仅把日志记录下来，放到链表中。如果达到一定量的日志，
- * 或者日志数量超过某个阈值，就会调用flush_buffer将日志刷新到磁盘中。
+ * @details 日志缓存是一块预先分配的环形内存，日志直接序列化到这块内存中，不再为每条日志分配对象。
+ * LSN是日志在日志流中的字节偏移量，也就是日志在文件中的偏移量。
+ * 写日志时先在 reserved_lsn_ 上使用 fetch_add 预留一段空间 [lsn, lsn + size)，然后各个线程并行地
+ * 把日志复制到自己的空间中，复制完成后按照LSN的顺序推进 published_lsn_。
+ * 刷盘时把 [written_lsn_, published_lsn_) 这段连续的数据一次写入文件(环形内存回绕时是两段内存，
+ * 使用 pwritev 也只需要一次系统调用)。
+ * 缓存满了以后，写日志的线程自己把数据写入文件腾出空间，而不是返回失败。
  */
 class CLogBuffer 
 {
 public:
-  CLogBuffer();
+  static constexpr int DEFAULT_CAPACITY = 4 * 1024 * 1024;
+
+public:
+  CLogBuffer() = default;
   ~CLogBuffer();
 
+  /**
+   * @brief 初始化
+   * @param start_lsn 下一条日志的LSN，也就是日志文件当前的有效长度
+   * @param capacity 缓存的大小
+   */
+  RC init(LSN start_lsn, int capacity = DEFAULT_CAPACITY);
+
   /**
    * @brief 增加一条日志
-   * @details 如果当前的日志达到一定量，就会刷新数据
+   * @details header 的 lsn_ 由这个函数设置，日志体可以由多段数据组成，依次复制到缓存中。
+   * header.logrec_len_ 必须等于日志体的总长度。
+   * @param log_file 缓存满了时，需要先把数据写入这个文件
+   * @param header 日志头
+   * @param body 日志体
+   * @param end_lsn 这条日志结束的位置。end_lsn 之前的数据持久化以后，这条日志就持久化了
    */
-  RC append_log_record(CLogRecord *log_record);
+  RC append_log_record(CLogFile &log_file, CLogRecordHeader &header, std::initializer_list<CLogSlice> body,
+                       LSN &end_lsn);
 
   /**
-   * @brief 将当前的日志都刷新到日志文件中
-   * @details 因为多线程访问与日志管理的问题，只能有一个线程调用此函数
+   * @brief 将已经复制完成的日志都写入到日志文件中，不执行sync
+   * @details 可以多个线程同时调用，同一时刻只有一个线程在写文件
    * @param log_file 日志文件
+   * @param written_lsn 返回时，LSN小于 written_lsn 的日志都已经写入文件
+   */
+  RC flush_buffer(CLogFile &log_file, LSN &written_lsn);
+
+  /**
+   * @brief 已经复制完成的日志的结束位置。小于这个值的日志都可以写入文件
+   */
+  LSN published_lsn() const { return published_lsn_.load(); }
+
+  /**
+   * @brief 小于这个值的日志都已经写入文件，但不一定已经持久化
+   */
+  LSN written_lsn() const { return written_lsn_.load(); }
+
+  /**
+   * @brief 已经分配出去的LSN，也就是下一条日志的LSN
+   * @details 页帧变脏时读取这个值作为 recovery LSN
+   */
+  const std::atomic<LSN> &reserved_lsn() const { return reserved_lsn_; }
+
+  /**
+   * @brief 重新设置当前的LSN，恢复完成后使用，新的日志从这个值开始分配
+   * @note 调用时不能有其它线程在写日志
    */
-  RC flush_buffer(CLogFile &log_file);
+  void set_current_lsn(LSN lsn);
 
 private:
   /**
-   * @brief 将日志记录写入到日志文件中
-   * 
-   * @param log_file 日志文件，概念上来讲不一定是某个特定的文件
-   * @param log_record 要写入的日志记录
+   * @brief 等待缓存中有足够的空间容纳 [.., end_lsn)
    */
-  RC write_log_record(CLogFile &log_file, CLogRecord *log_record);
+  RC wait_for_space(CLogFile &log_file, LSN end_lsn);
+
+  /**
+   * @brief 把数据复制到 lsn 在缓存中对应的位置，处理回绕
+   */
+  void copy_in(LSN lsn, const char *data, int len);
 
 private:
-  common::Mutex lock_;  ///< 加锁支持多线程并发写入
-  std::deque<std::unique_ptr<CLogRecord>> log_records_;  ///< 当前等待刷数据的日志记录
-  std::atomic_int32_t total_size_;  ///< 当前缓存中的日志记录的总大小
+  char *buffer_   = nullptr;  ///< 环形缓存，LSN对应的位置是 lsn % capacity_
+  int   capacity_ = 0;
+
+  std::atomic<LSN> reserved_lsn_{0};   ///< 已经分配出去的LSN
+  std::atomic<LSN> published_lsn_{0};  ///< 小于这个值的日志都已经复制到缓存中
+  std::atomic<LSN> written_lsn_{0};    ///< 小于这个值的日志都已经写入文件，缓存空间可以重用
+
+  std::mutex write_lock_;  ///< 同一时刻只有一个线程写文件。多个线程会同时写日志，所以不使用 common::Mutex
+};
+
+/**
+ * @brief 日志文件刷盘的方式
+ * @ingroup CLog
+ */
+enum class CLogSyncMethod
+{
+  FSYNC,      ///< write 之后调用 fsync
+  FDATASYNC,  ///< write 之后调用 fdatasync。日志段是预先分配的，写日志不改变文件大小，不需要同步元数据
+  DSYNC,      ///< 使用 O_DSYNC 打开文件，每次 write 都直接持久化，不再需要 sync
+  DIRECT,     ///< 使用 O_DIRECT | O_DSYNC 打开文件，不经过操作系统的页缓存。文件系统不支持时使用 DSYNC
+};
+
+/**
+ * @brief 刷盘方式转换成字符串
+ * @ingroup CLog
+ */
+const char *clog_sync_method_name(CLogSyncMethod method);
+
+/**
+ * @brief 字符串转换成刷盘方式，不区分大小写
+ * @ingroup CLog
+ */
+bool clog_sync_method_from_string(const char *str, CLogSyncMethod &method);
+
+/**
+ * @brief 日志块的头部
+ * @ingroup CLog
+ * @details 日志文件由固定大小的日志块组成，每个块的开头是这个头部，后面是日志流中的数据。
+ * 校验和覆盖头部中校验和之后的字段和块中的有效数据，块的LSN用来识别预分配的空块和旧的数据。
+ */
+struct CLogBlockHeader
+{
+  uint32_t checksum = 0;  ///< 校验和，CRC32C
+  int32_t  data_len = 0;  ///< 块中有效数据的长度，小于块的容量时表示这是日志的最后一个块
+  LSN      lsn      = 0;  ///< 块中第一个字节数据的LSN
 };
 
 /**
  * @brief 读写日志文件
  * @ingroup CLog
- * @details 这里的名字不太贴切，因为这个类希望管理所有日志文件，而不是特定的某个文件。不过当前
- * 只有一个文件，并且文件名是固定的。
+ * @details 管理日志目录下所有的日志文件。日志流被切分成固定大小的段(segment)，每段是一个文件，
+ * 文件名是 clog.<段编号>。
+ * 每个日志段又由 4KB 的日志块组成，块的开头是 CLogBlockHeader，LSN仍然是日志流中的偏移量，不包含块的头部。
+ * 一个日志段可以存放 segment_data_size() 字节的日志，LSN为 lsn 的数据放在编号为 lsn / segment_data_size()
+ * 的段中。检查点之前的段可以删除，所以第一个段的编号不一定是0。
+ * 日志段在第一次写入前预先分配空间并填充0，之后写日志不会改变文件大小，刷盘时不需要同步文件的元数据，
+ * 写入下一个段之前，后台会提前准备好这个段。
+ * 写入总是以块为单位，最后一个没有写满的块在下一次写入时会重新写一遍，所以可以使用 O_DIRECT。
+ * 读取时检查每个块的校验和，校验失败的块(比如没有写完整的块)以及之后的数据都认为不存在。
  */
 class CLogFile 
 {
+public:
+  static constexpr int64_t DEFAULT_SEGMENT_SIZE = 16 * 1024 * 1024;
+  static constexpr int     BLOCK_SIZE           = 4096;
+  static constexpr int     BLOCK_DATA_SIZE      = BLOCK_SIZE - static_cast<int>(sizeof(CLogBlockHeader));
+
 public:
   CLogFile() = default;
   ~CLogFile();
@@ -283,46 +398,149 @@ public:
   /**
    * @brief 初始化
    * 
-   * @param path 日志文件存放的路径。会打开这个目录下叫做 clog 的文件。
+   * @param path 日志文件存放的路径。会管理这个目录下所有 clog.<N> 文件。
+   * @param segment_size 每个日志段文件的大小，必须是 BLOCK_SIZE 的整数倍
+   * @param sync_method 刷盘的方式
    */
-  RC init(const char *path);
+  RC init(const char *path, int64_t segment_size = DEFAULT_SEGMENT_SIZE,
+          CLogSyncMethod sync_method = CLogSyncMethod::FDATASYNC);
 
   /**
-   * @brief 写入指定数据，全部写入成功返回成功，否则返回失败
-   * @details 作为日志文件读写的类，实现一个write_log_record可能更合适。
+   * @brief 在指定位置写入多段数据，全部写入成功返回成功，否则返回失败
+   * @details 数据被组织成日志块，每个日志段内的数据只需要一次系统调用。
+   * lsn 必须是上一次写入的结束位置，或者是已有日志的结尾。
+   * 同一时刻只能有一个线程写入。
    * @note  如果日志文件写入一半失败了，应该做特殊处理，但是这里什么都没管。
-   * @param data 写入的数据
-   * @param len  数据的长度
+   * @param lsn 写入的位置
+   * @param slices 写入的数据
+   * @param slice_num 数据的段数
    */
-  RC write(const char *data, int len);
+  RC write_at(LSN lsn, const CLogSlice *slices, int slice_num);
 
   /**
-   * @brief 读取指定长度的数据。全部读取成功返回成功，否则返回失败
-   * @details 与 write 有类似的问题。如果读取到了文件尾，会标记eof，可以通过eof()函数来判断。
+   * @brief 从当前读取的位置开始，读取指定长度的数据。全部读取成功返回成功，否则返回失败
+   * @details 如果读取到了日志尾，会标记eof，可以通过eof()函数来判断。
+   * 校验和错误的块也当作日志尾，同时标记 torn，可以通过 torn() 函数判断。
    * @param data 数据读出来放这里
    * @param len  读取的长度
    */
   RC read(char *data, int len);
 
   /**
-   * @brief 将当前写的文件执行sync同步数据到磁盘
+   * @brief 设置读取的位置
+   */
+  RC seek(LSN lsn);
+
+  /**
+   * @brief 将写入过的日志段执行sync同步数据到磁盘
+   * @details 使用 O_DSYNC 打开文件时，写入时已经持久化，这里什么都不做
    */
   RC sync();
 
   /**
-   * @brief 获取当前读取的文件位置
+   * @brief 获取当前读取的位置
    */
   RC offset(int64_t &off) const;
 
+  /**
+   * @brief 日志的结束位置
+   * @details 日志段是预先分配的，需要从最后一个有数据的段开始逐个检查日志块，找到最后一个有效的块
+   */
+  RC end_lsn(LSN &lsn);
+
+  /**
+   * @brief 第一个日志段的起始位置
+   */
+  LSN begin_lsn() const { return first_segment_ * segment_data_size(); }
+
+  /**
+   * @brief 截断日志。恢复时用来删除没有写完整的日志
+   * @details 重写 lsn 所在的块，把所在日志段后面的块都填充为0，并删除后面所有的日志段
+   */
+  RC truncate(LSN lsn);
+
+  /**
+   * @brief 删除所有数据都在 lsn 之前的日志段
+   * @details 检查点完成以后调用，回收已经不需要的日志
+   */
+  RC remove_segments_before(LSN lsn);
+
+  int64_t        segment_size() const { return segment_size_; }
+  int64_t        segment_data_size() const { return segment_size_ / BLOCK_SIZE * BLOCK_DATA_SIZE; }
+  CLogSyncMethod sync_method() const { return sync_method_; }
+
   /**
    * @brief 当前是否已经读取到文件尾
    */
   bool eof() const { return eof_; }
 
+  /**
+   * @brief 读取时是否遇到了校验和错误的块
+   */
+  bool torn() const { return torn_; }
+
+private:
+  std::string segment_file_name(int64_t segment) const;
+
+  /**
+   * @brief 获取日志段的文件描述符
+   * @param create 日志段不存在时是否创建。创建时预先分配空间并填充0
+   * @param fd 返回的文件描述符，日志段不存在并且不创建时返回-1
+   */
+  RC segment_fd(int64_t segment, bool create, int &fd);
+
+  /**
+   * @brief 打开日志段文件，O_DIRECT 不可用时改用 O_DSYNC
+   */
+  RC open_segment(const std::string &file_name, bool create, int &fd);
+
+  /**
+   * @brief 创建日志段文件，分配空间并填充0。先写临时文件再改名，日志段文件总是完整的
+   */
+  RC prepare_segment(int64_t segment);
+
+  /**
+   * @brief 在后台准备下一个日志段
+   */
+  void prepare_segment_async(int64_t segment);
+  RC   wait_prepared_segment(int64_t segment);
+
+  /**
+   * @brief 读取并检查一个日志块
+   * @param valid 块的校验和、LSN都正确时为true
+   */
+  RC read_block(int64_t segment, int64_t block, char *buffer, bool &valid);
+  RC read_blocks(int64_t segment, int64_t block, char *buffer, int block_num, int &read_num);
+  bool check_block(int64_t segment, int64_t block, const char *buffer) const;
+  RC write_blocks(int64_t segment, int64_t block, const char *buffer, int block_num);
+
+  LSN block_lsn(int64_t segment, int64_t block) const
+  {
+    return segment * segment_data_size() + block * BLOCK_DATA_SIZE;
+  }
+
 protected:
-  std::string filename_;  ///< 日志文件名。总是init函数参数path路径下的clog文件
-  int fd_ = -1;           ///< 操作的文件描述符
-  bool eof_ = false;      ///< 是否已经读取到文件尾
+  std::string    path_;                       ///< 日志文件存放的目录
+  int64_t        segment_size_  = DEFAULT_SEGMENT_SIZE;
+  CLogSyncMethod sync_method_   = CLogSyncMethod::FDATASYNC;
+  int64_t        first_segment_ = 0;          ///< 第一个日志段的编号
+  int64_t        last_segment_  = -1;         ///< 最后一个日志段的编号，小于 first_segment_ 表示没有日志段
+  LSN            read_lsn_ = 0;               ///< 当前读取的位置
+  bool           eof_  = false;               ///< 是否已经读取到文件尾
+  bool           torn_ = false;               ///< 是否遇到了校验和错误的块
+
+  char   *read_block_     = nullptr;          ///< 最近读取的块，按照 BLOCK_SIZE 对齐
+  LSN     read_block_lsn_ = -1;               ///< read_block_ 中块的LSN，-1表示没有
+  char   *write_buffer_   = nullptr;          ///< 写入时组织日志块的缓存，按照 BLOCK_SIZE 对齐
+  int     write_buffer_blocks_ = 0;
+  char   *tail_block_     = nullptr;          ///< 最后写入的块，下一次写入从这个块的中间开始时使用
+
+  std::mutex                 lock_;        ///< 保护下面的成员。读写数据时不加锁
+  std::map<int64_t, int>     segment_fds_; ///< 已经打开的日志段
+  std::set<int64_t>          unsynced_segments_; ///< 写入以后还没有sync的日志段
+  std::thread                prepare_thread_;    ///< 准备下一个日志段的线程
+  int64_t                    preparing_segment_ = -1;
+  RC                         prepare_rc_ = RC::SUCCESS;
 };
 
 /**
@@ -336,15 +554,133 @@ public:
   CLogRecordIterator() = default;
   ~CLogRecordIterator() = default;
 
-  RC init(CLogFile &log_file);
+  /**
+   * @brief 初始化
+   * @param log_file 日志文件
+   * @param start_lsn 从这个位置开始读取日志。通常是检查点记录的恢复起点
+   */
+  RC init(CLogFile &log_file, LSN start_lsn = 0);
 
   bool valid() const;
+
+  /**
+   * @brief 读取下一条日志
+   * @details 读到文件尾、校验和错误的日志块、不完整的日志或者LSN与日志位置不一致的日志，都认为日志已经结束，返回 RECORD_EOF。
+   * 是否因为校验和错误而结束可以通过 CLogFile::torn 判断
+   */
   RC next();
   const CLogRecord &log_record();
 
+  /**
+   * @brief 取走当前的日志对象，由调用者负责释放。之后 valid 返回false，直到再次调用 next
+   */
+  CLogRecord *release_log_record();
+
+  /**
+   * @brief 下一条日志的LSN，也就是已经读取的完整日志的结束位置
+   */
+  LSN next_lsn() const { return next_lsn_; }
+
 private:
   CLogFile *log_file_ = nullptr;
   CLogRecord *log_record_ = nullptr;
+  LSN next_lsn_ = 0;
+};
+
+/**
+ * @brief 组提交(group commit)的统计信息
+ * @ingroup CLog
+ * @details 每次刷盘称为一组，组的大小是这次刷盘写入的提交日志个数。
+ * 等待时间是 commit_trx 从提交日志放入缓存到日志持久化的时间。
+ */
+struct CLogGroupCommitStats
+{
+  std::atomic<int64_t> sync_count{0};        ///< 刷盘(fsync)次数
+  std::atomic<int64_t> commit_count{0};      ///< 刷盘写入的提交日志个数
+  std::atomic<int64_t> max_group_size{0};    ///< 一次刷盘写入的最多提交日志个数
+  std::atomic<int64_t> wait_count{0};        ///< 等待日志持久化的提交次数
+  std::atomic<int64_t> total_wait_us{0};     ///< 提交等待持久化的总时间(微秒)
+  std::atomic<int64_t> max_wait_us{0};       ///< 提交等待持久化的最长时间(微秒)
+
+  double avg_group_size() const;
+  double avg_wait_us() const;
+
+  std::string to_string() const;
+};
+
+/**
+ * @brief 不同持久化级别的统计信息
+ * @ingroup CLog
+ * @details 持久化延迟(lag)是提交返回到提交日志真正持久化之间的时间，只有 ASYNC 和 BUFFERED 提交才有。
+ * 每次刷盘时，用这次刷盘覆盖的最早一个提交返回的时间计算延迟，也就是这一批提交中最长的延迟。
+ */
+struct CLogDurabilityStats
+{
+  std::atomic<int64_t> sync_commits{0};      ///< SYNC 提交的次数
+  std::atomic<int64_t> async_commits{0};     ///< ASYNC 提交的次数
+  std::atomic<int64_t> buffered_commits{0};  ///< BUFFERED 提交的次数
+  std::atomic<int64_t> background_syncs{0};  ///< 后台线程刷盘的次数
+  std::atomic<int64_t> lag_count{0};         ///< 统计了延迟的刷盘次数
+  std::atomic<int64_t> total_lag_us{0};      ///< 延迟的总时间(微秒)
+  std::atomic<int64_t> max_lag_us{0};        ///< 最长的延迟(微秒)
+  std::atomic<int64_t> last_lag_us{0};       ///< 最近一次刷盘的延迟(微秒)
+
+  double avg_lag_us() const;
+
+  std::string to_string() const;
+};
+
+/**
+ * @brief 日志模块的配置
+ * @ingroup CLog
+ * @details 在配置文件的 [CLOG] 中设置
+ */
+struct CLogConfig
+{
+  int64_t segment_size        = CLogFile::DEFAULT_SEGMENT_SIZE;  ///< SEGMENT_SIZE 日志段的大小
+  int64_t checkpoint_interval = 4 * CLogFile::DEFAULT_SEGMENT_SIZE; ///< CHECKPOINT_INTERVAL 写入这么多日志后做一次检查点，0表示不自动做检查点
+  int     recovery_threads    = 0; ///< RECOVERY_THREADS 并行恢复的重做线程数。0表示使用CPU核数，小于0表示在当前线程中串行重做
+  CLogDurability durability   = CLogDurability::SYNC; ///< DURABILITY 服务器默认的提交持久化级别：sync/async/buffered
+  int     flush_interval_ms   = 100; ///< FLUSH_INTERVAL_MS ASYNC 提交时后台线程刷盘的间隔
+  CLogSyncMethod sync_method  = CLogSyncMethod::FDATASYNC; ///< SYNC_METHOD 日志文件刷盘的方式：fsync/fdatasync/dsync/direct
+
+  /**
+   * @brief 从配置文件中读取配置，没有配置的项使用默认值
+   */
+  static CLogConfig from_properties();
+};
+
+/**
+ * @brief 检查点信息，保存在日志目录下的 clog_checkpoint 文件中
+ * @ingroup CLog
+ * @details 检查点是模糊的(fuzzy)：做检查点时不刷脏页，也不阻塞写入，只是记录恢复时需要从哪里开始重做。
+ * 恢复起点是最老的脏页第一次变脏时的LSN、最老的活跃事务开始的LSN和当前日志结尾中的最小值。
+ * 这之前的日志对应的修改都已经在磁盘上，相关的事务也都结束了，恢复时不需要再读取。
+ */
+struct CLogCheckpoint
+{
+  static constexpr int32_t MAGIC = 0x434b5054;  ///< "CKPT"
+
+  /// 日志文件的格式。1: 日志段由带校验和的日志块组成; 2: 检查点记录最大的事务号
+  static constexpr int32_t VERSION = 2;
+
+  int32_t magic        = MAGIC;
+  int32_t version      = VERSION;
+  int64_t segment_size = 0;   ///< 日志段的大小。修改配置后仍然使用日志文件原来的段大小
+  LSN     redo_lsn     = 0;   ///< 恢复时从这个位置开始重做
+  LSN     checkpoint_lsn = 0; ///< 做检查点时日志的结尾
+  int32_t max_trx_id   = 0;   ///< 做检查点时已经分配的最大事务号。恢复时不一定重做到分配它的日志
+
+  /**
+   * @brief 读取日志目录下的检查点文件
+   * @param found 检查点文件不存在时返回false
+   */
+  RC load(const char *path, bool &found);
+
+  /**
+   * @brief 写入检查点文件。先写临时文件再改名，保证检查点文件总是完整的
+   */
+  RC save(const char *path) const;
 };
 
 /**
@@ -363,11 +699,14 @@ public:
    * @brief 初始化日志管理器
    * 
    * @param path 日志都放在这个目录下。当前就是数据库的目录
+   * @param config 日志段大小、检查点间隔等配置
+   * @param buffer_pool_manager 日志负责恢复的 buffer pool。做检查点时从这里获取最老的脏页
    */
-  RC init(const char *path);
+  RC init(const char *path, const CLogConfig &config = CLogConfig(), BufferPoolManager *buffer_pool_manager = nullptr);
 
   /**
    * @brief 新增一条数据更新的日志
+   * @param end_lsn 返回日志的结束位置，修改的页面需要记录这个值
    */
   RC append_log(CLogType type,
                 int32_t trx_id,
@@ -375,7 +714,8 @@ public:
                 const RID &rid,
                 int32_t data_len,
                 int32_t data_offset,
-                const char *data);
+                const char *data,
+                LSN *end_lsn = nullptr);
 
   /**
    * @brief 开启一个事务
@@ -389,34 +729,156 @@ public:
    * 
    * @param trx_id 事务编号
    * @param commit_xid 事务提交时使用的编号
+   * @param end_lsn 返回提交日志的结束位置
+   * @param durability 持久化级别，决定提交返回前日志写到哪里。DEFAULT 表示使用服务器的设置
    */
-  RC commit_trx(int32_t trx_id, int32_t commit_xid);
+  RC commit_trx(int32_t trx_id, int32_t commit_xid, LSN *end_lsn = nullptr,
+                CLogDurability durability = CLogDurability::DEFAULT);
 
   /**
    * @brief 回滚一个事务
    * 
    * @param trx_id 事务编号
+   * @param end_lsn 返回回滚日志的结束位置
+   */
+  RC rollback_trx(int32_t trx_id, LSN *end_lsn = nullptr);
+
+  /**
+   * @brief 事务提交以后，检查点仍然保留这个事务的日志
+   * @details 提交时没有把提交号写到记录上的事务，记录上留有负的事务号，恢复时需要重做它的提交。
+   * 在 commit_trx 之前调用，记录都改写完成以后调用 release_trx
    */
-  RC rollback_trx(int32_t trx_id);
+  void retain_trx(int32_t trx_id);
 
   /**
-   * @brief 也可以调用这个函数直接增加一条日志
+   * @brief 事务修改的记录都已经改写成提交号
+   * @details 改写没有日志，改写过的页面都落盘以后，检查点才不再保留这个事务的日志
    */
-  RC append_log(CLogRecord *log_record);
+  void release_trx(int32_t trx_id);
+
 
   /**
    * @brief 刷新日志到磁盘
    */
   RC sync();
 
+  /**
+   * @brief 等待LSN小于等于 lsn 的日志都持久化
+   * @details 组提交：同一时刻只有一个线程(leader)刷盘，它会把缓存中所有的日志写入文件并执行一次fsync。
+   * 其它线程(follower)在条件变量上等待，如果leader完成后自己的日志已经持久化就直接返回，否则其中一个
+   * 线程成为新的leader。这样并发提交的事务可以共享一次fsync。
+   */
+  RC sync_to(LSN lsn);
+
+  /**
+   * @brief 小于这个值的日志都已经持久化
+   */
+  LSN flushed_lsn();
+
+  const CLogGroupCommitStats &group_commit_stats() const { return group_commit_stats_; }
+  const CLogDurabilityStats  &durability_stats() const { return durability_stats_; }
+
+  /**
+   * @brief 当前的持久化状态
+   * @details 包括服务器的持久化级别、各个级别的统计信息，以及还没有写入文件和还没有持久化的日志量
+   */
+  std::string durability_status();
+
+  /**
+   * @brief 服务器默认的持久化级别
+   */
+  CLogDurability default_durability() const { return default_durability_.load(); }
+  void           set_default_durability(CLogDurability durability);
+
+  /**
+   * @brief 做一次模糊检查点
+   * @details 计算恢复起点并持久化到检查点文件中，然后删除恢复起点之前的日志段。
+   * 写入的日志超过配置的间隔时，刷盘的线程会自动调用
+   */
+  RC checkpoint();
+
   /**
    * @brief 重做
-   * @details 当前会重做所有日志。也就是说，所有buffer pool页面都不会写入到磁盘中，
-   * 否则可能无法恢复成功。
+   * @details 从最近一次检查点记录的恢复起点开始重做日志，没有检查点时重做所有日志。
    */
   RC recover(Db *db);
 
+private:
+  /**
+   * @brief 把日志序列化到日志缓存中
+   */
+  RC append_log(CLogRecordHeader &header, std::initializer_list<CLogSlice> body, LSN &end_lsn);
+
+  /**
+   * @brief 在当前线程中按照日志顺序重做，直到日志结束
+   */
+  RC redo_serially(Db *db, CLogRecordIterator &iterator);
+
+  /**
+   * @brief 等待 lsn 之前的日志持久化，不会触发检查点
+   * @details buffer pool 刷脏页前调用，这时可能持有 buffer pool 的锁，而做检查点需要访问 buffer pool
+   */
+  RC sync_log(LSN lsn);
+
+  /**
+   * @brief 写入的日志超过检查点间隔时，通知刷盘线程做检查点
+   * @details 提交时调用，只发出请求，不等待检查点完成
+   */
+  void checkpoint_if_needed();
+
+  /**
+   * @brief 把 lsn 之前的日志写入文件，不执行fsync
+   */
+  RC write_log(LSN lsn);
+
+  /**
+   * @brief 后台刷盘线程，每隔 flush_interval_ms 把 ASYNC 提交的日志持久化
+   * @details 有检查点请求时也在这个线程中做检查点
+   */
+  void flush_thread_func();
+  void stop_flush_thread();
+
 private:
   CLogBuffer *log_buffer_ = nullptr;   ///< 日志缓存。新增日志时先放到内存，也就是这个buffer中
   CLogFile *  log_file_   = nullptr;   ///< 管理日志，比如读写日志
+
+  std::mutex              sync_lock_;          ///< 保护 syncing_ 和 flushed_lsn_
+  std::condition_variable sync_cond_;          ///< follower 在这里等待 leader 刷盘完成
+  bool                    syncing_ = false;    ///< 是否有 leader 正在刷盘
+  LSN                     flushed_lsn_ = 0;    ///< 小于这个值的日志都已经持久化
+  std::atomic<int64_t>    pending_commits_{0}; ///< 还没有刷盘的提交日志个数，用来统计组的大小
+
+  std::string         path_;
+  CLogConfig          config_;
+  BufferPoolManager * buffer_pool_manager_ = nullptr;
+
+  std::mutex                          active_trx_lock_;
+  std::unordered_map<int32_t, LSN>    active_trx_lsns_;  ///< 活跃事务的 MTR_BEGIN 日志的LSN
+
+  /**
+   * @brief 提交以后还需要保留日志的事务
+   */
+  struct RetainedTrx
+  {
+    LSN begin_lsn    = 0;  ///< MTR_BEGIN 日志的LSN
+    LSN released_lsn = 0;  ///< 调用 release_trx 时日志的结尾，0表示还没有改写完成
+  };
+  std::unordered_map<int32_t, RetainedTrx> retained_trxes_;  ///< 由 active_trx_lock_ 保护
+
+  std::mutex        checkpoint_lock_;              ///< 同一时刻只做一个检查点
+  std::atomic<bool> checkpoint_requested_{false};  ///< 提交时发现需要做检查点，等待刷盘线程处理
+  std::atomic<LSN>  last_checkpoint_lsn_{0};       ///< 上一次检查点时日志的结尾
+
+  CLogGroupCommitStats group_commit_stats_;
+
+  std::atomic<CLogDurability> default_durability_{CLogDurability::SYNC};
+  std::atomic<LSN>            async_lsn_{0};          ///< ASYNC 提交的日志的最大结束位置，后台线程需要刷到这里
+  std::atomic<int64_t>        oldest_unsynced_us_{0}; ///< 最早一个还没有持久化的 ASYNC/BUFFERED 提交返回的时间，0表示没有
+
+  std::thread             flush_thread_;
+  std::mutex              flush_lock_;
+  std::condition_variable flush_cond_;
+  bool                    flush_stopped_ = false;
+
+  CLogDurabilityStats durability_stats_;
 };
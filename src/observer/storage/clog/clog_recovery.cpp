@@ -0,0 +1,225 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <inttypes.h>
+#include <algorithm>
+
+#include "storage/clog/clog_recovery.h"
+#include "storage/clog/clog.h"
+#include "storage/trx/trx.h"
+#include "common/log/log.h"
+
+using namespace std;
+
+CLogParallelRecovery::CLogParallelRecovery(Db *db, TrxKit &trx_kit, int thread_num)
+    : db_(db), trx_kit_(trx_kit), thread_num_(thread_num)
+{
+  if (thread_num_ <= 0) {
+    thread_num_ = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+
+#ifndef CONCURRENCY
+  // buffer pool、B+树等模块只有在 CONCURRENCY 模式下才支持多线程访问。
+  // 这时只使用一个重做线程，读取日志与重做仍然可以并行
+  if (thread_num_ > 1) {
+    LOG_INFO("use 1 redo thread instead of %d as concurrency is not enabled", thread_num_);
+    thread_num_ = 1;
+  }
+#endif
+}
+
+CLogParallelRecovery::~CLogParallelRecovery()
+{
+  stop_workers();
+}
+
+RC CLogParallelRecovery::recover(CLogRecordIterator &iterator)
+{
+  LOG_INFO("begin to redo log with %d threads", thread_num_);
+
+  for (int i = 0; i < thread_num_; i++) {
+    queues_.emplace_back(new RedoQueue);
+  }
+  for (int i = 0; i < thread_num_; i++) {
+    workers_.emplace_back(&CLogParallelRecovery::redo_worker, this, i);
+  }
+
+  RC rc = RC::SUCCESS;
+  for (rc = iterator.next(); OB_SUCC(rc) && iterator.valid(); rc = iterator.next()) {
+    if (failed_.load()) {
+      break;
+    }
+
+    shared_ptr<CLogRecord> log_record(iterator.release_log_record());
+    rc = dispatch(log_record);
+    if (OB_FAIL(rc)) {
+      set_error(rc);
+      break;
+    }
+    record_count_++;
+  }
+
+  if (rc == RC::RECORD_EOF) {
+    rc = RC::SUCCESS;
+  } else if (OB_FAIL(rc)) {
+    LOG_ERROR("failed to read log. rc=%s", strrc(rc));
+    set_error(rc);
+  }
+
+  stop_workers();
+
+  if (failed_.load()) {
+    return error_;
+  }
+
+  LOG_INFO("parallel redo done. threads=%d, records=%" PRId64 ", unfinished trx=%d",
+           thread_num_, record_count_, static_cast<int>(active_trxes_.size()));
+  return RC::SUCCESS;
+}
+
+int CLogParallelRecovery::partition_of(int32_t table_id, PageNum page_num) const
+{
+  const uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(table_id)) << 32) | static_cast<uint32_t>(page_num);
+  return static_cast<int>(std::hash<uint64_t>()(key) % thread_num_);
+}
+
+RC CLogParallelRecovery::dispatch(shared_ptr<CLogRecord> log_record)
+{
+  LOG_TRACE("begin to dispatch log={%s}", log_record->to_string().c_str());
+
+  const int32_t trx_id = log_record->trx_id();
+  if (log_record->log_type() == CLogType::MTR_BEGIN) {
+    Trx *trx = trx_kit_.create_trx(trx_id);
+    if (trx == nullptr) {
+      LOG_WARN("failed to create trx. log_record={%s}", log_record->to_string().c_str());
+      return RC::INTERNAL;
+    }
+
+    TrxState &trx_state = active_trxes_[trx_id];
+    trx_state.trx = trx;
+    trx_state.partitions.assign(thread_num_, false);
+    return RC::SUCCESS;
+  }
+
+  auto iter = active_trxes_.find(trx_id);
+  if (iter == active_trxes_.end()) {
+    LOG_WARN("no such trx. trx id=%d, log_record={%s}", trx_id, log_record->to_string().c_str());
+    return RC::INTERNAL;
+  }
+
+  TrxState &trx_state = iter->second;
+  RC rc = trx_state.trx->redo_analyze(db_, *log_record);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to analyze log. log_record={%s}, rc=%s", log_record->to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  switch (log_record->log_type()) {
+    case CLogType::INSERT:
+    case CLogType::DELETE:
+    case CLogType::UPDATE: {
+      const CLogRecordData &data_record = log_record->data_record();
+      const int partition = partition_of(data_record.table_id_, data_record.rid_.page_num);
+      trx_state.partitions[partition] = true;
+      push(partition, RedoTask{log_record, trx_state.trx});
+    } break;
+
+    case CLogType::MTR_COMMIT:
+    case CLogType::MTR_ROLLBACK: {
+      const int partition_num = static_cast<int>(count(trx_state.partitions.begin(), trx_state.partitions.end(), true));
+      if (partition_num == 0) {
+        trx_kit_.destroy_trx(trx_state.trx);
+      } else {
+        // 重做线程可能还在使用这个事务，由最后一个处理完的线程销毁
+        auto pending = make_shared<atomic<int>>(partition_num);
+        for (int partition = 0; partition < thread_num_; partition++) {
+          if (trx_state.partitions[partition]) {
+            push(partition, RedoTask{log_record, trx_state.trx, pending});
+          }
+        }
+      }
+      active_trxes_.erase(iter);
+    } break;
+
+    default: {
+      LOG_WARN("unsupported redo log. log_record={%s}", log_record->to_string().c_str());
+      return RC::INTERNAL;
+    } break;
+  }
+  return RC::SUCCESS;
+}
+
+void CLogParallelRecovery::push(int partition, RedoTask task)
+{
+  RedoQueue &queue = *queues_[partition];
+  unique_lock<mutex> lock(queue.lock);
+  queue.not_full.wait(lock, [&queue]() { return queue.tasks.size() < MAX_QUEUE_SIZE; });
+  queue.tasks.push_back(std::move(task));
+  queue.not_empty.notify_one();
+}
+
+void CLogParallelRecovery::redo_worker(int partition)
+{
+  RedoQueue &queue = *queues_[partition];
+  RedoPartitionFilter filter = [this, partition](int32_t table_id, PageNum page_num) {
+    return partition_of(table_id, page_num) == partition;
+  };
+
+  while (true) {
+    RedoTask task;
+    {
+      unique_lock<mutex> lock(queue.lock);
+      queue.not_empty.wait(lock, [&queue]() { return queue.closed || !queue.tasks.empty(); });
+      if (queue.tasks.empty()) {
+        break;
+      }
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      queue.not_full.notify_one();
+    }
+
+    // 出错以后只是把队列取空，读取日志的线程不会一直等待
+    if (!failed_.load()) {
+      RC rc = task.trx->redo_partition(db_, *task.log_record, filter);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to redo log. partition=%d, log_record={%s}, rc=%s",
+                 partition, task.log_record->to_string().c_str(), strrc(rc));
+        set_error(rc);
+      }
+    }
+
+    if (task.pending && task.pending->fetch_sub(1) == 1) {
+      trx_kit_.destroy_trx(task.trx);
+    }
+  }
+}
+
+void CLogParallelRecovery::stop_workers()
+{
+  for (auto &queue : queues_) {
+    lock_guard<mutex> lock(queue->lock);
+    queue->closed = true;
+    queue->not_empty.notify_all();
+  }
+
+  for (thread &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+void CLogParallelRecovery::set_error(RC rc)
+{
+  lock_guard<mutex> lock(error_lock_);
+  if (!failed_.load()) {
+    error_ = rc;
+    failed_.store(true);
+  }
+}
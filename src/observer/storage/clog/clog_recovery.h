@@ -0,0 +1,112 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "common/rc.h"
+#include "common/types.h"
+
+class Db;
+class Trx;
+class TrxKit;
+class CLogRecord;
+class CLogRecordIterator;
+
+/**
+ * @brief 并行重做日志
+ * @ingroup CLog
+ * @details 当前线程负责读取日志，按照(表, 页面)把数据日志分发到各个重做线程的队列中，每个线程按照LSN的顺序
+ * 重做自己分区内的日志。修改同一个页面的日志总是由同一个线程处理，所以每个页面上的修改顺序与串行重做相同。
+ * 事务的状态(比如修改过哪些记录)由读取日志的线程维护(Trx::redo_analyze)。提交和回滚日志会分发给事务修改过的
+ * 每个分区，由各个线程处理自己分区内的记录(Trx::redo_partition)。
+ * 最后一个处理完提交或回滚日志的线程销毁这个事务，没有结束的事务留在 TrxKit 中，由调用者回滚。
+ */
+class CLogParallelRecovery
+{
+public:
+  /**
+   * @param thread_num 重做线程的个数。0表示使用CPU核数
+   */
+  CLogParallelRecovery(Db *db, TrxKit &trx_kit, int thread_num);
+  ~CLogParallelRecovery();
+
+  /**
+   * @brief 从迭代器当前的位置开始重做，直到日志结束
+   */
+  RC recover(CLogRecordIterator &iterator);
+
+  int thread_num() const { return thread_num_; }
+
+private:
+  /**
+   * @brief 一个重做任务。提交和回滚日志会放到多个分区中，所以日志对象是共享的
+   */
+  struct RedoTask
+  {
+    std::shared_ptr<CLogRecord>       log_record;
+    Trx                              *trx = nullptr;
+    std::shared_ptr<std::atomic<int>> pending;  ///< 提交和回滚日志还有几个分区没有处理完，为0时销毁事务
+  };
+
+  /**
+   * @brief 每个重做线程一个队列。队列有长度限制，重做跟不上时读取日志的线程会等待
+   */
+  struct RedoQueue
+  {
+    std::mutex              lock;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<RedoTask>    tasks;
+    bool                    closed = false;
+  };
+
+  /**
+   * @brief 读取日志的线程维护的事务信息
+   */
+  struct TrxState
+  {
+    Trx              *trx = nullptr;
+    std::vector<bool> partitions;  ///< 事务修改过哪些分区
+  };
+
+  static constexpr size_t MAX_QUEUE_SIZE = 4096;
+
+  int  partition_of(int32_t table_id, PageNum page_num) const;
+  RC   dispatch(std::shared_ptr<CLogRecord> log_record);
+  void push(int partition, RedoTask task);
+  void redo_worker(int partition);
+  void stop_workers();
+  void set_error(RC rc);
+
+private:
+  Db     *db_ = nullptr;
+  TrxKit &trx_kit_;
+  int     thread_num_ = 1;
+
+  std::vector<std::unique_ptr<RedoQueue>> queues_;
+  std::vector<std::thread>                workers_;
+
+  std::unordered_map<int32_t, TrxState> active_trxes_;  ///< 还没有结束的事务
+
+  std::mutex        error_lock_;
+  std::atomic<bool> failed_{false};
+  RC                error_ = RC::SUCCESS;
+
+  int64_t record_count_ = 0;
+};
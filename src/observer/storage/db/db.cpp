@@ -25,10 +25,16 @@ See the Mulan PSL v2 for more details. */
 #include "storage/table/table.h"
 #include "storage/common/meta_util.h"
 #include "storage/trx/trx.h"
+#include "common/global_context.h"
 #include "storage/clog/clog.h"
+#include "storage/buffer/disk_buffer_pool.h"
 
 Db::~Db()
 {
+  // 已经提交的事务可能还没有把提交号写到记录上，关闭表之前写完
+  if (GCTX.trx_kit_ != nullptr) {
+    GCTX.trx_kit_->resolve_commits();
+  }
   for (auto &iter : opened_tables_) {
     delete iter.second;
   }
@@ -53,7 +59,7 @@ RC Db::init(const char *name, const char *dbpath)
     return RC::NOMEM;
   }
 
-  RC rc = clog_manager_->init(dbpath);
+  RC rc = clog_manager_->init(dbpath, CLogConfig::from_properties(), &BufferPoolManager::instance());
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to init clog manager. dbpath=%s, rc=%s", dbpath, strrc(rc));
     return rc;
@@ -109,6 +115,10 @@ RC Db::drop_table(const char *table_name)
     return RC::SCHEMA_TABLE_NOT_EXIST;
   }
 
+  if (GCTX.trx_kit_ != nullptr) {
+    GCTX.trx_kit_->resolve_commits();
+  }
+
   //释放资源
   auto it = opened_tables_.find(table_name);
   Table* table = it->second; //std::unordered_map<std::string, Table *> opened_tables_;
@@ -190,6 +200,11 @@ void Db::all_tables(std::vector<std::string> &table_names) const
 
 RC Db::sync()
 {
+  // 先把提交号写到记录上，这些修改随着表一起刷盘，检查点不再需要保留对应事务的日志
+  if (GCTX.trx_kit_ != nullptr) {
+    GCTX.trx_kit_->resolve_commits();
+  }
+
   RC rc = RC::SUCCESS;
   for (const auto &table_pair : opened_tables_) {
     Table *table = table_pair.second;
@@ -200,6 +215,13 @@ RC Db::sync()
     }
     LOG_INFO("Successfully sync table db:%s, table:%s.", name_.c_str(), table->name());
   }
+
+  // 所有的表都已经刷盘，做一次检查点，下次启动时就不需要重做之前的日志了
+  rc = clog_manager_->checkpoint();
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to do checkpoint. db=%s, rc=%s", name_.c_str(), strrc(rc));
+    return rc;
+  }
   LOG_INFO("Successfully sync db. db=%s", name_.c_str());
   return rc;
 }
@@ -12,7 +12,10 @@ See the Mulan PSL v2 for more details. */
 // Created by Xie Meiyi
 // Rewritten by Longda & Wangyunlai
 //
+#include <algorithm>
+
 #include "storage/index/bplus_tree.h"
+#include "storage/index/bplus_tree_key_search.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "common/log/log.h"
 #include "sql/parser/parse_defs.h"
@@ -38,6 +41,16 @@ int calc_leaf_page_capacity(int attr_length)
   return capacity;
 }
 
+/**
+ * 前缀压缩格式的节点最多可以容纳的数据项，即所有的属性值都是公共前缀的情况
+ */
+int calc_compressed_page_capacity(int header_size, int attr_length, int value_size)
+{
+  const int key_length = attr_length + sizeof(RID);
+  const int fence_size = IndexNodeFence::HEADER_SIZE + 2 * key_length;
+  return ((int)BP_PAGE_DATA_SIZE - header_size - fence_size) / ((int)sizeof(RID) + value_size);
+}
+
 /////////////////////////////////////////////////////////////////////////////////
 IndexNodeHandler::IndexNodeHandler(const IndexFileHeader &header, Frame *frame)
     : header_(header), page_num_(frame->page_num()), node_((IndexNode *)frame->data())
@@ -52,6 +65,11 @@ void IndexNodeHandler::init_empty(bool leaf)
   node_->is_leaf = leaf;
   node_->key_num = 0;
   node_->parent = BP_INVALID_PAGE_NUM;
+  if (prefix_compressed()) {
+    IndexNodeFence *node_fence = fence();
+    node_fence->prefix_length = 0;
+    node_fence->flags = 0;
+  }
 }
 PageNum IndexNodeHandler::page_num() const
 {
@@ -65,13 +83,12 @@ int IndexNodeHandler::key_size() const
 
 int IndexNodeHandler::value_size() const
 {
-  // return header_.value_size;
-  return sizeof(RID);
+  return is_leaf() ? sizeof(RID) : sizeof(PageNum);
 }
 
 int IndexNodeHandler::item_size() const
 {
-  return key_size() + value_size();
+  return stored_key_size() + value_size();
 }
 
 int IndexNodeHandler::size() const
@@ -81,7 +98,11 @@ int IndexNodeHandler::size() const
 
 int IndexNodeHandler::max_size() const
 {
-  return is_leaf() ? header_.leaf_max_size : header_.internal_max_size;
+  const int max_size = is_leaf() ? header_.leaf_max_size : header_.internal_max_size;
+  if (!prefix_compressed()) {
+    return max_size;
+  }
+  return std::min(max_size, capacity(prefix_length()));
 }
 
 int IndexNodeHandler::min_size() const
@@ -145,6 +166,9 @@ std::string to_string(const IndexNodeHandler &handler)
   ss << "PageNum:" << handler.page_num() << ",is_leaf:" << handler.is_leaf() << ","
      << "key_num:" << handler.size() << ","
      << "parent:" << handler.parent_page_num() << ",";
+  if (handler.prefix_compressed()) {
+    ss << "prefix_length:" << handler.prefix_length() << ",";
+  }
 
   return ss.str();
 }
@@ -166,6 +190,218 @@ bool IndexNodeHandler::validate() const
   return true;
 }
 
+bool IndexNodeHandler::prefix_compressed() const
+{
+  return header_.prefix_compression != 0;
+}
+
+IndexNodeFence *IndexNodeHandler::fence() const
+{
+  const int header_size = is_leaf() ? LeafIndexNode::HEADER_SIZE : InternalIndexNode::HEADER_SIZE;
+  return reinterpret_cast<IndexNodeFence *>(reinterpret_cast<char *>(node_) + header_size);
+}
+
+char *IndexNodeHandler::items() const
+{
+  char *fence_area = reinterpret_cast<char *>(fence());
+  if (!prefix_compressed()) {
+    return fence_area;
+  }
+  return fence_area + IndexNodeFence::HEADER_SIZE + 2 * key_size();
+}
+
+int IndexNodeHandler::prefix_length() const
+{
+  return prefix_compressed() ? fence()->prefix_length : 0;
+}
+
+int IndexNodeHandler::stored_key_size() const
+{
+  return key_size() - prefix_length();
+}
+
+int IndexNodeHandler::capacity(int prefix_length) const
+{
+  const int header_size = static_cast<int>(items() - reinterpret_cast<char *>(node_));
+  return ((int)BP_PAGE_DATA_SIZE - header_size) / (key_size() - prefix_length + value_size());
+}
+
+int IndexNodeHandler::common_prefix_length(const char *low_fence, const char *high_fence) const
+{
+  if (low_fence == nullptr || high_fence == nullptr) {
+    return 0;
+  }
+
+  // 字符串比较遇到'\0'就结束了，所以公共前缀不能包含'\0'
+  int length = 0;
+  while (length < header_.attr_length && low_fence[length] == high_fence[length] && low_fence[length] != '\0') {
+    length++;
+  }
+  return length;
+}
+
+int IndexNodeHandler::max_size_in_range(const char *low_fence, const char *high_fence) const
+{
+  const int max_size = is_leaf() ? header_.leaf_max_size : header_.internal_max_size;
+  if (!prefix_compressed()) {
+    return max_size;
+  }
+  return std::min(max_size, capacity(common_prefix_length(low_fence, high_fence)));
+}
+
+const char *IndexNodeHandler::low_fence() const
+{
+  if (!prefix_compressed() || (fence()->flags & IndexNodeFence::HAS_LOW_FENCE) == 0) {
+    return nullptr;
+  }
+  return fence()->keys;
+}
+
+const char *IndexNodeHandler::high_fence() const
+{
+  if (!prefix_compressed() || (fence()->flags & IndexNodeFence::HAS_HIGH_FENCE) == 0) {
+    return nullptr;
+  }
+  return fence()->keys + key_size();
+}
+
+void IndexNodeHandler::set_fences(const char *low_fence, const char *high_fence)
+{
+  if (!prefix_compressed()) {
+    return;
+  }
+
+  // 参数可能就指向当前节点中的键值，先复制出来
+  const int key_size = this->key_size();
+  std::string fences(2 * key_size, '\0');
+  int32_t flags = 0;
+  if (low_fence != nullptr) {
+    memcpy(fences.data(), low_fence, key_size);
+    flags |= IndexNodeFence::HAS_LOW_FENCE;
+  }
+  if (high_fence != nullptr) {
+    memcpy(fences.data() + key_size, high_fence, key_size);
+    flags |= IndexNodeFence::HAS_HIGH_FENCE;
+  }
+
+  const int old_prefix_length = prefix_length();
+  const int new_prefix_length = common_prefix_length(low_fence != nullptr ? fences.data() : nullptr,
+                                                     high_fence != nullptr ? fences.data() + key_size : nullptr);
+  const int num = size();
+  if (new_prefix_length == old_prefix_length) {
+    // 节点中的键值同时在新旧两个范围内，前缀长度相同时前缀的内容也相同，不需要重新编码
+    IndexNodeFence *node_fence = fence();
+    node_fence->flags = flags;
+    memcpy(node_fence->keys, fences.data(), fences.size());
+    return;
+  }
+
+  ASSERT(num <= capacity(new_prefix_length),
+         "too many items for the new fences. size=%d, capacity=%d", num, capacity(new_prefix_length));
+
+  const int full_item_size = key_size + value_size();
+  std::string full_items(static_cast<size_t>(num) * full_item_size, '\0');
+  for (int i = 0; i < num; i++) {
+    char *full_item = full_items.data() + i * full_item_size;
+    decode_key(__key_at(i), full_item);
+    memcpy(full_item + key_size, __value_at(i), value_size());
+  }
+
+  IndexNodeFence *node_fence = fence();
+  node_fence->prefix_length = new_prefix_length;
+  node_fence->flags = flags;
+  memcpy(node_fence->keys, fences.data(), fences.size());
+
+  for (int i = 0; i < num; i++) {
+    const char *full_item = full_items.data() + i * full_item_size;
+    encode_key(__key_at(i), full_item);
+    memcpy(__value_at(i), full_item + key_size, value_size());
+  }
+}
+
+void IndexNodeHandler::encode_key(char *stored_key, const char *key) const
+{
+  memcpy(stored_key, key + prefix_length(), stored_key_size());
+}
+
+void IndexNodeHandler::decode_key(const char *stored_key, char *key) const
+{
+  const int prefix_length = this->prefix_length();
+  if (prefix_length > 0) {
+    // 有公共前缀时一定有 low fence
+    memcpy(key, fence()->keys, prefix_length);
+  }
+  memcpy(key + prefix_length, stored_key, stored_key_size());
+}
+
+const char *IndexNodeHandler::decoded_key(const char *stored_key, char *buf) const
+{
+  if (prefix_length() == 0) {
+    return stored_key;
+  }
+  decode_key(stored_key, buf);
+  return buf;
+}
+
+char *IndexNodeHandler::__item_at(int index) const
+{
+  return items() + (index * item_size());
+}
+
+char *IndexNodeHandler::__key_at(int index) const
+{
+  return __item_at(index);
+}
+
+char *IndexNodeHandler::__value_at(int index) const
+{
+  return __item_at(index) + stored_key_size();
+}
+
+void IndexNodeHandler::copy_items(int index, const IndexNodeHandler &other, int other_index, int num)
+{
+  const int prefix_length = this->prefix_length();
+  if (prefix_length == other.prefix_length() &&
+      (prefix_length == 0 || memcmp(fence()->keys, other.fence()->keys, prefix_length) == 0)) {
+    memcpy(__item_at(index), other.__item_at(other_index), static_cast<size_t>(num) * item_size());
+    return;
+  }
+
+  std::string key(key_size(), '\0');
+  for (int i = 0; i < num; i++) {
+    other.decode_key(other.__key_at(other_index + i), key.data());
+    encode_key(__key_at(index + i), key.data());
+    memcpy(__value_at(index + i), other.__value_at(other_index + i), value_size());
+  }
+}
+
+int IndexNodeHandler::lookup_compressed(const char *stored_keys, int num, const char *key, bool *found) const
+{
+  // 先比较公共前缀，不在节点的范围内时直接返回
+  const int prefix_length = this->prefix_length();
+  int result = common::compare_string((void *)key, prefix_length, (void *)fence()->keys, prefix_length);
+  if (result != 0) {
+    if (found) {
+      *found = false;
+    }
+    return result < 0 ? 0 : num;
+  }
+
+  const int suffix_length = header_.attr_length - prefix_length;
+  auto comparator = [suffix_length](const char *stored_key, const char *key_suffix) {
+    int result = common::compare_string((void *)stored_key, suffix_length, (void *)key_suffix, suffix_length);
+    if (result != 0) {
+      return result;
+    }
+    return RID::compare((const RID *)(stored_key + suffix_length), (const RID *)(key_suffix + suffix_length));
+  };
+
+  common::BinaryIterator<char> iter_begin(item_size(), const_cast<char *>(stored_keys));
+  common::BinaryIterator<char> iter_end(item_size(), const_cast<char *>(stored_keys) + num * item_size());
+  common::BinaryIterator<char> iter = lower_bound(iter_begin, iter_end, key + prefix_length, comparator, found);
+  return iter - iter_begin;
+}
+
 /////////////////////////////////////////////////////////////////////////////////
 LeafIndexNodeHandler::LeafIndexNodeHandler(const IndexFileHeader &header, Frame *frame)
     : IndexNodeHandler(header, frame), leaf_node_((LeafIndexNode *)frame->data())
@@ -174,6 +410,7 @@ LeafIndexNodeHandler::LeafIndexNodeHandler(const IndexFileHeader &header, Frame
 void LeafIndexNodeHandler::init_empty()
 {
   IndexNodeHandler::init_empty(true);
+  leaf_node_->prev_brother = BP_INVALID_PAGE_NUM;
   leaf_node_->next_brother = BP_INVALID_PAGE_NUM;
 }
 
@@ -187,10 +424,20 @@ PageNum LeafIndexNodeHandler::next_page() const
   return leaf_node_->next_brother;
 }
 
-char *LeafIndexNodeHandler::key_at(int index)
+void LeafIndexNodeHandler::set_prev_page(PageNum page_num)
+{
+  leaf_node_->prev_brother = page_num;
+}
+
+PageNum LeafIndexNodeHandler::prev_page() const
+{
+  return leaf_node_->prev_brother;
+}
+
+const char *LeafIndexNodeHandler::key_at(int index, char *buf) const
 {
   assert(index >= 0 && index < size());
-  return __key_at(index);
+  return decoded_key(__key_at(index), buf);
 }
 
 char *LeafIndexNodeHandler::value_at(int index)
@@ -202,6 +449,15 @@ char *LeafIndexNodeHandler::value_at(int index)
 int LeafIndexNodeHandler::lookup(const KeyComparator &comparator, const char *key, bool *found /* = nullptr */) const
 {
   const int size = this->size();
+  if (prefix_length() > 0) {
+    return lookup_compressed(__key_at(0), size, key, found);
+  }
+
+  const AttrComparator &attr_comparator = comparator.attr_comparator();
+  if (fast_key_search_supported(attr_comparator.attr_type(), attr_comparator.attr_length())) {
+    return fast_key_lower_bound(attr_comparator.attr_type(), __key_at(0), item_size(), size, key, found);
+  }
+
   common::BinaryIterator<char> iter_begin(item_size(), __key_at(0));
   common::BinaryIterator<char> iter_end(item_size(), __key_at(size));
   common::BinaryIterator<char> iter = lower_bound(iter_begin, iter_end, key, comparator, found);
@@ -213,8 +469,8 @@ void LeafIndexNodeHandler::insert(int index, const char *key, const char *value)
   if (index < size()) {
     memmove(__item_at(index + 1), __item_at(index), (static_cast<size_t>(size()) - index) * item_size());
   }
-  memcpy(__item_at(index), key, key_size());
-  memcpy(__item_at(index) + key_size(), value, value_size());
+  encode_key(__key_at(index), key);
+  memcpy(__value_at(index), value, value_size());
   increase_size(1);
 }
 void LeafIndexNodeHandler::remove(int index)
@@ -242,14 +498,14 @@ RC LeafIndexNodeHandler::move_half_to(LeafIndexNodeHandler &other, DiskBufferPoo
   const int size = this->size();
   const int move_index = size / 2;
 
-  memcpy(other.__item_at(0), this->__item_at(move_index), static_cast<size_t>(item_size()) * (size - move_index));
+  other.copy_items(0, *this, move_index, size - move_index);
   other.increase_size(size - move_index);
   this->increase_size(-(size - move_index));
   return RC::SUCCESS;
 }
 RC LeafIndexNodeHandler::move_first_to_end(LeafIndexNodeHandler &other, DiskBufferPool *disk_buffer_pool)
 {
-  other.append(__item_at(0));
+  other.append(*this, 0);
 
   if (size() >= 1) {
     memmove(__item_at(0), __item_at(1), (static_cast<size_t>(size()) - 1) * item_size());
@@ -260,7 +516,7 @@ RC LeafIndexNodeHandler::move_first_to_end(LeafIndexNodeHandler &other, DiskBuff
 
 RC LeafIndexNodeHandler::move_last_to_front(LeafIndexNodeHandler &other, DiskBufferPool *bp)
 {
-  other.preappend(__item_at(size() - 1));
+  other.preappend(*this, size() - 1);
 
   increase_size(-1);
   return RC::SUCCESS;
@@ -270,7 +526,7 @@ RC LeafIndexNodeHandler::move_last_to_front(LeafIndexNodeHandler &other, DiskBuf
  */
 RC LeafIndexNodeHandler::move_to(LeafIndexNodeHandler &other, DiskBufferPool *bp)
 {
-  memcpy(other.__item_at(other.size()), this->__item_at(0), static_cast<size_t>(this->size()) * item_size());
+  other.copy_items(other.size(), *this, 0, this->size());
   other.increase_size(this->size());
   this->increase_size(-this->size());
 
@@ -278,42 +534,31 @@ RC LeafIndexNodeHandler::move_to(LeafIndexNodeHandler &other, DiskBufferPool *bp
   return RC::SUCCESS;
 }
 
-void LeafIndexNodeHandler::append(const char *item)
+void LeafIndexNodeHandler::append(const LeafIndexNodeHandler &other, int index)
 {
-  memcpy(__item_at(size()), item, item_size());
+  copy_items(size(), other, index, 1);
   increase_size(1);
 }
 
-void LeafIndexNodeHandler::preappend(const char *item)
+void LeafIndexNodeHandler::preappend(const LeafIndexNodeHandler &other, int index)
 {
   if (size() > 0) {
     memmove(__item_at(1), __item_at(0), static_cast<size_t>(size()) * item_size());
   }
-  memcpy(__item_at(0), item, item_size());
+  copy_items(0, other, index, 1);
   increase_size(1);
 }
 
-char *LeafIndexNodeHandler::__item_at(int index) const
-{
-  return leaf_node_->array + (index * item_size());
-}
-char *LeafIndexNodeHandler::__key_at(int index) const
-{
-  return __item_at(index);
-}
-char *LeafIndexNodeHandler::__value_at(int index) const
-{
-  return __item_at(index) + key_size();
-}
-
 std::string to_string(const LeafIndexNodeHandler &handler, const KeyPrinter &printer)
 {
   std::stringstream ss;
   ss << to_string((const IndexNodeHandler &)handler)
+     << ",prev page:" << handler.prev_page()
      << ",next page:" << handler.next_page();
-  ss << ",values=[" << printer(handler.__key_at(0));
+  std::string key_buf(handler.key_size(), '\0');
+  ss << ",values=[" << printer(handler.key_at(0, key_buf.data()));
   for (int i = 1; i < handler.size(); i++) {
-    ss << "," << printer(handler.__key_at(i));
+    ss << "," << printer(handler.key_at(i, key_buf.data()));
   }
   ss << "]";
   return ss.str();
@@ -326,9 +571,11 @@ bool LeafIndexNodeHandler::validate(const KeyComparator &comparator, DiskBufferP
     return false;
   }
 
+  std::string other_buf(key_size(), '\0');
+  std::string key_buf(key_size(), '\0');
   const int node_size = size();
   for (int i = 1; i < node_size; i++) {
-    if (comparator(__key_at(i - 1), __key_at(i)) >= 0) {
+    if (comparator(key_at(i - 1, other_buf.data()), key_at(i, key_buf.data())) >= 0) {
       LOG_WARN("page number = %d, invalid key order. id1=%d,id2=%d, this=%s",
                page_num(), i - 1, i, to_string(*this).c_str());
       return false;
@@ -357,7 +604,7 @@ bool LeafIndexNodeHandler::validate(const KeyComparator &comparator, DiskBufferP
   }
 
   if (0 != index_in_parent) {
-    int cmp_result = comparator(__key_at(0), parent_node.key_at(index_in_parent));
+    int cmp_result = comparator(key_at(0, key_buf.data()), parent_node.key_at(index_in_parent, other_buf.data()));
     if (cmp_result < 0) {
       LOG_WARN("invalid leaf node. first item should be greate than or equal to parent item. "
                "this page num=%d, parent page num=%d, index in parent=%d",
@@ -368,7 +615,8 @@ bool LeafIndexNodeHandler::validate(const KeyComparator &comparator, DiskBufferP
   }
 
   if (index_in_parent < parent_node.size() - 1) {
-    int cmp_result = comparator(__key_at(size() - 1), parent_node.key_at(index_in_parent + 1));
+    int cmp_result =
+        comparator(key_at(size() - 1, key_buf.data()), parent_node.key_at(index_in_parent + 1, other_buf.data()));
     if (cmp_result >= 0) {
       LOG_WARN("invalid leaf node. last item should be less than the item at the first after item in parent."
                "this page num=%d, parent page num=%d, parent item to compare=%d",
@@ -383,19 +631,20 @@ bool LeafIndexNodeHandler::validate(const KeyComparator &comparator, DiskBufferP
 
 /////////////////////////////////////////////////////////////////////////////////
 InternalIndexNodeHandler::InternalIndexNodeHandler(const IndexFileHeader &header, Frame *frame)
-    : IndexNodeHandler(header, frame), internal_node_((InternalIndexNode *)frame->data())
+    : IndexNodeHandler(header, frame)
 {}
 
 std::string to_string(const InternalIndexNodeHandler &node, const KeyPrinter &printer)
 {
   std::stringstream ss;
   ss << to_string((const IndexNodeHandler &)node);
+  std::string key_buf(node.key_size(), '\0');
   ss << ",children:["
-     << "{key:" << printer(node.__key_at(0)) << ","
+     << "{key:" << printer(node.key_at(0, key_buf.data())) << ","
      << "value:" << *(PageNum *)node.__value_at(0) << "}";
 
   for (int i = 1; i < node.size(); i++) {
-    ss << ",{key:" << printer(node.__key_at(i)) << ",value:" << *(PageNum *)node.__value_at(i) << "}";
+    ss << ",{key:" << printer(node.key_at(i, key_buf.data())) << ",value:" << *(PageNum *)node.__value_at(i) << "}";
   }
   ss << "]";
   return ss.str();
@@ -407,9 +656,9 @@ void InternalIndexNodeHandler::init_empty()
 }
 void InternalIndexNodeHandler::create_new_root(PageNum first_page_num, const char *key, PageNum page_num)
 {
-  memset(__key_at(0), 0, key_size());
+  memset(__key_at(0), 0, stored_key_size());
   memcpy(__value_at(0), &first_page_num, value_size());
-  memcpy(__item_at(1), key, key_size());
+  encode_key(__key_at(1), key);
   memcpy(__value_at(1), &page_num, value_size());
   increase_size(2);
 }
@@ -426,7 +675,7 @@ void InternalIndexNodeHandler::insert(const char *key, PageNum page_num, const K
   if (insert_position < size()) {
     memmove(__item_at(insert_position + 1), __item_at(insert_position), (static_cast<size_t>(size()) - insert_position) * item_size());
   }
-  memcpy(__item_at(insert_position), key, key_size());
+  encode_key(__key_at(insert_position), key);
   memcpy(__value_at(insert_position), &page_num, value_size());
   increase_size(1);
 }
@@ -435,7 +684,7 @@ RC InternalIndexNodeHandler::move_half_to(InternalIndexNodeHandler &other, DiskB
 {
   const int size = this->size();
   const int move_index = size / 2;
-  RC rc = other.copy_from(this->__item_at(move_index), size - move_index, bp);
+  RC rc = other.copy_from(*this, move_index, size - move_index, bp);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to copy item to new node. rc=%d:%s", rc, strrc(rc));
     return rc;
@@ -464,30 +713,41 @@ int InternalIndexNodeHandler::lookup(const KeyComparator &comparator, const char
     return 0;
   }
 
-  common::BinaryIterator<char> iter_begin(item_size(), __key_at(1));
-  common::BinaryIterator<char> iter_end(item_size(), __key_at(size));
-  common::BinaryIterator<char> iter = lower_bound(iter_begin, iter_end, key, comparator, found);
-  int ret = static_cast<int>(iter - iter_begin) + 1;
+  // 查找的是第一个不小于 key 的位置，只有与 key 相等时 key 才属于这个子节点
+  int ret = 0;
+  bool equal = false;
+  const AttrComparator &attr_comparator = comparator.attr_comparator();
+  if (prefix_length() > 0) {
+    ret = lookup_compressed(__key_at(1), size - 1, key, &equal) + 1;
+  } else if (fast_key_search_supported(attr_comparator.attr_type(), attr_comparator.attr_length())) {
+    // 第0个键值是无效的，从第1个开始查找
+    ret = fast_key_lower_bound(attr_comparator.attr_type(), __key_at(1), item_size(), size - 1, key, &equal) + 1;
+  } else {
+    common::BinaryIterator<char> iter_begin(item_size(), __key_at(1));
+    common::BinaryIterator<char> iter_end(item_size(), __key_at(size));
+    common::BinaryIterator<char> iter = lower_bound(iter_begin, iter_end, key, comparator, &equal);
+    ret = static_cast<int>(iter - iter_begin) + 1;
+  }
+  if (found) {
+    *found = equal;
+  }
   if (insert_position) {
     *insert_position = ret;
   }
 
-  if (ret >= size || comparator(key, __key_at(ret)) < 0) {
-    return ret - 1;
-  }
-  return ret;
+  return equal ? ret : ret - 1;
 }
 
-char *InternalIndexNodeHandler::key_at(int index)
+const char *InternalIndexNodeHandler::key_at(int index, char *buf) const
 {
   assert(index >= 0 && index < size());
-  return __key_at(index);
+  return decoded_key(__key_at(index), buf);
 }
 
 void InternalIndexNodeHandler::set_key_at(int index, const char *key)
 {
   assert(index >= 0 && index < size());
-  memcpy(__key_at(index), key, key_size());
+  encode_key(__key_at(index), key);
 }
 
 PageNum InternalIndexNodeHandler::value_at(int index)
@@ -517,7 +777,7 @@ void InternalIndexNodeHandler::remove(int index)
 
 RC InternalIndexNodeHandler::move_to(InternalIndexNodeHandler &other, DiskBufferPool *disk_buffer_pool)
 {
-  RC rc = other.copy_from(__item_at(0), size(), disk_buffer_pool);
+  RC rc = other.copy_from(*this, 0, size(), disk_buffer_pool);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to copy items to other node. rc=%d:%s", rc, strrc(rc));
     return rc;
@@ -529,7 +789,7 @@ RC InternalIndexNodeHandler::move_to(InternalIndexNodeHandler &other, DiskBuffer
 
 RC InternalIndexNodeHandler::move_first_to_end(InternalIndexNodeHandler &other, DiskBufferPool *disk_buffer_pool)
 {
-  RC rc = other.append(__item_at(0), disk_buffer_pool);
+  RC rc = other.append(*this, 0, disk_buffer_pool);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to append item to others.");
     return rc;
@@ -544,7 +804,7 @@ RC InternalIndexNodeHandler::move_first_to_end(InternalIndexNodeHandler &other,
 
 RC InternalIndexNodeHandler::move_last_to_front(InternalIndexNodeHandler &other, DiskBufferPool *bp)
 {
-  RC rc = other.preappend(__item_at(size() - 1), bp);
+  RC rc = other.preappend(*this, size() - 1, bp);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to preappend to others");
     return rc;
@@ -556,15 +816,16 @@ RC InternalIndexNodeHandler::move_last_to_front(InternalIndexNodeHandler &other,
 /**
  * copy items from other node to self's right
  */
-RC InternalIndexNodeHandler::copy_from(const char *items, int num, DiskBufferPool *disk_buffer_pool)
+RC InternalIndexNodeHandler::copy_from(
+    const InternalIndexNodeHandler &other, int index, int num, DiskBufferPool *disk_buffer_pool)
 {
-  memcpy(__item_at(this->size()), items, static_cast<size_t>(num) * item_size());
+  copy_items(this->size(), other, index, num);
 
   RC rc = RC::SUCCESS;
   PageNum this_page_num = this->page_num();
   Frame *frame = nullptr;
   for (int i = 0; i < num; i++) {
-    const PageNum page_num = *(const PageNum *)((items + i * item_size()) + key_size());
+    const PageNum page_num = *(const PageNum *)other.__value_at(index + i);
     rc = disk_buffer_pool->get_this_page(page_num, &frame);
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to set child's page num. child page num:%d, this page num=%d, rc=%d:%s",
@@ -580,14 +841,14 @@ RC InternalIndexNodeHandler::copy_from(const char *items, int num, DiskBufferPoo
   return rc;
 }
 
-RC InternalIndexNodeHandler::append(const char *item, DiskBufferPool *bp)
+RC InternalIndexNodeHandler::append(const InternalIndexNodeHandler &other, int index, DiskBufferPool *bp)
 {
-  return this->copy_from(item, 1, bp);
+  return this->copy_from(other, index, 1, bp);
 }
 
-RC InternalIndexNodeHandler::preappend(const char *item, DiskBufferPool *bp)
+RC InternalIndexNodeHandler::preappend(const InternalIndexNodeHandler &other, int index, DiskBufferPool *bp)
 {
-  PageNum child_page_num = *(PageNum *)(item + key_size());
+  PageNum child_page_num = *(PageNum *)other.__value_at(index);
   Frame *frame = nullptr;
   RC rc = bp->get_this_page(child_page_num, &frame);
   if (rc != RC::SUCCESS) {
@@ -605,36 +866,11 @@ RC InternalIndexNodeHandler::preappend(const char *item, DiskBufferPool *bp)
     memmove(__item_at(1), __item_at(0), static_cast<size_t>(this->size()) * item_size());
   }
 
-  memcpy(__item_at(0), item, item_size());
+  copy_items(0, other, index, 1);
   increase_size(1);
   return RC::SUCCESS;
 }
 
-char *InternalIndexNodeHandler::__item_at(int index) const
-{
-  return internal_node_->array + (index * item_size());
-}
-
-char *InternalIndexNodeHandler::__key_at(int index) const
-{
-  return __item_at(index);
-}
-
-char *InternalIndexNodeHandler::__value_at(int index) const
-{
-  return __item_at(index) + key_size();
-}
-
-int InternalIndexNodeHandler::value_size() const
-{
-  return sizeof(PageNum);
-}
-
-int InternalIndexNodeHandler::item_size() const
-{
-  return key_size() + this->value_size();
-}
-
 bool InternalIndexNodeHandler::validate(const KeyComparator &comparator, DiskBufferPool *bp) const
 {
   bool result = IndexNodeHandler::validate();
@@ -642,9 +878,11 @@ bool InternalIndexNodeHandler::validate(const KeyComparator &comparator, DiskBuf
     return false;
   }
 
+  std::string other_buf(key_size(), '\0');
+  std::string key_buf(key_size(), '\0');
   const int node_size = size();
   for (int i = 2; i < node_size; i++) {
-    if (comparator(__key_at(i - 1), __key_at(i)) >= 0) {
+    if (comparator(key_at(i - 1, other_buf.data()), key_at(i, key_buf.data())) >= 0) {
       LOG_WARN("page number = %d, invalid key order. id1=%d,id2=%d, this=%s",
           page_num(), i - 1, i, to_string(*this).c_str());
       return false;
@@ -699,7 +937,7 @@ bool InternalIndexNodeHandler::validate(const KeyComparator &comparator, DiskBuf
   }
 
   if (0 != index_in_parent) {
-    int cmp_result = comparator(__key_at(1), parent_node.key_at(index_in_parent));
+    int cmp_result = comparator(key_at(1, key_buf.data()), parent_node.key_at(index_in_parent, other_buf.data()));
     if (cmp_result < 0) {
       LOG_WARN("invalid internal node. the second item should be greate than or equal to parent item. "
                "this page num=%d, parent page num=%d, index in parent=%d",
@@ -710,7 +948,8 @@ bool InternalIndexNodeHandler::validate(const KeyComparator &comparator, DiskBuf
   }
 
   if (index_in_parent < parent_node.size() - 1) {
-    int cmp_result = comparator(__key_at(size() - 1), parent_node.key_at(index_in_parent + 1));
+    int cmp_result =
+        comparator(key_at(size() - 1, key_buf.data()), parent_node.key_at(index_in_parent + 1, other_buf.data()));
     if (cmp_result >= 0) {
       LOG_WARN("invalid internal node. last item should be less than the item at the first after item in parent."
                "this page num=%d, parent page num=%d, parent item to compare=%d",
@@ -746,8 +985,13 @@ RC BplusTreeHandler::sync()
 }
 
 RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_length, const bool &is_unique,
-    int internal_max_size /* = -1*/, int leaf_max_size /* = -1 */)
+    int internal_max_size /* = -1*/, int leaf_max_size /* = -1 */, bool prefix_compression /* = false */)
 {
+  if (prefix_compression && attr_type != CHARS) {
+    LOG_WARN("prefix compression is only supported for chars. attr type=%d", attr_type);
+    return RC::INVALID_ARGUMENT;
+  }
+
   BufferPoolManager &bpm = BufferPoolManager::instance();
   RC rc = bpm.create_file(file_name);
   if (rc != RC::SUCCESS) {
@@ -779,11 +1023,16 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_
     return RC::INTERNAL;
   }
 
+  // 前缀压缩格式的节点，实际的容量由节点的公共前缀决定，参考 IndexNodeHandler::max_size
   if (internal_max_size < 0) {
-    internal_max_size = calc_internal_page_capacity(attr_length);
+    internal_max_size = prefix_compression ? calc_compressed_page_capacity(InternalIndexNode::HEADER_SIZE,
+                                                                           attr_length, sizeof(PageNum))
+                                           : calc_internal_page_capacity(attr_length);
   }
   if (leaf_max_size < 0) {
-    leaf_max_size = calc_leaf_page_capacity(attr_length);
+    leaf_max_size = prefix_compression
+                        ? calc_compressed_page_capacity(LeafIndexNode::HEADER_SIZE, attr_length, sizeof(RID))
+                        : calc_leaf_page_capacity(attr_length);
   }
 
   char *pdata = header_frame->data();
@@ -794,6 +1043,9 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_
   file_header->internal_max_size = internal_max_size;
   file_header->leaf_max_size = leaf_max_size;
   file_header->root_page = BP_INVALID_PAGE_NUM;
+  file_header->prefix_compression = prefix_compression ? 1 : 0;
+  file_header->is_unique = is_unique ? 1 : 0;
+  file_header->format_version = IndexFileHeader::FORMAT_VERSION;
 
   header_frame->mark_dirty();
 
@@ -845,6 +1097,14 @@ RC BplusTreeHandler::open(const char *file_name)
 
   char *pdata = frame->data();
   memcpy(&file_header_, pdata, sizeof(IndexFileHeader));
+  if (file_header_.format_version != IndexFileHeader::FORMAT_VERSION) {
+    // 旧格式的节点布局与当前不同，继续使用会读错数据，只能删除索引后重新创建
+    LOG_WARN("index file format version mismatch. file name=%s, version=%d, expect=%d",
+             file_name, file_header_.format_version, IndexFileHeader::FORMAT_VERSION);
+    disk_buffer_pool->unpin_page(frame);
+    bpm.close_file(file_name);
+    return RC::FILE_VERSION_MISMATCH;
+  }
   header_dirty_ = false;
   disk_buffer_pool_ = disk_buffer_pool;
 
@@ -860,6 +1120,7 @@ RC BplusTreeHandler::open(const char *file_name)
 
   key_comparator_.init(file_header_.attr_type, file_header_.attr_length);
   key_printer_.init(file_header_.attr_type, file_header_.attr_length);
+  is_unique_ = file_header_.is_unique != 0;
   LOG_INFO("Successfully open index %s", file_name);
   return RC::SUCCESS;
 }
@@ -1023,9 +1284,16 @@ bool BplusTreeHandler::validate_leaf_link(LatchMemo &latch_memo)
 
   LeafIndexNodeHandler leaf_node(file_header_, frame);
   PageNum next_page_num = leaf_node.next_page();
+  PageNum prev_page_num = frame->page_num();
+  if (leaf_node.prev_page() != BP_INVALID_PAGE_NUM) {
+    LOG_WARN("invalid page. the left most page has a prev page. page num=%d, prev page=%d",
+             prev_page_num, leaf_node.prev_page());
+    return false;
+  }
 
   MemPoolItem::unique_ptr prev_key = mem_pool_item_->alloc_unique_ptr();
-  memcpy(prev_key.get(), leaf_node.key_at(leaf_node.size() - 1), file_header_.key_length);
+  std::string key_buf(file_header_.key_length, '\0');
+  memcpy(prev_key.get(), leaf_node.key_at(leaf_node.size() - 1, key_buf.data()), file_header_.key_length);
 
   bool result = true;
   while (result && next_page_num != BP_INVALID_PAGE_NUM) {
@@ -1036,13 +1304,18 @@ bool BplusTreeHandler::validate_leaf_link(LatchMemo &latch_memo)
     }
 
     LeafIndexNodeHandler leaf_node(file_header_, frame);
-    if (key_comparator_((char *)prev_key.get(), leaf_node.key_at(0)) >= 0) {
+    if (key_comparator_((char *)prev_key.get(), leaf_node.key_at(0, key_buf.data())) >= 0) {
       LOG_WARN("invalid page. current first key is not bigger than last");
       result = false;
     }
+    if (leaf_node.prev_page() != prev_page_num) {
+      LOG_WARN("invalid page. prev page is %d but should be %d", leaf_node.prev_page(), prev_page_num);
+      result = false;
+    }
 
+    prev_page_num = next_page_num;
     next_page_num = leaf_node.next_page();
-    memcpy(prev_key.get(), leaf_node.key_at(leaf_node.size() - 1), file_header_.key_length);
+    memcpy(prev_key.get(), leaf_node.key_at(leaf_node.size() - 1, key_buf.data()), file_header_.key_length);
   }
 
   // can do more things
@@ -1092,6 +1365,14 @@ RC BplusTreeHandler::left_most_page(LatchMemo &latch_memo, Frame *&frame)
   return find_leaf_internal(latch_memo, BplusTreeOperationType::READ, child_page_getter, frame);
 }
 
+RC BplusTreeHandler::right_most_page(LatchMemo &latch_memo, Frame *&frame)
+{
+  auto child_page_getter = [](InternalIndexNodeHandler &internal_node) {
+    return internal_node.value_at(internal_node.size() - 1);
+  };
+  return find_leaf_internal(latch_memo, BplusTreeOperationType::READ, child_page_getter, frame);
+}
+
 RC BplusTreeHandler::find_leaf_internal(
     LatchMemo &latch_memo, BplusTreeOperationType op, 
     const std::function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, 
@@ -1178,17 +1459,53 @@ RC BplusTreeHandler::insert_entry_into_leaf_node(LatchMemo &latch_memo, Frame *f
   }
 
   LeafIndexNodeHandler new_index_node(file_header_, new_frame);
+  rc = link_right_leaf(latch_memo, leaf_node.next_page(), new_frame->page_num());
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
   new_index_node.set_next_page(leaf_node.next_page());
+  new_index_node.set_prev_page(frame->page_num());
   new_index_node.set_parent_page_num(leaf_node.parent_page_num());
   leaf_node.set_next_page(new_frame->page_num());
 
-  if (insert_position < leaf_node.size()) {
+  // 插入的位置正好在两个节点之间时，它会成为右边节点的第一个键值
+  const int left_size = leaf_node.size();
+  std::string left_buf(file_header_.key_length, '\0');
+  std::string right_buf(file_header_.key_length, '\0');
+  std::string separator =
+      make_separator(leaf_node.key_at(left_size - 1, left_buf.data()),
+                     insert_position == left_size ? key : new_index_node.key_at(0, right_buf.data()));
+  leaf_node.set_fences(leaf_node.low_fence(), separator.data());
+  new_index_node.set_fences(separator.data(), new_index_node.high_fence());
+
+  if (insert_position < left_size) {
     leaf_node.insert(insert_position, key, (const char *)rid);
   } else {
-    new_index_node.insert(insert_position - leaf_node.size(), key, (const char *)rid);
+    new_index_node.insert(insert_position - left_size, key, (const char *)rid);
   }
 
-  return insert_entry_into_parent(latch_memo, frame, new_frame, new_index_node.key_at(0));
+  return insert_entry_into_parent(latch_memo, frame, new_frame, separator.data());
+}
+
+RC BplusTreeHandler::link_right_leaf(LatchMemo &latch_memo, PageNum right_page_num, PageNum prev_page_num)
+{
+  if (right_page_num == BP_INVALID_PAGE_NUM) {
+    return RC::SUCCESS;
+  }
+
+  // 按照从左到右的顺序加锁，与正序扫描的顺序一致
+  Frame *right_frame = nullptr;
+  RC rc = latch_memo.get_page(right_page_num, right_frame);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to fetch right leaf page. page num=%d, rc=%s", right_page_num, strrc(rc));
+    return rc;
+  }
+  latch_memo.xlatch(right_frame);
+
+  LeafIndexNodeHandler right_node(file_header_, right_frame);
+  right_node.set_prev_page(prev_page_num);
+  right_frame->mark_dirty();
+  return RC::SUCCESS;
 }
 
 RC BplusTreeHandler::insert_entry_into_parent(LatchMemo &latch_memo, Frame *frame, Frame *new_frame, const char *key)
@@ -1266,7 +1583,11 @@ RC BplusTreeHandler::insert_entry_into_parent(LatchMemo &latch_memo, Frame *fram
       } else {
         // insert into left or right ? decide by key compare result
         InternalIndexNodeHandler new_node(file_header_, new_parent_frame);
-        if (key_comparator_(key, new_node.key_at(0)) > 0) {
+        std::string separator(file_header_.key_length, '\0');
+        memcpy(separator.data(), new_node.key_at(0, separator.data()), separator.size());
+        parent_node.set_fences(parent_node.low_fence(), separator.data());
+        new_node.set_fences(separator.data(), new_node.high_fence());
+        if (key_comparator_(key, separator.data()) > 0) {
           new_node.insert(key, new_frame->page_num(), key_comparator_);
           new_node_handler.set_parent_page_num(new_node.page_num());
         } else {
@@ -1280,7 +1601,7 @@ RC BplusTreeHandler::insert_entry_into_parent(LatchMemo &latch_memo, Frame *fram
         // 虽然这里是递归调用，但是通常B+ Tree 的层高比较低（3层已经可以容纳很多数据），所以没有栈溢出风险。
         // Q: 在查找叶子节点时，我们都会尝试将没必要的锁提前释放掉，在这里插入数据时，是在向上遍历节点，
         //    理论上来说，我们可以释放更低层级节点的锁，但是并没有这么做，为什么？
-        rc = insert_entry_into_parent(latch_memo, parent_frame, new_parent_frame, new_node.key_at(0));
+        rc = insert_entry_into_parent(latch_memo, parent_frame, new_parent_frame, separator.data());
       }
     }
   }
@@ -1307,6 +1628,8 @@ RC BplusTreeHandler::split(LatchMemo &latch_memo, Frame *frame, Frame *&new_fram
   IndexNodeHandlerType new_node(file_header_, new_frame);
   new_node.init_empty();
   new_node.set_parent_page_num(old_node.parent_page_num());
+  // 先使用与原节点相同的键值范围，由调用者在确定分隔键值之后再调整
+  new_node.set_fences(old_node.low_fence(), old_node.high_fence());
 
   old_node.move_half_to(new_node, disk_buffer_pool_); // TODO remove disk buffer pool
 
@@ -1361,6 +1684,30 @@ MemPoolItem::unique_ptr BplusTreeHandler::make_key(const char *user_key, const R
   return key;
 }
 
+std::string BplusTreeHandler::make_separator(const char *left_key, const char *right_key) const
+{
+  std::string separator(right_key, file_header_.key_length);
+  if (file_header_.prefix_compression == 0) {
+    return separator;
+  }
+
+  // 找到第一个不同的字符，与 compare_string 一样，遇到'\0'就结束
+  const int attr_length = file_header_.attr_length;
+  int diff_index = 0;
+  while (diff_index < attr_length && left_key[diff_index] == right_key[diff_index] &&
+         left_key[diff_index] != '\0') {
+    diff_index++;
+  }
+  if (diff_index >= attr_length || left_key[diff_index] == right_key[diff_index]) {
+    // 属性值相同，只能依靠RID区分
+    return separator;
+  }
+
+  memset(separator.data() + diff_index + 1, 0, attr_length - diff_index - 1);
+  memcpy(separator.data() + attr_length, RID::min(), sizeof(RID));
+  return separator;
+}
+
 RC BplusTreeHandler::insert_entry(const char *user_key, const RID *rid)
 {
   if (user_key == nullptr || rid == nullptr) {
@@ -1378,7 +1725,7 @@ RC BplusTreeHandler::insert_entry(const char *user_key, const RID *rid)
     } else {
       if (rids.size() > 0) {
         LOG_WARN("Already inserted the key.");
-        return RC::INTERNAL;
+        return RC::RECORD_DUPLICATE_KEY;
       }
     }
   }
@@ -1443,6 +1790,158 @@ RC BplusTreeHandler::get_entry(const char *user_key, int key_len, std::list<RID>
   return rc;
 }
 
+RC BplusTreeHandler::multi_get_entry(const std::vector<std::string> &user_keys, std::vector<RID> &rids)
+{
+  const int attr_length = file_header_.attr_length;
+  std::vector<std::string> attrs;
+  attrs.reserve(user_keys.size());
+  for (const std::string &user_key : user_keys) {
+    std::string attr(attr_length, '\0');
+    if (file_header_.attr_type == CHARS) {
+      // 与 BplusTreeScanner::fix_user_key 一致，超出属性长度的部分不是'\0'时，不会有相等的值
+      if (static_cast<int>(user_key.size()) > attr_length && user_key[attr_length] != 0) {
+        continue;
+      }
+      memcpy(attr.data(), user_key.data(), std::min(static_cast<int>(user_key.size()), attr_length));
+    } else {
+      if (static_cast<int>(user_key.size()) < attr_length) {
+        LOG_WARN("invalid key length. key length=%d, attr length=%d", static_cast<int>(user_key.size()), attr_length);
+        return RC::INVALID_ARGUMENT;
+      }
+      memcpy(attr.data(), user_key.data(), attr_length);
+    }
+    attrs.push_back(std::move(attr));
+  }
+
+  const AttrComparator &attr_comparator = key_comparator_.attr_comparator();
+  std::sort(attrs.begin(), attrs.end(), [&attr_comparator](const std::string &a, const std::string &b) {
+    return attr_comparator(a.data(), b.data()) < 0;
+  });
+  auto last = std::unique(attrs.begin(), attrs.end(), [&attr_comparator](const std::string &a, const std::string &b) {
+    return attr_comparator(a.data(), b.data()) == 0;
+  });
+  attrs.erase(last, attrs.end());
+
+  const size_t first_rid = rids.size();
+  LatchMemo latch_memo(disk_buffer_pool_);
+  Frame *frame = nullptr;
+  for (size_t i = 0; i < attrs.size();) {
+    const size_t rid_num = rids.size();
+    RC rc = probe_entry(latch_memo, attrs[i].data(), frame, rids);
+    if (rc == RC::LOCKED_NEED_WAIT) {
+      // 丢掉这个键值已经找到的数据，释放所有的锁，从根节点重新查找
+      rids.resize(rid_num);
+      latch_memo.release();
+      frame = nullptr;
+      continue;
+    }
+    if (rc == RC::EMPTY) {
+      break;
+    }
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to probe key. rc=%s", strrc(rc));
+      return rc;
+    }
+    i++;
+  }
+  latch_memo.release();
+
+  std::sort(rids.begin() + first_rid, rids.end(), [](const RID &a, const RID &b) {
+    return RID::compare(&a, &b) < 0;
+  });
+  return RC::SUCCESS;
+}
+
+RC BplusTreeHandler::probe_entry(LatchMemo &latch_memo, const char *attr, Frame *&frame, std::vector<RID> &rids)
+{
+  RC rc = RC::SUCCESS;
+  MemPoolItem::unique_ptr key = make_key(attr, *RID::min());
+  const char *pkey = static_cast<const char *>(key.get());
+
+  // 键值是排好序的，第一个不小于当前键值的数据在当前节点或者下一个节点中时，就不需要从根节点查找
+  int index = -1;
+  if (frame != nullptr) {
+    LeafIndexNodeHandler leaf_node(file_header_, frame);
+    index = leaf_node.lookup(key_comparator_, pkey);
+    if (index >= leaf_node.size()) {
+      const PageNum next_page_num = leaf_node.next_page();
+      if (next_page_num == BP_INVALID_PAGE_NUM) {
+        return RC::SUCCESS;
+      }
+
+      rc = switch_leaf(latch_memo, next_page_num, frame);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+
+      LeafIndexNodeHandler next_node(file_header_, frame);
+      index = next_node.lookup(key_comparator_, pkey);
+      if (index >= next_node.size()) {
+        index = -1;
+      }
+    }
+  }
+
+  if (index < 0) {
+    latch_memo.release();
+    rc = find_leaf(latch_memo, BplusTreeOperationType::READ, pkey, frame);
+    if (rc != RC::SUCCESS) {
+      frame = nullptr;
+      return rc;
+    }
+
+    LeafIndexNodeHandler leaf_node(file_header_, frame);
+    index = leaf_node.lookup(key_comparator_, pkey);
+  }
+
+  const AttrComparator &attr_comparator = key_comparator_.attr_comparator();
+  std::string key_buf(file_header_.key_length, '\0');
+  while (true) {
+    LeafIndexNodeHandler leaf_node(file_header_, frame);
+    for (; index < leaf_node.size(); index++) {
+      if (attr_comparator(leaf_node.key_at(index, key_buf.data()), attr) != 0) {
+        return RC::SUCCESS;
+      }
+
+      RID rid;
+      memcpy(&rid, leaf_node.value_at(index), sizeof(rid));
+      rids.push_back(rid);
+    }
+
+    const PageNum next_page_num = leaf_node.next_page();
+    if (next_page_num == BP_INVALID_PAGE_NUM) {
+      return RC::SUCCESS;
+    }
+
+    rc = switch_leaf(latch_memo, next_page_num, frame);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    index = 0;
+  }
+  return rc;
+}
+
+RC BplusTreeHandler::switch_leaf(LatchMemo &latch_memo, PageNum page_num, Frame *&frame)
+{
+  const int memo_point = latch_memo.memo_point();
+  Frame *next_frame = nullptr;
+  RC rc = latch_memo.get_page(page_num, next_frame);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to fetch leaf page. page num=%d, rc=%s", page_num, strrc(rc));
+    return rc;
+  }
+
+  // 与扫描器一样，向右移动时只尝试加锁，避免与删除时合并节点的加锁顺序冲突
+  if (!latch_memo.try_slatch(next_frame)) {
+    return RC::LOCKED_NEED_WAIT;
+  }
+
+  latch_memo.release_to(memo_point);
+  frame = next_frame;
+  return RC::SUCCESS;
+}
+
 RC BplusTreeHandler::adjust_root(LatchMemo &latch_memo, Frame *root_frame)
 {
   IndexNodeHandler root_node(file_header_, root_frame);
@@ -1509,7 +2008,10 @@ RC BplusTreeHandler::coalesce_or_redistribute(LatchMemo &latch_memo, Frame *fram
   }
 
   InternalIndexNodeHandler parent_index_node(file_header_, parent_frame);
-  int index = parent_index_node.lookup(key_comparator_, index_node.key_at(index_node.size() - 1));
+  std::string key_buf(file_header_.key_length, '\0');
+  int index = index_node.size() > 0
+                  ? parent_index_node.lookup(key_comparator_, index_node.key_at(index_node.size() - 1, key_buf.data()))
+                  : parent_index_node.value_index(frame->page_num());
   ASSERT(parent_index_node.value_at(index) == frame->page_num(),
          "lookup return an invalid value. index=%d, this page num=%d, but got %d",
          index, frame->page_num(), parent_index_node.value_at(index));
@@ -1532,7 +2034,11 @@ RC BplusTreeHandler::coalesce_or_redistribute(LatchMemo &latch_memo, Frame *fram
   latch_memo.xlatch(neighbor_frame);
 
   IndexNodeHandlerType neighbor_node(file_header_, neighbor_frame);
-  if (index_node.size() + neighbor_node.size() > index_node.max_size()) {
+  // 前缀压缩格式下，合并后的节点范围变大，公共前缀可能变短，能容纳的数据项也会变少
+  IndexNodeHandlerType &left_node  = (index == 0) ? index_node : neighbor_node;
+  IndexNodeHandlerType &right_node = (index == 0) ? neighbor_node : index_node;
+  const int merged_max_size = left_node.max_size_in_range(left_node.low_fence(), right_node.high_fence());
+  if (index_node.size() + neighbor_node.size() > merged_max_size) {
     rc = redistribute<IndexNodeHandlerType>(neighbor_frame, frame, parent_frame, index);
   } else {
     rc = coalesce<IndexNodeHandlerType>(latch_memo, neighbor_frame, frame, parent_frame, index);
@@ -1562,6 +2068,7 @@ RC BplusTreeHandler::coalesce(LatchMemo &latch_memo, Frame *neighbor_frame, Fram
   IndexNodeHandlerType left_node(file_header_, left_frame);
   IndexNodeHandlerType right_node(file_header_, right_frame);
 
+  left_node.set_fences(left_node.low_fence(), right_node.high_fence());
   parent_node.remove(index);
   // parent_node.validate(key_comparator_, disk_buffer_pool_, file_id_);
   RC rc = right_node.move_to(left_node, disk_buffer_pool_);
@@ -1574,6 +2081,10 @@ RC BplusTreeHandler::coalesce(LatchMemo &latch_memo, Frame *neighbor_frame, Fram
   if (left_node.is_leaf()) {
     LeafIndexNodeHandler left_leaf_node(file_header_, left_frame);
     LeafIndexNodeHandler right_leaf_node(file_header_, right_frame);
+    rc = link_right_leaf(latch_memo, right_leaf_node.next_page(), left_frame->page_num());
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
     left_leaf_node.set_next_page(right_leaf_node.next_page());
   }
 
@@ -1590,19 +2101,38 @@ RC BplusTreeHandler::redistribute(Frame *neighbor_frame, Frame *frame, Frame *pa
   if (neighbor_node.size() < node.size()) {
     LOG_ERROR("got invalid nodes. neighbor node size %d, this node size %d", neighbor_node.size(), node.size());
   }
+  // 前缀压缩格式下，移动数据项后当前节点的范围变大，如果公共前缀变短后放不下了，就不再移动，
+  // 当前节点会暂时少于 min_size 个数据项，这不影响正确性
   if (index == 0) {
     // the neighbor is at right
+    if (neighbor_node.size() < 2) {
+      return RC::SUCCESS;
+    }
+    std::string separator(file_header_.key_length, '\0');
+    memcpy(separator.data(), neighbor_node.key_at(1, separator.data()), separator.size());
+    if (node.max_size_in_range(node.low_fence(), separator.data()) <= node.size()) {
+      return RC::SUCCESS;
+    }
+    node.set_fences(node.low_fence(), separator.data());
     neighbor_node.move_first_to_end(node, disk_buffer_pool_);
+    neighbor_node.set_fences(separator.data(), neighbor_node.high_fence());
     // neighbor_node.validate(key_comparator_, disk_buffer_pool_, file_id_);
     // node.validate(key_comparator_, disk_buffer_pool_, file_id_);
-    parent_node.set_key_at(index + 1, neighbor_node.key_at(0));
+    parent_node.set_key_at(index + 1, separator.data());
     // parent_node.validate(key_comparator_, disk_buffer_pool_, file_id_);
   } else {
     // the neighbor is at left
+    std::string separator(file_header_.key_length, '\0');
+    memcpy(separator.data(), neighbor_node.key_at(neighbor_node.size() - 1, separator.data()), separator.size());
+    if (node.max_size_in_range(separator.data(), node.high_fence()) <= node.size()) {
+      return RC::SUCCESS;
+    }
+    node.set_fences(separator.data(), node.high_fence());
     neighbor_node.move_last_to_front(node, disk_buffer_pool_);
+    neighbor_node.set_fences(neighbor_node.low_fence(), separator.data());
     // neighbor_node.validate(key_comparator_, disk_buffer_pool_, file_id_);
     // node.validate(key_comparator_, disk_buffer_pool_, file_id_);
-    parent_node.set_key_at(index, node.key_at(0));
+    parent_node.set_key_at(index, separator.data());
     // parent_node.validate(key_comparator_, disk_buffer_pool_, file_id_);
   }
 
@@ -1668,7 +2198,8 @@ RC BplusTreeHandler::delete_entry(const char *user_key, const RID *rid)
 
 BplusTreeScanner::BplusTreeScanner(BplusTreeHandler &tree_handler) 
     : tree_handler_(tree_handler),
-    latch_memo_(tree_handler.disk_buffer_pool_)
+    latch_memo_(tree_handler.disk_buffer_pool_),
+    key_buffer_(tree_handler.file_header_.key_length, '\0')
 {}
 
 BplusTreeScanner::~BplusTreeScanner()
@@ -1677,7 +2208,8 @@ BplusTreeScanner::~BplusTreeScanner()
 }
 
 RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inclusive, 
-                          const char *right_user_key, int right_len, bool right_inclusive)
+                          const char *right_user_key, int right_len, bool right_inclusive,
+                          bool descending /* = false */, int limit /* = -1 */)
 {
   RC rc = RC::SUCCESS;
   if (inited_) {
@@ -1687,7 +2219,81 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
 
   inited_ = true;
   first_emitted_ = false;
+  reached_end_ = false;
+  suspended_ = false;
+  resume_key_ = nullptr;
+  descending_ = descending;
+  limit_ = limit;
+  emitted_num_ = 0;
+
+  rc = set_bounds(left_user_key, left_len, left_inclusive, right_user_key, right_len, right_inclusive);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  rc = descending_ ? open_backward() : open_forward();
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  if (current_frame_ != nullptr && touch_end()) {
+    reached_end_ = true;
+  }
+
+  return RC::SUCCESS;
+}
+
+RC BplusTreeScanner::rescan(const char *left_user_key, int left_len, bool left_inclusive, 
+                            const char *right_user_key, int right_len, bool right_inclusive)
+{
+  if (!inited_) {
+    LOG_WARN("tree scanner has not been opened");
+    return RC::INTERNAL;
+  }
 
+  first_emitted_ = false;
+  reached_end_ = false;
+  suspended_ = false;
+  resume_key_ = nullptr;
+  emitted_num_ = 0;
+
+  RC rc = set_bounds(left_user_key, left_len, left_inclusive, right_user_key, right_len, right_inclusive);
+  if (rc != RC::SUCCESS) {
+    // 与 open 一样，非法的范围没有数据
+    reached_end_ = true;
+    return rc == RC::INVALID_ARGUMENT ? RC::SUCCESS : rc;
+  }
+
+  if (!descending_ && current_frame_ != nullptr && left_key_ != nullptr) {
+    LeafIndexNodeHandler node(tree_handler_.file_header_, current_frame_);
+    const KeyComparator &key_comparator = tree_handler_.key_comparator_;
+    const char *left_key = (const char *)left_key_.get();
+    // 第一个键比左边界小才能确定左边界之前的数据不在前一个叶子节点中
+    if (node.size() > 0 && key_comparator(node.key_at(0, key_buffer_.data()), left_key) < 0 &&
+        key_comparator(left_key, node.key_at(node.size() - 1, key_buffer_.data())) <= 0) {
+      iter_index_ = node.lookup(key_comparator, left_key);
+      reached_end_ = touch_end();
+      leaf_reused_num_++;
+      return RC::SUCCESS;
+    }
+  }
+
+  latch_memo_.release();
+  current_frame_ = nullptr;
+  rc = descending_ ? open_backward() : open_forward();
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  if (current_frame_ != nullptr && touch_end()) {
+    reached_end_ = true;
+  }
+  return RC::SUCCESS;
+}
+
+RC BplusTreeScanner::set_bounds(const char *left_user_key, int left_len, bool left_inclusive, 
+                                const char *right_user_key, int right_len, bool right_inclusive)
+{
   // 校验输入的键值是否是合法范围
   if (left_user_key && right_user_key) {
     const auto &attr_comparator = tree_handler_.key_comparator_.attr_comparator();
@@ -1699,7 +2305,58 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
     }
   }
 
-  if (nullptr == left_user_key) {
+  RC rc = make_bound_key(left_user_key, left_len, left_inclusive, true /*is_left*/, left_key_);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to make left key. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rc = make_bound_key(right_user_key, right_len, right_inclusive, false /*is_left*/, right_key_);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to make right key. rc=%s", strrc(rc));
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+RC BplusTreeScanner::make_bound_key(
+    const char *user_key, int key_len, bool inclusive, bool is_left, MemPoolItem::unique_ptr &key)
+{
+  // 没有指定边界
+  if (nullptr == user_key) {
+    key = nullptr;
+    return RC::SUCCESS;
+  }
+
+  char *fixed_key = const_cast<char *>(user_key);
+  if (tree_handler_.file_header_.attr_type == CHARS) {
+    bool should_inclusive_after_fix = false;
+    RC rc = fix_user_key(user_key, key_len, is_left /*want_greater*/, &fixed_key, &should_inclusive_after_fix);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to fix user key. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    if (should_inclusive_after_fix) {
+      inclusive = true;
+    }
+  }
+
+  // 包含左边界时从最小的RID开始，包含右边界时到最大的RID结束
+  const RID *rid = (is_left == inclusive) ? RID::min() : RID::max();
+  key = tree_handler_.make_key(fixed_key, *rid);
+
+  if (fixed_key != user_key) {
+    delete[] fixed_key;
+    fixed_key = nullptr;
+  }
+  return RC::SUCCESS;
+}
+
+RC BplusTreeScanner::open_forward()
+{
+  RC rc = RC::SUCCESS;
+  if (nullptr == left_key_) {
     rc = tree_handler_.left_most_page(latch_memo_, current_frame_);
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to find left most page. rc=%s", strrc(rc));
@@ -1707,105 +2364,88 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
     }
 
     iter_index_ = 0;
-  } else {
+    return RC::SUCCESS;
+  }
 
-    char *fixed_left_key = const_cast<char *>(left_user_key);
-    if (tree_handler_.file_header_.attr_type == CHARS) {
-      bool should_inclusive_after_fix = false;
-      rc = fix_user_key(left_user_key, left_len, true /*greater*/, &fixed_left_key, &should_inclusive_after_fix);
-      if (rc != RC::SUCCESS) {
-        LOG_WARN("failed to fix left user key. rc=%s", strrc(rc));
-        return rc;
-      }
+  const char *left_key = (const char *)left_key_.get();
+  rc = tree_handler_.find_leaf(latch_memo_, BplusTreeOperationType::READ, left_key, current_frame_);
+  if (rc == RC::EMPTY) {
+    current_frame_ = nullptr;
+    return RC::SUCCESS;
+  } else if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to find left page. rc=%s", strrc(rc));
+    return rc;
+  }
 
-      if (should_inclusive_after_fix) {
-        left_inclusive = true;
-      }
+  LeafIndexNodeHandler left_node(tree_handler_.file_header_, current_frame_);
+  int left_index = left_node.lookup(tree_handler_.key_comparator_, left_key);
+  // lookup 返回的是适合插入的位置，还需要判断一下是否在合适的边界范围内
+  if (left_index >= left_node.size()) {  // 超出了当前页，就需要向后移动一个位置
+    const PageNum next_page_num = left_node.next_page();
+    if (next_page_num == BP_INVALID_PAGE_NUM) {  // 这里已经是最后一页，说明当前扫描，没有数据
+      latch_memo_.release();
+      current_frame_ = nullptr;
+      return RC::SUCCESS;
     }
 
-    MemPoolItem::unique_ptr left_pkey;
-    if (left_inclusive) {
-      left_pkey = tree_handler_.make_key(fixed_left_key, *RID::min());
-    } else {
-      left_pkey = tree_handler_.make_key(fixed_left_key, *RID::max());
+    rc = latch_memo_.get_page(next_page_num, current_frame_);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to fetch next page. page num=%d, rc=%s", next_page_num, strrc(rc));
+      return rc;
     }
+    latch_memo_.slatch(current_frame_);
 
-    const char *left_key = (const char *)left_pkey.get();
+    left_index = 0;
+  }
+  iter_index_ = left_index;
+  return RC::SUCCESS;
+}
 
-    if (fixed_left_key != left_user_key) {
-      delete[] fixed_left_key;
-      fixed_left_key = nullptr;
+RC BplusTreeScanner::open_backward()
+{
+  RC rc = RC::SUCCESS;
+  while (true) {
+    if (nullptr == right_key_) {
+      rc = tree_handler_.right_most_page(latch_memo_, current_frame_);
+    } else {
+      rc = tree_handler_.find_leaf(
+          latch_memo_, BplusTreeOperationType::READ, (const char *)right_key_.get(), current_frame_);
     }
-
-    rc = tree_handler_.find_leaf(latch_memo_, BplusTreeOperationType::READ, left_key, current_frame_);
     if (rc == RC::EMPTY) {
-      rc = RC::SUCCESS;
       current_frame_ = nullptr;
-      return rc;
+      return RC::SUCCESS;
     } else if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to find left page. rc=%s", strrc(rc));
+      LOG_WARN("failed to find right page. rc=%s", strrc(rc));
       return rc;
     }
-    
-
-    LeafIndexNodeHandler left_node(tree_handler_.file_header_, current_frame_);
-    int left_index = left_node.lookup(tree_handler_.key_comparator_, left_key);
-    // lookup 返回的是适合插入的位置，还需要判断一下是否在合适的边界范围内
-    if (left_index >= left_node.size()) {  // 超出了当前页，就需要向后移动一个位置
-      const PageNum next_page_num = left_node.next_page();
-      if (next_page_num == BP_INVALID_PAGE_NUM) {  // 这里已经是最后一页，说明当前扫描，没有数据
-        latch_memo_.release();
-        current_frame_ = nullptr;
-        return RC::SUCCESS;
-      }
-
-      rc = latch_memo_.get_page(next_page_num, current_frame_);
-      if (rc != RC::SUCCESS) {
-        LOG_WARN("failed to fetch next page. page num=%d, rc=%s", next_page_num, strrc(rc));
-        return rc;
-      }
-      latch_memo_.slatch(current_frame_);
-
-      left_index = 0;
-    }
-    iter_index_ = left_index;
-  }
-
-  // 没有指定右边界范围，那么就返回右边界最大值
-  if (nullptr == right_user_key) {
-    right_key_ = nullptr;
-  } else {
 
-    char *fixed_right_key = const_cast<char *>(right_user_key);
-    bool should_include_after_fix = false;
-    if (tree_handler_.file_header_.attr_type == CHARS) {
-      rc = fix_user_key(right_user_key, right_len, false /*want_greater*/, &fixed_right_key, &should_include_after_fix);
-      if (rc != RC::SUCCESS) {
-        LOG_WARN("failed to fix right user key. rc=%s", strrc(rc));
-        return rc;
-      }
-
-      if (should_include_after_fix) {
-        right_inclusive = true;
-      }
-    }
-    if (right_inclusive) {
-      right_key_ = tree_handler_.make_key(fixed_right_key, *RID::max());
+    LeafIndexNodeHandler right_node(tree_handler_.file_header_, current_frame_);
+    if (nullptr == right_key_) {
+      iter_index_ = right_node.size() - 1;
     } else {
-      right_key_ = tree_handler_.make_key(fixed_right_key, *RID::min());
+      // lookup 返回第一个不小于右边界的位置，前一个就是最后一个在范围内的数据
+      iter_index_ = right_node.lookup(tree_handler_.key_comparator_, (const char *)right_key_.get()) - 1;
     }
 
-    if (fixed_right_key != right_user_key) {
-      delete[] fixed_right_key;
-      fixed_right_key = nullptr;
+    /**
+     * 需要移动到左边的页面时，加锁顺序与插入、删除相反，只能尝试加锁。
+     * 扫描还没有开始，加锁失败时释放所有的页面，重新定位
+     */
+    rc = iter_index_ >= 0 ? RC::SUCCESS : move_backward();
+    if (rc == RC::LOCKED_NEED_WAIT) {
+      latch_memo_.release();
+      current_frame_ = nullptr;
+      continue;
     }
-  }
 
-  if (touch_end()) {
-    current_frame_ = nullptr;
+    if (rc == RC::RECORD_EOF) {
+      latch_memo_.release();
+      current_frame_ = nullptr;
+      return RC::SUCCESS;
+    }
+    return rc;
   }
-
-  return RC::SUCCESS;
+  return rc;
 }
 
 void BplusTreeScanner::fetch_item(RID &rid)
@@ -1816,50 +2456,168 @@ void BplusTreeScanner::fetch_item(RID &rid)
 
 bool BplusTreeScanner::touch_end()
 {
-  if (right_key_ == nullptr) {
+  // 倒序扫描时，结束的位置是左边界
+  const MemPoolItem::unique_ptr &end_key = descending_ ? left_key_ : right_key_;
+  if (end_key == nullptr) {
     return false;
   }
-  
+
   LeafIndexNodeHandler node(tree_handler_.file_header_, current_frame_);
-  const char *this_key = node.key_at(iter_index_);
-  int compare_result = tree_handler_.key_comparator_(this_key, static_cast<char *>(right_key_.get()));
-  return compare_result > 0;
+  const char *this_key = node.key_at(iter_index_, key_buffer_.data());
+  int compare_result = tree_handler_.key_comparator_(this_key, static_cast<char *>(end_key.get()));
+  return descending_ ? compare_result < 0 : compare_result > 0;
 }
 
 RC BplusTreeScanner::next_entry(RID &rid)
 {
-  if (nullptr == current_frame_) {
+  if (suspended_) {
+    RC rc = resume();
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+
+  if (nullptr == current_frame_ || reached_end_) {
     return RC::RECORD_EOF;
   }
 
-  if (!first_emitted_) {
-    fetch_item(rid);
-    first_emitted_ = true;
-    return RC::SUCCESS;
+  // 已经返回了足够多的数据，不再访问后面的页面
+  if (limit_ >= 0 && emitted_num_ >= limit_) {
+    return RC::RECORD_EOF;
   }
 
-  iter_index_++;
+  if (first_emitted_) {
+    RC rc = descending_ ? move_backward() : move_forward();
+    if (rc != RC::SUCCESS) {
+      reached_end_ = (rc == RC::RECORD_EOF);
+      return rc;
+    }
 
-  LeafIndexNodeHandler node(tree_handler_.file_header_, current_frame_);
-  if (iter_index_ < node.size()) {
     if (touch_end()) {
+      reached_end_ = true;
       return RC::RECORD_EOF;
     }
+  }
 
-    fetch_item(rid);
+  fetch_item(rid);
+  first_emitted_ = true;
+  emitted_num_++;
+  return RC::SUCCESS;
+}
+
+RC BplusTreeScanner::suspend()
+{
+  if (!inited_ || suspended_) {
     return RC::SUCCESS;
   }
 
+  // 已经扫描结束时不需要再定位，释放页面以后 next_entry 直接返回 RECORD_EOF
+  const bool has_more = current_frame_ != nullptr && !reached_end_;
+  resume_key_ = nullptr;
+  if (has_more && first_emitted_) {
+    LeafIndexNodeHandler node(tree_handler_.file_header_, current_frame_);
+    RID rid;
+    fetch_item(rid);
+    resume_key_ = tree_handler_.make_key(node.key_at(iter_index_, key_buffer_.data()), rid);
+    if (nullptr == resume_key_) {
+      return RC::NOMEM;
+    }
+  }
+
+  latch_memo_.release();
+  current_frame_ = nullptr;
+  suspended_ = has_more;
+  return RC::SUCCESS;
+}
+
+RC BplusTreeScanner::resume()
+{
+  suspended_ = false;
+
   RC rc = RC::SUCCESS;
-  PageNum next_page_num = node.next_page();
-  if (BP_INVALID_PAGE_NUM == next_page_num) {
-    return RC::RECORD_EOF;
+  if (nullptr == resume_key_) {
+    // 还没有返回过数据，从头开始
+    rc = descending_ ? open_backward() : open_forward();
+  } else if (descending_) {
+    // 最后一个比上次返回的数据小的位置
+    std::swap(right_key_, resume_key_);
+    rc = open_backward();
+    std::swap(right_key_, resume_key_);
+    first_emitted_ = false;
+  } else {
+    // 第一个不小于上次返回的数据的位置。这条数据还在时，从它的下一条开始
+    std::swap(left_key_, resume_key_);
+    rc = open_forward();
+    std::swap(left_key_, resume_key_);
+    if (rc == RC::SUCCESS && current_frame_ != nullptr) {
+      LeafIndexNodeHandler node(tree_handler_.file_header_, current_frame_);
+      first_emitted_ =
+          tree_handler_.key_comparator_(node.key_at(iter_index_, key_buffer_.data()),
+                                        static_cast<char *>(resume_key_.get())) == 0;
+    }
+  }
+  resume_key_ = nullptr;
+  if (rc != RC::SUCCESS) {
+    return rc;
   }
 
+  if (current_frame_ != nullptr && !first_emitted_ && touch_end()) {
+    reached_end_ = true;
+  }
+  return RC::SUCCESS;
+}
+
+RC BplusTreeScanner::move_forward()
+{
+  iter_index_++;
+  while (true) {
+    LeafIndexNodeHandler node(tree_handler_.file_header_, current_frame_);
+    if (iter_index_ < node.size()) {
+      return RC::SUCCESS;
+    }
+
+    PageNum next_page_num = node.next_page();
+    if (BP_INVALID_PAGE_NUM == next_page_num) {
+      return RC::RECORD_EOF;
+    }
+
+    RC rc = switch_page(next_page_num);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    iter_index_ = 0;
+  }
+  return RC::SUCCESS;
+}
+
+RC BplusTreeScanner::move_backward()
+{
+  iter_index_--;
+  while (iter_index_ < 0) {
+    LeafIndexNodeHandler node(tree_handler_.file_header_, current_frame_);
+    PageNum prev_page_num = node.prev_page();
+    if (BP_INVALID_PAGE_NUM == prev_page_num) {
+      return RC::RECORD_EOF;
+    }
+
+    RC rc = switch_page(prev_page_num);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+
+    LeafIndexNodeHandler prev_node(tree_handler_.file_header_, current_frame_);
+    iter_index_ = prev_node.size() - 1;
+  }
+  return RC::SUCCESS;
+}
+
+RC BplusTreeScanner::switch_page(PageNum page_num)
+{
   const int memo_point = latch_memo_.memo_point();
-  rc = latch_memo_.get_page(next_page_num, current_frame_);
+  Frame *frame = nullptr;
+  RC rc = latch_memo_.get_page(page_num, frame);
   if (rc != RC::SUCCESS) {
-    LOG_WARN("failed to get next page. page num=%d, rc=%s", next_page_num, strrc(rc));
+    LOG_WARN("failed to get page. page num=%d, rc=%s", page_num, strrc(rc));
     return rc;
   }
 
@@ -1868,14 +2626,15 @@ RC BplusTreeScanner::next_entry(RID &rid)
    * 因为这里访问页面的方式顺序与插入、删除的顺序不一样
    * 如果加锁失败，就由上层做重试
    */
-  bool locked = latch_memo_.try_slatch(current_frame_);
+  bool locked = latch_memo_.try_slatch(frame);
   if (!locked) {
     return RC::LOCKED_NEED_WAIT;
   }
 
+  // 持有当前页面的锁时，相邻页面的链接不会被修改，拿到新页面的锁以后再释放当前页面
   latch_memo_.release_to(memo_point);
-  iter_index_ = -1; // `next` will add 1
-  return next_entry(rid);
+  current_frame_ = frame;
+  return RC::SUCCESS;
 }
 
 RC BplusTreeScanner::close()
@@ -21,6 +21,8 @@ See the Mulan PSL v2 for more details. */
 #include <sstream>
 #include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "storage/record/record_manager.h"
 #include "storage/buffer/disk_buffer_pool.h"
@@ -58,6 +60,11 @@ public:
     attr_length_ = length;
   }
 
+  AttrType attr_type() const
+  {
+    return attr_type_;
+  }
+
   int attr_length() const
   {
     return attr_length_;
@@ -209,6 +216,13 @@ private:
  */
 struct IndexFileHeader 
 {
+  /**
+   * @brief 当前的索引文件格式版本
+   * @details 节点的存储格式变化时增加这个值，打开版本不同的索引文件会失败，需要重建索引。
+   * 版本 1 在叶子节点中增加了 prev_brother，参考 LeafIndexNode。
+   */
+  static constexpr int32_t FORMAT_VERSION = 1;
+
   IndexFileHeader()
   {
     memset(this, 0, sizeof(IndexFileHeader));
@@ -220,6 +234,9 @@ struct IndexFileHeader
   int32_t attr_length;        ///< 键值的长度
   int32_t key_length;         ///< attr length + sizeof(RID)
   AttrType attr_type;         ///< 键值的类型
+  int32_t prefix_compression; ///< 节点是否使用前缀压缩格式，参考 IndexNodeHandler::set_fences
+  int32_t is_unique;          ///< 是否是唯一索引，重新打开时仍然检查键值重复
+  int32_t format_version;     ///< 创建文件时的格式版本，参考 FORMAT_VERSION
 
   const std::string to_string()
   {
@@ -230,7 +247,10 @@ struct IndexFileHeader
        << "attr_type:" << attr_type << ","
        << "root_page:" << root_page << ","
        << "internal_max_size:" << internal_max_size << ","
-       << "leaf_max_size:" << leaf_max_size << ";";
+       << "leaf_max_size:" << leaf_max_size << ","
+       << "prefix_compression:" << prefix_compression << ","
+       << "is_unique:" << is_unique << ","
+       << "format_version:" << format_version << ";";
 
     return ss.str();
   }
@@ -268,8 +288,9 @@ struct IndexNode
  */
 struct LeafIndexNode : public IndexNode 
 {
-  static constexpr int HEADER_SIZE = IndexNode::HEADER_SIZE + 4;
+  static constexpr int HEADER_SIZE = IndexNode::HEADER_SIZE + 8;
 
+  PageNum prev_brother;  ///< 左边的叶子节点，用于倒序扫描
   PageNum next_brother;
   /**
    * leaf can store order keys and rids at most
@@ -298,6 +319,31 @@ struct InternalIndexNode : public IndexNode
   char array[0];
 };
 
+/**
+ * @brief 前缀压缩格式的节点，在节点头和数据项之间记录的键值范围
+ * @ingroup BPlusTree
+ * @code
+ * storage format:
+ * | common header(leaf or internal) | prefix length | fence flags | low fence key | high fence key |
+ * | key0 suffix, value0 | key1 suffix, value1 | ... |
+ * @endcode
+ * 节点中所有的键值都在 [low fence, high fence) 范围内，这个范围由父节点中的分隔键值决定，
+ * 所以两个边界的公共前缀也是节点中所有键值(包括以后插入的键值)的公共前缀，数据项中只需要
+ * 保存去掉公共前缀之后的部分。公共前缀只会在节点分裂、合并或者重新分配时发生变化。
+ * 最左边的节点没有 low fence，最右边的节点没有 high fence，这时公共前缀的长度就是0。
+ */
+struct IndexNodeFence
+{
+  static constexpr int HEADER_SIZE = 8;
+
+  static constexpr int32_t HAS_LOW_FENCE  = 0x1;
+  static constexpr int32_t HAS_HIGH_FENCE = 0x2;
+
+  int32_t prefix_length;
+  int32_t flags;
+  char    keys[0];  ///< low fence key, high fence key
+};
+
 /**
  * @brief IndexNode 仅作为数据在内存或磁盘中的表示
  * @ingroup BPlusTree
@@ -329,8 +375,70 @@ public:
 
   bool validate() const;
 
+  /**
+   * @brief 前缀压缩格式的节点中键值的范围 [low fence, high fence)
+   * @return 如果没有这个边界或者不是前缀压缩格式，返回nullptr
+   */
+  const char *low_fence() const;
+  const char *high_fence() const;
+
+  /**
+   * @brief 设置节点的键值范围。nullptr 表示没有边界
+   * @details 只对前缀压缩格式的节点有效。公共前缀变化时，会重新编码节点中已有的数据项，
+   * 调用者需要保证节点中的数据项都在新的范围内，并且使用新的前缀后仍然可以放下，参考 max_size_in_range
+   */
+  void set_fences(const char *low_fence, const char *high_fence);
+
+  /**
+   * @brief 节点的键值范围设置为 [low_fence, high_fence) 时，最多可以容纳多少个数据项
+   */
+  int max_size_in_range(const char *low_fence, const char *high_fence) const;
+
+  /**
+   * @brief 数据项中去掉的公共前缀长度，不是前缀压缩格式时是0
+   */
+  int prefix_length() const;
+
   friend std::string to_string(const IndexNodeHandler &handler);
 
+protected:
+  bool  prefix_compressed() const;
+  int   stored_key_size() const;
+  int   capacity(int prefix_length) const;
+  int   common_prefix_length(const char *low_fence, const char *high_fence) const;
+  char *items() const;
+
+  /**
+   * @brief 在节点中保存的键值与完整键值之间的转换
+   */
+  void encode_key(char *stored_key, const char *key) const;
+  void decode_key(const char *stored_key, char *key) const;
+
+  /**
+   * @brief 返回完整的键值
+   * @param buf 至少 key_size() 字节。前缀压缩格式下把键值还原到 buf 中并返回 buf，否则直接返回 stored_key
+   */
+  const char *decoded_key(const char *stored_key, char *buf) const;
+
+  char *__item_at(int index) const;
+  char *__key_at(int index) const;
+  char *__value_at(int index) const;
+
+  /**
+   * @brief 从其它节点复制数据项到当前节点的指定位置，两个节点的公共前缀不同时会重新编码
+   * @details 不会修改节点的大小
+   */
+  void copy_items(int index, const IndexNodeHandler &other, int other_index, int num);
+
+  /**
+   * @brief 前缀压缩格式节点中的查找，返回值与 common::lower_bound 相同
+   * @param stored_keys 第一个参与查找的键值
+   */
+  int lookup_compressed(const char *stored_keys, int num, const char *key, bool *found) const;
+
+private:
+  IndexNodeFence *fence() const;
+
 protected:
   const IndexFileHeader &header_;
   PageNum page_num_;
@@ -350,8 +458,14 @@ public:
   void init_empty();
   void set_next_page(PageNum page_num);
   PageNum next_page() const;
+  void set_prev_page(PageNum page_num);
+  PageNum prev_page() const;
 
-  char *key_at(int index);
+  /**
+   * @brief 第 index 个数据项的完整键值
+   * @param buf 至少 key_size() 字节，前缀压缩格式的节点把键值还原到这里。返回值在 buf 和页面不变时有效
+   */
+  const char *key_at(int index, char *buf) const;
   char *value_at(int index);
 
   /**
@@ -376,12 +490,8 @@ public:
   friend std::string to_string(const LeafIndexNodeHandler &handler, const KeyPrinter &printer);
 
 private:
-  char *__item_at(int index) const;
-  char *__key_at(int index) const;
-  char *__value_at(int index) const;
-
-  void append(const char *item);
-  void preappend(const char *item);
+  void append(const LeafIndexNodeHandler &other, int index);
+  void preappend(const LeafIndexNodeHandler &other, int index);
 
 private:
   LeafIndexNode *leaf_node_;
@@ -402,7 +512,11 @@ public:
 
   void insert(const char *key, PageNum page_num, const KeyComparator &comparator);
   RC move_half_to(LeafIndexNodeHandler &other, DiskBufferPool *bp);
-  char *key_at(int index);
+  /**
+   * @brief 第 index 个数据项的完整键值
+   * @param buf 至少 key_size() 字节，前缀压缩格式的节点把键值还原到这里。返回值在 buf 和页面不变时有效
+   */
+  const char *key_at(int index, char *buf) const;
   PageNum value_at(int index);
 
   /**
@@ -435,20 +549,9 @@ public:
   friend std::string to_string(const InternalIndexNodeHandler &handler, const KeyPrinter &printer);
 
 private:
-  RC copy_from(const char *items, int num, DiskBufferPool *disk_buffer_pool);
-  RC append(const char *item, DiskBufferPool *bp);
-  RC preappend(const char *item, DiskBufferPool *bp);
-
-private:
-  char *__item_at(int index) const;
-  char *__key_at(int index) const;
-  char *__value_at(int index) const;
-
-  int value_size() const;
-  int item_size() const;
-
-private:
-  InternalIndexNode *internal_node_ = nullptr;
+  RC copy_from(const InternalIndexNodeHandler &other, int index, int num, DiskBufferPool *disk_buffer_pool);
+  RC append(const InternalIndexNodeHandler &other, int index, DiskBufferPool *bp);
+  RC preappend(const InternalIndexNodeHandler &other, int index, DiskBufferPool *bp);
 };
 
 /**
@@ -467,7 +570,8 @@ public:
             int attr_length,
             const bool &is_unique, 
             int internal_max_size = -1, 
-            int leaf_max_size = -1);
+            int leaf_max_size = -1,
+            bool prefix_compression = false);
 
   /**
    * 打开名为fileName的索引文件。
@@ -505,6 +609,15 @@ public:
    */
   RC get_entry(const char *user_key, int key_len, std::list<RID> &rids);
 
+  /**
+   * @brief 批量查找多个值的record
+   * @details 先对键值排序、去重，再从左到右查找。下一个键值还在当前叶子节点或者下一个叶子节点中时，
+   * 不会再从根节点开始查找。返回的RID按照(page_num, slot_num)排序，后续读取记录时按页面顺序访问。
+   * @param user_keys 每个元素是一个属性值。CHARS 类型可以比属性短
+   * @param rids 追加到这里
+   */
+  RC multi_get_entry(const std::vector<std::string> &user_keys, std::vector<RID> &rids);
+
   RC sync();
 
   /**
@@ -534,6 +647,7 @@ private:
 protected:
   RC find_leaf(LatchMemo &latch_memo, BplusTreeOperationType op, const char *key, Frame *&frame);
   RC left_most_page(LatchMemo &latch_memo, Frame *&frame);
+  RC right_most_page(LatchMemo &latch_memo, Frame *&frame);
   RC find_leaf_internal(LatchMemo &latch_memo, BplusTreeOperationType op, 
                         const std::function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, 
                         Frame *&frame);
@@ -545,6 +659,23 @@ protected:
 
   RC delete_entry_internal(LatchMemo &latch_memo, Frame *leaf_frame, const char *key);
 
+  /**
+   * @brief 批量查找中的一个键值
+   * @param[in,out] frame 上一个键值结束时所在的叶子节点，可能为空。返回时是当前键值结束时的叶子节点
+   * @return 切换叶子节点加锁失败时返回 LOCKED_NEED_WAIT，由调用者释放所有的锁以后重试
+   */
+  RC probe_entry(LatchMemo &latch_memo, const char *attr, Frame *&frame, std::vector<RID> &rids);
+
+  /**
+   * @brief 从当前叶子节点移动到右边的叶子节点，释放当前节点
+   */
+  RC switch_leaf(LatchMemo &latch_memo, PageNum page_num, Frame *&frame);
+
+  /**
+   * @brief 叶子节点分裂或合并后，修改右边叶子节点的 prev page
+   */
+  RC link_right_leaf(LatchMemo &latch_memo, PageNum right_page_num, PageNum prev_page_num);
+
   template <typename IndexNodeHandlerType>
   RC split(LatchMemo &latch_memo, Frame *frame, Frame *&new_frame);
   template <typename IndexNodeHandlerType>
@@ -567,6 +698,15 @@ private:
   common::MemPoolItem::unique_ptr make_key(const char *user_key, const RID &rid);
   void free_key(char *key);
 
+  /**
+   * @brief 叶子节点分裂时，生成放到父节点中的分隔键值
+   * @details 前缀压缩格式下，分隔键值截断到可以区分左右两个节点的最短长度，这样父节点和子节点
+   * 的公共前缀更长。满足 left_key < separator <= right_key
+   * @param left_key  左边节点的最后一个键值
+   * @param right_key 右边节点的第一个键值
+   */
+  std::string make_separator(const char *left_key, const char *right_key) const;
+
 protected:
   DiskBufferPool *disk_buffer_pool_ = nullptr;
   bool            header_dirty_ = false; // 
@@ -605,21 +745,78 @@ public:
    * @param right_user_key 扫描范围的右边界。如果是null，则没有右边界
    * @param right_len right_user_key 的内存大小(只有在变长字段中才会关注)
    * @param right_inclusive 右边界的值是否包含在内
+   * @param descending 是否从右边界开始倒序扫描
+   * @param limit 最多返回多少条数据，小于0表示没有限制。达到限制后不再访问后面的叶子节点
    */
   RC open(const char *left_user_key, int left_len, bool left_inclusive, 
-          const char *right_user_key, int right_len, bool right_inclusive);
+          const char *right_user_key, int right_len, bool right_inclusive,
+          bool descending = false, int limit = -1);
+
+  /**
+   * @brief 使用新的边界重新扫描，扫描的方向和数据条数限制与 open 时相同
+   * @details 正序扫描时，如果新的左边界落在当前的叶子节点中，就直接在这个节点中定位，不再从根节点开始查找。
+   * 按照从小到大的顺序依次扫描多个键(比如索引嵌套循环连接)时，大部分键都不需要访问内部节点。
+   */
+  RC rescan(const char *left_user_key, int left_len, bool left_inclusive,
+            const char *right_user_key, int right_len, bool right_inclusive);
 
   RC next_entry(RID &rid);
 
+  /**
+   * @brief 释放叶子节点的锁，记下最后返回的数据(键值+RID)
+   * @details 下次调用 next_entry 时重新查找这个位置，从它之后继续扫描。这条数据在这期间被删除了也没有关系
+   */
+  RC suspend();
+
   RC close();
 
+  /**
+   * @brief rescan 时直接在当前叶子节点中定位的次数
+   */
+  int64_t leaf_reused_num() const { return leaf_reused_num_; }
+
 private:
   /**
    * 如果key的类型是CHARS, 扩展或缩减user_key的大小刚好是schema中定义的大小
    */
   RC fix_user_key(const char *user_key, int key_len, bool want_greater, char **fixed_key, bool *should_inclusive);
 
+  /**
+   * @brief 根据用户指定的边界生成完整的键值(属性值+RID)
+   * @param is_left 是否是左边界
+   */
+  RC make_bound_key(const char *user_key, int key_len, bool inclusive, bool is_left,
+                    common::MemPoolItem::unique_ptr &key);
+
+  /**
+   * @brief 设置扫描的边界，并且检查边界是否是合法的范围
+   */
+  RC set_bounds(const char *left_user_key, int left_len, bool left_inclusive,
+                const char *right_user_key, int right_len, bool right_inclusive);
+
+  /**
+   * @brief 定位到第一个要返回的数据
+   */
+  RC open_forward();
+  RC open_backward();
+
+  /**
+   * @brief 回到 suspend 时的位置
+   */
+  RC resume();
+
+  /**
+   * @brief 移动到下一个/上一个数据，需要时切换到相邻的叶子节点
+   */
+  RC move_forward();
+  RC move_backward();
+  RC switch_page(PageNum page_num);
+
   void fetch_item(RID &rid);
+
+  /**
+   * @brief 当前位置是否已经超出了扫描范围。倒序扫描时判断的是左边界
+   */
   bool touch_end();
 
 private:
@@ -632,7 +829,19 @@ private:
   /// 起始位置和终止位置都是有效的数据
   Frame *current_frame_ = nullptr;
 
+  common::MemPoolItem::unique_ptr left_key_;
   common::MemPoolItem::unique_ptr right_key_;
   int iter_index_ = -1;
   bool first_emitted_ = false;
+  bool reached_end_ = false;  ///< 已经超出了扫描范围，当前位置仍然保留，rescan 时可以复用
+  bool suspended_ = false;    ///< 已经释放了叶子节点的锁，下次 next_entry 时重新定位
+
+  common::MemPoolItem::unique_ptr resume_key_;  ///< suspend 时最后返回的数据，还没有返回数据时为空
+  std::string key_buffer_;  ///< 读取前缀压缩的叶子节点中的键值时使用
+
+  bool descending_ = false;
+  int  limit_ = -1;
+  int  emitted_num_ = 0;  ///< 已经返回的数据条数
+
+  int64_t leaf_reused_num_ = 0;
 };
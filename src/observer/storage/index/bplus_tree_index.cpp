@@ -32,7 +32,8 @@ RC BplusTreeIndex::create(const char *file_name, const IndexMeta &index_meta, co
 
   Index::init(index_meta, field_meta);
 
-  RC rc = index_handler_.create(file_name, field_meta.type(), field_meta.len(), is_unique);
+  RC rc = index_handler_.create(file_name, field_meta.type(), field_meta.len(), is_unique,
+                                -1 /*internal_max_size*/, -1 /*leaf_max_size*/, index_meta.prefix_compression());
   if (RC::SUCCESS != rc) {
     LOG_WARN("Failed to create index_handler, file_name:%s, index:%s, field:%s, rc:%s",
         file_name,
@@ -101,9 +102,17 @@ RC BplusTreeIndex::delete_entry(const char *record, const RID *rid)
 
 IndexScanner *BplusTreeIndex::create_scanner(
     const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len, bool right_inclusive)
+{
+  return create_scanner(left_key, left_len, left_inclusive, right_key, right_len, right_inclusive,
+                        false /*descending*/, -1 /*limit*/);
+}
+
+IndexScanner *BplusTreeIndex::create_scanner(const char *left_key, int left_len, bool left_inclusive,
+    const char *right_key, int right_len, bool right_inclusive, bool descending, int limit)
 {
   BplusTreeIndexScanner *index_scanner = new BplusTreeIndexScanner(index_handler_);
-  RC rc = index_scanner->open(left_key, left_len, left_inclusive, right_key, right_len, right_inclusive);
+  RC rc = index_scanner->open(
+      left_key, left_len, left_inclusive, right_key, right_len, right_inclusive, descending, limit);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to open index scanner. rc=%d:%s", rc, strrc(rc));
     delete index_scanner;
@@ -126,10 +135,22 @@ BplusTreeIndexScanner::~BplusTreeIndexScanner() noexcept
   tree_scanner_.close();
 }
 
-RC BplusTreeIndexScanner::open(
-    const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len, bool right_inclusive)
+RC BplusTreeIndexScanner::open(const char *left_key, int left_len, bool left_inclusive, const char *right_key,
+    int right_len, bool right_inclusive, bool descending /* = false */, int limit /* = -1 */)
+{
+  return tree_scanner_.open(
+      left_key, left_len, left_inclusive, right_key, right_len, right_inclusive, descending, limit);
+}
+
+RC BplusTreeIndexScanner::rescan(const char *left_key, int left_len, bool left_inclusive, const char *right_key,
+    int right_len, bool right_inclusive)
+{
+  return tree_scanner_.rescan(left_key, left_len, left_inclusive, right_key, right_len, right_inclusive);
+}
+
+RC BplusTreeIndexScanner::suspend()
 {
-  return tree_scanner_.open(left_key, left_len, left_inclusive, right_key, right_len, right_inclusive);
+  return tree_scanner_.suspend();
 }
 
 RC BplusTreeIndexScanner::next_entry(RID *rid)
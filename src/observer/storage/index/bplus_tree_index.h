@@ -29,7 +29,7 @@ public:
 
   RC create(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta, const bool &is_unique);
   RC open(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta);
-  RC close();
+  RC close() override;
 
   RC insert_entry(const char *record, const RID *rid) override;
   RC delete_entry(const char *record, const RID *rid) override;
@@ -40,6 +40,14 @@ public:
   IndexScanner *create_scanner(const char *left_key, int left_len, bool left_inclusive, const char *right_key,
       int right_len, bool right_inclusive) override;
 
+  /**
+   * 扫描指定范围的数据，可以倒序扫描，以及限制返回的数据条数
+   * @param descending 从右边界开始倒序扫描
+   * @param limit 最多返回的数据条数，小于0表示没有限制
+   */
+  IndexScanner *create_scanner(const char *left_key, int left_len, bool left_inclusive, const char *right_key,
+      int right_len, bool right_inclusive, bool descending, int limit);
+
   RC sync() override;
 
 private:
@@ -62,7 +70,12 @@ public:
   RC destroy() override;
 
   RC open(const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len,
-      bool right_inclusive);
+      bool right_inclusive, bool descending = false, int limit = -1);
+
+  RC rescan(const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len,
+      bool right_inclusive) override;
+
+  RC suspend() override;
 
 private:
   BplusTreeScanner tree_scanner_;
@@ -0,0 +1,274 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "storage/index/bplus_tree_key_search.h"
+#include "storage/record/record.h"
+#include "common/defs.h"
+
+namespace {
+
+/// 二分查找缩小到这个范围后，使用向量比较
+constexpr int SEARCH_WINDOW_SIZE = 16;
+
+template <typename T>
+inline T load_attr(const char *item)
+{
+  T value;
+  memcpy(&value, item, sizeof(T));
+  return value;
+}
+
+/**
+ * @brief 属性值比较，与 common::compare_int 的语义相同
+ */
+inline int compare_attr(int32_t v1, int32_t v2)
+{
+  return (v1 > v2) - (v1 < v2);
+}
+
+/**
+ * @brief 属性值比较，与 common::compare_float 的语义相同
+ */
+inline int compare_attr(float v1, float v2)
+{
+  float cmp = v1 - v2;
+  if (cmp > EPSILON) {
+    return 1;
+  }
+  if (cmp < -EPSILON) {
+    return -1;
+  }
+  return 0;
+}
+
+template <typename T>
+inline int compare_key(const char *item, T key_attr, const RID *key_rid)
+{
+  int result = compare_attr(load_attr<T>(item), key_attr);
+  if (result != 0) {
+    return result;
+  }
+  RID item_rid;
+  memcpy(&item_rid, item + sizeof(T), sizeof(item_rid));
+  return RID::compare(&item_rid, key_rid);
+}
+
+/**
+ * @brief 属性值相等的键值，需要再比较RID
+ * @param eq_mask 属性值相等的位置
+ */
+template <typename T>
+inline int count_rid_less(const char *items, int item_size, unsigned eq_mask, const RID *key_rid)
+{
+  int count = 0;
+  while (eq_mask != 0) {
+    int lane = __builtin_ctz(eq_mask);
+    eq_mask &= eq_mask - 1;
+
+    RID item_rid;
+    memcpy(&item_rid, items + lane * item_size + sizeof(T), sizeof(item_rid));
+    if (RID::compare(&item_rid, key_rid) < 0) {
+      count++;
+    }
+  }
+  return count;
+}
+
+#if defined(__AVX2__)
+
+constexpr int LANES = 8;
+
+/**
+ * @brief 比较最多 LANES 个键值的属性值，返回小于和等于查找值的位置
+ * @details 使用gather按照item_size的步长读取，超出count的位置不会读取内存
+ */
+inline void compare_lanes(const char *items, int item_size, int count, int32_t key_attr,
+                          unsigned &lt_mask, unsigned &eq_mask)
+{
+  const __m256i lane_ids = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i offsets = _mm256_mullo_epi32(lane_ids, _mm256_set1_epi32(item_size));
+  const __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(count), lane_ids);
+  const __m256i values =
+      _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), reinterpret_cast<const int *>(items), offsets, valid, 1);
+
+  const __m256i key = _mm256_set1_epi32(key_attr);
+  const unsigned valid_mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(valid)));
+  lt_mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(key, values)))) & valid_mask;
+  eq_mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(values, key)))) & valid_mask;
+}
+
+inline void compare_lanes(const char *items, int item_size, int count, float key_attr,
+                          unsigned &lt_mask, unsigned &eq_mask)
+{
+  const __m256i lane_ids = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i offsets = _mm256_mullo_epi32(lane_ids, _mm256_set1_epi32(item_size));
+  const __m256 valid = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(count), lane_ids));
+  const __m256 values =
+      _mm256_mask_i32gather_ps(_mm256_setzero_ps(), reinterpret_cast<const float *>(items), offsets, valid, 1);
+
+  const __m256 diff = _mm256_sub_ps(values, _mm256_set1_ps(key_attr));
+  const __m256 lt = _mm256_cmp_ps(diff, _mm256_set1_ps(static_cast<float>(-EPSILON)), _CMP_LT_OQ);
+  const __m256 gt = _mm256_cmp_ps(diff, _mm256_set1_ps(static_cast<float>(EPSILON)), _CMP_GT_OQ);
+  const unsigned valid_mask = static_cast<unsigned>(_mm256_movemask_ps(valid));
+  lt_mask = static_cast<unsigned>(_mm256_movemask_ps(lt)) & valid_mask;
+  eq_mask = ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_or_ps(lt, gt))) & valid_mask;
+}
+
+#elif defined(__SSE2__)
+
+constexpr int LANES = 4;
+
+/**
+ * @brief 比较最多 LANES 个键值的属性值，返回小于和等于查找值的位置
+ * @details SSE2 没有gather指令，键值之间有间隔，只能逐个装载
+ */
+inline void compare_lanes(const char *items, int item_size, int count, int32_t key_attr,
+                          unsigned &lt_mask, unsigned &eq_mask)
+{
+  int32_t buffer[LANES] = {0};
+  for (int i = 0; i < count; i++) {
+    buffer[i] = load_attr<int32_t>(items + i * item_size);
+  }
+  const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer));
+  const __m128i key = _mm_set1_epi32(key_attr);
+  const unsigned valid_mask = (1U << count) - 1;
+  lt_mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(values, key)))) & valid_mask;
+  eq_mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(values, key)))) & valid_mask;
+}
+
+inline void compare_lanes(const char *items, int item_size, int count, float key_attr,
+                          unsigned &lt_mask, unsigned &eq_mask)
+{
+  float buffer[LANES] = {0};
+  for (int i = 0; i < count; i++) {
+    buffer[i] = load_attr<float>(items + i * item_size);
+  }
+  const __m128 values = _mm_loadu_ps(buffer);
+  const __m128 diff = _mm_sub_ps(values, _mm_set1_ps(key_attr));
+  const __m128 lt = _mm_cmplt_ps(diff, _mm_set1_ps(static_cast<float>(-EPSILON)));
+  const __m128 gt = _mm_cmpgt_ps(diff, _mm_set1_ps(static_cast<float>(EPSILON)));
+  const unsigned valid_mask = (1U << count) - 1;
+  lt_mask = static_cast<unsigned>(_mm_movemask_ps(lt)) & valid_mask;
+  eq_mask = ~static_cast<unsigned>(_mm_movemask_ps(_mm_or_ps(lt, gt))) & valid_mask;
+}
+
+#else
+
+constexpr int LANES = 4;
+
+template <typename T>
+inline void compare_lanes(const char *items, int item_size, int count, T key_attr,
+                          unsigned &lt_mask, unsigned &eq_mask)
+{
+  lt_mask = 0;
+  eq_mask = 0;
+  for (int i = 0; i < count; i++) {
+    int result = compare_attr(load_attr<T>(items + i * item_size), key_attr);
+    if (result < 0) {
+      lt_mask |= 1U << i;
+    } else if (result == 0) {
+      eq_mask |= 1U << i;
+    }
+  }
+}
+
+#endif
+
+/**
+ * @brief 统计窗口内小于查找键值的个数
+ * @details 窗口内的键值是有序的，所以小于查找值的个数就是lower bound在窗口内的偏移
+ */
+template <typename T>
+inline int count_less(const char *items, int item_size, int num, T key_attr, const RID *key_rid)
+{
+  int count = 0;
+  for (int i = 0; i < num; i += LANES) {
+    const char *lane_items = items + i * item_size;
+    const int lane_count = (num - i) < LANES ? (num - i) : LANES;
+
+    unsigned lt_mask = 0;
+    unsigned eq_mask = 0;
+    compare_lanes(lane_items, item_size, lane_count, key_attr, lt_mask, eq_mask);
+    count += __builtin_popcount(lt_mask);
+    if (eq_mask != 0) {
+      count += count_rid_less<T>(lane_items, item_size, eq_mask, key_rid);
+    }
+  }
+  return count;
+}
+
+template <typename T>
+int typed_lower_bound(const char *keys, int item_size, int num, const char *key, bool *found)
+{
+  const T key_attr = load_attr<T>(key);
+  RID key_rid;
+  memcpy(&key_rid, key + sizeof(T), sizeof(key_rid));
+
+  int low = 0;
+  int high = num;
+  while (high - low > SEARCH_WINDOW_SIZE) {
+    const int mid = low + (high - low) / 2;
+    const int result = compare_key<T>(keys + mid * item_size, key_attr, &key_rid);
+    if (result == 0) {
+      if (found) {
+        *found = true;
+      }
+      return mid;
+    }
+    if (result < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  const int position = low + count_less<T>(keys + low * item_size, item_size, high - low, key_attr, &key_rid);
+  if (found) {
+    *found = position < num && compare_key<T>(keys + position * item_size, key_attr, &key_rid) == 0;
+  }
+  return position;
+}
+
+}  // namespace
+
+bool fast_key_search_supported(AttrType attr_type, int attr_length)
+{
+  switch (attr_type) {
+    case INTS: return attr_length == sizeof(int32_t);
+    case FLOATS: return attr_length == sizeof(float);
+    default: return false;
+  }
+}
+
+int fast_key_lower_bound(AttrType attr_type, const char *keys, int item_size, int num, const char *key, bool *found)
+{
+  if (attr_type == FLOATS) {
+    return typed_lower_bound<float>(keys, item_size, num, key, found);
+  }
+  return typed_lower_bound<int32_t>(keys, item_size, num, key, found);
+}
+
+const char *fast_key_search_isa()
+{
+#if defined(__AVX2__)
+  return "avx2";
+#elif defined(__SSE2__)
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
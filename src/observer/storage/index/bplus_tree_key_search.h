@@ -0,0 +1,49 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/parser/parse_defs.h"
+
+/**
+ * @defgroup BPlusTreeKeySearch B+树节点内的键值查找
+ * @ingroup BPlusTree
+ * @details 通用的节点内查找使用 common::lower_bound + KeyComparator，每次比较都要按照
+ * AttrType 分派一次，对于一个几百个键值的节点，这些分派和分支预测失败占了查找的大部分时间。
+ * 对于定长的 INTS/FLOATS 键值，这里提供一个专门的实现：先用类型确定的比较做二分查找，
+ * 将范围缩小到一个很小的窗口，然后使用SIMD指令一次比较多个键值，统计小于查找值的个数。
+ * 具体使用哪种指令集在编译时决定(AVX2/SSE2)，都不支持时使用标量实现。
+ * 比较的语义与 common::compare_int/common::compare_float 及 RID::compare 完全一致。
+ */
+
+/**
+ * @brief 当前的键值类型是否可以使用专门的查找方法
+ * @ingroup BPlusTreeKeySearch
+ */
+bool fast_key_search_supported(AttrType attr_type, int attr_length);
+
+/**
+ * @brief 在节点内有序的键值中查找第一个不小于 key 的位置
+ * @ingroup BPlusTreeKeySearch
+ * @param attr_type 键值的类型，只能是INTS或FLOATS
+ * @param keys      第一个键值的地址。每个键值由属性值和RID组成
+ * @param item_size 相邻两个键值之间的距离，即键值加上value的长度
+ * @param num       键值的个数
+ * @param key       要查找的键值(属性值+RID)
+ * @param found     如果给定，返回是否找到了相等的键值
+ * @return 与 common::lower_bound 的返回值相同，如果所有的键值都小于key，返回num
+ */
+int fast_key_lower_bound(AttrType attr_type, const char *keys, int item_size, int num, const char *key, bool *found);
+
+/**
+ * @brief 编译时选择的指令集名称，用于测试和日志输出
+ * @ingroup BPlusTreeKeySearch
+ */
+const char *fast_key_search_isa();
@@ -0,0 +1,631 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+
+#include "storage/index/extendible_hash.h"
+#include "common/log/log.h"
+
+using namespace std;
+using namespace common;
+
+#define FIRST_INDEX_PAGE 1
+
+namespace {
+
+constexpr int DIRECTORY_ENTRIES_PER_PAGE = BP_PAGE_DATA_SIZE / sizeof(PageNum);
+
+int calc_bucket_capacity(int attr_length)
+{
+  int item_size = attr_length + sizeof(RID);
+  return ((int)BP_PAGE_DATA_SIZE - HashBucketNode::HEADER_SIZE) / item_size;
+}
+
+void init_bucket(Frame *frame, int local_depth)
+{
+  HashBucketNode *bucket = reinterpret_cast<HashBucketNode *>(frame->data());
+  bucket->local_depth = local_depth;
+  bucket->key_num = 0;
+  bucket->overflow_page = BP_INVALID_PAGE_NUM;
+}
+
+}  // namespace
+
+ExtendibleHashHandler::~ExtendibleHashHandler()
+{
+  close();
+}
+
+RC ExtendibleHashHandler::create(
+    const char *file_name, AttrType attr_type, int attr_length, bool is_unique, int bucket_capacity /* = -1 */)
+{
+  if (disk_buffer_pool_ != nullptr) {
+    LOG_WARN("%s has been opened before index.create.", file_name);
+    return RC::RECORD_OPENNED;
+  }
+
+  if (attr_type == FLOATS) {
+    // 浮点数比较时差在 EPSILON 以内就认为相等，相等的值字节可能不同，无法通过哈希查找
+    LOG_WARN("hash index does not support float keys. file name=%s", file_name);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  BufferPoolManager &bpm = BufferPoolManager::instance();
+  RC rc = bpm.create_file(file_name);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to create file. file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
+    return rc;
+  }
+
+  DiskBufferPool *bp = nullptr;
+  rc = bpm.open_file(file_name, bp);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to open file. file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
+    return rc;
+  }
+
+  // 文件中的页面：头页面，目录页面，以及初始时唯一的一个桶
+  Frame *header_frame = nullptr;
+  Frame *directory_frame = nullptr;
+  Frame *bucket_frame = nullptr;
+  if ((rc = bp->allocate_page(&header_frame)) != RC::SUCCESS ||
+      (rc = bp->allocate_page(&directory_frame)) != RC::SUCCESS ||
+      (rc = bp->allocate_page(&bucket_frame)) != RC::SUCCESS) {
+    LOG_WARN("failed to allocate pages for hash index. rc=%d:%s", rc, strrc(rc));
+    bpm.close_file(file_name);
+    return rc;
+  }
+
+  if (header_frame->page_num() != FIRST_INDEX_PAGE) {
+    LOG_WARN("header page num should be %d but got %d. is it a new file : %s",
+             FIRST_INDEX_PAGE, header_frame->page_num(), file_name);
+    bpm.close_file(file_name);
+    return RC::INTERNAL;
+  }
+
+  const int max_capacity = calc_bucket_capacity(attr_length);
+  if (bucket_capacity <= 0 || bucket_capacity > max_capacity) {
+    bucket_capacity = max_capacity;
+  }
+
+  init_bucket(bucket_frame, 0);
+  *reinterpret_cast<PageNum *>(directory_frame->data()) = bucket_frame->page_num();
+
+  file_header_.attr_length = attr_length;
+  file_header_.key_length = attr_length + sizeof(RID);
+  file_header_.attr_type = attr_type;
+  file_header_.global_depth = 0;
+  file_header_.bucket_capacity = bucket_capacity;
+  file_header_.directory_page_count = 1;
+  file_header_.directory_pages[0] = directory_frame->page_num();
+  file_header_.is_unique = is_unique ? 1 : 0;
+  memcpy(header_frame->data(), &file_header_, sizeof(file_header_));
+
+  directory_.assign(1, bucket_frame->page_num());
+
+  header_frame->mark_dirty();
+  directory_frame->mark_dirty();
+  bucket_frame->mark_dirty();
+  bp->unpin_page(header_frame);
+  bp->unpin_page(directory_frame);
+  bp->unpin_page(bucket_frame);
+
+  disk_buffer_pool_ = bp;
+  LOG_INFO("Successfully create hash index %s. header=%s", file_name, file_header_.to_string().c_str());
+  return sync();
+}
+
+RC ExtendibleHashHandler::open(const char *file_name)
+{
+  if (disk_buffer_pool_ != nullptr) {
+    LOG_WARN("%s has been opened before index.open.", file_name);
+    return RC::RECORD_OPENNED;
+  }
+
+  BufferPoolManager &bpm = BufferPoolManager::instance();
+  DiskBufferPool *bp = nullptr;
+  RC rc = bpm.open_file(file_name, bp);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to open file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
+    return rc;
+  }
+
+  Frame *frame = nullptr;
+  rc = bp->get_this_page(FIRST_INDEX_PAGE, &frame);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to get first page file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
+    bpm.close_file(file_name);
+    return rc;
+  }
+
+  memcpy(&file_header_, frame->data(), sizeof(file_header_));
+  bp->unpin_page(frame);
+  disk_buffer_pool_ = bp;
+
+  rc = load_directory();
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to load directory of hash index. file name=%s, rc=%s", file_name, strrc(rc));
+    close();
+    return rc;
+  }
+
+  LOG_INFO("Successfully open hash index %s. header=%s", file_name, file_header_.to_string().c_str());
+  return RC::SUCCESS;
+}
+
+RC ExtendibleHashHandler::close()
+{
+  if (disk_buffer_pool_ != nullptr) {
+    disk_buffer_pool_->close_file();
+  }
+
+  disk_buffer_pool_ = nullptr;
+  directory_.clear();
+  return RC::SUCCESS;
+}
+
+RC ExtendibleHashHandler::sync()
+{
+  return disk_buffer_pool_->flush_all_pages();
+}
+
+RC ExtendibleHashHandler::insert_entry(const char *user_key, const RID *rid)
+{
+  if (user_key == nullptr || rid == nullptr) {
+    LOG_WARN("Invalid arguments, key is empty or rid is empty");
+    return RC::INVALID_ARGUMENT;
+  }
+
+  string key(file_header_.key_length, '\0');
+  normalize_key(user_key, file_header_.attr_length, key.data());
+  memcpy(key.data() + file_header_.attr_length, rid, sizeof(*rid));
+  const uint32_t hash_value = hash(key.data());
+
+  lock_.lock();
+  RC rc = RC::SUCCESS;
+  while (true) {
+    const int index = directory_index(hash_value);
+    const PageNum bucket_page = directory_[index];
+
+    bool found = false;
+    rc = contains(bucket_page, key.data(), found);
+    if (rc != RC::SUCCESS) {
+      break;
+    }
+    if (found) {
+      LOG_TRACE("entry exists");
+      rc = RC::RECORD_DUPLICATE_KEY;
+      break;
+    }
+
+    bool has_space = false;
+    bool same_hash = false;
+    rc = check_bucket(bucket_page, hash_value, has_space, same_hash);
+    if (rc != RC::SUCCESS) {
+      break;
+    }
+
+    Frame *frame = nullptr;
+    rc = disk_buffer_pool_->get_this_page(bucket_page, &frame);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to fetch bucket page. page num=%d, rc=%s", bucket_page, strrc(rc));
+      break;
+    }
+    const int local_depth = reinterpret_cast<HashBucketNode *>(frame->data())->local_depth;
+    disk_buffer_pool_->unpin_page(frame);
+
+    if (has_space || same_hash || local_depth >= MAX_DEPTH) {
+      rc = append_item(bucket_page, key.data());
+      break;
+    }
+
+    // 桶已经满了，分裂以后重新定位
+    rc = split_bucket(index);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to split bucket. rc=%s", strrc(rc));
+      break;
+    }
+  }
+  lock_.unlock();
+  return rc;
+}
+
+RC ExtendibleHashHandler::delete_entry(const char *user_key, const RID *rid)
+{
+  string key(file_header_.key_length, '\0');
+  normalize_key(user_key, file_header_.attr_length, key.data());
+  memcpy(key.data() + file_header_.attr_length, rid, sizeof(*rid));
+  const uint32_t hash_value = hash(key.data());
+
+  lock_.lock();
+  RC rc = RC::RECORD_NOT_EXIST;
+  PageNum page_num = directory_[directory_index(hash_value)];
+  while (page_num != BP_INVALID_PAGE_NUM) {
+    Frame *frame = nullptr;
+    RC ret = disk_buffer_pool_->get_this_page(page_num, &frame);
+    if (ret != RC::SUCCESS) {
+      LOG_WARN("failed to fetch bucket page. page num=%d, rc=%s", page_num, strrc(ret));
+      rc = ret;
+      break;
+    }
+
+    HashBucketNode *bucket = reinterpret_cast<HashBucketNode *>(frame->data());
+    for (int i = 0; i < bucket->key_num; i++) {
+      if (memcmp(item_at(bucket, i), key.data(), item_size()) == 0) {
+        if (i != bucket->key_num - 1) {
+          memcpy(item_at(bucket, i), item_at(bucket, bucket->key_num - 1), item_size());
+        }
+        bucket->key_num--;
+        frame->mark_dirty();
+        rc = RC::SUCCESS;
+        break;
+      }
+    }
+
+    page_num = bucket->overflow_page;
+    disk_buffer_pool_->unpin_page(frame);
+    if (rc == RC::SUCCESS) {
+      break;
+    }
+  }
+  lock_.unlock();
+  return rc;
+}
+
+RC ExtendibleHashHandler::get_entry(const char *user_key, int key_len, std::list<RID> &rids)
+{
+  string attr(file_header_.attr_length, '\0');
+  normalize_key(user_key, key_len, attr.data());
+  const uint32_t hash_value = hash(attr.data());
+
+  lock_.lock_shared();
+  RC rc = RC::SUCCESS;
+  PageNum page_num = directory_[directory_index(hash_value)];
+  while (page_num != BP_INVALID_PAGE_NUM) {
+    Frame *frame = nullptr;
+    rc = disk_buffer_pool_->get_this_page(page_num, &frame);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to fetch bucket page. page num=%d, rc=%s", page_num, strrc(rc));
+      break;
+    }
+
+    HashBucketNode *bucket = reinterpret_cast<HashBucketNode *>(frame->data());
+    for (int i = 0; i < bucket->key_num; i++) {
+      const char *item = item_at(bucket, i);
+      if (memcmp(item, attr.data(), file_header_.attr_length) == 0) {
+        RID rid;
+        memcpy(&rid, item + file_header_.attr_length, sizeof(rid));
+        rids.push_back(rid);
+      }
+    }
+
+    page_num = bucket->overflow_page;
+    disk_buffer_pool_->unpin_page(frame);
+  }
+  lock_.unlock_shared();
+  return rc;
+}
+
+void ExtendibleHashHandler::normalize_key(const char *user_key, int key_len, char *attr) const
+{
+  const int attr_length = file_header_.attr_length;
+  memset(attr, 0, attr_length);
+  switch (file_header_.attr_type) {
+    case CHARS: {
+      const int length = std::min(key_len, attr_length);
+      for (int i = 0; i < length && user_key[i] != '\0'; i++) {
+        attr[i] = user_key[i];
+      }
+    } break;
+    default: {
+      memcpy(attr, user_key, attr_length);
+    } break;
+  }
+}
+
+uint32_t ExtendibleHashHandler::hash(const char *attr) const
+{
+  // FNV-1a，最后再把高位混合到低位，因为目录使用的是哈希值的低位
+  uint32_t hash_value = 2166136261U;
+  for (int i = 0; i < file_header_.attr_length; i++) {
+    hash_value ^= static_cast<uint8_t>(attr[i]);
+    hash_value *= 16777619U;
+  }
+  hash_value ^= hash_value >> 16;
+  hash_value *= 0x85ebca6bU;
+  hash_value ^= hash_value >> 13;
+  hash_value *= 0xc2b2ae35U;
+  hash_value ^= hash_value >> 16;
+  return hash_value;
+}
+
+int ExtendibleHashHandler::directory_index(uint32_t hash_value) const
+{
+  return static_cast<int>(hash_value & ((1U << file_header_.global_depth) - 1));
+}
+
+int ExtendibleHashHandler::item_size() const
+{
+  return file_header_.key_length;
+}
+
+char *ExtendibleHashHandler::item_at(HashBucketNode *bucket, int index) const
+{
+  return bucket->array + index * item_size();
+}
+
+RC ExtendibleHashHandler::contains(PageNum bucket_page, const char *key, bool &found)
+{
+  // 唯一索引只要属性值相同就认为是重复的
+  const int compare_length = file_header_.is_unique ? file_header_.attr_length : item_size();
+  found = false;
+
+  PageNum page_num = bucket_page;
+  while (!found && page_num != BP_INVALID_PAGE_NUM) {
+    Frame *frame = nullptr;
+    RC rc = disk_buffer_pool_->get_this_page(page_num, &frame);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to fetch bucket page. page num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+
+    HashBucketNode *bucket = reinterpret_cast<HashBucketNode *>(frame->data());
+    for (int i = 0; i < bucket->key_num && !found; i++) {
+      found = memcmp(item_at(bucket, i), key, compare_length) == 0;
+    }
+    page_num = bucket->overflow_page;
+    disk_buffer_pool_->unpin_page(frame);
+  }
+  return RC::SUCCESS;
+}
+
+RC ExtendibleHashHandler::check_bucket(PageNum bucket_page, uint32_t hash_value, bool &has_space, bool &same_hash)
+{
+  has_space = false;
+  same_hash = true;
+
+  PageNum page_num = bucket_page;
+  while (page_num != BP_INVALID_PAGE_NUM) {
+    Frame *frame = nullptr;
+    RC rc = disk_buffer_pool_->get_this_page(page_num, &frame);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to fetch bucket page. page num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+
+    HashBucketNode *bucket = reinterpret_cast<HashBucketNode *>(frame->data());
+    if (bucket->key_num < file_header_.bucket_capacity) {
+      has_space = true;
+    }
+    for (int i = 0; i < bucket->key_num && same_hash; i++) {
+      same_hash = hash(item_at(bucket, i)) == hash_value;
+    }
+    page_num = bucket->overflow_page;
+    disk_buffer_pool_->unpin_page(frame);
+  }
+  return RC::SUCCESS;
+}
+
+RC ExtendibleHashHandler::append_item(PageNum bucket_page, const char *item)
+{
+  PageNum page_num = bucket_page;
+  while (true) {
+    Frame *frame = nullptr;
+    RC rc = disk_buffer_pool_->get_this_page(page_num, &frame);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to fetch bucket page. page num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+
+    HashBucketNode *bucket = reinterpret_cast<HashBucketNode *>(frame->data());
+    if (bucket->key_num < file_header_.bucket_capacity) {
+      memcpy(item_at(bucket, bucket->key_num), item, item_size());
+      bucket->key_num++;
+      frame->mark_dirty();
+      disk_buffer_pool_->unpin_page(frame);
+      return RC::SUCCESS;
+    }
+
+    if (bucket->overflow_page == BP_INVALID_PAGE_NUM) {
+      Frame *overflow_frame = nullptr;
+      rc = disk_buffer_pool_->allocate_page(&overflow_frame);
+      if (rc != RC::SUCCESS) {
+        LOG_WARN("failed to allocate overflow page. rc=%s", strrc(rc));
+        disk_buffer_pool_->unpin_page(frame);
+        return rc;
+      }
+      init_bucket(overflow_frame, bucket->local_depth);
+      overflow_frame->mark_dirty();
+      bucket->overflow_page = overflow_frame->page_num();
+      frame->mark_dirty();
+      disk_buffer_pool_->unpin_page(overflow_frame);
+    }
+
+    page_num = bucket->overflow_page;
+    disk_buffer_pool_->unpin_page(frame);
+  }
+  return RC::SUCCESS;
+}
+
+RC ExtendibleHashHandler::write_header()
+{
+  Frame *frame = nullptr;
+  RC rc = disk_buffer_pool_->get_this_page(FIRST_INDEX_PAGE, &frame);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to fetch header page of hash index. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  memcpy(frame->data(), &file_header_, sizeof(file_header_));
+  frame->mark_dirty();
+  disk_buffer_pool_->unpin_page(frame);
+  return RC::SUCCESS;
+}
+
+RC ExtendibleHashHandler::load_directory()
+{
+  const int directory_size = 1 << file_header_.global_depth;
+  directory_.resize(directory_size);
+  for (int page_index = 0; page_index < file_header_.directory_page_count; page_index++) {
+    Frame *frame = nullptr;
+    RC rc = disk_buffer_pool_->get_this_page(file_header_.directory_pages[page_index], &frame);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to fetch directory page. page num=%d, rc=%s",
+               file_header_.directory_pages[page_index], strrc(rc));
+      return rc;
+    }
+
+    const int begin = page_index * DIRECTORY_ENTRIES_PER_PAGE;
+    const int end = std::min(directory_size, begin + DIRECTORY_ENTRIES_PER_PAGE);
+    if (begin < end) {
+      memcpy(directory_.data() + begin, frame->data(), (end - begin) * sizeof(PageNum));
+    }
+    disk_buffer_pool_->unpin_page(frame);
+  }
+  return RC::SUCCESS;
+}
+
+RC ExtendibleHashHandler::write_directory_entry(int index)
+{
+  const int page_index = index / DIRECTORY_ENTRIES_PER_PAGE;
+  Frame *frame = nullptr;
+  RC rc = disk_buffer_pool_->get_this_page(file_header_.directory_pages[page_index], &frame);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to fetch directory page. page num=%d, rc=%s",
+             file_header_.directory_pages[page_index], strrc(rc));
+    return rc;
+  }
+
+  PageNum *entries = reinterpret_cast<PageNum *>(frame->data());
+  entries[index % DIRECTORY_ENTRIES_PER_PAGE] = directory_[index];
+  frame->mark_dirty();
+  disk_buffer_pool_->unpin_page(frame);
+  return RC::SUCCESS;
+}
+
+RC ExtendibleHashHandler::double_directory()
+{
+  if (file_header_.global_depth >= MAX_DEPTH) {
+    LOG_WARN("the directory of hash index is too large. global depth=%d", file_header_.global_depth);
+    return RC::INTERNAL;
+  }
+
+  RC rc = RC::SUCCESS;
+  const int old_size = static_cast<int>(directory_.size());
+  const int new_size = old_size * 2;
+  const int page_count = (new_size + DIRECTORY_ENTRIES_PER_PAGE - 1) / DIRECTORY_ENTRIES_PER_PAGE;
+  while (file_header_.directory_page_count < page_count) {
+    Frame *frame = nullptr;
+    rc = disk_buffer_pool_->allocate_page(&frame);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to allocate directory page. rc=%s", strrc(rc));
+      return rc;
+    }
+    file_header_.directory_pages[file_header_.directory_page_count++] = frame->page_num();
+    frame->mark_dirty();
+    disk_buffer_pool_->unpin_page(frame);
+  }
+
+  // 新增加的一半与原来的一半指向相同的桶
+  directory_.resize(new_size);
+  std::copy(directory_.begin(), directory_.begin() + old_size, directory_.begin() + old_size);
+
+  for (int page_index = old_size / DIRECTORY_ENTRIES_PER_PAGE; page_index < page_count; page_index++) {
+    Frame *frame = nullptr;
+    rc = disk_buffer_pool_->get_this_page(file_header_.directory_pages[page_index], &frame);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to fetch directory page. page num=%d, rc=%s",
+               file_header_.directory_pages[page_index], strrc(rc));
+      return rc;
+    }
+
+    const int page_begin = page_index * DIRECTORY_ENTRIES_PER_PAGE;
+    const int begin = std::max(old_size, page_begin);
+    const int end = std::min(new_size, page_begin + DIRECTORY_ENTRIES_PER_PAGE);
+    memcpy(frame->data() + (begin - page_begin) * sizeof(PageNum),
+           directory_.data() + begin,
+           (end - begin) * sizeof(PageNum));
+    frame->mark_dirty();
+    disk_buffer_pool_->unpin_page(frame);
+  }
+
+  file_header_.global_depth++;
+  LOG_DEBUG("double the directory of hash index. global depth=%d", file_header_.global_depth);
+  return write_header();
+}
+
+RC ExtendibleHashHandler::split_bucket(int index)
+{
+  const PageNum old_page = directory_[index];
+  Frame *frame = nullptr;
+  RC rc = disk_buffer_pool_->get_this_page(old_page, &frame);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to fetch bucket page. page num=%d, rc=%s", old_page, strrc(rc));
+    return rc;
+  }
+
+  const int local_depth = reinterpret_cast<HashBucketNode *>(frame->data())->local_depth;
+  disk_buffer_pool_->unpin_page(frame);
+  if (local_depth == file_header_.global_depth) {
+    rc = double_directory();
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+
+  // 取出桶中所有的数据项，溢出页清空后留在原来的桶中继续使用
+  string items;
+  PageNum page_num = old_page;
+  while (page_num != BP_INVALID_PAGE_NUM) {
+    Frame *page_frame = nullptr;
+    rc = disk_buffer_pool_->get_this_page(page_num, &page_frame);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to fetch bucket page. page num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+    HashBucketNode *page_bucket = reinterpret_cast<HashBucketNode *>(page_frame->data());
+    items.append(page_bucket->array, page_bucket->key_num * item_size());
+    page_bucket->key_num = 0;
+    page_bucket->local_depth = local_depth + 1;
+    page_frame->mark_dirty();
+    page_num = page_bucket->overflow_page;
+    disk_buffer_pool_->unpin_page(page_frame);
+  }
+
+  Frame *new_frame = nullptr;
+  rc = disk_buffer_pool_->allocate_page(&new_frame);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to allocate bucket page. rc=%s", strrc(rc));
+    return rc;
+  }
+  init_bucket(new_frame, local_depth + 1);
+  const PageNum new_page = new_frame->page_num();
+  new_frame->mark_dirty();
+  disk_buffer_pool_->unpin_page(new_frame);
+
+  // 目录中所有指向原来的桶、并且第 local_depth 位是1的项，改为指向新的桶
+  const uint32_t split_bit = 1U << local_depth;
+
+  const uint32_t low_bits = static_cast<uint32_t>(index) & (split_bit - 1);
+  for (uint32_t i = low_bits | split_bit; i < directory_.size(); i += split_bit << 1) {
+    directory_[i] = new_page;
+    rc = write_directory_entry(static_cast<int>(i));
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+
+  const int item_num = static_cast<int>(items.size()) / item_size();
+  for (int i = 0; i < item_num && rc == RC::SUCCESS; i++) {
+    const char *item = items.data() + i * item_size();
+    rc = append_item((hash(item) & split_bit) ? new_page : old_page, item);
+  }
+  return rc;
+}
@@ -0,0 +1,182 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <string.h>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/rc.h"
+#include "common/lang/mutex.h"
+#include "sql/parser/parse_defs.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/record/record.h"
+
+/**
+ * @defgroup ExtendibleHash 可扩展哈希
+ * @ingroup Index
+ * @details 基于 DiskBufferPool 页面的可扩展哈希(extendible hashing)，只支持等值查找。
+ * 目录(directory)是一个页号数组，使用键值哈希值的低 global_depth 位定位到一个桶(bucket)，
+ * 每个桶占用一个页面，并记录自己的 local_depth。桶满了以后分裂成两个，如果 local_depth 已经等于
+ * global_depth，就先把目录扩大一倍。桶中的键值哈希值都相同(比如非唯一索引中大量重复的值)，
+ * 或者 local_depth 达到 MAX_DEPTH 时，分裂没有意义，这时使用溢出页。删除时不合并桶。
+ * 目录在打开文件时加载到内存中，查找一次只需要访问一个桶页面(没有溢出页时)。
+ */
+
+/**
+ * @brief 可扩展哈希的元数据，放在文件的第一个页面
+ * @ingroup ExtendibleHash
+ * @code
+ * storage format:
+ * | attr length | key length | attr type | global depth | bucket capacity | directory page count | is unique |
+ * | directory page 0 | directory page 1 | ... |
+ * @endcode
+ */
+struct HashIndexFileHeader
+{
+  static constexpr int MAX_DIRECTORY_PAGES = 64;
+
+  HashIndexFileHeader()
+  {
+    memset(this, 0, sizeof(HashIndexFileHeader));
+  }
+
+  int32_t  attr_length;           ///< 键值的长度
+  int32_t  key_length;            ///< attr length + sizeof(RID)
+  AttrType attr_type;             ///< 键值的类型
+  int32_t  global_depth;          ///< 目录的大小是 2^global_depth
+  int32_t  bucket_capacity;       ///< 每个桶页面最多容纳的数据项
+  int32_t  directory_page_count;  ///< 目录占用的页面数
+  int32_t  is_unique;             ///< 是否是唯一索引
+  PageNum  directory_pages[MAX_DIRECTORY_PAGES];
+
+  const std::string to_string() const
+  {
+    std::stringstream ss;
+
+    ss << "attr_length:" << attr_length << ","
+       << "key_length:" << key_length << ","
+       << "attr_type:" << attr_type << ","
+       << "global_depth:" << global_depth << ","
+       << "bucket_capacity:" << bucket_capacity << ","
+       << "directory_page_count:" << directory_page_count << ","
+       << "is_unique:" << is_unique << ";";
+
+    return ss.str();
+  }
+};
+
+/**
+ * @brief 桶页面
+ * @ingroup ExtendibleHash
+ * @code
+ * storage format:
+ * | local depth | item number | overflow page id |
+ * | attr0, rid0 | attr1, rid1 | ... | attrn, ridn |
+ * @endcode
+ * 桶内的数据项是无序的，删除时用最后一个数据项填补空位。
+ */
+struct HashBucketNode
+{
+  static constexpr int HEADER_SIZE = 12;
+
+  int32_t local_depth;
+  int32_t key_num;
+  PageNum overflow_page;  ///< 同一个桶的下一个溢出页，没有时是 BP_INVALID_PAGE_NUM
+  char    array[0];
+};
+
+/**
+ * @brief 可扩展哈希的实现
+ * @ingroup ExtendibleHash
+ */
+class ExtendibleHashHandler
+{
+public:
+  /// 桶分裂时使用的哈希位数上限，也决定了目录的最大大小
+  static constexpr int MAX_DEPTH = 16;
+
+public:
+  ExtendibleHashHandler() = default;
+  ~ExtendibleHashHandler();
+
+  /**
+   * @brief 创建索引文件
+   * @param bucket_capacity 每个桶最多容纳的数据项，小于0时使用一个页面能够容纳的数量。测试时使用
+   */
+  RC create(const char *file_name, AttrType attr_type, int attr_length, bool is_unique, int bucket_capacity = -1);
+  RC open(const char *file_name);
+  RC close();
+  RC sync();
+
+  /**
+   * @brief 插入一个键值对。user_key 是记录中的属性值
+   * @return 相同的属性值和RID已经存在，或者唯一索引中已经存在相同的属性值时，返回 RECORD_DUPLICATE_KEY
+   */
+  RC insert_entry(const char *user_key, const RID *rid);
+
+  /**
+   * @brief 删除一个键值对。不存在时返回 RECORD_NOT_EXIST
+   */
+  RC delete_entry(const char *user_key, const RID *rid);
+
+  /**
+   * @brief 获取与指定属性值相等的所有RID
+   * @param key_len user_key 的长度。对于CHARS类型，user_key 可以比属性短
+   */
+  RC get_entry(const char *user_key, int key_len, std::list<RID> &rids);
+
+  const HashIndexFileHeader &file_header() const { return file_header_; }
+
+private:
+  /**
+   * @brief 将属性值转换成哈希和比较使用的格式
+   * @details 字符串在第一个'\0'之后的内容都置为0，与 compare_string 一样只比较'\0'之前的内容，这样相等的值有相同的字节。
+   * 浮点数按照 EPSILON 比较，不能用作哈希索引的键值。
+   */
+  void normalize_key(const char *user_key, int key_len, char *attr) const;
+  uint32_t hash(const char *attr) const;
+  int      directory_index(uint32_t hash_value) const;
+
+  int   item_size() const;
+  char *item_at(HashBucketNode *bucket, int index) const;
+
+  /**
+   * @brief 在桶(包括溢出页)中查找键值。唯一索引只比较属性值
+   */
+  RC contains(PageNum bucket_page, const char *key, bool &found);
+
+  /**
+   * @brief 桶(包括溢出页)中是否还有空位，以及桶中的数据项与新键值的哈希值是否都相同
+   * @details 哈希值都相同时，分裂也无法把它们分开，只能使用溢出页
+   */
+  RC check_bucket(PageNum bucket_page, uint32_t hash_value, bool &has_space, bool &same_hash);
+
+  /**
+   * @brief 将数据项放到桶中第一个有空位的页面，都满了就增加一个溢出页
+   */
+  RC append_item(PageNum bucket_page, const char *item);
+
+  RC write_header();
+  RC load_directory();
+  RC write_directory_entry(int index);
+  RC double_directory();
+  RC split_bucket(int index);
+
+private:
+  DiskBufferPool      *disk_buffer_pool_ = nullptr;
+  HashIndexFileHeader  file_header_;
+  std::vector<PageNum> directory_;  ///< 目录在内存中的副本，修改时同步写到目录页面
+
+  common::SharedMutex lock_;  ///< 写操作互斥，读操作共享
+};
@@ -0,0 +1,145 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/index/hash_index.h"
+#include "common/log/log.h"
+
+HashIndex::~HashIndex() noexcept
+{
+  close();
+}
+
+RC HashIndex::create(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta, const bool &is_unique)
+{
+  if (inited_) {
+    LOG_WARN("Failed to create index due to the index has been created before. file_name:%s, index:%s, field:%s",
+        file_name, index_meta.name(), index_meta.field());
+    return RC::RECORD_OPENNED;
+  }
+
+  Index::init(index_meta, field_meta);
+
+  RC rc = index_handler_.create(file_name, field_meta.type(), field_meta.len(), is_unique);
+  if (RC::SUCCESS != rc) {
+    LOG_WARN("Failed to create hash handler, file_name:%s, index:%s, field:%s, rc:%s",
+        file_name, index_meta.name(), index_meta.field(), strrc(rc));
+    return rc;
+  }
+
+  inited_ = true;
+  LOG_INFO("Successfully create hash index, file_name:%s, index:%s, field:%s, is_unique:%s",
+      file_name, index_meta.name(), index_meta.field(), (is_unique ? "true" : "false"));
+  return RC::SUCCESS;
+}
+
+RC HashIndex::open(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+{
+  if (inited_) {
+    LOG_WARN("Failed to open index due to the index has been inited before. file_name:%s, index:%s, field:%s",
+        file_name, index_meta.name(), index_meta.field());
+    return RC::RECORD_OPENNED;
+  }
+
+  Index::init(index_meta, field_meta);
+
+  RC rc = index_handler_.open(file_name);
+  if (RC::SUCCESS != rc) {
+    LOG_WARN("Failed to open hash handler, file_name:%s, index:%s, field:%s, rc:%s",
+        file_name, index_meta.name(), index_meta.field(), strrc(rc));
+    return rc;
+  }
+
+  inited_ = true;
+  LOG_INFO("Successfully open hash index, file_name:%s, index:%s, field:%s",
+      file_name, index_meta.name(), index_meta.field());
+  return RC::SUCCESS;
+}
+
+RC HashIndex::close()
+{
+  if (inited_) {
+    LOG_INFO("Begin to close hash index, index:%s, field:%s", index_meta_.name(), index_meta_.field());
+    index_handler_.close();
+    inited_ = false;
+  }
+  return RC::SUCCESS;
+}
+
+RC HashIndex::insert_entry(const char *record, const RID *rid)
+{
+  return index_handler_.insert_entry(record + field_meta_.offset(), rid);
+}
+
+RC HashIndex::delete_entry(const char *record, const RID *rid)
+{
+  return index_handler_.delete_entry(record + field_meta_.offset(), rid);
+}
+
+IndexScanner *HashIndex::create_scanner(
+    const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len, bool right_inclusive)
+{
+  if (left_key == nullptr || right_key == nullptr || !left_inclusive || !right_inclusive || left_len != right_len ||
+      memcmp(left_key, right_key, left_len) != 0) {
+    LOG_WARN("hash index only supports equality scan. index:%s", index_meta_.name());
+    return nullptr;
+  }
+
+  HashIndexScanner *index_scanner = new HashIndexScanner(index_handler_);
+  RC rc = index_scanner->open(left_key, left_len);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to open hash index scanner. rc=%d:%s", rc, strrc(rc));
+    delete index_scanner;
+    return nullptr;
+  }
+  return index_scanner;
+}
+
+RC HashIndex::sync()
+{
+  return index_handler_.sync();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+HashIndexScanner::HashIndexScanner(ExtendibleHashHandler &hash_handler) : hash_handler_(hash_handler)
+{}
+
+RC HashIndexScanner::open(const char *key, int key_len)
+{
+  return hash_handler_.get_entry(key, key_len, rids_);
+}
+
+RC HashIndexScanner::rescan(
+    const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len, bool right_inclusive)
+{
+  rids_.clear();
+  if (left_key == nullptr || right_key == nullptr || !left_inclusive || !right_inclusive || left_len != right_len ||
+      memcmp(left_key, right_key, left_len) != 0) {
+    LOG_WARN("hash index scanner only supports equality scan");
+    return RC::SUCCESS;
+  }
+  return open(left_key, left_len);
+}
+
+RC HashIndexScanner::next_entry(RID *rid)
+{
+  if (rids_.empty()) {
+    return RC::RECORD_EOF;
+  }
+
+  *rid = rids_.front();
+  rids_.pop_front();
+  return RC::SUCCESS;
+}
+
+RC HashIndexScanner::destroy()
+{
+  delete this;
+  return RC::SUCCESS;
+}
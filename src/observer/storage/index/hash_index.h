@@ -0,0 +1,75 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <list>
+
+#include "storage/index/index.h"
+#include "storage/index/extendible_hash.h"
+
+/**
+ * @brief 哈希索引
+ * @ingroup Index
+ * @details 只支持等值查询，范围查询需要使用B+树索引
+ */
+class HashIndex : public Index
+{
+public:
+  HashIndex() = default;
+  virtual ~HashIndex() noexcept;
+
+  RC create(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta, const bool &is_unique);
+  RC open(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta);
+  RC close() override;
+
+  RC insert_entry(const char *record, const RID *rid) override;
+  RC delete_entry(const char *record, const RID *rid) override;
+
+  /**
+   * @brief 创建等值扫描器
+   * @details 左右边界必须相同并且都是闭区间，否则返回空
+   */
+  IndexScanner *create_scanner(const char *left_key, int left_len, bool left_inclusive, const char *right_key,
+      int right_len, bool right_inclusive) override;
+
+  RC sync() override;
+
+private:
+  bool inited_ = false;
+  ExtendibleHashHandler index_handler_;
+};
+
+/**
+ * @brief 哈希索引扫描器
+ * @ingroup Index
+ * @details 打开时就取出所有匹配的RID，之后不再访问索引文件
+ */
+class HashIndexScanner : public IndexScanner
+{
+public:
+  HashIndexScanner(ExtendibleHashHandler &hash_handler);
+  ~HashIndexScanner() noexcept override = default;
+
+  RC open(const char *key, int key_len);
+
+  RC next_entry(RID *rid) override;
+  RC destroy() override;
+
+  /**
+   * @brief 只支持等值扫描，其它范围返回空的结果
+   */
+  RC rescan(const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len,
+      bool right_inclusive) override;
+
+private:
+  ExtendibleHashHandler &hash_handler_;
+  std::list<RID>         rids_;
+};
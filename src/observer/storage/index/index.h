@@ -45,6 +45,11 @@ public:
     return index_meta_;
   }
 
+  const FieldMeta &field_meta() const
+  {
+    return field_meta_;
+  }
+
   /**
    * @brief 插入一条数据
    * 
@@ -80,6 +85,11 @@ public:
    */
   virtual RC sync() = 0;
 
+  /**
+   * @brief 关闭索引文件
+   */
+  virtual RC close() = 0;
+
 protected:
   RC init(const IndexMeta &index_meta, const FieldMeta &field_meta);
 
@@ -104,4 +114,20 @@ public:
    */
   virtual RC next_entry(RID *rid) = 0;
   virtual RC destroy() = 0;
+
+  /**
+   * @brief 使用新的边界重新扫描，复用扫描器已经持有的资源
+   * @details 参数与 Index::create_scanner 相同。不支持的扫描器返回 UNIMPLENMENT，调用方需要重新创建扫描器
+   */
+  virtual RC rescan(const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len,
+      bool right_inclusive)
+  {
+    return RC::UNIMPLENMENT;
+  }
+
+  /**
+   * @brief 释放扫描器持有的索引页面的锁，之后的 next_entry 从上次返回的数据之后继续扫描
+   * @details 调用者等待其它资源(比如行锁)之前调用，不能持有索引页面的锁等待。没有持有锁的扫描器不需要做什么
+   */
+  virtual RC suspend() { return RC::SUCCESS; }
 };
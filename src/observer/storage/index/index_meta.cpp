@@ -21,8 +21,12 @@ See the Mulan PSL v2 for more details. */
 
 const static Json::StaticString FIELD_NAME("name");
 const static Json::StaticString FIELD_FIELD_NAME("field_name");
+const static Json::StaticString FIELD_PREFIX_COMPRESSION("prefix_compression");
+const static Json::StaticString FIELD_TYPE("type");
+const static char *const HASH_INDEX_TYPE_NAME = "hash";
 
-RC IndexMeta::init(const char *name, const FieldMeta &field)
+RC IndexMeta::init(const char *name, const FieldMeta &field, IndexType index_type /* = BPLUS_TREE_INDEX */,
+                   bool prefix_compression /* = false */)
 {
   if (common::is_blank(name)) {
     LOG_ERROR("Failed to init index, name is empty.");
@@ -31,6 +35,8 @@ RC IndexMeta::init(const char *name, const FieldMeta &field)
 
   name_ = name;
   field_ = field.name();
+  index_type_ = index_type;
+  prefix_compression_ = prefix_compression;
   return RC::SUCCESS;
 }
 
@@ -38,6 +44,12 @@ void IndexMeta::to_json(Json::Value &json_value) const
 {
   json_value[FIELD_NAME] = name_;
   json_value[FIELD_FIELD_NAME] = field_;
+  if (index_type_ == HASH_INDEX) {
+    json_value[FIELD_TYPE] = HASH_INDEX_TYPE_NAME;
+  }
+  if (prefix_compression_) {
+    json_value[FIELD_PREFIX_COMPRESSION] = prefix_compression_;
+  }
 }
 
 RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, IndexMeta &index)
@@ -62,7 +74,12 @@ RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, I
     return RC::SCHEMA_FIELD_MISSING;
   }
 
-  return index.init(name_value.asCString(), *field);
+  const Json::Value &prefix_compression_value = json_value[FIELD_PREFIX_COMPRESSION];
+  const bool prefix_compression = prefix_compression_value.isBool() && prefix_compression_value.asBool();
+  const Json::Value &type_value = json_value[FIELD_TYPE];
+  const IndexType index_type =
+      (type_value.isString() && 0 == strcmp(type_value.asCString(), HASH_INDEX_TYPE_NAME)) ? HASH_INDEX : BPLUS_TREE_INDEX;
+  return index.init(name_value.asCString(), *field, index_type, prefix_compression);
 }
 
 const char *IndexMeta::name() const
@@ -75,7 +92,23 @@ const char *IndexMeta::field() const
   return field_.c_str();
 }
 
+IndexType IndexMeta::index_type() const
+{
+  return index_type_;
+}
+
+bool IndexMeta::prefix_compression() const
+{
+  return prefix_compression_;
+}
+
 void IndexMeta::desc(std::ostream &os) const
 {
   os << "index name=" << name_ << ", field=" << field_;
+  if (index_type_ == HASH_INDEX) {
+    os << ", using hash";
+  }
+  if (prefix_compression_) {
+    os << ", prefix compression";
+  }
 }
\ No newline at end of file
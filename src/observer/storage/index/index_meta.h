@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 
 #include <string>
 #include "common/rc.h"
+#include "sql/parser/parse_defs.h"
 
 class TableMeta;
 class FieldMeta;
@@ -28,18 +29,21 @@ class Value;
  * @brief 描述一个索引
  * @ingroup Index
  * @details 一个索引包含了表的哪些字段，索引的名称等。
- * 如果以后实现了多种类型的索引，还需要记录索引的类型，对应类型的一些元数据等
+ * 索引的类型默认是B+树，也可以是哈希索引
  */
 class IndexMeta 
 {
 public:
   IndexMeta() = default;
 
-  RC init(const char *name, const FieldMeta &field);
+  RC init(const char *name, const FieldMeta &field, IndexType index_type = BPLUS_TREE_INDEX,
+          bool prefix_compression = false);
 
 public:
   const char *name() const;
   const char *field() const;
+  IndexType index_type() const;
+  bool prefix_compression() const;
 
   void desc(std::ostream &os) const;
 
@@ -50,4 +54,6 @@ public:
 protected:
   std::string name_;   // index's name
   std::string field_;  // field's name
+  IndexType index_type_ = BPLUS_TREE_INDEX;  // 索引的类型
+  bool prefix_compression_ = false;  // 索引节点是否使用前缀压缩
 };
@@ -126,10 +126,17 @@ public:
     return *this;
   }
 
+  /**
+   * @brief 指向外部的数据(比如页面上的记录)，之前自己持有的数据会被释放
+   */
   void set_data(char *data, int len = 0)
   {
-    this->data_ = data;
-    this->len_  = len;
+    if (owner_ && data_ != nullptr && data_ != data) {
+      free(data_);
+    }
+    this->data_  = data;
+    this->len_   = len;
+    this->owner_ = false;
   }
   void set_data_owner(char *data, int len)
   {
@@ -11,6 +11,8 @@ See the Mulan PSL v2 for more details. */
 //
 // Created by Meiyi & Longda on 2021/4/13.
 //
+#include <cinttypes>
+
 #include "storage/record/record_manager.h"
 #include "common/log/log.h"
 #include "common/lang/bitmap.h"
@@ -283,8 +285,20 @@ PageNum RecordPageHandler::get_page_num() const
   return frame_->page_num();
 }
 
+LSN RecordPageHandler::page_lsn() const { return frame_->lsn(); }
+
+void RecordPageHandler::update_page_lsn(LSN lsn)
+{
+  if (lsn > frame_->lsn()) {
+    frame_->set_lsn(lsn);
+  }
+  frame_->mark_dirty();
+}
+
 bool RecordPageHandler::is_full() const { return page_header_->record_num >= page_header_->record_capacity; }
 
+int32_t RecordPageHandler::record_num() const { return page_header_->record_num; }
+
 ////////////////////////////////////////////////////////////////////////////////
 
 RecordFileHandler::~RecordFileHandler() { this->close(); }
@@ -297,6 +311,7 @@ RC RecordFileHandler::init(DiskBufferPool *buffer_pool)
   }
 
   disk_buffer_pool_ = buffer_pool;
+  record_num_       = 0;
 
   RC rc = init_free_pages();
 
@@ -337,9 +352,11 @@ RC RecordFileHandler::init_free_pages()
     if (!record_page_handler.is_full()) {
       free_pages_.insert(current_page_num);
     }
+    record_num_ += record_page_handler.record_num();
     record_page_handler.cleanup();
   }
-  LOG_INFO("record file handler init free pages done. free page num=%d, rc=%s", free_pages_.size(), strrc(rc));
+  LOG_INFO("record file handler init free pages done. free page num=%d, record num=%" PRId64 ", rc=%s",
+           free_pages_.size(), record_num_.load(), strrc(rc));
   return rc;
 }
 
@@ -405,22 +422,38 @@ RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
   }
 
   // 找到空闲位置
-  return record_page_handler.insert_record(data, rid);
+  ret = record_page_handler.insert_record(data, rid);
+  if (OB_SUCC(ret)) {
+    record_num_++;
+  }
+  return ret;
 }
 
-RC RecordFileHandler::recover_insert_record(const char *data, int record_size, const RID &rid)
+RC RecordFileHandler::recover_insert_record(const char *data, int record_size, const RID &rid, LSN lsn, bool &applied)
 {
-  RC ret = RC::SUCCESS;
+  applied = false;
 
   RecordPageHandler record_page_handler;
+  RC rc = record_page_handler.recover_init(*disk_buffer_pool_, rid.page_num);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init record page handler. page num=%d, rc=%s", rid.page_num, strrc(rc));
+    return rc;
+  }
 
-  ret = record_page_handler.recover_init(*disk_buffer_pool_, rid.page_num);
-  if (ret != RC::SUCCESS) {
-    LOG_WARN("failed to init record page handler. page num=%d, rc=%s", rid.page_num, strrc(ret));
-    return ret;
+  if (record_page_handler.page_lsn() >= lsn) {
+    LOG_TRACE("skip redo insert record. rid=%s, page lsn=%" PRId64 ", lsn=%" PRId64,
+              rid.to_string().c_str(), record_page_handler.page_lsn(), lsn);
+    return RC::SUCCESS;
   }
 
-  return record_page_handler.recover_insert_record(data, rid);
+  const int32_t old_record_num = record_page_handler.record_num();
+  rc = record_page_handler.recover_insert_record(data, rid);
+  if (OB_SUCC(rc)) {
+    record_page_handler.update_page_lsn(lsn);
+    record_num_ += record_page_handler.record_num() - old_record_num;
+    applied = true;
+  }
+  return rc;
 }
 
 RC RecordFileHandler::delete_record(const RID *rid)
@@ -439,6 +472,7 @@ RC RecordFileHandler::delete_record(const RID *rid)
   // insert record是加上 record manager锁，然后拿到指定页面锁再释放record manager锁
   page_handler.cleanup();
   if (OB_SUCC(rc)) {
+    record_num_--;
     // 因为这里已经释放了页面锁，并发时，其它线程可能又把该页面填满了，那就不应该再放入 free_pages_
     // 中。但是这里可以不关心，因为在查找空闲页面时，会自动过滤掉已经满的页面
     lock_.lock();
@@ -486,6 +520,93 @@ RC RecordFileHandler::visit_record(const RID &rid, bool readonly, std::function<
   return rc;
 }
 
+RC RecordFileHandler::modify_record(const RID &rid, LSN lsn, std::function<bool(Record &)> visitor)
+{
+  RecordPageHandler page_handler;
+
+  RC rc = page_handler.init(*disk_buffer_pool_, rid.page_num, false /*readonly*/);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init record page handler.page number=%d", rid.page_num);
+    return rc;
+  }
+
+  Record record;
+  rc = page_handler.get_record(&rid, &record);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get record from record page handle. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  if (visitor(record)) {
+    page_handler.update_page_lsn(lsn);
+  }
+  return rc;
+}
+
+RC RecordFileHandler::modify_records(PageNum page_num, const std::vector<SlotNum> &slots, LSN lsn,
+                                     std::function<bool(int, Record &)> visitor)
+{
+  RecordPageHandler page_handler;
+
+  RC rc = page_handler.init(*disk_buffer_pool_, page_num, false /*readonly*/);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init record page handler.page number=%d", page_num);
+    return rc;
+  }
+
+  // 先取出所有的记录再修改，不会出现修改了一部分记录后失败，页面却没有设置LSN、没有标记为脏页的情况
+  std::vector<Record> records(slots.size());
+  for (size_t i = 0; i < slots.size(); i++) {
+    RID rid(page_num, slots[i]);
+    rc = page_handler.get_record(&rid, &records[i]);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get record from record page handle. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+      return rc;
+    }
+  }
+
+  bool modified = false;
+  for (size_t i = 0; i < records.size(); i++) {
+    if (visitor(static_cast<int>(i), records[i])) {
+      modified = true;
+    }
+  }
+
+  if (modified) {
+    page_handler.update_page_lsn(lsn);
+  }
+  return rc;
+}
+
+RC RecordFileHandler::redo_modify_record(const RID &rid, LSN lsn, std::function<bool(Record &)> visitor)
+{
+  RecordPageHandler page_handler;
+
+  RC rc = page_handler.recover_init(*disk_buffer_pool_, rid.page_num);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init record page handler.page number=%d", rid.page_num);
+    return rc;
+  }
+
+  if (page_handler.page_lsn() >= lsn) {
+    LOG_TRACE("skip redo record. rid=%s, page lsn=%" PRId64 ", lsn=%" PRId64,
+              rid.to_string().c_str(), page_handler.page_lsn(), lsn);
+    return RC::SUCCESS;
+  }
+
+  Record record;
+  rc = page_handler.get_record(&rid, &record);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get record from record page handle. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  if (visitor(record)) {
+    page_handler.update_page_lsn(lsn);
+  }
+  return rc;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 RecordFileScanner::~RecordFileScanner() { close_scan(); }
@@ -574,18 +695,16 @@ RC RecordFileScanner::fetch_next_record_in_page()
       return rc;
     }
 
-    // 如果有过滤条件，就用过滤条件过滤一下
-    if (condition_filter_ != nullptr && !condition_filter_->filter(next_record_)) {
-      continue;
-    }
-
-    // 如果是某个事务上遍历数据，还要看看事务访问是否有冲突
-    if (trx_ == nullptr) {
-      return rc;
+    rc = visit_next_record();
+    if (rc == RC::LOCKED_NEED_WAIT) {
+      // 行锁被其它事务持有，释放页面的锁等待，拿到锁以后记录可能已经变化，重新检查
+      rc = wait_record_lock();
+      if (rc == RC::SUCCESS) {
+        rc = visit_next_record();
+      } else if (rc == RC::RECORD_NOT_EXIST) {
+        continue;
+      }
     }
-
-    // 让当前事务探测一下是否访问冲突，或者需要加锁、等锁等操作，由事务自己决定
-    rc = trx_->visit_record(table_, next_record_, readonly_);
     if (rc == RC::RECORD_INVISIBLE) {
       // 可以参考MvccTrx，表示当前记录不可见
       // 这种模式仅在 readonly 事务下是有效的
@@ -598,6 +717,45 @@ RC RecordFileScanner::fetch_next_record_in_page()
   return RC::RECORD_EOF;
 }
 
+RC RecordFileScanner::visit_next_record()
+{
+  // 如果有过滤条件，就用过滤条件过滤一下
+  if (condition_filter_ != nullptr && !condition_filter_->filter(next_record_)) {
+    return RC::RECORD_INVISIBLE;
+  }
+
+  // 如果是某个事务上遍历数据，还要看看事务访问是否有冲突
+  if (trx_ == nullptr) {
+    return RC::SUCCESS;
+  }
+
+  // 让当前事务探测一下是否访问冲突，或者需要加锁、等锁等操作，由事务自己决定
+  return trx_->visit_record(table_, next_record_, readonly_);
+}
+
+RC RecordFileScanner::wait_record_lock()
+{
+  const RID rid = next_record_.rid();
+  record_page_handler_.cleanup();
+
+  RC rc = trx_->lock_record(table_, rid);
+  if (OB_FAIL(rc)) {
+    // 页面已经释放，不能再继续遍历
+    next_record_.rid().slot_num = -1;
+    return rc;
+  }
+
+  rc = record_page_handler_.init(*disk_buffer_pool_, rid.page_num, readonly_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", rid.page_num, strrc(rc));
+    next_record_.rid().slot_num = -1;
+    return rc;
+  }
+
+  record_page_iterator_.init(record_page_handler_, rid.slot_num + 1);
+  return record_page_handler_.get_record(&rid, &next_record_);
+}
+
 RC RecordFileScanner::close_scan()
 {
   if (disk_buffer_pool_ != nullptr) {
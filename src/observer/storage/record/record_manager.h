@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 //
 #pragma once
 
+#include <atomic>
 #include <sstream>
 #include <limits>
 #include "storage/buffer/disk_buffer_pool.h"
@@ -194,11 +195,27 @@ public:
    */
   PageNum get_page_num() const;
 
+  /**
+   * @brief 页面上最后一次修改对应的日志结束位置
+   */
+  LSN page_lsn() const;
+
+  /**
+   * @brief 记录一次修改对应的日志位置，并把页面标记为脏页
+   * @details 页面LSN只会增大。lsn 不大于0时表示这次修改没有日志，只标记脏页
+   */
+  void update_page_lsn(LSN lsn);
+
   /**
    * @brief 当前页面是否已经没有空闲位置插入新的记录
    */
   bool is_full() const;
 
+  /**
+   * @brief 当前页面上记录的个数
+   */
+  int32_t record_num() const;
+
 protected:
   /**
    * @details 
@@ -277,12 +294,15 @@ public:
 
    /**
    * @brief 数据库恢复时，在指定文件指定位置插入数据
+   * @details 页面LSN不小于 lsn 时，页面中已经包含了这次插入，不做任何修改
    * 
    * @param data        记录内容
    * @param record_size 记录大小
    * @param rid         要插入记录的指定标识符
+   * @param lsn         插入日志的结束位置
+   * @param applied     返回是否在页面上重做了这次插入
    */
-  RC recover_insert_record(const char *data, int record_size, const RID &rid);
+  RC recover_insert_record(const char *data, int record_size, const RID &rid, LSN lsn, bool &applied);
 
   /**
    * @brief 获取指定文件中标识符为rid的记录内容到rec指向的记录结构中
@@ -305,6 +325,35 @@ public:
    */
   RC visit_record(const RID &rid, bool readonly, std::function<void(Record &)> visitor);
 
+  /**
+   * @brief 修改一条记录，并把描述这次修改的日志位置记录到页面上
+   * @details 页面刷盘之前，会先保证页面LSN之前的日志都已经持久化
+   * @param lsn     描述这次修改的日志结束位置
+   * @param visitor 修改记录的回调函数，返回false表示没有修改记录
+   */
+  RC modify_record(const RID &rid, LSN lsn, std::function<bool(Record &)> visitor);
+
+  /**
+   * @brief 修改同一个页面上的多条记录，页面只固定和加锁一次
+   * @param slots   要修改的记录，可以重复
+   * @param lsn     描述这些修改的日志结束位置，有记录被修改时记录到页面上
+   * @param visitor 按照 slots 的顺序访问每条记录，参数是记录在 slots 中的下标，返回false表示没有修改记录
+   */
+  RC modify_records(PageNum page_num, const std::vector<SlotNum> &slots, LSN lsn,
+                    std::function<bool(int, Record &)> visitor);
+
+  /**
+   * @brief 重做修改记录的日志
+   * @details 页面LSN不小于 lsn 时，说明这次修改已经在页面中了，不再调用 visitor，也不会把页面变成脏页
+   */
+  RC redo_modify_record(const RID &rid, LSN lsn, std::function<bool(Record &)> visitor);
+
+  /**
+   * @brief 文件中记录的个数，包括多版本并发控制中已经删除但还没有清理的记录
+   * @details 打开文件时根据每个页面头中的记录个数统计，之后随着插入、删除和重做更新
+   */
+  int64_t record_num() const { return record_num_.load(std::memory_order_relaxed); }
+
 private:
   /**
    * @brief 初始化当前没有填满记录的页面，初始化free_pages_成员
@@ -314,6 +363,7 @@ private:
 private:
   DiskBufferPool             *disk_buffer_pool_ = nullptr;
   std::unordered_set<PageNum> free_pages_;  ///< 没有填充满的页面集合
+  std::atomic<int64_t>        record_num_{0};  ///< 文件中记录的个数
   common::Mutex               lock_;        ///< 当编译时增加-DCONCURRENCY=ON 选项时，才会真正的支持并发
 };
 
@@ -370,6 +420,18 @@ private:
    */
   RC fetch_next_record_in_page();
 
+  /**
+   * @brief 过滤 next_record_，并让事务检查是否可以访问
+   * @return 被过滤掉时返回 RECORD_INVISIBLE，其它同 Trx::visit_record
+   */
+  RC visit_next_record();
+
+  /**
+   * @brief 释放当前页面的锁等待 next_record_ 上的行锁，拿到锁以后重新读取这条记录
+   * @details 页面的遍历从这条记录之后继续。记录在等待期间被删除时返回 RECORD_NOT_EXIST
+   */
+  RC wait_record_lock();
+
 private:
   // TODO 对于一个纯粹的record遍历器来说，不应该关心表和事务
   Table             *table_            = nullptr;  ///< 当前遍历的是哪张表。这个字段仅供事务函数使用，如果设计合适，可以去掉
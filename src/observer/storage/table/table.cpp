@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #include <limits.h>
 #include <string.h>
 #include <algorithm>
+#include <vector>
 
 #include "common/defs.h"
 #include "storage/table/table.h"
@@ -27,6 +28,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/common/meta_util.h"
 #include "storage/index/index.h"
 #include "storage/index/bplus_tree_index.h"
+#include "storage/index/hash_index.h"
 #include "storage/trx/trx.h"
 
 Table::~Table()
@@ -150,7 +152,7 @@ RC Table::destroy(const char *dir)
   for (int i = 0; i < index_num; i++) 
   {  
     // 清理所有的索引相关文件数据与索引元数据
-    ((BplusTreeIndex*)indexes_[i])->close();
+    indexes_[i]->close();
     const IndexMeta* index_meta = table_meta_.index(i);
     std::string index_path = table_index_file(dir, name(), index_meta->name());
     if(unlink(index_path.c_str()) != 0) 
@@ -201,9 +203,17 @@ RC Table::open(const char *meta_file, const char *base_dir)
       return RC::INTERNAL;
     }
 
-    BplusTreeIndex *index = new BplusTreeIndex();
+    Index *index = nullptr;
     std::string index_file = table_index_file(base_dir, name(), index_meta->name());
-    rc = index->open(index_file.c_str(), *index_meta, *field_meta);
+    if (index_meta->index_type() == HASH_INDEX) {
+      HashIndex *hash_index = new HashIndex();
+      rc = hash_index->open(index_file.c_str(), *index_meta, *field_meta);
+      index = hash_index;
+    } else {
+      BplusTreeIndex *bplus_tree_index = new BplusTreeIndex();
+      rc = bplus_tree_index->open(index_file.c_str(), *index_meta, *field_meta);
+      index = bplus_tree_index;
+    }
     if (rc != RC::SUCCESS) {
       delete index;
       LOG_ERROR("Failed to open index. table=%s, index=%s, file=%s, rc=%s",
@@ -230,8 +240,8 @@ RC Table::insert_record(Record &record)
   rc = insert_entry_of_indexes(record.data(), record.rid());
   if (rc != RC::SUCCESS) { // 可能出现了键值重复 
     RC rc2 = delete_entry_of_indexes(record.data(), record.rid(), false/*error_on_not_exists*/);
-    if (rc2 != RC::SUCCESS && rc != RC::INTERNAL) {
-      // INTERNAL是解题unique使用，如果不跳过这个if，后面会把错误信息输出到stdout
+    if (rc2 != RC::SUCCESS && rc != RC::RECORD_DUPLICATE_KEY) {
+      // 唯一索引键值重复时新记录的索引项不存在，删除失败是正常的。如果不跳过这个if，后面会把错误信息输出到stdout
       LOG_ERROR("Failed to rollback index data when insert index entries failed. table name=%s, rc=%d:%s",
                 name(), rc2, strrc(rc2));
     }
@@ -266,6 +276,22 @@ RC Table::visit_record(const RID &rid, bool readonly, std::function<void(Record
   return record_handler_->visit_record(rid, readonly, visitor);
 }
 
+RC Table::modify_record(const RID &rid, LSN lsn, std::function<bool(Record &)> visitor)
+{
+  return record_handler_->modify_record(rid, lsn, visitor);
+}
+
+RC Table::modify_records(PageNum page_num, const std::vector<SlotNum> &slots, LSN lsn,
+                         std::function<bool(int, Record &)> visitor)
+{
+  return record_handler_->modify_records(page_num, slots, lsn, visitor);
+}
+
+RC Table::redo_modify_record(const RID &rid, LSN lsn, std::function<bool(Record &)> visitor)
+{
+  return record_handler_->redo_modify_record(rid, lsn, visitor);
+}
+
 RC Table::get_record(const RID &rid, Record &record)
 {
   const int record_size = table_meta_.record_size();
@@ -287,31 +313,62 @@ RC Table::get_record(const RID &rid, Record &record)
   return rc;
 }
 
-RC Table::recover_insert_record(Record &record)
+RC Table::recover_insert_record(Record &record, LSN lsn)
 {
   RC rc = RC::SUCCESS;
-  rc = record_handler_->recover_insert_record(record.data(), table_meta_.record_size(), record.rid());
+  bool applied = false;
+  rc = record_handler_->recover_insert_record(record.data(), table_meta_.record_size(), record.rid(), lsn, applied);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Insert record failed. table name=%s, rc=%s", table_meta_.name(), strrc(rc));
     return rc;
   }
 
-  rc = insert_entry_of_indexes(record.data(), record.rid());
-  if (rc != RC::SUCCESS) { // 可能出现了键值重复
-    RC rc2 = delete_entry_of_indexes(record.data(), record.rid(), false/*error_on_not_exists*/);
-    if (rc2 != RC::SUCCESS) {
-      LOG_ERROR("Failed to rollback index data when insert index entries failed. table name=%s, rc=%d:%s",
-                name(), rc2, strrc(rc2));
-    }
-    rc2 = record_handler_->delete_record(&record.rid());
-    if (rc2 != RC::SUCCESS) {
-      LOG_PANIC("Failed to rollback record data when insert index entries failed. table name=%s, rc=%d:%s",
-                name(), rc2, strrc(rc2));
+  // 索引没有日志，索引页面与数据页面各自刷盘，不管数据页面是否已经包含了这条记录，
+  // 索引项都可能已经存在也可能不存在，所以逐个补上索引项，已经存在的跳过
+  for (Index *index : indexes_) {
+    rc = index->insert_entry(record.data(), &record.rid());
+    if (rc == RC::RECORD_DUPLICATE_KEY) {
+      rc = RC::SUCCESS;
+    } else if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to recover index entry. table name=%s, index=%s, applied=%d, rc=%s",
+                name(), index->index_meta().name(), applied, strrc(rc));
+      return rc;
     }
   }
   return rc;
 }
 
+RC Table::recover_update_record(const RID &rid, int32_t offset, int32_t len, const char *new_data,
+                                const char *old_data, LSN lsn)
+{
+  Record record;
+  RC rc = get_record(rid, record);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to get record to recover update. table=%s, rid=%s, rc=%s",
+              name(), rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  // 页面上可能是修改前的数据，也可能已经是修改后的数据，用日志中的两份数据分别拼出修改前后的记录
+  std::vector<char> old_record(record.data(), record.data() + record.len());
+  std::vector<char> new_record(old_record);
+  memcpy(old_record.data() + offset, old_data, len);
+  memcpy(new_record.data() + offset, new_data, len);
+
+  rc = update_entry_of_indexes(old_record.data(), new_record.data(), rid, true /*recovering*/);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to recover index entries. table=%s, rid=%s, rc=%s",
+              name(), rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  auto updater = [offset, len, new_data](Record &record) {
+    memcpy(record.data() + offset, new_data, len);
+    return true;
+  };
+  return record_handler_->redo_modify_record(rid, lsn, updater);
+}
+
 const char *Table::name() const
 {
   return table_meta_.name();
@@ -322,6 +379,8 @@ const TableMeta &Table::table_meta() const
   return table_meta_;
 }
 
+int64_t Table::estimated_record_num() const { return record_handler_->record_num(); }
+
 RC Table::make_record(int value_num, const Value *values, Record &record)
 {
   // 检查字段类型是否一致
@@ -396,7 +455,8 @@ RC Table::get_record_scanner(RecordFileScanner &scanner, Trx *trx, bool readonly
   return rc;
 }
 
-RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, const bool &is_unique)
+RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, const bool &is_unique,
+                       IndexType index_type /* = BPLUS_TREE_INDEX */, bool prefix_compression /* = false */)
 {
   if (common::is_blank(index_name) || nullptr == field_meta) {
     LOG_INFO("Invalid input arguments, table name is %s, index_name is blank or attribute_name is blank", name());
@@ -404,7 +464,7 @@ RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_
   }
 
   IndexMeta new_index_meta;
-  RC rc = new_index_meta.init(index_name, *field_meta);
+  RC rc = new_index_meta.init(index_name, *field_meta, index_type, prefix_compression);
   if (rc != RC::SUCCESS) {
     LOG_INFO("Failed to init IndexMeta in table:%s, index_name:%s, field_name:%s", 
              name(), index_name, field_meta->name());
@@ -412,12 +472,20 @@ RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_
   }
 
   // 创建索引相关数据
-  BplusTreeIndex *index = new BplusTreeIndex();
+  Index *index = nullptr;
   std::string index_file = table_index_file(base_dir_.c_str(), name(), index_name);
-  rc = index->create(index_file.c_str(), new_index_meta, *field_meta, is_unique); // 这里只实现B+ Tree
+  if (index_type == HASH_INDEX) {
+    HashIndex *hash_index = new HashIndex();
+    rc = hash_index->create(index_file.c_str(), new_index_meta, *field_meta, is_unique);
+    index = hash_index;
+  } else {
+    BplusTreeIndex *bplus_tree_index = new BplusTreeIndex();
+    rc = bplus_tree_index->create(index_file.c_str(), new_index_meta, *field_meta, is_unique);
+    index = bplus_tree_index;
+  }
   if (rc != RC::SUCCESS) {
     delete index;
-    LOG_ERROR("Failed to create bplus tree index. file name=%s, rc=%d:%s", index_file.c_str(), rc, strrc(rc));
+    LOG_ERROR("Failed to create index. file name=%s, rc=%d:%s", index_file.c_str(), rc, strrc(rc));
     return rc;
   }
 
@@ -505,46 +573,97 @@ RC Table::delete_record(const Record &record)
 
 RC Table::update_record(Record &record, const Value &value, const std::string &field)
 {
-  // 这里就用已经实现的接口，先删除再插入
   const int record_size = table_meta_.record_size();
-  char *record_data = (char *)malloc(record_size);
-  const char *field_name = field.c_str();
-  const FieldMeta *field_meta = table_meta_.field(field_name);
+  std::vector<char> new_data(record.data(), record.data() + record_size);
+  RC rc = set_value_to_record(new_data.data(), value, field);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
 
-  /* 这段加了有问题
-  if (false && record.len() != record_size) { // skip judge
-    LOG_WARN("update record length(%d bytes) not equal to table record length(%d bytes)", 
-        record.len(), record_size);
-    return RC::INTERNAL;
+  rc = update_entry_of_indexes(record.data(), new_data.data(), record.rid(), false /*recovering*/);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to update index entries while updating record. table=%s, rid=%s, rc=%s",
+             name(), record.rid().to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  // 原地修改，记录的位置不变
+  auto updater = [&new_data, record_size](Record &record_on_page) {
+    memcpy(record_on_page.data(), new_data.data(), record_size);
+  };
+  rc = record_handler_->visit_record(record.rid(), false /*readonly*/, updater);
+  ASSERT(RC::SUCCESS == rc, "Failed to update record in place. rid=%s, rc=%s",
+         record.rid().to_string().c_str(), strrc(rc));
+  return rc;
+}
+
+RC Table::set_value_to_record(char *data, const Value &value, const std::string &field) const
+{
+  const FieldMeta *field_meta = table_meta_.field(field.c_str());
+  if (nullptr == field_meta) {
+    LOG_WARN("no such field in table. table=%s, field=%s", name(), field.c_str());
+    return RC::SCHEMA_FIELD_NOT_EXIST;
   }
-  */
 
-  memcpy(record_data, record.data(), record_size);
   size_t copy_len = field_meta->len();
   if (field_meta->type() == CHARS) {
     const size_t data_len = value.length();
     if (copy_len > data_len) {
       copy_len = data_len + 1; // remomber c_string end with additional '\0'
-      // 只要有'\0'，就停止检索，只读取到这了
     }
   }
-  memcpy(record_data + field_meta->offset(), value.data(), copy_len);
+  memcpy(data + field_meta->offset(), value.data(), copy_len);
+  return RC::SUCCESS;
+}
 
-  // 这里将data修改好了，但是需要先将表中的record删了，再将record赋予新的data，重新插入record
+RC Table::update_entry_of_indexes(const char *old_data, const char *new_data, const RID &rid, bool recovering)
+{
+  RC rc = RC::SUCCESS;
+  std::vector<Index *> updated_indexes;
+  for (Index *index : indexes_) {
+    const FieldMeta &field_meta = index->field_meta();
+    if (0 == memcmp(old_data + field_meta.offset(), new_data + field_meta.offset(), field_meta.len())) {
+      continue;
+    }
 
-  // 先删除
-  RC rc = delete_record(record);
-  ASSERT(RC::SUCCESS == rc,
-      "Failed to delete record in poccess of updating, rc=%s",
-      strrc(rc));
+    rc = index->delete_entry(old_data, &rid);
+    if (recovering && OB_FAIL(rc)) {
+      rc = RC::SUCCESS;
+    }
+    if (OB_SUCC(rc)) {
+      rc = index->insert_entry(new_data, &rid);
+      if (recovering && rc == RC::RECORD_DUPLICATE_KEY) {
+        rc = RC::SUCCESS;
+      } else if (OB_FAIL(rc)) {
+        RC rc2 = index->insert_entry(old_data, &rid);
+        if (OB_FAIL(rc2)) {
+          LOG_ERROR("Failed to restore index entry. table=%s, index=%s, rc=%s",
+                    name(), index->index_meta().name(), strrc(rc2));
+        }
+      }
+    }
 
-  // 准备record，并插入
-  record.set_data_owner(record_data, record_size);
-  rc = insert_record(record);
-  ASSERT(RC::SUCCESS == rc,
-      "Failed to insert record in poccess of updating, rc=%s",
-      strrc(rc));
-  
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to update index entry. table=%s, index=%s, rid=%s, rc=%s",
+               name(), index->index_meta().name(), rid.to_string().c_str(), strrc(rc));
+      break;
+    }
+    updated_indexes.push_back(index);
+  }
+
+  if (OB_FAIL(rc)) {
+    for (auto iter = updated_indexes.rbegin(); iter != updated_indexes.rend(); ++iter) {
+      Index *index = *iter;
+      RC rc2 = index->delete_entry(new_data, &rid);
+      if (OB_SUCC(rc2)) {
+        rc2 = index->insert_entry(old_data, &rid);
+      }
+      if (OB_FAIL(rc2)) {
+        LOG_ERROR("Failed to rollback index entry. table=%s, index=%s, rc=%s",
+                  name(), index->index_meta().name(), strrc(rc2));
+      }
+    }
+  }
   return rc;
 }
 
@@ -593,9 +712,25 @@ Index *Table::find_index_by_field(const char *field_name) const
   return nullptr;
 }
 
+Index *Table::find_index_by_field(const char *field_name, IndexType index_type) const
+{
+  const TableMeta &table_meta = this->table_meta();
+  const IndexMeta *index_meta = table_meta.find_index_by_field(field_name, index_type);
+  if (index_meta != nullptr) {
+    return this->find_index(index_meta->name());
+  }
+  return nullptr;
+}
+
 RC Table::sync()
 {
-  RC rc = RC::SUCCESS;
+  // 数据页也要刷盘，否则之后的检查点仍然需要从这些脏页的日志开始重做
+  RC rc = data_buffer_pool_->flush_all_pages();
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to flush table's data pages. table=%s, rc=%d:%s", name(), rc, strrc(rc));
+    return rc;
+  }
+
   for (Index *index : indexes_) {
     rc = index->sync();
     if (rc != RC::SUCCESS) {
@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <functional>
+#include "common/types.h"
 #include "storage/table/table_meta.h"
 #include "sql/parser/parse_defs.h"
 
@@ -85,14 +86,57 @@ public:
   RC insert_record(Record &record);
   RC insert_record(std::vector<Record> &records); // 重复调用insert_record，插入多条record
   RC delete_record(const Record &record);
+
+  /**
+   * @brief 原地修改记录的一个字段
+   * @details 不涉及事务，更新键值有变化的索引项后直接修改页面上的记录
+   */
   RC update_record(Record &record, const Value &value, const std::string &field);
+
+  /**
+   * @brief 把字段的新值写到记录数据中
+   * @param data 完整的记录数据，长度是表的记录长度
+   */
+  RC set_value_to_record(char *data, const Value &value, const std::string &field) const;
+
+  /**
+   * @brief 记录从 old_data 修改为 new_data 时，更新键值有变化的索引项
+   * @details 某个索引更新失败时(比如唯一键冲突)，已经更新的索引项会恢复原状。
+   * recovering 为true时表示在重做日志，忽略已经删除或已经存在的索引项
+   */
+  RC update_entry_of_indexes(const char *old_data, const char *new_data, const RID &rid, bool recovering);
   RC visit_record(const RID &rid, bool readonly, std::function<void(Record &)> visitor);
+
+  /**
+   * @brief 修改记录，并把描述这次修改的日志位置记录到页面上。visitor 返回false表示没有修改
+   */
+  RC modify_record(const RID &rid, LSN lsn, std::function<bool(Record &)> visitor);
+
+  /**
+   * @brief 修改同一个页面上的多条记录，页面只固定一次。visitor 的第一个参数是记录在 slots 中的下标
+   */
+  RC modify_records(PageNum page_num, const std::vector<SlotNum> &slots, LSN lsn,
+                    std::function<bool(int, Record &)> visitor);
+
+  /**
+   * @brief 重做修改记录的日志。页面LSN不小于 lsn 时跳过
+   */
+  RC redo_modify_record(const RID &rid, LSN lsn, std::function<bool(Record &)> visitor);
   RC get_record(const RID &rid, Record &record);
 
-  RC recover_insert_record(Record &record);
+  RC recover_insert_record(Record &record, LSN lsn);
+
+  /**
+   * @brief 重做修改日志，把记录中从 offset 开始的 len 个字节修改为 new_data
+   * @details 页面LSN不小于 lsn 时页面上已经是修改后的数据。索引没有日志，无论页面是否需要重做都会补上索引项
+   * @param old_data 修改前的数据，用来计算修改前的索引键值
+   */
+  RC recover_update_record(const RID &rid, int32_t offset, int32_t len, const char *new_data, const char *old_data,
+                           LSN lsn);
 
   // TODO refactor
-  RC create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, const bool &is_unique);
+  RC create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, const bool &is_unique,
+                  IndexType index_type = BPLUS_TREE_INDEX, bool prefix_compression = false);
 
   RC get_record_scanner(RecordFileScanner &scanner, Trx *trx, bool readonly);
 
@@ -107,6 +151,12 @@ public:
 
   const TableMeta &table_meta() const;
 
+  /**
+   * @brief 估算记录的个数，优化器比较表的大小时使用
+   * @details 数据文件中的记录个数，包括已经删除但还没有清理的旧版本
+   */
+  int64_t estimated_record_num() const;
+
   RC sync();
 
 private:
@@ -119,6 +169,7 @@ private:
 public:
   Index *find_index(const char *index_name) const;
   Index *find_index_by_field(const char *field_name) const;
+  Index *find_index_by_field(const char *field_name, IndexType index_type) const;
 
 private:
   std::string base_dir_;
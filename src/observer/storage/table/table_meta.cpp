@@ -175,6 +175,16 @@ const IndexMeta *TableMeta::find_index_by_field(const char *field) const
   return nullptr;
 }
 
+const IndexMeta *TableMeta::find_index_by_field(const char *field, IndexType index_type) const
+{
+  for (const IndexMeta &index : indexes_) {
+    if (0 == strcmp(index.field(), field) && index.index_type() == index_type) {
+      return &index;
+    }
+  }
+  return nullptr;
+}
+
 const IndexMeta *TableMeta::index(int i) const
 {
   return &indexes_[i];
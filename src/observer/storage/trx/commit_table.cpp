@@ -0,0 +1,44 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/trx/commit_table.h"
+
+using namespace std;
+
+void CommitTable::add(int32_t trx_id, int32_t commit_xid)
+{
+  Shard &shard = shard_of(trx_id);
+  lock_guard<mutex> guard(shard.lock);
+  if (shard.commit_xids.emplace(trx_id, commit_xid).second) {
+    size_.fetch_add(1);
+  }
+}
+
+void CommitTable::remove(int32_t trx_id)
+{
+  Shard &shard = shard_of(trx_id);
+  lock_guard<mutex> guard(shard.lock);
+  if (shard.commit_xids.erase(trx_id) > 0) {
+    size_.fetch_sub(1);
+  }
+}
+
+int32_t CommitTable::find(int32_t trx_id) const
+{
+  // 大部分时候所有提交都已经写到记录上了，不需要加锁
+  if (size_.load() == 0) {
+    return 0;
+  }
+
+  const Shard &shard = shard_of(trx_id);
+  lock_guard<mutex> guard(shard.lock);
+  auto iter = shard.commit_xids.find(trx_id);
+  return iter == shard.commit_xids.end() ? 0 : iter->second;
+}
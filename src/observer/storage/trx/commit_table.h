@@ -0,0 +1,62 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * @brief 已经提交的事务的提交号
+ * @ingroup Transaction
+ * @details 事务提交时只在这里登记提交号，不再逐条改写修改过的记录，提交的代价与事务的大小无关。
+ * 记录上负的事务号由访问它的事务到这里查询：查到了说明事务已经提交，把提交号当作记录上的事务号；
+ * 查不到说明事务还没有结束(回滚会立即改写记录)。登记是一次完成的，其它事务要么看到提交的全部修改，要么都看不到。
+ * 之后由后台把提交号写到记录上，全部改写完成以后删除登记的信息。
+ * 访问记录的事务在持有页面锁的时候查询，而改写需要页面的写锁，所以不会出现记录还没有改写而登记已经删除的情况。
+ */
+class CommitTable
+{
+public:
+  CommitTable() = default;
+  ~CommitTable() = default;
+
+  void add(int32_t trx_id, int32_t commit_xid);
+  void remove(int32_t trx_id);
+
+  /**
+   * @brief 查找事务的提交号
+   * @return 事务没有登记时返回0
+   */
+  int32_t find(int32_t trx_id) const;
+
+  int64_t size() const { return size_.load(); }
+
+private:
+  /**
+   * @brief 按照事务号分成多个分片，每个分片一把锁
+   */
+  struct Shard
+  {
+    mutable std::mutex                  lock;
+    std::unordered_map<int32_t, int32_t> commit_xids;
+  };
+
+  static constexpr int SHARD_NUM = 64;
+
+  Shard &shard_of(int32_t trx_id) { return shards_[static_cast<uint32_t>(trx_id) % SHARD_NUM]; }
+  const Shard &shard_of(int32_t trx_id) const { return shards_[static_cast<uint32_t>(trx_id) % SHARD_NUM]; }
+
+private:
+  Shard                shards_[SHARD_NUM];
+  std::atomic<int64_t> size_{0};
+};
@@ -0,0 +1,309 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <sstream>
+
+#include "common/conf/ini.h"
+#include "common/lang/string.h"
+#include "common/log/log.h"
+#include "storage/trx/lock_manager.h"
+
+using namespace std;
+using namespace common;
+
+static const char *TRX_SECTION = "TRX";
+
+LockConfig LockConfig::from_properties()
+{
+  LockConfig config;
+  Ini *properties = get_properties();
+  if (nullptr == properties) {
+    return config;
+  }
+
+  int value = 0;
+  string str = properties->get("LOCK_WAIT_TIMEOUT_MS", "", TRX_SECTION);
+  if (!str.empty() && str_to_val(str, value) && value >= 0) {
+    config.lock_wait_timeout_ms = value;
+  }
+
+  str = properties->get("DEADLOCK_DETECT_INTERVAL_MS", "", TRX_SECTION);
+  if (!str.empty() && str_to_val(str, value) && value >= 0) {
+    config.deadlock_detect_interval_ms = value;
+  }
+  return config;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double LockStats::avg_wait_us() const
+{
+  const int64_t waits = lock_waits.load();
+  return waits == 0 ? 0.0 : static_cast<double>(total_wait_us.load()) / waits;
+}
+
+string LockStats::to_string() const
+{
+  stringstream ss;
+  ss << "lock_requests:" << lock_requests.load()
+     << ", lock_waits:" << lock_waits.load()
+     << ", wait_timeouts:" << wait_timeouts.load()
+     << ", deadlocks:" << deadlocks.load()
+     << ", avg_wait_us:" << avg_wait_us()
+     << ", max_wait_us:" << max_wait_us.load();
+  return ss.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+LockManager::~LockManager()
+{
+  stop_detect_thread();
+
+  if (stats_.lock_waits > 0) {
+    LOG_INFO("lock manager stats: %s", stats_.to_string().c_str());
+  }
+}
+
+void LockManager::init(const LockConfig &config)
+{
+  stop_detect_thread();
+
+  config_         = config;
+  detect_stopped_ = false;
+  if (config_.deadlock_detect_interval_ms > 0) {
+    detect_thread_ = thread(&LockManager::detect_thread_func, this);
+  }
+}
+
+bool LockManager::grant_if_free(int32_t trx_id, const LockKey &key, bool &acquired)
+{
+  acquired = false;
+  RowLock &row_lock = locks_[key];
+  if (row_lock.owner == trx_id) {
+    return true;
+  }
+  if (row_lock.owner == 0) {
+    row_lock.owner = trx_id;
+    acquired       = true;
+    return true;
+  }
+  return false;
+}
+
+RC LockManager::try_lock(int32_t trx_id, const LockKey &key, bool &acquired)
+{
+  stats_.lock_requests++;
+
+  lock_guard<mutex> guard(lock_);
+  return grant_if_free(trx_id, key, acquired) ? RC::SUCCESS : RC::LOCKED_NEED_WAIT;
+}
+
+RC LockManager::lock(int32_t trx_id, const LockKey &key, int timeout_ms, bool &acquired)
+{
+  stats_.lock_requests++;
+
+  unique_lock<mutex> guard(lock_);
+  if (grant_if_free(trx_id, key, acquired)) {
+    return RC::SUCCESS;
+  }
+
+  if (timeout_ms < 0) {
+    timeout_ms = config_.lock_wait_timeout_ms;
+  }
+  if (timeout_ms == 0) {
+    stats_.wait_timeouts++;
+    return RC::LOCKED_WAIT_TIMEOUT;
+  }
+
+  Waiter waiter;
+  waiter.trx_id = trx_id;
+  locks_[key].waiters.push_back(&waiter);
+  waiting_for_[trx_id] = key;
+  stats_.lock_waits++;
+  stats_.waiting++;
+
+  const auto start    = chrono::steady_clock::now();
+  const auto deadline = start + chrono::milliseconds(timeout_ms);
+  while (!waiter.granted && !waiter.victim) {
+    if (waiter.cond.wait_until(guard, deadline) == cv_status::timeout) {
+      break;
+    }
+  }
+
+  waiting_for_.erase(trx_id);
+  stats_.waiting--;
+  const int64_t wait_us = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+  stats_.total_wait_us += wait_us;
+  int64_t max_wait_us = stats_.max_wait_us.load();
+  while (wait_us > max_wait_us && !stats_.max_wait_us.compare_exchange_weak(max_wait_us, wait_us)) {
+  }
+
+  if (waiter.granted) {
+    acquired = true;
+    return RC::SUCCESS;
+  }
+
+  // 被选为死锁牺牲者时检测线程已经把它移出了队列
+  if (waiter.victim) {
+    LOG_INFO("lock wait is chosen as deadlock victim. trx=%d, table=%d, rid=%d:%d",
+             trx_id, key.table_id, key.page_num, key.slot_num);
+    return RC::LOCKED_DEADLOCK;
+  }
+
+  // 有等待者时锁不会被删除
+  deque<Waiter *> &waiters = locks_[key].waiters;
+  waiters.erase(std::find(waiters.begin(), waiters.end(), &waiter));
+  stats_.wait_timeouts++;
+  LOG_TRACE("lock wait timeout. trx=%d, table=%d, rid=%d:%d", trx_id, key.table_id, key.page_num, key.slot_num);
+  return RC::LOCKED_WAIT_TIMEOUT;
+}
+
+void LockManager::unlock_all(int32_t trx_id, const vector<LockKey> &keys)
+{
+  lock_guard<mutex> guard(lock_);
+  for (const LockKey &key : keys) {
+    auto iter = locks_.find(key);
+    if (iter == locks_.end() || iter->second.owner != trx_id) {
+      continue;
+    }
+
+    RowLock &row_lock = iter->second;
+    if (row_lock.waiters.empty()) {
+      locks_.erase(iter);
+      continue;
+    }
+
+    // 直接交给最早的等待者，后来的加锁请求不会插队
+    Waiter *waiter = row_lock.waiters.front();
+    row_lock.waiters.pop_front();
+    row_lock.owner  = waiter->trx_id;
+    waiter->granted = true;
+    waiter->cond.notify_one();
+  }
+}
+
+int LockManager::detect_deadlocks()
+{
+  lock_guard<mutex> guard(lock_);
+  if (waiting_for_.empty()) {
+    return 0;
+  }
+
+  // 等待者等待锁的持有者，也等待排在它前面的等待者
+  unordered_map<int32_t, vector<int32_t>> graph;
+  for (const auto &entry : locks_) {
+    const RowLock &row_lock = entry.second;
+    for (size_t i = 0; i < row_lock.waiters.size(); i++) {
+      vector<int32_t> &edges = graph[row_lock.waiters[i]->trx_id];
+      edges.push_back(row_lock.owner);
+      for (size_t j = 0; j < i; j++) {
+        edges.push_back(row_lock.waiters[j]->trx_id);
+      }
+    }
+  }
+
+  int deadlocks = 0;
+  vector<int32_t> cycle;
+  while (find_cycle(graph, cycle)) {
+    // 放弃最年轻的事务，它做的修改通常最少
+    const int32_t victim = *max_element(cycle.begin(), cycle.end());
+    graph.erase(victim);
+
+    auto waiting = waiting_for_.find(victim);
+    if (waiting == waiting_for_.end()) {
+      continue;
+    }
+    deque<Waiter *> &waiters = locks_[waiting->second].waiters;
+    for (auto iter = waiters.begin(); iter != waiters.end(); ++iter) {
+      if ((*iter)->trx_id == victim) {
+        Waiter *waiter = *iter;
+        waiters.erase(iter);
+        waiter->victim = true;
+        waiter->cond.notify_one();
+        break;
+      }
+    }
+
+    deadlocks++;
+    stats_.deadlocks++;
+    LOG_INFO("found deadlock. cycle size=%d, victim=%d", static_cast<int>(cycle.size()), victim);
+  }
+  return deadlocks;
+}
+
+bool LockManager::find_cycle(const unordered_map<int32_t, vector<int32_t>> &graph, vector<int32_t> &cycle)
+{
+  enum class State { UNVISITED, VISITING, VISITED };
+  unordered_map<int32_t, State> states;
+  vector<int32_t> path;
+
+  function<bool(int32_t)> visit = [&](int32_t trx_id) -> bool {
+    states[trx_id] = State::VISITING;
+    path.push_back(trx_id);
+
+    auto iter = graph.find(trx_id);
+    if (iter != graph.end()) {
+      for (int32_t next : iter->second) {
+        const State state = states[next];
+        if (state == State::VISITING) {
+          cycle.assign(std::find(path.begin(), path.end(), next), path.end());
+          return true;
+        }
+        if (state == State::UNVISITED && visit(next)) {
+          return true;
+        }
+      }
+    }
+
+    path.pop_back();
+    states[trx_id] = State::VISITED;
+    return false;
+  };
+
+  for (const auto &entry : graph) {
+    if (states[entry.first] == State::UNVISITED && visit(entry.first)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void LockManager::detect_thread_func()
+{
+  unique_lock<mutex> lock(detect_lock_);
+  while (!detect_stopped_) {
+    detect_cond_.wait_for(lock, chrono::milliseconds(config_.deadlock_detect_interval_ms));
+    if (detect_stopped_) {
+      break;
+    }
+
+    lock.unlock();
+    detect_deadlocks();
+    lock.lock();
+  }
+}
+
+void LockManager::stop_detect_thread()
+{
+  if (!detect_thread_.joinable()) {
+    return;
+  }
+
+  {
+    lock_guard<mutex> guard(detect_lock_);
+    detect_stopped_ = true;
+    detect_cond_.notify_all();
+  }
+  detect_thread_.join();
+}
@@ -0,0 +1,183 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "common/rc.h"
+#include "storage/record/record.h"
+
+/**
+ * @brief 行锁的配置
+ * @ingroup Transaction
+ * @details 在配置文件的 [TRX] 中设置
+ */
+struct LockConfig
+{
+  int lock_wait_timeout_ms        = 5000; ///< LOCK_WAIT_TIMEOUT_MS 等待行锁的最长时间，会话可以单独设置
+  int deadlock_detect_interval_ms = 100;  ///< DEADLOCK_DETECT_INTERVAL_MS 后台检测死锁的间隔，0表示不检测
+
+  /**
+   * @brief 从配置文件中读取配置，没有配置的项使用默认值
+   */
+  static LockConfig from_properties();
+};
+
+/**
+ * @brief 行锁的统计信息
+ * @ingroup Transaction
+ */
+struct LockStats
+{
+  std::atomic<int64_t> lock_requests{0};  ///< 加锁的次数，包括已经持有的锁
+  std::atomic<int64_t> lock_waits{0};     ///< 需要等待的次数
+  std::atomic<int64_t> waiting{0};        ///< 正在等待的事务个数
+  std::atomic<int64_t> wait_timeouts{0};  ///< 等待超时的次数
+  std::atomic<int64_t> deadlocks{0};      ///< 检测到的死锁个数，每个死锁回滚一个事务的等待
+  std::atomic<int64_t> total_wait_us{0};  ///< 等待的总时间(微秒)
+  std::atomic<int64_t> max_wait_us{0};    ///< 最长的一次等待(微秒)
+
+  double avg_wait_us() const;
+
+  std::string to_string() const;
+};
+
+/**
+ * @brief 行锁管理器
+ * @ingroup Transaction
+ * @details 修改记录之前对记录加排它锁，事务结束时释放。锁被其它事务持有时，按照请求的顺序排队等待，
+ * 锁释放时直接交给队列中的第一个事务，后来的事务不会插队。
+ * 等待超过超时时间返回 LOCKED_WAIT_TIMEOUT。后台线程定期根据等待关系构造等待图(wait-for graph)，
+ * 发现环时选择环中最年轻(事务号最大)的事务，让它的等待返回 LOCKED_DEADLOCK。
+ * 所有的锁由一把互斥锁保护，等待的事务各自在自己的条件变量上等待。
+ */
+class LockManager
+{
+public:
+  /**
+   * @brief 锁住的记录
+   */
+  struct LockKey
+  {
+    int32_t table_id;
+    PageNum page_num;
+    SlotNum slot_num;
+
+    bool operator==(const LockKey &other) const
+    {
+      return table_id == other.table_id && page_num == other.page_num && slot_num == other.slot_num;
+    }
+  };
+
+public:
+  LockManager() = default;
+  ~LockManager();
+
+  /**
+   * @brief 设置配置并启动后台检测死锁的线程
+   */
+  void init(const LockConfig &config);
+
+  /**
+   * @brief 对记录加排它锁
+   * @param timeout_ms 最长等待时间，小于0时使用配置的超时时间，0表示不等待
+   * @param acquired   返回这次是否新获得了锁。已经持有锁时返回false
+   * @return RC        - SUCCESS 加锁成功
+   *                   - LOCKED_WAIT_TIMEOUT 等待超时
+   *                   - LOCKED_DEADLOCK 等待形成了死锁，当前事务被选中放弃
+   */
+  RC lock(int32_t trx_id, const LockKey &key, int timeout_ms, bool &acquired);
+
+  /**
+   * @brief 不等待地对记录加排它锁
+   * @details 调用者持有其它资源(比如页面的锁)不能等待时使用。返回 LOCKED_NEED_WAIT 时，
+   * 释放这些资源以后再调用 lock 等待
+   * @return RC - SUCCESS 加锁成功或者已经持有锁
+   *            - LOCKED_NEED_WAIT 锁被其它事务持有
+   */
+  RC try_lock(int32_t trx_id, const LockKey &key, bool &acquired);
+
+  /**
+   * @brief 释放事务持有的锁，交给等待队列中的第一个事务
+   */
+  void unlock_all(int32_t trx_id, const std::vector<LockKey> &keys);
+
+  /**
+   * @brief 检测死锁，每个环选择一个事务放弃等待
+   * @return 检测到的死锁个数
+   */
+  int detect_deadlocks();
+
+  const LockConfig &config() const { return config_; }
+  const LockStats  &stats() const { return stats_; }
+
+private:
+  struct LockKeyHasher
+  {
+    size_t operator()(const LockKey &key) const
+    {
+      return std::hash<int64_t>()((static_cast<int64_t>(key.table_id) << 48) ^
+                                  (static_cast<int64_t>(key.page_num) << 16) ^ key.slot_num);
+    }
+  };
+
+  /**
+   * @brief 一个等待的请求，在等待的线程的栈上
+   */
+  struct Waiter
+  {
+    int32_t                 trx_id  = 0;
+    bool                    granted = false;  ///< 锁已经交给这个事务
+    bool                    victim  = false;  ///< 被选为死锁的牺牲者
+    std::condition_variable cond;
+  };
+
+  struct RowLock
+  {
+    int32_t              owner = 0;  ///< 持有锁的事务
+    std::deque<Waiter *> waiters;    ///< 按照请求的顺序排队
+  };
+
+  /**
+   * @brief 锁空闲或者已经被 trx_id 持有时加锁成功，调用者持有 lock_
+   */
+  bool grant_if_free(int32_t trx_id, const LockKey &key, bool &acquired);
+
+  void detect_thread_func();
+  void stop_detect_thread();
+
+  /**
+   * @brief 在等待图中找一个环
+   * @param cycle 返回环上的事务
+   */
+  static bool find_cycle(const std::unordered_map<int32_t, std::vector<int32_t>> &graph, std::vector<int32_t> &cycle);
+
+private:
+  LockConfig config_;
+  LockStats  stats_;
+
+  std::mutex                                        lock_;
+  std::unordered_map<LockKey, RowLock, LockKeyHasher> locks_;
+  std::unordered_map<int32_t, LockKey>              waiting_for_;  ///< 正在等待的事务在等哪个锁
+
+  std::thread             detect_thread_;
+  std::mutex              detect_lock_;
+  std::condition_variable detect_cond_;
+  bool                    detect_stopped_ = false;
+};
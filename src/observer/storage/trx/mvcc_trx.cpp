@@ -12,8 +12,10 @@ See the Mulan PSL v2 for more details. */
 // Created by Wangyunlai on 2023/04/24.
 //
 
+#include <inttypes.h>
 #include <limits>
 #include "storage/trx/mvcc_trx.h"
+#include "storage/table/table.h"
 #include "storage/field/field.h"
 #include "storage/clog/clog.h"
 #include "storage/db/db.h"
@@ -23,10 +25,14 @@ using namespace std;
 
 MvccTrxKit::~MvccTrxKit()
 {
+  // 表可能已经关闭了，不再改写没有改写的记录，重启时根据日志恢复
+  stop_resolve_thread();
+
   vector<Trx *> tmp_trxes;
-  tmp_trxes.swap(trxes_);
+  registry_.all(tmp_trxes);
   
   for (Trx *trx : tmp_trxes) {
+    registry_.remove(trx->id(), trx);
     delete trx;
   }
 }
@@ -38,6 +44,11 @@ RC MvccTrxKit::init()
     FieldMeta("__trx_xid_end",   AttrType::INTS, 0/*attr_offset*/, 4/*attr_len*/, false/*visible*/)
   };
 
+  lock_manager_.init(LockConfig::from_properties());
+#ifdef CONCURRENCY
+  // 页面的锁只有在 CONCURRENCY 模式下才生效，后台线程才能与其它线程同时修改页面
+  resolve_thread_ = thread(&MvccTrxKit::resolve_thread_func, this);
+#endif
   LOG_INFO("init mvcc trx kit done.");
   return RC::SUCCESS;
 }
@@ -57,64 +68,261 @@ int32_t MvccTrxKit::max_trx_id() const
   return numeric_limits<int32_t>::max();
 }
 
-Trx *MvccTrxKit::create_trx(CLogManager *log_manager)
+int32_t MvccTrxKit::start_trx(Trx *trx)
+{
+  return registry_.start(current_trx_id_, trx);
+}
+
+void MvccTrxKit::end_trx(int32_t trx_id, Trx *trx)
 {
-  Trx *trx = new MvccTrx(*this, log_manager);
-  if (trx != nullptr) {
-    lock_.lock();
-    trxes_.push_back(trx);
-    lock_.unlock();
+  registry_.remove(trx_id, trx);
+
+  if (finished_trx_num_.fetch_add(1) + 1 >= PURGE_INTERVAL) {
+    finished_trx_num_.store(0);
+    if (version_store_.version_count() > 0) {
+      int64_t purged = version_store_.purge(purge_horizon());
+      LOG_DEBUG("purge record versions. purged=%" PRId64 ", remain=%" PRId64, purged, version_store_.version_count());
+    }
   }
-  return trx;
+}
+
+int32_t MvccTrxKit::begin_commit(Trx *trx)
+{
+  return committing_.start(current_trx_id_, trx);
+}
+
+void MvccTrxKit::end_commit(int32_t commit_xid, Trx *trx)
+{
+  committing_.remove(commit_xid, trx);
+}
+
+ReadView MvccTrxKit::create_read_view()
+{
+  // 之后取的快照，up_limit 不会小于现在最老的提交中的事务，先用它占住清理的边界
+  const int slot = view_slots_.acquire(committing_.oldest(current_trx_id_.load()));
+
+  // 先读取最大的事务号再取快照，正在分配的提交号不会被漏掉
+  vector<int32_t> active;
+  const int32_t limit = committing_.snapshot(current_trx_id_.load(), active);
+  ReadView read_view(limit + 1, std::move(active));
+  read_view.set_slot(slot);
+  view_slots_.update(slot, read_view.up_limit());
+  return read_view;
+}
+
+void MvccTrxKit::close_read_view(ReadView &read_view)
+{
+  if (read_view.slot() >= 0) {
+    view_slots_.release(read_view.slot());
+    read_view.set_slot(-1);
+  }
+}
+
+int32_t MvccTrxKit::purge_horizon()
+{
+  // 先计算最老的提交中的事务再检查读视图。之后才登记的读视图，快照里不会有比它更老的提交
+  const int32_t horizon = committing_.oldest(current_trx_id_.load());
+  return view_slots_.min(horizon);
+}
+
+Trx *MvccTrxKit::create_trx(CLogManager *log_manager)
+{
+  // 事务开始时(start_if_need)才分配事务号并登记
+  return new MvccTrx(*this, log_manager);
 }
 
 Trx *MvccTrxKit::create_trx(int32_t trx_id)
 {
   Trx *trx = new MvccTrx(*this, trx_id);
-  if (trx != nullptr) {
-    lock_.lock();
-    trxes_.push_back(trx);
-    if (current_trx_id_ < trx_id) {
-      current_trx_id_ = trx_id;
-    }
-    lock_.unlock();
+  if (!registry_.add(trx_id, trx)) {
+    LOG_WARN("failed to register trx. trx id=%d", trx_id);
+    delete trx;
+    return nullptr;
   }
+
+  advance_trx_id(trx_id);
   return trx;
 }
 
-void MvccTrxKit::destroy_trx(Trx *trx)
+void MvccTrxKit::advance_trx_id(int32_t trx_id)
 {
-  lock_.lock();
-  for (auto iter = trxes_.begin(), itend = trxes_.end(); iter != itend; ++iter) {
-    if (*iter == trx) {
-      trxes_.erase(iter);
-      break;
-    }
+  int32_t current = current_trx_id_.load();
+  while (current < trx_id && !current_trx_id_.compare_exchange_weak(current, trx_id)) {
   }
-  lock_.unlock();
+}
 
+void MvccTrxKit::destroy_trx(Trx *trx)
+{
+  registry_.remove(trx->id(), trx);
   delete trx;
 }
 
 Trx *MvccTrxKit::find_trx(int32_t trx_id)
 {
-  lock_.lock();
-  for (Trx *trx : trxes_) {
-    if (trx->id() == trx_id) {
-      lock_.unlock();
-      return trx;
+  return registry_.find(trx_id);
+}
+
+void MvccTrxKit::all_trxes(std::vector<Trx *> &trxes)
+{
+  registry_.all(trxes);
+}
+
+/**
+ * @brief 获取指定表上的事务使用的字段
+ * 
+ * @param table 指定的表
+ * @param begin_xid_field 返回处理begin_xid的字段
+ * @param end_xid_field   返回处理end_xid的字段
+ */
+static void xid_fields(Table *table, Field &begin_xid_field, Field &end_xid_field)
+{
+  const TableMeta &table_meta = table->table_meta();
+  const std::pair<const FieldMeta *, int> trx_fields = table_meta.trx_fields();
+  ASSERT(trx_fields.second >= 2, "invalid trx fields number. %d", trx_fields.second);
+
+  begin_xid_field.set_table(table);
+  begin_xid_field.set_field(&trx_fields.first[0]);
+  end_xid_field.set_table(table);
+  end_xid_field.set_field(&trx_fields.first[1]);
+}
+
+/**
+ * @brief 把提交号写到事务修改过的同一个页面上的记录，修改的页面记录提交日志的位置 commit_lsn
+ * @details 记录上已经不是这个事务的事务号时跳过：重做时提交已经反映在页面上，
+ * 或者提交号还没有写到记录上时，记录又被之后的事务修改了(修改时已经换成了提交号)
+ * @param begin 同一个页面上的操作 [begin, end)
+ */
+static RC commit_page(VersionStore &version_store, const Operation *begin, const Operation *end, int32_t trx_id,
+                        int32_t commit_xid, LSN commit_lsn)
+{
+  Table *table = begin->table();
+  Field begin_xid_field, end_xid_field;
+  xid_fields(table, begin_xid_field, end_xid_field);
+
+  vector<SlotNum> slots;
+  for (const Operation *operation = begin; operation != end; ++operation) {
+    slots.push_back(operation->slot_num());
+  }
+
+  // 插入和修改的记录 begin xid 是负的事务号，删除的记录 end xid 是负的事务号
+  auto record_updater = [begin, trx_id, commit_xid, &begin_xid_field, &end_xid_field](int index, Record &record) {
+    Field &xid_field = (begin[index].type() == Operation::Type::DELETE) ? end_xid_field : begin_xid_field;
+    if (xid_field.get_int(record) != -trx_id) {
+      return false;
     }
+    xid_field.set_int(record, commit_xid);
+    return true;
+  };
+
+  RC rc = table->modify_records(begin->page_num(), slots, commit_lsn, record_updater);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("failed to get records while committing. table=%s, page=%d, rc=%s",
+              table->name(), begin->page_num(), strrc(rc));
+    return rc;
   }
-  lock_.unlock();
 
-  return nullptr;
+  for (const Operation *operation = begin; operation != end; ++operation) {
+    if (operation->type() == Operation::Type::UPDATE) {
+      version_store.commit(table->table_id(), RID(operation->page_num(), operation->slot_num()), trx_id, commit_xid);
+    }
+  }
+  return RC::SUCCESS;
 }
 
-void MvccTrxKit::all_trxes(std::vector<Trx *> &trxes)
+void MvccTrxKit::add_committed_trx(CommittedTrx &&trx)
+{
+  bool notify = false;
+  {
+    lock_guard<mutex> guard(committed_lock_);
+    committed_op_num_ += static_cast<int64_t>(trx.operations.size());
+    notify = committed_op_num_ >= RESOLVE_BATCH;
+    committed_trxes_.push_back(std::move(trx));
+  }
+
+#ifdef CONCURRENCY
+  if (notify) {
+    resolve_cond_.notify_one();
+  }
+#else
+  // 没有后台线程，提交时不改写记录，等到语句之间再改写
+  (void)notify;
+#endif
+}
+
+void MvccTrxKit::resolve_commits_if_needed()
+{
+#ifndef CONCURRENCY
+  bool need_resolve = false;
+  {
+    lock_guard<mutex> guard(committed_lock_);
+    need_resolve = committed_op_num_ >= RESOLVE_BATCH;
+  }
+  if (need_resolve) {
+    resolve_commits();
+  }
+#endif
+}
+
+void MvccTrxKit::resolve_commits()
+{
+  lock_guard<mutex> resolve_guard(resolve_lock_);
+
+  deque<CommittedTrx> trxes;
+  {
+    lock_guard<mutex> guard(committed_lock_);
+    trxes.swap(committed_trxes_);
+    committed_op_num_ = 0;
+  }
+
+  vector<Operation> operations;
+  for (const CommittedTrx &trx : trxes) {
+    trx.operations.sorted(operations);
+    RC rc = OperationLog::for_each_page(operations, [this, &trx](const Operation *begin, const Operation *end) {
+      return commit_page(version_store_, begin, end, trx.trx_id, trx.commit_xid, trx.commit_lsn);
+    });
+    if (OB_FAIL(rc)) {
+      // 保留登记的提交号，记录上还是事务号时仍然可以通过提交表判断可见性
+      LOG_ERROR("failed to resolve committed trx. trx id=%d, commit xid=%d, rc=%s",
+                trx.trx_id, trx.commit_xid, strrc(rc));
+      continue;
+    }
+
+    // 记录都改写完成以后才能删除登记的提交号
+    commit_table_.remove(trx.trx_id);
+    trx.log_manager->release_trx(trx.trx_id);
+  }
+  if (!trxes.empty()) {
+    LOG_DEBUG("resolve committed trxes. count=%d", static_cast<int>(trxes.size()));
+  }
+}
+
+void MvccTrxKit::resolve_thread_func()
 {
-  lock_.lock();
-  trxes = trxes_;
-  lock_.unlock();
+  unique_lock<mutex> lock(resolve_thread_lock_);
+  while (!resolve_stopped_) {
+    resolve_cond_.wait_for(lock, chrono::milliseconds(RESOLVE_INTERVAL_MS));
+    if (resolve_stopped_) {
+      break;
+    }
+
+    lock.unlock();
+    resolve_commits();
+    lock.lock();
+  }
+}
+
+void MvccTrxKit::stop_resolve_thread()
+{
+  if (!resolve_thread_.joinable()) {
+    return;
+  }
+
+  {
+    lock_guard<mutex> guard(resolve_thread_lock_);
+    resolve_stopped_ = true;
+    resolve_cond_.notify_all();
+  }
+  resolve_thread_.join();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -130,6 +338,11 @@ MvccTrx::MvccTrx(MvccTrxKit &kit, int32_t trx_id) : trx_kit_(kit), trx_id_(trx_i
 
 MvccTrx::~MvccTrx()
 {
+  // 没有结束的事务，不再阻止清理历史版本
+  if (started_ && !recovering_) {
+    trx_kit_.close_read_view(read_view_);
+  }
+  release_locks();
 }
 
 RC MvccTrx::insert_record(Table *table, std::vector<Record> &records)
@@ -165,11 +378,15 @@ RC MvccTrx::insert_record(Table *table, std::vector<Record> &records)
 
 RC MvccTrx::delete_record(Table * table, Record &record)
 {
+  if (read_only_) {
+    return RC::TRX_READ_ONLY;
+  }
+
   Field begin_field;
   Field end_field;
   trx_fields(table, begin_field, end_field);
 
-  [[maybe_unused]] int32_t end_xid = end_field.get_int(record);
+  [[maybe_unused]] int32_t end_xid = resolve_xid(end_field.get_int(record));
   /// 在删除之前，第一次获取record时，就已经对record做了对应的检查，并且保证不会有其它的事务来访问这条数据
   ASSERT(end_xid > 0, "concurrency conflit: other transaction is updating this record. end_xid=%d, current trx id=%d, rid=%s",
          end_xid, trx_id_, record.rid().to_string().c_str());
@@ -178,19 +395,157 @@ RC MvccTrx::delete_record(Table * table, Record &record)
     return RC::SUCCESS;
   }
   
-  end_field.set_int(record, -trx_id_);
-  RC rc = log_manager_->append_log(CLogType::DELETE, trx_id_, table->table_id(), record.rid(), 0, 0, nullptr);
+  // 调用者持有页面的写锁，日志在修改页面之前写入，所以页面LSN的顺序与日志的顺序一致，
+  // 重做时可以根据页面LSN判断这条日志是否已经反映在页面上
+  LSN lsn = 0;
+  RC rc = log_manager_->append_log(CLogType::DELETE, trx_id_, table->table_id(), record.rid(), 0, 0, nullptr, &lsn);
   ASSERT(rc == RC::SUCCESS, "failed to append delete record log. trx id=%d, table id=%d, rid=%s, record len=%d, rc=%s",
       trx_id_, table->table_id(), record.rid().to_string().c_str(), record.len(), strrc(rc));
 
-  operations_.insert(Operation(Operation::Type::DELETE, table, record.rid()));
+  auto record_updater = [this, &end_field](Record &record) {
+    end_field.set_int(record, -trx_id_);
+    return true;
+  };
+  rc = table->modify_record(record.rid(), lsn, record_updater);
+  ASSERT(rc == RC::SUCCESS, "failed to get record while deleting. rid=%s, rc=%s",
+         record.rid().to_string().c_str(), strrc(rc));
+
+  operations_.append(Operation(Operation::Type::DELETE, table, record.rid()));
 
   return RC::SUCCESS;
 }
 
+/**
+ * @brief 找出修改前后记录数据中不同的几段字节
+ * @details 两段修改之间的距离很近时合并成一段，比多写一条日志的头部要省空间
+ */
+static void diff_record(const char *old_data, const char *new_data, int len, vector<pair<int32_t, int32_t>> &ranges)
+{
+  const int merge_distance = static_cast<int>(sizeof(CLogRecordHeader) + CLogRecordData::HEADER_SIZE) / 2;
+  int i = 0;
+  while (i < len) {
+    if (old_data[i] == new_data[i]) {
+      i++;
+      continue;
+    }
+
+    int begin = i;
+    int end   = i + 1;  // [begin, end) 是当前这段修改
+    for (i = end; i < len && i - end <= merge_distance; i++) {
+      if (old_data[i] != new_data[i]) {
+        end = i + 1;
+      }
+    }
+    ranges.emplace_back(begin, end - begin);
+    i = end;
+  }
+}
+
 RC MvccTrx::update_record(Table *table, Record &record, const Value &value, const std::string &field)
 {
-  return RC::UNIMPLENMENT;
+  if (read_only_) {
+    return RC::TRX_READ_ONLY;
+  }
+
+  Field begin_field;
+  Field end_field;
+  trx_fields(table, begin_field, end_field);
+
+  [[maybe_unused]] int32_t end_xid = resolve_xid(end_field.get_int(record));
+  ASSERT(end_xid > 0, "concurrency conflit: other transaction is updating this record. end_xid=%d, current trx id=%d, rid=%s",
+         end_xid, trx_id_, record.rid().to_string().c_str());
+  if (end_xid != trx_kit_.max_trx_id()) {
+    // 已经被其它提交的事务删除了
+    LOG_WARN("record has been deleted by other transaction. end_xid=%d, current trx id=%d, rid=%s",
+             end_xid, trx_id_, record.rid().to_string().c_str());
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+
+  // record 指向页面上的数据，修改页面之前先复制一份
+  const int record_size = table->table_meta().record_size();
+  // 修改前的版本可能是已经提交但是提交号还没有写到记录上的，换成提交号再保存和记录回滚数据
+  vector<char> old_data(record.data(), record.data() + record_size);
+  Record old_record;
+  old_record.set_data(old_data.data(), record_size);
+  const int32_t old_begin_xid = begin_field.get_int(old_record);
+  begin_field.set_int(old_record, resolve_xid(old_begin_xid));
+
+  vector<char> new_data(old_data);
+  RC rc = table->set_value_to_record(new_data.data(), value, field);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  Record new_record;
+  new_record.set_data(new_data.data(), record_size);
+  begin_field.set_int(new_record, -trx_id_);
+
+  vector<pair<int32_t, int32_t>> ranges;
+  diff_record(old_data.data(), new_data.data(), record_size, ranges);
+  if (ranges.empty()) {
+    return RC::SUCCESS;
+  }
+
+  // 当前事务第一次修改这条记录时保存修改前的版本，之后的修改产生的中间版本其它事务都看不到
+  if (old_begin_xid != -trx_id_) {
+    trx_kit_.version_store().add(table->table_id(), record.rid(), trx_id_, old_data.data(), record_size);
+  }
+
+  // 与删除一样，日志在修改页面之前写入。每段修改一条日志，页面LSN是最后一条日志的位置
+  LSN lsn = 0;
+  vector<char> log_data;
+  for (const auto &[offset, len] : ranges) {
+    log_data.resize(len * 2);
+    memcpy(log_data.data(), new_data.data() + offset, len);
+    memcpy(log_data.data() + len, old_data.data() + offset, len);
+    rc = log_manager_->append_log(
+        CLogType::UPDATE, trx_id_, table->table_id(), record.rid(), len * 2, offset, log_data.data(), &lsn);
+    ASSERT(rc == RC::SUCCESS, "failed to append update record log. trx id=%d, table id=%d, rid=%s, rc=%s",
+        trx_id_, table->table_id(), record.rid().to_string().c_str(), strrc(rc));
+  }
+
+  auto record_updater = [&ranges, &new_data](Record &record) {
+    for (const auto &[offset, len] : ranges) {
+      memcpy(record.data() + offset, new_data.data() + offset, len);
+    }
+    return true;
+  };
+  rc = table->modify_record(record.rid(), lsn, record_updater);
+  ASSERT(rc == RC::SUCCESS, "failed to get record while updating. rid=%s, rc=%s",
+         record.rid().to_string().c_str(), strrc(rc));
+
+  Operation operation(Operation::Type::UPDATE, table, record.rid());
+  vector<UpdateUndo> &undos = update_undos_[operation];
+  if (undos.empty()) {
+    operations_.append(operation);
+  }
+  for (const auto &[offset, len] : ranges) {
+    undos.push_back(UpdateUndo{offset, string(old_data.data() + offset, len)});
+  }
+
+  // 与回滚一样，持有数据页面的锁时不能修改索引，等调用者释放页面的锁以后再修改
+  if (table->table_meta().index_num() > 0) {
+    index_updates_.push_back(IndexUpdate{table, record.rid(), std::move(old_data), std::move(new_data)});
+  }
+  return RC::SUCCESS;
+}
+
+RC MvccTrx::apply_index_updates()
+{
+  // 一条修改失败以后继续修改其它的，只有失败的记录与索引不一致
+  for (const IndexUpdate &update : index_updates_) {
+    RC rc = update.table->update_entry_of_indexes(
+        update.old_data.data(), update.new_data.data(), update.rid, false /*recovering*/);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to update index entries. trx id=%d, table=%s, rid=%s, rc=%s",
+               trx_id_, update.table->name(), update.rid.to_string().c_str(), strrc(rc));
+      if (OB_SUCC(index_update_rc_)) {
+        index_update_rc_ = rc;
+      }
+    }
+  }
+  index_updates_.clear();
+  return index_update_rc_;
 }
 
 RC MvccTrx::visit_record(Table *table, Record &record, bool readonly)
@@ -199,58 +554,156 @@ RC MvccTrx::visit_record(Table *table, Record &record, bool readonly)
   Field end_field;
   trx_fields(table, begin_field, end_field);
 
-  int32_t begin_xid = begin_field.get_int(record);
-  int32_t end_xid = end_field.get_int(record);
+  if (!readonly) {
+    if (read_only_) {
+      LOG_WARN("cannot modify records in a read only transaction. table=%s", table->name());
+      return RC::TRX_READ_ONLY;
+    }
 
-  RC rc = RC::SUCCESS;
-  if (begin_xid > 0 && end_xid > 0) {
-    if (trx_id_ >= begin_xid && trx_id_ <= end_xid) {
-      rc = RC::SUCCESS;
-    } else {
-      rc = RC::RECORD_INVISIBLE;
+    // 当前读：拿到锁以后，持有锁的事务已经结束，页面上是最新提交的版本。
+    // 调用者持有页面的锁，不能在这里等待
+    LockManager::LockKey key{table->table_id(), record.rid().page_num, record.rid().slot_num};
+    bool acquired = false;
+    RC rc = trx_kit_.lock_manager().try_lock(trx_id_, key, acquired);
+    if (acquired) {
+      locks_.push_back(key);
     }
-  } else if (begin_xid < 0) {
-    // begin xid 小于0说明是刚插入而且没有提交的数据
-    rc = (-begin_xid == trx_id_) ? RC::SUCCESS : RC::RECORD_INVISIBLE;
-  } else if (end_xid < 0) {
-    // end xid 小于0 说明是正在删除但是还没有提交的数据
-    if (readonly) {
-      // 如果 -end_xid 就是当前事务的事务号，说明是当前事务删除的
-      rc = (-end_xid != trx_id_) ? RC::SUCCESS : RC::RECORD_INVISIBLE;
-    } else {
-      // 如果当前想要修改此条数据，并且不是当前事务删除的，简单的报错
-      // 这是事务并发处理的一种方式，非常简单粗暴。其它的并发处理方法，可以等待，或者让客户端重试
-      // 或者等事务结束后，再检测修改的数据是否有冲突
-      rc = (-end_xid != trx_id_) ? RC::LOCKED_CONCURRENCY_CONFLICT : RC::RECORD_INVISIBLE;
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+
+    const int32_t begin_xid = resolve_xid(begin_field.get_int(record));
+    if (begin_xid < 0 && -begin_xid != trx_id_) {
+      LOG_WARN("record is modified by other transaction without lock. begin_xid=%d, current trx id=%d, rid=%s",
+               begin_xid, trx_id_, record.rid().to_string().c_str());
+      return RC::LOCKED_CONCURRENCY_CONFLICT;
+    }
+
+    const int32_t end_xid = resolve_xid(end_field.get_int(record));
+    if (end_xid == trx_kit_.max_trx_id()) {
+      return RC::SUCCESS;
     }
+    // 已经被提交的事务或者当前事务删除
+    if (end_xid > 0 || -end_xid == trx_id_) {
+      return RC::RECORD_INVISIBLE;
+    }
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
   }
-  return rc;
+
+  int32_t begin_xid = resolve_xid(begin_field.get_int(record));
+  if (begin_xid_visible(begin_xid)) {
+    return check_end_xid(resolve_xid(end_field.get_int(record)), readonly);
+  }
+
+  // 最新的版本是其它事务修改(插入)的，还没有提交或者在当前事务开始之后才提交
+  VersionStore &version_store = trx_kit_.version_store();
+  auto version_visible = [this, &begin_field](const char *data) {
+    Record version;
+    version.set_data(const_cast<char *>(data));
+    return begin_xid_visible(begin_field.get_int(version));
+  };
+  string version_data;
+  if (!version_store.find(table->table_id(), record.rid(), version_visible, version_data)) {
+    return RC::RECORD_INVISIBLE;
+  }
+
+  // 历史版本随时可能被清理，record 持有一份拷贝
+  char *data = static_cast<char *>(malloc(version_data.size()));
+  ASSERT(nullptr != data, "failed to allocate memory. size=%d", static_cast<int>(version_data.size()));
+  memcpy(data, version_data.data(), version_data.size());
+  record.set_data_owner(data, static_cast<int>(version_data.size()));
+  return check_end_xid(end_field.get_int(record), readonly);
+}
+
+RC MvccTrx::lock_record(Table *table, const RID &rid)
+{
+  LockManager::LockKey key{table->table_id(), rid.page_num, rid.slot_num};
+  bool acquired = false;
+  RC rc = trx_kit_.lock_manager().lock(trx_id_, key, lock_wait_timeout_ms_, acquired);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to lock record. trx id=%d, table=%s, rid=%s, rc=%s",
+             trx_id_, table->name(), rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  if (acquired) {
+    locks_.push_back(key);
+  }
+  return RC::SUCCESS;
+}
+
+void MvccTrx::release_locks()
+{
+  if (!locks_.empty()) {
+    trx_kit_.lock_manager().unlock_all(trx_id_, locks_);
+    locks_.clear();
+  }
+}
+
+int32_t MvccTrx::resolve_xid(int32_t xid) const
+{
+  if (xid >= 0 || -xid == trx_id_) {
+    return xid;
+  }
+
+  const int32_t commit_xid = trx_kit_.commit_table().find(-xid);
+  return commit_xid != 0 ? commit_xid : xid;
+}
+
+bool MvccTrx::begin_xid_visible(int32_t begin_xid) const
+{
+  if (begin_xid < 0) {
+    // begin xid 小于0说明是刚插入或刚修改而且没有提交的数据
+    return -begin_xid == trx_id_;
+  }
+  return read_view_.visible(begin_xid);
+}
+
+RC MvccTrx::check_end_xid(int32_t end_xid, bool readonly) const
+{
+  if (end_xid > 0) {
+    // 没有删除的记录 end xid 是最大的事务号，任何读视图都看不到
+    return read_view_.visible(end_xid) ? RC::RECORD_INVISIBLE : RC::SUCCESS;
+  }
+
+  // end xid 小于0 说明是正在删除但是还没有提交的数据
+  if (readonly) {
+    // 如果 -end_xid 就是当前事务的事务号，说明是当前事务删除的
+    return (-end_xid != trx_id_) ? RC::SUCCESS : RC::RECORD_INVISIBLE;
+  }
+  // 如果当前想要修改此条数据，并且不是当前事务删除的，简单的报错
+  // 或者等事务结束后，再检测修改的数据是否有冲突
+  return (-end_xid != trx_id_) ? RC::LOCKED_CONCURRENCY_CONFLICT : RC::RECORD_INVISIBLE;
 }
 
-/**
- * @brief 获取指定表上的事务使用的字段
- * 
- * @param table 指定的表
- * @param begin_xid_field 返回处理begin_xid的字段
- * @param end_xid_field   返回处理end_xid的字段
- */
 void MvccTrx::trx_fields(Table *table, Field &begin_xid_field, Field &end_xid_field) const
 {
-  const TableMeta &table_meta = table->table_meta();
-  const std::pair<const FieldMeta *, int> trx_fields = table_meta.trx_fields();
-  ASSERT(trx_fields.second >= 2, "invalid trx fields number. %d", trx_fields.second);
+  xid_fields(table, begin_xid_field, end_xid_field);
+}
 
-  begin_xid_field.set_table(table);
-  begin_xid_field.set_field(&trx_fields.first[0]);
-  end_xid_field.set_table(table);
-  end_xid_field.set_field(&trx_fields.first[1]);
+RC MvccTrx::set_read_only(bool read_only)
+{
+  if (started_ || !operations_.empty()) {
+    LOG_WARN("cannot change read only mode of a started trx. trx id=%d, read only=%d", trx_id_, read_only);
+    return RC::INVALID_ARGUMENT;
+  }
+  return Trx::set_read_only(read_only);
 }
 
 RC MvccTrx::start_if_need()
 {
   if (!started_) {
     ASSERT(operations_.empty(), "try to start a new trx while operations is not empty");
-    trx_id_ = trx_kit_.next_trx_id();
+    if (read_only_) {
+      // 只读事务只需要一个读视图，不分配事务号，不登记，也不写日志
+      trx_id_    = 0;
+      read_view_ = trx_kit_.create_read_view();
+      started_   = true;
+      return RC::SUCCESS;
+    }
+
+    trx_id_ = trx_kit_.start_trx(this);
+    read_view_ = trx_kit_.create_read_view();
     LOG_DEBUG("current thread change to new trx with %d", trx_id_);
     RC rc = log_manager_->begin_trx(trx_id_);
     ASSERT(rc == RC::SUCCESS, "failed to append log to clog. rc=%s", strrc(rc));
@@ -259,142 +712,283 @@ RC MvccTrx::start_if_need()
   return RC::SUCCESS;
 }
 
-RC MvccTrx::commit()
+void MvccTrx::end_read_only()
 {
-  int32_t commit_id = trx_kit_.next_trx_id();
-  return commit_with_trx_id(commit_id);
+  if (started_) {
+    trx_kit_.close_read_view(read_view_);
+    started_ = false;
+  }
+  read_only_ = false;
 }
 
-RC MvccTrx::commit_with_trx_id(int32_t commit_xid)
+RC MvccTrx::commit()
 {
-  // TODO 这里存在一个很大的问题，不能让其他事务一次性看到当前事务更新到的数据或同时看不到
-  RC rc = RC::SUCCESS;
-  started_ = false;
-  
-  for (const Operation &operation : operations_) {
-    switch (operation.type()) {
-      case Operation::Type::INSERT: {
-        RID rid(operation.page_num(), operation.slot_num());
-        Table *table = operation.table();
-        Field begin_xid_field, end_xid_field;
-        trx_fields(table, begin_xid_field, end_xid_field);
-
-        auto record_updater = [ this, &begin_xid_field, commit_xid](Record &record) {
-          LOG_DEBUG("before commit insert record. trx id=%d, begin xid=%d, commit xid=%d, lbt=%s",
-                    trx_id_, begin_xid_field.get_int(record), commit_xid, lbt());
-          ASSERT(begin_xid_field.get_int(record) == -this->trx_id_, 
-                 "got an invalid record while committing. begin xid=%d, this trx id=%d", 
-                 begin_xid_field.get_int(record), trx_id_);
-
-          begin_xid_field.set_int(record, commit_xid);
-        };
+  if (read_only_) {
+    end_read_only();
+    return RC::SUCCESS;
+  }
 
-        rc = operation.table()->visit_record(rid, false/*readonly*/, record_updater);
-        ASSERT(rc == RC::SUCCESS, "failed to get record while committing. rid=%s, rc=%s",
-               rid.to_string().c_str(), strrc(rc));
-      } break;
+  // 索引与记录不一致，不能提交
+  RC rc = apply_index_updates();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("rollback trx as index entries failed to update. trx id=%d, rc=%s", trx_id_, strrc(rc));
+    RC rc2 = rollback();
+    if (OB_FAIL(rc2)) {
+      LOG_WARN("failed to rollback trx. trx id=%d, rc=%s", trx_id_, strrc(rc2));
+    }
+    return rc;
+  }
 
-      case Operation::Type::DELETE: {
-        Table *table = operation.table();
-        RID rid(operation.page_num(), operation.slot_num());
-        
-        Field begin_xid_field, end_xid_field;
-        trx_fields(table, begin_xid_field, end_xid_field);
-
-        auto record_updater = [this, &end_xid_field, commit_xid](Record &record) {
-          (void)this;
-          ASSERT(end_xid_field.get_int(record) == -trx_id_, 
-                 "got an invalid record while committing. end xid=%d, this trx id=%d", 
-                 end_xid_field.get_int(record), trx_id_);
-                
-          end_xid_field.set_int(record, commit_xid);
-        };
+  // 有修改的事务，登记提交号之前，新创建的读视图都看不到这次提交
+  const bool has_operations = !operations_.empty();
+  int32_t commit_id = has_operations ? trx_kit_.begin_commit(this) : trx_kit_.next_trx_id();
 
-        rc = operation.table()->visit_record(rid, false/*readonly*/, record_updater);
-        ASSERT(rc == RC::SUCCESS, "failed to get record while committing. rid=%s, rc=%s",
-               rid.to_string().c_str(), strrc(rc));
-      } break;
+  // 修改过的记录上还是负的事务号，提交号写到记录上之前，恢复时仍然需要重做这个事务的提交
+  if (has_operations) {
+    log_manager_->retain_trx(trx_id_);
+  }
 
-      default: {
-        ASSERT(false, "unsupported operation. type=%d", static_cast<int>(operation.type()));
-      }
+  LSN commit_lsn = 0;
+  rc = log_manager_->commit_trx(trx_id_, commit_id, &commit_lsn, durability_);
+  LOG_TRACE("append trx commit log. trx id=%d, commit_xid=%d, rc=%s", trx_id_, commit_id, strrc(rc));
+  if (OB_FAIL(rc)) {
+    if (has_operations) {
+      trx_kit_.end_commit(commit_id, this);
     }
+    return rc;
   }
 
+  // 登记提交号以后，其它事务同时看到这个事务所有的修改。提交号由后台写到记录上，提交的代价与修改的记录数无关
+  started_ = false;
+  if (has_operations) {
+    trx_kit_.commit_table().add(trx_id_, commit_id);
+
+    MvccTrxKit::CommittedTrx committed_trx;
+    committed_trx.trx_id      = trx_id_;
+    committed_trx.commit_xid  = commit_id;
+    committed_trx.commit_lsn  = commit_lsn;
+    committed_trx.log_manager = log_manager_;
+    committed_trx.operations = std::move(operations_);
+    trx_kit_.add_committed_trx(std::move(committed_trx));
+    trx_kit_.end_commit(commit_id, this);
+  }
+
+  // 提交号已经可以查到，等锁的事务拿到锁以后读到的是提交后的版本
+  release_locks();
+
   operations_.clear();
+  update_undos_.clear();
+  trx_kit_.close_read_view(read_view_);
+  trx_kit_.end_trx(trx_id_, this);
+  return RC::SUCCESS;
+}
 
-  if (!recovering_) {
-    rc = log_manager_->commit_trx(trx_id_, commit_xid);
+RC MvccTrx::commit_with_trx_id(int32_t commit_xid, LSN commit_lsn, const RedoPartitionFilter &filter)
+{
+  // 重做时直接把提交号写到记录上。提交时修改的页面可能在写提交日志之后又被其它事务修改并落盘，
+  // 页面LSN不能说明提交是否已经反映在页面上，所以根据记录上的事务号判断
+  vector<Operation> operations;
+  operations_.sorted(operations, filter);
+  RC rc = OperationLog::for_each_page(
+      operations, [this, commit_xid, commit_lsn](const Operation *begin, const Operation *end) {
+        return commit_page(trx_kit_.version_store(), begin, end, trx_id_, commit_xid, commit_lsn);
+      });
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to commit records. trx id=%d, commit xid=%d, rc=%s", trx_id_, commit_xid, strrc(rc));
+    return rc;
   }
-  LOG_TRACE("append trx commit log. trx id=%d, commit_xid=%d, rc=%s", trx_id_, commit_xid, strrc(rc));
-  return rc;
+
+  if (!filter) {
+    started_ = false;
+    operations_.clear();
+    update_undos_.clear();
+  }
+  return RC::SUCCESS;
 }
 
 RC MvccTrx::rollback()
+{
+  if (read_only_) {
+    end_read_only();
+    return RC::SUCCESS;
+  }
+
+  // 推迟的索引项先修改，回滚时记录和索引一起恢复
+  apply_index_updates();
+
+  LSN rollback_lsn = 0;
+  if (!recovering_) {
+    RC rc = log_manager_->rollback_trx(trx_id_, &rollback_lsn);
+    LOG_TRACE("append trx rollback log. trx id=%d, rc=%s", trx_id_, strrc(rc));
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return rollback_with_lsn(rollback_lsn);
+}
+
+RC MvccTrx::rollback_with_lsn(LSN rollback_lsn, const RedoPartitionFilter &filter)
 {
   RC rc = RC::SUCCESS;
-  started_ = false;
+  if (!filter) {
+    started_ = false;
+  }
   
-  for (const Operation &operation : operations_) {
-    switch (operation.type()) {
-      case Operation::Type::INSERT: {
-        RID rid(operation.page_num(), operation.slot_num());
-        Record record;
-        Table *table = operation.table();
-        // TODO 这里虽然调用get_record好像多次一举，而且看起来放在table的实现中更好，
-        // 而且实际上trx应该记录下来自己曾经插入过的数据
-        // 也就是不需要从table中获取这条数据，可以直接从当前内存中获取
-        // 这里也可以不删除，仅仅给数据加个标识位，等垃圾回收器来收割也行
-        rc = table->get_record(rid, record); 
-        ASSERT(rc == RC::SUCCESS, "failed to get record while rollback. rid=%s, rc=%s", 
-               rid.to_string().c_str(), strrc(rc));
-        rc = table->delete_record(record);
-        ASSERT(rc == RC::SUCCESS, "failed to delete record while rollback. rid=%s, rc=%s",
-              rid.to_string().c_str(), strrc(rc));
-      } break;
+  // 与提交一样，重做时根据记录上的事务号判断回滚是否已经反映在页面上
+  vector<Operation> operations;
+  operations_.sorted(operations, filter);
+  rc = OperationLog::for_each_page(operations, [this, rollback_lsn](const Operation *begin, const Operation *end) {
+    return rollback_page(begin, end, rollback_lsn);
+  });
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to rollback records. trx id=%d, rc=%s", trx_id_, strrc(rc));
+  }
+
+  if (!filter) {
+    operations_.clear();
+    update_undos_.clear();
+    index_update_rc_ = RC::SUCCESS;
+    if (!recovering_) {
+      // 重做日志时创建的事务由 destroy_trx 删除
+      trx_kit_.close_read_view(read_view_);
+      release_locks();
+      trx_kit_.end_trx(trx_id_, this);
+    }
+  }
+  return rc;
+}
 
+void MvccTrx::rollback_insert(const Operation &operation)
+{
+  RID rid(operation.page_num(), operation.slot_num());
+  Record record;
+  Table *table = operation.table();
+  Field begin_xid_field, end_xid_field;
+  trx_fields(table, begin_xid_field, end_xid_field);
+  // TODO 这里虽然调用get_record好像多次一举，而且看起来放在table的实现中更好，
+  // 而且实际上trx应该记录下来自己曾经插入过的数据
+  // 也就是不需要从table中获取这条数据，可以直接从当前内存中获取
+  // 这里也可以不删除，仅仅给数据加个标识位，等垃圾回收器来收割也行
+  RC rc = table->get_record(rid, record); 
+  if (recovering_ && (rc == RC::RECORD_NOT_EXIST || begin_xid_field.get_int(record) != -trx_id_)) {
+    return;
+  }
+  ASSERT(rc == RC::SUCCESS, "failed to get record while rollback. rid=%s, rc=%s", 
+         rid.to_string().c_str(), strrc(rc));
+  rc = table->delete_record(record);
+  ASSERT(rc == RC::SUCCESS, "failed to delete record while rollback. rid=%s, rc=%s",
+        rid.to_string().c_str(), strrc(rc));
+}
+
+RC MvccTrx::rollback_page(const Operation *begin, const Operation *end, LSN rollback_lsn)
+{
+  Table *table = begin->table();
+  Field begin_xid_field, end_xid_field;
+  trx_fields(table, begin_xid_field, end_xid_field);
+
+  // 插入的记录回滚时要删除，不能和其它记录一起在页面上原地修改
+  vector<const Operation *> operations;
+  vector<SlotNum>           slots;
+  for (const Operation *operation = begin; operation != end; ++operation) {
+    if (operation->type() == Operation::Type::INSERT) {
+      rollback_insert(*operation);
+    } else {
+      operations.push_back(operation);
+      slots.push_back(operation->slot_num());
+    }
+  }
+  if (operations.empty()) {
+    return RC::SUCCESS;
+  }
+
+  // 索引扫描是先锁索引页面再锁数据页面，这里持有数据页面的锁时不能修改索引，否则加锁顺序相反。
+  // 先记录下来，页面上的记录恢复以后再回滚索引项
+  struct IndexUndo
+  {
+    RID          rid;
+    vector<char> new_data;  ///< 回滚前的记录
+    vector<char> old_data;  ///< 回滚后的记录
+  };
+  vector<IndexUndo> index_undos;
+
+  auto record_updater = [this, table, &operations, &begin_xid_field, &end_xid_field, &index_undos](
+                            int index, Record &record) {
+    const Operation &operation = *operations[index];
+    switch (operation.type()) {
       case Operation::Type::DELETE: {
-        Table *table = operation.table();
-        RID rid(operation.page_num(), operation.slot_num());
-        
-        ASSERT(rc == RC::SUCCESS, "failed to get record while rollback. rid=%s, rc=%s",
-              rid.to_string().c_str(), strrc(rc));
-        Field begin_xid_field, end_xid_field;
-        trx_fields(table, begin_xid_field, end_xid_field);
-
-        auto record_updater = [this, &end_xid_field](Record &record) {
-          ASSERT(end_xid_field.get_int(record) == -trx_id_, 
-                "got an invalid record while rollback. end xid=%d, this trx id=%d", 
-                end_xid_field.get_int(record), trx_id_);
-
-          end_xid_field.set_int(record, trx_kit_.max_trx_id());
-        };
-        
-        rc = table->visit_record(rid, false/*readonly*/, record_updater);
-        ASSERT(rc == RC::SUCCESS, "failed to get record while committing. rid=%s, rc=%s",
-               rid.to_string().c_str(), strrc(rc));
-      } break;
+        if (recovering_ && end_xid_field.get_int(record) != -trx_id_) {
+          return false;
+        }
+        ASSERT(end_xid_field.get_int(record) == -trx_id_, 
+              "got an invalid record while rollback. end xid=%d, this trx id=%d", 
+              end_xid_field.get_int(record), trx_id_);
+
+        end_xid_field.set_int(record, trx_kit_.max_trx_id());
+        return true;
+      }
+
+      case Operation::Type::UPDATE: {
+        if (begin_xid_field.get_int(record) != -trx_id_) {
+          // 只有重做时才会出现：回滚已经反映在页面上了
+          ASSERT(recovering_, "got an invalid record while rollback. begin xid=%d, this trx id=%d",
+                 begin_xid_field.get_int(record), trx_id_);
+          return false;
+        }
+
+        auto iter = update_undos_.find(operation);
+        ASSERT(iter != update_undos_.end(), "cannot find undo data of update. rid=%s", record.rid().to_string().c_str());
+        const vector<UpdateUndo> &undos = iter->second;
+
+        vector<char> old_data(record.data(), record.data() + table->table_meta().record_size());
+        for (auto undo = undos.rbegin(); undo != undos.rend(); ++undo) {
+          memcpy(old_data.data() + undo->offset, undo->old_data.data(), undo->old_data.size());
+        }
+
+        index_undos.push_back(
+            IndexUndo{record.rid(), vector<char>(record.data(), record.data() + old_data.size()), old_data});
+        memcpy(record.data(), old_data.data(), old_data.size());
+        return true;
+      }
 
       default: {
         ASSERT(false, "unsupported operation. type=%d", static_cast<int>(operation.type()));
+        return false;
       }
     }
+  };
+
+  RC rc = table->modify_records(begin->page_num(), slots, rollback_lsn, record_updater);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("failed to get records while rollback. table=%s, page=%d, rc=%s",
+              table->name(), begin->page_num(), strrc(rc));
+    return rc;
   }
 
-  operations_.clear();
+  // 修改索引项失败过的记录，索引中还是修改前的索引项
+  const bool tolerant = recovering_ || OB_FAIL(index_update_rc_);
+  for (const IndexUndo &undo : index_undos) {
+    rc = table->update_entry_of_indexes(undo.new_data.data(), undo.old_data.data(), undo.rid, tolerant);
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("failed to rollback index entries. rid=%s, rc=%s", undo.rid.to_string().c_str(), strrc(rc));
+      return rc;
+    }
+  }
 
-  if (!recovering_) {
-    rc = log_manager_->rollback_trx(trx_id_);
+  for (const Operation *operation : operations) {
+    if (operation->type() == Operation::Type::UPDATE) {
+      RID rid(operation->page_num(), operation->slot_num());
+      trx_kit_.version_store().rollback(table->table_id(), rid, trx_id_);
+    }
   }
-  LOG_TRACE("append trx rollback log. trx id=%d, rc=%s", trx_id_, strrc(rc));
-  return rc;
+  return RC::SUCCESS;
 }
 
 RC find_table(Db *db, const CLogRecord &log_record, Table *&table)
 {
   switch (clog_type_from_integer(log_record.header().type_)) {
     case CLogType::INSERT:
-    case CLogType::DELETE: {
+    case CLogType::DELETE:
+    case CLogType::UPDATE: {
       const CLogRecordData &data_record = log_record.data_record();
       table = db->find_table(data_record.table_id_);
       if (nullptr == table) {
@@ -411,6 +1005,56 @@ RC find_table(Db *db, const CLogRecord &log_record, Table *&table)
 }
 
 RC MvccTrx::redo(Db *db, const CLogRecord &log_record)
+{
+  RC rc = redo_analyze(db, log_record);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  return redo_partition(db, log_record, nullptr);
+}
+
+RC MvccTrx::redo_analyze(Db *db, const CLogRecord &log_record)
+{
+  Table *table = nullptr;
+  RC rc = find_table(db, log_record, table);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  switch (log_record.log_type()) {
+    case CLogType::INSERT: {
+      operations_.append(Operation(Operation::Type::INSERT, table, log_record.data_record().rid_));
+    } break;
+
+    case CLogType::DELETE: {
+      operations_.append(Operation(Operation::Type::DELETE, table, log_record.data_record().rid_));
+    } break;
+
+    case CLogType::UPDATE: {
+      const CLogRecordData &data_record = log_record.data_record();
+      const int32_t len = data_record.data_len_ / 2;
+      Operation operation(Operation::Type::UPDATE, table, data_record.rid_);
+      vector<UpdateUndo> &undos = update_undos_[operation];
+      if (undos.empty()) {
+        operations_.append(operation);
+      }
+      undos.push_back(UpdateUndo{data_record.data_offset_, string(data_record.data_ + len, len)});
+    } break;
+
+    case CLogType::MTR_COMMIT:
+    case CLogType::MTR_ROLLBACK: {
+      // 提交和回滚在重做线程中处理
+    } break;
+
+    default: {
+      ASSERT(false, "unsupported redo log. log_record=%s", log_record.to_string().c_str());
+      return RC::INTERNAL;
+    } break;
+  }
+  return RC::SUCCESS;
+}
+
+RC MvccTrx::redo_partition(Db *db, const CLogRecord &log_record, const RedoPartitionFilter &filter)
 {
   Table *table = nullptr;
   RC rc = find_table(db, log_record, table);
@@ -424,13 +1068,12 @@ RC MvccTrx::redo(Db *db, const CLogRecord &log_record)
       Record record;
       record.set_data(const_cast<char *>(data_record.data_), data_record.data_len_);
       record.set_rid(data_record.rid_);
-      RC rc = table->recover_insert_record(record);
+      RC rc = table->recover_insert_record(record, log_record.end_lsn());
       if (OB_FAIL(rc)) {
         LOG_WARN("failed to recover insert. table=%s, log record=%s, rc=%s",
                  table->name(), log_record.to_string().c_str(), strrc(rc));
         return rc;
       }
-      operations_.insert(Operation(Operation::Type::INSERT, table, record.rid()));
     } break;
 
     case CLogType::DELETE: {
@@ -446,22 +1089,36 @@ RC MvccTrx::redo(Db *db, const CLogRecord &log_record)
                end_field.get_int(record), trx_id_);
                 
         end_field.set_int(record, -trx_id_);
+        return true;
       };
 
-      RC rc = table->visit_record(data_record.rid_, false/*readonly*/, record_updater);
+      // 页面LSN不小于日志的位置时，删除已经反映在页面上了
+      RC rc = table->redo_modify_record(data_record.rid_, log_record.end_lsn(), record_updater);
       ASSERT(rc == RC::SUCCESS, "failed to get record while committing. rid=%s, rc=%s",
              data_record.rid_.to_string().c_str(), strrc(rc));
-      
-      operations_.insert(Operation(Operation::Type::DELETE, table, data_record.rid_));
+    } break;
+
+    case CLogType::UPDATE: {
+      const CLogRecordData &data_record = log_record.data_record();
+      const int32_t len = data_record.data_len_ / 2;
+      RC rc = table->recover_update_record(data_record.rid_, data_record.data_offset_, len,
+                                           data_record.data_, data_record.data_ + len, log_record.end_lsn());
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to recover update. table=%s, log record=%s, rc=%s",
+                 table->name(), log_record.to_string().c_str(), strrc(rc));
+        return rc;
+      }
     } break;
 
     case CLogType::MTR_COMMIT: {
       const CLogRecordCommitData &commit_record = log_record.commit_record();
-      commit_with_trx_id(commit_record.commit_xid_);
+      // 提交号与事务号来自同一个计数器，重启以后不能再分配出去
+      trx_kit_.advance_trx_id(commit_record.commit_xid_);
+      commit_with_trx_id(commit_record.commit_xid_, log_record.end_lsn(), filter);
     } break;
 
     case CLogType::MTR_ROLLBACK: {
-      rollback();
+      rollback_with_lsn(log_record.end_lsn(), filter);
     } break;
     
     default: {
@@ -14,9 +14,20 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
+#include "storage/trx/commit_table.h"
+#include "storage/trx/lock_manager.h"
+#include "storage/trx/read_view.h"
 #include "storage/trx/trx.h"
+#include "storage/trx/trx_registry.h"
+#include "storage/trx/version_store.h"
 
 class CLogManager;
 
@@ -34,24 +45,121 @@ public:
 
   /**
    * @brief 找到对应事务号的事务
-   * @details 当前仅在recover场景下使用
+   * @details 只能找到已经开始(分配了事务号)的事务
    */
   Trx *find_trx(int32_t trx_id) override;
   void all_trxes(std::vector<Trx *> &trxes) override;
 
+  /**
+   * @brief 把还没有写到记录上的提交号都写到记录上
+   * @details CONCURRENCY 模式下后台线程会定期调用，否则在语句之间积累得足够多时调用
+   */
+  void resolve_commits() override;
+
+  /**
+   * @brief 没有开启 CONCURRENCY 时，没有改写的记录超过 RESOLVE_BATCH 条才改写
+   * @details CONCURRENCY 模式下由后台线程改写，这里什么都不做
+   */
+  void resolve_commits_if_needed() override;
+
+  int32_t current_trx_id() const override { return current_trx_id_.load(); }
+  void    advance_trx_id(int32_t trx_id) override;
+
 public:
   int32_t next_trx_id();
 
+  /**
+   * @brief 为事务分配一个事务号并登记为活跃事务
+   * @return 事务号
+   */
+  int32_t start_trx(Trx *trx);
+
+  /**
+   * @brief 事务结束，从活跃事务表中删除
+   * @details 每结束 PURGE_INTERVAL 个事务清理一次不再需要的历史版本
+   */
+  void end_trx(int32_t trx_id, Trx *trx);
+
+  /**
+   * @brief 为要提交修改的事务分配提交号，并登记为提交中的事务
+   * @details 提交号登记到 commit_table 之后调用 end_commit。创建读视图时，提交中的事务都不可见
+   * @return 提交号
+   */
+  int32_t begin_commit(Trx *trx);
+  void    end_commit(int32_t commit_xid, Trx *trx);
+
+  /**
+   * @brief 创建读视图
+   * @details 读视图关闭之前，它看不到的提交所替代的历史版本不会被清理。创建和关闭都不加锁
+   */
+  ReadView create_read_view();
+  void     close_read_view(ReadView &read_view);
+
+  /**
+   * @brief 所有现在以及之后的读视图都能看到提交号小于这个值的提交，被这些提交替代的历史版本可以清理
+   */
+  int32_t purge_horizon();
+
 public:
   int32_t max_trx_id() const;
 
+  VersionStore &version_store() { return version_store_; }
+  CommitTable  &commit_table() { return commit_table_; }
+  LockManager  &lock_manager() { return lock_manager_; }
+
+  /**
+   * @brief 提交时没有改写记录的事务
+   */
+  struct CommittedTrx
+  {
+    int32_t                trx_id      = 0;
+    int32_t                commit_xid  = 0;
+    LSN                    commit_lsn  = 0;        ///< 改写的页面记录提交日志的位置
+    CLogManager *          log_manager = nullptr;  ///< 改写完成以后通知日志不再保留这个事务
+    OperationLog           operations;
+  };
+
+  /**
+   * @brief 事务已经在 commit_table 中登记了提交号，之后再把提交号写到它修改过的记录上
+   * @details 只是登记，不访问记录。CONCURRENCY 模式下由后台线程改写；否则页面的锁不起作用，
+   * 不启动后台线程，由 resolve_commits_if_needed 在语句之间改写
+   */
+  void add_committed_trx(CommittedTrx &&trx);
+
+private:
+  void resolve_thread_func();
+  void stop_resolve_thread();
+
+private:
+  static constexpr int PURGE_INTERVAL      = 128;
+  static constexpr int RESOLVE_INTERVAL_MS = 100;   ///< 后台线程改写记录的间隔
+  static constexpr int RESOLVE_BATCH       = 4096;  ///< 没有改写的记录超过这么多时立即改写
+
 private:
   std::vector<FieldMeta> fields_; // 存储事务数据需要用到的字段元数据，所有表结构都需要带的
 
   std::atomic<int32_t> current_trx_id_{0};
 
-  common::Mutex      lock_;
-  std::vector<Trx *> trxes_;
+  TrxRegistry registry_;    ///< 已经开始的事务，按照事务号登记
+  TrxRegistry committing_;  ///< 提交中的事务，按照提交号登记
+
+  ReadViewSlots view_slots_;  ///< 所有打开的读视图
+
+  VersionStore     version_store_;        ///< 记录的历史版本
+  std::atomic<int> finished_trx_num_{0};  ///< 上次清理历史版本以后结束的事务个数
+
+  LockManager lock_manager_;  ///< 修改记录时加的行锁
+
+  CommitTable              commit_table_;       ///< 提交号还没有写到记录上的事务
+  std::mutex               committed_lock_;     ///< 保护 committed_trxes_ 和 committed_op_num_
+  std::deque<CommittedTrx> committed_trxes_;    ///< 等待改写记录的事务，按照提交的顺序
+  int64_t                  committed_op_num_ = 0;
+  std::mutex               resolve_lock_;       ///< 同一时刻只有一个线程在改写记录
+
+  std::thread             resolve_thread_;
+  std::mutex              resolve_thread_lock_;
+  std::condition_variable resolve_cond_;
+  bool                    resolve_stopped_ = false;
 };
 
 /**
@@ -68,41 +176,132 @@ public:
 
   RC insert_record(Table *table, std::vector<Record> &records) override; // UNIMPLENMENT
   RC delete_record(Table *table, Record &record) override; 
-  RC update_record(Table *table, Record &record, const Value &value, const std::string &field) override; // UNIMPLENMENT
+
+  /**
+   * @brief 原地修改记录
+   * @details 只把发生变化的字节写到日志中(UPDATE日志)，修改前的数据保存在内存中用于回滚。
+   * 修改后的记录 begin xid 是负的事务号。修改前的完整记录作为历史版本放到 VersionStore 中，
+   * 看不到新版本的事务读取历史版本。
+   * 调用者持有记录所在页面的锁，索引项的修改先记录下来，由 apply_index_updates 修改。
+   */
+  RC update_record(Table *table, Record &record, const Value &value, const std::string &field) override;
 
   /**
    * @brief 当访问到某条数据时，使用此函数来判断是否可见，或者是否有访问冲突
+   * @details 只读访问不加锁，可见性由事务开始时创建的读视图决定。
+   * 如果页面上最新的版本不可见，沿着版本链找到可见的历史版本，record 改为指向这个版本的一份拷贝。
+   * 修改时先对记录加行锁，然后读取最新提交的版本(当前读)，修改总是基于最新的版本。
+   * 调用者持有记录所在页面的锁，这里不等待行锁，锁被其它事务持有时返回 LOCKED_NEED_WAIT，
+   * 由调用者释放页面的锁以后调用 lock_record 等待。
    * 
    * @param table    要访问的数据属于哪张表
    * @param record   要访问哪条数据
    * @param readonly 是否只读访问
    * @return RC      - SUCCESS 成功
    *                 - RECORD_INVISIBLE 此数据对当前事务不可见，应该跳过
+   *                 - LOCKED_NEED_WAIT 行锁被其它事务持有，需要释放页面的锁以后等待
    *                 - LOCKED_CONCURRENCY_CONFLICT 与其它事务有冲突
    */
   RC visit_record(Table *table, Record &record, bool readonly) override;
 
+  /**
+   * @brief 对要修改的记录加行锁，锁被其它事务持有时等待它结束。事务结束时释放
+   * @return RC - SUCCESS 成功
+   *            - LOCKED_WAIT_TIMEOUT 等待行锁超时
+   *            - LOCKED_DEADLOCK 等待行锁时发生死锁，当前事务被选中放弃
+   */
+  RC lock_record(Table *table, const RID &rid) override;
+
+  /**
+   * @brief 修改 update_record 推迟的索引项
+   * @details 修改失败(比如违反唯一约束)时，记录已经修改了但是索引没有，事务只能回滚，提交时也会回滚并返回错误
+   */
+  RC apply_index_updates() override;
+
+  /**
+   * @brief 设置是否是只读事务
+   * @details 事务已经开始或者已经有修改时返回 INVALID_ARGUMENT，不能在事务中途切换
+   */
+  RC set_read_only(bool read_only) override;
+
   RC start_if_need() override;
   RC commit() override;
   RC rollback() override;
 
   RC redo(Db *db, const CLogRecord &log_record) override;
+  RC redo_analyze(Db *db, const CLogRecord &log_record) override;
+  RC redo_partition(Db *db, const CLogRecord &log_record, const RedoPartitionFilter &filter) override;
 
   int32_t id() const override { return trx_id_; }
 
 private:
-  RC commit_with_trx_id(int32_t commit_id);
+  /**
+   * @brief 重做提交日志，把提交号写到事务修改过的记录上，修改的页面记录提交日志的位置 commit_lsn
+   * @details 运行时提交只登记提交号，由 MvccTrxKit 延迟改写记录
+   * @param filter 并行恢复时只处理这个分区中的记录，并且保留事务的操作记录，其它分区还要使用
+   */
+  RC commit_with_trx_id(int32_t commit_id, LSN commit_lsn, const RedoPartitionFilter &filter = nullptr);
+  RC rollback_with_lsn(LSN rollback_lsn, const RedoPartitionFilter &filter = nullptr);
   void trx_fields(Table *table, Field &begin_xid_field, Field &end_xid_field) const;
 
+  /**
+   * @brief 回滚同一个页面上的删除和修改，页面只固定一次
+   */
+  RC   rollback_page(const Operation *begin, const Operation *end, LSN rollback_lsn);
+  void rollback_insert(const Operation &operation);
+
+  /**
+   * @brief 一个版本的 begin xid 是否对当前事务可见，即读视图能看到这个版本的提交，或者是当前事务自己修改的
+   */
+  bool begin_xid_visible(int32_t begin_xid) const;
+  RC   check_end_xid(int32_t end_xid, bool readonly) const;
+
+  void release_locks();
+
+  /**
+   * @brief 结束只读事务，只需要关闭读视图
+   */
+  void end_read_only();
+
+  /**
+   * @brief 记录上负的事务号如果属于已经提交的其它事务，返回它的提交号，否则原样返回
+   */
+  int32_t resolve_xid(int32_t xid) const;
+
 private:
   static const int32_t MAX_TRX_ID = std::numeric_limits<int32_t>::max();
 
 private:
-  using OperationSet = std::unordered_set<Operation, OperationHasher, OperationEqualer>;
+  /**
+   * @brief 还没有修改的索引项，记录从 old_data 修改为 new_data
+   */
+  struct IndexUpdate
+  {
+    Table            *table = nullptr;
+    RID               rid;
+    std::vector<char> old_data;
+    std::vector<char> new_data;
+  };
+
+  /**
+   * @brief 一次修改中一段数据修改前的内容，回滚时按照相反的顺序恢复
+   */
+  struct UpdateUndo
+  {
+    int32_t     offset;
+    std::string old_data;
+  };
+  using UpdateUndoMap = std::unordered_map<Operation, std::vector<UpdateUndo>, OperationHasher, OperationEqualer>;
+
   MvccTrxKit & trx_kit_;
   CLogManager *log_manager_ = nullptr;
   int32_t      trx_id_ = -1;
   bool         started_ = false;
   bool         recovering_ = false;
-  OperationSet operations_;
+  ReadView     read_view_;  ///< 事务开始时创建，事务结束时关闭
+  OperationLog operations_;  ///< 按照发生的顺序记录修改过的记录
+  UpdateUndoMap update_undos_;  ///< 每条修改过的记录的回滚数据
+  std::vector<IndexUpdate> index_updates_;  ///< 等待调用者释放页面的锁以后再修改的索引项
+  RC index_update_rc_ = RC::SUCCESS;  ///< 修改索引项失败以后，索引与记录不一致，事务只能回滚
+  std::vector<LockManager::LockKey> locks_;  ///< 持有的行锁
 };
@@ -0,0 +1,54 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <functional>
+#include <thread>
+
+#include "storage/trx/read_view.h"
+
+using namespace std;
+
+ReadViewSlots::ReadViewSlots(int capacity) : capacity_(capacity)
+{
+  slots_.reset(new atomic<int32_t>[capacity_]);
+  for (int i = 0; i < capacity_; i++) {
+    slots_[i].store(0);
+  }
+}
+
+int ReadViewSlots::acquire(int32_t floor)
+{
+  const size_t hint = hash<thread::id>()(this_thread::get_id());
+  for (size_t i = hint;; i++) {
+    atomic<int32_t> &slot = slots_[i % capacity_];
+    int32_t expected = 0;
+    if (slot.load() == 0 && slot.compare_exchange_strong(expected, floor)) {
+      return static_cast<int>(i % capacity_);
+    }
+    if ((i - hint) % capacity_ == static_cast<size_t>(capacity_ - 1)) {
+      this_thread::yield();
+    }
+  }
+}
+
+void ReadViewSlots::update(int slot, int32_t up_limit) { slots_[slot].store(up_limit); }
+
+void ReadViewSlots::release(int slot) { slots_[slot].store(0); }
+
+int32_t ReadViewSlots::min(int32_t limit) const
+{
+  for (int i = 0; i < capacity_; i++) {
+    const int32_t value = slots_[i].load();
+    if (value > 0 && value < limit) {
+      limit = value;
+    }
+  }
+  return limit;
+}
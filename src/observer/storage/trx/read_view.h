@@ -0,0 +1,106 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief 读视图
+ * @ingroup Transaction
+ * @details 事务开始时创建的一个快照，决定哪些提交对这个事务可见。
+ * 记录上保存的是提交号，提交号与事务号使用同一个计数器分配。分配了提交号但还没有完成提交的事务
+ * 登记在提交中的事务表里，创建读视图时从这个表中取出它们的提交号(active_)：
+ * - 提交号小于 up_limit_ 的提交都已经完成，可见；
+ * - 提交号不小于 low_limit_ 的提交在读视图创建之后才开始，不可见；
+ * - 两者之间的提交，不在 active_ 中就可见。
+ * 判断只需要几次整数比较，不加锁也不会失败。
+ */
+class ReadView
+{
+public:
+  ReadView() = default;
+
+  /**
+   * @param low_limit 这个提交号以及之后的提交都不可见
+   * @param active    创建时还没有完成的提交，从小到大排列，都小于 low_limit
+   */
+  ReadView(int32_t low_limit, std::vector<int32_t> &&active) : low_limit_(low_limit), active_(std::move(active))
+  {
+    up_limit_ = active_.empty() ? low_limit_ : active_.front();
+  }
+
+  bool visible(int32_t commit_xid) const
+  {
+    if (commit_xid < up_limit_) {
+      return true;
+    }
+    if (commit_xid >= low_limit_) {
+      return false;
+    }
+    return !std::binary_search(active_.begin(), active_.end(), commit_xid);
+  }
+
+  /**
+   * @brief 提交号小于这个值的提交都可见
+   */
+  int32_t up_limit() const { return up_limit_; }
+  int32_t low_limit() const { return low_limit_; }
+
+  /**
+   * @brief 读视图在 ReadViewSlots 中登记的位置
+   */
+  int  slot() const { return slot_; }
+  void set_slot(int slot) { slot_ = slot; }
+
+private:
+  int32_t              up_limit_  = 0;
+  int32_t              low_limit_ = 0;
+  std::vector<int32_t> active_;
+  int                  slot_ = -1;
+};
+
+/**
+ * @brief 打开的读视图的 up_limit，清理历史版本时不能越过它们
+ * @ingroup Transaction
+ * @details 每个读视图占用数组中的一个位置，按照线程选择起始位置，不同的线程一般不会访问同一个位置，
+ * 创建和关闭读视图都不加锁。
+ * 创建读视图之前先登记一个不大于 up_limit 的下界(floor)，取完快照以后再改成 up_limit，
+ * 这样在取快照的过程中计算的清理边界也不会越过这个读视图。
+ */
+class ReadViewSlots
+{
+public:
+  explicit ReadViewSlots(int capacity = 1024);
+
+  /**
+   * @brief 占用一个位置并登记下界
+   * @details 所有位置都被占用时等待其它读视图关闭
+   * @return 位置
+   */
+  int  acquire(int32_t floor);
+  void update(int slot, int32_t up_limit);
+  void release(int slot);
+
+  /**
+   * @brief 所有登记的值与 limit 中最小的一个
+   */
+  int32_t min(int32_t limit) const;
+
+  int capacity() const { return capacity_; }
+
+private:
+  int                                     capacity_ = 0;
+  std::unique_ptr<std::atomic<int32_t>[]> slots_;  ///< 0 表示空闲
+};
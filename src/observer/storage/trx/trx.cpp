@@ -12,7 +12,9 @@ See the Mulan PSL v2 for more details. */
 // Created by Wangyunlai on 2021/5/24.
 //
 
+#include <algorithm>
 #include <atomic>
+#include <tuple>
 
 #include "storage/trx/trx.h"
 #include "storage/table/table.h"
@@ -24,6 +26,63 @@ See the Mulan PSL v2 for more details. */
 #include "storage/trx/mvcc_trx.h"
 #include "storage/trx/vacuous_trx.h"
 
+void OperationLog::append(const Operation &operation)
+{
+  if (size_ == blocks_.size() * BLOCK_SIZE) {
+    blocks_.emplace_back(new Operation[BLOCK_SIZE]);
+  }
+  blocks_[size_ / BLOCK_SIZE][size_ % BLOCK_SIZE] = operation;
+  size_++;
+}
+
+void OperationLog::clear()
+{
+  if (blocks_.size() > 1) {
+    blocks_.resize(1);
+  }
+  size_ = 0;
+}
+
+void OperationLog::sorted(std::vector<Operation> &operations, const RedoPartitionFilter &filter) const
+{
+  operations.clear();
+  operations.reserve(size_);
+  for (size_t i = 0; i < size_; i++) {
+    const Operation &operation = blocks_[i / BLOCK_SIZE][i % BLOCK_SIZE];
+    if (!filter || filter(operation.table_id(), operation.page_num())) {
+      operations.push_back(operation);
+    }
+  }
+
+  auto key = [](const Operation &operation) {
+    return std::make_tuple(operation.table_id(), operation.page_num(), operation.slot_num(), operation.type());
+  };
+  std::sort(operations.begin(), operations.end(),
+       [&key](const Operation &op1, const Operation &op2) { return key(op1) < key(op2); });
+  auto last = std::unique(operations.begin(), operations.end(), OperationEqualer());
+  operations.erase(last, operations.end());
+}
+
+RC OperationLog::for_each_page(const std::vector<Operation> &operations,
+                               const std::function<RC(const Operation *, const Operation *)> &visitor)
+{
+  const Operation *end = operations.data() + operations.size();
+  for (const Operation *begin = operations.data(); begin != end;) {
+    const Operation *page_end = begin + 1;
+    while (page_end != end && page_end->table() == begin->table() && page_end->page_num() == begin->page_num()) {
+      page_end++;
+    }
+    RC rc = visitor(begin, page_end);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    begin = page_end;
+  }
+  return RC::SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 static TrxKit *global_trxkit = nullptr;
 
 TrxKit *TrxKit::create(const char *name)
@@ -65,3 +124,13 @@ RC Trx::redo(Db *db, const CLogRecord &)
 {
   return RC::UNIMPLENMENT;
 }
+
+RC Trx::redo_analyze(Db *db, const CLogRecord &)
+{
+  return RC::UNIMPLENMENT;
+}
+
+RC Trx::redo_partition(Db *db, const CLogRecord &, const RedoPartitionFilter &)
+{
+  return RC::UNIMPLENMENT;
+}
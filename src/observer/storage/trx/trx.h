@@ -15,15 +15,19 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <stddef.h>
+#include <functional>
+#include <memory>
 #include <unordered_set>
 #include <mutex>
 #include <utility>
+#include <vector>
 
 #include "sql/parser/parse.h"
 #include "sql/parser/parse_defs.h"
 #include "storage/record/record_manager.h"
 #include "storage/field/field_meta.h"
 #include "storage/table/table.h"
+#include "storage/clog/clog.h"
 #include "common/rc.h"
 
 /**
@@ -36,6 +40,13 @@ class CLogManager;
 class CLogRecord;
 class Trx;
 
+/**
+ * @brief 并行恢复时，判断一个页面是否属于当前重做线程负责的分区
+ * @ingroup Transaction
+ * @details 为空时表示所有页面
+ */
+using RedoPartitionFilter = std::function<bool(int32_t table_id, PageNum page_num)>;
+
 /**
  * @brief 描述一个操作，比如插入、删除行等
  * @ingroup Transaction
@@ -57,6 +68,7 @@ public:
   };
 
 public:
+  Operation() = default;
   Operation(Type type, Table *table, const RID &rid) 
       : type_(type), 
         table_(table),
@@ -72,11 +84,11 @@ public:
 
 private:
   ///< 操作的哪张表。这里直接使用表其实并不准确，因为表中的索引也可能有日志
-  Type type_;
+  Type type_ = Type::UNDEFINED;
   
   Table * table_ = nullptr;
-  PageNum page_num_; // TODO use RID instead of page num and slot num
-  SlotNum slot_num_;
+  PageNum page_num_ = -1; // TODO use RID instead of page num and slot num
+  SlotNum slot_num_ = -1;
 };
 
 class OperationHasher 
@@ -93,11 +105,47 @@ class OperationEqualer
 public:
   bool operator()(const Operation &op1, const Operation &op2) const
   {
-    return op1.table_id() == op2.table_id() &&
+    return op1.type() == op2.type() && op1.table_id() == op2.table_id() &&
         op1.page_num() == op2.page_num() && op1.slot_num() == op2.slot_num();
   }
 };
 
+/**
+ * @brief 事务的操作记录
+ * @ingroup Transaction
+ * @details 操作按照发生的顺序追加到固定大小的内存块中，追加时不需要计算哈希，也不会因为扩容复制已有的操作。
+ * 事务结束时保留第一个内存块，同一个会话的下一个事务继续使用。
+ * 提交和回滚时使用 sorted 按照表和页面排好序，同一个页面上的记录一起处理，每个页面只固定一次。
+ */
+class OperationLog
+{
+public:
+  void   append(const Operation &operation);
+  bool   empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  void   clear();
+
+  /**
+   * @brief 按照表、页面、槽位排序，并去掉重复的操作
+   * @param filter 不为空时只保留 filter 返回true的操作
+   */
+  void sorted(std::vector<Operation> &operations, const RedoPartitionFilter &filter = nullptr) const;
+
+  /**
+   * @brief 按照页面分组访问排好序的操作
+   * @param visitor 每个页面调用一次，参数是这个页面上的操作 [begin, end)。返回失败时停止访问
+   * @return visitor 返回的第一个错误
+   */
+  static RC for_each_page(const std::vector<Operation> &operations,
+                          const std::function<RC(const Operation *begin, const Operation *end)> &visitor);
+
+private:
+  static constexpr size_t BLOCK_SIZE = 512;  ///< 每个内存块中的操作个数
+
+  std::vector<std::unique_ptr<Operation[]>> blocks_;
+  size_t                                    size_ = 0;
+};
+
 /**
  * @brief 事务管理器
  * @ingroup Transaction
@@ -129,6 +177,30 @@ public:
 
   virtual void destroy_trx(Trx *trx) = 0;
 
+  /**
+   * @brief 把已经提交的事务的提交结果都写到记录上
+   * @details 事务提交时可能没有改写修改过的记录。关闭或者删除表、刷盘之前调用，之后不再访问已经提交的事务修改的表
+   */
+  virtual void resolve_commits() {}
+
+  /**
+   * @brief 没有写到记录上的提交积累得足够多时，把它们写到记录上
+   * @details 在两条语句之间调用，这时当前会话没有打开的算子，不会持有页面或者记录。
+   * 提交时只登记提交号，不改写记录；其它事务读到负的事务号时通过提交表判断可见性
+   */
+  virtual void resolve_commits_if_needed() {}
+
+  /**
+   * @brief 已经分配过的最大事务号(包括提交号)
+   * @details 检查点中记录这个值，重启以后不会再分配记录上已经使用过的事务号
+   */
+  virtual int32_t current_trx_id() const { return 0; }
+
+  /**
+   * @brief 保证之后分配的事务号都比 trx_id 大
+   */
+  virtual void advance_trx_id(int32_t /*trx_id*/) {}
+
 public:
   static TrxKit *create(const char *name);
   static RC init_global(const char *name);
@@ -150,11 +222,72 @@ public:
   virtual RC update_record(Table *table, Record &record, const Value &value, const std::string &field) = 0; // 没有实现mvcc_trx中的具体细节，只实现没有事务的版本
   virtual RC visit_record(Table *table, Record &record, bool readonly) = 0;
 
+  /**
+   * @brief 等待要修改的记录上的行锁
+   * @details visit_record 返回 LOCKED_NEED_WAIT 时，调用者先释放记录所在页面的锁再调用这个接口，
+   * 拿到行锁以后重新读取记录并调用 visit_record。持有页面的锁等待，会让持有行锁的事务在提交时拿不到页面的锁
+   */
+  virtual RC lock_record(Table * /*table*/, const RID & /*rid*/) { return RC::SUCCESS; }
+
+  /**
+   * @brief 修改索引中 update_record 推迟的索引项
+   * @details update_record 时调用者持有记录所在页面的锁，索引要在数据页面之前加锁，这时不能修改索引。
+   * 调用者释放页面的锁以后(比如语句结束时)调用这个接口
+   */
+  virtual RC apply_index_updates() { return RC::SUCCESS; }
+
   virtual RC start_if_need() = 0;
   virtual RC commit() = 0;
   virtual RC rollback() = 0;
 
+  /**
+   * @brief 串行恢复时按照日志顺序重做一条日志
+   */
   virtual RC redo(Db *db, const CLogRecord &log_record);
 
+  /**
+   * @brief 并行恢复时，由读取日志的线程按照日志顺序调用
+   * @details 只记录事务自身的状态，比如修改过哪些记录，不访问页面
+   */
+  virtual RC redo_analyze(Db *db, const CLogRecord &log_record);
+
+  /**
+   * @brief 并行恢复时，由重做线程调用，只修改 filter 接受的页面
+   * @details 数据日志只会分发给它修改的页面所在的分区。提交和回滚日志会分发给事务修改过的每个分区，
+   * 不同的线程可能同时处理同一个事务，所以这里不能修改事务自身的状态
+   */
+  virtual RC redo_partition(Db *db, const CLogRecord &log_record, const RedoPartitionFilter &filter);
+
   virtual int32_t id() const = 0;
+
+  /**
+   * @brief 设置提交时日志的持久化级别
+   * @details 会话每次使用事务前设置，DEFAULT 表示使用服务器的设置
+   */
+  void           set_durability(CLogDurability durability) { durability_ = durability; }
+  CLogDurability durability() const { return durability_; }
+
+  /**
+   * @brief 设置等待行锁的超时时间(毫秒)
+   * @details 会话每次使用事务前设置，小于0表示使用服务器的设置
+   */
+  void set_lock_wait_timeout_ms(int timeout_ms) { lock_wait_timeout_ms_ = timeout_ms; }
+  int  lock_wait_timeout_ms() const { return lock_wait_timeout_ms_; }
+
+  /**
+   * @brief 把下一个开始的事务设置为只读事务
+   * @details 只读事务不分配事务号，也不写日志，修改数据时返回 TRX_READ_ONLY。
+   * 只对还没有开始的事务生效，事务结束后恢复为读写事务
+   */
+  virtual RC set_read_only(bool read_only)
+  {
+    read_only_ = read_only;
+    return RC::SUCCESS;
+  }
+  bool read_only() const { return read_only_; }
+
+protected:
+  CLogDurability durability_ = CLogDurability::DEFAULT;
+  int            lock_wait_timeout_ms_ = -1;
+  bool           read_only_ = false;
 };
@@ -0,0 +1,250 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+#include "storage/trx/trx_registry.h"
+
+using namespace std;
+
+TrxRegistry::TrxRegistry(int capacity)
+{
+  capacity_ = 1;
+  while (capacity_ < capacity) {
+    capacity_ <<= 1;
+  }
+  mask_  = static_cast<uint32_t>(capacity_ - 1);
+  slots_.reset(new Slot[capacity_]);
+
+  for (atomic<int32_t> &pending : pending_) {
+    pending.store(0);
+  }
+}
+
+int32_t TrxRegistry::start(atomic<int32_t> &trx_id_counter, Trx *trx)
+{
+  // 先留下事务号的下界：之后分配的事务号一定不小于它
+  const size_t hint = hash<thread::id>()(this_thread::get_id());
+  atomic<int32_t> *pending = nullptr;
+  for (size_t i = hint; pending == nullptr; i++) {
+    atomic<int32_t> &slot = pending_[i % PENDING_SLOTS];
+    int32_t expected = 0;
+    if (slot.compare_exchange_strong(expected, trx_id_counter.load() + 1)) {
+      pending = &slot;
+    }
+  }
+
+  const int32_t trx_id = trx_id_counter.fetch_add(1) + 1;
+  add(trx_id, trx);
+  pending->store(0);
+  return trx_id;
+}
+
+bool TrxRegistry::add(int32_t trx_id, Trx *trx)
+{
+  if (trx_id <= 0) {
+    return false;
+  }
+
+  bool added = false;
+  const int home = home_of(trx_id);
+  for (int distance = 0; distance < capacity_ && !added; distance++) {
+    Slot &slot = slots_[(home + distance) & mask_];
+    int32_t slot_trx_id = slot.trx_id.load();
+    if (slot_trx_id != EMPTY && slot_trx_id != TOMBSTONE) {
+      continue;
+    }
+    if (!slot.trx_id.compare_exchange_strong(slot_trx_id, RESERVED)) {
+      continue;
+    }
+
+    // 先放大查找距离再填写事务号，查找时不会错过这个位置
+    int max_probe = max_probe_.load();
+    while (max_probe < distance && !max_probe_.compare_exchange_weak(max_probe, distance)) {
+    }
+
+    slot.trx.store(trx);
+    slot.trx_id.store(trx_id);
+    added = true;
+  }
+
+  if (!added) {
+    add_overflow(trx_id, trx);
+  }
+  size_.fetch_add(1);
+
+  // 重做时会登记日志中的事务，事务号可能比之前计算的结果小
+  int32_t oldest = oldest_.load();
+  while (trx_id < oldest && !oldest_.compare_exchange_weak(oldest, trx_id)) {
+  }
+  return true;
+}
+
+void TrxRegistry::add_overflow(int32_t trx_id, Trx *trx)
+{
+  lock_guard<mutex> guard(overflow_lock_);
+  overflow_[trx_id] = trx;
+  overflow_size_.fetch_add(1);
+}
+
+bool TrxRegistry::remove_overflow(int32_t trx_id, Trx *trx)
+{
+  if (overflow_size_.load() == 0) {
+    return false;
+  }
+
+  lock_guard<mutex> guard(overflow_lock_);
+  auto iter = overflow_.find(trx_id);
+  if (iter == overflow_.end() || iter->second != trx) {
+    return false;
+  }
+  overflow_.erase(iter);
+  overflow_size_.fetch_sub(1);
+  return true;
+}
+
+Trx *TrxRegistry::find_overflow(int32_t trx_id) const
+{
+  if (overflow_size_.load() == 0) {
+    return nullptr;
+  }
+
+  lock_guard<mutex> guard(overflow_lock_);
+  auto iter = overflow_.find(trx_id);
+  return iter == overflow_.end() ? nullptr : iter->second;
+}
+
+bool TrxRegistry::remove(int32_t trx_id, Trx *trx)
+{
+  if (trx_id <= 0) {
+    return false;
+  }
+
+  const int home      = home_of(trx_id);
+  const int max_probe = max_probe_.load();
+  for (int distance = 0; distance <= max_probe; distance++) {
+    Slot &slot = slots_[(home + distance) & mask_];
+    const int32_t slot_trx_id = slot.trx_id.load();
+    if (slot_trx_id == EMPTY) {
+      break;
+    }
+    if (slot_trx_id == trx_id && slot.trx.load() == trx) {
+      slot.trx.store(nullptr);
+      slot.trx_id.store(TOMBSTONE);
+      size_.fetch_sub(1);
+      return true;
+    }
+  }
+
+  if (remove_overflow(trx_id, trx)) {
+    size_.fetch_sub(1);
+    return true;
+  }
+  return false;
+}
+
+Trx *TrxRegistry::find(int32_t trx_id) const
+{
+  if (trx_id <= 0) {
+    return nullptr;
+  }
+
+  const int home      = home_of(trx_id);
+  const int max_probe = max_probe_.load();
+  for (int distance = 0; distance <= max_probe; distance++) {
+    const Slot &slot = slots_[(home + distance) & mask_];
+    const int32_t slot_trx_id = slot.trx_id.load();
+    if (slot_trx_id == EMPTY) {
+      break;
+    }
+    if (slot_trx_id == trx_id) {
+      Trx *trx = slot.trx.load();
+      if (trx != nullptr) {
+        return trx;
+      }
+    }
+  }
+  return find_overflow(trx_id);
+}
+
+void TrxRegistry::all(vector<Trx *> &trxes) const
+{
+  trxes.clear();
+  for (int i = 0; i < capacity_; i++) {
+    const Slot &slot = slots_[i];
+    if (slot.trx_id.load() > 0) {
+      Trx *trx = slot.trx.load();
+      if (trx != nullptr) {
+        trxes.push_back(trx);
+      }
+    }
+  }
+
+  if (overflow_size_.load() > 0) {
+    lock_guard<mutex> guard(overflow_lock_);
+    for (const auto &[trx_id, trx] : overflow_) {
+      trxes.push_back(trx);
+    }
+  }
+}
+
+int32_t TrxRegistry::pending_limit(int32_t max_trx_id) const
+{
+  // 正在登记的事务还不在表中，不能越过它们
+  int32_t limit = max_trx_id;
+  for (const atomic<int32_t> &pending : pending_) {
+    const int32_t floor = pending.load();
+    if (floor > 0 && floor - 1 < limit) {
+      limit = floor - 1;
+    }
+  }
+  return limit;
+}
+
+int32_t TrxRegistry::snapshot(int32_t max_trx_id, vector<int32_t> &trx_ids) const
+{
+  const int32_t limit = pending_limit(max_trx_id);
+
+  trx_ids.clear();
+  for (int i = 0; i < capacity_; i++) {
+    const int32_t trx_id = slots_[i].trx_id.load();
+    if (trx_id > 0 && trx_id <= limit) {
+      trx_ids.push_back(trx_id);
+    }
+  }
+
+  if (overflow_size_.load() > 0) {
+    lock_guard<mutex> guard(overflow_lock_);
+    for (const auto &[trx_id, trx] : overflow_) {
+      if (trx_id <= limit) {
+        trx_ids.push_back(trx_id);
+      }
+    }
+  }
+  sort(trx_ids.begin(), trx_ids.end());
+  return limit;
+}
+
+int32_t TrxRegistry::oldest(int32_t max_trx_id)
+{
+  const int32_t limit = pending_limit(max_trx_id);
+
+  int32_t oldest = oldest_.load();
+  while (oldest <= limit && find(oldest) == nullptr) {
+    oldest++;
+  }
+
+  int32_t current = oldest_.load();
+  while (current < oldest && !oldest_.compare_exchange_weak(current, oldest)) {
+  }
+  return oldest;
+}
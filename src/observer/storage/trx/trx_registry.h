@@ -0,0 +1,130 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class Trx;
+
+/**
+ * @brief 活跃事务表
+ * @ingroup Transaction
+ * @details 按照事务号登记正在运行的事务，注册、删除和查找都不需要加锁。
+ * 使用开放定址的哈希表，事务号对容量取模作为起始位置，冲突时向后探查。事务号是递增的，
+ * 新的事务总是可以复用之前结束的事务留下的位置，探查的距离通常很短。
+ * 删除时只把位置标记为删除(TOMBSTONE)，不会打断其它事务的探查路径。
+ * 表满时登记到一个加锁的溢出表中，只有溢出表不为空时，查找和删除才需要加锁。
+ *
+ * 最老的活跃事务号从上次的结果开始向后检查，已经结束的事务号只检查一次。分配事务号和登记不是原子的，
+ * 所以事务在分配事务号之前，先在一个很小的数组(PENDING_SLOTS)中留下事务号的下界，登记完成后清除，
+ * 计算最老的活跃事务号时不会越过这些正在登记的事务。
+ */
+class TrxRegistry
+{
+public:
+  static constexpr int DEFAULT_CAPACITY = 16 * 1024;
+
+  /**
+   * @param capacity 不加锁登记的事务个数，会向上取整为2的幂。超过以后登记到溢出表中
+   */
+  explicit TrxRegistry(int capacity = DEFAULT_CAPACITY);
+  ~TrxRegistry() = default;
+
+  /**
+   * @brief 分配一个新的事务号并登记
+   * @param trx_id_counter 当前已经分配的最大事务号
+   * @return 新的事务号
+   */
+  int32_t start(std::atomic<int32_t> &trx_id_counter, Trx *trx);
+
+  /**
+   * @brief 登记一个已经有事务号的事务，比如重做日志时创建的事务。事务号无效时返回false
+   */
+  bool add(int32_t trx_id, Trx *trx);
+
+  /**
+   * @brief 删除一个事务。只有事务号和事务对象都匹配时才会删除
+   */
+  bool remove(int32_t trx_id, Trx *trx);
+
+  Trx *find(int32_t trx_id) const;
+  void all(std::vector<Trx *> &trxes) const;
+
+  /**
+   * @brief 最老的活跃事务号
+   * @param max_trx_id 当前已经分配的最大事务号
+   * @return 没有活跃事务时返回 max_trx_id + 1
+   */
+  int32_t oldest(int32_t max_trx_id);
+
+  /**
+   * @brief 登记的事务号的快照，用来创建读视图
+   * @details 先读取当前已经分配的最大事务号，再调用这个函数。正在登记的事务可能已经分配了事务号但还不在表中，
+   * 返回的上界不会越过它们
+   * @param max_trx_id 当前已经分配的最大事务号
+   * @param trx_ids 返回不大于上界的所有登记的事务号，从小到大排列
+   * @return 上界。不大于它的事务号，没有在 trx_ids 中的都已经结束(或者从来没有登记)
+   */
+  int32_t snapshot(int32_t max_trx_id, std::vector<int32_t> &trx_ids) const;
+
+  int size() const { return size_.load(); }
+  int capacity() const { return capacity_; }
+
+  /**
+   * @brief 登记在溢出表中的事务个数
+   */
+  int overflow_size() const { return overflow_size_.load(); }
+
+private:
+  static constexpr int32_t EMPTY     = 0;   ///< 从来没有使用过
+  static constexpr int32_t TOMBSTONE = -1;  ///< 事务已经删除
+  static constexpr int32_t RESERVED  = -2;  ///< 正在登记，还没有填写事务号
+
+  static constexpr int PENDING_SLOTS = 64;
+
+  struct Slot
+  {
+    std::atomic<int32_t> trx_id{EMPTY};
+    std::atomic<Trx *>   trx{nullptr};
+  };
+
+  int home_of(int32_t trx_id) const { return static_cast<int>(static_cast<uint32_t>(trx_id) & mask_); }
+
+  /**
+   * @brief 不越过正在登记的事务的事务号上界
+   */
+  int32_t pending_limit(int32_t max_trx_id) const;
+
+  void add_overflow(int32_t trx_id, Trx *trx);
+  bool remove_overflow(int32_t trx_id, Trx *trx);
+  Trx *find_overflow(int32_t trx_id) const;
+
+private:
+  int                     capacity_ = 0;
+  uint32_t                mask_     = 0;
+  std::unique_ptr<Slot[]> slots_;
+
+  std::atomic<int>     max_probe_{0};  ///< 登记时最长的探查距离，查找不需要超过这个距离
+  std::atomic<int>     size_{0};
+  std::atomic<int32_t> oldest_{1};     ///< 最老的活跃事务号的下界
+
+  /// 正在分配事务号的事务留下的事务号下界，0表示空闲
+  std::atomic<int32_t> pending_[PENDING_SLOTS];
+
+  mutable std::mutex                 overflow_lock_;
+  std::unordered_map<int32_t, Trx *> overflow_;           ///< 哈希表满时登记的事务
+  std::atomic<int>                   overflow_size_{0};   ///< 为0时不需要检查溢出表
+};
@@ -0,0 +1,122 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/trx/version_store.h"
+
+using namespace std;
+
+void VersionStore::add(int32_t table_id, const RID &rid, int32_t trx_id, const char *data, int len)
+{
+  Key key{table_id, rid.page_num, rid.slot_num};
+  Shard &shard = shard_of(key);
+  lock_guard<mutex> guard(shard.lock);
+  shard.chains[key].push_back(Version{-trx_id, string(data, len)});
+  version_count_.fetch_add(1);
+}
+
+void VersionStore::commit(int32_t table_id, const RID &rid, int32_t trx_id, int32_t commit_xid)
+{
+  Key key{table_id, rid.page_num, rid.slot_num};
+  Shard &shard = shard_of(key);
+  lock_guard<mutex> guard(shard.lock);
+  auto iter = shard.chains.find(key);
+  if (iter == shard.chains.end()) {
+    return;
+  }
+
+  // 提交号是延迟写入的，这之前其它事务可能已经修改了这条记录，当前事务的版本不一定在版本链的最后
+  for (Version &version : iter->second) {
+    if (version.end_xid == -trx_id) {
+      version.end_xid = commit_xid;
+    }
+  }
+}
+
+void VersionStore::rollback(int32_t table_id, const RID &rid, int32_t trx_id)
+{
+  Key key{table_id, rid.page_num, rid.slot_num};
+  Shard &shard = shard_of(key);
+  lock_guard<mutex> guard(shard.lock);
+  auto iter = shard.chains.find(key);
+  if (iter == shard.chains.end()) {
+    return;
+  }
+
+  vector<Version> &chain = iter->second;
+  while (!chain.empty() && chain.back().end_xid == -trx_id) {
+    chain.pop_back();
+    version_count_.fetch_sub(1);
+  }
+  if (chain.empty()) {
+    shard.chains.erase(iter);
+  }
+}
+
+bool VersionStore::find(int32_t table_id, const RID &rid, const function<bool(const char *)> &visible,
+                        string &data) const
+{
+  Key key{table_id, rid.page_num, rid.slot_num};
+  const Shard &shard = shard_of(key);
+  lock_guard<mutex> guard(shard.lock);
+  auto iter = shard.chains.find(key);
+  if (iter == shard.chains.end()) {
+    return false;
+  }
+
+  const vector<Version> &chain = iter->second;
+  for (auto version = chain.rbegin(); version != chain.rend(); ++version) {
+    if (visible(version->data.data())) {
+      data = version->data;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool VersionStore::exists(int32_t table_id, const RID &rid) const
+{
+  Key key{table_id, rid.page_num, rid.slot_num};
+  const Shard &shard = shard_of(key);
+  lock_guard<mutex> guard(shard.lock);
+  return shard.chains.find(key) != shard.chains.end();
+}
+
+int VersionStore::trim(vector<Version> &chain, int32_t horizon)
+{
+  // 被替代的版本只有看不到替代它的提交的事务才会访问。找到最新的一个可以清理的版本，
+  // 比它更旧的版本被更早的事务替代，也都可以清理
+  for (int i = static_cast<int>(chain.size()) - 1; i >= 0; i--) {
+    const int32_t end_xid = chain[i].end_xid;
+    if (end_xid > 0 && end_xid < horizon) {
+      chain.erase(chain.begin(), chain.begin() + i + 1);
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+int64_t VersionStore::purge(int32_t horizon)
+{
+  int64_t purged = 0;
+  for (Shard &shard : shards_) {
+    lock_guard<mutex> guard(shard.lock);
+    for (auto iter = shard.chains.begin(); iter != shard.chains.end();) {
+      purged += trim(iter->second, horizon);
+      if (iter->second.empty()) {
+        iter = shard.chains.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+
+  version_count_.fetch_sub(purged);
+  return purged;
+}
@@ -0,0 +1,128 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "storage/record/record.h"
+
+/**
+ * @brief 记录的历史版本
+ * @ingroup Transaction
+ * @details 记录原地修改时，修改前的完整数据作为一个历史版本保存在这里，同一条记录的历史版本按照修改的顺序
+ * 组成一个版本链。读取的事务看不到页面上最新的版本时，沿着版本链从新到旧找到第一个自己可以看到的版本。
+ * 历史版本只服务于正在运行的事务，重启以后不再需要，所以只保存在内存中。回滚使用的是事务自己保存的修改前的
+ * 数据和日志，与这里无关。
+ * 版本被提交的修改替代以后，所有活跃事务都能看到替代它的版本时，就可以清理掉(purge)。
+ */
+class VersionStore
+{
+public:
+  VersionStore() = default;
+  ~VersionStore() = default;
+
+  /**
+   * @brief 记录被事务 trx_id 修改之前，保存修改前的数据
+   */
+  void add(int32_t table_id, const RID &rid, int32_t trx_id, const char *data, int len);
+
+  /**
+   * @brief 事务提交，把这个事务产生的历史版本标记为被 commit_xid 替代
+   */
+  void commit(int32_t table_id, const RID &rid, int32_t trx_id, int32_t commit_xid);
+
+  /**
+   * @brief 事务回滚，删除这个事务产生的历史版本
+   */
+  void rollback(int32_t table_id, const RID &rid, int32_t trx_id);
+
+  /**
+   * @brief 从新到旧查找第一个 visible 返回true的历史版本
+   * @param data 找到时返回这个版本的数据
+   * @return 没有历史版本或者没有满足条件的版本时返回false
+   */
+  bool find(int32_t table_id, const RID &rid, const std::function<bool(const char *)> &visible,
+            std::string &data) const;
+
+  /**
+   * @brief 这条记录是否有历史版本
+   */
+  bool exists(int32_t table_id, const RID &rid) const;
+
+  /**
+   * @brief 清理不再需要的历史版本
+   * @param horizon 所有读视图都能看到提交号小于它的提交，被这些提交替代的版本任何事务都不会再访问
+   * @return 清理掉的版本个数
+   */
+  int64_t purge(int32_t horizon);
+
+  int64_t version_count() const { return version_count_.load(); }
+
+private:
+  struct Version
+  {
+    int32_t     end_xid;  ///< 替代这个版本的事务。提交前是负的事务号，提交后是提交的事务号
+    std::string data;     ///< 修改前完整的记录数据
+  };
+
+  struct Key
+  {
+    int32_t table_id;
+    PageNum page_num;
+    SlotNum slot_num;
+
+    bool operator==(const Key &other) const
+    {
+      return table_id == other.table_id && page_num == other.page_num && slot_num == other.slot_num;
+    }
+  };
+
+  struct KeyHasher
+  {
+    size_t operator()(const Key &key) const
+    {
+      return std::hash<int64_t>()((static_cast<int64_t>(key.table_id) << 48) ^
+                                  (static_cast<int64_t>(key.page_num) << 16) ^ key.slot_num);
+    }
+  };
+
+  /// 每条记录的版本链，新的版本在后面
+  using Chains = std::unordered_map<Key, std::vector<Version>, KeyHasher>;
+
+  /**
+   * @brief 按照记录分成多个分片，每个分片一把锁
+   */
+  struct Shard
+  {
+    mutable std::mutex lock;
+    Chains             chains;
+  };
+
+  static constexpr int SHARD_NUM = 64;
+
+  Shard &shard_of(const Key &key) { return shards_[KeyHasher()(key) % SHARD_NUM]; }
+  const Shard &shard_of(const Key &key) const { return shards_[KeyHasher()(key) % SHARD_NUM]; }
+
+  /**
+   * @brief 删除版本链中不再需要的旧版本
+   */
+  int trim(std::vector<Version> &chain, int32_t horizon);
+
+private:
+  Shard                shards_[SHARD_NUM];
+  std::atomic<int64_t> version_count_{0};
+};
@@ -13,48 +13,195 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include <inttypes.h>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <vector>
 
 #include "storage/clog/clog.h"
 
 using namespace std;
 
-void dump(const char *filename)
+/**
+ * @brief 打开日志目录，按顺序访问每一条日志
+ * @details 日志结束后打印错误或者日志尾部不完整的信息
+ */
+void visit(const char *path, bool print_checkpoint, function<void(CLogFile &, const CLogRecord &)> visitor)
 {
+  // 日志段的大小记录在检查点文件中
+  CLogCheckpoint checkpoint;
+  bool found = false;
+  RC rc = checkpoint.load(path, found);
+  if (OB_FAIL(rc)) {
+    printf("failed to load checkpoint file in '%s'. rc=%s\n", path, strrc(rc));
+    return;
+  }
+  if (found && print_checkpoint) {
+    printf("checkpoint: redo_lsn:%" PRId64 ", checkpoint_lsn:%" PRId64 ", segment_size:%" PRId64 "\n",
+           checkpoint.redo_lsn, checkpoint.checkpoint_lsn, checkpoint.segment_size);
+  }
+
   CLogFile file;
-  RC rc = file.init(filename);
+  rc = file.init(path, found ? checkpoint.segment_size : CLogFile::DEFAULT_SEGMENT_SIZE);
   if (OB_FAIL(rc)) {
-    printf("failed to open file: '%s'. syserr=%s, rc=%s\n", filename, strerror(errno), strrc(rc));
+    printf("failed to open clog files: '%s'. syserr=%s, rc=%s\n", path, strerror(errno), strrc(rc));
     return;
   }
 
   CLogRecordIterator iterator;
-  rc = iterator.init(file);
+  rc = iterator.init(file, file.begin_lsn());
   if (OB_FAIL(rc)) {
     printf("failed to init iterator. rc=%s\n", strrc(rc));
     return;
   }
-  
-  int64_t offset = 0;
-  int index = 0;
-  for (index++, rc = iterator.next(); OB_SUCC(rc) && iterator.valid(); rc = iterator.next(), ++index) {
-    const CLogRecord &log_record = iterator.log_record();
-    
-    printf("index:%d, file_offset:%" PRId64 ", %s\n", index, offset, log_record.to_string().c_str());
-    (void)file.offset(offset);
+
+  for (rc = iterator.next(); OB_SUCC(rc) && iterator.valid(); rc = iterator.next()) {
+    visitor(file, iterator.log_record());
   }
 
   if (rc != RC::RECORD_EOF) {
     printf("something error. error=%s\n", strrc(rc));
+  } else if (file.torn()) {
+    printf("found a torn block at the end of log. end lsn:%" PRId64 "\n", iterator.next_lsn());
+  }
+}
+
+void dump(const char *path)
+{
+  // 日志记录所在的日志段和日志块
+  int index = 0;
+  visit(path, true /*print_checkpoint*/, [&index](CLogFile &file, const CLogRecord &log_record) {
+    const LSN lsn = log_record.header().lsn_;
+    printf("index:%d, segment:%" PRId64 ", block:%" PRId64 ", %s\n", ++index, lsn / file.segment_data_size(),
+           lsn % file.segment_data_size() / CLogFile::BLOCK_DATA_SIZE, log_record.to_string().c_str());
+  });
+}
+
+/**
+ * @brief 日志量的统计：条数和字节数(日志头加数据)
+ */
+struct LogVolume
+{
+  int64_t count = 0;
+  int64_t bytes = 0;
+
+  void add(int64_t size)
+  {
+    count++;
+    bytes += size;
+  }
+};
+
+void print_volume_header(const char *name)
+{
+  printf("  %-16s %12s %14s %10s %8s\n", name, "records", "bytes", "avg", "percent");
+}
+
+void print_volume(const string &name, const LogVolume &volume, int64_t total_bytes)
+{
+  printf("  %-16s %12" PRId64 " %14" PRId64 " %10.1f %7.2f%%\n", name.c_str(), volume.count, volume.bytes,
+         volume.count > 0 ? static_cast<double>(volume.bytes) / volume.count : 0.0,
+         total_bytes > 0 ? 100.0 * volume.bytes / total_bytes : 0.0);
+}
+
+/**
+ * @brief 统计日志的组成：各种类型的日志、每个事务、每张表的日志量
+ */
+void summary(const char *path)
+{
+  const int TOP_TRX_NUM = 10;
+
+  LogVolume                          total;
+  map<string, LogVolume>             type_volumes;
+  map<int32_t, LogVolume>            table_volumes;
+  unordered_map<int32_t, LogVolume>  active_trxes;
+  vector<pair<int32_t, LogVolume>>   finished_trxes;
+
+  visit(path, true /*print_checkpoint*/, [&](CLogFile &, const CLogRecord &log_record) {
+    const CLogRecordHeader &header = log_record.header();
+    const int64_t size = static_cast<int64_t>(sizeof(header)) + header.logrec_len_;
+    const CLogType type = log_record.log_type();
+
+    total.add(size);
+    type_volumes[clog_type_name(type)].add(size);
+
+    switch (type) {
+      case CLogType::INSERT:
+      case CLogType::DELETE:
+      case CLogType::UPDATE: {
+        table_volumes[log_record.data_record().table_id_].add(size);
+      } break;
+      default: break;
+    }
+
+    active_trxes[header.trx_id_].add(size);
+    if (type == CLogType::MTR_COMMIT || type == CLogType::MTR_ROLLBACK) {
+      auto iter = active_trxes.find(header.trx_id_);
+      finished_trxes.emplace_back(iter->first, iter->second);
+      active_trxes.erase(iter);
+    }
+  });
+
+  printf("total: records:%" PRId64 ", bytes:%" PRId64 "\n", total.count, total.bytes);
+
+  printf("\nby type:\n");
+  print_volume_header("type");
+  for (const auto &[name, volume] : type_volumes) {
+    print_volume(name, volume, total.bytes);
+  }
+
+  printf("\nby table:\n");
+  print_volume_header("table_id");
+  for (const auto &[table_id, volume] : table_volumes) {
+    print_volume(to_string(table_id), volume, total.bytes);
+  }
+
+  printf("\ntransactions: finished:%d, unfinished:%d\n",
+         static_cast<int>(finished_trxes.size()), static_cast<int>(active_trxes.size()));
+  if (finished_trxes.empty()) {
+    return;
+  }
+
+  vector<int64_t> trx_bytes;
+  vector<int64_t> trx_records;
+  for (const auto &[trx_id, volume] : finished_trxes) {
+    trx_bytes.push_back(volume.bytes);
+    trx_records.push_back(volume.count);
+  }
+  sort(trx_bytes.begin(), trx_bytes.end());
+  sort(trx_records.begin(), trx_records.end());
+
+  auto percentile = [](const vector<int64_t> &values, int p) { return values[values.size() * p / 100]; };
+  printf("  %-8s %10s %10s %10s %10s\n", "", "min", "p50", "p99", "max");
+  printf("  %-8s %10" PRId64 " %10" PRId64 " %10" PRId64 " %10" PRId64 "\n", "records", trx_records.front(),
+         percentile(trx_records, 50), percentile(trx_records, 99), trx_records.back());
+  printf("  %-8s %10" PRId64 " %10" PRId64 " %10" PRId64 " %10" PRId64 "\n", "bytes", trx_bytes.front(),
+         percentile(trx_bytes, 50), percentile(trx_bytes, 99), trx_bytes.back());
+
+  const int top_num = min(TOP_TRX_NUM, static_cast<int>(finished_trxes.size()));
+  partial_sort(finished_trxes.begin(), finished_trxes.begin() + top_num, finished_trxes.end(),
+               [](const auto &left, const auto &right) { return left.second.bytes > right.second.bytes; });
+  printf("\nlargest transactions:\n");
+  print_volume_header("trx_id");
+  for (int i = 0; i < top_num; i++) {
+    print_volume(to_string(finished_trxes[i].first), finished_trxes[i].second, total.bytes);
   }
 }
 
 int main(int argc, char *argv[])
 {
   if (argc < 2) {
-    printf("please give me a clog file name\n");
+    printf("usage: %s clog_dir [--summary]\n", argv[0]);
+    printf("  --summary  print log volume by record type, table and transaction instead of every record\n");
     return 1;
   }
 
-  dump(argv[1]);
+  if (argc >= 3 && 0 == strcmp(argv[2], "--summary")) {
+    summary(argv[1]);
+  } else {
+    dump(argv[1]);
+  }
   return 0;
 }
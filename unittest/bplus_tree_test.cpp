@@ -12,12 +12,19 @@ See the Mulan PSL v2 for more details. */
 // Created by longda on 2022
 //
 
+#include <algorithm>
+#include <limits>
 #include <list>
 #include <iostream>
+#include <vector>
+#include <string>
 
 #include "storage/index/bplus_tree.h"
+#include "storage/index/bplus_tree_key_search.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "common/log/log.h"
+#include "common/lang/comparator.h"
+#include "common/lang/lower_bound.h"
 #include "sql/parser/parse_defs.h"
 #include "gtest/gtest.h"
 
@@ -412,9 +419,10 @@ TEST(test_bplus_tree, test_internal_index_node_handle)
 
   ASSERT_EQ(5, internal_node.size());
 
+  char key_buf[4 + sizeof(RID)];
   for (int i = 1; i < 5; i++) {
     key = i * 2 + 1;
-    int real_key = *(int*)internal_node.key_at(i);
+    int real_key = *(const int *)internal_node.key_at(i, key_buf);
     ASSERT_EQ(key, real_key);
   }
 
@@ -465,6 +473,135 @@ TEST(test_bplus_tree, test_internal_index_node_handle)
   }
 }
 
+TEST(test_bplus_tree, test_prefix_compressed_key_at)
+{
+  const int attr_length = 16;
+  IndexFileHeader index_file_header;
+  index_file_header.root_page = BP_INVALID_PAGE_NUM;
+  index_file_header.internal_max_size = 5;
+  index_file_header.leaf_max_size = 5;
+  index_file_header.attr_length = attr_length;
+  index_file_header.key_length = attr_length + sizeof(RID);
+  index_file_header.attr_type = CHARS;
+  index_file_header.prefix_compression = 1;
+
+  Frame frame;
+
+  KeyComparator key_comparator;
+  key_comparator.init(CHARS, attr_length);
+
+  auto make_key = [](const char *attr, int slot_num, char *key) {
+    memset(key, 0, attr_length + sizeof(RID));
+    strncpy(key, attr, attr_length);
+    RID rid(1, slot_num);
+    memcpy(key + attr_length, &rid, sizeof(RID));
+  };
+
+  char low_fence[attr_length + sizeof(RID)];
+  char high_fence[attr_length + sizeof(RID)];
+  make_key("user/000", 0, low_fence);
+  make_key("user/999", 0, high_fence);
+
+  LeafIndexNodeHandler leaf_node(index_file_header, &frame);
+  leaf_node.init_empty();
+  leaf_node.set_fences(low_fence, high_fence);
+  ASSERT_EQ(5, leaf_node.prefix_length());
+
+  char key[attr_length + sizeof(RID)];
+  RID  value(1, 0);
+  make_key("user/001", 1, key);
+  leaf_node.insert(0, key, (const char *)&value);
+  make_key("user/002", 2, key);
+  leaf_node.insert(1, key, (const char *)&value);
+
+  // 两次调用使用各自的内存，第二次不会覆盖第一次的结果
+  char buf0[attr_length + sizeof(RID)];
+  char buf1[attr_length + sizeof(RID)];
+  const char *key0 = leaf_node.key_at(0, buf0);
+  const char *key1 = leaf_node.key_at(1, buf1);
+  ASSERT_STREQ("user/001", key0);
+  ASSERT_STREQ("user/002", key1);
+  ASSERT_LT(key_comparator(key0, key1), 0);
+}
+
+template <typename T>
+void check_fast_key_search(AttrType attr_type)
+{
+  // 每个属性值重复3次，使用RID区分，与叶子节点的布局相同：属性值 + RID(键值的一部分) + RID(value)
+  const int attr_length = sizeof(T);
+  const int key_size = attr_length + sizeof(RID);
+  const int item_size = key_size + sizeof(RID);
+  const int max_num = 300;
+
+  KeyComparator key_comparator;
+  key_comparator.init(attr_type, attr_length);
+
+  std::vector<char> items(item_size * max_num);
+  for (int i = 0; i < max_num; i++) {
+    T attr = static_cast<T>((i / 3) * 2);
+    RID item_rid{i % 3, i % 3};
+    memcpy(items.data() + i * item_size, &attr, attr_length);
+    memcpy(items.data() + i * item_size + attr_length, &item_rid, sizeof(item_rid));
+  }
+
+  char key[sizeof(T) + sizeof(RID)];
+  for (int num : {0, 1, 3, 7, 16, 17, 33, 100, max_num}) {
+    for (int value = -2; value <= (max_num / 3) * 2 + 2; value++) {
+      for (int slot = -1; slot <= 3; slot++) {
+        T attr = static_cast<T>(value);
+        RID key_rid{slot, slot};
+        memcpy(key, &attr, attr_length);
+        memcpy(key + attr_length, &key_rid, sizeof(key_rid));
+
+        common::BinaryIterator<char> iter_begin(item_size, items.data());
+        common::BinaryIterator<char> iter_end(item_size, items.data() + num * item_size);
+        bool expect_found = false;
+        int expect = common::lower_bound(iter_begin, iter_end, key, key_comparator, &expect_found) - iter_begin;
+
+        bool found = false;
+        int index = fast_key_lower_bound(attr_type, items.data(), item_size, num, key, &found);
+        ASSERT_EQ(expect, index) << "num=" << num << ", value=" << value << ", slot=" << slot;
+        ASSERT_EQ(expect_found, found) << "num=" << num << ", value=" << value << ", slot=" << slot;
+      }
+    }
+  }
+}
+
+TEST(test_bplus_tree, test_fast_key_search)
+{
+  LOG_INFO("fast key search isa: %s", fast_key_search_isa());
+  ASSERT_TRUE(fast_key_search_supported(INTS, 4));
+  ASSERT_TRUE(fast_key_search_supported(FLOATS, 4));
+  ASSERT_FALSE(fast_key_search_supported(CHARS, 4));
+
+  check_fast_key_search<int>(INTS);
+  check_fast_key_search<float>(FLOATS);
+
+  // 相差超过 INT_MAX 的键值也要有正确的顺序
+  const int extremes[] = {std::numeric_limits<int>::min(), -1, 0, 1, std::numeric_limits<int>::max()};
+  const int item_size = sizeof(int) + sizeof(RID) + sizeof(RID);
+  const int num = sizeof(extremes) / sizeof(extremes[0]);
+  std::vector<char> items(item_size * num);
+  for (int i = 0; i < num; i++) {
+    RID item_rid{1, 1};
+    memcpy(items.data() + i * item_size, &extremes[i], sizeof(int));
+    memcpy(items.data() + i * item_size + sizeof(int), &item_rid, sizeof(item_rid));
+  }
+  for (int i = 0; i < num; i++) {
+    char key[sizeof(int) + sizeof(RID)];
+    RID key_rid{1, 1};
+    memcpy(key, &extremes[i], sizeof(int));
+    memcpy(key + sizeof(int), &key_rid, sizeof(key_rid));
+    bool found = false;
+    ASSERT_EQ(i, fast_key_lower_bound(INTS, items.data(), item_size, num, key, &found));
+    ASSERT_TRUE(found);
+  }
+  int min_value = std::numeric_limits<int>::min();
+  int max_value = std::numeric_limits<int>::max();
+  ASSERT_LT(common::compare_int(&min_value, &max_value), 0);
+  ASSERT_GT(common::compare_int(&max_value, &min_value), 0);
+}
+
 TEST(test_bplus_tree, test_chars)
 {
   LoggerFactory::init_default("test_chars.log");
@@ -508,6 +645,92 @@ TEST(test_bplus_tree, test_chars)
   ASSERT_EQ(2, count);
 }
 
+TEST(test_bplus_tree, test_chars_prefix_compression)
+{
+  LoggerFactory::init_default("test_chars_prefix_compression.log");
+
+  const char *index_name = "chars_prefix.btree";
+  ::remove(index_name);
+  handler = new BplusTreeHandler();
+  const int attr_length = 32;
+  ASSERT_EQ(RC::SUCCESS, handler->create(index_name, CHARS, attr_length, false, 6, 6, true));
+
+  // 大量键值有很长的公共前缀，每个属性值重复两次，只能通过RID区分
+  const int key_num = 1500;
+  auto make_attr = [](int i, char *attr) {
+    memset(attr, 0, attr_length);
+    snprintf(attr, attr_length, "user/%03d/%05d", (i / 2) % 7, i / 2);
+  };
+
+  std::vector<int> order(key_num);
+  for (int i = 0; i < key_num; i++) {
+    order[i] = (i * 733) % key_num;
+  }
+
+  char attr[attr_length];
+  RID  rid;
+  for (int i = 0; i < key_num; i++) {
+    make_attr(order[i], attr);
+    rid.page_num = 1;
+    rid.slot_num = order[i];
+    ASSERT_EQ(RC::SUCCESS, handler->insert_entry(attr, &rid));
+    if (i % 100 == 0) {
+      ASSERT_EQ(true, handler->validate_tree());
+    }
+  }
+  ASSERT_EQ(true, handler->validate_tree());
+
+  for (int i = 0; i < key_num; i++) {
+    make_attr(i, attr);
+    std::list<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, handler->get_entry(attr, strlen(attr), rids));
+    ASSERT_EQ(2, static_cast<int>(rids.size()));
+  }
+
+  BplusTreeScanner scanner(*handler);
+  const char *left_key = "user/003/";
+  const char *right_key = "user/004/";
+  ASSERT_EQ(RC::SUCCESS, scanner.open(left_key, strlen(left_key), true, right_key, strlen(right_key), false));
+  int count = 0;
+  while (RC::SUCCESS == scanner.next_entry(rid)) {
+    count++;
+  }
+  scanner.close();
+  int expect_count = 0;
+  for (int i = 0; i < key_num; i++) {
+    expect_count += ((i / 2) % 7 == 3) ? 1 : 0;
+  }
+  ASSERT_EQ(expect_count, count);
+
+  for (int i = 0; i < key_num; i++) {
+    if (order[i] % 3 == 0) {
+      continue;
+    }
+    make_attr(order[i], attr);
+    rid.page_num = 1;
+    rid.slot_num = order[i];
+    ASSERT_EQ(RC::SUCCESS, handler->delete_entry(attr, &rid));
+    if (i % 100 == 0) {
+      ASSERT_EQ(true, handler->validate_tree());
+    }
+  }
+  ASSERT_EQ(true, handler->validate_tree());
+
+  for (int i = 0; i < key_num; i++) {
+    make_attr(i, attr);
+    rid.page_num = 1;
+    rid.slot_num = i;
+    std::list<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, handler->get_entry(attr, strlen(attr), rids));
+    const bool exists = std::find(rids.begin(), rids.end(), rid) != rids.end();
+    ASSERT_EQ(i % 3 == 0, exists);
+  }
+
+  handler->close();
+  delete handler;
+  handler = nullptr;
+}
+
 TEST(test_bplus_tree, test_scanner)
 {
   LoggerFactory::init_default("test.log");
@@ -718,6 +941,308 @@ TEST(test_bplus_tree, test_scanner)
   scanner.close();
 }
 
+TEST(test_bplus_tree, test_descending_scanner)
+{
+  LoggerFactory::init_default("test.log");
+
+  const char *index_name = "descending_scanner.btree";
+  ::remove(index_name);
+  BplusTreeHandler tree_handler;
+  ASSERT_EQ(RC::SUCCESS, tree_handler.create(index_name, INTS, sizeof(int), false, ORDER, ORDER));
+
+  // 插入[1 - 399]所有奇数，再删除一部分，让叶子节点分裂、合并
+  RID rid;
+  for (int i = 0; i < 200; i++) {
+    int key = i * 2 + 1;
+    rid.page_num = 0;
+    rid.slot_num = key;
+    ASSERT_EQ(RC::SUCCESS, tree_handler.insert_entry((const char *)&key, &rid));
+  }
+  for (int i = 0; i < 200; i += 3) {
+    int key = i * 2 + 1;
+    rid.page_num = 0;
+    rid.slot_num = key;
+    ASSERT_EQ(RC::SUCCESS, tree_handler.delete_entry((const char *)&key, &rid));
+  }
+  ASSERT_TRUE(tree_handler.validate_tree());
+
+  std::vector<int> forward_keys;
+  {
+    BplusTreeScanner scanner(tree_handler);
+    ASSERT_EQ(RC::SUCCESS, scanner.open(nullptr, 0, true, nullptr, 0, true));
+    while (scanner.next_entry(rid) == RC::SUCCESS) {
+      forward_keys.push_back(rid.slot_num);
+    }
+  }
+  ASSERT_EQ(133, (int)forward_keys.size());
+
+  std::vector<int> backward_keys;
+  {
+    BplusTreeScanner scanner(tree_handler);
+    ASSERT_EQ(RC::SUCCESS, scanner.open(nullptr, 0, true, nullptr, 0, true, true /*descending*/));
+    while (scanner.next_entry(rid) == RC::SUCCESS) {
+      backward_keys.push_back(rid.slot_num);
+    }
+  }
+  std::reverse(backward_keys.begin(), backward_keys.end());
+  ASSERT_EQ(forward_keys, backward_keys);
+
+  auto scan_desc = [&tree_handler](int begin, bool begin_inclusive, int end, bool end_inclusive, int limit) {
+    std::vector<int> keys;
+    BplusTreeScanner scanner(tree_handler);
+    RID rid;
+    EXPECT_EQ(RC::SUCCESS, scanner.open((const char *)&begin, 4, begin_inclusive, (const char *)&end, 4,
+                                        end_inclusive, true /*descending*/, limit));
+    while (scanner.next_entry(rid) == RC::SUCCESS) {
+      keys.push_back(rid.slot_num);
+    }
+    return keys;
+  };
+
+  // 1, 7, 103, 397 等被删除了
+  ASSERT_EQ(std::vector<int>({11, 9, 5, 3}), scan_desc(3, true, 11, true, -1));
+  ASSERT_EQ(std::vector<int>({9, 5}), scan_desc(3, false, 11, false, -1));
+  ASSERT_EQ(std::vector<int>({9, 5}), scan_desc(4, true, 10, true, -1));
+  ASSERT_EQ(std::vector<int>({399, 395, 393}), scan_desc(-100, true, 1000, true, 3));
+  ASSERT_EQ(std::vector<int>({3}), scan_desc(-100, true, 4, true, 10));
+  ASSERT_TRUE(scan_desc(1000, true, 2000, true, 10).empty());
+  ASSERT_TRUE(scan_desc(-100, true, 0, true, 10).empty());
+  ASSERT_TRUE(scan_desc(6, true, 8, true, 10).empty());
+
+  // 正序扫描也可以限制条数
+  {
+    BplusTreeScanner scanner(tree_handler);
+    int begin = 100;
+    ASSERT_EQ(RC::SUCCESS, scanner.open((const char *)&begin, 4, true, nullptr, 0, true, false, 2));
+    ASSERT_EQ(RC::SUCCESS, scanner.next_entry(rid));
+    ASSERT_EQ(101, rid.slot_num);
+    ASSERT_EQ(RC::SUCCESS, scanner.next_entry(rid));
+    ASSERT_EQ(105, rid.slot_num);
+    ASSERT_EQ(RC::RECORD_EOF, scanner.next_entry(rid));
+  }
+
+  tree_handler.close();
+}
+
+TEST(test_bplus_tree, test_multi_get)
+{
+  LoggerFactory::init_default("test.log");
+
+  const char *index_name = "multi_get.btree";
+  ::remove(index_name);
+  BplusTreeHandler tree_handler;
+  ASSERT_EQ(RC::SUCCESS, tree_handler.create(index_name, INTS, sizeof(int), false, ORDER, ORDER));
+
+  // 每个偶数插入5次，相同键值的数据会跨越多个叶子节点
+  const int dup_num = 5;
+  for (int i = 0; i < 100 * dup_num; i++) {
+    int key = (i % 100) * 2;
+    RID rid(i % 7 + 1, i);
+    ASSERT_EQ(RC::SUCCESS, tree_handler.insert_entry((const char *)&key, &rid));
+  }
+
+  std::vector<int> probes = {150, -1, 8, 9, 150, 198, 0, 400, 96, 97, 8};
+  std::vector<std::string> keys;
+  std::vector<RID> expected;
+  for (int probe : probes) {
+    keys.emplace_back((const char *)&probe, sizeof(probe));
+  }
+  for (int probe : {-1, 0, 8, 9, 96, 97, 150, 198, 400}) {
+    std::list<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, tree_handler.get_entry((const char *)&probe, sizeof(probe), rids));
+    expected.insert(expected.end(), rids.begin(), rids.end());
+  }
+  std::sort(expected.begin(), expected.end(), [](const RID &a, const RID &b) { return RID::compare(&a, &b) < 0; });
+  ASSERT_EQ(5 * dup_num, (int)expected.size());
+
+  std::vector<RID> rids;
+  ASSERT_EQ(RC::SUCCESS, tree_handler.multi_get_entry(keys, rids));
+  ASSERT_EQ(expected.size(), rids.size());
+  for (size_t i = 0; i < rids.size(); i++) {
+    ASSERT_EQ(0, RID::compare(&expected[i], &rids[i]));
+  }
+
+  // 按照页面排序
+  for (size_t i = 1; i < rids.size(); i++) {
+    ASSERT_LE(rids[i - 1].page_num, rids[i].page_num);
+  }
+
+  tree_handler.close();
+}
+
+TEST(test_bplus_tree, test_rescan)
+{
+  LoggerFactory::init_default("test.log");
+
+  const char *index_name = "rescan.btree";
+  ::remove(index_name);
+  BplusTreeHandler tree_handler;
+  ASSERT_EQ(RC::SUCCESS, tree_handler.create(index_name, INTS, sizeof(int), false, ORDER, ORDER));
+
+  // 每个偶数插入3次，相同键值的数据可能跨越叶子节点
+  for (int i = 0; i < 300; i++) {
+    int key = (i % 100) * 2;
+    RID rid(i % 7 + 1, i);
+    ASSERT_EQ(RC::SUCCESS, tree_handler.insert_entry((const char *)&key, &rid));
+  }
+
+  auto expected_rids = [&tree_handler](int key) {
+    std::list<RID> rids;
+    EXPECT_EQ(RC::SUCCESS, tree_handler.get_entry((const char *)&key, sizeof(key), rids));
+    std::vector<RID> result(rids.begin(), rids.end());
+    std::sort(result.begin(), result.end(), [](const RID &a, const RID &b) { return RID::compare(&a, &b) < 0; });
+    return result;
+  };
+  auto scan_rids = [](BplusTreeScanner &scanner) {
+    std::vector<RID> rids;
+    RID rid;
+    while (scanner.next_entry(rid) == RC::SUCCESS) {
+      rids.push_back(rid);
+    }
+    return rids;
+  };
+  auto same_rids = [](const std::vector<RID> &a, const std::vector<RID> &b) {
+    if (a.size() != b.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+      if (RID::compare(&a[i], &b[i]) != 0) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  BplusTreeScanner scanner(tree_handler);
+  int key = -1;
+  ASSERT_EQ(RC::SUCCESS, scanner.open((const char *)&key, sizeof(key), true, (const char *)&key, sizeof(key), true));
+  ASSERT_TRUE(scan_rids(scanner).empty());
+
+  // 按照从小到大的顺序查找，包括不存在的键和重复的键
+  for (key = 0; key <= 200; key++) {
+    ASSERT_EQ(RC::SUCCESS,
+        scanner.rescan((const char *)&key, sizeof(key), true, (const char *)&key, sizeof(key), true));
+    std::vector<RID> rids = scan_rids(scanner);
+    ASSERT_EQ(key % 2 == 0 && key < 200 ? 3 : 0, (int)rids.size()) << "key=" << key;
+    ASSERT_TRUE(same_rids(expected_rids(key), rids)) << "key=" << key;
+    ASSERT_TRUE(scan_rids(scanner).empty());
+  }
+  ASSERT_GT(scanner.leaf_reused_num(), 0);
+
+  // 乱序和范围查找
+  for (int probe : {150, 8, 9, 198, 0, 8}) {
+    ASSERT_EQ(RC::SUCCESS,
+        scanner.rescan((const char *)&probe, sizeof(probe), true, (const char *)&probe, sizeof(probe), true));
+    ASSERT_TRUE(same_rids(expected_rids(probe), scan_rids(scanner))) << "key=" << probe;
+  }
+  int begin = 10;
+  int end = 14;
+  ASSERT_EQ(RC::SUCCESS, scanner.rescan((const char *)&begin, sizeof(begin), false, (const char *)&end, sizeof(end), true));
+  ASSERT_EQ(6, (int)scan_rids(scanner).size());
+
+  // 非法的范围没有数据
+  ASSERT_EQ(RC::SUCCESS, scanner.rescan((const char *)&end, sizeof(end), true, (const char *)&begin, sizeof(begin), true));
+  ASSERT_TRUE(scan_rids(scanner).empty());
+
+  scanner.close();
+  tree_handler.close();
+}
+
+TEST(test_bplus_tree, test_suspend)
+{
+  LoggerFactory::init_default("test.log");
+
+  const char *index_name = "suspend.btree";
+  ::remove(index_name);
+  BplusTreeHandler tree_handler;
+  ASSERT_EQ(RC::SUCCESS, tree_handler.create(index_name, INTS, sizeof(int), false, ORDER, ORDER));
+
+  const int key_num = 300;
+  for (int key = 0; key < key_num; key++) {
+    RID rid(1, key);
+    ASSERT_EQ(RC::SUCCESS, tree_handler.insert_entry((const char *)&key, &rid));
+  }
+
+  // 每次返回数据以后都释放叶子节点的锁，其间删除一部分刚返回的数据，让叶子节点合并
+  auto scan = [&tree_handler](bool descending, int delete_step) {
+    std::vector<int> keys;
+    BplusTreeScanner scanner(tree_handler);
+    EXPECT_EQ(RC::SUCCESS, scanner.open(nullptr, 0, true, nullptr, 0, true, descending));
+    EXPECT_EQ(RC::SUCCESS, scanner.suspend());
+    RID rid;
+    while (scanner.next_entry(rid) == RC::SUCCESS) {
+      int key = rid.slot_num;
+      keys.push_back(key);
+      EXPECT_EQ(RC::SUCCESS, scanner.suspend());
+      if (key % delete_step == 0) {
+        EXPECT_EQ(RC::SUCCESS, tree_handler.delete_entry((const char *)&key, &rid));
+      }
+    }
+    EXPECT_EQ(RC::SUCCESS, scanner.suspend());
+    EXPECT_EQ(RC::RECORD_EOF, scanner.next_entry(rid));
+    return keys;
+  };
+
+  std::vector<int> expected;
+  for (int key = 0; key < key_num; key++) {
+    expected.push_back(key);
+  }
+  ASSERT_EQ(expected, scan(false /*descending*/, 2));
+  ASSERT_TRUE(tree_handler.validate_tree());
+
+  // 剩下所有的奇数
+  expected.clear();
+  for (int key = key_num - 1; key > 0; key -= 2) {
+    expected.push_back(key);
+  }
+  ASSERT_EQ(expected, scan(true /*descending*/, 3));
+  ASSERT_TRUE(tree_handler.validate_tree());
+
+  tree_handler.close();
+}
+
+TEST(test_bplus_tree, test_format_version)
+{
+  LoggerFactory::init_default("test.log");
+
+  const char *index_name = "format_version.btree";
+  ::remove(index_name);
+  BplusTreeHandler tree_handler;
+  ASSERT_EQ(RC::SUCCESS, tree_handler.create(index_name, INTS, sizeof(int), false, ORDER, ORDER));
+  for (int key = 0; key < 10; key++) {
+    RID rid(1, key);
+    ASSERT_EQ(RC::SUCCESS, tree_handler.insert_entry((const char *)&key, &rid));
+  }
+  ASSERT_EQ(RC::SUCCESS, tree_handler.sync());
+  tree_handler.close();
+
+  // 修改文件头中的版本号，模拟旧格式的索引文件
+  auto set_format_version = [index_name](int32_t format_version) {
+    BufferPoolManager &bpm = BufferPoolManager::instance();
+    DiskBufferPool *bp = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm.open_file(index_name, bp));
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->get_this_page(1, &frame));
+    IndexFileHeader *file_header = reinterpret_cast<IndexFileHeader *>(frame->data());
+    file_header->format_version = format_version;
+    frame->mark_dirty();
+    bp->unpin_page(frame);
+    ASSERT_EQ(RC::SUCCESS, bpm.close_file(index_name));
+  };
+  set_format_version(0);
+
+  BplusTreeHandler old_handler;
+  ASSERT_EQ(RC::FILE_VERSION_MISMATCH, old_handler.open(index_name));
+  // 打开失败时不能留下打开的文件，否则恢复版本号时无法再次打开
+  set_format_version(IndexFileHeader::FORMAT_VERSION);
+  ASSERT_EQ(RC::SUCCESS, old_handler.open(index_name));
+  std::list<RID> rids;
+  const int key = 5;
+  ASSERT_EQ(RC::SUCCESS, old_handler.get_entry((const char *)&key, sizeof(key), rids));
+  ASSERT_EQ(1, static_cast<int>(rids.size()));
+  old_handler.close();
+}
+
 TEST(test_bplus_tree, test_bplus_tree_insert)
 {
   LoggerFactory::init_default("test.log");
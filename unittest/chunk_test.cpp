@@ -0,0 +1,301 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/global_context.h"
+#include "common/log/log.h"
+#include "sql/expr/chunk.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/calc_physical_operator.h"
+#include "sql/operator/join_physical_operator.h"
+#include "sql/operator/predicate_physical_operator.h"
+#include "sql/operator/project_physical_operator.h"
+#include "sql/operator/table_scan_physical_operator.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/db/db.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace common;
+
+const char *chunk_db_path = "chunk_test_dir";
+const int   ROW_NUM       = 3000;  // 超过两个批次
+
+BufferPoolManager bpm;
+
+/**
+ * @brief 创建表 t(id int, name char(8), score float)，id 从0开始，score = id / 2
+ */
+void prepare_table(Db &db, const char *table_name)
+{
+  AttrInfoSqlNode attrs[3];
+  attrs[0].type   = INTS;
+  attrs[0].name   = "id";
+  attrs[0].length = sizeof(int);
+  attrs[1].type   = CHARS;
+  attrs[1].name   = "name";
+  attrs[1].length = 8;
+  attrs[2].type   = FLOATS;
+  attrs[2].name   = "score";
+  attrs[2].length = sizeof(float);
+  ASSERT_EQ(RC::SUCCESS, db.create_table(table_name, 3, attrs));
+
+  Table *table = db.find_table(table_name);
+  for (int i = 0; i < ROW_NUM; i++) {
+    Value values[3];
+    values[0].set_int(i);
+    values[1].set_string(("n" + to_string(i % 10)).c_str());
+    values[2].set_float(i / 2.0f);
+
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, table->make_record(3, values, record));
+    ASSERT_EQ(RC::SUCCESS, table->insert_record(record));
+  }
+}
+
+unique_ptr<Expression> field_expr(Table *table, const char *field_name)
+{
+  return make_unique<FieldExpr>(table, table->table_meta().field(field_name));
+}
+
+unique_ptr<Expression> compare_expr(CompOp comp, unique_ptr<Expression> left, Value value)
+{
+  return make_unique<ComparisonExpr>(comp, std::move(left), make_unique<ValueExpr>(value));
+}
+
+TEST(test_chunk, test_column)
+{
+  Column column(INTS, sizeof(int32_t), 4);
+  const int32_t values[] = {1, 2, 3};
+  for (const int32_t &value : values) {
+    column.append(reinterpret_cast<const char *>(&value));
+  }
+  ASSERT_EQ(3, column.count());
+
+  Value value;
+  column.get_value(2, value);
+  ASSERT_EQ(3, value.get_int());
+
+  // 常量列所有的行都是同一个值
+  Column constant;
+  constant.set_constant(Value(7));
+  constant.get_value(100, value);
+  ASSERT_EQ(7, value.get_int());
+
+  // 引用不复制数据
+  Column reference;
+  reference.reference(column);
+  ASSERT_EQ(column.data(), reference.data());
+
+  // 写入更长的字符串时加宽
+  Column chars(CHARS, 2, 4);
+  ASSERT_EQ(RC::SUCCESS, chars.set_value(0, Value("ab")));
+  ASSERT_EQ(RC::SUCCESS, chars.set_value(1, Value("abcdef")));
+  ASSERT_EQ(6, chars.attr_len());
+  chars.get_value(0, value);
+  ASSERT_EQ("ab", value.get_string());
+  chars.get_value(1, value);
+  ASSERT_EQ("abcdef", value.get_string());
+}
+
+TEST(test_chunk, test_filter)
+{
+  Chunk chunk;
+  chunk.add_column(make_unique<Column>(INTS, sizeof(int32_t), Chunk::MAX_ROWS), TupleCellSpec("t", "a"));
+  for (int32_t i = 0; i < 10; i++) {
+    chunk.column(0).append(reinterpret_cast<const char *>(&i));
+  }
+  chunk.set_rows(10);
+  ASSERT_EQ(10, chunk.size());
+
+  // 保留偶数行，再保留大于4的行
+  Column bools(BOOLEANS, sizeof(int32_t), Chunk::MAX_ROWS);
+  for (int32_t i = 0; i < 10; i++) {
+    const int32_t value = (i % 2 == 0);
+    bools.append(reinterpret_cast<const char *>(&value));
+  }
+  chunk.filter(bools);
+  ASSERT_EQ(5, chunk.size());
+  ASSERT_EQ(8, chunk.row_at(4));
+
+  for (int32_t i = 0; i < 10; i++) {
+    bools.values<int32_t>()[i] = (i > 4);
+  }
+  chunk.filter(bools);
+  ASSERT_EQ(2, chunk.size());
+  ASSERT_EQ(6, chunk.row_at(0));
+
+  // 复制以后只有有效的行
+  Chunk copied;
+  copied.copy_from(chunk);
+  ASSERT_EQ(2, copied.rows());
+  ASSERT_EQ(2, copied.size());
+  Value value;
+  copied.column(0).get_value(1, value);
+  ASSERT_EQ(8, value.get_int());
+  ASSERT_EQ(0, copied.find_column("t", "a"));
+  ASSERT_EQ(-1, copied.find_column("t", "b"));
+}
+
+TEST(test_chunk, test_calc)
+{
+  vector<unique_ptr<Expression>> expressions;
+  expressions.emplace_back(
+      new ArithmeticExpr(ArithmeticExpr::Type::ADD, make_unique<ValueExpr>(Value(1)), make_unique<ValueExpr>(Value(2))));
+  expressions.emplace_back(new ArithmeticExpr(
+      ArithmeticExpr::Type::DIV, make_unique<ValueExpr>(Value(3)), make_unique<ValueExpr>(Value(2.0f))));
+  expressions.emplace_back(
+      compare_expr(LESS_THAN, make_unique<ValueExpr>(Value("abc")), Value("abd")).release());
+
+  CalcPhysicalOperator calc(std::move(expressions));
+  Chunk chunk;
+  ASSERT_EQ(RC::SUCCESS, calc.next_chunk(chunk));
+  ASSERT_EQ(1, chunk.size());
+  ASSERT_EQ(3, chunk.column_num());
+
+  Value value;
+  chunk.column(0).get_value(0, value);
+  ASSERT_EQ(3, value.get_int());
+  chunk.column(1).get_value(0, value);
+  ASSERT_FLOAT_EQ(1.5f, value.get_float());
+  chunk.column(2).get_value(0, value);
+  ASSERT_TRUE(value.get_boolean());
+
+  ASSERT_EQ(RC::RECORD_EOF, calc.next_chunk(chunk));
+}
+
+TEST(test_chunk, test_scan_filter_project)
+{
+  filesystem::remove_all(chunk_db_path);
+  filesystem::create_directory(chunk_db_path);
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", chunk_db_path));
+    prepare_table(db, "t");
+    Table *table = db.find_table("t");
+    Trx *trx = GCTX.trx_kit_->create_trx(db.clog_manager());
+
+    // select name, id from t where id >= 100 and score < 1000 and name <> 'x'
+    // 最后一个条件比较字符串，逐行计算
+    auto scan = make_unique<TableScanPhysicalOperator>(table, true);
+    vector<unique_ptr<Expression>> predicates;
+    predicates.emplace_back(compare_expr(GREAT_EQUAL, field_expr(table, "id"), Value(100)));
+    scan->set_predicates(std::move(predicates));
+
+    vector<unique_ptr<Expression>> conditions;
+    conditions.emplace_back(compare_expr(LESS_THAN, field_expr(table, "score"), Value(1000)));
+    conditions.emplace_back(compare_expr(NOT_EQUAL, field_expr(table, "name"), Value("x")));
+    auto predicate = make_unique<PredicatePhysicalOperator>(
+        make_unique<ConjunctionExpr>(ConjunctionExpr::Type::AND, conditions));
+    predicate->add_child(std::move(scan));
+
+    ProjectPhysicalOperator project;
+    project.add_projection(table, table->table_meta().field("name"));
+    project.add_projection(table, table->table_meta().field("id"));
+    project.add_child(std::move(predicate));
+
+    // 逐行的接口返回的是批次中的每一行
+    ASSERT_EQ(RC::SUCCESS, project.open(trx));
+    int expected_id = 100;
+    RC rc = RC::SUCCESS;
+    while (RC::SUCCESS == (rc = project.next())) {
+      Tuple *tuple = project.current_tuple();
+      ASSERT_EQ(2, tuple->cell_num());
+      Value name;
+      Value id;
+      ASSERT_EQ(RC::SUCCESS, tuple->cell_at(0, name));
+      ASSERT_EQ(RC::SUCCESS, tuple->cell_at(1, id));
+      ASSERT_EQ(expected_id, id.get_int());
+      ASSERT_EQ("n" + to_string(expected_id % 10), name.get_string());
+      expected_id++;
+    }
+    ASSERT_EQ(RC::RECORD_EOF, rc);
+    ASSERT_EQ(2000, expected_id);
+    ASSERT_EQ(RC::SUCCESS, project.close());
+
+    GCTX.trx_kit_->destroy_trx(trx);
+  }
+  filesystem::remove_all(chunk_db_path);
+}
+
+TEST(test_chunk, test_join)
+{
+  filesystem::remove_all(chunk_db_path);
+  filesystem::create_directory(chunk_db_path);
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", chunk_db_path));
+    prepare_table(db, "t1");
+    prepare_table(db, "t2");
+    Table *t1 = db.find_table("t1");
+    Table *t2 = db.find_table("t2");
+    Trx *trx = GCTX.trx_kit_->create_trx(db.clog_manager());
+
+    // select t1.id, t2.score from t1, t2 where t1.id < 3 and t2.id < 1500 and t1.id * 500 = t2.id
+    auto left = make_unique<TableScanPhysicalOperator>(t1, true);
+    vector<unique_ptr<Expression>> left_predicates;
+    left_predicates.emplace_back(compare_expr(LESS_THAN, field_expr(t1, "id"), Value(3)));
+    left->set_predicates(std::move(left_predicates));
+
+    auto right = make_unique<TableScanPhysicalOperator>(t2, true);
+    vector<unique_ptr<Expression>> right_predicates;
+    right_predicates.emplace_back(compare_expr(LESS_THAN, field_expr(t2, "id"), Value(1500)));
+    right->set_predicates(std::move(right_predicates));
+
+    auto join = make_unique<NestedLoopJoinPhysicalOperator>();
+    join->add_child(std::move(left));
+    join->add_child(std::move(right));
+
+    auto predicate = make_unique<PredicatePhysicalOperator>(make_unique<ComparisonExpr>(EQUAL_TO,
+        make_unique<ArithmeticExpr>(ArithmeticExpr::Type::MUL, field_expr(t1, "id"), make_unique<ValueExpr>(Value(500))),
+        field_expr(t2, "id")));
+    predicate->add_child(std::move(join));
+
+    ProjectPhysicalOperator project;
+    project.add_projection(t1, t1->table_meta().field("id"));
+    project.add_projection(t2, t2->table_meta().field("score"));
+    project.add_child(std::move(predicate));
+
+    ASSERT_EQ(RC::SUCCESS, project.open(trx));
+    vector<pair<int, float>> results;
+    while (RC::SUCCESS == project.next()) {
+      Tuple *tuple = project.current_tuple();
+      Value id;
+      Value score;
+      ASSERT_EQ(RC::SUCCESS, tuple->cell_at(0, id));
+      ASSERT_EQ(RC::SUCCESS, tuple->cell_at(1, score));
+      results.emplace_back(id.get_int(), score.get_float());
+    }
+    ASSERT_EQ(RC::SUCCESS, project.close());
+    ASSERT_EQ((vector<pair<int, float>>{{0, 0.0f}, {1, 250.0f}, {2, 500.0f}}), results);
+
+    GCTX.trx_kit_->destroy_trx(trx);
+  }
+  filesystem::remove_all(chunk_db_path);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  LoggerFactory::init_default("chunk_test.log", LOG_LEVEL_INFO);
+
+  BufferPoolManager::set_instance(&bpm);
+  if (TrxKit::init_global("vacuous") != RC::SUCCESS) {
+    return 1;
+  }
+  GCTX.trx_kit_ = TrxKit::instance();
+  return RUN_ALL_TESTS();
+}
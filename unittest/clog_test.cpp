@@ -12,7 +12,13 @@ See the Mulan PSL v2 for more details. */
 // Created by huhaosheng.hhs on 2022
 //
 
+#include <fcntl.h>
 #include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include <vector>
 
 #include "common/log/log.h"
 #include "storage/clog/clog.h"
@@ -20,11 +26,30 @@ See the Mulan PSL v2 for more details. */
 
 using namespace common;
 
+// 日志目录下有多个日志段文件和检查点文件，每个测试使用一个新的目录
+const char *clog_path = "clog_test_dir";
+
+void prepare_clog_path()
+{
+  std::filesystem::remove_all(clog_path);
+  std::filesystem::create_directory(clog_path);
+}
+
+int clog_segment_num()
+{
+  int num = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(clog_path)) {
+    if (entry.path().filename().string().rfind("clog.", 0) == 0) {
+      num++;
+    }
+  }
+  return num;
+}
+
 TEST(test_clog, test_clog)
 {
-  const char *path = ".";
-  const char *clog_file = "./clog";
-  remove(clog_file);
+  const char *path = clog_path;
+  prepare_clog_path();
   
 
   CLogManager log_mgr;
@@ -45,6 +70,332 @@ TEST(test_clog, test_clog)
   */
 }
 
+TEST(test_clog, test_group_commit)
+{
+  const char *path = clog_path;
+  prepare_clog_path();
+
+  const int thread_num = 8;
+  const int trx_per_thread = 50;
+  LSN flushed_lsn = 0;
+  {
+    CLogManager log_mgr;
+    ASSERT_EQ(RC::SUCCESS, log_mgr.init(path));
+
+    auto committer = [&log_mgr](int thread_id) {
+      for (int i = 0; i < trx_per_thread; i++) {
+        int32_t trx_id = thread_id * trx_per_thread + i + 1;
+        ASSERT_EQ(RC::SUCCESS, log_mgr.begin_trx(trx_id));
+        ASSERT_EQ(RC::SUCCESS, log_mgr.append_log(CLogType::INSERT, trx_id, 1, RID(1, i), 4, 0, "data"));
+        ASSERT_EQ(RC::SUCCESS, log_mgr.commit_trx(trx_id, trx_id));
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_num; i++) {
+      threads.emplace_back(committer, i);
+    }
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+
+    const CLogGroupCommitStats &stats = log_mgr.group_commit_stats();
+    ASSERT_EQ(thread_num * trx_per_thread, stats.commit_count.load());
+    ASSERT_EQ(thread_num * trx_per_thread, stats.wait_count.load());
+    ASSERT_LE(stats.sync_count.load(), stats.commit_count.load());
+    ASSERT_GE(stats.max_group_size.load(), 1);
+    flushed_lsn = log_mgr.flushed_lsn();
+  }
+
+  // 日志文件中的记录按照LSN顺序排列，没有遗漏
+  CLogFile log_file;
+  ASSERT_EQ(RC::SUCCESS, log_file.init(path));
+  CLogRecordIterator iterator;
+  ASSERT_EQ(RC::SUCCESS, iterator.init(log_file));
+  LSN expect_lsn = 0;
+  int record_num = 0;
+  RC rc = RC::SUCCESS;
+  for (rc = iterator.next(); OB_SUCC(rc) && iterator.valid(); rc = iterator.next()) {
+    ASSERT_EQ(expect_lsn, iterator.log_record().header().lsn_);
+    expect_lsn = iterator.next_lsn();
+    record_num++;
+  }
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  ASSERT_EQ(thread_num * trx_per_thread * 3, record_num);
+  ASSERT_EQ(flushed_lsn, expect_lsn);
+}
+
+TEST(test_clog, test_log_buffer_wrap)
+{
+  const char *path = clog_path;
+  prepare_clog_path();
+
+  CLogFile log_file;
+  ASSERT_EQ(RC::SUCCESS, log_file.init(path));
+
+  // 缓存很小，写日志时会多次回绕，并且需要等待空间
+  CLogBuffer log_buffer;
+  ASSERT_EQ(RC::SUCCESS, log_buffer.init(0, 256));
+
+  const int thread_num = 4;
+  const int record_per_thread = 200;
+  auto writer = [&log_buffer, &log_file](int thread_id) {
+    char payload[64];
+    for (int i = 0; i < record_per_thread; i++) {
+      const int payload_len = i % (int)sizeof(payload);
+      memset(payload, 'a' + thread_id, payload_len);
+
+      CLogRecordData data_record;
+      data_record.table_id_ = thread_id;
+      data_record.rid_      = RID(thread_id, i);
+      data_record.data_len_ = payload_len;
+
+      CLogRecordHeader header;
+      header.trx_id_     = thread_id;
+      header.type_       = clog_type_to_integer(CLogType::INSERT);
+      header.logrec_len_ = CLogRecordData::HEADER_SIZE + payload_len;
+
+      LSN end_lsn = 0;
+      ASSERT_EQ(RC::SUCCESS,
+          log_buffer.append_log_record(log_file,
+              header,
+              {CLogSlice{reinterpret_cast<const char *>(&data_record), CLogRecordData::HEADER_SIZE},
+                  CLogSlice{payload, payload_len}},
+              end_lsn));
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_num; i++) {
+    threads.emplace_back(writer, i);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  LSN written_lsn = 0;
+  ASSERT_EQ(RC::SUCCESS, log_buffer.flush_buffer(log_file, written_lsn));
+  ASSERT_EQ(log_buffer.published_lsn(), written_lsn);
+
+  CLogFile read_file;
+  ASSERT_EQ(RC::SUCCESS, read_file.init(path));
+  CLogRecordIterator iterator;
+  ASSERT_EQ(RC::SUCCESS, iterator.init(read_file));
+  int next_slot[thread_num] = {0};
+  RC rc = RC::SUCCESS;
+  for (rc = iterator.next(); OB_SUCC(rc) && iterator.valid(); rc = iterator.next()) {
+    const CLogRecordData &data_record = iterator.log_record().data_record();
+    const int thread_id = data_record.table_id_;
+    ASSERT_TRUE(thread_id >= 0 && thread_id < thread_num);
+    // 同一个线程的日志按照写入的顺序排列
+    ASSERT_EQ(next_slot[thread_id], data_record.rid_.slot_num);
+    next_slot[thread_id]++;
+    for (int i = 0; i < data_record.data_len_; i++) {
+      ASSERT_EQ('a' + thread_id, data_record.data_[i]);
+    }
+  }
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  ASSERT_EQ(written_lsn, iterator.next_lsn());
+  for (int i = 0; i < thread_num; i++) {
+    ASSERT_EQ(record_per_thread, next_slot[i]);
+  }
+}
+
+TEST(test_clog, test_segment_and_checkpoint)
+{
+  prepare_clog_path();
+
+  CLogConfig config;
+  config.segment_size        = CLogFile::BLOCK_SIZE;
+  config.checkpoint_interval = 0;
+
+  const int trx_num = 200;
+  char data[400];
+  memset(data, 'x', sizeof(data));
+  LSN redo_lsn = 0;
+  {
+    CLogManager log_mgr;
+    ASSERT_EQ(RC::SUCCESS, log_mgr.init(clog_path, config));
+
+    // 一个长事务，检查点不能越过它的开始位置
+    const int32_t long_trx_id = 100000;
+    ASSERT_EQ(RC::SUCCESS, log_mgr.begin_trx(long_trx_id));
+    for (int i = 1; i <= trx_num; i++) {
+      ASSERT_EQ(RC::SUCCESS, log_mgr.begin_trx(i));
+      ASSERT_EQ(RC::SUCCESS, log_mgr.append_log(CLogType::INSERT, i, 1, RID(1, i), sizeof(data), 0, data));
+      ASSERT_EQ(RC::SUCCESS, log_mgr.commit_trx(i, i));
+    }
+    const int segment_num = clog_segment_num();
+    ASSERT_GT(segment_num, 10);
+
+    ASSERT_EQ(RC::SUCCESS, log_mgr.checkpoint());
+    ASSERT_GE(clog_segment_num(), segment_num);
+
+    // 长事务结束后，检查点可以回收前面的日志段。剩下当前的段和预先准备的下一个段
+    ASSERT_EQ(RC::SUCCESS, log_mgr.commit_trx(long_trx_id, long_trx_id));
+    ASSERT_EQ(RC::SUCCESS, log_mgr.checkpoint());
+    ASSERT_LE(clog_segment_num(), 2);
+    redo_lsn = log_mgr.flushed_lsn();
+
+    // 自动检查点
+    config.checkpoint_interval = 4 * config.segment_size;
+  }
+
+  CLogCheckpoint checkpoint;
+  bool found = false;
+  ASSERT_EQ(RC::SUCCESS, checkpoint.load(clog_path, found));
+  ASSERT_TRUE(found);
+  ASSERT_EQ(redo_lsn, checkpoint.redo_lsn);
+  ASSERT_EQ(CLogFile::BLOCK_SIZE, checkpoint.segment_size);
+
+  {
+    // 修改了段大小的配置，仍然使用原来的段大小
+    CLogConfig new_config = config;
+    new_config.segment_size = 4 * CLogFile::BLOCK_SIZE;
+    CLogManager log_mgr;
+    ASSERT_EQ(RC::SUCCESS, log_mgr.init(clog_path, new_config));
+    ASSERT_EQ(redo_lsn, log_mgr.flushed_lsn());
+
+    for (int i = 1; i <= trx_num; i++) {
+      ASSERT_EQ(RC::SUCCESS, log_mgr.begin_trx(i));
+      ASSERT_EQ(RC::SUCCESS, log_mgr.append_log(CLogType::INSERT, i, 1, RID(1, i), sizeof(data), 0, data));
+      ASSERT_EQ(RC::SUCCESS, log_mgr.commit_trx(i, i));
+    }
+    // 写入的日志超过检查点间隔时，刷盘线程在后台做检查点，日志段数量不会一直增长
+    for (int i = 0; i < 500 && clog_segment_num() > 7; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_LE(clog_segment_num(), 7);
+  }
+
+  {
+    // 后台的检查点可能已经覆盖了上面所有的日志，不做自动检查点，再写入一些
+    CLogConfig new_config = config;
+    new_config.checkpoint_interval = 0;
+    CLogManager log_mgr;
+    ASSERT_EQ(RC::SUCCESS, log_mgr.init(clog_path, new_config));
+    ASSERT_EQ(RC::SUCCESS, log_mgr.begin_trx(trx_num + 1));
+    ASSERT_EQ(RC::SUCCESS, log_mgr.commit_trx(trx_num + 1, trx_num + 1));
+  }
+
+  // 从检查点开始读取日志
+  ASSERT_EQ(RC::SUCCESS, checkpoint.load(clog_path, found));
+  ASSERT_GT(checkpoint.redo_lsn, redo_lsn);
+  CLogFile log_file;
+  ASSERT_EQ(RC::SUCCESS, log_file.init(clog_path, checkpoint.segment_size));
+  ASSERT_LE(log_file.begin_lsn(), checkpoint.redo_lsn);
+  CLogRecordIterator iterator;
+  ASSERT_EQ(RC::SUCCESS, iterator.init(log_file, checkpoint.redo_lsn));
+  RC rc = RC::SUCCESS;
+  int record_num = 0;
+  for (rc = iterator.next(); OB_SUCC(rc) && iterator.valid(); rc = iterator.next()) {
+    record_num++;
+  }
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  ASSERT_GT(record_num, 0);
+  std::filesystem::remove_all(clog_path);
+}
+
+TEST(test_clog, test_block_checksum)
+{
+  prepare_clog_path();
+
+  char data[100];
+  memset(data, 'x', sizeof(data));
+  LSN end_lsn = 0;
+  {
+    CLogManager log_mgr;
+    ASSERT_EQ(RC::SUCCESS, log_mgr.init(clog_path));
+    for (int i = 1; i <= 100; i++) {
+      ASSERT_EQ(RC::SUCCESS, log_mgr.begin_trx(i));
+      ASSERT_EQ(RC::SUCCESS, log_mgr.append_log(CLogType::INSERT, i, 1, RID(1, i), sizeof(data), 0, data));
+      ASSERT_EQ(RC::SUCCESS, log_mgr.commit_trx(i, i, &end_lsn));
+    }
+  }
+  ASSERT_GT(end_lsn, 2 * CLogFile::BLOCK_DATA_SIZE);
+
+  // 日志段是预先分配的，日志的结尾通过日志块找到
+  {
+    CLogFile log_file;
+    ASSERT_EQ(RC::SUCCESS, log_file.init(clog_path));
+    LSN file_end_lsn = 0;
+    ASSERT_EQ(RC::SUCCESS, log_file.end_lsn(file_end_lsn));
+    ASSERT_EQ(end_lsn, file_end_lsn);
+  }
+
+  // 破坏第二个块中的数据，模拟没有写完整的块，读取日志时在这个块之前结束
+  const std::string file_name = std::string(clog_path) + "/clog.0000000000";
+  int fd = ::open(file_name.c_str(), O_RDWR);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(1, ::pwrite(fd, "z", 1, CLogFile::BLOCK_SIZE + 100));
+  ::close(fd);
+
+  CLogFile log_file;
+  ASSERT_EQ(RC::SUCCESS, log_file.init(clog_path));
+  CLogRecordIterator iterator;
+  ASSERT_EQ(RC::SUCCESS, iterator.init(log_file));
+  RC rc = RC::SUCCESS;
+  int record_num = 0;
+  for (rc = iterator.next(); OB_SUCC(rc) && iterator.valid(); rc = iterator.next()) {
+    record_num++;
+  }
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  ASSERT_TRUE(log_file.torn());
+  ASSERT_GT(record_num, 0);
+  ASSERT_LE(iterator.next_lsn(), CLogFile::BLOCK_DATA_SIZE);
+
+  // 截断以后，损坏的块和后面的块都被清除
+  ASSERT_EQ(RC::SUCCESS, log_file.truncate(iterator.next_lsn()));
+  LSN file_end_lsn = 0;
+  ASSERT_EQ(RC::SUCCESS, log_file.end_lsn(file_end_lsn));
+  ASSERT_EQ(iterator.next_lsn(), file_end_lsn);
+}
+
+TEST(test_clog, test_durability)
+{
+  prepare_clog_path();
+
+  CLogConfig config;
+  config.flush_interval_ms = 10;
+  CLogManager log_mgr;
+  ASSERT_EQ(RC::SUCCESS, log_mgr.init(clog_path, config));
+  ASSERT_EQ(CLogDurability::SYNC, log_mgr.default_durability());
+
+  // SYNC: 提交返回时日志已经持久化
+  LSN end_lsn = 0;
+  ASSERT_EQ(RC::SUCCESS, log_mgr.begin_trx(1));
+  ASSERT_EQ(RC::SUCCESS, log_mgr.commit_trx(1, 1, &end_lsn));
+  ASSERT_GE(log_mgr.flushed_lsn(), end_lsn);
+
+  // ASYNC: 提交不等待刷盘，后台线程在刷盘间隔后持久化
+  ASSERT_EQ(RC::SUCCESS, log_mgr.begin_trx(2));
+  ASSERT_EQ(RC::SUCCESS, log_mgr.commit_trx(2, 2, &end_lsn, CLogDurability::ASYNC));
+  for (int i = 0; i < 500 && log_mgr.flushed_lsn() < end_lsn; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_GE(log_mgr.flushed_lsn(), end_lsn);
+
+  // BUFFERED: 服务器级别的设置对 DEFAULT 的提交生效，后台线程不会为它刷盘
+  log_mgr.set_default_durability(CLogDurability::BUFFERED);
+  ASSERT_EQ(RC::SUCCESS, log_mgr.begin_trx(3));
+  ASSERT_EQ(RC::SUCCESS, log_mgr.commit_trx(3, 3, &end_lsn));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ASSERT_LT(log_mgr.flushed_lsn(), end_lsn);
+  ASSERT_NE(std::string::npos, log_mgr.durability_status().find("durability:buffered"));
+
+  // 其它提交刷盘时一起持久化，并统计延迟
+  ASSERT_EQ(RC::SUCCESS, log_mgr.sync());
+  ASSERT_GE(log_mgr.flushed_lsn(), end_lsn);
+
+  const CLogDurabilityStats &stats = log_mgr.durability_stats();
+  ASSERT_EQ(1, stats.sync_commits.load());
+  ASSERT_EQ(1, stats.async_commits.load());
+  ASSERT_EQ(1, stats.buffered_commits.load());
+  ASSERT_GE(stats.background_syncs.load(), 1);
+  ASSERT_EQ(2, stats.lag_count.load());
+  ASSERT_GE(stats.max_lag_us.load(), 50 * 1000);
+}
+
 int main(int argc, char **argv)
 {
   // 分析gtest程序的命令行参数
@@ -0,0 +1,154 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <stdio.h>
+#include <list>
+
+#include "storage/index/extendible_hash.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "common/log/log.h"
+#include "gtest/gtest.h"
+
+using namespace common;
+
+BufferPoolManager bpm;
+const char *hash_index_name = "test.hash";
+
+// 桶很小，让目录扩展很多次
+const int BUCKET_CAPACITY = 8;
+
+TEST(test_extendible_hash, test_ints)
+{
+  ::remove(hash_index_name);
+  ExtendibleHashHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(hash_index_name, INTS, sizeof(int), false, BUCKET_CAPACITY));
+
+  const int insert_num = 5000;
+  for (int i = 0; i < insert_num; i++) {
+    RID rid(i / 100 + 1, i % 100);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(reinterpret_cast<const char *>(&i), &rid));
+  }
+  ASSERT_GT(handler.file_header().global_depth, 8);
+
+  // 重复插入相同的键值对
+  int key = 10;
+  RID rid(1, 10);
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, handler.insert_entry(reinterpret_cast<const char *>(&key), &rid));
+
+  for (int i = 0; i < insert_num; i++) {
+    std::list<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, handler.get_entry(reinterpret_cast<const char *>(&i), sizeof(i), rids));
+    ASSERT_EQ(1, (int)rids.size());
+    ASSERT_EQ(i / 100 + 1, rids.front().page_num);
+    ASSERT_EQ(i % 100, rids.front().slot_num);
+  }
+
+  for (int i = 0; i < insert_num; i += 2) {
+    RID rid(i / 100 + 1, i % 100);
+    ASSERT_EQ(RC::SUCCESS, handler.delete_entry(reinterpret_cast<const char *>(&i), &rid));
+  }
+  key = 0;
+  ASSERT_EQ(RC::RECORD_NOT_EXIST, handler.delete_entry(reinterpret_cast<const char *>(&key), &rid));
+
+  // 重新打开以后目录从文件中加载
+  const int global_depth = handler.file_header().global_depth;
+  ASSERT_EQ(RC::SUCCESS, handler.close());
+  ASSERT_EQ(RC::SUCCESS, handler.open(hash_index_name));
+  ASSERT_EQ(global_depth, handler.file_header().global_depth);
+
+  for (int i = 0; i < insert_num; i++) {
+    std::list<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, handler.get_entry(reinterpret_cast<const char *>(&i), sizeof(i), rids));
+    ASSERT_EQ(i % 2 == 0 ? 0 : 1, (int)rids.size());
+  }
+  handler.close();
+}
+
+TEST(test_extendible_hash, test_duplicate_chars)
+{
+  ::remove(hash_index_name);
+  ExtendibleHashHandler handler;
+  const int attr_length = 16;
+  ASSERT_EQ(RC::SUCCESS, handler.create(hash_index_name, CHARS, attr_length, false, BUCKET_CAPACITY));
+
+  // 大量重复的键值，只能放在溢出页中
+  const int key_num = 20;
+  const int dup_num = 50;
+  char attr[attr_length];
+  for (int i = 0; i < key_num * dup_num; i++) {
+    memset(attr, 0, sizeof(attr));
+    snprintf(attr, sizeof(attr), "key-%d", i % key_num);
+    RID rid(i + 1, 0);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(attr, &rid));
+  }
+
+  for (int i = 0; i < key_num; i++) {
+    snprintf(attr, sizeof(attr), "key-%d", i);
+    std::list<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, handler.get_entry(attr, strlen(attr), rids));
+    ASSERT_EQ(dup_num, (int)rids.size());
+    for (const RID &rid : rids) {
+      ASSERT_EQ(i, (rid.page_num - 1) % key_num);
+    }
+  }
+
+  std::list<RID> rids;
+  ASSERT_EQ(RC::SUCCESS, handler.get_entry("key-", 4, rids));
+  ASSERT_TRUE(rids.empty());
+
+  for (int i = 0; i < key_num * dup_num; i += 2) {
+    memset(attr, 0, sizeof(attr));
+    snprintf(attr, sizeof(attr), "key-%d", i % key_num);
+    RID rid(i + 1, 0);
+    ASSERT_EQ(RC::SUCCESS, handler.delete_entry(attr, &rid));
+  }
+
+  for (int i = 0; i < key_num; i++) {
+    snprintf(attr, sizeof(attr), "key-%d", i);
+    std::list<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, handler.get_entry(attr, strlen(attr), rids));
+    ASSERT_EQ(i % 2 == 0 ? 0 : dup_num, (int)rids.size());
+  }
+  handler.close();
+}
+
+TEST(test_extendible_hash, test_unique)
+{
+  ::remove(hash_index_name);
+  ExtendibleHashHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(hash_index_name, INTS, sizeof(int), true, BUCKET_CAPACITY));
+
+  int key = 1;
+  RID rid1(1, 1);
+  RID rid2(1, 2);
+  ASSERT_EQ(RC::SUCCESS, handler.insert_entry(reinterpret_cast<const char *>(&key), &rid1));
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, handler.insert_entry(reinterpret_cast<const char *>(&key), &rid2));
+  ASSERT_EQ(RC::SUCCESS, handler.delete_entry(reinterpret_cast<const char *>(&key), &rid1));
+  ASSERT_EQ(RC::SUCCESS, handler.insert_entry(reinterpret_cast<const char *>(&key), &rid2));
+  handler.close();
+}
+
+TEST(test_extendible_hash, test_floats)
+{
+  // 浮点数按照 EPSILON 比较，不能使用哈希索引
+  ::remove(hash_index_name);
+  ExtendibleHashHandler handler;
+  ASSERT_EQ(RC::INVALID_ARGUMENT, handler.create(hash_index_name, FLOATS, sizeof(float), false, BUCKET_CAPACITY));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  LoggerFactory::init_default("extendible_hash_test.log", LOG_LEVEL_INFO);
+  BufferPoolManager::set_instance(&bpm);
+  int rc = RUN_ALL_TESTS();
+  ::remove(hash_index_name);
+  return rc;
+}
@@ -0,0 +1,141 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sql/operator/hash_join_physical_operator.h"
+#include "sql/operator/table_scan_physical_operator.h"
+#include "join_test.h"
+
+using namespace std;
+
+const int ROW_NUM = 3000;
+
+class HashJoinTest : public JoinTest
+{
+protected:
+  void SetUp() override
+  {
+    JoinTest::SetUp();
+    t1_ = prepare_table("t1");
+    t2_ = prepare_table("t2");
+  }
+
+  /**
+   * @brief 创建表 t(id int, name char(8))，id 从0开始，name 只有10种
+   */
+  Table *prepare_table(const char *table_name)
+  {
+    Table *table = create_table(table_name, {attr("id", INTS), attr("name", CHARS, 8)});
+    for (int i = 0; i < ROW_NUM; i++) {
+      const string name = "n" + to_string(i % 10);
+      insert_row(table, {Value(i), Value(name.c_str())});
+    }
+    return table;
+  }
+
+  /**
+   * @brief 扫描表，只保留 id < max_id 的行
+   */
+  static unique_ptr<PhysicalOperator> create_scan(Table *table, int max_id)
+  {
+    auto scan = make_unique<TableScanPhysicalOperator>(table, true);
+    scan->set_predicates(id_less_than(table, max_id));
+    return scan;
+  }
+
+  /**
+   * @brief 执行 select t1.id, t2.id from t1, t2 where t1.key = t2.key and t1.id < left_max and t2.id < right_max
+   * @return 按照 (t1.id, t2.id) 排序的结果
+   */
+  vector<pair<int, int>> run_join(const char *key, int left_max, int right_max, bool build_left, int64_t memory_limit,
+      int *spilled_partitions = nullptr)
+  {
+    vector<unique_ptr<Expression>> left_keys;
+    vector<unique_ptr<Expression>> right_keys;
+    left_keys.emplace_back(field_expr(t1_, key));
+    right_keys.emplace_back(field_expr(t2_, key));
+    HashJoinPhysicalOperator join(std::move(left_keys), std::move(right_keys), build_left, memory_limit);
+    join.add_child(create_scan(t1_, left_max));
+    join.add_child(create_scan(t2_, right_max));
+
+    vector<pair<int, int>> results =
+        JoinTest::run_join(join, TupleCellSpec(t1_->name(), "id"), TupleCellSpec(t2_->name(), "id"), [&]() {
+          // 结束以后再调用仍然返回 EOF
+          EXPECT_EQ(RC::RECORD_EOF, join.next());
+          EXPECT_EQ(RC::RECORD_EOF, join.next());
+          if (spilled_partitions != nullptr) {
+            *spilled_partitions = join.spilled_partitions();
+          }
+        });
+    sort(results.begin(), results.end());
+    return results;
+  }
+
+protected:
+  Table *t1_ = nullptr;
+  Table *t2_ = nullptr;
+};
+
+TEST_F(HashJoinTest, test_unique_keys)
+{
+  vector<pair<int, int>> expected;
+  for (int i = 0; i < 2000; i++) {
+    expected.emplace_back(i, i);
+  }
+
+  // 两端的行数都超过一批，构建端在左边或者右边结果都一样
+  ASSERT_EQ(expected, run_join("id", ROW_NUM, 2000, true, 64 * 1024 * 1024));
+  ASSERT_EQ(expected, run_join("id", ROW_NUM, 2000, false, 64 * 1024 * 1024));
+}
+
+TEST_F(HashJoinTest, test_duplicate_keys)
+{
+  // t1 的20行中每个 name 出现两次，t2 中每个 name 出现300次
+  vector<pair<int, int>> expected;
+  for (int i = 0; i < 20; i++) {
+    for (int j = i % 10; j < ROW_NUM; j += 10) {
+      expected.emplace_back(i, j);
+    }
+  }
+
+  ASSERT_EQ(expected, run_join("name", 20, ROW_NUM, true, 64 * 1024 * 1024));
+  ASSERT_EQ(expected, run_join("name", 20, ROW_NUM, false, 64 * 1024 * 1024));
+}
+
+TEST_F(HashJoinTest, test_spill)
+{
+  const vector<pair<int, int>> expected = run_join("id", ROW_NUM, ROW_NUM, false, 64 * 1024 * 1024);
+  ASSERT_EQ(ROW_NUM, static_cast<int>(expected.size()));
+
+  int spilled_partitions = 0;
+  ASSERT_EQ(expected, run_join("id", ROW_NUM, ROW_NUM, false, 32 * 1024, &spilled_partitions));
+  ASSERT_GT(spilled_partitions, 0);
+
+  // 重复的键也分到同一个分区
+  vector<pair<int, int>> duplicates = run_join("name", 50, ROW_NUM, false, 64 * 1024 * 1024);
+  ASSERT_EQ(duplicates, run_join("name", 50, ROW_NUM, false, 32 * 1024, &spilled_partitions));
+  ASSERT_GT(spilled_partitions, 0);
+}
+
+TEST_F(HashJoinTest, test_empty)
+{
+  ASSERT_TRUE(run_join("id", 0, ROW_NUM, true, 64 * 1024 * 1024).empty());
+  ASSERT_TRUE(run_join("id", ROW_NUM, 0, true, 64 * 1024 * 1024).empty());
+  ASSERT_TRUE(run_join("id", ROW_NUM, 0, false, 32 * 1024).empty());
+}
+
+int main(int argc, char **argv)
+{
+  return run_join_tests(argc, argv, "hash_join_test.log");
+}
@@ -0,0 +1,182 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sql/operator/index_nested_loop_join_physical_operator.h"
+#include "sql/operator/index_scan_physical_operator.h"
+#include "sql/operator/join_logical_operator.h"
+#include "sql/operator/table_get_logical_operator.h"
+#include "sql/operator/table_scan_physical_operator.h"
+#include "sql/optimizer/physical_plan_generator.h"
+#include "join_test.h"
+
+using namespace std;
+
+const int INNER_ROW_NUM = 3000;
+const int INNER_KEY_NUM = 1500;  // 内表每个键出现两次
+
+class IndexNestedLoopJoinTest : public JoinTest
+{
+protected:
+  void SetUp() override
+  {
+    JoinTest::SetUp();
+
+    vector<int> inner_ids;
+    for (int i = 0; i < INNER_ROW_NUM; i++) {
+      inner_ids.push_back(i % INNER_KEY_NUM);
+    }
+    inner_ = prepare_table("inner_t", inner_ids);
+  }
+
+  /**
+   * @brief 创建表 t(id int, v int)，插入 (ids[i], i)
+   */
+  Table *prepare_table(const char *table_name, const vector<int> &ids)
+  {
+    Table *table = create_table(table_name, {attr("id", INTS), attr("v", INTS)});
+    for (size_t i = 0; i < ids.size(); i++) {
+      insert_row(table, {Value(ids[i]), Value(static_cast<int>(i))});
+    }
+    return table;
+  }
+
+  /**
+   * @brief 执行 select outer_t.v, inner_t.v from outer_t, inner_t where outer_t.id = inner_t.id
+   * @return 按照输出顺序的结果
+   */
+  vector<pair<int, int>> run_join(const vector<int> &outer_ids, Index *index)
+  {
+    Table *outer = create_outer_table(outer_ids);
+
+    IndexNestedLoopJoinPhysicalOperator join(field_expr(outer, "id"));
+    join.add_child(make_unique<TableScanPhysicalOperator>(outer, true));
+    join.add_child(make_unique<IndexScanPhysicalOperator>(inner_, index, true));
+    return JoinTest::run_join(join, TupleCellSpec(outer->name(), "v"), TupleCellSpec(inner_->name(), "v"));
+  }
+
+  /**
+   * @brief 外表第 i 行依次与内表中 id 相同的行连接，内表同一个键的行按照插入的顺序返回
+   */
+  static vector<pair<int, int>> expected_results(const vector<int> &outer_ids)
+  {
+    vector<pair<int, int>> results;
+    for (size_t i = 0; i < outer_ids.size(); i++) {
+      const int id = outer_ids[i];
+      if (id < 0 || id >= INNER_KEY_NUM) {
+        continue;
+      }
+      for (int v = id; v < INNER_ROW_NUM; v += INNER_KEY_NUM) {
+        results.emplace_back(static_cast<int>(i), v);
+      }
+    }
+    return results;
+  }
+
+  /**
+   * @brief 为 outer_t.id = inner_t.id 生成物理计划
+   */
+  unique_ptr<PhysicalOperator> generate_join_plan(Table *outer)
+  {
+    auto table_fields = [](Table *table) {
+      vector<Field> fields;
+      for (const FieldMeta &field_meta : *table->table_meta().field_metas()) {
+        fields.emplace_back(table, &field_meta);
+      }
+      return fields;
+    };
+
+    JoinLogicalOperator join_oper;
+    join_oper.add_child(make_unique<TableGetLogicalOperator>(outer, table_fields(outer), true));
+    join_oper.add_child(make_unique<TableGetLogicalOperator>(inner_, table_fields(inner_), true));
+    join_oper.expressions().emplace_back(
+        new ComparisonExpr(EQUAL_TO, field_expr(outer, "id"), field_expr(inner_, "id")));
+
+    unique_ptr<PhysicalOperator> oper;
+    EXPECT_EQ(RC::SUCCESS, PhysicalPlanGenerator().create(join_oper, oper));
+    return oper;
+  }
+
+  Table *create_outer_table(const vector<int> &outer_ids)
+  {
+    const string outer_name = "outer_" + to_string(outer_table_num_++);
+    return prepare_table(outer_name.c_str(), outer_ids);
+  }
+
+protected:
+  Table *inner_           = nullptr;
+  int    outer_table_num_ = 0;
+};
+
+TEST_F(IndexNestedLoopJoinTest, test_bplus_tree_index)
+{
+  Index *index = create_index(inner_, "id", "i_inner_id", BPLUS_TREE_INDEX);
+  ASSERT_NE(nullptr, index);
+
+  // 有序的键，包括不存在的键和重复的键，输出超过一批
+  vector<int> ordered_ids;
+  for (int i = -5; i < INNER_KEY_NUM + 5; i++) {
+    ordered_ids.push_back(i);
+    if (i % 100 == 0) {
+      ordered_ids.push_back(i);
+    }
+  }
+  ASSERT_EQ(expected_results(ordered_ids), run_join(ordered_ids, index));
+
+  vector<int> unordered_ids = {1400, 3, 3, 99999, 0, 1499, 750, -1, 2};
+  ASSERT_EQ(expected_results(unordered_ids), run_join(unordered_ids, index));
+
+  ASSERT_TRUE(run_join({}, index).empty());
+  ASSERT_TRUE(run_join({-1, INNER_KEY_NUM}, index).empty());
+}
+
+TEST_F(IndexNestedLoopJoinTest, test_hash_index)
+{
+  Index *index = create_index(inner_, "id", "i_inner_id_hash", HASH_INDEX);
+  ASSERT_NE(nullptr, index);
+
+  // 哈希索引中同一个键的数据没有顺序
+  vector<int> ids = {1400, 3, 3, 99999, 0, 1499, 750, -1, 2};
+  vector<pair<int, int>> expected = expected_results(ids);
+  vector<pair<int, int>> results = run_join(ids, index);
+  sort(expected.begin(), expected.end());
+  sort(results.begin(), results.end());
+  ASSERT_EQ(expected, results);
+}
+
+TEST_F(IndexNestedLoopJoinTest, test_plan_generator)
+{
+  Table *small_outer = create_outer_table({1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+  Table *large_outer = create_outer_table(vector<int>(INNER_ROW_NUM / 2, 1));
+
+  // 内表没有索引
+  ASSERT_EQ(PhysicalOperatorType::HASH_JOIN, generate_join_plan(small_outer)->type());
+
+  ASSERT_NE(nullptr, create_index(inner_, "id", "i_inner_id", BPLUS_TREE_INDEX));
+
+  // 外表很小，内表有索引，每行在索引中查找一次
+  unique_ptr<PhysicalOperator> oper = generate_join_plan(small_outer);
+  ASSERT_EQ(PhysicalOperatorType::INDEX_NESTED_LOOP_JOIN, oper->type());
+  ASSERT_EQ(2, static_cast<int>(oper->children().size()));
+  ASSERT_EQ(PhysicalOperatorType::TABLE_SCAN, oper->children()[0]->type());
+  ASSERT_EQ(PhysicalOperatorType::INDEX_SCAN, oper->children()[1]->type());
+
+  // 外表和内表差不多大时，查找索引不如扫描一遍内表
+  ASSERT_EQ(PhysicalOperatorType::HASH_JOIN, generate_join_plan(large_outer)->type());
+}
+
+int main(int argc, char **argv)
+{
+  return run_join_tests(argc, argv, "index_nested_loop_join_test.log");
+}
@@ -0,0 +1,151 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/global_context.h"
+#include "common/log/log.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/physical_operator.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/db/db.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+#include "gtest/gtest.h"
+
+/**
+ * @brief 连接算子单测共用的环境
+ * @details 每个测试使用自己的数据库目录和 buffer pool manager，ctest 可以并行执行这些测试
+ */
+class JoinTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    const testing::TestInfo *test_info = testing::UnitTest::GetInstance()->current_test_info();
+    db_path_ = std::string(test_info->test_suite_name()) + "_" + test_info->name() + "_dir";
+    std::filesystem::remove_all(db_path_);
+    std::filesystem::create_directory(db_path_);
+
+    bpm_ = std::make_unique<BufferPoolManager>();
+    BufferPoolManager::set_instance(bpm_.get());
+
+    db_ = std::make_unique<Db>();
+    ASSERT_EQ(RC::SUCCESS, db_->init("test", db_path_.c_str()));
+  }
+
+  void TearDown() override
+  {
+    db_.reset();
+    BufferPoolManager::set_instance(nullptr);
+    bpm_.reset();
+    std::filesystem::remove_all(db_path_);
+  }
+
+  static AttrInfoSqlNode attr(const char *name, AttrType type, size_t length = sizeof(int))
+  {
+    AttrInfoSqlNode attr_info;
+    attr_info.type   = type;
+    attr_info.name   = name;
+    attr_info.length = length;
+    return attr_info;
+  }
+
+  Table *create_table(const char *table_name, const std::vector<AttrInfoSqlNode> &attrs)
+  {
+    EXPECT_EQ(RC::SUCCESS, db_->create_table(table_name, static_cast<int>(attrs.size()), attrs.data()));
+    return db_->find_table(table_name);
+  }
+
+  static void insert_row(Table *table, const std::vector<Value> &values)
+  {
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, table->make_record(static_cast<int>(values.size()), values.data(), record));
+    ASSERT_EQ(RC::SUCCESS, table->insert_record(record));
+  }
+
+  Index *create_index(Table *table, const char *field_name, const char *index_name, IndexType index_type)
+  {
+    Trx *trx = GCTX.trx_kit_->create_trx(db_->clog_manager());
+    EXPECT_EQ(RC::SUCCESS, table->create_index(trx, table->table_meta().field(field_name), index_name, false, index_type));
+    GCTX.trx_kit_->destroy_trx(trx);
+    return table->find_index(index_name);
+  }
+
+  static std::unique_ptr<Expression> field_expr(Table *table, const char *field_name)
+  {
+    return std::make_unique<FieldExpr>(table, table->table_meta().field(field_name));
+  }
+
+  /**
+   * @brief 只保留 id < max_id 的行
+   */
+  static std::vector<std::unique_ptr<Expression>> id_less_than(Table *table, int max_id)
+  {
+    std::vector<std::unique_ptr<Expression>> predicates;
+    predicates.emplace_back(std::make_unique<ComparisonExpr>(
+        LESS_THAN, field_expr(table, "id"), std::make_unique<ValueExpr>(Value(max_id))));
+    return predicates;
+  }
+
+  /**
+   * @brief 执行连接，取出每一行中 left 和 right 两个整数字段的值
+   * @param before_close 在算子关闭前调用，用来检查算子的状态
+   * @return 按照输出顺序的结果
+   */
+  std::vector<std::pair<int, int>> run_join(PhysicalOperator &join, const TupleCellSpec &left,
+      const TupleCellSpec &right, const std::function<void()> &before_close = nullptr)
+  {
+    Trx *trx = GCTX.trx_kit_->create_trx(db_->clog_manager());
+    std::vector<std::pair<int, int>> results;
+    EXPECT_EQ(RC::SUCCESS, join.open(trx));
+    while (RC::SUCCESS == join.next()) {
+      Tuple *tuple = join.current_tuple();
+      Value left_value;
+      Value right_value;
+      EXPECT_EQ(RC::SUCCESS, tuple->find_cell(left, left_value));
+      EXPECT_EQ(RC::SUCCESS, tuple->find_cell(right, right_value));
+      results.emplace_back(left_value.get_int(), right_value.get_int());
+    }
+    if (before_close) {
+      before_close();
+    }
+    EXPECT_EQ(RC::SUCCESS, join.close());
+    GCTX.trx_kit_->destroy_trx(trx);
+    return results;
+  }
+
+protected:
+  std::string                        db_path_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+  std::unique_ptr<Db>                db_;
+};
+
+/**
+ * @brief 连接算子单测的 main 函数
+ */
+inline int run_join_tests(int argc, char **argv, const char *log_file)
+{
+  testing::InitGoogleTest(&argc, argv);
+  common::LoggerFactory::init_default(log_file, common::LOG_LEVEL_INFO);
+
+  if (TrxKit::init_global("vacuous") != RC::SUCCESS) {
+    return 1;
+  }
+  GCTX.trx_kit_ = TrxKit::instance();
+  return RUN_ALL_TESTS();
+}
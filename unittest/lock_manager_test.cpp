@@ -0,0 +1,135 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "storage/trx/lock_manager.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+
+LockConfig test_config(int timeout_ms, int detect_interval_ms)
+{
+  LockConfig config;
+  config.lock_wait_timeout_ms        = timeout_ms;
+  config.deadlock_detect_interval_ms = detect_interval_ms;
+  return config;
+}
+
+TEST(test_lock_manager, test_lock)
+{
+  LockManager lock_manager;
+  lock_manager.init(test_config(0, 0));
+
+  const LockManager::LockKey key1{1, 1, 0};
+  const LockManager::LockKey key2{1, 1, 1};
+  bool acquired = false;
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(1, key1, -1, acquired));
+  ASSERT_TRUE(acquired);
+  // 已经持有的锁
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(1, key1, -1, acquired));
+  ASSERT_FALSE(acquired);
+
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(2, key2, -1, acquired));
+  ASSERT_TRUE(acquired);
+  ASSERT_EQ(RC::LOCKED_WAIT_TIMEOUT, lock_manager.lock(2, key1, -1, acquired));
+  ASSERT_FALSE(acquired);
+
+  // 只释放自己持有的锁
+  lock_manager.unlock_all(2, {key1, key2});
+  ASSERT_EQ(RC::LOCKED_WAIT_TIMEOUT, lock_manager.lock(2, key1, -1, acquired));
+  lock_manager.unlock_all(1, {key1});
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(2, key1, -1, acquired));
+  ASSERT_TRUE(acquired);
+
+  ASSERT_EQ(6, lock_manager.stats().lock_requests.load());
+  ASSERT_EQ(2, lock_manager.stats().wait_timeouts.load());
+}
+
+TEST(test_lock_manager, test_wait)
+{
+  LockManager lock_manager;
+  lock_manager.init(test_config(10000, 0));
+
+  const LockManager::LockKey key{1, 1, 0};
+  bool acquired = false;
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(1, key, -1, acquired));
+
+  // 等待的事务按照请求的顺序拿到锁
+  vector<int32_t> order;
+  mutex order_lock;
+  auto waiter = [&](int32_t trx_id) {
+    bool acquired = false;
+    ASSERT_EQ(RC::SUCCESS, lock_manager.lock(trx_id, key, -1, acquired));
+    ASSERT_TRUE(acquired);
+    {
+      lock_guard<mutex> guard(order_lock);
+      order.push_back(trx_id);
+    }
+    lock_manager.unlock_all(trx_id, {key});
+  };
+
+  vector<thread> threads;
+  for (int32_t trx_id = 2; trx_id <= 4; trx_id++) {
+    threads.emplace_back(waiter, trx_id);
+    while (lock_manager.stats().waiting.load() < trx_id - 1) {
+      this_thread::yield();
+    }
+  }
+
+  // 等待超时不影响其它等待者
+  ASSERT_EQ(RC::LOCKED_WAIT_TIMEOUT, lock_manager.lock(5, key, 10, acquired));
+
+  lock_manager.unlock_all(1, {key});
+  for (thread &t : threads) {
+    t.join();
+  }
+  ASSERT_EQ((vector<int32_t>{2, 3, 4}), order);
+  ASSERT_EQ(4, lock_manager.stats().lock_waits.load());
+  ASSERT_EQ(0, lock_manager.stats().waiting.load());
+}
+
+TEST(test_lock_manager, test_deadlock)
+{
+  LockManager lock_manager;
+  lock_manager.init(test_config(10000, 10));
+
+  const LockManager::LockKey key1{1, 1, 0};
+  const LockManager::LockKey key2{1, 2, 0};
+  bool acquired = false;
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(1, key1, -1, acquired));
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(2, key2, -1, acquired));
+
+  // 1 等待 2 持有的锁，2 再等待 1 持有的锁，年轻的事务 2 被选中放弃
+  RC rc1 = RC::SUCCESS;
+  thread t1([&]() {
+    bool acquired = false;
+    rc1 = lock_manager.lock(1, key2, -1, acquired);
+  });
+  while (lock_manager.stats().waiting.load() < 1) {
+    this_thread::yield();
+  }
+
+  ASSERT_EQ(RC::LOCKED_DEADLOCK, lock_manager.lock(2, key1, -1, acquired));
+  lock_manager.unlock_all(2, {key2});
+  t1.join();
+  ASSERT_EQ(RC::SUCCESS, rc1);
+  ASSERT_EQ(1, lock_manager.stats().deadlocks.load());
+  ASSERT_EQ(0, lock_manager.detect_deadlocks());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,166 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sql/operator/index_scan_physical_operator.h"
+#include "sql/operator/merge_join_physical_operator.h"
+#include "join_test.h"
+
+using namespace std;
+
+const int ROW_NUM   = 3000;
+const int NAME_NUM  = 13;  // name 按照字符串排序与按照数字排序不同，比如 n10 < n2
+const int GROUP_NUM = 2;   // 每个 g 超过一批
+
+class MergeJoinTest : public JoinTest
+{
+protected:
+  void SetUp() override
+  {
+    JoinTest::SetUp();
+    t1_ = prepare_table("t1");
+    t2_ = prepare_table("t2");
+  }
+
+  /**
+   * @brief 创建表 t(id int, name char(8), g int)，id 从0开始，插入的顺序与 id 相反，
+   * name 是 "n" + id % NAME_NUM，g 是 id % GROUP_NUM。每个字段上都建立B+树索引
+   */
+  Table *prepare_table(const char *table_name)
+  {
+    Table *table = create_table(table_name, {attr("id", INTS), attr("name", CHARS, 8), attr("g", INTS)});
+    for (int i = ROW_NUM - 1; i >= 0; i--) {
+      const string name = "n" + to_string(i % NAME_NUM);
+      insert_row(table, {Value(i), Value(name.c_str()), Value(i % GROUP_NUM)});
+    }
+
+    for (const char *field_name : {"id", "name", "g"}) {
+      const string index_name = string(table_name) + "_" + field_name;
+      EXPECT_NE(nullptr, create_index(table, field_name, index_name.c_str(), BPLUS_TREE_INDEX));
+    }
+    return table;
+  }
+
+  /**
+   * @brief 按照 key 字段的索引顺序扫描表，只保留 id < max_id 的行。max_id 是 INT_MAX 时保留所有的行
+   */
+  static unique_ptr<PhysicalOperator> create_scan(Table *table, const char *key, int max_id)
+  {
+    Index *index = table->find_index((string(table->name()) + "_" + key).c_str());
+    auto   scan  = make_unique<IndexScanPhysicalOperator>(table, index, true, nullptr, false, nullptr, false);
+    if (max_id != numeric_limits<int>::max()) {
+      scan->set_predicates(id_less_than(table, max_id));
+    }
+    return scan;
+  }
+
+  /**
+   * @brief 执行 select t1.id, t2.id from t1, t2 where t1.key = t2.key and t1.id < left_max and t2.id < right_max
+   * @return 按照 (t1.id, t2.id) 排序的结果
+   */
+  vector<pair<int, int>> run_join(const char *key, int left_max, int right_max, int64_t *max_run_rows = nullptr)
+  {
+    MergeJoinPhysicalOperator join(field_expr(t1_, key), field_expr(t2_, key));
+    join.add_child(create_scan(t1_, key, left_max));
+    join.add_child(create_scan(t2_, key, right_max));
+
+    vector<pair<int, int>> results =
+        JoinTest::run_join(join, TupleCellSpec(t1_->name(), "id"), TupleCellSpec(t2_->name(), "id"), [&]() {
+          if (max_run_rows != nullptr) {
+            *max_run_rows = join.max_run_rows();
+          }
+        });
+    sort(results.begin(), results.end());
+    return results;
+  }
+
+  /**
+   * @brief 两端的 id 对 mod 取余相同的所有组合
+   */
+  static vector<pair<int, int>> expected_results(int mod, int left_max, int right_max)
+  {
+    vector<pair<int, int>> results;
+    for (int i = 0; i < left_max; i++) {
+      for (int j = i % mod; j < right_max; j += mod) {
+        results.emplace_back(i, j);
+      }
+    }
+    return results;
+  }
+
+protected:
+  Table *t1_ = nullptr;
+  Table *t2_ = nullptr;
+};
+
+TEST_F(MergeJoinTest, test_unique_keys)
+{
+  vector<pair<int, int>> expected;
+  for (int i = 0; i < 2000; i++) {
+    expected.emplace_back(i, i);
+  }
+
+  // 键唯一时缓冲区中只有一行
+  int64_t max_run_rows = 0;
+  ASSERT_EQ(expected, run_join("id", ROW_NUM, 2000, &max_run_rows));
+  ASSERT_EQ(1, max_run_rows);
+  ASSERT_EQ(expected, run_join("id", 2000, ROW_NUM, &max_run_rows));
+  ASSERT_EQ(1, max_run_rows);
+}
+
+TEST_F(MergeJoinTest, test_duplicate_keys)
+{
+  ASSERT_EQ(expected_results(NAME_NUM, 40, ROW_NUM), run_join("name", 40, ROW_NUM));
+  ASSERT_EQ(expected_results(NAME_NUM, ROW_NUM, 100), run_join("name", ROW_NUM, 100));
+
+  // 右表中每个键的数据超过一批
+  int64_t max_run_rows = 0;
+  ASSERT_EQ(expected_results(GROUP_NUM, 3, ROW_NUM), run_join("g", 3, ROW_NUM, &max_run_rows));
+  ASSERT_EQ(ROW_NUM / GROUP_NUM, max_run_rows);
+}
+
+TEST_F(MergeJoinTest, test_extreme_keys)
+{
+  // 键值相减会溢出，索引和归并时都要按照大小比较。t2 中的 INT_MAX 在 t1 中没有对应的行
+  const int min_id = numeric_limits<int>::min();
+  const int max_id = numeric_limits<int>::max();
+  for (Table *table : {t1_, t2_}) {
+    for (int id : {min_id, max_id}) {
+      if (table == t1_ && id == max_id) {
+        continue;
+      }
+      insert_row(table, {Value(id), Value("n0"), Value(0)});
+    }
+  }
+
+  vector<pair<int, int>> expected;
+  expected.emplace_back(min_id, min_id);
+  for (int i = 0; i < ROW_NUM; i++) {
+    expected.emplace_back(i, i);
+  }
+  ASSERT_EQ(expected, run_join("id", max_id, max_id));
+}
+
+TEST_F(MergeJoinTest, test_empty)
+{
+  ASSERT_TRUE(run_join("id", 0, ROW_NUM).empty());
+  ASSERT_TRUE(run_join("id", ROW_NUM, 0).empty());
+  ASSERT_TRUE(run_join("name", 0, 0).empty());
+}
+
+int main(int argc, char **argv)
+{
+  return run_join_tests(argc, argv, "merge_join_test.log");
+}
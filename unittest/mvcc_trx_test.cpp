@@ -0,0 +1,892 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+#include <chrono>
+#include <filesystem>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "common/global_context.h"
+#include "common/log/log.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/clog/clog.h"
+#include "storage/db/db.h"
+#include "storage/index/index.h"
+#include "storage/record/record.h"
+#include "storage/table/table.h"
+#include "storage/trx/mvcc_trx.h"
+#include "storage/trx/trx.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace common;
+
+const char *mvcc_db_path = "mvcc_trx_test_dir";
+const int   ROW_NUM      = 100;
+
+BufferPoolManager bpm;
+
+/**
+ * @brief 创建一个宽表 t(id int, payload char(800), v int)，插入的数据都已经提交
+ */
+void prepare_table(Db &db)
+{
+  AttrInfoSqlNode attrs[3];
+  attrs[0].type   = INTS;
+  attrs[0].name   = "id";
+  attrs[0].length = sizeof(int);
+  attrs[1].type   = CHARS;
+  attrs[1].name   = "payload";
+  attrs[1].length = 800;
+  attrs[2].type   = INTS;
+  attrs[2].name   = "v";
+  attrs[2].length = sizeof(int);
+  ASSERT_EQ(RC::SUCCESS, db.create_table("t", 3, attrs));
+
+  Table *table = db.find_table("t");
+  const FieldMeta *trx_fields = table->table_meta().trx_fields().first;
+  for (int i = 0; i < ROW_NUM; i++) {
+    Value values[3];
+    values[0].set_int(i);
+    values[1].set_string("payload");
+    values[2].set_int(i);
+
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, table->make_record(3, values, record));
+    const int32_t begin_xid = 1;
+    const int32_t end_xid   = numeric_limits<int32_t>::max();
+    memcpy(record.data() + trx_fields[0].offset(), &begin_xid, sizeof(begin_xid));
+    memcpy(record.data() + trx_fields[1].offset(), &end_xid, sizeof(end_xid));
+    ASSERT_EQ(RC::SUCCESS, table->insert_record(record));
+  }
+  ASSERT_EQ(RC::SUCCESS, db.sync());
+}
+
+void update_all(Trx *trx, Table *table, const char *field, int delta)
+{
+  RecordFileScanner scanner;
+  ASSERT_EQ(RC::SUCCESS, table->get_record_scanner(scanner, trx, false /*readonly*/));
+  Record record;
+  while (scanner.has_next()) {
+    ASSERT_EQ(RC::SUCCESS, scanner.next(record));
+    int value = 0;
+    memcpy(&value, record.data() + table->table_meta().field("id")->offset(), sizeof(value));
+    ASSERT_EQ(RC::SUCCESS, trx->update_record(table, record, Value(value + delta), field));
+  }
+  scanner.close_scan();
+}
+
+void check_values(Table *table, int v_delta)
+{
+  const TableMeta &table_meta = table->table_meta();
+  const FieldMeta *begin_field = &table_meta.trx_fields().first[0];
+  RecordFileScanner scanner;
+  ASSERT_EQ(RC::SUCCESS, table->get_record_scanner(scanner, nullptr, true /*readonly*/));
+  Record record;
+  int count = 0;
+  while (scanner.has_next()) {
+    ASSERT_EQ(RC::SUCCESS, scanner.next(record));
+    int id = 0, v = 0, begin_xid = 0;
+    memcpy(&id, record.data() + table_meta.field("id")->offset(), sizeof(id));
+    memcpy(&v, record.data() + table_meta.field("v")->offset(), sizeof(v));
+    memcpy(&begin_xid, record.data() + begin_field->offset(), sizeof(begin_xid));
+    ASSERT_EQ(id + v_delta, v);
+    ASSERT_GT(begin_xid, 0);
+    ASSERT_STREQ("payload", record.data() + table_meta.field("payload")->offset());
+    count++;
+  }
+  scanner.close_scan();
+  ASSERT_EQ(ROW_NUM, count);
+}
+
+/**
+ * @brief 事务读到的每一行 v - id 的值，所有行必须相同
+ * @param row_num 事务应该读到的行数
+ */
+int read_delta(Trx *trx, Table *table, int row_num = ROW_NUM)
+{
+  const TableMeta &table_meta = table->table_meta();
+  RecordFileScanner scanner;
+  EXPECT_EQ(RC::SUCCESS, table->get_record_scanner(scanner, trx, true /*readonly*/));
+  Record record;
+  int count = 0;
+  int delta = -1;
+  while (scanner.has_next()) {
+    EXPECT_EQ(RC::SUCCESS, scanner.next(record));
+    int id = 0, v = 0;
+    memcpy(&id, record.data() + table_meta.field("id")->offset(), sizeof(id));
+    memcpy(&v, record.data() + table_meta.field("v")->offset(), sizeof(v));
+    EXPECT_TRUE(delta == -1 || delta == v - id);
+    delta = v - id;
+    count++;
+  }
+  scanner.close_scan();
+  EXPECT_EQ(row_num, count);
+  return delta;
+}
+
+TEST(test_mvcc_trx, test_update)
+{
+  filesystem::remove_all(mvcc_db_path);
+  filesystem::create_directory(mvcc_db_path);
+
+  TrxKit *trx_kit = GCTX.trx_kit_;
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", mvcc_db_path));
+    prepare_table(db);
+    Table *table = db.find_table("t");
+    CLogManager *clog_manager = db.clog_manager();
+
+    // 提交的修改只记录变化的字节，日志量远小于整行数据
+    LSN begin_lsn = clog_manager->flushed_lsn();
+    Trx *trx = trx_kit->create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+    update_all(trx, table, "v", 10);
+    ASSERT_EQ(RC::SUCCESS, trx->commit());
+    LSN log_size = clog_manager->flushed_lsn() - begin_lsn;
+    ASSERT_LT(log_size, static_cast<LSN>(ROW_NUM) * table->table_meta().record_size() / 5);
+    trx_kit->destroy_trx(trx);
+    trx_kit->resolve_commits();
+    check_values(table, 10);
+
+    // 回滚的修改恢复原来的数据
+    trx = trx_kit->create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+    update_all(trx, table, "v", 20);
+    update_all(trx, table, "v", 30);
+    ASSERT_EQ(RC::SUCCESS, trx->rollback());
+    trx_kit->destroy_trx(trx);
+    check_values(table, 10);
+
+    // 没有结束的事务，页面落盘以后重启，恢复时根据日志中修改前的数据回滚
+    trx = trx_kit->create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+    update_all(trx, table, "v", 40);
+    ASSERT_EQ(RC::SUCCESS, clog_manager->sync());
+    ASSERT_EQ(RC::SUCCESS, table->sync());
+    trx_kit->destroy_trx(trx);
+  }
+
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", mvcc_db_path));
+    check_values(db.find_table("t"), 10);
+  }
+
+  filesystem::remove_all(mvcc_db_path);
+}
+
+TEST(test_mvcc_trx, test_version_chain)
+{
+  filesystem::remove_all(mvcc_db_path);
+  filesystem::create_directory(mvcc_db_path);
+
+  // 使用单独的事务模块，历史版本不受其它测试的影响
+  MvccTrxKit kit;
+  ASSERT_EQ(RC::SUCCESS, kit.init());
+  MvccTrxKit *trx_kit = &kit;
+
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", mvcc_db_path));
+    prepare_table(db);
+    Table *table = db.find_table("t");
+    CLogManager *clog_manager = db.clog_manager();
+
+    Trx *reader = trx_kit->create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, reader->start_if_need());
+    ASSERT_EQ(0, read_delta(reader, table));
+
+    // 修改没有提交时，其它事务读到的是修改前的版本
+    Trx *writer = trx_kit->create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+    update_all(writer, table, "v", 10);
+    ASSERT_EQ(10, read_delta(writer, table));
+    ASSERT_EQ(0, read_delta(reader, table));
+    ASSERT_EQ(ROW_NUM, trx_kit->version_store().version_count());
+
+    // 提交以后，之前开始的事务仍然读到修改前的版本，之后开始的事务读到新的版本
+    ASSERT_EQ(RC::SUCCESS, writer->commit());
+    ASSERT_EQ(0, read_delta(reader, table));
+
+    Trx *late_reader = trx_kit->create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, late_reader->start_if_need());
+    ASSERT_EQ(10, read_delta(late_reader, table));
+
+    // 再修改一次，版本链上有两个版本
+    ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+    update_all(writer, table, "v", 20);
+    ASSERT_EQ(RC::SUCCESS, writer->commit());
+    ASSERT_EQ(0, read_delta(reader, table));
+    ASSERT_EQ(10, read_delta(late_reader, table));
+    ASSERT_EQ(2 * ROW_NUM, trx_kit->version_store().version_count());
+
+    // 修改时读取最新提交的版本，不受读视图的限制
+    RecordFileScanner scanner;
+    ASSERT_EQ(RC::SUCCESS, table->get_record_scanner(scanner, reader, false /*readonly*/));
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, scanner.next(record));
+    int id = 0, v = 0;
+    memcpy(&id, record.data() + table->table_meta().field("id")->offset(), sizeof(id));
+    memcpy(&v, record.data() + table->table_meta().field("v")->offset(), sizeof(v));
+    ASSERT_EQ(20, v - id);
+    scanner.close_scan();
+
+    // 最老的事务结束以后，它能看到的版本可以清理
+    trx_kit->resolve_commits();
+    ASSERT_EQ(RC::SUCCESS, reader->rollback());
+    trx_kit->version_store().purge(trx_kit->purge_horizon());
+    ASSERT_EQ(ROW_NUM, trx_kit->version_store().version_count());
+    ASSERT_EQ(10, read_delta(late_reader, table));
+
+    ASSERT_EQ(RC::SUCCESS, late_reader->rollback());
+    trx_kit->version_store().purge(trx_kit->purge_horizon());
+    ASSERT_EQ(0, trx_kit->version_store().version_count());
+
+    trx_kit->destroy_trx(reader);
+    trx_kit->destroy_trx(late_reader);
+    trx_kit->destroy_trx(writer);
+  }
+
+  filesystem::remove_all(mvcc_db_path);
+}
+
+TEST(test_mvcc_trx, test_commit_table)
+{
+  filesystem::remove_all(mvcc_db_path);
+  filesystem::create_directory(mvcc_db_path);
+
+  MvccTrxKit trx_kit;
+  ASSERT_EQ(RC::SUCCESS, trx_kit.init());
+
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", mvcc_db_path));
+    prepare_table(db);
+    Table *table = db.find_table("t");
+    CLogManager *clog_manager = db.clog_manager();
+
+    Trx *reader = trx_kit.create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, reader->start_if_need());
+
+    // 提交只登记提交号，之后开始的事务通过提交号看到全部修改
+    Trx *writer = trx_kit.create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+    update_all(writer, table, "v", 10);
+    ASSERT_EQ(RC::SUCCESS, writer->commit());
+
+    Trx *late_reader = trx_kit.create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, late_reader->start_if_need());
+    ASSERT_EQ(10, read_delta(late_reader, table));
+    ASSERT_EQ(0, read_delta(reader, table));
+
+    // 基于已经提交但没有改写的记录再修改
+    ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+    update_all(writer, table, "v", 20);
+    ASSERT_EQ(20, read_delta(writer, table));
+    ASSERT_EQ(RC::SUCCESS, writer->rollback());
+    ASSERT_EQ(10, read_delta(late_reader, table));
+
+    // 改写完成以后删除登记的提交号，记录上都是提交号
+    trx_kit.resolve_commits();
+    ASSERT_EQ(0, trx_kit.commit_table().size());
+    check_values(table, 10);
+    ASSERT_EQ(10, read_delta(late_reader, table));
+    ASSERT_EQ(0, read_delta(reader, table));
+
+    trx_kit.destroy_trx(reader);
+    trx_kit.destroy_trx(late_reader);
+    trx_kit.destroy_trx(writer);
+  }
+
+  filesystem::remove_all(mvcc_db_path);
+}
+
+/**
+ * @brief 记录上 begin xid 是 xid 的行数，直接读取页面上的数据
+ */
+int count_begin_xid(Table *table, int32_t xid)
+{
+  const FieldMeta *begin_field = &table->table_meta().trx_fields().first[0];
+  RecordFileScanner scanner;
+  EXPECT_EQ(RC::SUCCESS, table->get_record_scanner(scanner, nullptr, true /*readonly*/));
+  Record record;
+  int count = 0;
+  while (scanner.has_next()) {
+    EXPECT_EQ(RC::SUCCESS, scanner.next(record));
+    int32_t begin_xid = 0;
+    memcpy(&begin_xid, record.data() + begin_field->offset(), sizeof(begin_xid));
+    count += (begin_xid == xid) ? 1 : 0;
+  }
+  scanner.close_scan();
+  return count;
+}
+
+TEST(test_mvcc_trx, test_commit_without_touching_records)
+{
+  filesystem::remove_all(mvcc_db_path);
+  filesystem::create_directory(mvcc_db_path);
+
+  MvccTrxKit trx_kit;
+  ASSERT_EQ(RC::SUCCESS, trx_kit.init());
+
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", mvcc_db_path));
+    prepare_table(db);
+    Table *table = db.find_table("t");
+    CLogManager *clog_manager = db.clog_manager();
+
+    // 提交以后记录上仍然是负的事务号，提交的代价与修改的记录数无关
+    Trx *writer = trx_kit.create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+    const int32_t trx_id = writer->id();
+    update_all(writer, table, "v", 10);
+    ASSERT_EQ(RC::SUCCESS, writer->commit());
+    ASSERT_EQ(ROW_NUM, count_begin_xid(table, -trx_id));
+    ASSERT_EQ(1, trx_kit.commit_table().size());
+
+    Trx *reader = trx_kit.create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, reader->start_if_need());
+    ASSERT_EQ(10, read_delta(reader, table));
+    ASSERT_EQ(RC::SUCCESS, reader->commit());
+
+    // 积累的修改不多时语句之间也不改写
+    trx_kit.resolve_commits_if_needed();
+    ASSERT_EQ(ROW_NUM, count_begin_xid(table, -trx_id));
+
+#ifndef CONCURRENCY
+    // 积累得足够多以后，语句之间一次改写所有提交的事务
+    int delta = 10;
+    while (trx_kit.commit_table().size() * ROW_NUM < 4096) {
+      ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+      delta += 10;
+      update_all(writer, table, "v", delta);
+      ASSERT_EQ(RC::SUCCESS, writer->commit());
+    }
+    trx_kit.resolve_commits_if_needed();
+    ASSERT_EQ(0, trx_kit.commit_table().size());
+    ASSERT_EQ(0, count_begin_xid(table, -trx_id));
+    check_values(table, delta);
+#endif
+
+    trx_kit.destroy_trx(reader);
+    trx_kit.destroy_trx(writer);
+  }
+
+  filesystem::remove_all(mvcc_db_path);
+}
+
+TEST(test_mvcc_trx, test_row_lock)
+{
+  filesystem::remove_all(mvcc_db_path);
+  filesystem::create_directory(mvcc_db_path);
+
+  MvccTrxKit trx_kit;
+  ASSERT_EQ(RC::SUCCESS, trx_kit.init());
+
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", mvcc_db_path));
+    prepare_table(db);
+    Table *table = db.find_table("t");
+    CLogManager *clog_manager = db.clog_manager();
+
+    Trx *writer = trx_kit.create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+    update_all(writer, table, "v", 10);
+
+    // 行锁被没有结束的事务持有，不等待时立即失败
+    Trx *other = trx_kit.create_trx(clog_manager);
+    other->set_lock_wait_timeout_ms(0);
+    ASSERT_EQ(RC::SUCCESS, other->start_if_need());
+    RecordFileScanner scanner;
+    ASSERT_EQ(RC::LOCKED_WAIT_TIMEOUT, table->get_record_scanner(scanner, other, false /*readonly*/));
+    ASSERT_EQ(1, trx_kit.lock_manager().stats().wait_timeouts.load());
+
+    // 等待的事务在持有锁的事务提交以后拿到锁，基于提交后的版本修改
+    other->set_lock_wait_timeout_ms(10000);
+    thread committer([writer]() {
+      this_thread::sleep_for(chrono::milliseconds(50));
+      ASSERT_EQ(RC::SUCCESS, writer->commit());
+    });
+    update_all(other, table, "v", 30);
+    committer.join();
+    ASSERT_EQ(RC::SUCCESS, other->commit());
+    ASSERT_EQ(1, trx_kit.lock_manager().stats().lock_waits.load());
+
+    trx_kit.resolve_commits();
+    check_values(table, 30);
+
+    // 持有锁的事务回滚时要修改页面，等锁的事务不能持有页面的锁，否则只能等到超时
+    Trx *rollbacker = trx_kit.create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, rollbacker->start_if_need());
+    update_all(rollbacker, table, "v", 50);
+
+    Trx *waiter = trx_kit.create_trx(clog_manager);
+    waiter->set_lock_wait_timeout_ms(10000);
+    ASSERT_EQ(RC::SUCCESS, waiter->start_if_need());
+    thread rollback_thread([rollbacker]() {
+      this_thread::sleep_for(chrono::milliseconds(50));
+      ASSERT_EQ(RC::SUCCESS, rollbacker->rollback());
+    });
+    update_all(waiter, table, "v", 40);
+    rollback_thread.join();
+    ASSERT_EQ(RC::SUCCESS, waiter->commit());
+    ASSERT_EQ(1, trx_kit.lock_manager().stats().wait_timeouts.load());
+
+    trx_kit.resolve_commits();
+    check_values(table, 40);
+
+    trx_kit.destroy_trx(writer);
+    trx_kit.destroy_trx(other);
+    trx_kit.destroy_trx(rollbacker);
+    trx_kit.destroy_trx(waiter);
+  }
+
+  filesystem::remove_all(mvcc_db_path);
+}
+
+TEST(test_mvcc_trx, test_read_only)
+{
+  filesystem::remove_all(mvcc_db_path);
+  filesystem::create_directory(mvcc_db_path);
+
+  MvccTrxKit trx_kit;
+  ASSERT_EQ(RC::SUCCESS, trx_kit.init());
+
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", mvcc_db_path));
+    prepare_table(db);
+    Table *table = db.find_table("t");
+    CLogManager *clog_manager = db.clog_manager();
+
+    // 准备的数据使用提交号1，真实运行时它已经由提交分配
+    trx_kit.next_trx_id();
+
+    // 只读事务不分配事务号，也不登记为活跃事务
+    Trx *reader = trx_kit.create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, reader->set_read_only(true));
+    ASSERT_EQ(RC::SUCCESS, reader->start_if_need());
+    ASSERT_EQ(0, reader->id());
+    // 事务开始以后不能再切换
+    ASSERT_EQ(RC::INVALID_ARGUMENT, reader->set_read_only(false));
+    ASSERT_TRUE(reader->read_only());
+    vector<Trx *> trxes;
+    trx_kit.all_trxes(trxes);
+    ASSERT_TRUE(trxes.empty());
+
+    Trx *writer = trx_kit.create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+    update_all(writer, table, "v", 10);
+    ASSERT_EQ(RC::SUCCESS, writer->commit());
+
+    // 读视图与读写事务相同，历史版本也不会被清理
+    trx_kit.version_store().purge(trx_kit.purge_horizon());
+    ASSERT_EQ(ROW_NUM, trx_kit.version_store().version_count());
+    ASSERT_EQ(0, read_delta(reader, table));
+
+    RecordFileScanner scanner;
+    ASSERT_EQ(RC::TRX_READ_ONLY, table->get_record_scanner(scanner, reader, false /*readonly*/));
+    scanner.close_scan();
+
+    // 结束以后恢复为读写事务
+    ASSERT_EQ(RC::SUCCESS, reader->commit());
+    ASSERT_FALSE(reader->read_only());
+    trx_kit.resolve_commits();
+    trx_kit.version_store().purge(trx_kit.purge_horizon());
+    ASSERT_EQ(0, trx_kit.version_store().version_count());
+
+    ASSERT_EQ(RC::SUCCESS, reader->start_if_need());
+    ASSERT_GT(reader->id(), 0);
+    ASSERT_EQ(10, read_delta(reader, table));
+    ASSERT_EQ(RC::SUCCESS, reader->rollback());
+
+    trx_kit.destroy_trx(reader);
+    trx_kit.destroy_trx(writer);
+  }
+
+  filesystem::remove_all(mvcc_db_path);
+}
+
+TEST(test_mvcc_trx, test_operation_log)
+{
+  filesystem::remove_all(mvcc_db_path);
+  filesystem::create_directory(mvcc_db_path);
+
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", mvcc_db_path));
+    prepare_table(db);
+    Table *table = db.find_table("t");
+
+    // 按照与页面顺序相反的顺序追加，跨越多个内存块，每个操作重复一次
+    OperationLog log;
+    constexpr int page_num = 10;
+    constexpr int slot_num = 100;
+    for (int i = 0; i < 2; i++) {
+      for (int page = page_num; page > 0; page--) {
+        for (int slot = slot_num - 1; slot >= 0; slot--) {
+          log.append(Operation(Operation::Type::UPDATE, table, RID(page, slot)));
+        }
+      }
+    }
+    ASSERT_EQ(static_cast<size_t>(2 * page_num * slot_num), log.size());
+
+    vector<Operation> operations;
+    log.sorted(operations);
+    ASSERT_EQ(static_cast<size_t>(page_num * slot_num), operations.size());
+    int pages = 0;
+    RC rc = OperationLog::for_each_page(operations, [&](const Operation *begin, const Operation *end) {
+      pages++;
+      EXPECT_EQ(pages, begin->page_num());
+      EXPECT_EQ(slot_num, end - begin);
+      for (const Operation *operation = begin; operation != end; ++operation) {
+        EXPECT_EQ(operation - begin, operation->slot_num());
+      }
+      return RC::SUCCESS;
+    });
+    ASSERT_EQ(RC::SUCCESS, rc);
+    ASSERT_EQ(page_num, pages);
+
+    // 访问函数返回错误时停止
+    pages = 0;
+    rc = OperationLog::for_each_page(operations, [&pages](const Operation *, const Operation *) {
+      return ++pages == 2 ? RC::RECORD_INVALID_RID : RC::SUCCESS;
+    });
+    ASSERT_EQ(RC::RECORD_INVALID_RID, rc);
+    ASSERT_EQ(2, pages);
+
+    log.sorted(operations, [](int32_t, PageNum page) { return page % 2 == 0; });
+    ASSERT_EQ(static_cast<size_t>(page_num / 2 * slot_num), operations.size());
+
+    log.clear();
+    ASSERT_TRUE(log.empty());
+  }
+
+  filesystem::remove_all(mvcc_db_path);
+}
+
+TEST(test_mvcc_trx, test_rollback)
+{
+  filesystem::remove_all(mvcc_db_path);
+  filesystem::create_directory(mvcc_db_path);
+
+  MvccTrxKit trx_kit;
+  ASSERT_EQ(RC::SUCCESS, trx_kit.init());
+
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", mvcc_db_path));
+    prepare_table(db);
+    Table *table = db.find_table("t");
+    CLogManager *clog_manager = db.clog_manager();
+
+    // 一个事务多次修改并删除跨越多个页面的记录，回滚按照页面恢复所有记录
+    Trx *writer = trx_kit.create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+    update_all(writer, table, "v", 10);
+    update_all(writer, table, "v", 20);
+
+    RecordFileScanner scanner;
+    ASSERT_EQ(RC::SUCCESS, table->get_record_scanner(scanner, writer, false /*readonly*/));
+    Record record;
+    while (scanner.has_next()) {
+      ASSERT_EQ(RC::SUCCESS, scanner.next(record));
+      ASSERT_EQ(RC::SUCCESS, writer->delete_record(table, record));
+    }
+    scanner.close_scan();
+
+    ASSERT_EQ(RC::SUCCESS, writer->rollback());
+    check_values(table, 0);
+    ASSERT_EQ(0, trx_kit.version_store().version_count());
+
+    Trx *reader = trx_kit.create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, reader->start_if_need());
+    ASSERT_EQ(0, read_delta(reader, table));
+    ASSERT_EQ(RC::SUCCESS, reader->rollback());
+
+    trx_kit.destroy_trx(reader);
+    trx_kit.destroy_trx(writer);
+  }
+
+  filesystem::remove_all(mvcc_db_path);
+}
+
+/**
+ * @brief 索引中等于 key 的数据对应的记录的 id，没有时返回-1
+ */
+int find_id_by_index(Table *table, Index *index, int key)
+{
+  IndexScanner *scanner =
+      index->create_scanner(reinterpret_cast<const char *>(&key), sizeof(key), true, reinterpret_cast<const char *>(&key), sizeof(key), true);
+  EXPECT_NE(nullptr, scanner);
+  int id = -1;
+  RID rid;
+  if (scanner->next_entry(&rid) == RC::SUCCESS) {
+    Record record;
+    EXPECT_EQ(RC::SUCCESS, table->get_record(rid, record));
+    memcpy(&id, record.data() + table->table_meta().field("id")->offset(), sizeof(id));
+  }
+  scanner->destroy();
+  return id;
+}
+
+TEST(test_mvcc_trx, test_deferred_index_update)
+{
+  filesystem::remove_all(mvcc_db_path);
+  filesystem::create_directory(mvcc_db_path);
+
+  MvccTrxKit trx_kit;
+  ASSERT_EQ(RC::SUCCESS, trx_kit.init());
+
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", mvcc_db_path));
+    prepare_table(db);
+    Table *table = db.find_table("t");
+    CLogManager *clog_manager = db.clog_manager();
+
+    Trx *writer = trx_kit.create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+    ASSERT_EQ(RC::SUCCESS, table->create_index(writer, table->table_meta().field("v"), "t_v", true, BPLUS_TREE_INDEX));
+    Index *index = table->find_index("t_v");
+    ASSERT_NE(nullptr, index);
+    ASSERT_EQ(0, find_id_by_index(table, index, 0));
+
+    // 修改记录时扫描器持有数据页面的锁，索引项等到 apply_index_updates 时才修改
+    update_all(writer, table, "v", 1000);
+    ASSERT_EQ(0, find_id_by_index(table, index, 0));
+    ASSERT_EQ(-1, find_id_by_index(table, index, 1000));
+    ASSERT_EQ(RC::SUCCESS, writer->apply_index_updates());
+    ASSERT_EQ(-1, find_id_by_index(table, index, 0));
+    ASSERT_EQ(0, find_id_by_index(table, index, 1000));
+    ASSERT_EQ(RC::SUCCESS, writer->commit());
+    trx_kit.resolve_commits();
+    check_values(table, 1000);
+
+    // 违反唯一约束时记录已经修改了，事务只能回滚
+    ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+    RecordFileScanner scanner;
+    ASSERT_EQ(RC::SUCCESS, table->get_record_scanner(scanner, writer, false /*readonly*/));
+    Record record;
+    ASSERT_TRUE(scanner.has_next());
+    ASSERT_EQ(RC::SUCCESS, scanner.next(record));
+    int id = -1;
+    memcpy(&id, record.data() + table->table_meta().field("id")->offset(), sizeof(id));
+    const int other_v = (id + 1) % ROW_NUM + 1000;
+    ASSERT_EQ(RC::SUCCESS, writer->update_record(table, record, Value(other_v), "v"));
+    scanner.close_scan();
+
+    ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, writer->apply_index_updates());
+    ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, writer->commit());
+    check_values(table, 1000);
+    ASSERT_EQ(id, find_id_by_index(table, index, id + 1000));
+    ASSERT_EQ((id + 1) % ROW_NUM, find_id_by_index(table, index, other_v));
+
+    // 回滚以后事务可以继续使用
+    ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+    update_all(writer, table, "v", 2000);
+    ASSERT_EQ(RC::SUCCESS, writer->commit());
+    trx_kit.resolve_commits();
+    check_values(table, 2000);
+    ASSERT_EQ(id, find_id_by_index(table, index, id + 2000));
+
+    trx_kit.destroy_trx(writer);
+  }
+
+  filesystem::remove_all(mvcc_db_path);
+}
+
+TEST(test_mvcc_trx, test_restart_after_checkpoint)
+{
+  filesystem::remove_all(mvcc_db_path);
+  filesystem::create_directory(mvcc_db_path);
+
+  TrxKit *global_trx_kit = GCTX.trx_kit_;
+  int32_t max_trx_id = 0;
+  {
+    MvccTrxKit trx_kit;
+    ASSERT_EQ(RC::SUCCESS, trx_kit.init());
+    GCTX.trx_kit_ = &trx_kit;
+
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", mvcc_db_path));
+    prepare_table(db);
+    Table *table = db.find_table("t");
+    CLogManager *clog_manager = db.clog_manager();
+
+    // 提交若干次修改和一次删除，记录上的提交号远大于1
+    for (int i = 0; i < 5; i++) {
+      Trx *trx = trx_kit.create_trx(clog_manager);
+      ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+      update_all(trx, table, "v", 10 * (i + 1));
+      ASSERT_EQ(RC::SUCCESS, trx->commit());
+      trx_kit.destroy_trx(trx);
+    }
+
+    Trx *trx = trx_kit.create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+    RecordFileScanner scanner;
+    ASSERT_EQ(RC::SUCCESS, table->get_record_scanner(scanner, trx, false /*readonly*/));
+    Record record;
+    ASSERT_TRUE(scanner.has_next());
+    ASSERT_EQ(RC::SUCCESS, scanner.next(record));
+    ASSERT_EQ(RC::SUCCESS, trx->delete_record(table, record));
+    scanner.close_scan();
+    ASSERT_EQ(RC::SUCCESS, trx->commit());
+    trx_kit.destroy_trx(trx);
+
+    // 正常关闭：数据都落盘并且做检查点，重启时没有需要重做的日志
+    ASSERT_EQ(RC::SUCCESS, db.sync());
+    max_trx_id = trx_kit.current_trx_id();
+    ASSERT_GT(max_trx_id, 10);
+  }
+
+  {
+    // 重启以后的事务管理器从0开始分配事务号，恢复时根据检查点调整
+    MvccTrxKit trx_kit;
+    ASSERT_EQ(RC::SUCCESS, trx_kit.init());
+    GCTX.trx_kit_ = &trx_kit;
+
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", mvcc_db_path));
+    ASSERT_GE(trx_kit.current_trx_id(), max_trx_id);
+
+    Table *table = db.find_table("t");
+    Trx *reader = trx_kit.create_trx(db.clog_manager());
+    ASSERT_EQ(RC::SUCCESS, reader->start_if_need());
+    ASSERT_EQ(50, read_delta(reader, table, ROW_NUM - 1));
+    ASSERT_EQ(RC::SUCCESS, reader->commit());
+    trx_kit.destroy_trx(reader);
+
+    // 新的提交号比记录上已有的都大，修改对之后的事务可见
+    Trx *writer = trx_kit.create_trx(db.clog_manager());
+    ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+    update_all(writer, table, "v", 60);
+    ASSERT_EQ(RC::SUCCESS, writer->commit());
+    trx_kit.destroy_trx(writer);
+
+    reader = trx_kit.create_trx(db.clog_manager());
+    ASSERT_EQ(RC::SUCCESS, reader->start_if_need());
+    ASSERT_EQ(60, read_delta(reader, table, ROW_NUM - 1));
+    ASSERT_EQ(RC::SUCCESS, reader->commit());
+    trx_kit.destroy_trx(reader);
+
+    ASSERT_EQ(RC::SUCCESS, db.sync());
+  }
+  GCTX.trx_kit_ = global_trx_kit;
+
+  filesystem::remove_all(mvcc_db_path);
+}
+
+TEST(test_mvcc_trx, test_recover_unique_index)
+{
+  filesystem::remove_all(mvcc_db_path);
+  filesystem::create_directory(mvcc_db_path);
+
+  TrxKit *trx_kit = GCTX.trx_kit_;
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", mvcc_db_path));
+    AttrInfoSqlNode attrs[2];
+    attrs[0].type   = INTS;
+    attrs[0].name   = "id";
+    attrs[0].length = sizeof(int);
+    attrs[1].type   = INTS;
+    attrs[1].name   = "v";
+    attrs[1].length = sizeof(int);
+    ASSERT_EQ(RC::SUCCESS, db.create_table("u", 2, attrs));
+    Table *table = db.find_table("u");
+    CLogManager *clog_manager = db.clog_manager();
+
+    Trx *trx = trx_kit->create_trx(clog_manager);
+    ASSERT_EQ(RC::SUCCESS, table->create_index(trx, table->table_meta().field("id"), "u_id", true, BPLUS_TREE_INDEX));
+    ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+
+    // 按照插入的执行过程写日志：插入记录和索引，记录 INSERT 日志并推进页面LSN，最后提交
+    const FieldMeta *trx_fields = table->table_meta().trx_fields().first;
+    ASSERT_EQ(RC::SUCCESS, clog_manager->begin_trx(trx->id()));
+    for (int i = 0; i < ROW_NUM; i++) {
+      Value values[2];
+      values[0].set_int(i);
+      values[1].set_int(i);
+
+      Record record;
+      ASSERT_EQ(RC::SUCCESS, table->make_record(2, values, record));
+      const int32_t begin_xid = -trx->id();
+      const int32_t end_xid   = numeric_limits<int32_t>::max();
+      memcpy(record.data() + trx_fields[0].offset(), &begin_xid, sizeof(begin_xid));
+      memcpy(record.data() + trx_fields[1].offset(), &end_xid, sizeof(end_xid));
+      ASSERT_EQ(RC::SUCCESS, table->insert_record(record));
+
+      LSN lsn = 0;
+      ASSERT_EQ(RC::SUCCESS,
+          clog_manager->append_log(
+              CLogType::INSERT, trx->id(), table->table_id(), record.rid(), record.len(), 0, record.data(), &lsn));
+      ASSERT_EQ(RC::SUCCESS, table->modify_record(record.rid(), lsn, [](Record &) { return true; }));
+    }
+    ASSERT_EQ(RC::SUCCESS, clog_manager->commit_trx(trx->id(), trx_kit->current_trx_id() + 1));
+    trx_kit->destroy_trx(trx);
+
+    // 数据页面和索引页面都已经落盘，但是没有做检查点，重启时重做所有的插入
+    ASSERT_EQ(RC::SUCCESS, clog_manager->sync());
+    ASSERT_EQ(RC::SUCCESS, table->sync());
+  }
+
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test", mvcc_db_path));
+    Table *table = db.find_table("u");
+    Index *index = table->find_index("u_id");
+    ASSERT_NE(nullptr, index);
+
+    // 每个键在唯一索引中仍然只有一项，指向原来的记录
+    for (int i = 0; i < ROW_NUM; i++) {
+      IndexScanner *scanner =
+          index->create_scanner(reinterpret_cast<const char *>(&i), sizeof(i), true, reinterpret_cast<const char *>(&i), sizeof(i), true);
+      ASSERT_NE(nullptr, scanner);
+      RID rid;
+      ASSERT_EQ(RC::SUCCESS, scanner->next_entry(&rid));
+      Record record;
+      ASSERT_EQ(RC::SUCCESS, table->get_record(rid, record));
+      int id = -1;
+      memcpy(&id, record.data() + table->table_meta().field("id")->offset(), sizeof(id));
+      ASSERT_EQ(i, id);
+      ASSERT_EQ(RC::RECORD_EOF, scanner->next_entry(&rid));
+      scanner->destroy();
+    }
+
+    Trx *reader = trx_kit->create_trx(db.clog_manager());
+    ASSERT_EQ(RC::SUCCESS, reader->start_if_need());
+    ASSERT_EQ(0, read_delta(reader, table));
+    ASSERT_EQ(RC::SUCCESS, reader->commit());
+    trx_kit->destroy_trx(reader);
+  }
+
+  filesystem::remove_all(mvcc_db_path);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  LoggerFactory::init_default("mvcc_trx_test.log", LOG_LEVEL_INFO);
+
+  BufferPoolManager::set_instance(&bpm);
+  if (TrxKit::init_global("mvcc") != RC::SUCCESS) {
+    return 1;
+  }
+  GCTX.trx_kit_ = TrxKit::instance();
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,102 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <memory>
+
+#include "sql/parser/parse.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+
+/**
+ * @brief 解析一条SQL，返回唯一的语法树
+ */
+unique_ptr<ParsedSqlNode> parse_one(const char *sql)
+{
+  ParsedSqlResult result;
+  parse(sql, &result);
+  EXPECT_EQ(1, static_cast<int>(result.sql_nodes().size())) << sql;
+  if (result.sql_nodes().empty()) {
+    return make_unique<ParsedSqlNode>();
+  }
+  return std::move(result.sql_nodes().front());
+}
+
+TEST(test_parser, test_index_options_as_identifiers)
+{
+  // USING、HASH 不是保留字，可以用作表名和字段名
+  unique_ptr<ParsedSqlNode> node = parse_one("create table hash(id int, hash int, using char(4));");
+  ASSERT_EQ(SCF_CREATE_TABLE, node->flag);
+  ASSERT_EQ("hash", node->create_table.relation_name);
+  ASSERT_EQ(3, static_cast<int>(node->create_table.attr_infos.size()));
+  ASSERT_EQ("hash", node->create_table.attr_infos[1].name);
+  ASSERT_EQ("using", node->create_table.attr_infos[2].name);
+
+  node = parse_one("select hash, using from hash where using = 'a';");
+  ASSERT_EQ(SCF_SELECT, node->flag);
+  ASSERT_EQ(2, static_cast<int>(node->selection.attributes.size()));
+  ASSERT_EQ(1, static_cast<int>(node->selection.conditions.size()));
+
+  node = parse_one("update hash set hash = 1 where using = 'b';");
+  ASSERT_EQ(SCF_UPDATE, node->flag);
+
+  node = parse_one("create index i_hash on hash(hash);");
+  ASSERT_EQ(SCF_CREATE_INDEX, node->flag);
+  ASSERT_EQ("hash", node->create_index.relation_name);
+  ASSERT_EQ("hash", node->create_index.attribute_name);
+  ASSERT_EQ(BPLUS_TREE_INDEX, node->create_index.index_type);
+
+  node = parse_one("create unique index i_using on hash(using) USING Hash;");
+  ASSERT_EQ(SCF_CREATE_INDEX, node->flag);
+  ASSERT_EQ("using", node->create_index.attribute_name);
+  ASSERT_TRUE(node->create_index.is_unique);
+  ASSERT_EQ(HASH_INDEX, node->create_index.index_type);
+
+  ASSERT_EQ(SCF_ERROR, parse_one("create index i_id on hash(id) using btree;")->flag);
+  ASSERT_EQ(SCF_ERROR, parse_one("create index i_id on hash(id) hash;")->flag);
+}
+
+TEST(test_parser, test_compress_as_identifier)
+{
+  // COMPRESS 不是保留字
+  unique_ptr<ParsedSqlNode> node = parse_one("create table compress(id int, compress char(8));");
+  ASSERT_EQ(SCF_CREATE_TABLE, node->flag);
+  ASSERT_EQ("compress", node->create_table.relation_name);
+  ASSERT_EQ("compress", node->create_table.attr_infos[1].name);
+
+  node = parse_one("select compress.compress from compress where compress = 'a';");
+  ASSERT_EQ(SCF_SELECT, node->flag);
+  ASSERT_EQ("compress", node->selection.attributes[0].relation_name);
+  ASSERT_EQ("compress", node->selection.attributes[0].attribute_name);
+
+  node = parse_one("create index compress on compress(compress) compress;");
+  ASSERT_EQ(SCF_CREATE_INDEX, node->flag);
+  ASSERT_EQ("compress", node->create_index.index_name);
+  ASSERT_EQ("compress", node->create_index.attribute_name);
+  ASSERT_TRUE(node->create_index.prefix_compression);
+  ASSERT_EQ(BPLUS_TREE_INDEX, node->create_index.index_type);
+
+  node = parse_one("create index i_compress on compress(compress) using hash COMPRESS;");
+  ASSERT_EQ(SCF_CREATE_INDEX, node->flag);
+  ASSERT_TRUE(node->create_index.prefix_compression);
+  ASSERT_EQ(HASH_INDEX, node->create_index.index_type);
+
+  node = parse_one("create index i_compress on compress(compress);");
+  ASSERT_FALSE(node->create_index.prefix_compression);
+
+  ASSERT_EQ(SCF_ERROR, parse_one("create index i_compress on compress(compress) compressed;")->flag);
+  ASSERT_EQ(SCF_ERROR, parse_one("create index i_compress on compress(compress) compress using hash;")->flag);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
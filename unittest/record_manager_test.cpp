@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include <string.h>
+#include <algorithm>
 #include <sstream>
 
 #include "gtest/gtest.h"
@@ -184,6 +185,88 @@ TEST(test_record_page_handler, test_record_file_iterator)
   delete bpm;
 }
 
+TEST(test_record_page_handler, test_page_lsn)
+{
+  const char *record_manager_file = "record_manager.bp";
+  ::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(record_manager_file, bp));
+
+  // 记录刷页面之前要求持久化的日志位置
+  LSN flushed_lsn = 0;
+  bpm->set_log_flusher([&flushed_lsn](LSN lsn) {
+    flushed_lsn = std::max(flushed_lsn, lsn);
+    return RC::SUCCESS;
+  });
+
+  RecordFileHandler file_handler;
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(bp));
+
+  const int record_size = 8;
+  char buf[record_size];
+  memset(buf, 0, sizeof(buf));
+  RID rid;
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(buf, record_size, &rid));
+
+  // 运行时的修改总是执行，并推进页面LSN
+  auto updater = [](char value) {
+    return [value](Record &record) {
+      record.data()[0] = value;
+      return true;
+    };
+  };
+  ASSERT_EQ(RC::SUCCESS, file_handler.modify_record(rid, 100, updater('a')));
+
+  // 重做时，页面LSN不小于日志位置的修改被跳过
+  ASSERT_EQ(RC::SUCCESS, file_handler.redo_modify_record(rid, 100, updater('b')));
+  ASSERT_EQ(RC::SUCCESS, file_handler.redo_modify_record(rid, 80, updater('b')));
+  char value = 0;
+  ASSERT_EQ(RC::SUCCESS, file_handler.visit_record(rid, true, [&value](Record &record) { value = record.data()[0]; }));
+  ASSERT_EQ('a', value);
+
+  ASSERT_EQ(RC::SUCCESS, file_handler.redo_modify_record(rid, 200, updater('c')));
+  ASSERT_EQ(RC::SUCCESS, file_handler.visit_record(rid, true, [&value](Record &record) { value = record.data()[0]; }));
+  ASSERT_EQ('c', value);
+
+  bool applied = true;
+  buf[0] = 'd';
+  ASSERT_EQ(RC::SUCCESS, file_handler.recover_insert_record(buf, record_size, rid, 150, applied));
+  ASSERT_FALSE(applied);
+  ASSERT_EQ(RC::SUCCESS, file_handler.recover_insert_record(buf, record_size, rid, 300, applied));
+  ASSERT_TRUE(applied);
+
+  // 批量修改时有一个槽位无效，所有记录都不修改
+  RID rid2;
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(buf, record_size, &rid2));
+  int visited = 0;
+  auto batch_updater = [&visited](int, Record &record) {
+    visited++;
+    record.data()[0] = 'e';
+    return true;
+  };
+  ASSERT_EQ(RC::RECORD_NOT_EXIST,
+      file_handler.modify_records(rid.page_num, {rid.slot_num, rid2.slot_num + 1, rid2.slot_num}, 400, batch_updater));
+  ASSERT_EQ(0, visited);
+  ASSERT_EQ(RC::SUCCESS, file_handler.visit_record(rid, true, [&value](Record &record) { value = record.data()[0]; }));
+  ASSERT_EQ('d', value);
+
+  ASSERT_EQ(RC::SUCCESS, file_handler.modify_records(rid.page_num, {rid.slot_num, rid2.slot_num}, 400, batch_updater));
+  ASSERT_EQ(2, visited);
+  ASSERT_EQ(RC::SUCCESS, file_handler.visit_record(rid2, true, [&value](Record &record) { value = record.data()[0]; }));
+  ASSERT_EQ('e', value);
+
+  // 页面落盘前先持久化页面LSN之前的日志
+  ASSERT_EQ(RC::SUCCESS, bp->flush_all_pages());
+  ASSERT_EQ(400, flushed_lsn);
+
+  bpm->set_log_flusher(nullptr);
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
 int main(int argc, char **argv)
 {
   // 分析gtest程序的命令行参数
@@ -0,0 +1,189 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "storage/trx/read_view.h"
+#include "storage/trx/trx_registry.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+
+// 活跃事务表不会访问事务对象，测试中使用假的指针
+Trx *fake_trx(intptr_t value) { return reinterpret_cast<Trx *>(value); }
+
+TEST(test_trx_registry, test_basic)
+{
+  TrxRegistry registry(8);
+  ASSERT_EQ(8, registry.capacity());
+
+  // 1 和 9 的起始位置相同
+  ASSERT_TRUE(registry.add(1, fake_trx(1)));
+  ASSERT_TRUE(registry.add(9, fake_trx(9)));
+  ASSERT_TRUE(registry.add(2, fake_trx(2)));
+  ASSERT_EQ(3, registry.size());
+  ASSERT_EQ(fake_trx(1), registry.find(1));
+  ASSERT_EQ(fake_trx(9), registry.find(9));
+  ASSERT_EQ(fake_trx(2), registry.find(2));
+  ASSERT_EQ(nullptr, registry.find(3));
+  ASSERT_EQ(nullptr, registry.find(17));
+
+  // 只有事务对象也匹配时才删除
+  ASSERT_FALSE(registry.remove(1, fake_trx(2)));
+  ASSERT_TRUE(registry.remove(1, fake_trx(1)));
+  ASSERT_EQ(nullptr, registry.find(1));
+  ASSERT_EQ(fake_trx(9), registry.find(9));
+
+  vector<Trx *> trxes;
+  registry.all(trxes);
+  ASSERT_EQ(2, static_cast<int>(trxes.size()));
+
+  // 表满以后登记到溢出表中
+  for (int32_t trx_id = 10; trx_id < 16; trx_id++) {
+    ASSERT_TRUE(registry.add(trx_id, fake_trx(trx_id)));
+  }
+  ASSERT_EQ(0, registry.overflow_size());
+  ASSERT_TRUE(registry.add(16, fake_trx(16)));
+  ASSERT_TRUE(registry.add(17, fake_trx(17)));
+  ASSERT_EQ(2, registry.overflow_size());
+  ASSERT_EQ(10, registry.size());
+  ASSERT_EQ(fake_trx(16), registry.find(16));
+  ASSERT_EQ(fake_trx(17), registry.find(17));
+
+  registry.all(trxes);
+  ASSERT_EQ(10, static_cast<int>(trxes.size()));
+
+  vector<int32_t> trx_ids;
+  registry.snapshot(17, trx_ids);
+  ASSERT_EQ((vector<int32_t>{2, 9, 10, 11, 12, 13, 14, 15, 16, 17}), trx_ids);
+
+  ASSERT_FALSE(registry.remove(16, fake_trx(17)));
+  ASSERT_TRUE(registry.remove(16, fake_trx(16)));
+  ASSERT_EQ(nullptr, registry.find(16));
+  ASSERT_EQ(1, registry.overflow_size());
+  ASSERT_EQ(9, registry.size());
+
+  // 哈希表中空出来的位置可以继续使用
+  ASSERT_TRUE(registry.remove(10, fake_trx(10)));
+  ASSERT_TRUE(registry.add(18, fake_trx(18)));
+  ASSERT_EQ(1, registry.overflow_size());
+  ASSERT_EQ(fake_trx(18), registry.find(18));
+}
+
+TEST(test_trx_registry, test_oldest)
+{
+  TrxRegistry registry(16);
+  ASSERT_EQ(1, registry.oldest(0));
+
+  ASSERT_TRUE(registry.add(3, fake_trx(3)));
+  ASSERT_TRUE(registry.add(5, fake_trx(5)));
+  ASSERT_EQ(3, registry.oldest(6));
+
+  ASSERT_TRUE(registry.remove(3, fake_trx(3)));
+  ASSERT_EQ(5, registry.oldest(6));
+
+  ASSERT_TRUE(registry.remove(5, fake_trx(5)));
+  ASSERT_EQ(7, registry.oldest(6));
+
+  // 事务号小于之前的结果(重做日志时)
+  ASSERT_TRUE(registry.add(4, fake_trx(4)));
+  ASSERT_EQ(4, registry.oldest(8));
+}
+
+TEST(test_trx_registry, test_snapshot)
+{
+  TrxRegistry registry(16);
+  atomic<int32_t> current_trx_id{2};
+
+  // 提交号 3、5 还没有完成，4 已经完成
+  ASSERT_EQ(3, registry.start(current_trx_id, fake_trx(3)));
+  ASSERT_EQ(4, registry.start(current_trx_id, fake_trx(4)));
+  ASSERT_EQ(5, registry.start(current_trx_id, fake_trx(5)));
+  ASSERT_TRUE(registry.remove(4, fake_trx(4)));
+
+  vector<int32_t> active;
+  const int32_t limit = registry.snapshot(current_trx_id.load(), active);
+  ASSERT_EQ(5, limit);
+  ASSERT_EQ((vector<int32_t>{3, 5}), active);
+
+  ReadView read_view(limit + 1, std::move(active));
+  ASSERT_EQ(3, read_view.up_limit());
+  ASSERT_TRUE(read_view.visible(1));
+  ASSERT_TRUE(read_view.visible(2));
+  ASSERT_FALSE(read_view.visible(3));
+  ASSERT_TRUE(read_view.visible(4));
+  ASSERT_FALSE(read_view.visible(5));
+  ASSERT_FALSE(read_view.visible(6));
+
+  // 读视图创建以后完成的提交仍然不可见
+  ASSERT_TRUE(registry.remove(3, fake_trx(3)));
+  ASSERT_FALSE(read_view.visible(3));
+}
+
+TEST(test_trx_registry, test_read_view_slots)
+{
+  ReadViewSlots slots(4);
+  ASSERT_EQ(100, slots.min(100));
+
+  // 先登记下界，取完快照以后改成 up_limit
+  const int slot1 = slots.acquire(3);
+  ASSERT_EQ(3, slots.min(100));
+  slots.update(slot1, 5);
+  ASSERT_EQ(5, slots.min(100));
+  ASSERT_EQ(4, slots.min(4));
+
+  const int slot2 = slots.acquire(7);
+  ASSERT_NE(slot1, slot2);
+  ASSERT_EQ(5, slots.min(100));
+
+  slots.release(slot1);
+  ASSERT_EQ(7, slots.min(100));
+  slots.release(slot2);
+  ASSERT_EQ(100, slots.min(100));
+}
+
+TEST(test_trx_registry, test_concurrency)
+{
+  TrxRegistry registry(64);
+  atomic<int32_t> current_trx_id{0};
+  const int thread_num = 8;
+  const int trx_num    = 10000;
+
+  auto worker = [&](int index) {
+    Trx *trx = fake_trx(index + 1);
+    for (int i = 0; i < trx_num; i++) {
+      const int32_t trx_id = registry.start(current_trx_id, trx);
+      ASSERT_GT(trx_id, 0);
+      ASSERT_EQ(trx, registry.find(trx_id));
+      ASSERT_LE(registry.oldest(current_trx_id.load()), trx_id);
+      ASSERT_TRUE(registry.remove(trx_id, trx));
+    }
+  };
+
+  vector<thread> threads;
+  for (int i = 0; i < thread_num; i++) {
+    threads.emplace_back(worker, i);
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+
+  ASSERT_EQ(0, registry.size());
+  ASSERT_EQ(current_trx_id.load() + 1, registry.oldest(current_trx_id.load()));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}